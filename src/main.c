@@ -23,11 +23,13 @@
 #include "ui/footer.h"
 #include "ui/home/main_menu.h"
 #include "ui/layout.h"
+#include "utils/cpu_features.h"
 #include "utils/resize.h"
 #include "utils/utils.h"
 
 int
 main() {
+    cpu_features_init();   // Select the hash kernels before any worker runs
     setlocale(LC_ALL, ""); // Set the locale to the user's default (utf-8)
     initscr();             // Initialize ncurses
 
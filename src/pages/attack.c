@@ -67,7 +67,7 @@ render_attack_page(WINDOW* content_win, WINDOW* header_win, WINDOW* footer_win,
             case KEY_DOWN:
             case '\t': // Tab key
                 // If the user presses down on the last item, wrap around to the first item
-                if (selected_item_index == hash_config_len - 1) {
+                if (selected_item_index == hash_menu_item_count() - 1) {
                     menu_driver(hash_menu, REQ_FIRST_ITEM);
                 } else {
                     menu_driver(hash_menu, REQ_DOWN_ITEM);
@@ -85,8 +85,13 @@ render_attack_page(WINDOW* content_win, WINDOW* header_win, WINDOW* footer_win,
             case KEY_ENTER:
             case 10: // Enter key
                 hash_menu_erase();
-                render_hash_collision_page(content_win, header_win, footer_win, max_y, max_x,
-                                           selected_item_index, thread_pool);
+                const hash_menu_tool_t* tool = hash_menu_tool(selected_item_index);
+                if (tool) {
+                    tool->render(content_win, header_win, footer_win, max_y, max_x, thread_pool);
+                } else {
+                    render_hash_collision_page(content_win, header_win, footer_win, max_y, max_x,
+                                               selected_item_index, thread_pool);
+                }
 
                 // Back to menu after exiting the hash collision page
                 hash_menu_restore(content_win, *max_y, *max_x);
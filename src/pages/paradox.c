@@ -65,6 +65,7 @@ render_paradox_page(WINDOW* content_win, WINDOW* header_win, WINDOW* footer_win,
     int ch;
     while ((ch = wgetch(content_win)) != KEY_F(2)) {
         paradox_form_handle_input(content_win, ch, &collision_probability, &simulated_runs_results);
+        paradox_form_update(content_win, collision_probability, &simulated_runs_results);
 
         // Check if terminal was resized
         if (check_console_window_resize_event(&win_size)) {
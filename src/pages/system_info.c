@@ -13,14 +13,20 @@
 #include "system_info.h"
 
 static const char const* s_system_info_page_title = "[ System Information ]";
-static int s_win_rows = 15, s_win_cols = 40;
+static int s_win_rows = 20, s_win_cols = 78;
+
+/**
+ * \brief          The column of the hash kernels, right of the versions and the CPU features
+ */
+static const int s_kernel_col = 40;
 
 /****************************************************************
                        INTERNAL FUNCTION
 ****************************************************************/
 /**
- * \brief          Render the system info like application version
- *                 and dependencies version. This function does not
+ * \brief          Render the system info like application version,
+ *                 dependencies version, the CPU features and the kernel
+ *                 of every hash function. This function does not
  *                 refresh the window after printing
  *
  * \param[in]      win The content to render the info at
@@ -48,6 +54,23 @@ render_info(WINDOW* win) {
 
     mvwprintw(win, 8, 2, "- GLib Version: %d.%d.%d", GLIB_MAJOR_VERSION, GLIB_MINOR_VERSION,
               GLIB_MICRO_VERSION);
+
+    // The features the processor has, then the ones the kernels use after the override
+    char features[64];
+    const char* override = cpu_features_override();
+    mvwprintw(win, 10, 2, "CPU Features:");
+    mvwprintw(win, 11, 2, "- Detected: %s",
+              cpu_features_describe(cpu_features_detected(), features, sizeof(features)));
+    mvwprintw(win, 12, 2, "- In use: %s",
+              cpu_features_describe(cpu_features(), features, sizeof(features)));
+    mvwprintw(win, 13, 2, "- %s: %.17s", BH_CPU_FEATURES_ENV, override ? override : "unset");
+
+    mvwprintw(win, 2, s_kernel_col, "Hash Kernels:");
+    for (unsigned short i = 0; i < hash_config_len; i++) {
+        char kernel[32];
+        mvwprintw(win, 3 + i, s_kernel_col, "- %-11s: %s", hash_config[i].label,
+                  hash_config_kernel_name(hash_config[i].id, kernel, sizeof(kernel)));
+    }
 }
 
 /**
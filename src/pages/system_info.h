@@ -20,9 +20,11 @@
 #include <windows.h>
 #endif
 
+#include "../ui/attack/hash_config.h"
 #include "../ui/error.h"
 #include "../ui/footer.h"
 #include "../ui/header.h"
+#include "../utils/cpu_features.h"
 #include "../utils/resize.h"
 #include "version.h"
 
@@ -0,0 +1,564 @@
+/**
+ * \file            attack_page.c
+ * \brief           The form handling every attack page shares. An attack page is a column of
+ *                  numeric fields with a button below them that starts a run on the worker
+ *                  threads, a progress line under the button and the results of the last run
+ *                  under it. The pages only describe their fields, how a run starts and how
+ *                  its progress and results show, the rest lives here.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "attack_page.h"
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Get the button field of the page
+ *
+ * \param[in]      page The attack page
+ * \return         The button field, after the input fields
+ */
+static FIELD*
+attack_page_button(const attack_page_t* page) {
+    return page->manager->fields[page->config->field_count];
+}
+
+/**
+ * \brief          Create a sub window from the parent window for the form, with the rows of
+ *                 the button, the progress line and the results below the fields. When they
+ *                 do not fit in the window, the page is marked too small and the window shows
+ *                 the rows the terminal needs instead.
+ *
+ * \param[in]      page The attack page
+ * \param[in]      win The window that will contain the created subwin for the form. This
+ *                 should ideally be the content win
+ * \param[in]      max_x The maximum width of the screen space that can be rendered
+ */
+static void
+attack_page_create_sub_win(attack_page_t* page, WINDOW* win, int max_x) {
+    form_manager_t* manager = page->manager;
+    unpost_form(manager->form); // The form is posted again on the new sub window
+    if (manager->sub_win) {
+        delwin(manager->sub_win);
+        manager->sub_win = NULL;
+    }
+
+    const int sub_win_rows_count = attack_page_row(page, 4) + page->config->result_rows;
+    const int sub_win_cols_count = max_x - BH_FORM_X_PADDING - BH_FORM_X_PADDING;
+
+    // Create a sub-window for the form with extra space for the button and the results
+    manager->sub_win = derwin(win, sub_win_rows_count, sub_win_cols_count, 5, 1);
+    page->is_too_small = manager->sub_win == NULL;
+    if (page->is_too_small) {
+        // The details above the form, its bottom border and the header and footer rows
+        int rows_needed = 5 + sub_win_rows_count + 1 + BH_LAYOUT_PADDING;
+        wattron(win, A_BOLD | COLOR_PAIR(BH_ERROR_COLOR_PAIR));
+        mvwprintw(win, 5, BH_FORM_X_PADDING,
+                  "The terminal is too small for this page, it needs %d rows.", rows_needed);
+        wattroff(win, A_BOLD | COLOR_PAIR(BH_ERROR_COLOR_PAIR));
+        wrefresh(win);
+        return;
+    }
+    keypad(manager->sub_win, TRUE);
+
+    set_form_win(manager->form, win);
+    set_form_sub(manager->form, manager->sub_win);
+    post_form(manager->form);
+}
+
+/**
+ * \brief          Refresh the form sub window, unless the page is too small to have one
+ *
+ * \param[in]      page The attack page
+ */
+static void
+attack_page_refresh(const attack_page_t* page) {
+    if (!page->is_too_small) {
+        wrefresh(page->manager->sub_win);
+    }
+}
+
+/**
+ * \brief          Render the labels of the fields and put the cursor on the first one
+ *
+ * \param[in]      page The attack page
+ * \param[in]      win The window the form is rendered in
+ */
+static void
+attack_page_form_render(attack_page_t* page, WINDOW* win) {
+    if (page->is_too_small) {
+        return;
+    }
+
+    render_form_field_labels(page->manager, page->config->fields);
+
+    set_current_field(page->manager->form, page->manager->fields[0]);
+    update_field_highlighting(page->manager);
+    form_driver(page->manager->form, REQ_END_LINE);
+
+    wrefresh(win);
+}
+
+/**
+ * \brief          Create the form of the page: its fields, its button and its sub window
+ *
+ * \param[in]      page The attack page
+ * \param[in]      win The window to display the form in. This should ideally be
+ *                 the content window.
+ * \param[in]      max_x The maximum width of the screen space that can be rendered
+ */
+static void
+attack_page_form_init(attack_page_t* page, WINDOW* win, int max_x) {
+    const attack_page_config_t* config = page->config;
+    char message[128];
+
+    page->manager = create_form_manager(config->fields, config->field_count, config->button, 1);
+    if (!page->manager) {
+        snprintf(message, sizeof(message), "Unable to allocate memory for %s form manager",
+                 config->name);
+        render_full_page_error_exit(win, 0, 0, message);
+    }
+
+    if (!create_form_input_fields(page->manager, config->fields)) {
+        snprintf(message, sizeof(message), "Unable to allocate memory for %s form field",
+                 config->name);
+        render_full_page_error_exit(win, 0, 0, message);
+    }
+
+    page->manager->fields[config->field_count] =
+        create_button_field(config->button->label, config->field_count + 1, BH_FORM_X_PADDING);
+
+    page->manager->form = new_form(page->manager->fields);
+    attack_page_create_sub_win(page, win, max_x);
+    attack_page_form_render(page, win);
+}
+
+/**
+ * \brief          Render the results of the last run below the progress line
+ *
+ * \param[in]      page The attack page
+ */
+static void
+attack_page_render_result(attack_page_t* page) {
+    int starting_y = attack_page_row(page, 4);
+    attack_page_clear_rows(page, starting_y, page->config->result_rows);
+    if (page->has_result && !page->is_too_small) {
+        page->config->render_result(page->manager->sub_win, starting_y);
+    }
+}
+
+/**
+ * \brief          Restore the form and the last results to the window, that has previously
+ *                 been cleared
+ *
+ * \param[in]      page The attack page
+ * \param[in]      win The window that should restore the form to.
+ * \param[in]      max_x The maximum width of the screen space that can be rendered
+ */
+static void
+attack_page_form_restore(attack_page_t* page, WINDOW* win, int max_x) {
+    form_manager_t* manager = page->manager;
+    attack_page_create_sub_win(page, win, max_x);
+    if (page->is_too_small) {
+        return;
+    }
+    attack_page_form_render(page, win);
+
+    // Manually restore field buffers
+    for (int i = 0; manager->fields[i] != NULL; ++i) {
+        const char* buf = field_buffer(manager->fields[i], 0);
+        set_field_buffer(manager->fields[i], 0, buf); // Force internal repaint
+    }
+
+    // Force redraw current field again
+    set_current_field(manager->form, manager->fields[0]);
+    form_driver(manager->form, REQ_FIRST_FIELD);
+
+    attack_page_render_result(page);
+    attack_page_refresh(page);
+}
+
+/**
+ * \brief          Show the progress of the run, with the hook of the page when it has one
+ *
+ * \param[in]      page The attack page
+ * \param[in]      ctx The context of the run
+ */
+static void
+attack_page_update_progress(attack_page_t* page, hash_collision_context_t* ctx) {
+    if (page->config->progress) {
+        page->config->progress(page, ctx);
+    } else {
+        attack_page_progress(page, g_atomic_int_get(&ctx->result->attempts_made),
+                             (int)ctx->max_attempts);
+    }
+}
+
+/**
+ * \brief          Put the button back, show an error of the workers, and keep and render the
+ *                 results of a finished run before its context is cleared
+ *
+ * \param[in]      page The attack page
+ * \param[in]      content_win The window of the page
+ * \param[in]      ctx The context of the finished run
+ */
+static void
+attack_page_finish_run(attack_page_t* page, WINDOW* content_win, hash_collision_context_t* ctx) {
+    const struct FormButton* button = page->config->button;
+    update_button_field_is_running(attack_page_button(page), button->label, button->loading_label,
+                                   false);
+
+    if (page->is_btn_highlighted) {
+        update_field_highlighting(page->manager);
+        set_field_buffer(attack_page_button(page), 0, button->label);
+        pos_form_cursor(page->manager->form);
+    }
+
+    if (ctx->error_info->has_error) {
+        char message[sizeof(ctx->error_info->error_message)
+                     + sizeof(ctx->error_info->error_location) + 128];
+        snprintf(message, sizeof(message), "%s%s\n%s%s%s%s%s",
+                 "An error had occured when calculating hashes.\nError: ",
+                 ctx->error_info->error_message, " at ", ctx->error_info->error_location, " (",
+                 error_type_to_string(ctx->error_info->error_type), " )");
+        render_full_page_error(content_win, 0, 0, message);
+    }
+
+    page->config->collect(ctx);
+    page->has_result = true;
+    attack_page_update_progress(page, ctx);
+    attack_page_render_result(page);
+    attack_page_refresh(page);
+    clear_result_hash_collision_context(ctx, false);
+}
+
+/**
+ * \brief          Render the description of the attack above the form
+ *
+ * \param[in]      page The attack page
+ * \param[in]      content_win The window to actually prints all the details in
+ * \param[in]      worker_count The number of workers the runs are divided among
+ * \param[in]      max_x The maximum width of the screen space that can be rendered
+ */
+static void
+render_attack_page_details(const attack_page_t* page, WINDOW* content_win, int worker_count,
+                           int max_x) {
+    mvwprintw(content_win, 2, BH_FORM_X_PADDING, "%s", page->config->description);
+    mvwprintw(content_win, 3, BH_FORM_X_PADDING, "Workers             : %d", worker_count);
+
+    // Segment the details and form input fields with a line
+    for (int i = BH_FORM_X_PADDING; i < max_x - 2; i++) {
+        mvwaddch(content_win, 4, i, '-');
+    }
+}
+
+/****************************************************************
+                       EXTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Get the row of the sub window the given part of the page starts on
+ *
+ * \param[in]      page The attack page
+ * \param[in]      offset The rows below the button, 2 for the progress line and 4 for the
+ *                 results
+ * \return         The row
+ */
+int
+attack_page_row(const attack_page_t* page, int offset) {
+    return page->config->field_count + 1 + offset;
+}
+
+/**
+ * \brief          Get the text of an input field of the page
+ *
+ * \param[in]      page The attack page
+ * \param[in]      index The index of the field in the fields of the page
+ * \return         The buffer of the field
+ */
+const char*
+attack_page_field_buffer(const attack_page_t* page, int index) {
+    return field_buffer(page->manager->fields[index], 0);
+}
+
+/**
+ * \brief          Clear rows of the form sub window
+ *
+ * \param[in]      page The attack page
+ * \param[in]      first The first row to clear
+ * \param[in]      count The number of rows to clear
+ */
+void
+attack_page_clear_rows(const attack_page_t* page, int first, int count) {
+    if (page->is_too_small) {
+        return;
+    }
+
+    for (int row = first; row < first + count; ++row) {
+        for (int col = BH_FORM_X_PADDING; col <= COLS - BH_FORM_X_PADDING; col++) {
+            mvwaddch(page->manager->sub_win, row, col, ' ');
+        }
+    }
+}
+
+/**
+ * \brief          Replace the progress line below the button
+ *
+ * \param[in]      page The attack page
+ * \param[in]      format The printf format of the line, followed by its arguments
+ */
+void
+attack_page_status(const attack_page_t* page, const char* format, ...) {
+    if (page->is_too_small) {
+        return;
+    }
+
+    int row = attack_page_row(page, 2);
+    attack_page_clear_rows(page, row, 1);
+
+    va_list args;
+    va_start(args, format);
+    wmove(page->manager->sub_win, row, BH_FORM_X_PADDING);
+    vw_printw(page->manager->sub_win, format, args);
+    va_end(args);
+}
+
+/**
+ * \brief          Show the inputs hashed so far on the progress line
+ *
+ * \param[in]      page The attack page
+ * \param[in]      progress The number of inputs hashed so far
+ * \param[in]      total The number of inputs to hash
+ */
+void
+attack_page_progress(const attack_page_t* page, int progress, int total) {
+    if (progress < 0 || total <= 0 || progress > total) {
+        return; // Invalid parameters
+    }
+
+    attack_page_status(page, "Progress: %d%% (%d/%d inputs)",
+                       (int)((gint64)progress * 100 / total), progress, total);
+}
+
+/**
+ * \brief          Show why a run can not start on the progress line
+ *
+ * \param[in]      page The attack page
+ * \param[in]      message The message
+ */
+void
+attack_page_message(const attack_page_t* page, const char* message) {
+    if (page->is_too_small) {
+        return;
+    }
+
+    int row = attack_page_row(page, 2);
+    attack_page_clear_rows(page, row, 1);
+    wattron(page->manager->sub_win, A_BOLD | COLOR_PAIR(BH_ERROR_COLOR_PAIR));
+    mvwprintw(page->manager->sub_win, row, BH_FORM_X_PADDING, "%s", message);
+    wattroff(page->manager->sub_win, A_BOLD | COLOR_PAIR(BH_ERROR_COLOR_PAIR));
+    wrefresh(page->manager->sub_win);
+}
+
+/**
+ * \brief          Set up the shared state of a run before its workers are submitted: the run
+ *                 seed the inputs are regenerated from, the mutexes, the error info and the
+ *                 counters of the result
+ *
+ * \param[out]     ctx The context of the run shared between all worker threads
+ * \param[in]      thread_pool The thread pool to run the workers on
+ * \param[in]      max_attempts The inputs of the run, the total of its progress
+ */
+void
+attack_page_prepare_run(hash_collision_context_t* ctx, GThreadPool* thread_pool,
+                        unsigned int max_attempts) {
+    RAND_bytes((unsigned char*)&ctx->run_seed, sizeof(ctx->run_seed));
+    ctx->table_mutex = g_new0(GMutex, 1);
+    g_mutex_init(ctx->table_mutex);
+
+    ctx->cancel = 0;
+    ctx->remaining_workers = 0;
+
+    ctx->result_mutex = g_new0(GMutex, 1);
+    g_mutex_init(ctx->result_mutex);
+
+    ctx->error_info = error_info_create();
+    if (!ctx->error_info) {
+        render_full_page_error_exit(stdscr, 0, 0, "Memory allocation failed for ctx error info");
+    }
+
+    ctx->result->attempts_made = 0;
+    memset(&ctx->result->stats, 0, sizeof(ctx->result->stats));
+
+    ctx->thread_pool = thread_pool;
+    ctx->worker_count = g_thread_pool_get_max_threads(thread_pool);
+    ctx->max_attempts = max_attempts;
+    ctx->result->stats.started_at = g_get_monotonic_time();
+}
+
+/**
+ * \brief          Render an attack page and run it until F2 is pressed: its form, the runs
+ *                 started from its button, their progress and their results.
+ *
+ * \param[in]      config What the page is made of
+ * \param[in]      content_win The window to render the page on
+ * \param[in]      header_win The window to render the header content, normally for
+ *                 the args of header_render
+ * \param[in]      footer_win The window to render the footer content, normally for
+ *                 the args of footer_render
+ * \param[out]     max_y The maximum height of the screen space that can be rendered. The
+ *                 value will be updated when a resize happens
+ * \param[out]     max_x The maximum width of the screen space that can be rendered. The
+ *                 value will be updated when a resize happens
+ * \param[in]      thread_pool The thread pool to run the workers on.
+ */
+void
+attack_page_render(const attack_page_config_t* config, WINDOW* content_win, WINDOW* header_win,
+                   WINDOW* footer_win, int* max_y, int* max_x, GThreadPool* thread_pool) {
+    if (content_win == NULL || header_win == NULL || footer_win == NULL) {
+        render_full_page_error_exit(stdscr, 0, 0,
+                                    "The window passed to attack_page_render is null");
+    }
+
+    attack_page_t page = {.config = config};
+
+    curs_set(1); // Show the cursor
+    bool nodelay_modified = false;
+    if (!is_nodelay(content_win)) {
+        nodelay(content_win, TRUE);
+        nodelay_modified = true; // Track if we modified nodelay
+    }
+
+    // Clear the window before rendering
+    werase(content_win);
+    wresize(content_win, *max_y - BH_LAYOUT_PADDING, *max_x);
+    mvwin(content_win, 4, 0);
+    box(content_win, 0, 0);
+
+    COORD win_size;
+
+    unsigned short title_len = strlen(config->title);
+    mvwprintw(content_win, 0, (*max_x - title_len) / 2, "%s", config->title);
+
+    int worker_count = g_thread_pool_get_max_threads(thread_pool);
+    render_attack_page_details(&page, content_win, worker_count, *max_x);
+
+    attack_page_form_init(&page, content_win, *max_x);
+    pos_form_cursor(page.manager->form);
+
+    hash_collision_simulation_result_t* result = malloc(sizeof(hash_collision_simulation_result_t));
+    if (!result) {
+        render_full_page_error_exit(stdscr, 0, 0, "Memory allocation failed for attack result.");
+    }
+    result->attempts_made = -1;
+    result->collision_found = false;
+    result->collision_input_1 = NULL;
+    result->collision_input_2 = NULL;
+    result->collision_hash_hex = NULL;
+    memset(&result->stats, 0, sizeof(result->stats));
+
+    // The structures of every attack hold its results, the shared table is never used
+    hash_collision_context_t ctx = {.hash_id = HASH_CONFIG_SHA256,
+                                    .shared = {.layout = HASH_TABLE_FLAT},
+                                    .result = result};
+
+    while (true) {
+        int char_input = wgetch(content_win);
+
+        if (char_input == KEY_F(2)) {
+            g_atomic_int_set((gint*)&ctx.cancel, 1); // Signal cancellation to worker threads
+            break;
+        }
+
+        // A page too small for its form only waits for a resize or F2
+        bool is_not_running = g_atomic_int_get(&result->attempts_made) == -1;
+        if (!page.is_too_small
+            && handle_form_input_key(page.manager, char_input, config->button->label,
+                                     &page.is_btn_highlighted)
+            && is_not_running) {
+            // We are not going to start another run while one is still running
+            config->start(&page, thread_pool, &ctx);
+        }
+
+        bool has_results_to_check = g_atomic_int_get(&result->attempts_made) != -1;
+        gint left = g_atomic_int_get((gint*)&ctx.remaining_workers);
+
+        // Every run schedules its later passes before its last worker leaves, so the run is
+        // over as soon as none is left
+        if (left == 0 && has_results_to_check) {
+            attack_page_finish_run(&page, content_win, &ctx);
+        } else if (has_results_to_check) {
+            // if button is not in running state, set it to running state
+            FIELD* button = attack_page_button(&page);
+            if (strcmp(field_buffer(button, 0), config->button->loading_label) != 0) {
+                update_button_field_is_running(button, config->button->label,
+                                               config->button->loading_label, true);
+            }
+
+            attack_page_update_progress(&page, &ctx);
+            attack_page_refresh(&page);
+        }
+
+        if (check_console_window_resize_event(&win_size)) {
+            int resize_result = resize_term(win_size.Y, win_size.X);
+            if (resize_result != OK) {
+                render_full_page_error(
+                    content_win, 0, 0,
+                    "Unable to resize the UI to the terminal new size. Resize failure.");
+            }
+
+            wclear(footer_win);
+
+            clear();
+            wclear(content_win);
+            refresh();
+
+            *max_y = win_size.Y;
+            *max_x = win_size.X;
+
+            wresize(content_win, *max_y - BH_LAYOUT_PADDING, *max_x);
+            box(content_win, 0, 0);
+            render_attack_page_details(&page, content_win, worker_count, *max_x);
+
+            header_render(header_win);
+            mvwin(footer_win, win_size.Y - 2, 0);
+            footer_render(footer_win, win_size.Y - 2, *max_x);
+            attack_page_form_restore(&page, content_win, *max_x);
+
+            mvwprintw(content_win, 0, (*max_x - title_len) / 2, "%s", config->title);
+            wrefresh(content_win);
+        }
+    }
+
+    bool waiting_all_threads_to_exit = true;
+    while (waiting_all_threads_to_exit) {
+        gint left = g_atomic_int_get((gint*)&ctx.remaining_workers);
+        attack_page_status(&page, "Exiting: %d%%", ((worker_count - left) * 100) / worker_count);
+
+        if (left == 0) {
+            waiting_all_threads_to_exit = false;
+        }
+    }
+
+    // Cleanup
+    clear_result_hash_collision_context(&ctx, true);
+    free_form_manager(page.manager);
+
+    curs_set(0); // Hide the cursor
+    if (nodelay_modified) {
+        nodelay(content_win, FALSE); // Restore nodelay to true
+    }
+
+    // Clear the window after user input
+    werase(content_win);
+
+    // Refresh the window to show the changes
+    wrefresh(content_win);
+}
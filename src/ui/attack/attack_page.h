@@ -0,0 +1,99 @@
+/**
+ * \file            attack_page.h
+ * \brief           Header file for attack_page.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef ATTACK_PAGE_H
+#define ATTACK_PAGE_H
+
+#include <form.h>
+#include <glib.h>
+#include <ncurses.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "hash_collision_compute.h"
+
+#include "../../utils/resize.h"
+#include "../../utils/utils.h"
+#include "../error.h"
+#include "../footer.h"
+#include "../form.h"
+#include "../header.h"
+#include "../layout.h"
+
+typedef struct attack_page attack_page_t;
+
+/**
+ * \brief          What an attack page is made of besides the form handling every attack page
+ *                 shares: its fields, how a run starts, and how its progress and results show
+ */
+typedef struct {
+    const char* title;       ///< The title on the top border of the page
+    const char* name;        ///< The name of the attack in error messages, e.g. "prefix search"
+    const char* description; ///< The line describing the attack above the form
+    const struct FormInputField* fields; ///< The input fields of the form
+    unsigned short field_count;          ///< The number of input fields
+    const struct FormButton* button;     ///< The button that starts a run
+    unsigned short result_rows;          ///< The rows below the button kept for the results
+
+    /**
+     * \brief          Read the fields and start a run with attack_page_prepare_run, or show
+     *                 why it can not start with attack_page_message
+     */
+    void (*start)(attack_page_t* page, GThreadPool* thread_pool, hash_collision_context_t* ctx);
+
+    /**
+     * \brief          Show the progress of a run, also called once it finished. NULL shows the
+     *                 inputs hashed out of max_attempts.
+     */
+    void (*progress)(attack_page_t* page, hash_collision_context_t* ctx);
+
+    /**
+     * \brief          Keep the results of a finished run before its context is cleared
+     */
+    void (*collect)(hash_collision_context_t* ctx);
+
+    /**
+     * \brief          Render the kept results from the given row of the sub window, which is
+     *                 cleared beforehand
+     */
+    void (*render_result)(WINDOW* win, int starting_y);
+} attack_page_config_t;
+
+/**
+ * \brief          The state of an attack page while it is shown
+ */
+struct attack_page {
+    const attack_page_config_t* config; ///< What the page is made of
+    form_manager_t* manager;            ///< The form of the page
+    bool is_btn_highlighted; ///< Whether the button is highlighted before it shows its run state
+    bool has_result;         ///< Whether a run finished since the page was opened
+    bool is_too_small; ///< Whether the form does not fit in the window, which says so instead
+};
+
+int attack_page_row(const attack_page_t* page, int offset);
+const char* attack_page_field_buffer(const attack_page_t* page, int index);
+void attack_page_clear_rows(const attack_page_t* page, int first, int count);
+void attack_page_status(const attack_page_t* page, const char* format, ...);
+void attack_page_progress(const attack_page_t* page, int progress, int total);
+void attack_page_message(const attack_page_t* page, const char* message);
+void attack_page_prepare_run(hash_collision_context_t* ctx, GThreadPool* thread_pool,
+                             unsigned int max_attempts);
+void attack_page_render(const attack_page_config_t* config, WINDOW* content_win,
+                        WINDOW* header_win, WINDOW* footer_win, int* max_y, int* max_x,
+                        GThreadPool* thread_pool);
+
+#endif
@@ -0,0 +1,324 @@
+/**
+ * \file            hash_analysis.c
+ * \brief           The page of the exhaustive analysis of a toy hash: every input of up to L
+ *                  bytes is hashed, with every input one bit away from it. The histograms of
+ *                  the digests are measured against a random function, so a bias of the hash
+ *                  in the collisions the attacks find shows up, and the flips of the output
+ *                  bits give the avalanche matrix.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_analysis.h"
+
+#define ACTION_SUBMIT 1
+
+/**
+ * \brief          The rows of the sub window below the button for the results of a run
+ */
+#define BH_ANALYSIS_RESULT_ROWS 20
+
+/**
+ * \brief          The row of the results the avalanche matrix starts on
+ */
+#define BH_ANALYSIS_AVALANCHE_ROW 8
+
+/**
+ * \brief          The z-score of a chi-square beyond which the outputs are not uniform
+ */
+#define BH_ANALYSIS_Z_LIMIT 3.0
+
+static const struct FormButton s_analysis_form_button = {"[ Run Analysis ]", "[ Running... ]",
+                                                         ACTION_SUBMIT};
+
+static const struct FormInputField s_analysis_form_field_metadata[] = {
+    {"Hash (menu number)", 1, 2, 0},
+    {"Input length L", 2, 1, BH_ANALYSIS_MAX_LENGTH}};
+
+/**
+ * \brief          The index of the input fields in s_analysis_form_field_metadata
+ */
+enum hash_analysis_field_index { HASH_ANALYSIS_FIELD_HASH = 0, HASH_ANALYSIS_FIELD_LENGTH };
+
+/**
+ * \brief          The results of the last run, kept to render them again after a resize
+ */
+typedef struct {
+    int attempts;            ///< The inputs hashed
+    double seconds;          ///< The duration of the run
+    const char* label;       ///< The label of the hash function
+    unsigned int bits;       ///< The bits of the digest
+    unsigned int max_length; ///< The longest inputs
+    bool finished;           ///< Whether every input was hashed and the shards merged
+    hash_analysis_distribution_t lengths[BH_ANALYSIS_MAX_LENGTH]; ///< Every length on its own
+    hash_analysis_distribution_t all; ///< Every input together
+    double avalanche[BH_ANALYSIS_MAX_INPUT_BITS]
+                    [BH_ANALYSIS_MAX_OUTPUT_BITS]; ///< The flip probabilities
+    double mean_bias;             ///< The mean distance of the avalanche matrix from 1/2
+    double max_bias;              ///< The largest distance from 1/2
+    unsigned int max_bias_input;  ///< The input bit of the largest distance
+    unsigned int max_bias_output; ///< The output bit of the largest distance
+    double random_bias;           ///< The mean distance of a random function
+} hash_analysis_result_t;
+
+// The results of the last analysis, rendered again when the page is restored
+static hash_analysis_result_t s_analysis_result;
+
+/****************************************************************
+ INTERNAL FUNCTION
+ ****************************************************************/
+
+/**
+ * \brief          Start an analysis: create the shards of the workers, then submit them.
+ *
+ * \param[in]      hash_id The toy hash function to analyse
+ * \param[in]      max_length The longest inputs to enumerate
+ * \param[in]      thread_pool The thread pool to run the workers on
+ * \param[out]     ctx The context of the run shared between all worker threads
+ */
+static void
+hash_analysis_run(enum hash_function_ids hash_id, unsigned int max_length,
+                  GThreadPool* thread_pool, hash_collision_context_t* ctx) {
+    ctx->hash_id = hash_id;
+
+    // Every worker counts into its own shard of the counters
+    ctx->analysis =
+        hash_analysis_create(hash_id, max_length, g_thread_pool_get_max_threads(thread_pool));
+    if (!ctx->analysis) {
+        render_full_page_error_exit(stdscr, 0, 0,
+                                    "Memory allocation failed for the analysis histograms.");
+    }
+
+    attack_page_prepare_run(ctx, thread_pool, (unsigned int)ctx->analysis->total);
+    hash_collision_submit_workers(ctx, HASH_PASS_ANALYSIS);
+}
+
+/**
+ * \brief          Update the progress bar in the analysis form sub window with the inputs
+ *                 hashed so far.
+ *
+ * \param[in]      page The analysis page
+ * \param[in]      ctx The context of the run
+ */
+static void
+hash_analysis_progress_update(attack_page_t* page, hash_collision_context_t* ctx) {
+    if (!ctx->analysis) {
+        return;
+    }
+
+    int done = g_atomic_int_get(&ctx->result->attempts_made);
+    guint64 total = ctx->analysis->total;
+    attack_page_status(page, "Progress: %d%% (%d/%llu inputs)", (int)((guint64)done * 100 / total),
+                       done, (unsigned long long)total);
+}
+
+/**
+ * \brief          Keep the results of a finished run, the measures of the merged shards
+ *
+ * \param[in]      ctx The context of the finished run
+ */
+static void
+hash_analysis_collect_result(hash_collision_context_t* ctx) {
+    hash_collision_stats_t* stats = &ctx->result->stats;
+    hash_analysis_result_t* result = &s_analysis_result;
+    memset(result, 0, sizeof(*result));
+
+    result->attempts = ctx->result->attempts_made;
+    result->seconds = stats->finished_at > stats->started_at
+                          ? (double)(stats->finished_at - stats->started_at) / G_USEC_PER_SEC
+                          : 0.0;
+    result->label = get_hash_config_item(ctx->hash_id).label;
+    if (!ctx->analysis) {
+        return;
+    }
+
+    const hash_analysis_t* analysis = ctx->analysis;
+    result->bits = analysis->bits;
+    result->max_length = analysis->max_length;
+    result->finished = g_atomic_int_get(&analysis->finished);
+    memcpy(result->lengths, analysis->lengths, sizeof(result->lengths));
+    result->all = analysis->all;
+    memcpy(result->avalanche, analysis->avalanche, sizeof(result->avalanche));
+    result->mean_bias = analysis->mean_bias;
+    result->max_bias = analysis->max_bias;
+    result->max_bias_input = analysis->max_bias_input;
+    result->max_bias_output = analysis->max_bias_output;
+    result->random_bias = analysis->random_bias;
+}
+
+/**
+ * \brief          Render one row of the distribution table
+ *
+ * \param[in]      win The sub window of the form
+ * \param[in]      row The row of the sub window
+ * \param[in]      name The inputs the row measures
+ * \param[in]      distribution The measures
+ */
+static void
+render_analysis_distribution(WINDOW* win, int row, const char* name,
+                             const hash_analysis_distribution_t* distribution) {
+    char empty[32];
+    char pairs[48];
+    snprintf(empty, sizeof(empty), "%llu/%.0f", (unsigned long long)distribution->empty,
+             distribution->expected_empty);
+    snprintf(pairs, sizeof(pairs), "%llu/%.0f", (unsigned long long)distribution->pairs,
+             distribution->expected_pairs);
+
+    mvwprintw(win, row, BH_FORM_X_PADDING, "  %-8s %-10llu %-10.3f %-+9.1f %-15s %-8llu %s", name,
+              (unsigned long long)distribution->inputs,
+              distribution->chi_square / distribution->freedom, distribution->z_score, empty,
+              (unsigned long long)distribution->max_load, pairs);
+}
+
+/**
+ * \brief          Render the results of the last run: the distribution of every length and of
+ *                 every input against a random function, the verdict on the collisions, and
+ *                 the avalanche matrix with one digit per cell
+ *
+ * \param[in]      win The sub window of the form
+ * \param[in]      starting_y The row of the first line of the results
+ */
+static void
+render_analysis_result(WINDOW* win, int starting_y) {
+    const hash_analysis_result_t* result = &s_analysis_result;
+
+    wattron(win, A_BOLD);
+    mvwprintw(win, starting_y, BH_FORM_X_PADDING,
+              "%s, every input of 1 to %u bytes and its %u one-bit flips", result->label,
+              result->max_length, 8 * result->max_length);
+    wattroff(win, A_BOLD);
+
+    if (!result->finished) {
+        wattron(win, COLOR_PAIR(BH_ERROR_COLOR_PAIR));
+        mvwprintw(win, starting_y + 1, BH_FORM_X_PADDING,
+                  "Stopped after %d inputs, the counters were not merged", result->attempts);
+        wattroff(win, COLOR_PAIR(BH_ERROR_COLOR_PAIR));
+        return;
+    }
+
+    mvwprintw(win, starting_y + 1, BH_FORM_X_PADDING, "  %-8s %-10s %-10s %-9s %-15s %-8s %s",
+              "Length", "Inputs", "Chi2/dof", "z-score", "Empty/random", "Max load",
+              "Pairs/random");
+    for (unsigned int length = 0; length < result->max_length; length++) {
+        char name[16];
+        snprintf(name, sizeof(name), "%u byte%s", length + 1, length > 0 ? "s" : "");
+        render_analysis_distribution(win, starting_y + 2 + length, name, &result->lengths[length]);
+    }
+    render_analysis_distribution(win, starting_y + 2 + result->max_length, "All", &result->all);
+
+    // The collisions the attacks find are the pairs, a bias shows as more or fewer of them
+    const hash_analysis_distribution_t* all = &result->all;
+    double ratio = all->expected_pairs > 0.0 ? all->pairs / all->expected_pairs : 0.0;
+    bool uniform = fabs(all->z_score) < BH_ANALYSIS_Z_LIMIT;
+    const char* verdict = uniform                ? "as uniform as a random function"
+                          : all->z_score < 0.0 ? "more uniform than a random function"
+                                               : "biased";
+    int color = uniform ? BH_SUCCESS_COLOR_PAIR : BH_ERROR_COLOR_PAIR;
+    wattron(win, COLOR_PAIR(color));
+    mvwprintw(win, starting_y + 3 + result->max_length, BH_FORM_X_PADDING,
+              "Verdict   : %s, %.3fx the collision pairs of a random function", verdict, ratio);
+    wattroff(win, COLOR_PAIR(color));
+
+    int avalanche_y = starting_y + BH_ANALYSIS_AVALANCHE_ROW;
+    mvwprintw(win, avalanche_y, BH_FORM_X_PADDING,
+              "Avalanche : mean |p - 1/2| %.4f (random %.4f), worst %.3f, input bit %u to "
+              "output bit %u",
+              result->mean_bias, result->random_bias, result->max_bias, result->max_bias_input,
+              result->max_bias_output);
+    mvwprintw(win, avalanche_y + 1, BH_FORM_X_PADDING,
+              "  Flip probability in tenths (5 is ideal), a group per input byte, output bits "
+              "high to low");
+
+    // One row per bit of an input byte, the groups side by side
+    for (unsigned int bit = 0; bit < 8; bit++) {
+        int row = avalanche_y + 2 + (int)bit;
+        mvwprintw(win, row, BH_FORM_X_PADDING, "  bit %u :", bit);
+        int col = BH_FORM_X_PADDING + 10;
+        for (unsigned int byte = 0; byte < result->max_length; byte++) {
+            for (unsigned int out = result->bits; out-- > 0;) {
+                int tenths = (int)(result->avalanche[8 * byte + bit][out] * 10.0);
+                mvwaddch(win, row, col++, '0' + (tenths > 9 ? 9 : tenths));
+            }
+            col++;
+        }
+    }
+
+    // Every input is hashed once and once more per bit it has
+    unsigned long long hashes = 0;
+    for (unsigned int length = 0; length < result->max_length; length++) {
+        hashes += result->lengths[length].inputs * (1 + 8 * (length + 1));
+    }
+    mvwprintw(win, starting_y + BH_ANALYSIS_RESULT_ROWS - 1, BH_FORM_X_PADDING,
+              "Run       : %d inputs, %llu hashes in %.3f s", result->attempts, hashes,
+              result->seconds);
+}
+
+/**
+ * \brief          Take the value from the form fields and start an analysis
+ *
+ * \param[in]      page The analysis page
+ * \param[in]      thread_pool The thread pool to use for running the workers
+ * \param[out]     ctx The context of the run shared between all worker threads
+ */
+static void
+hash_analysis_start(attack_page_t* page, GThreadPool* thread_pool, hash_collision_context_t* ctx) {
+    int hash_number = atoi(attack_page_field_buffer(page, HASH_ANALYSIS_FIELD_HASH));
+    unsigned int max_length = atoi(attack_page_field_buffer(page, HASH_ANALYSIS_FIELD_LENGTH));
+
+    const char* message = NULL;
+    if (hash_number < 1 || hash_number > hash_config_len) {
+        message = "The hash is the number of a hash function in the menu.";
+    } else if (!hash_analysis_supports(hash_config[hash_number - 1].id)) {
+        message = "Only the toy hashes are small enough to be analysed exhaustively.";
+    } else {
+        hash_analysis_run(hash_config[hash_number - 1].id, max_length, thread_pool, ctx);
+    }
+
+    if (message) {
+        attack_page_message(page, message);
+    }
+}
+
+static const attack_page_config_t s_analysis_page = {
+    .title = "[ Toy Hash Analysis ]",
+    .name = "analysis",
+    .description =
+        "Hashes every input up to L bytes and its one-bit flips, against a random function",
+    .fields = s_analysis_form_field_metadata,
+    .field_count = ARRAY_SIZE(s_analysis_form_field_metadata),
+    .button = &s_analysis_form_button,
+    .result_rows = BH_ANALYSIS_RESULT_ROWS,
+    .start = hash_analysis_start,
+    .progress = hash_analysis_progress_update,
+    .collect = hash_analysis_collect_result,
+    .render_result = render_analysis_result,
+};
+
+/**************************************************************
+                      EXTERNAL FUNCTIONS
+**************************************************************/
+
+/**
+ * \brief          Render the page that analyses a toy hash over every input of a few bytes.
+ *
+ * \param[in]      content_win The window to render the analysis page on
+ * \param[in]      header_win The window to render the header content, normally for
+ *                 the args of header_render
+ * \param[in]      footer_win The window to render the footer content, normally for
+ *                 the args of footer_render
+ * \param[out]     max_y The maximum height of the screen space that can be rendered. The
+ *                 value will be updated when a resize happens
+ * \param[out]     max_x The maximum width of the screen space that can be rendered. The
+ *                 value will be updated when a resize happens
+ * \param[in]      thread_pool The thread pool to use for running the analysis.
+ */
+void
+render_hash_analysis_page(WINDOW* content_win, WINDOW* header_win, WINDOW* footer_win, int* max_y,
+                          int* max_x, GThreadPool* thread_pool) {
+    attack_page_render(&s_analysis_page, content_win, header_win, footer_win, max_y, max_x,
+                       thread_pool);
+}
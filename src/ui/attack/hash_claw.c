@@ -0,0 +1,377 @@
+/**
+ * \file            hash_claw.c
+ * \brief           The page of the claw search: an input of family A and an input of family
+ *                  B whose digests share their leading bits, the structure behind
+ *                  chosen-prefix attacks. The inputs of a family start with its label, and
+ *                  each family may use its own hash function. Family A is built into a
+ *                  partitioned table first, then family B is streamed through it. With
+ *                  messages, the families are the variants of an honest and a fraudulent
+ *                  message instead, the meaningful collision of Yuval's birthday attack.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_claw.h"
+
+#define ACTION_SUBMIT 1
+
+/**
+ * \brief          The rows of the sub window below the button for the results of a search
+ */
+#define BH_CLAW_RESULT_ROWS 12
+
+static const struct FormButton s_claw_form_button = {"[ Run Search ]", "[ Running... ]",
+                                                      ACTION_SUBMIT};
+
+static const struct FormInputField s_claw_form_field_metadata[] = {
+    {"Hash A (menu number)", 7, 2, 0},
+    {"Hash B (menu number)", 7, 2, 0},
+    {"Compared Bits", 30, 2, BH_CLAW_MAX_BITS},
+    {"List A Size", 60000, 8, 0},
+    {"Max B Inputs", 60000, 8, 0},
+    {"Inputs (1 random, 2+ text)", 1, 1, 3}};
+
+/**
+ * \brief          The index of the input fields in s_claw_form_field_metadata
+ */
+enum hash_claw_field_index {
+    HASH_CLAW_FIELD_HASH_A = 0,
+    HASH_CLAW_FIELD_HASH_B,
+    HASH_CLAW_FIELD_BITS,
+    HASH_CLAW_FIELD_BUILD_SIZE,
+    HASH_CLAW_FIELD_MAX_ATTEMPTS,
+    HASH_CLAW_FIELD_INPUTS
+};
+
+/**
+ * \brief          The results of the last search, kept to render them again after a resize
+ */
+typedef struct {
+    int attempts;               ///< The inputs of family B probed
+    double build_seconds;       ///< The duration of the build of family A
+    double probe_seconds;       ///< The duration of the probes of family B
+    const char* labels[2];      ///< The label of the hash function of each family
+    char family_labels[2];      ///< The byte the inputs of each family start with
+    unsigned int bits;          ///< The leading digest bits compared
+    unsigned int build_size;    ///< The inputs of family A
+    unsigned int partitions;    ///< The partitions of the build table
+    double table_mib;           ///< The size of the build table
+    bool found;                 ///< Whether a claw was found
+    guint64 point;              ///< The inputs of family B probed up to the claw
+    char inputs[2][67];         ///< The inputs of the claw, from family A and B
+    char digest[17];            ///< The compared bits of the digests
+    const char* pair_name;      ///< The name of the pair of messages, NULL for random inputs
+    unsigned int choices[2];    ///< The choice points of the message of each family
+    char texts[2][BH_YUVAL_MAX_MESSAGE + 1]; ///< The variants of the claw as text
+    guint64 bytes_hashed;       ///< The bytes the message hashers hashed
+    guint64 message_bytes;      ///< The bytes of the variants they hashed, in full
+} hash_claw_result_t;
+
+// The results of the last search, rendered again when the page is restored
+static hash_claw_result_t s_claw_result;
+
+/****************************************************************
+ INTERNAL FUNCTION
+ ****************************************************************/
+
+/**
+ * \brief          Start a claw search: create the families and the build table, then submit
+ *                 the build workers. The last of them submits the probe workers.
+ *
+ * \param[in]      hash_a The hash function of family A
+ * \param[in]      hash_b The hash function of family B
+ * \param[in]      bits The leading digest bits compared
+ * \param[in]      build_size The number of inputs of family A
+ * \param[in]      max_attempts The most inputs of family B to probe
+ * \param[in]      messages The built-in pair of messages plus one, 0 for random inputs
+ * \param[in]      thread_pool The thread pool to run the workers on
+ * \param[out]     ctx The context of the run shared between all worker threads
+ */
+static void
+hash_claw_run(enum hash_function_ids hash_a, enum hash_function_ids hash_b, unsigned int bits,
+              unsigned int build_size, unsigned int max_attempts, unsigned int messages,
+              GThreadPool* thread_pool, hash_collision_context_t* ctx) {
+    if (max_attempts == 0) {
+        max_attempts = 10000; // Default to 10,000 attempts for zero attempts
+    }
+
+    ctx->hash_id = hash_a;
+    ctx->claw = hash_claw_search_create(hash_a, hash_b, bits, build_size);
+    if (!ctx->claw) {
+        render_full_page_error_exit(stdscr, 0, 0, "Memory allocation failed for claw table.");
+    }
+    if (messages > 0 && !hash_claw_search_use_messages(ctx->claw, messages - 1)) {
+        render_full_page_error_exit(stdscr, 0, 0, "Memory allocation failed for claw messages.");
+    }
+
+    // The inputs of family A are regenerated from their index to confirm a claw
+    attack_page_prepare_run(ctx, thread_pool, max_attempts);
+    hash_collision_submit_workers(ctx, HASH_PASS_CLAW_BUILD);
+}
+
+/**
+ * \brief          Update the progress bar while a claw search runs, with the build of family
+ *                 A first and the probes of family B after it
+ *
+ * \param[in]      page The claw search page
+ * \param[in]      ctx The context of the running search
+ */
+static void
+hash_claw_run_progress_update(attack_page_t* page, hash_collision_context_t* ctx) {
+    if (g_atomic_int_get((gint*)&ctx->pass_one_pending) > 0 && ctx->claw->build_size > 0) {
+        int built = g_atomic_int_get(&ctx->claw->built);
+        attack_page_status(page, "Building: %d%% (%d/%u inputs of family A)",
+                           (int)((gint64)built * 100 / ctx->claw->build_size), built,
+                           ctx->claw->build_size);
+        return;
+    }
+
+    attack_page_progress(page, g_atomic_int_get(&ctx->result->attempts_made),
+                         (int)ctx->max_attempts);
+}
+
+/**
+ * \brief          Keep the results of a finished search
+ *
+ * \param[in]      ctx The context of the finished run
+ */
+static void
+hash_claw_collect_result(hash_collision_context_t* ctx) {
+    hash_collision_stats_t* stats = &ctx->result->stats;
+    hash_claw_result_t* result = &s_claw_result;
+    memset(result, 0, sizeof(*result));
+
+    result->attempts = ctx->result->attempts_made;
+    if (!ctx->claw) {
+        return;
+    }
+
+    hash_claw_search_t* claw = ctx->claw;
+    gint64 build_end = claw->build_finished_at ? claw->build_finished_at : stats->finished_at;
+    result->build_seconds = (double)(build_end - stats->started_at) / G_USEC_PER_SEC;
+    result->probe_seconds = stats->finished_at > build_end
+                                ? (double)(stats->finished_at - build_end) / G_USEC_PER_SEC
+                                : 0.0;
+
+    for (int family = HASH_CLAW_FAMILY_A; family <= HASH_CLAW_FAMILY_B; family++) {
+        result->labels[family] = get_hash_config_item(claw->hash_ids[family]).label;
+        result->family_labels[family] = claw->labels[family];
+    }
+    result->bits = claw->bits;
+    result->build_size = claw->build_size;
+    result->partitions = claw->table->partition_count;
+    result->table_mib = (double)hash_claw_table_memory_size(claw->table) / (1024.0 * 1024.0);
+
+    result->found = claw->found;
+    result->point = claw->point;
+    snprintf(result->inputs[0], sizeof(result->inputs[0]), "%s",
+             ctx->result->collision_input_1 ? ctx->result->collision_input_1 : "-");
+    snprintf(result->inputs[1], sizeof(result->inputs[1]), "%s",
+             ctx->result->collision_input_2 ? ctx->result->collision_input_2 : "-");
+    snprintf(result->digest, sizeof(result->digest), "%s",
+             ctx->result->collision_hash_hex ? ctx->result->collision_hash_hex : "-");
+
+    if (!claw->messages[HASH_CLAW_FAMILY_A]) {
+        return;
+    }
+
+    result->pair_name = claw->messages[HASH_CLAW_FAMILY_A]->name;
+    result->bytes_hashed = claw->bytes_hashed;
+    result->message_bytes = claw->message_bytes;
+    for (int family = HASH_CLAW_FAMILY_A; family <= HASH_CLAW_FAMILY_B; family++) {
+        result->choices[family] = claw->messages[family]->choice_count;
+        if (!claw->found) {
+            snprintf(result->texts[family], sizeof(result->texts[family]), "-");
+            continue;
+        }
+
+        // The text is shown on one row, its line breaks as spaces
+        size_t len = hash_yuval_variant(claw->messages[family], claw->found_variants[family],
+                                        (uint8_t*)result->texts[family]);
+        result->texts[family][len] = '\0';
+        for (size_t i = 0; i < len; i++) {
+            if (result->texts[family][i] == '\n') {
+                result->texts[family][i] = ' ';
+            }
+        }
+    }
+}
+
+/**
+ * \brief          Render the two variants of the messages of a claw, each clipped to the
+ *                 width of the sub window, and the bytes the hashers saved
+ *
+ * \param[in]      win The sub window of the form
+ * \param[in]      starting_y The row of the first variant
+ */
+static void
+render_claw_messages(WINDOW* win, int starting_y) {
+    const hash_claw_result_t* result = &s_claw_result;
+    int width = COLS - 2 * BH_FORM_X_PADDING - 14;
+    if (width < 8) {
+        width = 8;
+    }
+
+    mvwprintw(win, starting_y, BH_FORM_X_PADDING, "  Honest  : %.*s", width, result->texts[0]);
+    mvwprintw(win, starting_y + 1, BH_FORM_X_PADDING, "  Forged  : %.*s", width, result->texts[1]);
+    mvwprintw(win, starting_y + 2, BH_FORM_X_PADDING, "  Digests : %s...", result->digest);
+
+    double saved = result->message_bytes
+                       ? 100.0 * (1.0 - (double)result->bytes_hashed / result->message_bytes)
+                       : 0.0;
+    mvwprintw(win, starting_y + 3, BH_FORM_X_PADDING,
+              "Hashed    : %llu of %llu bytes of the variants, %.1f%% saved by the prefix states",
+              (unsigned long long)result->bytes_hashed, (unsigned long long)result->message_bytes,
+              saved);
+}
+
+/**
+ * \brief          Render the results of the last search: the two families, where the claw
+ *                 was found against the 2^n / N inputs of family B expected for it, and the
+ *                 input of each family
+ *
+ * \param[in]      win The sub window of the form
+ * \param[in]      starting_y The row of the first line of the results
+ */
+static void
+render_claw_result(WINDOW* win, int starting_y) {
+    const hash_claw_result_t* result = &s_claw_result;
+
+    double expected = result->build_size ? ldexp(1.0, result->bits) / result->build_size : 0.0;
+
+    wattron(win, A_BOLD);
+    mvwprintw(win, starting_y, BH_FORM_X_PADDING,
+              "Claw on the first %u bits of %s (family A) and %s (family B)", result->bits,
+              result->labels[0], result->labels[1]);
+    wattroff(win, A_BOLD);
+
+    if (result->pair_name) {
+        mvwprintw(win, starting_y + 2, BH_FORM_X_PADDING,
+                  "Family A  : %u of 2^%u honest \"%s\" variants, %u partitions, %.2f MiB, "
+                  "%.3f s",
+                  result->build_size, result->choices[0], result->pair_name,
+                  result->partitions, result->table_mib, result->build_seconds);
+        mvwprintw(win, starting_y + 3, BH_FORM_X_PADDING,
+                  "Family B  : %d of 2^%u forged variants probed in %.3f s", result->attempts,
+                  result->choices[1], result->probe_seconds);
+    } else {
+        mvwprintw(win, starting_y + 2, BH_FORM_X_PADDING,
+                  "Family A  : %u inputs starting with '%c', %u partitions, %.2f MiB, %.3f s",
+                  result->build_size, result->family_labels[0], result->partitions,
+                  result->table_mib, result->build_seconds);
+        mvwprintw(win, starting_y + 3, BH_FORM_X_PADDING,
+                  "Family B  : %d inputs starting with '%c' probed in %.3f s", result->attempts,
+                  result->family_labels[1], result->probe_seconds);
+    }
+
+    int color = result->found ? BH_SUCCESS_COLOR_PAIR : BH_ERROR_COLOR_PAIR;
+    wattron(win, COLOR_PAIR(color));
+    if (result->found) {
+        mvwprintw(win, starting_y + 5, BH_FORM_X_PADDING,
+                  "Claw      : found after %llu inputs of family B, 2^%u / %u = %.0f expected",
+                  (unsigned long long)result->point, result->bits, result->build_size, expected);
+    } else {
+        mvwprintw(win, starting_y + 5, BH_FORM_X_PADDING,
+                  "Claw      : not found in %d inputs of family B, 2^%u / %u = %.0f expected",
+                  result->attempts, result->bits, result->build_size, expected);
+    }
+    wattroff(win, COLOR_PAIR(color));
+
+    if (result->pair_name) {
+        render_claw_messages(win, starting_y + 6);
+        return;
+    }
+
+    mvwprintw(win, starting_y + 6, BH_FORM_X_PADDING, "  A input : %s", result->inputs[0]);
+    mvwprintw(win, starting_y + 7, BH_FORM_X_PADDING, "  B input : %s", result->inputs[1]);
+    mvwprintw(win, starting_y + 8, BH_FORM_X_PADDING, "  Digests : %s...", result->digest);
+}
+
+/**
+ * \brief          Take the value from the form fields and start a claw search
+ *
+ * \param[in]      page The claw search page
+ * \param[in]      thread_pool The thread pool to use for running the search
+ * \param[out]     ctx The context of the run shared between all worker threads
+ */
+static void
+hash_claw_start(attack_page_t* page, GThreadPool* thread_pool, hash_collision_context_t* ctx) {
+    int hash_a = atoi(attack_page_field_buffer(page, HASH_CLAW_FIELD_HASH_A));
+    int hash_b = atoi(attack_page_field_buffer(page, HASH_CLAW_FIELD_HASH_B));
+    unsigned int bits = atoi(attack_page_field_buffer(page, HASH_CLAW_FIELD_BITS));
+    unsigned int build_size = atoi(attack_page_field_buffer(page, HASH_CLAW_FIELD_BUILD_SIZE));
+    unsigned int attempts = atoi(attack_page_field_buffer(page, HASH_CLAW_FIELD_MAX_ATTEMPTS));
+    unsigned int inputs = atoi(attack_page_field_buffer(page, HASH_CLAW_FIELD_INPUTS));
+
+    // Every input of a family must be its own variant of the message
+    hash_yuval_template_t messages[2];
+    bool with_messages = inputs >= 2 && inputs - 2 < hash_yuval_pair_count()
+                         && hash_yuval_template_parse(inputs - 2, 0, &messages[0])
+                         && hash_yuval_template_parse(inputs - 2, 1, &messages[1]);
+
+    const char* message = NULL;
+    if (hash_a < 1 || hash_a > hash_config_len || hash_b < 1 || hash_b > hash_config_len) {
+        message = "A hash is the number of a hash function in the menu.";
+    } else if (!hash_config_init(&hash_config[hash_a - 1])
+               || !hash_config_init(&hash_config[hash_b - 1])) {
+        message = BH_HASH_UNAVAILABLE_MESSAGE;
+    } else if (bits > hash_config[hash_a - 1].bits || bits > hash_config[hash_b - 1].bits) {
+        message = "The compared bits can not be longer than either digest.";
+    } else if (inputs >= 2 && !with_messages) {
+        message = "The inputs are 1 for random inputs or the number of a pair of messages + 1.";
+    } else if (with_messages
+               && (build_size > hash_yuval_variant_count(&messages[0])
+                   || attempts > hash_yuval_variant_count(&messages[1]))) {
+        message = "A family can not have more inputs than its message has variants.";
+    } else {
+        hash_claw_run(hash_config[hash_a - 1].id, hash_config[hash_b - 1].id, bits, build_size,
+                      attempts, with_messages ? inputs - 1 : 0, thread_pool, ctx);
+    }
+
+    if (message) {
+        attack_page_message(page, message);
+    }
+}
+
+static const attack_page_config_t s_claw_page = {
+    .title = "[ Claw Search ]",
+    .name = "claw search",
+    .description = "Finds inputs 'A' || x and 'B' || y whose digests share their first bits",
+    .fields = s_claw_form_field_metadata,
+    .field_count = ARRAY_SIZE(s_claw_form_field_metadata),
+    .button = &s_claw_form_button,
+    .result_rows = BH_CLAW_RESULT_ROWS,
+    .start = hash_claw_start,
+    .progress = hash_claw_run_progress_update,
+    .collect = hash_claw_collect_result,
+    .render_result = render_claw_result,
+};
+
+/**************************************************************
+                      EXTERNAL FUNCTIONS
+**************************************************************/
+
+/**
+ * \brief          Render the page that searches for a claw between two input families.
+ *
+ * \param[in]      content_win The window to render the claw search page on
+ * \param[in]      header_win The window to render the header content, normally for
+ *                 the args of header_render
+ * \param[in]      footer_win The window to render the footer content, normally for
+ *                 the args of footer_render
+ * \param[out]     max_y The maximum height of the screen space that can be rendered. The
+ *                 value will be updated when a resize happens
+ * \param[out]     max_x The maximum width of the screen space that can be rendered. The
+ *                 value will be updated when a resize happens
+ * \param[in]      thread_pool The thread pool to use for running the search.
+ */
+void
+render_hash_claw_page(WINDOW* content_win, WINDOW* header_win, WINDOW* footer_win, int* max_y,
+                      int* max_x, GThreadPool* thread_pool) {
+    attack_page_render(&s_claw_page, content_win, header_win, footer_win, max_y, max_x,
+                       thread_pool);
+}
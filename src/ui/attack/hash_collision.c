@@ -24,9 +24,34 @@ static const unsigned short s_hash_form_buttons_metadata_len =
     ARRAY_SIZE(s_hash_form_buttons_metadata);
 
 static const struct FormInputField const s_hash_form_field_metadata[] = {
-    {"Max Attempts", 10000, 6}};
+    {"Max Attempts", 10000, 6, 0},
+    {"Memory budget (MiB)", BH_PLAN_DEFAULT_BUDGET_MIB, 6, 0},
+    {"Strategy (1 Auto, 2 Table, 3 Compact, 4 DP, 5 Cycle)", HASH_STRATEGY_AUTO, 1,
+     HASH_STRATEGY_CYCLE},
+    {"Engine (1 Shared, 2 Sharded)", HASH_ENGINE_SHARED, 1, HASH_ENGINE_SHARDED},
+    {"Table (1 Flat, 2 Chained)", HASH_TABLE_FLAT, 1, HASH_TABLE_CHAINED},
+    {"Prefilter (1 Off, 2 Bloom, 3 Two-pass)", HASH_PREFILTER_OFF, 1, HASH_PREFILTER_TWO_PASS},
+    {"Buckets (1 SipHash, 2 djb2)", HASH_BUCKET_SIPHASH, 1, HASH_BUCKET_DJB2},
+    {"Flood demo (1 Off, 2 On)", 1, 1, 2},
+    {"Inputs (1 Random, 2 Counter, 3 Wordlist, 4 Block)", HASH_INPUTS_RANDOM, 1,
+     HASH_INPUTS_BLOCK}};
 static const unsigned short s_hash_form_field_metadata_len = ARRAY_SIZE(s_hash_form_field_metadata);
 
+/**
+ * \brief          The index of every input field in s_hash_form_field_metadata
+ */
+enum hash_form_field_index {
+    HASH_FORM_FIELD_MAX_ATTEMPTS = 0,
+    HASH_FORM_FIELD_BUDGET,
+    HASH_FORM_FIELD_STRATEGY,
+    HASH_FORM_FIELD_ENGINE,
+    HASH_FORM_FIELD_TABLE,
+    HASH_FORM_FIELD_PREFILTER,
+    HASH_FORM_FIELD_BUCKETS,
+    HASH_FORM_FIELD_FLOOD,
+    HASH_FORM_FIELD_INPUTS
+};
+
 static form_manager_t* manager = NULL;
 
 // This variable temporarily tracks if the button is highlighted before calling
@@ -34,6 +59,9 @@ static form_manager_t* manager = NULL;
 // is used ONLY in this scope
 static bool is_btn_highlighted = false;
 
+// The measured cost of one hash of the page hash function, used to predict the run time
+static double s_seconds_per_hash = 0.0;
+
 /****************************************************************
  INTERNAL FUNCTION
  ****************************************************************/
@@ -43,6 +71,142 @@ hash_collision_form_field_get(int index) {
     return manager->fields[index];
 }
 
+/**
+ * \brief          Describe a run to the planner, with the same engine and prefilter
+ *                 adjustments hash_collision_simulation_run makes
+ *
+ * \param[out]     request Receives the description of the run
+ * \param[in]      hash_id The hash function of the run
+ * \param[in]      max_attempts The maximum number of attempts of the run
+ * \param[in]      worker_count The number of workers of the run
+ * \param[in]      budget_mib The memory budget in MiB
+ * \param[in]      engine The engine chosen on the form
+ * \param[in]      layout The table layout chosen on the form
+ * \param[in]      prefilter The prefilter chosen on the form
+ * \param[in]      flood Whether the flood demonstration keys are inserted
+ */
+static void
+hash_collision_plan_request(hash_plan_request_t* request, enum hash_function_ids hash_id,
+                            unsigned int max_attempts, int worker_count, unsigned int budget_mib,
+                            hash_engine_t engine, hash_table_layout_t layout,
+                            hash_prefilter_mode_t prefilter, bool flood) {
+    request->bits = get_hash_config_item(hash_id).bits;
+    request->hash_hex_length = get_hash_hex_length(hash_id);
+    request->digest_bytes = get_hash_config(hash_id)->digest_bytes;
+    request->max_attempts = max_attempts;
+    request->extra_entries = flood ? BH_FLOOD_KEY_COUNT : 0;
+    request->worker_count = worker_count;
+    request->budget_bytes = (size_t)budget_mib * 1024 * 1024;
+    request->two_pass = prefilter == HASH_PREFILTER_TWO_PASS;
+    request->sharded = engine == HASH_ENGINE_SHARDED && !request->two_pass;
+    request->layout = layout == HASH_TABLE_CHAINED ? HASH_TABLE_CHAINED : HASH_TABLE_FLAT;
+    request->bloom = prefilter == HASH_PREFILTER_BLOOM;
+    request->seconds_per_hash = s_seconds_per_hash;
+}
+
+/**
+ * \brief          Allocate the tables of a full table run: the shared table or the shards,
+ *                 the prefilter and the two-pass candidates. A failed allocation frees what
+ *                 was allocated, so the run can fall back to a strategy that needs less.
+ *
+ * \param[in,out]  ctx The context of the run, with worker_count and bucket_hasher set
+ * \param[in]      max_attempts The maximum number of attempts of the run
+ * \param[in]      engine The engine of the run
+ * \param[in]      layout The memory layout of the digest tables
+ * \param[in]      prefilter The prefilter of the run
+ * \param[in]      flood_entries The number of flood keys the tables also hold
+ * \return         true on success, false on memory allocation failure
+ */
+static bool
+hash_collision_allocate_tables(hash_collision_context_t* ctx, unsigned int max_attempts,
+                               hash_engine_t engine, hash_table_layout_t layout,
+                               hash_prefilter_mode_t prefilter, unsigned int flood_entries) {
+    // Every attempt stores one digest, and the table is sized for all of them
+    unsigned int expected_entries = max_attempts + flood_entries;
+    if (prefilter == HASH_PREFILTER_TWO_PASS) {
+        // Only the digests the filter reports as maybe seen are stored, which is below
+        // 1% of the attempts with the default filter size
+        expected_entries = max_attempts / 32 + 1024 + flood_entries;
+
+        ctx->candidates = hash_table_create(next_prime(expected_entries), &ctx->bucket_hasher);
+        if (!ctx->candidates) {
+            return false;
+        }
+    }
+
+    bool allocated = true;
+    if (engine == HASH_ENGINE_SHARDED) {
+        // Every worker owns one shard with its own table and prefilter. A worker waits on
+        // the rings of the others, so every worker needs a thread of the pool at once.
+        int max_threads = g_thread_pool_get_max_threads(ctx->thread_pool);
+        if (max_threads > 0 && ctx->worker_count > max_threads) {
+            ctx->worker_count = max_threads;
+        }
+        ctx->shards = hash_shard_engine_create(ctx->worker_count, expected_entries, layout,
+                                               prefilter == HASH_PREFILTER_BLOOM,
+                                               &ctx->bucket_hasher,
+                                               get_hash_config(ctx->hash_id)->digest_bytes);
+        allocated = ctx->shards != NULL;
+    } else {
+        allocated = hash_digest_store_init(&ctx->shared, layout, expected_entries, false,
+                                           &ctx->bucket_hasher);
+
+        // The filter sees every attempt, even when the table only stores the candidates
+        if (allocated && prefilter != HASH_PREFILTER_OFF) {
+            ctx->shared.filter = hash_filter_create(max_attempts, BH_FILTER_BITS_PER_ENTRY);
+            allocated = ctx->shared.filter != NULL;
+        }
+    }
+
+    if (!allocated) {
+        hash_digest_store_clear(&ctx->shared);
+        hash_table_destroy(ctx->candidates);
+        ctx->candidates = NULL;
+    }
+    return allocated;
+}
+
+/**
+ * \brief          Allocate what the planned strategy needs: the full tables, or the compact
+ *                 table of the digest fingerprints or of the trail ends. The cycle search
+ *                 needs nothing.
+ *
+ * \param[in,out]  ctx The context of the run, with plan, worker_count and bucket_hasher set
+ * \param[in]      max_attempts The maximum number of attempts of the run
+ * \param[in]      engine The engine of the run
+ * \param[in]      layout The memory layout of the digest tables
+ * \param[in]      prefilter The prefilter of the run
+ * \param[in]      flood_entries The number of flood keys the tables also hold
+ * \return         true on success, false on memory allocation failure
+ */
+static bool
+hash_collision_allocate_plan(hash_collision_context_t* ctx, unsigned int max_attempts,
+                             hash_engine_t engine, hash_table_layout_t layout,
+                             hash_prefilter_mode_t prefilter, unsigned int flood_entries) {
+    switch (ctx->plan.strategy) {
+        case HASH_STRATEGY_TABLE:
+            return hash_collision_allocate_tables(ctx, max_attempts, engine, layout, prefilter,
+                                                  flood_entries);
+
+        case HASH_STRATEGY_COMPACT: {
+            // Never more distinct digests than the hash can produce
+            double space = ldexp(1.0, get_hash_config_item(ctx->hash_id).bits);
+            ctx->compact = hash_compact_table_create(space < max_attempts ? (size_t)space
+                                                                          : max_attempts);
+            return ctx->compact != NULL;
+        }
+
+        case HASH_STRATEGY_DISTINGUISHED: {
+            double distance = ldexp(1.0, (int)ctx->plan.distinguished_bits);
+            ctx->compact = hash_compact_table_create(
+                (size_t)(ctx->plan.expected_hashes / distance) + ctx->worker_count);
+            return ctx->compact != NULL;
+        }
+
+        default: return true;
+    }
+}
+
 /**
  * \brief          Simulates a hash collision using the Birthday Attack algorithm.
  *                 It will first create a hash table with a size based on the maximum number of attempts.
@@ -52,6 +216,31 @@ hash_collision_form_field_get(int index) {
  *                 indicating no collision.
  *
  * \param[in]      max_attempts The maximum number of attempts to find a collision before exiting.
+ * \param[in]      engine Where the workers store the digests. The sharded engine gives every
+ *                 worker its own part of the digests, so no table lock is shared. The
+ *                 two-pass prefilter always runs on the shared engine.
+ * \param[in]      layout The memory layout of the digest tables. The flat layout probes
+ *                 16 slots with one SIMD compare of their tags, the chained layout walks a
+ *                 linked list per bucket.
+ * \param[in]      prefilter The prefilter to place in front of the hash table. The two-pass mode
+ *                 keeps only the filter in memory while hashing, and replays the inputs to
+ *                 resolve the digests the filter reports as maybe seen.
+ * \param[in]      buckets How the tables place the digests in their buckets. SipHash is keyed
+ *                 with a random key for the run, djb2 is unkeyed and can be flooded.
+ * \param[in]      flood Whether BH_FLOOD_KEY_COUNT keys crafted to share one djb2 bucket are
+ *                 inserted at the start of the run, to compare the chains of both functions
+ * \param[in]      inputs How the inputs are made. The counter inputs are distinct by
+ *                 construction, so a collision is never one input found twice. The wordlist
+ *                 inputs are the lines of ctx->wordlist, which must be open, and the run
+ *                 makes at most one attempt per line. The block inputs are counter inputs
+ *                 zero-filled to the most one block holds, hashed by a single-block kernel.
+ *                 They only apply to the full table and the compact entries, the walks hash
+ *                 digests.
+ * \param[in]      budget_mib The memory the run may use in MiB. The planner picks the
+ *                 strategy that fits, and falls back to one that needs less memory when the
+ *                 allocation fails anyway.
+ * \param[in]      strategy The strategy chosen on the form, or HASH_STRATEGY_AUTO. The engine,
+ *                 layout, prefilter, buckets and flood only apply to the full table.
  * \param[in]      thread_pool The thread pool to use for running the hash collision simulation.
  *                 This allows for concurrent execution of the simulation.
  * \param[out]     ctx The context of the birthday attack simulation shared between all worker threads and
@@ -60,22 +249,87 @@ hash_collision_form_field_get(int index) {
  * \return         hash_collision_simulation_result_t*
  */
 static void
-hash_collision_simulation_run(unsigned int max_attempts, GThreadPool* thread_pool,
-                              hash_collision_context_t* ctx) {
+hash_collision_simulation_run(unsigned int max_attempts, hash_engine_t engine,
+                              hash_table_layout_t layout, hash_prefilter_mode_t prefilter,
+                              hash_bucket_mode_t buckets, bool flood, hash_input_mode_t inputs,
+                              unsigned int budget_mib, hash_strategy_t strategy,
+                              GThreadPool* thread_pool, hash_collision_context_t* ctx) {
     if (max_attempts <= 0) {
         max_attempts = 10000; // Default to 10,000 attempts for negative or zero attempts
     }
+    if (prefilter < HASH_PREFILTER_OFF || prefilter > HASH_PREFILTER_TWO_PASS) {
+        prefilter = HASH_PREFILTER_OFF;
+    }
+    if (engine != HASH_ENGINE_SHARDED || prefilter == HASH_PREFILTER_TWO_PASS) {
+        engine = HASH_ENGINE_SHARED;
+    }
+    if (layout != HASH_TABLE_CHAINED) {
+        layout = HASH_TABLE_FLAT;
+    }
+    if (inputs == HASH_INPUTS_WORDLIST && ctx->wordlist->lines < max_attempts) {
+        max_attempts = (unsigned int)ctx->wordlist->lines;
+    }
+    ctx->worker_count = g_thread_pool_get_max_threads(thread_pool);
+    ctx->thread_pool = thread_pool;
 
-    // The desired table size is 1.3 times the maximum attempts so that
-    // the load factor (n / table_size) should ideally stay under 0.75.
-    unsigned int desired_table_size = (max_attempts * 1.3);
-    unsigned int table_size = next_prime(desired_table_size);
-    hash_table_t* table = hash_table_create(table_size);
+    if (!hash_bucket_hasher_init(&ctx->bucket_hasher, buckets)) {
+        render_full_page_error_exit(stdscr, 0, 0, "Failed to draw the bucket hash key.");
+    }
 
-    if (!table) {
-        render_full_page_error_exit(stdscr, 0, 0, "Memory allocation failed for hash table.");
+    // The predictions are only estimates, so a plan that fails to allocate falls back to
+    // the next strategy, down to the cycle search that needs no table
+    unsigned int flood_entries = flood ? BH_FLOOD_KEY_COUNT : 0;
+    hash_plan_request_t request;
+    hash_collision_plan_request(&request, ctx->hash_id, max_attempts, ctx->worker_count,
+                                budget_mib, engine, layout, prefilter, flood);
+    hash_plan_attack(&request, strategy, &ctx->plan);
+    while (!hash_collision_allocate_plan(ctx, max_attempts, engine, layout, prefilter,
+                                         flood_entries)) {
+        hash_plan_fall_back(&request, &ctx->plan);
     }
-    ctx->shared_table = table;
+
+    // The other strategies have no digest table for the engine, prefilter or flood
+    if (ctx->plan.strategy != HASH_STRATEGY_TABLE) {
+        engine = HASH_ENGINE_SHARED;
+        prefilter = HASH_PREFILTER_OFF;
+        flood = false;
+    }
+    ctx->engine = engine;
+
+    ctx->prefilter = prefilter;
+    bool walks = ctx->plan.strategy == HASH_STRATEGY_DISTINGUISHED
+                 || ctx->plan.strategy == HASH_STRATEGY_CYCLE;
+    bool deterministic = inputs == HASH_INPUTS_COUNTER || inputs == HASH_INPUTS_WORDLIST
+                         || inputs == HASH_INPUTS_BLOCK;
+    ctx->input_mode = deterministic && !walks ? inputs : HASH_INPUTS_RANDOM;
+    if (ctx->input_mode == HASH_INPUTS_BLOCK) {
+        ctx->block_input_bytes = hash_collision_block_setup(ctx->hash_id, &ctx->block_kernel);
+    }
+
+    // Craft the flood keys against the djb2 buckets of the table they go to. Every shard
+    // has the same size, so the keys land in one chain of whichever shard owns them.
+    if (flood) {
+        const hash_digest_store_t* target = ctx->shards ? &ctx->shards->shards[0] : &ctx->shared;
+        size_t prefix_length = get_hash_hex_length(ctx->hash_id);
+        if (prefix_length < 8) {
+            prefix_length = 8; // The shard owner is read from the first 8 characters
+        }
+
+        ctx->flood_key_size = prefix_length + BH_FLOOD_SUFFIX_CHARS + 1;
+        ctx->flood_keys =
+            hash_bucket_djb2_flood_keys(hash_digest_store_bucket_modulus(target), prefix_length,
+                                        BH_FLOOD_KEY_COUNT, &ctx->flood_count);
+        if (!ctx->flood_keys) {
+            render_full_page_error_exit(stdscr, 0, 0, "Memory allocation failed for flood keys.");
+        }
+        ctx->flood_worker = ctx->shards && ctx->flood_count > 0
+                                ? hash_shard_owner(ctx->shards, ctx->flood_keys)
+                                : 0;
+    }
+
+    // Seed the inputs that can be regenerated: the two-pass replay, the compact entries and
+    // the walk starts
+    RAND_bytes((unsigned char*)&ctx->run_seed, sizeof(ctx->run_seed));
     ctx->table_mutex = g_new0(GMutex, 1);
     g_mutex_init(ctx->table_mutex);
 
@@ -91,28 +345,37 @@ hash_collision_simulation_run(unsigned int max_attempts, GThreadPool* thread_poo
     }
 
     ctx->result->attempts_made = 0;
-
-    // Divide work among threads
-    int num_threads = g_thread_pool_get_max_threads(thread_pool);
-    unsigned int attempts_per_thread = max_attempts / num_threads;
-    unsigned int remaining_attempts = max_attempts % num_threads;
-
-    // Submit work to thread pool
-    for (int i = 0; i < num_threads; i++) {
-        WorkerData* worker_data = g_new(WorkerData, 1);
-        worker_data->ctx = ctx;
-        worker_data->attempts_to_make = attempts_per_thread + (i == 0 ? remaining_attempts : 0);
-        worker_data->worker_id = i;
-
-        GError* error = NULL;
-        g_thread_pool_push(thread_pool, worker_data, &error);
-
-        if (error) {
-            g_printerr("Failed to submit work: %s\n", error->message);
-            g_error_free(error);
-            g_free(worker_data);
-        }
+    ctx->replay_attempts = 0;
+
+    memset(&ctx->result->stats, 0, sizeof(ctx->result->stats));
+    ctx->result->stats.plan = ctx->plan;
+    ctx->result->stats.engine = engine;
+    ctx->result->stats.layout = layout;
+    ctx->result->stats.prefilter = prefilter;
+    ctx->result->stats.input_mode = ctx->input_mode;
+    ctx->result->stats.run_seed = ctx->run_seed;
+    if (ctx->input_mode == HASH_INPUTS_WORDLIST) {
+        ctx->result->stats.wordlist_lines = ctx->wordlist->lines;
+        ctx->result->stats.wordlist_bytes = ctx->wordlist->map->size;
+        ctx->result->stats.wordlist_index_time = ctx->wordlist->index_time;
+        ctx->result->stats.wordlist_threads = ctx->wordlist->threads;
+    }
+    if (ctx->input_mode == HASH_INPUTS_BLOCK) {
+        ctx->result->stats.block_input_bytes = ctx->block_input_bytes;
+        ctx->result->stats.block_bytes = ctx->block_kernel.block_bytes;
+        ctx->result->stats.block_rate =
+            hash_collision_block_rate(ctx->hash_id, &ctx->block_kernel);
     }
+    ctx->result->stats.bucket_mode = ctx->bucket_hasher.mode;
+    ctx->result->stats.filter_bytes = ctx->shards ? hash_shard_engine_filter_bytes(ctx->shards)
+                                                  : hash_filter_memory_size(ctx->shared.filter);
+
+    // Divide work among threads and submit it to the thread pool
+    ctx->max_attempts = max_attempts;
+    ctx->result->stats.started_at = g_get_monotonic_time();
+
+    hash_collision_submit_workers(ctx, prefilter == HASH_PREFILTER_TWO_PASS ? HASH_PASS_FILTER
+                                                                            : HASH_PASS_SINGLE);
 }
 
 /**************************************************************
@@ -194,7 +457,7 @@ hash_form_create_sub_win(WINDOW* win, int max_y, int max_x) {
         manager->sub_win = NULL;
     }
 
-    const int sub_win_rows_count = s_hash_form_field_metadata_len + 12;
+    const int sub_win_rows_count = s_hash_form_field_metadata_len + 18;
     const int sub_win_cols_count = max_x - BH_FORM_X_PADDING - BH_FORM_X_PADDING;
 
     // Create a sub-window for the form with extra space for the button
@@ -208,6 +471,23 @@ hash_form_create_sub_win(WINDOW* win, int max_y, int max_x) {
     post_form(manager->form);
 }
 
+/**
+ * \brief          Render why a run can not start on the row below the button
+ *
+ * \param[in]      message The reason the run can not start
+ */
+static void
+render_run_error(const char* message) {
+    uint8_t row = s_hash_form_field_metadata_len + 1 + 2 + 3 + 1;
+    for (int col = BH_FORM_X_PADDING; col <= COLS - BH_FORM_X_PADDING; col++) {
+        mvwaddch(manager->sub_win, row, col, ' ');
+    }
+    wattron(manager->sub_win, A_BOLD | COLOR_PAIR(BH_ERROR_COLOR_PAIR));
+    mvwprintw(manager->sub_win, row, BH_FORM_X_PADDING, "%s", message);
+    wattroff(manager->sub_win, A_BOLD | COLOR_PAIR(BH_ERROR_COLOR_PAIR));
+    wrefresh(manager->sub_win);
+}
+
 /**
  * \brief          Take the value from the form field as arguments for simulating the
  *                 birthday attack. The result will be stored back to the arguments
@@ -220,8 +500,334 @@ hash_form_create_sub_win(WINDOW* win, int max_y, int max_x) {
  */
 static void
 run_hash_collision_from_input(GThreadPool* thread_pool, hash_collision_context_t* ctx) {
-    unsigned int attempts = atoi(field_buffer(hash_collision_form_field_get(0), 0));
-    return hash_collision_simulation_run(attempts, thread_pool, ctx);
+    if (!hash_config_init(get_hash_config(ctx->hash_id))) {
+        render_run_error(BH_HASH_UNAVAILABLE_MESSAGE);
+        return;
+    }
+
+    unsigned int attempts =
+        atoi(field_buffer(hash_collision_form_field_get(HASH_FORM_FIELD_MAX_ATTEMPTS), 0));
+    hash_engine_t engine =
+        atoi(field_buffer(hash_collision_form_field_get(HASH_FORM_FIELD_ENGINE), 0));
+    hash_table_layout_t layout =
+        atoi(field_buffer(hash_collision_form_field_get(HASH_FORM_FIELD_TABLE), 0));
+    hash_prefilter_mode_t prefilter =
+        atoi(field_buffer(hash_collision_form_field_get(HASH_FORM_FIELD_PREFILTER), 0));
+    hash_bucket_mode_t buckets =
+        atoi(field_buffer(hash_collision_form_field_get(HASH_FORM_FIELD_BUCKETS), 0));
+    bool flood = atoi(field_buffer(hash_collision_form_field_get(HASH_FORM_FIELD_FLOOD), 0)) == 2;
+    hash_input_mode_t inputs =
+        atoi(field_buffer(hash_collision_form_field_get(HASH_FORM_FIELD_INPUTS), 0));
+
+    // The corpus is indexed before the plan, which needs its number of lines
+    if (inputs == HASH_INPUTS_WORDLIST) {
+        ctx->wordlist =
+            hash_wordlist_open(BH_WORDLIST_PATH, g_thread_pool_get_max_threads(thread_pool));
+        if (!ctx->wordlist) {
+            char message[128];
+            snprintf(message, sizeof(message), "No line to read from %s in the working directory.",
+                     BH_WORDLIST_PATH);
+            render_run_error(message);
+            return;
+        }
+    }
+    unsigned int budget_mib =
+        atoi(field_buffer(hash_collision_form_field_get(HASH_FORM_FIELD_BUDGET), 0));
+    hash_strategy_t strategy =
+        atoi(field_buffer(hash_collision_form_field_get(HASH_FORM_FIELD_STRATEGY), 0));
+    return hash_collision_simulation_run(attempts, engine, layout, prefilter, buckets, flood,
+                                         inputs, budget_mib, strategy, thread_pool, ctx);
+}
+
+/**
+ * \brief          Render the plan of a run on the first row of the statistics: the strategy,
+ *                 its predicted memory against the budget, the predicted time and the chance
+ *                 to find a collision within the attempts
+ *
+ * \param[in]      row The row of the sub window to render on
+ * \param[in]      plan The plan to render
+ */
+static void
+render_attack_plan(int row, const hash_attack_plan_t* plan) {
+    for (int col = BH_FORM_X_PADDING; col <= COLS - BH_FORM_X_PADDING; col++) {
+        mvwaddch(manager->sub_win, row, col, ' ');
+    }
+
+    mvwprintw(manager->sub_win, row, BH_FORM_X_PADDING,
+              "Plan     : %s, %.2f of %.0f MiB, ~%.3g s, %.1f%% success%s%s",
+              hash_plan_strategy_label(plan->strategy),
+              (double)plan->predicted_bytes / (1024.0 * 1024.0),
+              (double)plan->budget_bytes / (1024.0 * 1024.0), plan->predicted_seconds,
+              100.0 * plan->success_probability, plan->fits ? "" : ", over budget",
+              plan->fallback ? ", fallback" : "");
+}
+
+/**
+ * \brief          Plan a run from the current form values and render the plan, so the
+ *                 predicted memory and time are shown before the run starts. Nothing is
+ *                 rendered while a run is in progress.
+ *
+ * \param[in]      ctx The context of the page, for its hash function and result
+ * \param[in]      thread_pool The thread pool the run would use, for its number of workers
+ */
+static void
+render_attack_plan_preview(const hash_collision_context_t* ctx, GThreadPool* thread_pool) {
+    if (g_atomic_int_get(&ctx->result->attempts_made) != -1) {
+        return;
+    }
+
+    hash_plan_request_t request;
+    hash_collision_plan_request(
+        &request, ctx->hash_id,
+        atoi(field_buffer(hash_collision_form_field_get(HASH_FORM_FIELD_MAX_ATTEMPTS), 0)),
+        g_thread_pool_get_max_threads(thread_pool),
+        atoi(field_buffer(hash_collision_form_field_get(HASH_FORM_FIELD_BUDGET), 0)),
+        atoi(field_buffer(hash_collision_form_field_get(HASH_FORM_FIELD_ENGINE), 0)),
+        atoi(field_buffer(hash_collision_form_field_get(HASH_FORM_FIELD_TABLE), 0)),
+        atoi(field_buffer(hash_collision_form_field_get(HASH_FORM_FIELD_PREFILTER), 0)),
+        atoi(field_buffer(hash_collision_form_field_get(HASH_FORM_FIELD_FLOOD), 0)) == 2);
+
+    hash_attack_plan_t plan;
+    hash_plan_attack(&request,
+                     atoi(field_buffer(hash_collision_form_field_get(HASH_FORM_FIELD_STRATEGY), 0)),
+                     &plan);
+    render_attack_plan(s_hash_form_field_metadata_len + 1 + 2 + 3 + 1 + 2, &plan);
+    wrefresh(manager->sub_win);
+}
+
+/**
+ * \brief          Render how the inputs of a run were made on the last row of the statistics,
+ *                 with the size of the corpus and the time its index took for a wordlist
+ *
+ * \param[in]      row The row of the sub window to render on
+ * \param[in]      stats The statistics of the run
+ */
+static void
+render_attack_inputs(int row, const hash_collision_stats_t* stats) {
+    switch (stats->input_mode) {
+        case HASH_INPUTS_WORDLIST:
+            mvwprintw(manager->sub_win, row, BH_FORM_X_PADDING,
+                      "Inputs   : %s, %llu lines, %.2f MiB mapped, indexed in %.3f s by %u "
+                      "threads",
+                      BH_WORDLIST_PATH, (unsigned long long)stats->wordlist_lines,
+                      (double)stats->wordlist_bytes / (1024.0 * 1024.0),
+                      (double)stats->wordlist_index_time / G_USEC_PER_SEC,
+                      stats->wordlist_threads);
+            break;
+        case HASH_INPUTS_COUNTER:
+            mvwprintw(manager->sub_win, row, BH_FORM_X_PADDING,
+                      "Inputs   : Counter, %d bytes from the worker and its counter, all distinct",
+                      BH_COUNTER_INPUT_BYTES);
+            break;
+        case HASH_INPUTS_BLOCK:
+            // The toy hashes have no block, their kernel is the byte loop itself
+            if (stats->block_bytes > 0) {
+                mvwprintw(manager->sub_win, row, BH_FORM_X_PADDING,
+                          "Inputs   : Block, %zu bytes in one %zu-byte block, kernel bound %.2f "
+                          "Mhash/s per thread",
+                          stats->block_input_bytes, stats->block_bytes, stats->block_rate / 1e6);
+            } else {
+                mvwprintw(manager->sub_win, row, BH_FORM_X_PADDING,
+                          "Inputs   : Block, %zu bytes, no padding, kernel bound %.2f Mhash/s per "
+                          "thread",
+                          stats->block_input_bytes, stats->block_rate / 1e6);
+            }
+            break;
+        default:
+            mvwprintw(manager->sub_win, row, BH_FORM_X_PADDING, "Inputs   : Random, 4 to 31 bytes");
+            break;
+    }
+}
+
+/**
+ * \brief          Render the run statistics below the progress bar: the plan, the engine
+ *                 throughput, the digests the sharded engine routed between workers, the
+ *                 bucket hash with the flood demonstration and the chain length distribution,
+ *                 the prefilter memory, its false positive rate and how many lookups it kept
+ *                 away from the table. The strategies without a full table show their own
+ *                 counters instead.
+ *
+ * \param[in]      stats The statistics of the run to render
+ * \param[in]      attempts_made The number of attempts the run made
+ */
+static void
+render_attack_stats(hash_collision_stats_t stats, int attempts_made) {
+    uint8_t starting_y = s_hash_form_field_metadata_len + 1 + 2 + 3 + 1 + 2;
+
+    // Clear the sub-window from starting_y to starting_y + 9
+    for (unsigned short row = starting_y; row < starting_y + 9; ++row) {
+        for (int col = BH_FORM_X_PADDING; col <= COLS - BH_FORM_X_PADDING; col++) {
+            mvwaddch(manager->sub_win, row, col, ' ');
+        }
+    }
+
+    render_attack_plan(starting_y, &stats.plan);
+    render_attack_inputs(starting_y + 8, &stats);
+    starting_y++;
+
+    // Every replayed input and every walk of merged trails is hashed a second time
+    guint64 hashes =
+        (attempts_made > 0 ? attempts_made : 0) + stats.replayed_inputs + stats.rewalk_hashes;
+    double seconds = stats.finished_at > stats.started_at
+                         ? (double)(stats.finished_at - stats.started_at) / G_USEC_PER_SEC
+                         : 0.0;
+    double table_mib = (double)stats.table_bytes / (1024.0 * 1024.0);
+    switch (stats.plan.strategy) {
+        case HASH_STRATEGY_COMPACT:
+            mvwprintw(manager->sub_win, starting_y, BH_FORM_X_PADDING,
+                      "Engine   : Compact entries %.2f MiB, %.3f s, %.0f hashes/s", table_mib,
+                      seconds, seconds > 0 ? hashes / seconds : 0.0);
+            mvwprintw(manager->sub_win, starting_y + 1, BH_FORM_X_PADDING,
+                      "Compact  : %llu fingerprint matches, %llu inputs regenerated",
+                      (unsigned long long)stats.fingerprint_matches,
+                      (unsigned long long)stats.replayed_inputs);
+            return;
+
+        case HASH_STRATEGY_DISTINGUISHED:
+            mvwprintw(manager->sub_win, starting_y, BH_FORM_X_PADDING,
+                      "Engine   : Distinguished points %.2f MiB, %.3f s, %.0f hashes/s",
+                      table_mib, seconds, seconds > 0 ? hashes / seconds : 0.0);
+            mvwprintw(manager->sub_win, starting_y + 1, BH_FORM_X_PADDING,
+                      "Trails   : %llu ended on %u zero bits, %llu merged, %llu abandoned, "
+                      "%llu hashes rewalked",
+                      (unsigned long long)stats.trails, stats.plan.distinguished_bits,
+                      (unsigned long long)stats.trail_merges,
+                      (unsigned long long)stats.abandoned_trails,
+                      (unsigned long long)stats.rewalk_hashes);
+            return;
+
+        case HASH_STRATEGY_CYCLE:
+            mvwprintw(manager->sub_win, starting_y, BH_FORM_X_PADDING,
+                      "Engine   : Cycle search, no table, %.3f s, %.0f hashes/s", seconds,
+                      seconds > 0 ? hashes / seconds : 0.0);
+            mvwprintw(manager->sub_win, starting_y + 1, BH_FORM_X_PADDING,
+                      "Cycle    : %llu restarts from a start already on the cycle",
+                      (unsigned long long)stats.cycle_restarts);
+            return;
+
+        default: break;
+    }
+
+    mvwprintw(manager->sub_win, starting_y, BH_FORM_X_PADDING,
+              "Engine   : %s, %s table %.2f MiB, %.3f s, %.0f hashes/s",
+              stats.engine == HASH_ENGINE_SHARDED ? "Sharded" : "Shared",
+              stats.layout == HASH_TABLE_CHAINED ? "chained" : "flat", table_mib, seconds,
+              seconds > 0 ? hashes / seconds : 0.0);
+
+    if (stats.engine == HASH_ENGINE_SHARDED) {
+        double routed_percent =
+            attempts_made > 0 ? (100.0 * stats.routed_digests) / attempts_made : 0.0;
+        mvwprintw(manager->sub_win, starting_y + 1, BH_FORM_X_PADDING,
+                  "Routing  : %.2f%% of digests crossed workers, %llu batches, %.2f MiB, "
+                  "%llu ring stalls",
+                  routed_percent, (unsigned long long)stats.ring_batches,
+                  (double)stats.routed_bytes / (1024.0 * 1024.0),
+                  (unsigned long long)stats.ring_stalls);
+    }
+
+    const char* bucket_label =
+        stats.bucket_mode == HASH_BUCKET_DJB2 ? "djb2, unkeyed" : "SipHash-1-3, keyed per run";
+    if (stats.flood_keys > 0) {
+        double flood_seconds = (double)stats.flood_time / G_USEC_PER_SEC;
+        mvwprintw(manager->sub_win, starting_y + 2, BH_FORM_X_PADDING,
+                  "Buckets  : %s, %llu flood keys took %.3f s (%.0f ns per key)", bucket_label,
+                  (unsigned long long)stats.flood_keys, flood_seconds,
+                  (flood_seconds * 1e9) / stats.flood_keys);
+    } else {
+        mvwprintw(manager->sub_win, starting_y + 2, BH_FORM_X_PADDING, "Buckets  : %s",
+                  bucket_label);
+    }
+
+    // The chained layout counts the buckets by chain length, the flat layout counts the
+    // digests by the number of groups probed to reach them
+    size_t chain_total = 0;
+    for (unsigned int i = 0; i < BH_CHAIN_HISTOGRAM_BINS; i++) {
+        chain_total += stats.chains.histogram[i];
+    }
+    bool chained = stats.layout == HASH_TABLE_CHAINED;
+    char chain_row[192];
+    int cols = getmaxx(manager->sub_win) - 2 * BH_FORM_X_PADDING;
+    size_t width = cols > 0 ? (size_t)cols : 0;
+    if (width >= sizeof(chain_row)) {
+        width = sizeof(chain_row) - 1;
+    }
+    size_t used = snprintf(chain_row, width + 1,
+                           chained ? "Chains   : longest %zu, buckets by length"
+                                   : "Probes   : longest %zu groups, digests by groups probed",
+                           chained ? stats.chains.longest : stats.chains.longest + 1);
+
+    // The buckets that do not fit in the width are merged into one "N+" bucket
+    size_t remaining = chain_total;
+    for (unsigned int i = 0; i < BH_CHAIN_HISTOGRAM_BINS && used < width; i++) {
+        unsigned int length = chained ? i : i + 1;
+        size_t count = stats.chains.histogram[i];
+        bool last = i == BH_CHAIN_HISTOGRAM_BINS - 1;
+        char bucket[32];
+        char tail[32] = "";
+        size_t bucket_len = snprintf(bucket, sizeof(bucket), " %u%s:%.1f%%", length,
+                                     last ? "+" : "",
+                                     chain_total > 0 ? (100.0 * count) / chain_total : 0.0);
+        remaining -= count;
+        if (!last) {
+            snprintf(tail, sizeof(tail), " %u+:%.1f%%", length + 1,
+                     chain_total > 0 ? (100.0 * remaining) / chain_total : 0.0);
+        }
+        if (used + bucket_len + strlen(tail) > width) {
+            bucket_len = snprintf(bucket, sizeof(bucket), " %u+:%.1f%%", length,
+                                  chain_total > 0 ? (100.0 * (remaining + count)) / chain_total
+                                                  : 0.0);
+            last = true;
+        }
+        if (used + bucket_len > width) {
+            break;
+        }
+        memcpy(chain_row + used, bucket, bucket_len + 1);
+        used += bucket_len;
+        if (last) {
+            break;
+        }
+    }
+    mvwprintw(manager->sub_win, starting_y + 3, BH_FORM_X_PADDING, "%s", chain_row);
+    starting_y += 4;
+
+    double filter_mib = (double)stats.filter_bytes / (1024.0 * 1024.0);
+    switch (stats.prefilter) {
+        case HASH_PREFILTER_BLOOM:
+            mvwprintw(manager->sub_win, starting_y, BH_FORM_X_PADDING,
+                      "Prefilter: Blocked Bloom, %.2f MiB", filter_mib);
+            break;
+        case HASH_PREFILTER_TWO_PASS:
+            mvwprintw(manager->sub_win, starting_y, BH_FORM_X_PADDING,
+                      "Prefilter: Blocked Bloom two-pass, %.2f MiB, %llu inputs replayed",
+                      filter_mib, (unsigned long long)stats.replayed_inputs);
+            break;
+        default:
+            mvwprintw(manager->sub_win, starting_y, BH_FORM_X_PADDING, "Prefilter: Off");
+            break;
+    }
+
+    // Without a prefilter every lookup is a table probe
+    guint64 lookups = stats.table_probes;
+    if (stats.prefilter != HASH_PREFILTER_OFF) {
+        lookups = stats.filter_queries;
+
+        // Every filter hit that the table did not confirm was a false positive
+        guint64 false_positives =
+            stats.filter_hits > stats.table_hits ? stats.filter_hits - stats.table_hits : 0;
+        double false_positive_rate =
+            lookups > 0 ? (100.0 * false_positives) / lookups : 0.0;
+        mvwprintw(manager->sub_win, starting_y + 1, BH_FORM_X_PADDING,
+                  "Filter   : %llu hits of %llu queries, false positive rate %.3f%%",
+                  (unsigned long long)stats.filter_hits, (unsigned long long)lookups,
+                  false_positive_rate);
+    }
+
+    double probes_avoided =
+        lookups > 0 ? (100.0 * (lookups - stats.table_probes)) / lookups : 0.0;
+    mvwprintw(manager->sub_win, starting_y + 2, BH_FORM_X_PADDING,
+              "Table    : %llu probes for %llu lookups (%.2f%% avoided)",
+              (unsigned long long)stats.table_probes, (unsigned long long)lookups,
+              probes_avoided);
 }
 
 /**
@@ -241,7 +847,11 @@ render_attack_result(hash_collision_simulation_result_t results) {
         }
     }
 
-    unsigned int attempts = atoi(field_buffer(hash_collision_form_field_get(0), 0));
+    unsigned int attempts =
+        atoi(field_buffer(hash_collision_form_field_get(HASH_FORM_FIELD_MAX_ATTEMPTS), 0));
+    if (results.stats.wordlist_lines > 0 && results.stats.wordlist_lines < attempts) {
+        attempts = (unsigned int)results.stats.wordlist_lines; // One attempt per line at most
+    }
     if (results.attempts_made < attempts && !results.collision_found) {
         // No results to display
         return;
@@ -253,10 +863,21 @@ render_attack_result(hash_collision_simulation_result_t results) {
         mvwprintw(manager->sub_win, starting_y, BH_FORM_X_PADDING, "Collision Found at attempt %d!",
                   results.attempts_made);
         wattroff(manager->sub_win, A_BOLD | COLOR_PAIR(BH_SUCCESS_COLOR_PAIR));
-        mvwprintw(manager->sub_win, starting_y + 1, BH_FORM_X_PADDING, "Input 1: %s",
-                  results.collision_input_1);
-        mvwprintw(manager->sub_win, starting_y + 2, BH_FORM_X_PADDING, "Input 2: %s",
-                  results.collision_input_2);
+        // A counter input is read back to the worker and the counter it was made from
+        const char* inputs[2] = {results.collision_input_1, results.collision_input_2};
+        for (int i = 0; i < 2; i++) {
+            mvwprintw(manager->sub_win, starting_y + 1 + i, BH_FORM_X_PADDING, "Input %d: %s",
+                      i + 1, inputs[i]);
+
+            unsigned int worker_id;
+            guint32 index;
+            bool counted = results.stats.input_mode == HASH_INPUTS_COUNTER
+                           || results.stats.input_mode == HASH_INPUTS_BLOCK;
+            if (counted
+                && counter_input_origin(results.stats.run_seed, inputs[i], &worker_id, &index)) {
+                wprintw(manager->sub_win, " (worker %u, counter %u)", worker_id, index);
+            }
+        }
         mvwprintw(manager->sub_win, starting_y + 3, BH_FORM_X_PADDING, "Hash   : %s",
                   results.collision_hash_hex);
     } else {
@@ -266,6 +887,8 @@ render_attack_result(hash_collision_simulation_result_t results) {
         wattroff(manager->sub_win, A_BOLD | COLOR_PAIR(BH_ERROR_COLOR_PAIR));
     }
 
+    render_attack_stats(results.stats, results.attempts_made);
+
     wrefresh(manager->sub_win);
 }
 
@@ -334,6 +957,11 @@ hash_collision_form_init(WINDOW* win, int max_y, int max_x) {
         }
 
         snprintf(string_buffer, metadata->max_length + 1, "%hu", metadata->default_value);
+        if (i == HASH_FORM_FIELD_BUDGET) {
+            // The budget defaults to the memory available to the process
+            snprintf(string_buffer, metadata->max_length + 1, "%zu",
+                     hash_plan_default_budget_mib());
+        }
 
         // Make the field visible and editable
         field_opts_on(manager->fields[i], O_STATIC);    // Keep field static size
@@ -349,12 +977,16 @@ hash_collision_form_init(WINDOW* win, int max_y, int max_x) {
 
         // Set the field type to numeric
         int max_value = calculate_form_max_value(metadata->max_length);
+        if (metadata->max_value > 0 && (int)metadata->max_value < max_value) {
+            max_value = metadata->max_value;
+        }
         set_field_type(manager->fields[i], TYPE_INTEGER, 0, (long)1, (long)max_value);
 
         // Initialize tracker
         manager->trackers[i].field = manager->fields[i];
         manager->trackers[i].current_length = strlen(string_buffer);
         manager->trackers[i].max_length = metadata->max_length;
+        manager->trackers[i].max_value = metadata->max_value;
         manager->trackers[i].field_index = i;
         manager->trackers[i].cursor_position = manager->trackers[i].current_length;
 
@@ -501,6 +1133,8 @@ hash_form_handle_input(int ch, hash_collision_context_t* ctx, GThreadPool* threa
 
                 update_field_highlighting(manager);
 
+                render_attack_plan_preview(ctx, thread_pool);
+
                 if (!is_button) {
                     on_field_change(manager, old_field, active_field);
                     is_btn_highlighted = false;
@@ -691,6 +1325,7 @@ render_hash_collision_page(WINDOW* content_win, WINDOW* header_win, WINDOW* foot
     mvwprintw(content_win, 0, (*max_x - title_len) / 2, s_hash_collision_page_title);
 
     hash_config_t current_hash_function = get_hash_config_item(hash_id);
+    s_seconds_per_hash = hash_collision_seconds_per_hash(hash_id);
 
     render_page_details(content_win, current_hash_function, *max_x);
 
@@ -718,18 +1353,30 @@ render_hash_collision_page(WINDOW* content_win, WINDOW* header_win, WINDOW* foot
     result->collision_input_1 = NULL;
     result->collision_input_2 = NULL;
     result->collision_hash_hex = NULL;
+    memset(&result->stats, 0, sizeof(result->stats));
 
     prev_result.attempts_made = -1;
     prev_result.collision_found = false;
     prev_result.collision_input_1 = NULL;
     prev_result.collision_input_2 = NULL;
     prev_result.collision_hash_hex = NULL;
+    memset(&prev_result.stats, 0, sizeof(prev_result.stats));
 
     // Initialize context state
     hash_collision_context_t ctx = {.hash_id = hash_id,
-                                    .shared_table = NULL,
+                                    .shared = {.layout = HASH_TABLE_FLAT},
                                     .table_mutex = NULL,
 
+                                    .compact = NULL,
+
+                                    .engine = HASH_ENGINE_SHARED,
+                                    .shards = NULL,
+
+                                    .prefilter = HASH_PREFILTER_OFF,
+                                    .candidates = NULL,
+                                    .pass_one_pending = 0,
+                                    .replay_attempts = 0,
+
                                     .cancel = 0,
                                     .remaining_workers = 0,
 
@@ -738,6 +1385,9 @@ render_hash_collision_page(WINDOW* content_win, WINDOW* header_win, WINDOW* foot
 
                                     .error_info = NULL};
 
+    render_attack_plan_preview(&ctx, thread_pool);
+    pos_form_cursor(hash_collision_form);
+
     int char_input;
 
     while (true) {
@@ -752,7 +1402,12 @@ render_hash_collision_page(WINDOW* content_win, WINDOW* header_win, WINDOW* foot
 
         // If the user has initiated a simulation run, check if the thread pool has
         // finished processing all tasks
-        unsigned int max_attempts = atoi(field_buffer(hash_collision_form_field_get(0), 0));
+        // A run may make fewer attempts than the field asks for, one per line of a wordlist
+        unsigned int max_attempts = ctx.max_attempts;
+        if (max_attempts == 0) {
+            max_attempts =
+                atoi(field_buffer(hash_collision_form_field_get(HASH_FORM_FIELD_MAX_ATTEMPTS), 0));
+        }
         bool has_results_to_check = g_atomic_int_get(&result->attempts_made) != -1;
         bool all_tasks_completed = g_atomic_int_get(&result->attempts_made) >= max_attempts;
         gint left = g_atomic_int_get((gint*)&ctx.remaining_workers);
@@ -781,6 +1436,8 @@ render_hash_collision_page(WINDOW* content_win, WINDOW* header_win, WINDOW* foot
                 render_full_page_error(content_win, 0, 0, result);
             }
 
+            result->stats.table_bytes = hash_collision_table_bytes(&ctx);
+            hash_collision_chain_stats(&ctx, &result->stats.chains);
             hash_progress_bar_update(result->attempts_made, max_attempts, true);
             render_attack_result(*ctx.result);
             deep_copy_hash_collision_simulation_result(&prev_result, result);
@@ -797,8 +1454,15 @@ render_hash_collision_page(WINDOW* content_win, WINDOW* header_win, WINDOW* foot
                     s_hash_form_buttons_metadata[0].loading_label, true);
             }
 
-            // Update the intermediate result display
-            hash_progress_bar_update(result->attempts_made, max_attempts, false);
+            // Update the intermediate result display, the two-pass mode hashes every input
+            // twice so its progress covers both passes
+            if (ctx.prefilter == HASH_PREFILTER_TWO_PASS) {
+                hash_progress_bar_update(
+                    result->attempts_made + g_atomic_int_get((gint*)&ctx.replay_attempts),
+                    max_attempts * 2, false);
+            } else {
+                hash_progress_bar_update(result->attempts_made, max_attempts, false);
+            }
             wrefresh(manager->sub_win);
         }
 
@@ -829,6 +1493,9 @@ render_hash_collision_page(WINDOW* content_win, WINDOW* header_win, WINDOW* foot
             footer_render(footer_win, win_size.Y - 2, *max_x);
             hash_collision_form_restore(content_win, *max_y, *max_x, prev_result);
             hash_progress_bar_update(prev_result.attempts_made, max_attempts, true);
+            if (prev_result.attempts_made == -1) {
+                render_attack_plan_preview(&ctx, thread_pool);
+            }
 
             mvwprintw(content_win, 0, (*max_x - title_len) / 2, s_hash_collision_page_title);
             wrefresh(content_win);
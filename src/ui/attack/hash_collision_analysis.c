@@ -0,0 +1,258 @@
+/**
+ * \file            hash_collision_analysis.c
+ * \brief           Exhaustive analysis of the toy hashes. Their outputs are small enough to
+ *                  count every digest of every input of a few bytes, so how far they are from
+ *                  a random function is measured instead of sampled: the uniformity of the
+ *                  outputs, the collisions they give and how the input bits spread over the
+ *                  output bits.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_analysis.h"
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Measure a histogram against the uniform distribution and against a random
+ *                 function hashing as many inputs
+ *
+ * \param[in]      histogram The inputs of every digest
+ * \param[in]      bits The bits of the digest
+ * \param[out]     distribution Receives the measures
+ */
+static void
+analysis_measure(const uint64_t* histogram, unsigned int bits,
+                 hash_analysis_distribution_t* distribution) {
+    size_t digests = (size_t)1 << bits;
+    memset(distribution, 0, sizeof(*distribution));
+
+    for (size_t i = 0; i < digests; i++) {
+        uint64_t load = histogram[i];
+        distribution->inputs += load;
+        distribution->pairs += load > 0 ? load * (load - 1) / 2 : 0;
+        distribution->empty += load == 0;
+        if (load > distribution->max_load) {
+            distribution->max_load = load;
+        }
+    }
+
+    double inputs = (double)distribution->inputs;
+    double expected = inputs / (double)digests;
+    if (expected > 0.0) {
+        for (size_t i = 0; i < digests; i++) {
+            double delta = (double)histogram[i] - expected;
+            distribution->chi_square += delta * delta / expected;
+        }
+    }
+
+    distribution->freedom = (unsigned int)digests - 1;
+    distribution->z_score = (distribution->chi_square - distribution->freedom)
+                            / sqrt(2.0 * distribution->freedom);
+    distribution->expected_empty = (double)digests * exp(inputs * log1p(-1.0 / (double)digests));
+    distribution->expected_pairs = inputs * (inputs - 1.0) / (2.0 * (double)digests);
+}
+
+/****************************************************************
+                       EXTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Check whether a hash function is a toy hash small enough to be analysed
+ *                 exhaustively
+ *
+ * \param[in]      hash_id The hash function
+ * \return         true for the toy hashes of the registry
+ */
+bool
+hash_analysis_supports(enum hash_function_ids hash_id) {
+    return get_hash_config(hash_id)->toy_update != NULL;
+}
+
+/**
+ * \brief          Create an analysis with the counters of every worker. You should free the
+ *                 returned analysis using `hash_analysis_destroy` when done.
+ *
+ * \param[in]      hash_id The toy hash function
+ * \param[in]      max_length The longest inputs, 1 to BH_ANALYSIS_MAX_LENGTH
+ * \param[in]      shard_count The workers, each counts in its own shard
+ * \return         A pointer to the newly created analysis, or NULL on memory allocation
+ *                 failure or invalid parameters
+ */
+hash_analysis_t*
+hash_analysis_create(enum hash_function_ids hash_id, unsigned int max_length,
+                     unsigned int shard_count) {
+    if (!hash_analysis_supports(hash_id) || max_length == 0
+        || max_length > BH_ANALYSIS_MAX_LENGTH || shard_count == 0) {
+        return NULL;
+    }
+
+    hash_analysis_t* analysis = calloc(1, sizeof(hash_analysis_t));
+    if (!analysis) {
+        return NULL;
+    }
+
+    analysis->hash_id = hash_id;
+    analysis->bits = get_hash_config_item(hash_id).bits;
+    analysis->max_length = max_length;
+    for (unsigned int length = 1; length <= max_length; length++) {
+        analysis->total += (uint64_t)1 << (8 * length);
+    }
+
+    size_t counters = ((size_t)max_length) << analysis->bits;
+    analysis->shard_count = shard_count;
+    analysis->shards = calloc(shard_count, sizeof(hash_analysis_shard_t));
+    analysis->merged.histograms = calloc(counters, sizeof(uint32_t));
+    if (!analysis->shards || !analysis->merged.histograms) {
+        hash_analysis_destroy(analysis);
+        return NULL;
+    }
+
+    for (unsigned int i = 0; i < shard_count; i++) {
+        analysis->shards[i].histograms = calloc(counters, sizeof(uint32_t));
+        if (!analysis->shards[i].histograms) {
+            hash_analysis_destroy(analysis);
+            return NULL;
+        }
+    }
+    return analysis;
+}
+
+/**
+ * \brief          Get an input of the enumeration. The inputs are numbered by length, the 256
+ *                 of one byte first, and within a length the number is the input, little
+ *                 endian.
+ *
+ * \param[in]      analysis The analysis
+ * \param[in]      index The number of the input, below analysis->total
+ * \param[out]     input Receives the input, BH_ANALYSIS_MAX_LENGTH bytes at most
+ * \return         The length of the input in bytes
+ */
+size_t
+hash_analysis_input(const hash_analysis_t* analysis, uint64_t index, uint8_t* input) {
+    size_t length = 1;
+    while (length < analysis->max_length && index >= (uint64_t)1 << (8 * length)) {
+        index -= (uint64_t)1 << (8 * length);
+        length++;
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        input[i] = (uint8_t)(index >> (8 * i));
+    }
+    return length;
+}
+
+/**
+ * \brief          Read the binary digest of a toy hash as its value
+ *
+ * \param[in]      analysis The analysis
+ * \param[in]      digest The big-endian digest written by the batch function of the hash
+ * \return         The value of the digest, below 2^bits
+ */
+uint32_t
+hash_analysis_digest_value(const hash_analysis_t* analysis, const uint8_t* digest) {
+    return analysis->bits > 8 ? ((uint32_t)digest[0] << 8) | digest[1] : digest[0];
+}
+
+/**
+ * \brief          Sum the shards of every worker and measure the result: the distribution of
+ *                 every length and of every input together, and the avalanche matrix. Only
+ *                 call it once every worker is done.
+ *
+ * \param[in]      analysis The analysis
+ * \return         true once measured, false on memory allocation failure
+ */
+bool
+hash_analysis_merge(hash_analysis_t* analysis) {
+    size_t digests = (size_t)1 << analysis->bits;
+    size_t counters = analysis->max_length * digests;
+    hash_analysis_shard_t* merged = &analysis->merged;
+
+    for (unsigned int s = 0; s < analysis->shard_count; s++) {
+        const hash_analysis_shard_t* shard = &analysis->shards[s];
+        for (size_t i = 0; i < counters; i++) {
+            merged->histograms[i] += shard->histograms[i];
+        }
+        for (unsigned int i = 0; i < BH_ANALYSIS_MAX_INPUT_BITS; i++) {
+            merged->trials[i] += shard->trials[i];
+            for (unsigned int o = 0; o < BH_ANALYSIS_MAX_OUTPUT_BITS; o++) {
+                merged->flips[i][o] += shard->flips[i][o];
+            }
+        }
+    }
+
+    uint64_t* histogram = calloc(digests, sizeof(uint64_t));
+    uint64_t* all = calloc(digests, sizeof(uint64_t));
+    if (!histogram || !all) {
+        free(histogram);
+        free(all);
+        return false;
+    }
+
+    for (unsigned int length = 0; length < analysis->max_length; length++) {
+        for (size_t i = 0; i < digests; i++) {
+            histogram[i] = merged->histograms[length * digests + i];
+            all[i] += histogram[i];
+        }
+        analysis_measure(histogram, analysis->bits, &analysis->lengths[length]);
+    }
+    analysis_measure(all, analysis->bits, &analysis->all);
+    free(histogram);
+    free(all);
+
+    // A random function flips every output bit with probability 1/2, the estimate of n trials
+    // is off by sqrt(1/4n) and its mean distance from 1/2 is that times sqrt(2/pi)
+    unsigned int cells = 0;
+    double bias_sum = 0.0, random_sum = 0.0;
+    for (unsigned int i = 0; i < 8 * analysis->max_length; i++) {
+        if (merged->trials[i] == 0) {
+            continue;
+        }
+        double trials = (double)merged->trials[i];
+        for (unsigned int o = 0; o < analysis->bits; o++) {
+            double p = (double)merged->flips[i][o] / trials;
+            double bias = fabs(p - 0.5);
+            analysis->avalanche[i][o] = p;
+            bias_sum += bias;
+            random_sum += sqrt(0.25 / trials) * 0.7978845608028654;
+            cells++;
+            if (bias > analysis->max_bias) {
+                analysis->max_bias = bias;
+                analysis->max_bias_input = i;
+                analysis->max_bias_output = o;
+            }
+        }
+    }
+    analysis->mean_bias = cells > 0 ? bias_sum / cells : 0.0;
+    analysis->random_bias = cells > 0 ? random_sum / cells : 0.0;
+
+    g_atomic_int_set(&analysis->finished, 1);
+    return true;
+}
+
+/**
+ * \brief          Destroy the analysis with the shards of its workers
+ *
+ * \param[in]      analysis The analysis to destroy, NULL is ignored
+ */
+void
+hash_analysis_destroy(hash_analysis_t* analysis) {
+    if (!analysis) {
+        return;
+    }
+
+    if (analysis->shards) {
+        for (unsigned int i = 0; i < analysis->shard_count; i++) {
+            free(analysis->shards[i].histograms);
+        }
+    }
+    free(analysis->shards);
+    free(analysis->merged.histograms);
+    free(analysis);
+}
@@ -0,0 +1,109 @@
+/**
+ * \file            hash_collision_analysis.h
+ * \brief           Header file for hash_collision_analysis.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_COLLISION_ANALYSIS_H
+#define HASH_COLLISION_ANALYSIS_H
+
+#include <glib.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_config.h"
+
+#include "../../utils/hash_function.h"
+
+/**
+ * \brief          The longest inputs enumerated, 256^3 inputs of 3 bytes
+ */
+#define BH_ANALYSIS_MAX_LENGTH 3
+
+/**
+ * \brief          The input bits of the avalanche matrix, the bits of the longest inputs
+ */
+#define BH_ANALYSIS_MAX_INPUT_BITS (8 * BH_ANALYSIS_MAX_LENGTH)
+
+/**
+ * \brief          The output bits of the avalanche matrix, the bits of the widest toy hash
+ */
+#define BH_ANALYSIS_MAX_OUTPUT_BITS 16
+
+/**
+ * \brief          The inputs a worker takes at once from the counter of the analysis
+ */
+#define BH_ANALYSIS_CHUNK_SIZE 4096
+
+/**
+ * \brief          The output distribution of some inputs against the one of a random function
+ *                 hashing as many inputs
+ */
+typedef struct {
+    uint64_t inputs;       ///< The inputs hashed
+    double chi_square;     ///< Chi-square of the histogram against the uniform distribution
+    unsigned int freedom;  ///< The degrees of freedom, the digests minus one
+    double z_score;        ///< The chi-square in standard deviations from its mean
+    uint64_t empty;        ///< The digests no input reached
+    double expected_empty; ///< The digests a random function leaves empty
+    uint64_t max_load;     ///< The inputs of the digest reached the most
+    uint64_t pairs;        ///< The pairs of inputs with the same digest, the collisions
+    double expected_pairs; ///< The pairs a random function gives
+} hash_analysis_distribution_t;
+
+/**
+ * \brief          The counters of one worker. Every worker counts in its own shard, which
+ *                 are only summed once every input is hashed, so the workers never contend.
+ */
+typedef struct {
+    uint32_t* histograms; ///< The digests of every length, 2^bits counters per length
+    uint64_t trials[BH_ANALYSIS_MAX_INPUT_BITS]; ///< The inputs every input bit was flipped in
+    uint64_t flips[BH_ANALYSIS_MAX_INPUT_BITS]
+                  [BH_ANALYSIS_MAX_OUTPUT_BITS]; ///< The flips of every output bit per input bit
+} hash_analysis_shard_t;
+
+/**
+ * \brief          An exhaustive analysis of a toy hash: every input of 1 to max_length bytes
+ *                 is hashed, with every input that differs from it in one bit. The histograms
+ *                 give the uniformity of the outputs and the collisions they hold, the flips
+ *                 the avalanche matrix: the probability an output bit changes when an input
+ *                 bit does, 1/2 for a random function.
+ */
+typedef struct {
+    enum hash_function_ids hash_id; ///< The toy hash function, 8, 12 or 16 bits
+    unsigned int bits;              ///< The bits of the digest
+    unsigned int max_length;        ///< The longest inputs, 1 to BH_ANALYSIS_MAX_LENGTH
+    uint64_t total;                 ///< The inputs of every length up to max_length
+    int next_job;                   ///< The next chunk of inputs to take, atomic
+    int finished;                   ///< Set once the shards are merged, atomic
+    unsigned int shard_count;       ///< The shards, one per worker
+    hash_analysis_shard_t* shards;  ///< The counters of every worker
+    hash_analysis_shard_t merged;   ///< The sum of the shards, once finished
+    hash_analysis_distribution_t lengths[BH_ANALYSIS_MAX_LENGTH]; ///< Every length on its own
+    hash_analysis_distribution_t all; ///< Every input together
+    double avalanche[BH_ANALYSIS_MAX_INPUT_BITS]
+                    [BH_ANALYSIS_MAX_OUTPUT_BITS]; ///< The flip probabilities, once finished
+    double mean_bias;             ///< The mean distance of the avalanche matrix from 1/2
+    double max_bias;              ///< The largest distance from 1/2
+    unsigned int max_bias_input;  ///< The input bit of the largest distance
+    unsigned int max_bias_output; ///< The output bit of the largest distance
+    double random_bias;           ///< The mean distance of a random function on as many trials
+} hash_analysis_t;
+
+bool hash_analysis_supports(enum hash_function_ids hash_id);
+hash_analysis_t* hash_analysis_create(enum hash_function_ids hash_id, unsigned int max_length,
+                                      unsigned int shard_count);
+size_t hash_analysis_input(const hash_analysis_t* analysis, uint64_t index, uint8_t* input);
+uint32_t hash_analysis_digest_value(const hash_analysis_t* analysis, const uint8_t* digest);
+bool hash_analysis_merge(hash_analysis_t* analysis);
+void hash_analysis_destroy(hash_analysis_t* analysis);
+
+#endif
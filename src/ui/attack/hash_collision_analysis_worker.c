@@ -0,0 +1,98 @@
+/**
+ * \file            hash_collision_analysis_worker.c
+ * \brief           The worker of the toy hash analysis page, which counts its share of the inputs
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_analysis_worker.h"
+
+/**************************************************************
+                      EXTERNAL FUNCTIONS
+**************************************************************/
+
+/**
+ * \brief          Run a worker of a toy hash analysis. The workers take chunks of the
+ *                 enumerated inputs and hash every input in one batch with the inputs that
+ *                 differ from it in one bit, counting its digest and the output bits every
+ *                 input bit flips in the shard of the worker. The last worker merges the
+ *                 shards.
+ *
+ * \param[in]      worker The data of this worker
+ */
+void
+hash_collision_analysis_worker(WorkerData* worker) {
+    hash_collision_context_t* ctx = worker->ctx;
+    hash_analysis_t* analysis = ctx->analysis;
+    hash_analysis_shard_t* shard = &analysis->shards[worker->worker_id];
+    const hash_config_t* hash = get_hash_config(analysis->hash_id);
+    size_t digests = (size_t)1 << analysis->bits;
+
+    // The input is the first of the batch, every flip of one of its bits follows
+    uint8_t inputs[1 + BH_ANALYSIS_MAX_INPUT_BITS][BH_ANALYSIS_MAX_LENGTH];
+    const uint8_t* batch[1 + BH_ANALYSIS_MAX_INPUT_BITS];
+    size_t batch_lens[1 + BH_ANALYSIS_MAX_INPUT_BITS];
+    uint8_t batch_digests[(1 + BH_ANALYSIS_MAX_INPUT_BITS) * 2];
+    for (unsigned int i = 0; i <= BH_ANALYSIS_MAX_INPUT_BITS; i++) {
+        batch[i] = inputs[i];
+    }
+
+    while (!g_atomic_int_get((gint*)&ctx->cancel) && !ctx->error_info->has_error) {
+        uint64_t first =
+            (uint64_t)g_atomic_int_add(&analysis->next_job, 1) * BH_ANALYSIS_CHUNK_SIZE;
+        if (first >= analysis->total) {
+            break;
+        }
+
+        uint64_t last = first + BH_ANALYSIS_CHUNK_SIZE < analysis->total
+                            ? first + BH_ANALYSIS_CHUNK_SIZE
+                            : analysis->total;
+        uint64_t index = first;
+        for (; index < last; index++) {
+            size_t length = hash_analysis_input(analysis, index, inputs[0]);
+            unsigned int input_bits = 8 * (unsigned int)length;
+            for (unsigned int bit = 0; bit <= input_bits; bit++) {
+                batch_lens[bit] = length;
+            }
+            for (unsigned int bit = 0; bit < input_bits; bit++) {
+                memcpy(inputs[bit + 1], inputs[0], length);
+                inputs[bit + 1][bit / 8] ^= (uint8_t)(1u << (bit % 8));
+            }
+
+            if (!hash->batch(batch, batch_lens, input_bits + 1, batch_digests)) {
+                REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_HASH_COMPUTATION,
+                                    "Hash function returned invalid result");
+                break;
+            }
+
+            uint32_t digest = hash_analysis_digest_value(analysis, batch_digests);
+            shard->histograms[(length - 1) * digests + digest]++;
+            for (unsigned int bit = 0; bit < input_bits; bit++) {
+                const uint8_t* flipped_digest = batch_digests + (bit + 1) * hash->digest_bytes;
+                uint32_t flipped = digest ^ hash_analysis_digest_value(analysis, flipped_digest);
+                shard->trials[bit]++;
+                for (unsigned int out = 0; out < analysis->bits; out++) {
+                    shard->flips[bit][out] += (flipped >> out) & 1;
+                }
+            }
+        }
+
+        g_atomic_int_add((gint*)&ctx->result->attempts_made, (gint)(index - first));
+    }
+
+    if (!g_atomic_int_dec_and_test((gint*)&ctx->pass_one_pending)) {
+        return;
+    }
+
+    if (g_atomic_int_get((gint*)&ctx->cancel) || ctx->error_info->has_error) {
+        return;
+    }
+    if (!hash_analysis_merge(analysis)) {
+        REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_MEMORY_ALLOCATION,
+                            "Memory allocation failed for the merged histograms");
+    }
+}
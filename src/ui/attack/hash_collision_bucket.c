@@ -0,0 +1,282 @@
+/**
+ * \file            hash_collision_bucket.c
+ * \brief           Bucket selection for the digest tables. The tables place a digest with
+ *                  SipHash-1-3 keyed by a random key drawn for every run, so nobody can
+ *                  predict which digests share a bucket. The unkeyed djb2 of the original
+ *                  table is kept as an option, together with a generator of keys that all
+ *                  land in one djb2 bucket, to demonstrate the hash flooding it allows.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_bucket.h"
+
+#include <openssl/rand.h>
+
+#include "../../utils/hash_siphash.h"
+
+/**
+ * \brief          The number of hex characters in each half of the suffix of a flood key
+ */
+#define BH_FLOOD_HALF_CHARS (BH_FLOOD_SUFFIX_CHARS / 2)
+
+/**
+ * \brief          The number of different halves, 16 choices for every character
+ */
+#define BH_FLOOD_HALF_COUNT ((uint32_t)1 << (4 * BH_FLOOD_HALF_CHARS))
+
+/**
+ * \brief          The characters used by the digests, and so by the flood keys
+ */
+static const char s_bucket_hex_digits[] = "0123456789ABCDEF";
+
+/**
+ * \brief          The djb2 residue of one suffix half, used to sort and search the halves
+ */
+typedef struct {
+    uint64_t residue; ///< The djb2 sum of the half modulo the bucket modulus
+    uint32_t half;    ///< The half, one hex character per nibble
+} flood_half_t;
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Get the djb2 sum of the characters of one suffix half, starting from
+ *                 zero. The djb2 of a whole key is the djb2 of its prefix times 33 to the
+ *                 power of the suffix length, plus the sums of the halves weighted alike.
+ *
+ * \param[in]      half The half, one hex character per nibble, most significant first
+ * \return         The djb2 sum of the characters of the half
+ */
+static uint64_t
+hash_bucket_djb2_half(uint32_t half) {
+    uint64_t sum = 0;
+    for (int i = BH_FLOOD_HALF_CHARS - 1; i >= 0; i--) {
+        sum = sum * 33 + (unsigned char)s_bucket_hex_digits[(half >> (4 * i)) & 0xF];
+    }
+    return sum;
+}
+
+/**
+ * \brief          Write a suffix half as hex characters
+ *
+ * \param[out]     out Receives BH_FLOOD_HALF_CHARS characters, not terminated
+ * \param[in]      half The half, one hex character per nibble, most significant first
+ */
+static void
+hash_bucket_write_half(char* out, uint32_t half) {
+    for (int i = 0; i < BH_FLOOD_HALF_CHARS; i++) {
+        out[i] = s_bucket_hex_digits[(half >> (4 * (BH_FLOOD_HALF_CHARS - 1 - i))) & 0xF];
+    }
+}
+
+/**
+ * \brief          Order flood halves by residue for qsort and the binary search
+ */
+static int
+flood_half_compare(const void* a, const void* b) {
+    uint64_t left = ((const flood_half_t*)a)->residue;
+    uint64_t right = ((const flood_half_t*)b)->residue;
+    return (left > right) - (left < right);
+}
+
+/****************************************************************
+                       EXTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Set up the bucket hasher of a run. A SipHash hasher gets a fresh random
+ *                 key, so the buckets of one run say nothing about the next one.
+ *
+ * \param[out]     hasher The hasher to set up
+ * \param[in]      mode The function used to place the digests
+ * \return         true on success, false when no random key could be drawn
+ */
+bool
+hash_bucket_hasher_init(hash_bucket_hasher_t* hasher, hash_bucket_mode_t mode) {
+    hasher->mode = mode == HASH_BUCKET_DJB2 ? HASH_BUCKET_DJB2 : HASH_BUCKET_SIPHASH;
+    hasher->key[0] = 0;
+    hasher->key[1] = 0;
+    if (hasher->mode == HASH_BUCKET_DJB2) {
+        return true;
+    }
+    return RAND_bytes((unsigned char*)hasher->key, sizeof(hasher->key)) == 1;
+}
+
+/**
+ * \brief          SipHash-1-3: one compression round per 8-byte word and three
+ *                 finalization rounds. It is a keyed function, without the key the output
+ *                 can not be predicted, which is all a hash table needs and half the
+ *                 rounds of SipHash-2-4.
+ *
+ * \param[in]      key The 128-bit key
+ * \param[in]      data The bytes to hash
+ * \param[in]      len The number of bytes
+ * \return         The 64-bit hash
+ */
+uint64_t
+hash_bucket_siphash13(const uint64_t key[2], const void* data, size_t len) {
+    return hash_siphash(key, 1, 3, data, len);
+}
+
+/**
+ * \brief          Uses djb2 algorithm to compute a simple hash for the given string.
+ *
+ * \param[in]      str The string to hash.
+ * \return         The 64-bit djb2 hash
+ */
+uint64_t
+hash_bucket_djb2(const char* str) {
+    uint64_t hash = 5381;
+    int c;
+    while ((c = *str++)) {               // Loops auto terminates at null character
+        hash = ((hash << 5) + hash) + c; // Multiply by 33 and add the current character
+    }
+    return hash;
+}
+
+/**
+ * \brief          Hash a digest with the function of the hasher
+ *
+ * \param[in]      hasher The hasher of the table
+ * \param[in]      hash_hex The hexadecimal string representation of the digest
+ * \return         The 64-bit hash the table derives the bucket from
+ */
+uint64_t
+hash_bucket_hash(const hash_bucket_hasher_t* hasher, const char* hash_hex) {
+    if (hasher->mode == HASH_BUCKET_DJB2) {
+        return hash_bucket_djb2(hash_hex);
+    }
+    return hash_bucket_siphash13(hasher->key, hash_hex, strlen(hash_hex));
+}
+
+/**
+ * \brief          Count chains of one length in a chain length histogram
+ *
+ * \param[in,out]  stats The histogram to add to
+ * \param[in]      length The length of the chains
+ * \param[in]      count The number of chains of that length
+ */
+void
+hash_chain_stats_add(hash_chain_stats_t* stats, size_t length, size_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    size_t bin = length < BH_CHAIN_HISTOGRAM_BINS - 1 ? length : BH_CHAIN_HISTOGRAM_BINS - 1;
+    stats->histogram[bin] += count;
+    if (length > stats->longest) {
+        stats->longest = length;
+    }
+}
+
+/**
+ * \brief          Craft keys that all have the same djb2 hash modulo a bucket modulus,
+ *                 the hash flooding an adversary can do against an unkeyed table. A key is
+ *                 a fixed prefix followed by two halves of BH_FLOOD_HALF_CHARS hex
+ *                 characters. djb2 is linear, so the hash of a key is a constant plus a
+ *                 weighted sum of its halves, and a meet in the middle over the residues
+ *                 of the second half finds every key in the bucket of the first one.
+ *                 The keys are upper case hex like the digests, but never as short.
+ *
+ * \param[in]      modulus The number of buckets the keys are crafted against, the bucket
+ *                 count of a chained table, or the group count times 128 of a flat table
+ *                 so that the keys also share their 7-bit tag
+ * \param[in]      prefix_length The number of characters before the halves
+ * \param[in]      count The number of keys to craft
+ * \param[out]     generated Receives the number of keys crafted, fewer than count when
+ *                 the halves run out against a large modulus
+ * \return         The keys, one after the other and each one terminated, every key is
+ *                 prefix_length + BH_FLOOD_SUFFIX_CHARS + 1 bytes apart. The caller frees
+ *                 it. NULL on memory allocation failure.
+ */
+char*
+hash_bucket_djb2_flood_keys(uint64_t modulus, size_t prefix_length, size_t count,
+                            size_t* generated) {
+    const size_t key_size = prefix_length + BH_FLOOD_SUFFIX_CHARS + 1;
+    *generated = 0;
+    if (modulus == 0) {
+        modulus = 1;
+    }
+
+    char* keys = malloc(count * key_size + 1);
+    flood_half_t* halves = malloc(BH_FLOOD_HALF_COUNT * sizeof(flood_half_t));
+    char* prefix = malloc(prefix_length + 1);
+    if (!keys || !halves || !prefix) {
+        free(keys);
+        free(halves);
+        free(prefix);
+        return NULL;
+    }
+
+    // 33 to the power of the length of one half
+    uint64_t half_weight = 1;
+    for (int i = 0; i < BH_FLOOD_HALF_CHARS; i++) {
+        half_weight *= 33;
+    }
+
+    // The sum of the halves stays below 2^53, so the prefix term is picked low enough
+    // that the 64-bit djb2 never wraps, which would break the residue arithmetic for a
+    // modulus that is not a power of two
+    uint64_t base = 0;
+    memset(prefix, 'F', prefix_length);
+    prefix[prefix_length] = '\0';
+    for (int digit = 15; digit >= 0; digit--) {
+        if (prefix_length > 0) {
+            prefix[0] = s_bucket_hex_digits[digit];
+        }
+        base = hash_bucket_djb2(prefix) * half_weight * half_weight;
+        if (base < UINT64_MAX - ((uint64_t)1 << 54)) {
+            break;
+        }
+    }
+
+    for (uint32_t half = 0; half < BH_FLOOD_HALF_COUNT; half++) {
+        halves[half].residue = hash_bucket_djb2_half(half) % modulus;
+        halves[half].half = half;
+    }
+    qsort(halves, BH_FLOOD_HALF_COUNT, sizeof(flood_half_t), flood_half_compare);
+
+    // Every key lands in the bucket of the key with both halves zero
+    uint64_t base_residue = base % modulus;
+    uint64_t target = (base_residue + (hash_bucket_djb2_half(0) * half_weight) % modulus
+                       + hash_bucket_djb2_half(0) % modulus)
+                      % modulus;
+
+    for (uint32_t first = 0; first < BH_FLOOD_HALF_COUNT && *generated < count; first++) {
+        uint64_t first_residue = (hash_bucket_djb2_half(first) * half_weight) % modulus;
+        uint64_t needed = (target + 2 * modulus - base_residue - first_residue) % modulus;
+
+        // Binary search the first second half with the needed residue
+        size_t low = 0;
+        size_t high = BH_FLOOD_HALF_COUNT;
+        while (low < high) {
+            size_t mid = low + (high - low) / 2;
+            if (halves[mid].residue < needed) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+
+        for (; low < BH_FLOOD_HALF_COUNT && halves[low].residue == needed && *generated < count;
+             low++) {
+            char* key = keys + *generated * key_size;
+            memcpy(key, prefix, prefix_length);
+            hash_bucket_write_half(key + prefix_length, first);
+            hash_bucket_write_half(key + prefix_length + BH_FLOOD_HALF_CHARS, halves[low].half);
+            key[key_size - 1] = '\0';
+            (*generated)++;
+        }
+    }
+
+    free(halves);
+    free(prefix);
+    return keys;
+}
@@ -0,0 +1,70 @@
+/**
+ * \file            hash_collision_bucket.h
+ * \brief           Header file for hash_collision_bucket.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_COLLISION_BUCKET_H
+#define HASH_COLLISION_BUCKET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * \brief          The number of bins of a chain length histogram, the last bin also counts
+ *                 every longer chain
+ */
+#define BH_CHAIN_HISTOGRAM_BINS 8
+
+/**
+ * \brief          The number of crafted keys the flood demonstration inserts. Against djb2
+ *                 they all share one chain, so every insert walks all the keys before it.
+ */
+#define BH_FLOOD_KEY_COUNT      20000
+
+/**
+ * \brief          The number of hex characters the flood generator appends to the prefix of
+ *                 every key, must be even
+ */
+#define BH_FLOOD_SUFFIX_CHARS   10
+
+/**
+ * \brief          How the digest tables turn a digest into a bucket. The values match the
+ *                 option numbers of the buckets field on the hash collision form.
+ */
+typedef enum {
+    HASH_BUCKET_SIPHASH = 1, ///< SipHash-1-3 with a random key drawn for every run
+    HASH_BUCKET_DJB2         ///< Unkeyed djb2, anyone can craft digests that share a bucket
+} hash_bucket_mode_t;
+
+typedef struct {
+    hash_bucket_mode_t mode; ///< The function used to place the digests
+    uint64_t key[2];         ///< The SipHash key of the run, unused by djb2
+} hash_bucket_hasher_t;
+
+/**
+ * \brief          The distribution of the chain lengths of a digest table. For the chained
+ *                 layout bin i counts the buckets holding i digests, for the flat layout bin
+ *                 i counts the digests stored in the (i + 1)th group of their probe sequence.
+ */
+typedef struct {
+    size_t histogram[BH_CHAIN_HISTOGRAM_BINS]; ///< The count of every length, see above
+    size_t longest;                            ///< The longest chain or probe sequence
+} hash_chain_stats_t;
+
+bool hash_bucket_hasher_init(hash_bucket_hasher_t* hasher, hash_bucket_mode_t mode);
+uint64_t hash_bucket_siphash13(const uint64_t key[2], const void* data, size_t len);
+uint64_t hash_bucket_djb2(const char* str);
+uint64_t hash_bucket_hash(const hash_bucket_hasher_t* hasher, const char* hash_hex);
+void hash_chain_stats_add(hash_chain_stats_t* stats, size_t length, size_t count);
+char* hash_bucket_djb2_flood_keys(uint64_t modulus, size_t prefix_length, size_t count,
+                                  size_t* generated);
+
+#endif
@@ -0,0 +1,279 @@
+/**
+ * \file            hash_collision_claw.c
+ * \brief           The build side of a claw search, where the digests of one input family
+ *                  are matched against the digests of another. The fingerprints of the first
+ *                  family are radix partitioned on their top bits into compact tables sized
+ *                  to fit in the cache. The workers group every chunk of digests by partition
+ *                  before they touch the tables, so a partition is locked once per chunk
+ *                  while building and stays in the cache while it is probed.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_claw.h"
+
+/****************************************************************
+                       EXTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Create the build table of a claw search, with enough partitions that each
+ *                 holds its share of the entries within BH_CLAW_PARTITION_BYTES. You should
+ *                 free the returned table using `hash_claw_table_destroy` when done.
+ *
+ * \param[in]      build_entries The number of inputs of family A
+ * \return         A pointer to the newly created table, or NULL on memory allocation failure
+ */
+hash_claw_table_t*
+hash_claw_table_create(size_t build_entries) {
+    hash_claw_table_t* table = calloc(1, sizeof(hash_claw_table_t));
+    if (!table) {
+        return NULL;
+    }
+
+    // Grow the partitions until the share of one fits the cache at the 3/4 load limit
+    size_t partition_entries = BH_CLAW_PARTITION_BYTES / sizeof(hash_compact_entry_t) * 3 / 4;
+    while (table->partition_bits < BH_CLAW_MAX_PARTITION_BITS
+           && (build_entries >> table->partition_bits) > partition_entries) {
+        table->partition_bits++;
+    }
+    table->partition_count = 1u << table->partition_bits;
+
+    table->partitions = calloc(table->partition_count, sizeof(hash_compact_table_t*));
+    table->locks = calloc(table->partition_count, sizeof(GMutex));
+    if (!table->partitions || !table->locks) {
+        hash_claw_table_destroy(table);
+        return NULL;
+    }
+
+    size_t share = (build_entries >> table->partition_bits) + 1;
+    for (unsigned int i = 0; i < table->partition_count; i++) {
+        g_mutex_init(&table->locks[i]);
+        table->partitions[i] = hash_compact_table_create(share);
+        if (!table->partitions[i]) {
+            hash_claw_table_destroy(table);
+            return NULL;
+        }
+    }
+    return table;
+}
+
+/**
+ * \brief          Get the partition a fingerprint belongs to. The compact tables place the
+ *                 fingerprint by its low bits, so the partitions take the top ones.
+ *
+ * \param[in]      table The build table
+ * \param[in]      fingerprint The fingerprint of the digest
+ * \return         The index of the partition
+ */
+unsigned int
+hash_claw_partition(const hash_claw_table_t* table, uint64_t fingerprint) {
+    return table->partition_bits ? (unsigned int)(fingerprint >> (64 - table->partition_bits))
+                                 : 0;
+}
+
+/**
+ * \brief          Order the digests of a chunk by partition with a counting sort, keeping
+ *                 their order within a partition
+ *
+ * \param[in]      table The build table
+ * \param[in]      fingerprints The fingerprints of the chunk
+ * \param[in]      count The number of fingerprints
+ * \param[out]     counts Scratch space of partition_count + 1 entries, receives the index in
+ *                 order where every partition starts, and the count at the end
+ * \param[out]     order Receives the index of every fingerprint, partition by partition
+ */
+void
+hash_claw_partition_order(const hash_claw_table_t* table, const uint64_t* fingerprints,
+                          unsigned int count, unsigned int* counts, unsigned int* order) {
+    memset(counts, 0, (table->partition_count + 1) * sizeof(unsigned int));
+    for (unsigned int i = 0; i < count; i++) {
+        counts[hash_claw_partition(table, fingerprints[i]) + 1]++;
+    }
+    for (unsigned int p = 0; p < table->partition_count; p++) {
+        counts[p + 1] += counts[p];
+    }
+
+    // The starts move while the digests are placed and are set back after
+    for (unsigned int i = 0; i < count; i++) {
+        order[counts[hash_claw_partition(table, fingerprints[i])]++] = i;
+    }
+    for (unsigned int p = table->partition_count; p > 0; p--) {
+        counts[p] = counts[p - 1];
+    }
+    counts[0] = 0;
+}
+
+/**
+ * \brief          Insert a chunk of family A into the build table. The chunk is ordered by
+ *                 partition first, so every partition is locked once.
+ *
+ * \param[in]      table The build table
+ * \param[in]      fingerprints The fingerprints of the chunk
+ * \param[in]      payloads The payload of every fingerprint
+ * \param[in]      count The number of fingerprints
+ * \param[out]     counts Scratch space of partition_count + 1 entries
+ * \param[out]     order Scratch space of count entries
+ * \return         true on success, false on memory allocation failure while growing
+ */
+bool
+hash_claw_table_insert(hash_claw_table_t* table, const uint64_t* fingerprints,
+                       const uint64_t* payloads, unsigned int count, unsigned int* counts,
+                       unsigned int* order) {
+    hash_claw_partition_order(table, fingerprints, count, counts, order);
+
+    bool ok = true;
+    for (unsigned int p = 0; p < table->partition_count && ok; p++) {
+        if (counts[p] == counts[p + 1]) {
+            continue;
+        }
+
+        g_mutex_lock(&table->locks[p]);
+        for (unsigned int k = counts[p]; k < counts[p + 1] && ok; k++) {
+            uint64_t existing;
+            bool found;
+            unsigned int i = order[k];
+
+            // A digest family A already has is a collision within A, the first input is kept
+            ok = hash_compact_table_find_or_insert(table->partitions[p], fingerprints[i],
+                                                   payloads[i], &existing, &found);
+        }
+        g_mutex_unlock(&table->locks[p]);
+    }
+    return ok;
+}
+
+/**
+ * \brief          Look up a digest of family B in the build table, once the build is done
+ *
+ * \param[in]      table The build table
+ * \param[in]      fingerprint The fingerprint of the digest
+ * \param[out]     payload Receives the payload of the family A input when found
+ * \return         true if family A has the fingerprint
+ */
+bool
+hash_claw_table_find(const hash_claw_table_t* table, uint64_t fingerprint, uint64_t* payload) {
+    return hash_compact_table_find(table->partitions[hash_claw_partition(table, fingerprint)],
+                                   fingerprint, payload);
+}
+
+/**
+ * \brief          Get the number of bytes used by the partitions of the table
+ *
+ * \param[in]      table The table to measure
+ * \return         The size of the table in bytes, 0 if table is NULL
+ */
+size_t
+hash_claw_table_memory_size(const hash_claw_table_t* table) {
+    if (!table) {
+        return 0;
+    }
+
+    size_t bytes = 0;
+    for (unsigned int i = 0; i < table->partition_count; i++) {
+        bytes += hash_compact_table_memory_size(table->partitions[i]);
+    }
+    return bytes;
+}
+
+/**
+ * \brief          Destroy the table with its partitions
+ *
+ * \param[in]      table The table to destroy, NULL is ignored
+ */
+void
+hash_claw_table_destroy(hash_claw_table_t* table) {
+    if (!table) {
+        return;
+    }
+
+    for (unsigned int i = 0; table->partitions && i < table->partition_count; i++) {
+        hash_compact_table_destroy(table->partitions[i]);
+    }
+    for (unsigned int i = 0; table->locks && i < table->partition_count; i++) {
+        g_mutex_clear(&table->locks[i]);
+    }
+    free(table->partitions);
+    free(table->locks);
+    free(table);
+}
+
+/**
+ * \brief          Create a claw search with its build table. You should free the returned
+ *                 search using `hash_claw_search_destroy` when done.
+ *
+ * \param[in]      hash_a The hash function of family A
+ * \param[in]      hash_b The hash function of family B
+ * \param[in]      bits The leading digest bits compared, 1 to BH_CLAW_MAX_BITS and at most
+ *                 the output bits of both hash functions
+ * \param[in]      build_size The number of inputs of family A
+ * \return         A pointer to the newly created search, or NULL on memory allocation failure
+ *                 or when bits is out of range
+ */
+hash_claw_search_t*
+hash_claw_search_create(enum hash_function_ids hash_a, enum hash_function_ids hash_b,
+                        unsigned int bits, unsigned int build_size) {
+    if (bits == 0 || bits > BH_CLAW_MAX_BITS || bits > get_hash_config_item(hash_a).bits
+        || bits > get_hash_config_item(hash_b).bits) {
+        return NULL;
+    }
+
+    hash_claw_search_t* search = calloc(1, sizeof(hash_claw_search_t));
+    if (!search) {
+        return NULL;
+    }
+
+    search->hash_ids[HASH_CLAW_FAMILY_A] = hash_a;
+    search->hash_ids[HASH_CLAW_FAMILY_B] = hash_b;
+    search->labels[HASH_CLAW_FAMILY_A] = 'A';
+    search->labels[HASH_CLAW_FAMILY_B] = 'B';
+    search->bits = bits;
+    search->build_size = build_size;
+    search->table = hash_claw_table_create(build_size);
+    if (!search->table) {
+        free(search);
+        return NULL;
+    }
+    return search;
+}
+
+/**
+ * \brief          Make the inputs of a claw search the variants of a built-in pair of
+ *                 messages, the honest message for family A and the fraudulent one for B
+ *
+ * \param[in]      search The search, before any worker runs
+ * \param[in]      pair The pair, 0 to hash_yuval_pair_count() - 1
+ * \return         false on memory allocation failure or for an unknown pair, true otherwise
+ */
+bool
+hash_claw_search_use_messages(hash_claw_search_t* search, unsigned int pair) {
+    for (int family = HASH_CLAW_FAMILY_A; family <= HASH_CLAW_FAMILY_B; family++) {
+        search->messages[family] = malloc(sizeof(hash_yuval_template_t));
+        if (!search->messages[family]
+            || !hash_yuval_template_parse(pair, (unsigned int)family, search->messages[family])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * \brief          Destroy the search with its build table
+ *
+ * \param[in]      search The search to destroy, NULL is ignored
+ */
+void
+hash_claw_search_destroy(hash_claw_search_t* search) {
+    if (!search) {
+        return;
+    }
+
+    hash_claw_table_destroy(search->table);
+    free(search->messages[HASH_CLAW_FAMILY_A]);
+    free(search->messages[HASH_CLAW_FAMILY_B]);
+    free(search);
+}
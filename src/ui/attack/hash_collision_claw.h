@@ -0,0 +1,113 @@
+/**
+ * \file            hash_collision_claw.h
+ * \brief           Header file for hash_collision_claw.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_COLLISION_CLAW_H
+#define HASH_COLLISION_CLAW_H
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "hash_collision_compact.h"
+#include "hash_collision_yuval.h"
+#include "hash_config.h"
+
+/**
+ * \brief          The bytes one partition of the build table is sized for, the share of a
+ *                 per core L2 cache a probe can keep hot
+ */
+#define BH_CLAW_PARTITION_BYTES (256 * 1024)
+
+/**
+ * \brief          The most partitions of the build table, the partition is taken from the top
+ *                 bits of the fingerprint
+ */
+#define BH_CLAW_MAX_PARTITION_BITS 16
+
+/**
+ * \brief          The digests a worker hashes before it scatters them over the partitions.
+ *                 The probes of a chunk are made partition by partition, so each partition is
+ *                 loaded into the cache once per chunk.
+ */
+#define BH_CLAW_CHUNK_SIZE 1024
+
+/**
+ * \brief          The most leading digest bits a claw search compares, the compared digest fits
+ *                 the 64-bit fingerprint so fingerprints never match by chance
+ */
+#define BH_CLAW_MAX_BITS 64
+
+/**
+ * \brief          The families of a claw search, the index of a family in its arrays
+ */
+typedef enum {
+    HASH_CLAW_FAMILY_A = 0, ///< The build side, every input is stored
+    HASH_CLAW_FAMILY_B      ///< The probe side, every input is looked up in the build side
+} hash_claw_family_t;
+
+/**
+ * \brief          The build side of a claw search: the fingerprints of family A with the index
+ *                 of their input, spread over compact tables that each fit in the cache. The
+ *                 partitions are written under their own lock while the build runs and read
+ *                 without one once it is done.
+ */
+typedef struct {
+    hash_compact_table_t** partitions; ///< The tables, partition_count of them
+    GMutex* locks;                     ///< Guards the table of the same index while building
+    unsigned int partition_bits;       ///< The top fingerprint bits that select the partition
+    unsigned int partition_count;      ///< The number of partitions, 2^partition_bits
+} hash_claw_table_t;
+
+/**
+ * \brief          A claw search: an input of family A and an input of family B whose digests
+ *                 share their leading bits. The inputs of a family start with its label, so
+ *                 the families never share an input even with the same hash function. With
+ *                 messages, the inputs are the variants of the honest message for family A
+ *                 and of the fraudulent one for family B instead, numbered from 0 over all
+ *                 the workers.
+ */
+typedef struct {
+    enum hash_function_ids hash_ids[2]; ///< The hash function of each family
+    char labels[2];                     ///< The byte each input of a family starts with
+    unsigned int bits;                  ///< The leading digest bits compared
+    unsigned int build_size;            ///< The number of inputs of family A
+    hash_claw_table_t* table;           ///< The build side, family A
+    int built;                          ///< The inputs of family A stored so far, atomic
+    gint64 build_finished_at;           ///< Monotonic time in microseconds the build finished
+    int found;                          ///< Set once a claw is found, read atomically
+    guint64 point;                      ///< The inputs of family B probed up to the claw
+    guint64 fingerprint_matches;        ///< Fingerprints found that were not a claw
+    hash_yuval_template_t* messages[2]; ///< The message of each family, NULL for random inputs
+    uint64_t found_variants[2];         ///< The variant of each family that made the claw
+    guint64 bytes_hashed;               ///< The bytes the message hashers hashed
+    guint64 message_bytes;              ///< The bytes of the variants they hashed, in full
+} hash_claw_search_t;
+
+hash_claw_table_t* hash_claw_table_create(size_t build_entries);
+unsigned int hash_claw_partition(const hash_claw_table_t* table, uint64_t fingerprint);
+void hash_claw_partition_order(const hash_claw_table_t* table, const uint64_t* fingerprints,
+                               unsigned int count, unsigned int* counts, unsigned int* order);
+bool hash_claw_table_insert(hash_claw_table_t* table, const uint64_t* fingerprints,
+                            const uint64_t* payloads, unsigned int count, unsigned int* counts,
+                            unsigned int* order);
+bool hash_claw_table_find(const hash_claw_table_t* table, uint64_t fingerprint,
+                          uint64_t* payload);
+size_t hash_claw_table_memory_size(const hash_claw_table_t* table);
+void hash_claw_table_destroy(hash_claw_table_t* table);
+
+hash_claw_search_t* hash_claw_search_create(enum hash_function_ids hash_a,
+                                            enum hash_function_ids hash_b, unsigned int bits,
+                                            unsigned int build_size);
+bool hash_claw_search_use_messages(hash_claw_search_t* search, unsigned int pair);
+void hash_claw_search_destroy(hash_claw_search_t* search);
+
+#endif
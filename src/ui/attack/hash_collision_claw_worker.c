@@ -0,0 +1,348 @@
+/**
+ * \file            hash_collision_claw_worker.c
+ * \brief           The worker of the claw page, which stores the inputs of one family in the
+ *                  build table and looks the inputs of the other family up in it
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_claw_worker.h"
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          The inputs and digests of the chunk a claw worker is working on, allocated
+ *                 once per worker
+ */
+typedef struct {
+    uint8_t inputs[BH_CLAW_CHUNK_SIZE][32];         ///< The inputs, the family label first
+    size_t input_lens[BH_CLAW_CHUNK_SIZE];          ///< The length of every input in bytes
+    char truncated[BH_CLAW_CHUNK_SIZE][17];         ///< The compared bits of every digest
+    uint64_t fingerprints[BH_CLAW_CHUNK_SIZE];      ///< The fingerprint of every digest
+    uint64_t payloads[BH_CLAW_CHUNK_SIZE];          ///< The worker and index of every input
+    unsigned int order[BH_CLAW_CHUNK_SIZE];         ///< The digests ordered by partition
+    unsigned int counts[(1u << BH_CLAW_MAX_PARTITION_BITS) + 1]; ///< Where every partition starts
+    uint64_t variants[BH_CLAW_CHUNK_SIZE];          ///< The variant of every input with messages
+    hash_yuval_hasher_t* hasher;                    ///< The hasher of the message, or NULL
+} claw_chunk_t;
+
+/**
+ * \brief          Get the variant of the message of a claw family an input stands for. The
+ *                 workers of a pass take consecutive variants, worker 0 first with the
+ *                 remainder, so the hasher of a worker keeps the longest common prefix.
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      family The family of the input
+ * \param[in]      worker_id The id of the worker that owns the input
+ * \param[in]      index The index of the input within the worker
+ * \return         The variant
+ */
+static uint64_t
+claw_variant(hash_collision_context_t* ctx, hash_claw_family_t family, unsigned int worker_id,
+             guint32 index) {
+    unsigned int total =
+        family == HASH_CLAW_FAMILY_A ? ctx->claw->build_size : ctx->max_attempts;
+    return (uint64_t)hash_collision_worker_first_attempt(total, ctx->worker_count, worker_id)
+           + index;
+}
+
+/**
+ * \brief          Generate an input of a claw family from its index: the label of the family
+ *                 followed by the input generate_indexed_input makes for the index
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      family The family of the input
+ * \param[in]      worker_id The id of the worker that owns the input
+ * \param[in]      index The index of the input within the worker
+ * \param[out]     buffer Receives the input, at least 32 bytes
+ * \return         The length of the input in bytes
+ */
+static size_t
+claw_generate_input(hash_collision_context_t* ctx, hash_claw_family_t family,
+                    unsigned int worker_id, guint32 index, uint8_t* buffer) {
+    buffer[0] = (uint8_t)ctx->claw->labels[family];
+    return 1 + generate_indexed_input(ctx->run_seed, worker_id, index, buffer + 1, 4, 31);
+}
+
+/**
+ * \brief          Generate and hash a chunk of inputs of a claw family, keeping the compared
+ *                 bits of every digest with their fingerprint
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      family The family of the inputs
+ * \param[in]      worker_id The id of the worker the inputs belong to
+ * \param[in]      first_index The index of the first input of the chunk
+ * \param[in]      count The number of inputs of the chunk
+ * \param[out]     chunk Receives the inputs, their digests and their payloads
+ * \return         false when a hash failed and the error is registered, true otherwise
+ */
+static bool
+claw_hash_chunk(hash_collision_context_t* ctx, hash_claw_family_t family,
+                unsigned int worker_id, guint32 first_index, unsigned int count,
+                claw_chunk_t* chunk) {
+    hash_claw_search_t* claw = ctx->claw;
+    for (unsigned int i = 0; i < count; i++) {
+        if (chunk->hasher) {
+            // The variant is hashed from the state its prefix left, it is only written in
+            // full to confirm a claw
+            char hash_hex[BH_YUVAL_MAX_HEX];
+            chunk->variants[i] = claw_variant(ctx, family, worker_id, first_index + i);
+            if (!hash_yuval_hasher_digest(chunk->hasher, chunk->variants[i], hash_hex)) {
+                REGISTER_ERROR_FUNC(ctx, worker_id, ERROR_HASH_COMPUTATION,
+                                    "Message variant hash failed");
+                return false;
+            }
+            truncate_hex_digest(hash_hex, claw->bits, chunk->truncated[i]);
+        } else {
+            chunk->input_lens[i] =
+                claw_generate_input(ctx, family, worker_id, first_index + i, chunk->inputs[i]);
+
+            char hash_hex[BH_HASH_MAX_HEX];
+            if (!compute_hash(claw->hash_ids[family], chunk->inputs[i], chunk->input_lens[i],
+                              hash_hex)) {
+                REGISTER_ERROR_FUNC(ctx, worker_id, ERROR_HASH_COMPUTATION,
+                                    "Hash function returned invalid result");
+                return false;
+            }
+            truncate_hex_digest(hash_hex, claw->bits, chunk->truncated[i]);
+        }
+
+        chunk->fingerprints[i] = hash_filter_fingerprint(chunk->truncated[i]);
+        chunk->payloads[i] = ((uint64_t)worker_id << 32) | (first_index + i);
+    }
+    return true;
+}
+
+/**
+ * \brief          The build worker of a claw search, stores its share of family A in the
+ *                 partitioned build table chunk by chunk
+ *
+ * \param[in]      worker The data of this worker
+ * \param[in]      chunk The chunk buffers of this worker
+ */
+static void
+hash_collision_claw_build_worker(WorkerData* worker, claw_chunk_t* chunk) {
+    hash_collision_context_t* ctx = worker->ctx;
+    hash_claw_search_t* claw = ctx->claw;
+
+    unsigned int attempt = 0;
+    while (attempt < worker->attempts_to_make && !g_atomic_int_get((gint*)&ctx->cancel)) {
+        unsigned int count = worker->attempts_to_make - attempt;
+        if (count > BH_CLAW_CHUNK_SIZE) {
+            count = BH_CLAW_CHUNK_SIZE;
+        }
+
+        if (!claw_hash_chunk(ctx, HASH_CLAW_FAMILY_A, worker->worker_id, attempt, count,
+                             chunk)) {
+            return;
+        }
+        if (!hash_claw_table_insert(claw->table, chunk->fingerprints, chunk->payloads, count,
+                                    chunk->counts, chunk->order)) {
+            REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_HASH_TABLE_INSERT,
+                                "Fingerprint insert into claw build table failed");
+            return;
+        }
+
+        g_atomic_int_add(&claw->built, (gint)count);
+        attempt += count;
+    }
+}
+
+/**
+ * \brief          Confirm a fingerprint of family B found in the build table by regenerating
+ *                 the input of family A and hashing it, then record the claw unless another
+ *                 worker already has.
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      worker_id The id of the worker that probed the input
+ * \param[in]      chunk The chunk the input of family B is in
+ * \param[in]      i The index of the input of family B in the chunk
+ * \param[in]      payload The payload of the family A input stored with the fingerprint
+ * \param[in]      point The inputs of family B probed up to and with this one
+ * \return         false when a hash or an allocation failed and the error is registered,
+ *                 true otherwise
+ */
+static bool
+resolve_claw_candidate(hash_collision_context_t* ctx, unsigned int worker_id,
+                       const claw_chunk_t* chunk, unsigned int i, uint64_t payload,
+                       guint64 point) {
+    hash_claw_search_t* claw = ctx->claw;
+
+    // A variant of a message is written and hashed in full, which also checks the digest the
+    // hasher made from its cached states
+    uint8_t input_a[BH_YUVAL_MAX_MESSAGE];
+    size_t input_a_len;
+    uint64_t variant_a = 0;
+    if (claw->messages[HASH_CLAW_FAMILY_A]) {
+        variant_a = claw_variant(ctx, HASH_CLAW_FAMILY_A, (unsigned int)(payload >> 32),
+                                 (guint32)payload);
+        input_a_len = hash_yuval_variant(claw->messages[HASH_CLAW_FAMILY_A], variant_a, input_a);
+    } else {
+        input_a_len = claw_generate_input(ctx, HASH_CLAW_FAMILY_A, (unsigned int)(payload >> 32),
+                                          (guint32)payload, input_a);
+    }
+
+    char hash_hex[BH_HASH_MAX_HEX];
+    if (!compute_hash(claw->hash_ids[HASH_CLAW_FAMILY_A], input_a, input_a_len, hash_hex)) {
+        REGISTER_ERROR_FUNC(ctx, worker_id, ERROR_HASH_COMPUTATION,
+                            "Hash function returned invalid result");
+        return false;
+    }
+
+    char truncated[17];
+    bool is_claw = strcmp(truncate_hex_digest(hash_hex, claw->bits, truncated),
+                          chunk->truncated[i])
+                   == 0;
+
+    g_mutex_lock(ctx->result_mutex);
+    bool ok = true;
+    if (!is_claw) {
+        claw->fingerprint_matches++;
+    } else if (!g_atomic_int_get(&claw->found) || point < claw->point) {
+        uint8_t input_b[BH_YUVAL_MAX_MESSAGE];
+        size_t input_b_len = chunk->input_lens[i];
+        if (claw->messages[HASH_CLAW_FAMILY_B]) {
+            input_b_len =
+                hash_yuval_variant(claw->messages[HASH_CLAW_FAMILY_B], chunk->variants[i], input_b);
+            claw->found_variants[HASH_CLAW_FAMILY_A] = variant_a;
+            claw->found_variants[HASH_CLAW_FAMILY_B] = chunk->variants[i];
+        } else {
+            memcpy(input_b, chunk->inputs[i], input_b_len);
+        }
+
+        char* input_1 = bytes_to_hex(input_a, input_a_len, true);
+        char* input_2 = bytes_to_hex(input_b, input_b_len, true);
+        char* digest = g_strdup(truncated);
+        if (input_1 && input_2 && digest) {
+            hash_collision_simulation_result_t* result = ctx->result;
+            free(result->collision_input_1);
+            free(result->collision_input_2);
+            free(result->collision_hash_hex);
+            result->collision_input_1 = input_1;
+            result->collision_input_2 = input_2;
+            result->collision_hash_hex = digest;
+            result->collision_found = true;
+            claw->point = point;
+            g_atomic_int_set(&claw->found, 1);
+        } else {
+            free(input_1);
+            free(input_2);
+            g_free(digest);
+            REGISTER_ERROR_FUNC(ctx, worker_id, ERROR_MEMORY_ALLOCATION,
+                                "Input hex string allocation failed");
+            ok = false;
+        }
+    }
+    g_mutex_unlock(ctx->result_mutex);
+    return ok;
+}
+
+/**
+ * \brief          The probe worker of a claw search, streams its share of family B through
+ *                 the build table. Every chunk is ordered by partition and probed partition
+ *                 by partition, so each partition is read from the cache while its digests
+ *                 are looked up. The worker stops once a claw is found.
+ *
+ * \param[in]      worker The data of this worker
+ * \param[in]      chunk The chunk buffers of this worker
+ */
+static void
+hash_collision_claw_probe_worker(WorkerData* worker, claw_chunk_t* chunk) {
+    hash_collision_context_t* ctx = worker->ctx;
+    hash_claw_search_t* claw = ctx->claw;
+
+    bool ok = true;
+    unsigned int attempt = 0;
+    while (ok && attempt < worker->attempts_to_make && !g_atomic_int_get(&claw->found)
+           && !g_atomic_int_get((gint*)&ctx->cancel)) {
+        unsigned int count = worker->attempts_to_make - attempt;
+        if (count > BH_CLAW_CHUNK_SIZE) {
+            count = BH_CLAW_CHUNK_SIZE;
+        }
+
+        if (!claw_hash_chunk(ctx, HASH_CLAW_FAMILY_B, worker->worker_id, attempt, count,
+                             chunk)) {
+            return;
+        }
+
+        // The inputs of family B before the chunk, counted over every worker
+        guint64 probed = (guint)g_atomic_int_add((gint*)&ctx->result->attempts_made, (gint)count);
+
+        hash_claw_partition_order(claw->table, chunk->fingerprints, count, chunk->counts,
+                                  chunk->order);
+        for (unsigned int k = 0; k < count && ok; k++) {
+            unsigned int i = chunk->order[k];
+            uint64_t payload;
+            if (hash_claw_table_find(claw->table, chunk->fingerprints[i], &payload)) {
+                ok = resolve_claw_candidate(ctx, worker->worker_id, chunk, i, payload,
+                                            probed + i + 1);
+            }
+        }
+        attempt += count;
+    }
+}
+
+/**************************************************************
+                      EXTERNAL FUNCTIONS
+**************************************************************/
+
+/**
+ * \brief          Run a worker of a claw search. The last build worker records when the
+ *                 build finished and schedules the probe workers, which are counted in
+ *                 remaining_workers before it leaves.
+ *
+ * \param[in]      worker The data of this worker
+ */
+void
+hash_collision_claw_worker(WorkerData* worker) {
+    hash_collision_context_t* ctx = worker->ctx;
+    claw_chunk_t* chunk = malloc(sizeof(claw_chunk_t));
+    if (!chunk) {
+        REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_MEMORY_ALLOCATION,
+                            "Claw chunk allocation failed");
+    } else {
+        hash_claw_family_t family =
+            worker->pass == HASH_PASS_CLAW_BUILD ? HASH_CLAW_FAMILY_A : HASH_CLAW_FAMILY_B;
+        hash_claw_search_t* claw = ctx->claw;
+        chunk->hasher = NULL;
+        if (claw->messages[family]) {
+            chunk->hasher =
+                hash_yuval_hasher_create(claw->hash_ids[family], claw->messages[family]);
+            if (!chunk->hasher) {
+                REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_MEMORY_ALLOCATION,
+                                    "Message hasher allocation failed");
+            }
+        }
+
+        if (!claw->messages[family] || chunk->hasher) {
+            if (family == HASH_CLAW_FAMILY_A) {
+                hash_collision_claw_build_worker(worker, chunk);
+            } else {
+                hash_collision_claw_probe_worker(worker, chunk);
+            }
+        }
+
+        if (chunk->hasher) {
+            g_mutex_lock(ctx->result_mutex);
+            claw->bytes_hashed += chunk->hasher->bytes_hashed;
+            claw->message_bytes += chunk->hasher->message_bytes;
+            g_mutex_unlock(ctx->result_mutex);
+            hash_yuval_hasher_destroy(chunk->hasher);
+        }
+    }
+    free(chunk);
+
+    if (worker->pass == HASH_PASS_CLAW_BUILD
+        && g_atomic_int_dec_and_test((gint*)&ctx->pass_one_pending)) {
+        ctx->claw->build_finished_at = g_get_monotonic_time();
+        if (!g_atomic_int_get((gint*)&ctx->cancel) && !ctx->error_info->has_error) {
+            hash_collision_submit_workers(ctx, HASH_PASS_CLAW_PROBE);
+        }
+    }
+}
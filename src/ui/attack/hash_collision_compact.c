@@ -0,0 +1,224 @@
+/**
+ * \file            hash_collision_compact.c
+ * \brief           A compact, open addressing digest table that keeps 16 bytes per digest:
+ *                  a 64-bit fingerprint and a 64-bit payload. Neither the digest nor its
+ *                  input are stored, the payload holds what the caller needs to regenerate
+ *                  the input, and a fingerprint match is confirmed by hashing it again.
+ *                  Slots are probed linearly, the fingerprint is already well mixed.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_compact.h"
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Get the number of slots that holds the entries under the 3/4 load limit
+ *
+ * \param[in]      entries The number of entries to hold
+ * \return         The number of slots, a power of two of at least 16
+ */
+static size_t
+hash_compact_slot_count(size_t entries) {
+    size_t slot_count = 16;
+    while (slot_count * 3 / 4 < entries) {
+        slot_count *= 2;
+    }
+    return slot_count;
+}
+
+/**
+ * \brief          Allocate the slots of a table, every slot starts empty
+ *
+ * \param[in]      table The table to allocate, its previous slots are not freed
+ * \param[in]      slot_count The number of slots, must be a power of two
+ * \return         true on success, false on memory allocation failure
+ */
+static bool
+hash_compact_allocate_slots(hash_compact_table_t* table, size_t slot_count) {
+    hash_compact_entry_t* slots = malloc(slot_count * sizeof(hash_compact_entry_t));
+    if (!slots) {
+        return false;
+    }
+
+    // Every byte 0xFF makes every payload BH_COMPACT_EMPTY
+    memset(slots, 0xFF, slot_count * sizeof(hash_compact_entry_t));
+    table->slots = slots;
+    table->slot_mask = slot_count - 1;
+    table->growth_left = slot_count * 3 / 4 - table->entry_count;
+    return true;
+}
+
+/**
+ * \brief          Double the number of slots and place every entry again
+ *
+ * \param[in]      table The table to grow
+ * \return         true on success, false on memory allocation failure, the table is left
+ *                 unchanged
+ */
+static bool
+hash_compact_grow(hash_compact_table_t* table) {
+    hash_compact_entry_t* old_slots = table->slots;
+    size_t old_count = table->slot_mask + 1;
+
+    if (!hash_compact_allocate_slots(table, old_count * 2)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < old_count; i++) {
+        if (old_slots[i].payload == BH_COMPACT_EMPTY) {
+            continue;
+        }
+
+        size_t slot = old_slots[i].fingerprint & table->slot_mask;
+        while (table->slots[slot].payload != BH_COMPACT_EMPTY) {
+            slot = (slot + 1) & table->slot_mask;
+        }
+        table->slots[slot] = old_slots[i];
+    }
+
+    free(old_slots);
+    return true;
+}
+
+/****************************************************************
+                       EXTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Create a new compact table sized for the expected number of entries.
+ *                 The table grows when more are inserted. You should free the returned
+ *                 table using `hash_compact_table_destroy` when done.
+ *
+ * \param[in]      expected_entries The number of entries expected to be inserted
+ * \return         A pointer to the newly created table, or NULL on memory allocation failure
+ */
+hash_compact_table_t*
+hash_compact_table_create(size_t expected_entries) {
+    hash_compact_table_t* table = calloc(1, sizeof(hash_compact_table_t));
+    if (!table) {
+        return NULL;
+    }
+
+    if (!hash_compact_allocate_slots(table, hash_compact_slot_count(expected_entries))) {
+        free(table);
+        return NULL;
+    }
+    return table;
+}
+
+/**
+ * \brief          Look up a fingerprint and insert it with its payload when it is absent.
+ *                 Different digests can share a fingerprint, so a found payload is only a
+ *                 candidate that the caller has to confirm.
+ *
+ * \param[in]      table The table to search and insert into
+ * \param[in]      fingerprint The fingerprint of the digest
+ * \param[in]      payload The payload to store, must not be BH_COMPACT_EMPTY
+ * \param[out]     existing_payload Receives the stored payload when the fingerprint is found
+ * \param[out]     found Receives whether the fingerprint was found, nothing is inserted then
+ * \return         true on success, false on memory allocation failure while growing
+ */
+bool
+hash_compact_table_find_or_insert(hash_compact_table_t* table, uint64_t fingerprint,
+                                  uint64_t payload, uint64_t* existing_payload, bool* found) {
+    size_t slot = fingerprint & table->slot_mask;
+    while (table->slots[slot].payload != BH_COMPACT_EMPTY) {
+        if (table->slots[slot].fingerprint == fingerprint) {
+            *existing_payload = table->slots[slot].payload;
+            *found = true;
+            return true;
+        }
+        slot = (slot + 1) & table->slot_mask;
+    }
+
+    *found = false;
+    if (table->growth_left == 0) {
+        if (!hash_compact_grow(table)) {
+            return false;
+        }
+
+        // The empty slot found above has moved with the growth
+        slot = fingerprint & table->slot_mask;
+        while (table->slots[slot].payload != BH_COMPACT_EMPTY) {
+            slot = (slot + 1) & table->slot_mask;
+        }
+    }
+
+    table->slots[slot].fingerprint = fingerprint;
+    table->slots[slot].payload = payload;
+    table->entry_count++;
+    table->growth_left--;
+    return true;
+}
+
+/**
+ * \brief          Look up a fingerprint without inserting it. The table must not change
+ *                 while it is read.
+ *
+ * \param[in]      table The table to search
+ * \param[in]      fingerprint The fingerprint of the digest
+ * \param[out]     payload Receives the stored payload when the fingerprint is found
+ * \return         true if the fingerprint is found
+ */
+bool
+hash_compact_table_find(const hash_compact_table_t* table, uint64_t fingerprint,
+                        uint64_t* payload) {
+    size_t slot = fingerprint & table->slot_mask;
+    while (table->slots[slot].payload != BH_COMPACT_EMPTY) {
+        if (table->slots[slot].fingerprint == fingerprint) {
+            *payload = table->slots[slot].payload;
+            return true;
+        }
+        slot = (slot + 1) & table->slot_mask;
+    }
+    return false;
+}
+
+/**
+ * \brief          Get the number of bytes used by the slots of the table
+ *
+ * \param[in]      table The table to measure
+ * \return         The size of the table in bytes, 0 if table is NULL
+ */
+size_t
+hash_compact_table_memory_size(const hash_compact_table_t* table) {
+    if (!table) {
+        return 0;
+    }
+    return (table->slot_mask + 1) * sizeof(hash_compact_entry_t);
+}
+
+/**
+ * \brief          Get the number of bytes a table would take once the expected number of
+ *                 entries are inserted, without creating it
+ *
+ * \param[in]      expected_entries The number of entries
+ * \return         The size of the table in bytes
+ */
+size_t
+hash_compact_table_estimate_bytes(size_t expected_entries) {
+    return hash_compact_slot_count(expected_entries) * sizeof(hash_compact_entry_t);
+}
+
+/**
+ * \brief          Destroy the table and free its slots
+ *
+ * \param[in]      table The table to destroy, NULL is ignored
+ */
+void
+hash_compact_table_destroy(hash_compact_table_t* table) {
+    if (!table) {
+        return;
+    }
+
+    free(table->slots);
+    free(table);
+}
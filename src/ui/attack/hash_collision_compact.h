@@ -0,0 +1,52 @@
+/**
+ * \file            hash_collision_compact.h
+ * \brief           Header file for hash_collision_compact.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_COLLISION_COMPACT_H
+#define HASH_COLLISION_COMPACT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * \brief          The payload of an empty slot. Callers pack their payloads so that they
+ *                 never take this value.
+ */
+#define BH_COMPACT_EMPTY UINT64_MAX
+
+/**
+ * \brief          One slot of the compact table: a 64-bit fingerprint of the digest and
+ *                 a payload the caller uses to regenerate whatever produced the digest
+ */
+typedef struct {
+    uint64_t fingerprint; ///< The fingerprint of the digest, from hash_filter_fingerprint
+    uint64_t payload;     ///< The caller data, BH_COMPACT_EMPTY for an empty slot
+} hash_compact_entry_t;
+
+typedef struct {
+    hash_compact_entry_t* slots; ///< The slots, a power of two of them
+    size_t slot_mask;            ///< The number of slots minus one
+    size_t entry_count;          ///< The number of entries stored
+    size_t growth_left;          ///< The number of inserts left before the table has to grow
+} hash_compact_table_t;
+
+hash_compact_table_t* hash_compact_table_create(size_t expected_entries);
+bool hash_compact_table_find_or_insert(hash_compact_table_t* table, uint64_t fingerprint,
+                                       uint64_t payload, uint64_t* existing_payload,
+                                       bool* found);
+bool hash_compact_table_find(const hash_compact_table_t* table, uint64_t fingerprint,
+                             uint64_t* payload);
+size_t hash_compact_table_memory_size(const hash_compact_table_t* table);
+size_t hash_compact_table_estimate_bytes(size_t expected_entries);
+void hash_compact_table_destroy(hash_compact_table_t* table);
+
+#endif
@@ -0,0 +1,154 @@
+/**
+ * \file            hash_collision_compact_worker.c
+ * \brief           The worker of the compact table strategy of the collision page
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_compact_worker.h"
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Look up the fingerprint of a digest in the compact table and insert it
+ *                 with the index of its input when absent. A found fingerprint is confirmed
+ *                 by regenerating the stored input and hashing it again, since the table
+ *                 keeps neither the digest nor the input. The caller must hold
+ *                 ctx->table_mutex.
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      worker_id The id of the worker the input belongs to
+ * \param[in]      index The index of the input among the inputs of the worker
+ * \param[in]      input The input
+ * \param[in]      input_len The length of the input in bytes
+ * \param[in]      hash_hex The hexadecimal representation of the digest of the input
+ * \param[out]     stats The statistics of the calling worker
+ * \return         The outcome of the lookup
+ */
+static worker_step_t
+compact_lookup_and_insert(hash_collision_context_t* ctx, unsigned int worker_id, guint32 index,
+                          const uint8_t* input, size_t input_len, const char* hash_hex,
+                          hash_collision_stats_t* stats) {
+    uint64_t existing;
+    bool found;
+    stats->table_probes++;
+    if (!hash_compact_table_find_or_insert(ctx->compact, hash_filter_fingerprint(hash_hex),
+                                           ((uint64_t)worker_id << 32) | index, &existing,
+                                           &found)) {
+        return WORKER_STEP_INSERT_FAILED;
+    }
+    if (!found) {
+        return WORKER_STEP_CONTINUE;
+    }
+
+    uint8_t stored_buffer[BH_INPUT_BUFFER_BYTES];
+    size_t stored_len;
+    const uint8_t* stored_input = generate_run_input(ctx, (unsigned int)(existing >> 32),
+                                                     (guint32)existing, stored_buffer,
+                                                     &stored_len);
+    char stored_hash[BH_HASH_MAX_HEX];
+    if (!hash_run_input(ctx, stored_input, stored_len, stored_hash)) {
+        REGISTER_ERROR_FUNC(ctx, worker_id, ERROR_HASH_COMPUTATION,
+                            "Hash function returned invalid result");
+        return WORKER_STEP_STOP;
+    }
+    stats->replayed_inputs++;
+
+    // Digests longer than the fingerprint can share it, and the generator can repeat an
+    // input. Neither is a collision, and the new digest is dropped rather than stored.
+    bool same_input = stored_len == input_len && memcmp(stored_input, input, input_len) == 0;
+    if (same_input || strcmp(stored_hash, hash_hex) != 0) {
+        stats->fingerprint_matches++;
+        return WORKER_STEP_CONTINUE;
+    }
+
+    char* stored_hex = bytes_to_hex(stored_input, stored_len, true);
+    char* input_hex = bytes_to_hex(input, input_len, true);
+    worker_step_t step = WORKER_STEP_STOP;
+    if (stored_hex && input_hex) {
+        stats->table_hits++;
+        record_collision(ctx, stored_hex, input_hex, hash_hex);
+    } else {
+        REGISTER_ERROR_FUNC(ctx, worker_id, ERROR_MEMORY_ALLOCATION,
+                            "Input hex string allocation failed");
+    }
+
+    free(stored_hex);
+    free(input_hex);
+    return step;
+}
+
+/**************************************************************
+                      EXTERNAL FUNCTIONS
+**************************************************************/
+
+/**
+ * \brief          The worker of the compact entries strategy. The inputs are generated from
+ *                 their index and hashed in batches outside the lock, and only the digest
+ *                 fingerprints are stored, 16 bytes per attempt.
+ *
+ * \param[in]      worker The data of this worker
+ * \param[out]     stats The statistics of the worker
+ */
+void
+hash_collision_compact_worker(WorkerData* worker, hash_collision_stats_t* stats) {
+    hash_collision_context_t* ctx = worker->ctx;
+    uint8_t buffers[BH_TABLE_BATCH_SIZE][BH_INPUT_BUFFER_BYTES];
+    const uint8_t* inputs[BH_TABLE_BATCH_SIZE];
+    size_t input_lens[BH_TABLE_BATCH_SIZE];
+    char hex_buffers[BH_TABLE_BATCH_SIZE][BH_HASH_MAX_HEX];
+    char* hash_hexes[BH_TABLE_BATCH_SIZE];
+    for (unsigned int i = 0; i < BH_TABLE_BATCH_SIZE; i++) {
+        hash_hexes[i] = hex_buffers[i];
+    }
+
+    worker_step_t step = WORKER_STEP_CONTINUE;
+    unsigned int attempt = 0;
+    while (attempt < worker->attempts_to_make && step == WORKER_STEP_CONTINUE
+           && !hash_collision_run_stopping(ctx)) {
+        unsigned int batch = worker->attempts_to_make - attempt;
+        if (batch > BH_TABLE_BATCH_SIZE) {
+            batch = BH_TABLE_BATCH_SIZE;
+        }
+
+        for (unsigned int i = 0; i < batch; i++) {
+            inputs[i] = generate_run_input(ctx, worker->worker_id, attempt + i, buffers[i],
+                                           &input_lens[i]);
+        }
+
+        if (!hash_run_batch(ctx, inputs, input_lens, batch, hash_hexes)) {
+            REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_HASH_COMPUTATION,
+                                "Hash function returned invalid result");
+            step = WORKER_STEP_STOP;
+        }
+
+        unsigned int inserted = 0;
+        if (step == WORKER_STEP_CONTINUE) {
+            g_mutex_lock(ctx->table_mutex);
+            while (inserted < batch && step == WORKER_STEP_CONTINUE
+                   && !ctx->result->collision_found) {
+                step = compact_lookup_and_insert(ctx, worker->worker_id, attempt + inserted,
+                                                 inputs[inserted], input_lens[inserted],
+                                                 hash_hexes[inserted], stats);
+                if (step == WORKER_STEP_CONTINUE) {
+                    inserted++;
+                }
+            }
+            g_mutex_unlock(ctx->table_mutex);
+        }
+
+        g_atomic_int_add((gint*)&ctx->result->attempts_made, (gint)inserted);
+        attempt += batch;
+    }
+
+    if (step == WORKER_STEP_INSERT_FAILED) {
+        REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_HASH_TABLE_INSERT,
+                            "Fingerprint insert into compact table failed");
+    }
+}
@@ -11,83 +11,808 @@
  */
 
 #include "hash_collision_compute.h"
+#include "hash_collision_analysis_worker.h"
+#include "hash_collision_claw_worker.h"
+#include "hash_collision_compact_worker.h"
+#include "hash_collision_cycle_worker.h"
+#include "hash_collision_detector_worker.h"
+#include "hash_collision_distinguished_worker.h"
+#include "hash_collision_joux_worker.h"
+#include "hash_collision_ktree_worker.h"
+#include "hash_collision_near_worker.h"
+#include "hash_collision_prefix_worker.h"
+#include "hash_collision_rainbow_worker.h"
+#include "hash_collision_run.h"
 
 /****************************************************************
                        INTERNAL FUNCTION
 ****************************************************************/
 
 /**
- * \brief          Compute the hash for the given input based on the specified hash function ID.
+ * \brief          Generate random input data from a seeded generator. Unlike
+ *                 generate_random_input, the same seed always produces the same sequence
+ *                 of inputs, which is what allows the second pass of the two-pass mode to
+ *                 replay the inputs of the first pass without storing them.
  *
- * \param[in]      hash_id The ID of the hash function to use.
- * \param[in]      input The input data to hash, it should be a pointer to an array of bytes.
- * \param[in]      input_len The length of the input data in bytes.
- * \param[out]     output A pointer to a string where the computed hash will be stored in hexadecimal format.
- * \return         true The hash was computed successfully.
- * \return         false Memory allocation failed or an unsupported hash function ID was provided.
+ * \param[in]      rng The seeded random number generator of the worker
+ * \param[out]     buffer Output buffer for random data
+ * \param[in]      min_len Minimum length of random data
+ * \param[in]      max_len Maximum length of random data
+ * \return         size_t Actual length of generated data
  */
-static bool
-compute_hash(enum hash_function_ids hash_id, const uint8_t* input, size_t input_len,
-             char** output) {
-    size_t hash_hex_len = get_hash_hex_length(hash_id);
-    *output = malloc(hash_hex_len);
-    if (!*output) {
-        return false;
+static size_t
+generate_seeded_input(GRand* rng, uint8_t* buffer, size_t min_len, size_t max_len) {
+    size_t len = min_len + g_rand_int_range(rng, 0, (gint32)(max_len - min_len + 1));
+    for (size_t i = 0; i < len; i += sizeof(guint32)) {
+        guint32 word = g_rand_int(rng);
+        memcpy(buffer + i, &word, len - i < sizeof(guint32) ? len - i : sizeof(guint32));
+    }
+    return len;
+}
+
+/**
+ * \brief          Advance a SplitMix64 generator and get its next output
+ *
+ * \param[in,out]  state The state of the generator
+ * \return         The next 64 random bits
+ */
+static inline uint64_t
+splitmix64_next(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * \brief          Get the key the counter inputs of a run are XORed with before they are mixed
+ *
+ * \param[in]      run_seed The seed of the run
+ * \return         The key
+ */
+static inline uint64_t
+counter_input_key(guint32 run_seed) {
+    return run_seed * 0xD6E8FEB86659FD93ULL;
+}
+
+/**
+ * \brief          Undo x ^= x >> shift: every pass fixes twice as many of the top bits
+ *
+ * \param[in]      value The shifted value
+ * \param[in]      shift The shift, above 0
+ * \return         The value before the shift
+ */
+static inline uint64_t
+counter_input_unshift(uint64_t value, unsigned int shift) {
+    for (unsigned int bits = shift; bits < 64; bits *= 2) {
+        value ^= value >> bits;
+    }
+    return value;
+}
+
+/**
+ * \brief          Look up a digest and insert it when it has not been seen before. When the
+ *                 prefilter is enabled, the table is only probed for digests the filter
+ *                 reports as maybe seen. The caller must be the only writer of the store,
+ *                 either by holding ctx->table_mutex or by owning its shard.
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      store The table that records the digests, with its prefilter
+ * \param[in]      input_hex The hexadecimal representation of the input
+ * \param[in]      hash_hex The hexadecimal representation of the digest of the input
+ * \param[out]     stats The statistics of the calling worker
+ * \return         The outcome of the lookup
+ */
+static worker_step_t
+lookup_and_insert_digest(hash_collision_context_t* ctx, hash_digest_store_t* store,
+                         const char* input_hex, const char* hash_hex,
+                         hash_collision_stats_t* stats) {
+    bool maybe_seen = true;
+    if (store->filter) {
+        stats->filter_queries++;
+        maybe_seen =
+            hash_filter_test_and_insert(store->filter, hash_filter_fingerprint(hash_hex));
+        if (maybe_seen) {
+            stats->filter_hits++;
+        }
+    }
+
+    const char* existing_input = NULL;
+    if (maybe_seen) {
+        stats->table_probes++;
+        existing_input = hash_digest_store_find(store, hash_hex);
+    }
+
+    if (existing_input) {
+        // Collision found! BIRTHDAY ATTACK SUCCESS: Same hash with different inputs!
+        stats->table_hits++;
+        record_collision(ctx, existing_input, input_hex, hash_hex);
+        return WORKER_STEP_STOP;
+    }
+
+    // Insert new hash
+    if (!hash_digest_store_insert(store, input_hex, hash_hex)) {
+        return WORKER_STEP_INSERT_FAILED;
+    }
+    return WORKER_STEP_CONTINUE;
+}
+
+/**
+ * \brief          Look up a batch of digests and insert the ones not seen before, stopping
+ *                 at the first collision. The prefilter is queried for the whole batch first,
+ *                 then the table resolves the batch with its prefetching batch lookup, where
+ *                 the definite filter misses are inserted without a probe. The caller must be
+ *                 the only writer of the store, as for lookup_and_insert_digest.
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      store The table that records the digests, with its prefilter
+ * \param[in]      inputs The hexadecimal representations of the inputs
+ * \param[in]      hash_hexes The hexadecimal representations of the digests of the inputs
+ * \param[in]      count The number of digests, at most BH_TABLE_BATCH_SIZE
+ * \param[out]     stats The statistics of the calling worker
+ * \param[out]     inserted Receives the number of digests stored before the batch stopped
+ * \return         The outcome of the batch
+ */
+static worker_step_t
+lookup_and_insert_batch(hash_collision_context_t* ctx, hash_digest_store_t* store,
+                        const char* const* inputs, const char* const* hash_hexes,
+                        unsigned int count, hash_collision_stats_t* stats, unsigned int* inserted) {
+    hash_filter_t* filter = store->filter;
+    bool known_new[BH_TABLE_BATCH_SIZE];
+    if (filter) {
+        for (unsigned int i = 0; i < count; i++) {
+            uint64_t fingerprint = hash_filter_fingerprint(hash_hexes[i]);
+            known_new[i] = !hash_filter_test_and_insert(filter, fingerprint);
+        }
     }
 
-    switch (hash_id) {
-        case HASH_CONFIG_8BIT: {
-            uint8_t result = hash_8bit(input, input_len);
-            sprintf(*output, "%02X", result);
-        } break;
-        case HASH_CONFIG_12BIT: {
-            uint16_t result = hash_12bit(input, input_len);
-            sprintf(*output, "%03X", result);
-        } break;
-        case HASH_CONFIG_16BIT: {
-            uint16_t result = hash_16bit(input, input_len);
-            sprintf(*output, "%04X", result);
-        } break;
-        case HASH_CONFIG_RIPEMD160:
-        case HASH_CONFIG_SHA1:
-        case HASH_CONFIG_SHA3_256:
-        case HASH_CONFIG_SHA256:
-        case HASH_CONFIG_SHA512:
-        case HASH_CONFIG_SHA384: {
-            int openssl_id;
-
-            // First, assign the OpenSSL ID based on the hash_id
-            switch (hash_id) {
-                case HASH_CONFIG_RIPEMD160: openssl_id = BH_OPENSSL_HASH_RIPEMD160; break;
-                case HASH_CONFIG_SHA1: openssl_id = BH_OPENSSL_HASH_SHA1; break;
-                case HASH_CONFIG_SHA3_256: openssl_id = BH_OPENSSL_HASH_SHA3_256; break;
-                case HASH_CONFIG_SHA256: openssl_id = BH_OPENSSL_HASH_SHA256; break;
-                case HASH_CONFIG_SHA512: openssl_id = BH_OPENSSL_HASH_SHA512; break;
-                case HASH_CONFIG_SHA384: openssl_id = BH_OPENSSL_HASH_SHA384; break;
-                default: free(*output); return false;
+    const char* existing_input = NULL;
+    size_t stop = hash_digest_store_lookup_insert_batch(store, inputs, hash_hexes, count,
+                                                        filter ? known_new : NULL,
+                                                        &existing_input);
+
+    // Only the digests up to the stop are counted, the rest of the batch is dropped
+    unsigned int resolved = stop < count ? (unsigned int)stop + 1 : count;
+    for (unsigned int i = 0; i < resolved; i++) {
+        if (filter) {
+            stats->filter_queries++;
+            if (known_new[i]) {
+                continue;
             }
+            stats->filter_hits++;
+        }
+        stats->table_probes++;
+    }
 
-            // Then, compute the hash using OpenSSL given the OpenSSL ID
-            unsigned char* digest = openssl_hash(input, input_len, openssl_id);
-            if (!digest) {
-                free(*output);
-                return false;
+    *inserted = (unsigned int)stop;
+    if (stop == count) {
+        return WORKER_STEP_CONTINUE;
+    }
+    if (!existing_input) {
+        return WORKER_STEP_INSERT_FAILED;
+    }
+
+    // Collision found! BIRTHDAY ATTACK SUCCESS: Same hash with different inputs!
+    stats->table_hits++;
+    record_collision(ctx, existing_input, inputs[stop], hash_hexes[stop]);
+    return WORKER_STEP_STOP;
+}
+
+/**
+ * \brief          Insert the crafted keys of the flood demonstration into a store, timed.
+ *                 The keys go through the same batched lookup and insert as the digests,
+ *                 like keys an adversary got stored, but they bypass the prefilter and the
+ *                 statistics of the attempts. They are never as short as a digest, so they
+ *                 never collide with one.
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      store The store to flood
+ * \param[in]      lock Whether table_mutex guards the store, taken once per batch
+ * \param[out]     stats The statistics of the calling worker
+ * \return         WORKER_STEP_INSERT_FAILED when a key could not be stored, otherwise
+ *                 WORKER_STEP_CONTINUE, also when the run was cancelled during the flood
+ */
+static worker_step_t
+hash_collision_flood(hash_collision_context_t* ctx, hash_digest_store_t* store, bool lock,
+                     hash_collision_stats_t* stats) {
+    static const char* const flood_input = "FLOOD";
+    const char* inputs[BH_TABLE_BATCH_SIZE];
+    const char* keys[BH_TABLE_BATCH_SIZE];
+    for (unsigned int i = 0; i < BH_TABLE_BATCH_SIZE; i++) {
+        inputs[i] = flood_input;
+    }
+
+    gint64 started_at = g_get_monotonic_time();
+    size_t next = 0;
+    while (next < ctx->flood_count && !g_atomic_int_get((gint*)&ctx->cancel)) {
+        size_t batch = ctx->flood_count - next;
+        if (batch > BH_TABLE_BATCH_SIZE) {
+            batch = BH_TABLE_BATCH_SIZE;
+        }
+        for (size_t i = 0; i < batch; i++) {
+            keys[i] = ctx->flood_keys + (next + i) * ctx->flood_key_size;
+        }
+
+        if (lock) {
+            g_mutex_lock(ctx->table_mutex);
+        }
+        const char* existing_input = NULL;
+        size_t stop = hash_digest_store_lookup_insert_batch(store, inputs, keys, batch, NULL,
+                                                            &existing_input);
+        if (lock) {
+            g_mutex_unlock(ctx->table_mutex);
+        }
+
+        stats->flood_keys += stop;
+        if (stop < batch && !existing_input) {
+            stats->flood_time += g_get_monotonic_time() - started_at;
+            return WORKER_STEP_INSERT_FAILED;
+        }
+
+        // The keys are distinct, but a found key is skipped rather than trusted
+        next += stop < batch ? stop + 1 : batch;
+    }
+
+    stats->flood_time += g_get_monotonic_time() - started_at;
+    return WORKER_STEP_CONTINUE;
+}
+
+/**
+ * \brief          First pass of the two-pass mode. The digest only goes into the filter,
+ *                 and the digests the filter reports as maybe seen are kept as candidates
+ *                 for the second pass. The caller must hold ctx->table_mutex.
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      hash_hex The hexadecimal representation of the digest
+ * \param[out]     stats The statistics of the calling worker
+ * \return         The outcome of the filter insert
+ */
+static worker_step_t
+record_filter_candidate(hash_collision_context_t* ctx, const char* hash_hex,
+                        hash_collision_stats_t* stats) {
+    stats->filter_queries++;
+    if (!hash_filter_test_and_insert(ctx->shared.filter, hash_filter_fingerprint(hash_hex))) {
+        return WORKER_STEP_CONTINUE;
+    }
+
+    stats->filter_hits++;
+    if (!hash_table_find(ctx->candidates, hash_hex)
+        && !hash_table_insert(ctx->candidates, "", hash_hex)) {
+        return WORKER_STEP_INSERT_FAILED;
+    }
+    return WORKER_STEP_CONTINUE;
+}
+
+/**
+ * \brief          Second pass of the two-pass mode. Only the replayed inputs whose digest
+ *                 is a candidate are stored, so the table stays as small as the number of
+ *                 filter hits. The candidate table is read only during this pass, so the
+ *                 lock is only taken for candidates.
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      input_hex The hexadecimal representation of the replayed input
+ * \param[in]      hash_hex The hexadecimal representation of the digest of the input
+ * \param[out]     stats The statistics of the calling worker
+ * \return         The outcome of resolving the candidate
+ */
+static worker_step_t
+resolve_filter_candidate(hash_collision_context_t* ctx, const char* input_hex,
+                         const char* hash_hex, hash_collision_stats_t* stats) {
+    if (!hash_table_find(ctx->candidates, hash_hex)) {
+        return WORKER_STEP_CONTINUE;
+    }
+
+    worker_step_t step = WORKER_STEP_CONTINUE;
+    g_mutex_lock(ctx->table_mutex);
+
+    if (ctx->result->collision_found) {
+        step = WORKER_STEP_STOP;
+    } else {
+        stats->table_probes++;
+        const char* existing_input = hash_digest_store_find(&ctx->shared, hash_hex);
+
+        if (existing_input) {
+            stats->table_hits++;
+            // The random generator can produce the same input twice, which is not a collision
+            if (strcmp(existing_input, input_hex) != 0) {
+                record_collision(ctx, existing_input, input_hex, hash_hex);
+                step = WORKER_STEP_STOP;
             }
+        } else if (!hash_digest_store_insert(&ctx->shared, input_hex, hash_hex)) {
+            step = WORKER_STEP_INSERT_FAILED;
+        }
+    }
+
+    g_mutex_unlock(ctx->table_mutex);
+    return step;
+}
+
+/**
+ * \brief          Add the statistics of one worker to the run statistics in the result
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      stats The statistics collected by the worker
+ */
+static void
+merge_worker_stats(hash_collision_context_t* ctx, const hash_collision_stats_t* stats) {
+    if (ctx->table_mutex == NULL) {
+        return;
+    }
 
-            free(*output);
+    g_mutex_lock(ctx->table_mutex);
+    ctx->result->stats.filter_queries += stats->filter_queries;
+    ctx->result->stats.filter_hits += stats->filter_hits;
+    ctx->result->stats.table_probes += stats->table_probes;
+    ctx->result->stats.table_hits += stats->table_hits;
+    ctx->result->stats.replayed_inputs += stats->replayed_inputs;
+    ctx->result->stats.routed_digests += stats->routed_digests;
+    ctx->result->stats.routed_bytes += stats->routed_bytes;
+    ctx->result->stats.ring_batches += stats->ring_batches;
+    ctx->result->stats.ring_stalls += stats->ring_stalls;
+    ctx->result->stats.flood_keys += stats->flood_keys;
+    ctx->result->stats.flood_time += stats->flood_time;
+    ctx->result->stats.fingerprint_matches += stats->fingerprint_matches;
+    ctx->result->stats.trails += stats->trails;
+    ctx->result->stats.trail_merges += stats->trail_merges;
+    ctx->result->stats.abandoned_trails += stats->abandoned_trails;
+    ctx->result->stats.rewalk_hashes += stats->rewalk_hashes;
+    ctx->result->stats.cycle_restarts += stats->cycle_restarts;
+
+    // Written before the worker leaves remaining_workers, so the page always sees it
+    gint64 now = g_get_monotonic_time();
+    if (now > ctx->result->stats.finished_at) {
+        ctx->result->stats.finished_at = now;
+    }
+    g_mutex_unlock(ctx->table_mutex);
+}
+
+/**
+ * \brief          Store a batch of records routed to the shard of this worker. The digests
+ *                 are formatted and the inputs regenerated from their index here, on the
+ *                 owner, so the producer only copies the binary digest into the ring.
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      worker_id The id of the worker, which is also the id of its shard
+ * \param[in]      producer The id of the worker the records came from
+ * \param[in]      records The records to store
+ * \param[in]      count The number of records, at most BH_TABLE_BATCH_SIZE
+ * \param[out]     stats The statistics of the calling worker
+ * \return         The outcome of the lookups, WORKER_STEP_STOP when an input could not be
+ *                 formatted
+ */
+static worker_step_t
+shard_store_records(hash_collision_context_t* ctx, unsigned int worker_id, int producer,
+                    const shard_record_t* records, unsigned int count,
+                    hash_collision_stats_t* stats) {
+    const hash_config_t* hash = get_hash_config(ctx->hash_id);
+    char hex_buffers[BH_TABLE_BATCH_SIZE][BH_HASH_MAX_HEX];
+    const char* hash_hexes[BH_TABLE_BATCH_SIZE];
+    char* inputs[BH_TABLE_BATCH_SIZE];
+
+    unsigned int filled = 0;
+    for (; filled < count; filled++) {
+        uint8_t buffer[BH_INPUT_BUFFER_BYTES];
+        size_t input_len;
+        const uint8_t* input =
+            generate_run_input(ctx, producer, records[filled].index, buffer, &input_len);
+        inputs[filled] = bytes_to_hex(input, input_len, true);
+        if (!inputs[filled]) {
+            REGISTER_ERROR_FUNC(ctx, worker_id, ERROR_MEMORY_ALLOCATION,
+                                "Input hex string allocation failed");
+            break;
+        }
+        hash_hexes[filled] = hash->truncate(records[filled].digest, hex_buffers[filled]);
+    }
+
+    worker_step_t step = WORKER_STEP_STOP;
+    if (filled == count) {
+        unsigned int inserted;
+        step = lookup_and_insert_batch(ctx, &ctx->shards->shards[worker_id],
+                                       (const char* const*)inputs, hash_hexes, count, stats,
+                                       &inserted);
+    }
 
-            size_t bin_len = (hash_hex_len - 1) / 2;    // Exclude null terminator
-            *output = bytes_to_hex(digest, bin_len, 1); // Convert to hex string
-            if (!*output) {
-                free(digest);
-                return false; // Memory allocation failed in bytes_to_hex
+    for (unsigned int i = 0; i < filled; i++) {
+        free(inputs[i]);
+    }
+    return step;
+}
+
+/**
+ * \brief          Consume every digest other workers have routed to the shard of this
+ *                 worker. Only this worker writes the shard, so no lock is taken.
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      worker_id The id of the worker, which is also the id of its shard
+ * \param[out]     stats The statistics of the calling worker
+ * \param[out]     consumed Receives the number of digests taken from the rings
+ * \return         The outcome of the lookups, records left after a stop are dropped
+ */
+static worker_step_t
+shard_drain_inbox(hash_collision_context_t* ctx, unsigned int worker_id,
+                  hash_collision_stats_t* stats, unsigned int* consumed) {
+    hash_shard_engine_t* engine = ctx->shards;
+    shard_record_t records[BH_SHARD_BATCH_SIZE * 4];
+    worker_step_t step = WORKER_STEP_CONTINUE;
+
+    *consumed = 0;
+    for (int producer = 0; producer < engine->shard_count; producer++) {
+        if (producer == (int)worker_id) {
+            continue;
+        }
+
+        shard_ring_t* ring = hash_shard_ring(engine, producer, worker_id);
+        unsigned int count;
+        while ((count = shard_ring_pop_batch(ring, records, ARRAY_SIZE(records))) > 0) {
+            for (unsigned int start = 0; start < count && step == WORKER_STEP_CONTINUE;
+                 start += BH_TABLE_BATCH_SIZE) {
+                unsigned int batch =
+                    count - start < BH_TABLE_BATCH_SIZE ? count - start : BH_TABLE_BATCH_SIZE;
+                step = shard_store_records(ctx, worker_id, producer, records + start, batch,
+                                           stats);
             }
+            *consumed += count;
 
-            free(digest); // Free the binary digest after conversion
-        } break;
+            if (step != WORKER_STEP_CONTINUE) {
+                return step;
+            }
+        }
     }
+    return step;
+}
 
-    return true;
+/**
+ * \brief          Publish the digests collected for one shard to its ring. When the ring
+ *                 is full, the owner may itself be waiting on a full ring of this worker, so
+ *                 this worker keeps draining its own inbox until there is room.
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      worker_id The id of the worker publishing the digests
+ * \param[in]      owner The id of the shard the digests belong to
+ * \param[in,out]  outbox The digests to publish, every one is published or dropped on return
+ * \param[in,out]  count The number of digests in outbox, set to 0 on return
+ * \param[out]     stats The statistics of the calling worker
+ * \return         The outcome of the digests drained while waiting
+ */
+static worker_step_t
+shard_flush_outbox(hash_collision_context_t* ctx, unsigned int worker_id, unsigned int owner,
+                   shard_record_t* outbox, unsigned int* count, hash_collision_stats_t* stats) {
+    shard_ring_t* ring = hash_shard_ring(ctx->shards, worker_id, owner);
+    worker_step_t step = WORKER_STEP_CONTINUE;
+    unsigned int sent = 0;
+
+    while (sent < *count) {
+        unsigned int pushed = shard_ring_push_batch(ring, outbox + sent, *count - sent);
+        if (pushed > 0) {
+            stats->ring_batches++;
+            sent += pushed;
+            continue;
+        }
+
+        stats->ring_stalls++;
+        unsigned int consumed;
+        step = shard_drain_inbox(ctx, worker_id, stats, &consumed);
+        if (step == WORKER_STEP_CONTINUE && hash_collision_run_stopping(ctx)) {
+            step = WORKER_STEP_STOP;
+        }
+        if (step != WORKER_STEP_CONTINUE) {
+            break;
+        }
+        if (consumed == 0) {
+            g_thread_yield();
+        }
+    }
+
+    // The digests that were not published are dropped with the run
+    *count = 0;
+    return step;
+}
+
+/**
+ * \brief          The worker of the sharded engine. Every digest is routed to the worker
+ *                 that owns it: digests of the own shard are stored right away, the others
+ *                 are batched per shard and published to its ring as binary records with the
+ *                 index of their input, which the owner regenerates. Once the worker has made
+ *                 all its attempts, it keeps serving its shard until every other worker has
+ *                 routed all of its digests.
+ *
+ * \param[in]      worker The data of this worker
+ * \param[out]     stats The statistics of the worker
+ */
+static void
+hash_collision_sharded_worker(WorkerData* worker, hash_collision_stats_t* stats) {
+    hash_collision_context_t* ctx = worker->ctx;
+    hash_shard_engine_t* engine = ctx->shards;
+    hash_digest_store_t* shard = &engine->shards[worker->worker_id];
+    const hash_config_t* hash = get_hash_config(ctx->hash_id);
+
+    shard_record_t* outboxes = g_new(shard_record_t, engine->shard_count * BH_SHARD_BATCH_SIZE);
+    unsigned int* outbox_counts = g_new0(unsigned int, engine->shard_count);
+    unsigned int pending_attempts = 0;
+    worker_step_t step = WORKER_STEP_CONTINUE;
+
+    // The crafted keys all belong to one shard, and only its owner may write it
+    if (ctx->flood_keys && ctx->flood_worker == worker->worker_id) {
+        step = hash_collision_flood(ctx, shard, false, stats);
+    }
+
+    for (unsigned int attempt = 0;
+         attempt < worker->attempts_to_make && step == WORKER_STEP_CONTINUE; ++attempt) {
+        // The shared counters are only touched once per batch, so that workers do not bounce
+        // their cache lines between cores on every attempt
+        if (attempt % BH_SHARD_BATCH_SIZE == 0) {
+            g_atomic_int_add((gint*)&ctx->result->attempts_made, (gint)pending_attempts);
+            pending_attempts = 0;
+
+            unsigned int consumed;
+            step = shard_drain_inbox(ctx, worker->worker_id, stats, &consumed);
+            if (step != WORKER_STEP_CONTINUE || hash_collision_run_stopping(ctx)) {
+                break;
+            }
+        }
+
+        // The input is regenerated from its index by the owner of a routed digest
+        uint8_t input_buffer[BH_INPUT_BUFFER_BYTES];
+        size_t input_len;
+        const uint8_t* current_input =
+            generate_run_input(ctx, worker->worker_id, attempt, input_buffer, &input_len);
+
+        uint8_t digest[BH_HASH_MAX_DIGEST_BYTES];
+        if (!hash_run_digest(ctx, current_input, input_len, digest)) {
+            REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_HASH_COMPUTATION,
+                                "Hash function returned invalid result");
+            break;
+        }
+
+        char hash_hex[BH_HASH_MAX_HEX];
+        hash->truncate(digest, hash_hex);
+
+        unsigned int owner = hash_shard_owner(engine, hash_hex);
+        if (owner == worker->worker_id) {
+            char* input_hex = bytes_to_hex(current_input, input_len, true);
+            if (!input_hex) {
+                REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_MEMORY_ALLOCATION,
+                                    "Input hex string allocation failed");
+                break;
+            }
+
+            step = lookup_and_insert_digest(ctx, shard, input_hex, hash_hex, stats);
+            free(input_hex);
+        } else {
+            shard_record_t* outbox = outboxes + owner * BH_SHARD_BATCH_SIZE;
+            shard_record_t* record = &outbox[outbox_counts[owner]++];
+            memcpy(record->digest, digest, hash->digest_bytes);
+            record->index = attempt;
+            stats->routed_digests++;
+            stats->routed_bytes += engine->record_bytes;
+
+            if (outbox_counts[owner] == BH_SHARD_BATCH_SIZE) {
+                step = shard_flush_outbox(ctx, worker->worker_id, owner, outbox,
+                                          &outbox_counts[owner], stats);
+            }
+        }
+
+        if (step != WORKER_STEP_CONTINUE) {
+            break;
+        }
+        pending_attempts++;
+    }
+
+    g_atomic_int_add((gint*)&ctx->result->attempts_made, (gint)pending_attempts);
+
+    // Publish the partial batches, or drop them when the run is stopping
+    for (int owner = 0; owner < engine->shard_count && step == WORKER_STEP_CONTINUE; owner++) {
+        step = shard_flush_outbox(ctx, worker->worker_id, owner,
+                                  outboxes + owner * BH_SHARD_BATCH_SIZE, &outbox_counts[owner],
+                                  stats);
+    }
+    g_free(outboxes);
+    g_free(outbox_counts);
+
+    g_atomic_int_inc((gint*)&engine->producers_done);
+
+    // Keep serving the shard until every producer is done and its rings are empty. The
+    // producer count is read before draining, so the last drain sees every digest.
+    while (step == WORKER_STEP_CONTINUE && !hash_collision_run_stopping(ctx)) {
+        bool all_done = g_atomic_int_get(&engine->producers_done) == engine->shard_count;
+
+        unsigned int consumed;
+        step = shard_drain_inbox(ctx, worker->worker_id, stats, &consumed);
+        if (consumed == 0) {
+            if (all_done) {
+                break;
+            }
+            // Sleep rather than spin, a producer may still be waiting for a free core
+            g_usleep(50);
+        }
+    }
+
+    if (step == WORKER_STEP_INSERT_FAILED) {
+        REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_HASH_TABLE_INSERT,
+                            "Hash result insert into hash table failed");
+    }
+}
+
+/**
+ * \brief          The worker of the shared engine. The inputs are generated and hashed in
+ *                 batches of BH_TABLE_BATCH_SIZE outside the lock, and each batch is resolved
+ *                 with one acquisition of table_mutex through the prefetching batch lookup.
+ *
+ * \param[in]      worker The data of this worker
+ * \param[out]     stats The statistics of the worker
+ */
+static void
+hash_collision_shared_worker(WorkerData* worker, hash_collision_stats_t* stats) {
+    hash_collision_context_t* ctx = worker->ctx;
+    uint8_t buffers[BH_TABLE_BATCH_SIZE][BH_INPUT_BUFFER_BYTES];
+    const uint8_t* batch_inputs[BH_TABLE_BATCH_SIZE];
+    size_t input_lens[BH_TABLE_BATCH_SIZE];
+    char* inputs[BH_TABLE_BATCH_SIZE];
+    char hex_buffers[BH_TABLE_BATCH_SIZE][BH_HASH_MAX_HEX];
+    char* hash_hexes[BH_TABLE_BATCH_SIZE];
+    for (unsigned int i = 0; i < BH_TABLE_BATCH_SIZE; i++) {
+        hash_hexes[i] = hex_buffers[i];
+    }
+
+    if (ctx->flood_keys && ctx->flood_worker == worker->worker_id && ctx->table_mutex
+        && hash_collision_flood(ctx, &ctx->shared, true, stats) == WORKER_STEP_INSERT_FAILED) {
+        REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_HASH_TABLE_INSERT,
+                            "Flood key insert into hash table failed");
+        return;
+    }
+
+    unsigned int attempt = 0;
+    while (attempt < worker->attempts_to_make) {
+        if (g_atomic_int_get((gint*)&ctx->cancel)) {
+            break; // Exit if cancellation is requested
+        }
+
+        if (ctx->result_mutex == NULL) {
+            REGISTER_ERROR(ctx, worker->worker_id, ERROR_RESULT_MUTEX_NOT_ALLOCATED,
+                           "Result mutex memory is not allocated!");
+            break;
+        }
+        if (ctx->table_mutex == NULL) {
+            REGISTER_ERROR(ctx, worker->worker_id, ERROR_HASH_TABLE_MUTEX_NOT_ALLOCATED,
+                           "Hash table mutex memory is not allocated!");
+            break;
+        }
+
+        // Check if another worker found collision
+        g_mutex_lock(ctx->result_mutex);
+        if (ctx->result->collision_found) {
+            g_mutex_unlock(ctx->result_mutex);
+            break;
+        }
+        g_mutex_unlock(ctx->result_mutex);
+
+        // Step 1: Generate a batch of inputs, then hash it through the registry
+        unsigned int batch = worker->attempts_to_make - attempt;
+        if (batch > BH_TABLE_BATCH_SIZE) {
+            batch = BH_TABLE_BATCH_SIZE;
+        }
+
+        for (unsigned int i = 0; i < batch; i++) {
+            batch_inputs[i] = deterministic_input(ctx, worker->worker_id, attempt + i,
+                                                  buffers[i], &input_lens[i]);
+            if (!batch_inputs[i]) {
+                input_lens[i] = generate_random_input(buffers[i], 4, 31);
+                batch_inputs[i] = buffers[i];
+            }
+        }
+
+        unsigned int filled = 0;
+        if (!hash_run_batch(ctx, batch_inputs, input_lens, batch, hash_hexes)) {
+            REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_HASH_COMPUTATION,
+                                "Hash function returned invalid result");
+        } else {
+            for (; filled < batch; filled++) {
+                inputs[filled] = bytes_to_hex(batch_inputs[filled], input_lens[filled], true);
+                if (!inputs[filled]) {
+                    REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_MEMORY_ALLOCATION,
+                                        "Input hex string allocation failed");
+                    break;
+                }
+            }
+        }
+
+        // Step 2: Check the batch for collisions (thread-safe)
+        worker_step_t step = filled < batch ? WORKER_STEP_STOP : WORKER_STEP_CONTINUE;
+        unsigned int inserted = 0;
+        if (step == WORKER_STEP_CONTINUE) {
+            g_mutex_lock(ctx->table_mutex);
+
+            // Double-check collision flag while holding lock
+            if (ctx->result->collision_found) {
+                step = WORKER_STEP_STOP;
+            } else {
+                step = lookup_and_insert_batch(ctx, &ctx->shared, (const char* const*)inputs,
+                                               (const char* const*)hash_hexes, batch, stats,
+                                               &inserted);
+            }
+
+            g_mutex_unlock(ctx->table_mutex);
+        }
+
+        for (unsigned int i = 0; i < filled; i++) {
+            free(inputs[i]);
+        }
+
+        // Update attempts counter with the digests stored before any stop
+        g_atomic_int_add((gint*)&ctx->result->attempts_made, (gint)inserted);
+        attempt += batch;
+
+        if (step == WORKER_STEP_INSERT_FAILED) {
+            REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_HASH_TABLE_INSERT,
+                                "Hash result insert into hash table failed");
+            break;
+        }
+        if (step == WORKER_STEP_STOP) {
+            break;
+        }
+    }
+}
+
+/**
+ * \brief          Run the worker of the mode a pass belongs to, the passes of the collision
+ *                 page itself are left to hash_collision_worker
+ *
+ * \param[in]      worker The data of this worker
+ * \return         true when the pass belongs to a mode and its worker ran, or had nothing
+ *                 to do without the object of its mode in the context
+ */
+static bool
+hash_collision_mode_worker(WorkerData* worker) {
+    hash_collision_context_t* ctx = worker->ctx;
+    switch (worker->pass) {
+        case HASH_PASS_DETECTORS:
+            if (ctx->detectors) {
+                hash_collision_detector_worker(worker);
+            }
+            return true;
+        case HASH_PASS_PREFIX:
+            if (ctx->prefix) {
+                hash_collision_prefix_worker(worker);
+            }
+            return true;
+        case HASH_PASS_CLAW_BUILD:
+        case HASH_PASS_CLAW_PROBE:
+            if (ctx->claw) {
+                hash_collision_claw_worker(worker);
+            }
+            return true;
+        case HASH_PASS_KTREE:
+            if (ctx->ktree) {
+                hash_collision_ktree_worker(worker);
+            }
+            return true;
+        case HASH_PASS_NEAR:
+            if (ctx->near) {
+                hash_collision_near_worker(worker);
+            }
+            return true;
+        case HASH_PASS_JOUX:
+            if (ctx->joux) {
+                hash_collision_joux_worker(worker);
+            }
+            return true;
+        case HASH_PASS_RAINBOW_BUILD:
+            if (ctx->rainbow) {
+                hash_collision_rainbow_build_worker(worker);
+            }
+            return true;
+        case HASH_PASS_RAINBOW_LOOKUP:
+            if (ctx->rainbow) {
+                hash_collision_rainbow_lookup_worker(worker);
+            }
+            return true;
+        case HASH_PASS_ANALYSIS:
+            if (ctx->analysis) {
+                hash_collision_analysis_worker(worker);
+            }
+            return true;
+        default: return false;
+    }
 }
 
 /**
@@ -103,9 +828,67 @@ hash_collision_worker(gpointer data, gpointer user_data) {
     WorkerData* worker = (WorkerData*)data;
     hash_collision_context_t* ctx = worker->ctx;
 
-    g_atomic_int_inc((gint*)&ctx->remaining_workers);
+    // Statistics are counted locally and merged once, so they cost nothing per attempt
+    hash_collision_stats_t stats = {0};
+
+    if (hash_collision_mode_worker(worker)) {
+        // Written before the worker leaves remaining_workers, so the page always sees it
+        g_mutex_lock(ctx->result_mutex);
+        gint64 now = g_get_monotonic_time();
+        if (now > ctx->result->stats.finished_at) {
+            ctx->result->stats.finished_at = now;
+        }
+        g_mutex_unlock(ctx->result_mutex);
+
+        g_free(worker);
+        g_atomic_int_dec_and_test((gint*)&ctx->remaining_workers);
+        return;
+    }
+
+    if (worker->pass == HASH_PASS_SINGLE) {
+        bool needs_mutexes = ctx->engine == HASH_ENGINE_SHARDED
+                             || ctx->plan.strategy != HASH_STRATEGY_TABLE;
+        if (ctx->plan.strategy == HASH_STRATEGY_TABLE && ctx->engine != HASH_ENGINE_SHARDED) {
+            hash_collision_shared_worker(worker, &stats);
+        } else if (needs_mutexes && ctx->result_mutex == NULL) {
+            REGISTER_ERROR(ctx, worker->worker_id, ERROR_RESULT_MUTEX_NOT_ALLOCATED,
+                           "Result mutex memory is not allocated!");
+        } else if (ctx->plan.strategy != HASH_STRATEGY_TABLE && ctx->table_mutex == NULL) {
+            REGISTER_ERROR(ctx, worker->worker_id, ERROR_HASH_TABLE_MUTEX_NOT_ALLOCATED,
+                           "Hash table mutex memory is not allocated!");
+        } else if (ctx->plan.strategy == HASH_STRATEGY_COMPACT) {
+            hash_collision_compact_worker(worker, &stats);
+        } else if (ctx->plan.strategy == HASH_STRATEGY_DISTINGUISHED) {
+            hash_collision_distinguished_worker(worker, &stats);
+        } else if (ctx->plan.strategy == HASH_STRATEGY_CYCLE) {
+            hash_collision_cycle_worker(worker, &stats);
+        } else {
+            hash_collision_sharded_worker(worker, &stats);
+        }
+        merge_worker_stats(ctx, &stats);
+
+        g_free(worker);
+        g_atomic_int_dec_and_test((gint*)&ctx->remaining_workers);
+        return;
+    }
+
+    // Both passes of the two-pass mode derive the inputs from the same per worker seed
+    GRand* rng = g_rand_new_with_seed(ctx->run_seed + worker->worker_id);
+
+    // The flood goes to the table the replay resolves into, before the replay starts
+    bool flood_failed = false;
+    if (worker->pass == HASH_PASS_FILTER && ctx->flood_keys
+        && ctx->flood_worker == worker->worker_id && ctx->table_mutex) {
+        flood_failed = hash_collision_flood(ctx, &ctx->shared, true, &stats)
+                       == WORKER_STEP_INSERT_FAILED;
+        if (flood_failed) {
+            REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_HASH_TABLE_INSERT,
+                                "Flood key insert into hash table failed");
+        }
+    }
 
-    for (unsigned int attempt = 0; attempt < worker->attempts_to_make; ++attempt) {
+    for (unsigned int attempt = 0; attempt < worker->attempts_to_make && !flood_failed;
+         ++attempt) {
         if (g_atomic_int_get((gint*)&ctx->cancel)) {
             break; // Exit if cancellation is requested
         }
@@ -124,15 +907,20 @@ hash_collision_worker(gpointer data, gpointer user_data) {
         }
         g_mutex_unlock(ctx->result_mutex);
 
-        // Step 1: Generate a random input
-        uint8_t current_input[32];
-        size_t input_len = generate_random_input(current_input, 4, 31);
+        // Step 1: Generate a random input, or take the input of the attempt
+        uint8_t input_buffer[BH_INPUT_BUFFER_BYTES];
+        size_t input_len;
+        const uint8_t* current_input =
+            deterministic_input(ctx, worker->worker_id, attempt, input_buffer, &input_len);
+        if (!current_input) {
+            input_len = generate_seeded_input(rng, input_buffer, 4, 31);
+            current_input = input_buffer;
+        }
 
         // Step 2: Compute the hash
-        char* hash_hex = NULL;
-        bool compute_success = compute_hash(ctx->hash_id, current_input, input_len, &hash_hex);
+        char hash_hex[BH_HASH_MAX_HEX];
+        bool compute_success = hash_run_input(ctx, current_input, input_len, hash_hex);
         if (!compute_success) {
-            free(hash_hex);
             REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_HASH_COMPUTATION,
                                 "Hash function returned invalid result");
             break;
@@ -144,51 +932,60 @@ hash_collision_worker(gpointer data, gpointer user_data) {
             break;
         }
 
-        // Step 3: Check collision (thread-safe)
-        g_mutex_lock(ctx->table_mutex);
-
-        // Double-check collision flag while holding lock
-        if (ctx->result->collision_found) {
-            g_mutex_unlock(ctx->table_mutex);
-            free(hash_hex);
+        char* input_hex = bytes_to_hex(current_input, input_len, true);
+        if (!input_hex) {
+            REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_MEMORY_ALLOCATION,
+                                "Input hex string allocation failed");
             break;
         }
 
-        hash_node_t* existing = hash_table_find(ctx->shared_table, hash_hex);
+        // Step 3: Check collision (thread-safe)
+        worker_step_t step;
+        if (worker->pass == HASH_PASS_REPLAY) {
+            stats.replayed_inputs++;
+            step = resolve_filter_candidate(ctx, input_hex, hash_hex, &stats);
+        } else {
+            g_mutex_lock(ctx->table_mutex);
 
-        if (existing) {
-            // Collision found! BIRTHDAY ATTACK SUCCESS: Same hash with different inputs!
-            g_mutex_lock(ctx->result_mutex);
-            if (!ctx->result->collision_found) { // First to find collision
-                ctx->result->collision_found = true;
-                ctx->result->collision_input_1 = strdup(existing->input);
-                ctx->result->collision_input_2 =
-                    strdup(bytes_to_hex(current_input, input_len, true));
-                ctx->result->collision_hash_hex = strdup(hash_hex);
+            // Double-check collision flag while holding lock
+            if (ctx->result->collision_found) {
+                step = WORKER_STEP_STOP;
+            } else {
+                step = record_filter_candidate(ctx, hash_hex, &stats);
             }
-            g_mutex_unlock(ctx->result_mutex);
 
             g_mutex_unlock(ctx->table_mutex);
-            free(hash_hex);
+        }
+
+        free(input_hex);
+
+        if (step == WORKER_STEP_INSERT_FAILED) {
+            REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_HASH_TABLE_INSERT,
+                                "Hash result insert into hash table failed");
             break;
-        } else {
-            // Insert new hash
-            bool insert_success = hash_table_insert(
-                ctx->shared_table, bytes_to_hex(current_input, input_len, true), hash_hex);
-            g_mutex_unlock(ctx->table_mutex);
+        }
+        if (step == WORKER_STEP_STOP) {
+            break;
+        }
 
-            if (!insert_success) {
-                free(hash_hex);
-                REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_HASH_TABLE_INSERT,
-                                    "Hash result insert into hash table failed");
-                break;
-            }
+        // Update attempts counter, the replay does not make new attempts
+        if (worker->pass == HASH_PASS_REPLAY) {
+            g_atomic_int_inc((gint*)&ctx->replay_attempts);
+        } else {
+            g_atomic_int_inc((guint*)&ctx->result->attempts_made);
         }
+    }
 
-        free(hash_hex);
+    merge_worker_stats(ctx, &stats);
+    g_rand_free(rng);
 
-        // Update attempts counter
-        g_atomic_int_inc((guint*)&ctx->result->attempts_made);
+    // The last worker of the first pass schedules the second pass. The second pass
+    // workers are counted in remaining_workers before this worker leaves, so the page
+    // never sees the run as finished between the two passes.
+    if (worker->pass == HASH_PASS_FILTER
+        && g_atomic_int_dec_and_test((gint*)&ctx->pass_one_pending)
+        && !g_atomic_int_get((gint*)&ctx->cancel)) {
+        hash_collision_submit_workers(ctx, HASH_PASS_REPLAY);
     }
 
     // Cleanup worker data
@@ -200,6 +997,285 @@ hash_collision_worker(gpointer data, gpointer user_data) {
                       EXTERNAL FUNCTIONS
 **************************************************************/
 
+/**
+ * \brief          Compute the hash for the given input based on the specified hash function ID.
+ *                 The hash function is called through its registry entry in hash_config[].
+ *
+ * \param[in]      hash_id The ID of the hash function to use.
+ * \param[in]      input The input data to hash, it should be a pointer to an array of bytes.
+ * \param[in]      input_len The length of the input data in bytes.
+ * \param[out]     output A buffer of BH_HASH_MAX_HEX bytes the hexadecimal digest is written to
+ * \return         true The hash was computed successfully.
+ * \return         false The hash function failed.
+ */
+bool
+compute_hash(enum hash_function_ids hash_id, const uint8_t* input, size_t input_len,
+             char* output) {
+    const hash_config_t* hash = get_hash_config(hash_id);
+    uint8_t digest[BH_HASH_MAX_DIGEST_BYTES];
+    if (!hash->digest(input, input_len, digest)) {
+        return false;
+    }
+
+    hash->truncate(digest, output);
+    return true;
+}
+
+/**
+ * \brief          Compute the hashes of a batch of inputs with one hash function. The registry
+ *                 entry is looked up once for the batch, its batch function hashes the inputs
+ *                 in a loop specialized for the hash function, and its truncate function
+ *                 writes every digest into the buffer the caller gives for it.
+ *
+ * \param[in]      hash_id The ID of the hash function to use
+ * \param[in]      inputs The inputs to hash
+ * \param[in]      input_lens The length of every input in bytes
+ * \param[in]      count The number of inputs
+ * \param[out]     outputs The buffers of BH_HASH_MAX_HEX bytes the hex digest of every input
+ *                 is written to
+ * \return         true The hashes were computed successfully.
+ * \return         false The hash function failed.
+ */
+bool
+compute_hash_batch(enum hash_function_ids hash_id, const uint8_t* const* inputs,
+                   const size_t* input_lens, unsigned int count, char* const* outputs) {
+    const hash_config_t* hash = get_hash_config(hash_id);
+    uint8_t digests[BH_TABLE_BATCH_SIZE * BH_HASH_MAX_DIGEST_BYTES];
+
+    for (unsigned int done = 0; done < count;) {
+        unsigned int batch = count - done;
+        if (batch > BH_TABLE_BATCH_SIZE) {
+            batch = BH_TABLE_BATCH_SIZE;
+        }
+        if (!hash->batch(inputs + done, input_lens + done, batch, digests)) {
+            return false;
+        }
+        for (unsigned int i = 0; i < batch; i++, done++) {
+            hash->truncate(digests + i * hash->digest_bytes, outputs[done]);
+        }
+    }
+    return true;
+}
+
+/**
+ * \brief          Set up the single-block kernel of a hash function for the block inputs, through
+ *                 the block init of its registry entry. The hashes without one, the toy hashes
+ *                 iterated byte by byte without padding among them, take the counter inputs
+ *                 alone and the kernel is left empty.
+ *
+ * \param[in]      hash_id The ID of the hash function
+ * \param[out]     kernel The kernel to set up, its block_bytes is 0 for the hashes without one
+ * \return         The fixed length of every block input in bytes
+ */
+size_t
+hash_collision_block_setup(enum hash_function_ids hash_id, hash_block_kernel_t* kernel) {
+    const hash_config_t* hash = get_hash_config(hash_id);
+    if (!hash->block_init || !hash->block_init(kernel)) {
+        memset(kernel, 0, sizeof(*kernel));
+        return BH_COUNTER_INPUT_BYTES;
+    }
+    return kernel->message_bytes;
+}
+
+/**
+ * \brief          Compute the hash of a block input with the single-block kernel, the digest is
+ *                 the same compute_hash gives for the input
+ *
+ * \param[in]      hash_id The ID of the hash function
+ * \param[in]      kernel The kernel from hash_collision_block_setup
+ * \param[in]      input The input, as long as hash_collision_block_setup returned
+ * \param[out]     output A buffer of BH_HASH_MAX_HEX bytes the hexadecimal digest is written to
+ * \return         true The hash was computed successfully.
+ * \return         false The hash function failed.
+ */
+bool
+compute_block_hash(enum hash_function_ids hash_id, const hash_block_kernel_t* kernel,
+                   const uint8_t* input, char* output) {
+    if (kernel->block_bytes == 0) {
+        return compute_hash(hash_id, input, BH_COUNTER_INPUT_BYTES, output);
+    }
+
+    uint8_t digest[BH_HASH_BLOCK_MAX_DIGEST];
+    hash_block_kernel_hash(kernel, input, digest);
+    get_hash_config(hash_id)->truncate(digest, output);
+    return true;
+}
+
+/**
+ * \brief          Compute the hashes of a batch of block inputs with the single-block kernel,
+ *                 which hashes as many of them at once as the processor allows for SHA3-256
+ *
+ * \param[in]      hash_id The ID of the hash function
+ * \param[in]      kernel The kernel from hash_collision_block_setup
+ * \param[in]      inputs The inputs, as long as hash_collision_block_setup returned
+ * \param[in]      count The number of inputs
+ * \param[out]     outputs The buffers of BH_HASH_MAX_HEX bytes the hex digest of every input
+ *                 is written to
+ * \return         true The hashes were computed successfully.
+ * \return         false The hash function failed.
+ */
+bool
+compute_block_hash_batch(enum hash_function_ids hash_id, const hash_block_kernel_t* kernel,
+                         const uint8_t* const* inputs, unsigned int count,
+                         char* const* outputs) {
+    if (kernel->block_bytes == 0) {
+        for (unsigned int i = 0; i < count; i++) {
+            if (!compute_block_hash(hash_id, kernel, inputs[i], outputs[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const hash_config_t* hash = get_hash_config(hash_id);
+    uint8_t digests[BH_TABLE_BATCH_SIZE * BH_HASH_BLOCK_MAX_DIGEST];
+    for (unsigned int done = 0; done < count;) {
+        unsigned int batch = count - done;
+        if (batch > BH_TABLE_BATCH_SIZE) {
+            batch = BH_TABLE_BATCH_SIZE;
+        }
+        hash_block_kernel_hash_batch(kernel, inputs + done, batch, digests);
+        for (unsigned int i = 0; i < batch; i++, done++) {
+            hash->truncate(digests + i * kernel->digest_bytes, outputs[done]);
+        }
+    }
+    return true;
+}
+
+/**
+ * \brief          Measure how many block inputs one thread hashes per second through the
+ *                 kernel alone, with no encoding and no table: the bound the table strategies
+ *                 approach as their other costs shrink
+ *
+ * \param[in]      hash_id The ID of the hash function
+ * \param[in]      kernel The kernel from hash_collision_block_setup
+ * \return         The digests per second
+ */
+double
+hash_collision_block_rate(enum hash_function_ids hash_id, const hash_block_kernel_t* kernel) {
+    const guint32 rounds = 1 << 14;
+    // As many inputs per call as the widest Keccak kernel permutes at once
+    uint8_t inputs[BH_KECCAK_MAX_LANES][BH_INPUT_BUFFER_BYTES] = {0};
+    const uint8_t* input_ptrs[BH_KECCAK_MAX_LANES];
+    size_t input_lens[BH_KECCAK_MAX_LANES];
+    uint8_t digests[BH_KECCAK_MAX_LANES * BH_HASH_MAX_DIGEST_BYTES];
+    volatile unsigned int sink = 0; // Keeps the digests alive, the loop is not optimized away
+    const hash_config_t* hash = get_hash_config(hash_id);
+    for (unsigned int m = 0; m < BH_KECCAK_MAX_LANES; m++) {
+        input_ptrs[m] = inputs[m];
+        input_lens[m] = BH_COUNTER_INPUT_BYTES;
+    }
+
+    gint64 start = g_get_monotonic_time();
+    for (guint32 i = 0; i < rounds; i += BH_KECCAK_MAX_LANES) {
+        for (guint32 m = 0; m < BH_KECCAK_MAX_LANES; m++) {
+            guint32 counter = i + m;
+            memcpy(inputs[m], &counter, sizeof(counter));
+        }
+        // The hashes without a kernel, the toy ones too, take the counter inputs through
+        // their registry batch, which calls the hash function directly in its loop
+        if (kernel->block_bytes == 0) {
+            hash->batch(input_ptrs, input_lens, BH_KECCAK_MAX_LANES, digests);
+        } else {
+            hash_block_kernel_hash_batch(kernel, input_ptrs, BH_KECCAK_MAX_LANES, digests);
+        }
+        sink += digests[0];
+    }
+    gint64 elapsed = g_get_monotonic_time() - start;
+    return (double)rounds * G_USEC_PER_SEC / (elapsed > 0 ? elapsed : 1);
+}
+
+/**
+ * \brief          Generate the input with a given index of a worker. The input only depends
+ *                 on the run seed, the worker and the index, so it can be regenerated at any
+ *                 time from those alone, which is all the compact entries and the trail ends
+ *                 store. Different indexes of a worker start from different generator states.
+ *
+ * \param[in]      run_seed The seed of the run
+ * \param[in]      worker_id The worker the input belongs to
+ * \param[in]      index The index of the input among the inputs of the worker
+ * \param[out]     buffer Output buffer for random data
+ * \param[in]      min_len Minimum length of random data
+ * \param[in]      max_len Maximum length of random data
+ * \return         size_t Actual length of generated data
+ */
+size_t
+generate_indexed_input(guint32 run_seed, unsigned int worker_id, guint32 index, uint8_t* buffer,
+                       size_t min_len, size_t max_len) {
+    uint64_t state = (((uint64_t)worker_id << 32) | index) ^ (run_seed * 0xD6E8FEB86659FD93ULL);
+    size_t len = min_len + (size_t)(splitmix64_next(&state) % (max_len - min_len + 1));
+    for (size_t i = 0; i < len; i += sizeof(uint64_t)) {
+        uint64_t word = splitmix64_next(&state);
+        memcpy(buffer + i, &word, len - i < sizeof(uint64_t) ? len - i : sizeof(uint64_t));
+    }
+    return len;
+}
+
+/**
+ * \brief          Generate the counter input with a given index of a worker: the worker in
+ *                 the high 32 bits and the index in the low 32 bits, XORed with a key drawn
+ *                 from the run seed and mixed by the SplitMix64 finalizer. Every step is a
+ *                 bijection of 64 bits, so no two indexes of any workers give the same input,
+ *                 and counter_input_origin reads the worker and the index back from it.
+ *
+ * \param[in]      run_seed The seed of the run
+ * \param[in]      worker_id The worker the input belongs to
+ * \param[in]      index The index of the input among the inputs of the worker
+ * \param[out]     buffer Receives the input, at least BH_COUNTER_INPUT_BYTES bytes
+ * \return         BH_COUNTER_INPUT_BYTES
+ */
+size_t
+generate_counter_input(guint32 run_seed, unsigned int worker_id, guint32 index, uint8_t* buffer) {
+    uint64_t value = (((uint64_t)worker_id << 32) | index) ^ counter_input_key(run_seed);
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    value ^= value >> 31;
+
+    for (int i = 0; i < BH_COUNTER_INPUT_BYTES; i++) {
+        buffer[i] = (uint8_t)(value >> (8 * (BH_COUNTER_INPUT_BYTES - 1 - i)));
+    }
+    return BH_COUNTER_INPUT_BYTES;
+}
+
+/**
+ * \brief          Read the worker and the index of a counter input back from its hex, by
+ *                 running the steps of generate_counter_input backwards. The multiplications
+ *                 are undone with the inverses of their odd constants modulo 2^64.
+ *
+ * \param[in]      run_seed The seed of the run the input was generated in
+ * \param[in]      input_hex The input in hex, as the results hold it
+ * \param[out]     worker_id Receives the worker the input belongs to
+ * \param[out]     index Receives the index of the input among the inputs of the worker
+ * \return         true if input_hex is the hex of a counter input, false otherwise
+ */
+bool
+counter_input_origin(guint32 run_seed, const char* input_hex, unsigned int* worker_id,
+                     guint32* index) {
+    if (!input_hex || strlen(input_hex) != 2 * BH_COUNTER_INPUT_BYTES) {
+        return false;
+    }
+
+    uint64_t value = 0;
+    for (const char* c = input_hex; *c != '\0'; c++) {
+        int digit = *c >= '0' && *c <= '9'   ? *c - '0'
+                    : *c >= 'A' && *c <= 'F' ? *c - 'A' + 10
+                    : *c >= 'a' && *c <= 'f' ? *c - 'a' + 10
+                                             : -1;
+        if (digit < 0) {
+            return false;
+        }
+        value = (value << 4) | (uint64_t)digit;
+    }
+
+    value = counter_input_unshift(value, 31) * 0x319642B2D24D8EC3ULL;
+    value = counter_input_unshift(value, 27) * 0x96DE1B173F119089ULL;
+    value = counter_input_unshift(value, 30) ^ counter_input_key(run_seed);
+
+    *worker_id = (unsigned int)(value >> 32);
+    *index = (guint32)value;
+    return true;
+}
+
 /**
  * \brief          Create a glib thread pool for hash collision workers. This is for birthday attack
  *                 simulation to calculate hash collision in parallel.
@@ -230,6 +1306,157 @@ create_hash_attack_pool(int num_threads) {
     return pool;
 }
 
+/**
+ * \brief          Get the number of attempts a worker makes. The attempts are divided
+ *                 evenly, and the first worker takes the remainder.
+ *
+ * \param[in]      max_attempts The total number of attempts of the run
+ * \param[in]      worker_count The number of workers the attempts are divided among
+ * \param[in]      worker_id The id of the worker, 0 to worker_count - 1
+ * \return         The number of attempts the worker should make
+ */
+unsigned int
+hash_collision_worker_attempts(unsigned int max_attempts, int worker_count,
+                               unsigned int worker_id) {
+    unsigned int attempts_per_thread = max_attempts / worker_count;
+    unsigned int remaining_attempts = max_attempts % worker_count;
+    return attempts_per_thread + (worker_id == 0 ? remaining_attempts : 0);
+}
+
+/**
+ * \brief          Get the number of attempts the workers before a worker make, so that the
+ *                 attempts of all the workers can be numbered one after the other
+ *
+ * \param[in]      max_attempts The total number of attempts of the run
+ * \param[in]      worker_count The number of workers the attempts are divided among
+ * \param[in]      worker_id The id of the worker, 0 to worker_count - 1
+ * \return         The number of the first attempt of the worker
+ */
+unsigned int
+hash_collision_worker_first_attempt(unsigned int max_attempts, int worker_count,
+                                    unsigned int worker_id) {
+    if (worker_id == 0) {
+        return 0;
+    }
+    return max_attempts / worker_count * worker_id + max_attempts % worker_count;
+}
+
+/**
+ * \brief          Submit one worker per thread of ctx->thread_pool for the given pass of
+ *                 the run. The workers are counted in ctx->remaining_workers before they are
+ *                 queued, so that the count only drops to zero once the run is over.
+ *
+ * \param[in]      ctx The shared context of the simulation, with thread_pool, worker_count
+ *                 and max_attempts already set. The build of a claw search divides the
+ *                 build_size of ctx->claw instead of max_attempts.
+ * \param[in]      pass The part of the run the workers execute
+ * \return         true if every worker was submitted, false otherwise
+ */
+bool
+hash_collision_submit_workers(hash_collision_context_t* ctx, hash_worker_pass_t pass) {
+    g_atomic_int_add((gint*)&ctx->remaining_workers, ctx->worker_count);
+    bool counts_first_pass = pass == HASH_PASS_FILTER || pass == HASH_PASS_CLAW_BUILD
+                             || pass == HASH_PASS_KTREE || pass == HASH_PASS_JOUX
+                             || pass == HASH_PASS_RAINBOW_BUILD || pass == HASH_PASS_ANALYSIS;
+    if (counts_first_pass) {
+        g_atomic_int_set((gint*)&ctx->pass_one_pending, ctx->worker_count);
+    }
+
+    // The build of a claw search stores family A, the other passes make the attempts
+    unsigned int total = pass == HASH_PASS_CLAW_BUILD ? ctx->claw->build_size : ctx->max_attempts;
+
+    bool all_submitted = true;
+    for (int i = 0; i < ctx->worker_count; i++) {
+        WorkerData* worker_data = g_new(WorkerData, 1);
+        worker_data->ctx = ctx;
+        worker_data->attempts_to_make =
+            hash_collision_worker_attempts(total, ctx->worker_count, i);
+        worker_data->worker_id = i;
+        worker_data->pass = pass;
+
+        GError* error = NULL;
+        g_thread_pool_push(ctx->thread_pool, worker_data, &error);
+
+        if (error) {
+            g_printerr("Failed to submit work: %s\n", error->message);
+            g_error_free(error);
+            g_free(worker_data);
+
+            g_atomic_int_dec_and_test((gint*)&ctx->remaining_workers);
+            if (counts_first_pass) {
+                g_atomic_int_dec_and_test((gint*)&ctx->pass_one_pending);
+            }
+            all_submitted = false;
+        }
+    }
+
+    return all_submitted;
+}
+
+/**
+ * \brief          Get the memory used by the digest tables of a run: the shared table and
+ *                 the two-pass candidates, the compact table, or the tables of every shard.
+ *                 The prefilter is counted separately in the run statistics. Only call this
+ *                 once every worker of the run has exited.
+ *
+ * \param[in]      ctx The context of the finished run
+ * \return         The size of the digest tables in bytes
+ */
+size_t
+hash_collision_table_bytes(const hash_collision_context_t* ctx) {
+    size_t bytes = hash_digest_store_table_bytes(&ctx->shared);
+    bytes += hash_table_memory_size(ctx->candidates);
+    bytes += hash_compact_table_memory_size(ctx->compact);
+    if (ctx->shards) {
+        bytes += hash_shard_engine_table_bytes(ctx->shards);
+    }
+    return bytes;
+}
+
+/**
+ * \brief          Get the chain lengths of the digest tables of a run: the shared table or
+ *                 the tables of every shard. The two-pass candidates are left out, they
+ *                 always use the chained layout. Only call this once every worker of the run
+ *                 has exited.
+ *
+ * \param[in]      ctx The context of the finished run
+ * \param[out]     stats Receives the chain length histogram
+ */
+void
+hash_collision_chain_stats(const hash_collision_context_t* ctx, hash_chain_stats_t* stats) {
+    memset(stats, 0, sizeof(*stats));
+    hash_digest_store_chain_stats(&ctx->shared, stats);
+    if (ctx->shards) {
+        hash_shard_engine_chain_stats(ctx->shards, stats);
+    }
+}
+
+/**
+ * \brief          Measure the time it takes to generate, hash and encode one input, which
+ *                 the planner uses to predict the duration of a run
+ *
+ * \param[in]      hash_id The hash function to measure
+ * \return         The seconds per hash, 0 if the hash function failed
+ */
+double
+hash_collision_seconds_per_hash(enum hash_function_ids hash_id) {
+    const int rounds = 1024;
+    gint64 start = g_get_monotonic_time();
+    for (int i = 0; i < rounds; i++) {
+        uint8_t input[32];
+        size_t input_len = generate_random_input(input, 4, 31);
+
+        char hash_hex[BH_HASH_MAX_HEX];
+        if (!compute_hash(hash_id, input, input_len, hash_hex)) {
+            return 0.0;
+        }
+
+        char* input_hex = bytes_to_hex(input, input_len, true);
+        free(input_hex);
+    }
+    return (double)(g_get_monotonic_time() - start) / G_USEC_PER_SEC / rounds;
+}
+
 /****************************************************************
                         HELPER FUNCTION
 ****************************************************************/
@@ -249,6 +1476,7 @@ void
 deep_copy_hash_collision_simulation_result(hash_collision_simulation_result_t* dest,
                                            const hash_collision_simulation_result_t* src) {
     dest->attempts_made = src->attempts_made;
+    dest->stats = src->stats;
 
     // Deep copy each string safely
     dest->collision_input_1 = src->collision_input_1 ? strdup(src->collision_input_1) : NULL;
@@ -282,6 +1510,7 @@ clear_result_hash_collision_simulation_result(hash_collision_simulation_result_t
         res->collision_input_2 = NULL;
         res->collision_hash_hex = NULL;
         res->collision_found = false;
+        memset(&res->stats, 0, sizeof(res->stats));
     }
 }
 
@@ -290,8 +1519,9 @@ clear_result_hash_collision_simulation_result(hash_collision_simulation_result_t
  *
  *                 This function clears the simulation result (if present), destroys mutexes,
  *                 frees dynamically allocated synchronization primitives and flags, and destroys
- *                 the shared hash table. If \p free_struct is TRUE, the context structure itself
- *                 is also freed; otherwise its pointer fields are set to NULL for safe reuse.
+ *                 the shared hash table and the prefilter. If \p free_struct is TRUE, the context
+ *                 structure itself is also freed; otherwise its pointer fields are set to NULL for
+ *                 safe reuse.
  *
  * \param[in,out]  ctx Pointer to the context structure to clear.
  * \param[in]      free_struct TRUE to free the context structure itself,
@@ -328,12 +1558,41 @@ clear_result_hash_collision_context(hash_collision_context_t* ctx, bool free_str
         g_free(ctx->error_info);
     }
 
-    // Cleanup: Free the hash table and its entries
-    hash_table_destroy(ctx->shared_table);
+    // Cleanup: Free the hash table and its entries, and the prefilter with its candidates
+    hash_digest_store_clear(&ctx->shared);
+    hash_table_destroy(ctx->candidates);
+    hash_compact_table_destroy(ctx->compact);
+    hash_detector_set_destroy(ctx->detectors);
+    hash_prefix_target_destroy(ctx->prefix);
+    hash_claw_search_destroy(ctx->claw);
+    hash_ktree_destroy(ctx->ktree);
+    hash_near_search_destroy(ctx->near);
+    hash_joux_destroy(ctx->joux);
+    hash_rainbow_destroy(ctx->rainbow);
+    hash_analysis_destroy(ctx->analysis);
+    hash_wordlist_destroy(ctx->wordlist);
+    hash_shard_engine_destroy(ctx->shards);
+    free(ctx->flood_keys);
 
-    ctx->shared_table = NULL;
+    ctx->compact = NULL;
+    ctx->detectors = NULL;
+    ctx->prefix = NULL;
+    ctx->claw = NULL;
+    ctx->ktree = NULL;
+    ctx->near = NULL;
+    ctx->joux = NULL;
+    ctx->rainbow = NULL;
+    ctx->analysis = NULL;
+    ctx->wordlist = NULL;
+    ctx->shards = NULL;
+    ctx->flood_keys = NULL;
+    ctx->flood_count = 0;
+    ctx->candidates = NULL;
     ctx->table_mutex = NULL;
 
+    ctx->pass_one_pending = 0;
+    ctx->replay_attempts = 0;
+
     ctx->cancel = 0;
     ctx->remaining_workers = 0;
 
@@ -426,6 +1685,7 @@ error_type_to_string(error_type_t type) {
         case ERROR_MEMORY_ALLOCATION: return "MEMORY_ALLOCATION";
         case ERROR_HASH_COMPUTATION: return "HASH_COMPUTATION";
         case ERROR_HASH_TABLE_INSERT: return "HASH_TABLE_INSERT";
+        case ERROR_TABLE_FILE: return "TABLE_FILE";
         default: return "UNKNOWN";
     }
 }
\ No newline at end of file
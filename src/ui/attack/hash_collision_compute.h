@@ -16,9 +16,23 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#include "hash_collision_analysis.h"
+#include "hash_collision_claw.h"
+#include "hash_collision_compact.h"
+#include "hash_collision_detector.h"
+#include "hash_collision_prefix.h"
+#include "hash_collision_filter.h"
+#include "hash_collision_joux.h"
+#include "hash_collision_ktree.h"
+#include "hash_collision_near.h"
+#include "hash_collision_plan.h"
+#include "hash_collision_rainbow.h"
+#include "hash_collision_shard.h"
 #include "hash_collision_table.h"
+#include "hash_collision_wordlist.h"
 #include "hash_config.h"
 
+#include "../../utils/hash_block.h"
 #include "../../utils/hash_function.h"
 #include "../../utils/utils.h"
 #include "../error.h"
@@ -31,7 +45,8 @@ typedef enum {
     ERROR_HASH_COMPUTATION,
     ERROR_HASH_TABLE_INSERT,
     ERROR_RESULT_MUTEX_NOT_ALLOCATED,
-    ERROR_HASH_TABLE_MUTEX_NOT_ALLOCATED
+    ERROR_HASH_TABLE_MUTEX_NOT_ALLOCATED,
+    ERROR_TABLE_FILE
 } error_type_t;
 
 typedef struct {
@@ -43,20 +58,171 @@ typedef struct {
     GMutex* error_mutex;      ///<  mutex to write to the error info struct
 } thread_error_info_t;
 
+/**
+ * \brief          The prefilter placed in front of the digest table. The values match
+ *                 the option numbers of the prefilter field on the hash collision form.
+ */
+typedef enum {
+    HASH_PREFILTER_OFF = 1, ///< Every digest is looked up in the main table
+    HASH_PREFILTER_BLOOM,   ///< A blocked Bloom filter answers definite misses before the table
+    HASH_PREFILTER_TWO_PASS ///< Filter-only first pass, then a replay that stores only filter hits
+} hash_prefilter_mode_t;
+
+/**
+ * \brief          Where the workers store the digests. The values match the option
+ *                 numbers of the engine field on the hash collision form.
+ */
+typedef enum {
+    HASH_ENGINE_SHARED = 1, ///< One table shared by every worker behind table_mutex
+    HASH_ENGINE_SHARDED     ///< Every worker owns a shard of the digests, fed through SPSC rings
+} hash_engine_t;
+
+/**
+ * \brief          How the workers of the hash collision page make their inputs. The values
+ *                 match the option numbers of the inputs field on the hash collision form.
+ */
+typedef enum {
+    HASH_INPUTS_RANDOM = 1, ///< 4 to 31 random bytes, the same input can come up twice
+    HASH_INPUTS_COUNTER,    ///< The worker and its counter through a keyed bijection, all distinct
+    HASH_INPUTS_WORDLIST,   ///< The lines of BH_WORDLIST_PATH, hashed where they are mapped
+    HASH_INPUTS_BLOCK       ///< Counter inputs zero-filled to one block, hashed by its kernel
+} hash_input_mode_t;
+
+/**
+ * \brief          The bytes of a counter input, the 64-bit image of the worker and its counter
+ */
+#define BH_COUNTER_INPUT_BYTES 8
+
+/**
+ * \brief          The bytes of a buffer the table, compact and two-pass workers make an input
+ *                 in, the single-block inputs of SHA3-256 are the longest
+ */
+#define BH_INPUT_BUFFER_BYTES BH_HASH_BLOCK_MAX_BYTES
+
+/**
+ * \brief          Which part of a run a worker is executing
+ */
+typedef enum {
+    HASH_PASS_SINGLE = 0,     ///< Look up and insert every digest in the table
+    HASH_PASS_FILTER,         ///< Two-pass mode, insert in the filter and record candidate digests
+    HASH_PASS_REPLAY,         ///< Two-pass mode, regenerate the inputs and resolve the candidates
+    HASH_PASS_DETECTORS,      ///< Hash every input with the hash of each detector in ctx->detectors
+    HASH_PASS_PREFIX,         ///< Match every digest against ctx->prefix and feed ctx->detectors
+    HASH_PASS_CLAW_BUILD,     ///< Claw search, store the inputs of family A in the build table
+    HASH_PASS_CLAW_PROBE,     ///< Claw search, look up the inputs of family B in the build table
+    HASH_PASS_KTREE,          ///< K-tree, take the jobs of the level of ctx->ktree being built
+    HASH_PASS_NEAR,           ///< Look up and add the digests in the substring indexes of ctx->near
+    HASH_PASS_JOUX,           ///< Multicollision, search the collision of the step of ctx->joux
+    HASH_PASS_RAINBOW_BUILD,  ///< Rainbow table, build the chains of ctx->rainbow
+    HASH_PASS_RAINBOW_LOOKUP, ///< Rainbow table, answer the inversion queries of ctx->rainbow
+    HASH_PASS_ANALYSIS        ///< Toy hash analysis, count the inputs of ctx->analysis
+} hash_worker_pass_t;
+
+/**
+ * \brief          The number of hex characters of the longest digest, SHA-512. The walks of
+ *                 the distinguished points and cycle strategies hash the hex digest again.
+ */
+#define BH_WALK_MAX_BYTES 128
+
+typedef struct HashCollisionStats {
+    hash_attack_plan_t plan;         ///< The strategy of the run and its predicted cost
+    hash_engine_t engine;            ///< The engine used for the run
+    hash_table_layout_t layout;      ///< The layout of the digest tables of the run
+    size_t table_bytes;              ///< The memory used by the digest tables, set once finished
+    hash_bucket_mode_t bucket_mode;  ///< How the digest tables placed the digests
+    hash_chain_stats_t chains;       ///< The chain lengths of the digest tables, set once finished
+    guint64 flood_keys;              ///< Flood demonstration, the crafted keys inserted
+    gint64 flood_time;               ///< Flood demonstration, microseconds spent inserting them
+    gint64 started_at;               ///< Monotonic time in microseconds the workers were submitted
+    gint64 finished_at;              ///< Monotonic time in microseconds the last worker finished
+    hash_prefilter_mode_t prefilter; ///< The prefilter mode used for the run
+    hash_input_mode_t input_mode;    ///< How the inputs of the run were made
+    guint32 run_seed;                ///< The seed of the run, the key of the counter inputs
+    guint64 wordlist_lines;          ///< Wordlist inputs, the lines of the corpus
+    guint64 wordlist_bytes;          ///< Wordlist inputs, the bytes of the corpus
+    gint64 wordlist_index_time;      ///< Wordlist inputs, microseconds the line index took
+    unsigned int wordlist_threads;   ///< Wordlist inputs, the threads that built the index
+    size_t block_input_bytes;        ///< Block inputs, the fixed length of every input
+    size_t block_bytes;              ///< Block inputs, the bytes of a block, 0 for the toy hashes
+    double block_rate;               ///< Block inputs, digests per second of one thread through
+                                     ///< the kernel alone, without the tables
+    size_t filter_bytes;             ///< The memory used by the prefilter bits
+    guint64 filter_queries;          ///< The number of digests checked against the prefilter
+    guint64 filter_hits;             ///< The number of digests the prefilter reported as maybe seen
+    guint64 table_probes;            ///< The number of lookups that reached the main table
+    guint64 table_hits;              ///< The number of lookups that found the digest already stored
+    guint64 replayed_inputs;         ///< The number of inputs regenerated by the second pass
+    guint64 routed_digests;          ///< Sharded engine, digests sent to a shard of another worker
+    guint64 routed_bytes;            ///< Sharded engine, record bytes sent to others
+    guint64 ring_batches;            ///< Sharded engine, the number of batches published to rings
+    guint64 ring_stalls;             ///< Sharded engine, the number of times a full ring was hit
+    guint64 fingerprint_matches;     ///< Compact entries, fingerprints shared by different digests
+    guint64 trails;                  ///< Distinguished points, the trails that reached an end
+    guint64 trail_merges;            ///< Distinguished points, the trails ending where another did
+    guint64 abandoned_trails;        ///< Distinguished points, trails stopped at the length limit
+    guint64 rewalk_hashes;           ///< Distinguished points, hashes made walking merged trails
+    guint64 cycle_restarts;          ///< Cycle search, the starts that were already on the cycle
+} hash_collision_stats_t;
+
 typedef struct HashCollisionSimulationResult {
     int attempts_made;        ///< The number of attempts made to find a collision or no collision
     bool collision_found;     ///< Whether a collision was found or not
     char* collision_input_1;  ///< The first input that caused a collision
     char* collision_input_2;  ///< The second input that caused a collision
     char* collision_hash_hex; ///< The hash value of the collision inputs
+    hash_collision_stats_t stats; ///< The run statistics, written once each worker exits
 } hash_collision_simulation_result_t;
 
 typedef struct HashCollisionContext {
     enum hash_function_ids
         hash_id; ///< The hash id of to be use for hash collision calculation, this should not be changed once init
-    hash_table_t*
-        shared_table; ///< The shared hash table from hash_collision_table.h that records all digest of input
+    hash_digest_store_t
+        shared; ///< The shared digest table from hash_collision_table.h that records all digest of input, with its prefilter. Guarded by table_mutex
     GMutex* table_mutex; ///< Mutex to insert data and lookup digest
+    hash_bucket_hasher_t
+        bucket_hasher; ///< Places the digests in the buckets of every table of the run
+
+    char* flood_keys;          ///< Flood demonstration only, the crafted keys one after the other
+    size_t flood_count;        ///< Flood demonstration only, the number of crafted keys
+    size_t flood_key_size;     ///< Flood demonstration only, the bytes from one key to the next
+    unsigned int flood_worker; ///< Flood demonstration only, the worker that inserts the keys
+
+    hash_attack_plan_t plan;       ///< The strategy of the run, chosen before it starts
+    hash_compact_table_t* compact; ///< Compact entries and distinguished points only, the
+                                   ///< fingerprints of the digests or of the trail ends
+    hash_detector_set_t* detectors; ///< Detector runs only, the hash functions every input is
+                                    ///< hashed with, each with its own collision
+    hash_prefix_target_t* prefix; ///< Prefix searches only, the pattern the digests must start
+                                  ///< with, searched next to the collision of ctx->detectors
+    hash_claw_search_t* claw; ///< Claw searches only, the two input families and the build
+                              ///< table of the first
+    hash_ktree_t* ktree; ///< K-tree runs only, the lists of every level and the solution
+    hash_near_search_t* near; ///< Near-collision searches only, the digests with their
+                              ///< substring indexes
+    hash_joux_t* joux; ///< Multicollisions only, the chained collisions and the states
+    hash_rainbow_t* rainbow; ///< Rainbow tables only, the chains and the queries
+    hash_analysis_t* analysis; ///< Toy hash analyses only, the counters of every worker
+
+    hash_engine_t engine; ///< The engine of the run
+    hash_input_mode_t input_mode; ///< How the table, compact and two-pass workers make their
+                                  ///< inputs, random unless COUNTER, WORDLIST or BLOCK
+    hash_wordlist_t* wordlist; ///< Wordlist inputs only, the corpus the inputs are read from
+    hash_block_kernel_t block_kernel; ///< Block inputs only, the padded block of the hash
+                                      ///< function, its block_bytes is 0 for the toy hashes
+    size_t block_input_bytes;         ///< Block inputs only, the fixed length of every input
+    hash_shard_engine_t*
+        shards; ///< Sharded engine only, the shards and rings used instead of shared
+
+    hash_prefilter_mode_t prefilter; ///< The prefilter mode of the run
+    hash_table_t*
+        candidates; ///< Two-pass mode only, the digests the filter reported as maybe seen in the first pass
+    guint32 run_seed; ///< Seeds the input generators that can regenerate an input: the two-pass replay, the compact entries and the walk starts
+    int pass_one_pending; ///< Two-pass mode, claw searches, k-trees, multicollisions, rainbow tables and toy hash analyses only, the number of first pass, build, level, step or analysis workers that are still running
+    int replay_attempts;  ///< Two-pass mode only, the number of inputs the second pass has replayed
+
+    GThreadPool* thread_pool;  ///< The pool the workers run on, used to schedule the second pass
+    unsigned int max_attempts; ///< The total number of attempts requested for the run
+    int worker_count;          ///< The number of workers the attempts are divided among
 
     int cancel; ///< Flag to signal cancellation to worker threads
     int remaining_workers; ///< Count of remaining active worker threads, used to determine when all threads have completed
@@ -72,8 +238,35 @@ typedef struct {
     hash_collision_context_t* ctx; ///< Stores the context struct
     unsigned int attempts_to_make; ///< The number of times to calculate the hash function
     unsigned int worker_id;        ///< The worker id to identify the thread
+    hash_worker_pass_t pass;       ///< The part of the run this worker executes
 } WorkerData;
 
+bool compute_hash(enum hash_function_ids hash_id, const uint8_t* input, size_t input_len,
+                  char* output);
+bool compute_hash_batch(enum hash_function_ids hash_id, const uint8_t* const* inputs,
+                        const size_t* input_lens, unsigned int count, char* const* outputs);
+size_t hash_collision_block_setup(enum hash_function_ids hash_id, hash_block_kernel_t* kernel);
+bool compute_block_hash(enum hash_function_ids hash_id, const hash_block_kernel_t* kernel,
+                        const uint8_t* input, char* output);
+bool compute_block_hash_batch(enum hash_function_ids hash_id, const hash_block_kernel_t* kernel,
+                              const uint8_t* const* inputs, unsigned int count,
+                              char* const* outputs);
+double hash_collision_block_rate(enum hash_function_ids hash_id,
+                                 const hash_block_kernel_t* kernel);
+size_t generate_indexed_input(guint32 run_seed, unsigned int worker_id, guint32 index,
+                              uint8_t* buffer, size_t min_len, size_t max_len);
+size_t generate_counter_input(guint32 run_seed, unsigned int worker_id, guint32 index,
+                              uint8_t* buffer);
+bool counter_input_origin(guint32 run_seed, const char* input_hex, unsigned int* worker_id,
+                          guint32* index);
+unsigned int hash_collision_worker_attempts(unsigned int max_attempts, int worker_count,
+                                           unsigned int worker_id);
+unsigned int hash_collision_worker_first_attempt(unsigned int max_attempts, int worker_count,
+                                                unsigned int worker_id);
+bool hash_collision_submit_workers(hash_collision_context_t* ctx, hash_worker_pass_t pass);
+double hash_collision_seconds_per_hash(enum hash_function_ids hash_id);
+size_t hash_collision_table_bytes(const hash_collision_context_t* ctx);
+void hash_collision_chain_stats(const hash_collision_context_t* ctx, hash_chain_stats_t* stats);
 void deep_copy_hash_collision_simulation_result(hash_collision_simulation_result_t* dest,
                                                 const hash_collision_simulation_result_t* src);
 void clear_result_hash_collision_simulation_result(hash_collision_simulation_result_t* res,
@@ -0,0 +1,110 @@
+/**
+ * \file            hash_collision_cycle_worker.c
+ * \brief           The worker of the cycle strategy of the collision page, which finds the
+ *                  collision at the start of the cycle of a walk of iterated hashes
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_cycle_worker.h"
+
+/**************************************************************
+                      EXTERNAL FUNCTIONS
+**************************************************************/
+
+/**
+ * \brief          The worker of the cycle search strategy, a memoryless rho search. Iterating
+ *                 the hash from a start always runs into a cycle, and the point where the
+ *                 walk enters it has two different predecessors with the same digest: the
+ *                 last point before the cycle and the last point of the cycle. Brent's
+ *                 search finds the cycle length with two points in memory, then a second
+ *                 walker that many steps ahead meets the first at the entry. A start that
+ *                 is already on the cycle has no such entry, and the search starts over.
+ *                 The walk is sequential, so only the first worker runs it.
+ *
+ * \param[in]      worker The data of this worker
+ * \param[out]     stats The statistics of the worker
+ */
+void
+hash_collision_cycle_worker(WorkerData* worker, hash_collision_stats_t* stats) {
+    hash_collision_context_t* ctx = worker->ctx;
+    if (worker->worker_id != 0) {
+        return;
+    }
+
+    hash_walker_t walker = {.ctx = ctx,
+                            .worker_id = worker->worker_id,
+                            .point_length = walk_point_length(ctx->hash_id),
+                            .max_attempts = ctx->max_attempts};
+    size_t length = walker.point_length;
+    uint8_t start[BH_WALK_MAX_BYTES];
+    uint8_t tortoise[BH_WALK_MAX_BYTES];
+    uint8_t hare[BH_WALK_MAX_BYTES];
+    char hash_hex[BH_HASH_MAX_HEX];
+    char hare_hex[BH_HASH_MAX_HEX];
+    bool running = true;
+
+    for (guint32 restart = 0; running; restart++) {
+        generate_indexed_input(ctx->run_seed, worker->worker_id, restart, start, length, length);
+
+        // Find the cycle length: the tortoise waits at every power of two for the hare
+        memcpy(tortoise, start, length);
+        memcpy(hare, start, length);
+        running = walker_step(&walker, hare, hash_hex);
+        unsigned int power = 1;
+        unsigned int cycle_length = 1;
+        while (running && memcmp(tortoise, hare, length) != 0) {
+            if (power == cycle_length) {
+                memcpy(tortoise, hare, length);
+                power *= 2;
+                cycle_length = 0;
+            }
+            running = walker_step(&walker, hare, hash_hex);
+            cycle_length++;
+        }
+
+        // Put the hare one cycle length ahead of the tortoise at the start
+        memcpy(tortoise, start, length);
+        memcpy(hare, start, length);
+        for (unsigned int i = 0; running && i < cycle_length; i++) {
+            running = walker_step(&walker, hare, hash_hex);
+        }
+        if (!running) {
+            break;
+        }
+        if (memcmp(tortoise, hare, length) == 0) {
+            stats->cycle_restarts++;
+            continue;
+        }
+
+        // Both meet at the entry of the cycle, the points before it share a digest
+        while (running) {
+            uint8_t tortoise_input[BH_WALK_MAX_BYTES];
+            uint8_t hare_input[BH_WALK_MAX_BYTES];
+            memcpy(tortoise_input, tortoise, length);
+            memcpy(hare_input, hare, length);
+
+            running = walker_step(&walker, tortoise, hash_hex)
+                      && walker_step(&walker, hare, hare_hex);
+            if (running && strcmp(hash_hex, hare_hex) == 0) {
+                char* tortoise_input_hex = bytes_to_hex(tortoise_input, length, true);
+                char* hare_input_hex = bytes_to_hex(hare_input, length, true);
+                if (tortoise_input_hex && hare_input_hex) {
+                    record_collision(ctx, tortoise_input_hex, hare_input_hex, hash_hex);
+                } else {
+                    REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_MEMORY_ALLOCATION,
+                                        "Input hex string allocation failed");
+                }
+                free(tortoise_input_hex);
+                free(hare_input_hex);
+                running = false;
+            }
+        }
+    }
+
+    g_atomic_int_add((gint*)&ctx->result->attempts_made, (gint)walker.pending);
+}
@@ -0,0 +1,149 @@
+/**
+ * \file            hash_collision_detector.c
+ * \brief           The collision detectors of a run that hashes every input with several
+ *                  hash functions. Each detector keeps the fingerprints of its own digests
+ *                  in a compact table, and retires once it has found its collision, which
+ *                  frees the table while the other detectors keep looking.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_detector.h"
+
+/****************************************************************
+                       EXTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Create an empty set of detectors. You should free the returned set using
+ *                 `hash_detector_set_destroy` when done.
+ *
+ * \return         A pointer to the newly created set, or NULL on memory allocation failure
+ */
+hash_detector_set_t*
+hash_detector_set_create(void) {
+    return calloc(1, sizeof(hash_detector_set_t));
+}
+
+/**
+ * \brief          Add a detector for a hash function. The table is sized for the expected
+ *                 collision bound of the compared bits, the attempts of the run or every
+ *                 possible digest, whichever is fewest.
+ *
+ * \param[in]      set The set to add the detector to
+ * \param[in]      hash_id The hash function the detector watches
+ * \param[in]      truncation_bits The leading bits of the digest to compare, below the output
+ *                 bits and at most BH_DETECTOR_MAX_TRUNCATION_BITS, or 0 to compare the whole
+ *                 digest
+ * \param[in]      max_attempts The total number of attempts of the run
+ * \return         true on success, false when the set is full, the truncation is invalid or
+ *                 on memory allocation failure
+ */
+bool
+hash_detector_set_add(hash_detector_set_t* set, enum hash_function_ids hash_id,
+                      unsigned int truncation_bits, unsigned int max_attempts) {
+    unsigned int output_bits = get_hash_config_item(hash_id).bits;
+    if (set->count == BH_DETECTOR_MAX || truncation_bits >= output_bits
+        || truncation_bits > BH_DETECTOR_MAX_TRUNCATION_BITS) {
+        return false;
+    }
+
+    hash_detector_t* detector = &set->detectors[set->count];
+    memset(detector, 0, sizeof(*detector));
+    detector->hash_id = hash_id;
+    detector->bits = truncation_bits ? truncation_bits : output_bits;
+    detector->hex_length = (truncation_bits + 3) / 4;
+
+    double entries = BH_DETECTOR_BOUND_FACTOR * ldexp(1.0, detector->bits / 2);
+    if (ldexp(1.0, detector->bits) < entries) {
+        entries = ldexp(1.0, detector->bits);
+    }
+    if (max_attempts < entries) {
+        entries = max_attempts;
+    }
+    detector->table = hash_compact_table_create((size_t)entries);
+    if (!detector->table) {
+        return false;
+    }
+
+    g_mutex_init(&detector->mutex);
+    set->count++;
+    set->active++;
+    return true;
+}
+
+/**
+ * \brief          Stop a detector and free its table. The caller must hold detector->mutex,
+ *                 and a retired detector is left as it is.
+ *
+ * \param[in]      set The set the detector belongs to
+ * \param[in]      detector The detector to retire
+ */
+void
+hash_detector_retire(hash_detector_set_t* set, hash_detector_t* detector) {
+    if (g_atomic_int_get(&detector->retired)) {
+        return;
+    }
+
+    detector->table_bytes = hash_compact_table_memory_size(detector->table);
+    hash_compact_table_destroy(detector->table);
+    detector->table = NULL;
+    g_atomic_int_set(&detector->retired, 1);
+    g_atomic_int_dec_and_test(&set->active);
+}
+
+/**
+ * \brief          Check whether a detector has stopped looking, without taking its mutex
+ *
+ * \param[in]      detector The detector to check
+ * \return         true if it is retired
+ */
+bool
+hash_detector_is_retired(hash_detector_t* detector) {
+    return g_atomic_int_get(&detector->retired) != 0;
+}
+
+/**
+ * \brief          Get the memory of the tables of every detector, the size a retired table
+ *                 had when it was freed. Only call this once every worker of the run has
+ *                 exited.
+ *
+ * \param[in]      set The set to measure
+ * \return         The size of the tables in bytes
+ */
+size_t
+hash_detector_set_table_bytes(hash_detector_set_t* set) {
+    size_t bytes = 0;
+    for (unsigned int i = 0; i < set->count; i++) {
+        hash_detector_t* detector = &set->detectors[i];
+        bytes += detector->table ? hash_compact_table_memory_size(detector->table)
+                                 : detector->table_bytes;
+    }
+    return bytes;
+}
+
+/**
+ * \brief          Destroy the set with the tables and the collisions of its detectors
+ *
+ * \param[in]      set The set to destroy, NULL is ignored
+ */
+void
+hash_detector_set_destroy(hash_detector_set_t* set) {
+    if (!set) {
+        return;
+    }
+
+    for (unsigned int i = 0; i < set->count; i++) {
+        hash_detector_t* detector = &set->detectors[i];
+        hash_compact_table_destroy(detector->table);
+        free(detector->collision_input_1);
+        free(detector->collision_input_2);
+        free(detector->collision_hash_hex);
+        g_mutex_clear(&detector->mutex);
+    }
+    free(set);
+}
@@ -0,0 +1,84 @@
+/**
+ * \file            hash_collision_detector.h
+ * \brief           Header file for hash_collision_detector.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_COLLISION_DETECTOR_H
+#define HASH_COLLISION_DETECTOR_H
+
+#include <glib.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "hash_collision_compact.h"
+#include "hash_config.h"
+
+/**
+ * \brief          The most detectors a run can feed
+ */
+#define BH_DETECTOR_MAX 16
+
+/**
+ * \brief          The most leading bits a detector can compare instead of the whole digest,
+ *                 the truncated digest fits the 64-bit fingerprint
+ */
+#define BH_DETECTOR_MAX_TRUNCATION_BITS 64
+
+/**
+ * \brief          A detector table is first sized for this many times the square root of the
+ *                 number of digests, about twice the expected first collision point of
+ *                 1.25 sqrt(N). It grows in the rare run that needs more.
+ */
+#define BH_DETECTOR_BOUND_FACTOR 2.5
+
+/**
+ * \brief          Looks for the first collision of one hash function in the inputs shared by
+ *                 every detector of a run, either on the whole digest or on its first bits.
+ *                 The digests are kept as fingerprints with the index of their input, like
+ *                 the compact entries strategy.
+ */
+typedef struct {
+    enum hash_function_ids hash_id; ///< The hash function the detector watches
+    unsigned int bits;              ///< The bits compared, the truncation or the output bits
+    unsigned int hex_length;        ///< The hex characters compared, 0 for the whole digest.
+                                    ///< The last one is masked to the bits compared
+    hash_compact_table_t* table;    ///< The fingerprints of the digests, NULL once retired
+    GMutex mutex;                   ///< Guards the table and everything below it
+    int retired;                    ///< Set once the detector stops looking, read atomically
+    guint64 digests;                ///< The digests looked up, the collision point once found
+    guint64 fingerprint_matches;    ///< Fingerprints shared by different digests
+    size_t table_bytes;             ///< The size of the table, kept once it is freed
+    gint64 hash_time;               ///< Microseconds the workers spent hashing for it
+    guint64 hashes;                 ///< The hashes the workers made for it, with confirmations
+    bool collision_found;           ///< Whether a collision was found
+    char* collision_input_1;        ///< The input stored first
+    char* collision_input_2;        ///< The input that collided with it
+    char* collision_hash_hex;       ///< The digest, or its compared part, shared by both inputs
+} hash_detector_t;
+
+/**
+ * \brief          The detectors of a run, fed from one stream of inputs
+ */
+typedef struct {
+    hash_detector_t detectors[BH_DETECTOR_MAX]; ///< The detectors, count of them are used
+    unsigned int count;                         ///< The number of detectors
+    int active;                                 ///< The detectors not yet retired, atomic
+} hash_detector_set_t;
+
+hash_detector_set_t* hash_detector_set_create(void);
+bool hash_detector_set_add(hash_detector_set_t* set, enum hash_function_ids hash_id,
+                           unsigned int truncation_bits, unsigned int max_attempts);
+void hash_detector_retire(hash_detector_set_t* set, hash_detector_t* detector);
+bool hash_detector_is_retired(hash_detector_t* detector);
+size_t hash_detector_set_table_bytes(hash_detector_set_t* set);
+void hash_detector_set_destroy(hash_detector_set_t* set);
+
+#endif
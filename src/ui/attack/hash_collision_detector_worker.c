@@ -0,0 +1,205 @@
+/**
+ * \file            hash_collision_detector_worker.c
+ * \brief           The worker of the compare page, which hashes every input with the hash
+ *                  function of each detector
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_detector_worker.h"
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Get the part of a digest a detector compares: the whole digest, or its
+ *                 truncation
+ *
+ * \param[in]      detector The detector comparing the digest
+ * \param[in]      hash_hex The digest in hex
+ * \param[out]     truncated A buffer of 17 characters the truncated digest is written to
+ * \return         hash_hex itself, or truncated
+ */
+static const char*
+detector_compared_digest(const hash_detector_t* detector, const char* hash_hex,
+                         char* truncated) {
+    if (!detector->hex_length) {
+        return hash_hex;
+    }
+    return truncate_hex_digest(hash_hex, detector->bits, truncated);
+}
+
+/**************************************************************
+                      EXTERNAL FUNCTIONS
+**************************************************************/
+
+/**
+ * \brief          Look up the digests of one detector for a batch of inputs, and insert the
+ *                 new ones. A found fingerprint is confirmed by regenerating the stored input
+ *                 and hashing it again, and a confirmed collision retires the detector.
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      detector The detector to feed
+ * \param[in]      worker_id The id of the worker the inputs belong to
+ * \param[in]      first_index The index of the first input of the batch
+ * \param[in]      inputs The inputs of the batch
+ * \param[in]      input_lens The length of every input in bytes
+ * \param[in]      hash_hexes The digest of every input with the hash of the detector
+ * \param[in]      count The number of inputs in the batch
+ * \return         false when a hash or an allocation failed and the error is registered,
+ *                 true otherwise
+ */
+bool
+detector_lookup_batch(hash_collision_context_t* ctx, hash_detector_t* detector,
+                      unsigned int worker_id, guint32 first_index,
+                      uint8_t inputs[][32], const size_t* input_lens, char* const* hash_hexes,
+                      unsigned int count) {
+    bool ok = true;
+    g_mutex_lock(&detector->mutex);
+    for (unsigned int i = 0; i < count && ok && detector->table; i++) {
+        uint64_t existing;
+        bool found;
+        detector->digests++;
+
+        // A truncated digest fits the 64 bits the fingerprint is made of, so its fingerprints
+        // never match by chance
+        char truncated[17];
+        const char* compared = detector_compared_digest(detector, hash_hexes[i], truncated);
+        if (!hash_compact_table_find_or_insert(detector->table, hash_filter_fingerprint(compared),
+                                               ((uint64_t)worker_id << 32) | (first_index + i),
+                                               &existing, &found)) {
+            REGISTER_ERROR_FUNC(ctx, worker_id, ERROR_HASH_TABLE_INSERT,
+                                "Fingerprint insert into detector table failed");
+            hash_detector_retire(ctx->detectors, detector);
+            ok = false;
+            break;
+        }
+        if (!found) {
+            continue;
+        }
+
+        uint8_t stored_input[32];
+        size_t stored_len = generate_indexed_input(ctx->run_seed, (unsigned int)(existing >> 32),
+                                                   (guint32)existing, stored_input, 4, 31);
+        char stored_hash[BH_HASH_MAX_HEX];
+        if (!compute_hash(detector->hash_id, stored_input, stored_len, stored_hash)) {
+            REGISTER_ERROR_FUNC(ctx, worker_id, ERROR_HASH_COMPUTATION,
+                                "Hash function returned invalid result");
+            ok = false;
+            break;
+        }
+        detector->hashes++;
+
+        bool same_input =
+            stored_len == input_lens[i] && memcmp(stored_input, inputs[i], stored_len) == 0;
+        char stored_truncated[17];
+        const char* stored_compared =
+            detector_compared_digest(detector, stored_hash, stored_truncated);
+        if (same_input || strcmp(stored_compared, compared) != 0) {
+            detector->fingerprint_matches++;
+            continue;
+        }
+
+        detector->collision_input_1 = bytes_to_hex(stored_input, stored_len, true);
+        detector->collision_input_2 = bytes_to_hex(inputs[i], input_lens[i], true);
+        detector->collision_hash_hex = strdup(stored_compared); // Only the part that collided
+        detector->collision_found = detector->collision_input_1 != NULL
+                                    && detector->collision_input_2 != NULL
+                                    && detector->collision_hash_hex != NULL;
+        if (!detector->collision_found) {
+            REGISTER_ERROR_FUNC(ctx, worker_id, ERROR_MEMORY_ALLOCATION,
+                                "Input hex string allocation failed");
+            ok = false;
+        }
+        hash_detector_retire(ctx->detectors, detector);
+    }
+    g_mutex_unlock(&detector->mutex);
+    return ok;
+}
+
+/**
+ * \brief          The worker of a detector run. Every input is generated once from its index
+ *                 and hashed once with the hash function of every detector still looking, so
+ *                 the input generation is shared and the batch stays in the cache while it is
+ *                 hashed again. The detectors that watch the truncations of the same function
+ *                 share its digests, and the time spent hashing is counted for each of them.
+ *                 The worker stops once its attempts are made or every detector has retired.
+ *
+ * \param[in]      worker The data of this worker
+ */
+void
+hash_collision_detector_worker(WorkerData* worker) {
+    hash_collision_context_t* ctx = worker->ctx;
+    hash_detector_set_t* set = ctx->detectors;
+    uint8_t inputs[BH_TABLE_BATCH_SIZE][32];
+    const uint8_t* input_ptrs[BH_TABLE_BATCH_SIZE];
+    size_t input_lens[BH_TABLE_BATCH_SIZE];
+    char hex_buffers[BH_TABLE_BATCH_SIZE][BH_HASH_MAX_HEX];
+    char* hash_hexes[BH_TABLE_BATCH_SIZE];
+    for (unsigned int i = 0; i < BH_TABLE_BATCH_SIZE; i++) {
+        input_ptrs[i] = inputs[i];
+        hash_hexes[i] = hex_buffers[i];
+    }
+
+    bool ok = true;
+    unsigned int attempt = 0;
+    while (ok && attempt < worker->attempts_to_make && g_atomic_int_get(&set->active) > 0
+           && !g_atomic_int_get((gint*)&ctx->cancel)) {
+        unsigned int batch = worker->attempts_to_make - attempt;
+        if (batch > BH_TABLE_BATCH_SIZE) {
+            batch = BH_TABLE_BATCH_SIZE;
+        }
+        for (unsigned int i = 0; i < batch; i++) {
+            input_lens[i] = generate_indexed_input(ctx->run_seed, worker->worker_id, attempt + i,
+                                                   inputs[i], 4, 31);
+        }
+
+        // The digests of the batch are kept while the next detectors watch the same function
+        bool have_digests = false;
+        enum hash_function_ids digests_id = HASH_CONFIG_SHA256;
+        unsigned int hashed = 0;
+        gint64 elapsed = 0;
+
+        for (unsigned int d = 0; d < set->count && ok; d++) {
+            hash_detector_t* detector = &set->detectors[d];
+            if (hash_detector_is_retired(detector)) {
+                continue;
+            }
+
+            if (!have_digests || digests_id != detector->hash_id) {
+                have_digests = true;
+                digests_id = detector->hash_id;
+
+                gint64 started = g_get_monotonic_time();
+                hashed = batch;
+                if (!compute_hash_batch(detector->hash_id, input_ptrs, input_lens, batch,
+                                        hash_hexes)) {
+                    REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_HASH_COMPUTATION,
+                                        "Hash function returned invalid result");
+                    hashed = 0;
+                    ok = false;
+                }
+                elapsed = g_get_monotonic_time() - started;
+            }
+
+            if (ok) {
+                ok = detector_lookup_batch(ctx, detector, worker->worker_id, attempt, inputs,
+                                           input_lens, hash_hexes, batch);
+            }
+
+            // The timing is added under the lock the detector is read with
+            g_mutex_lock(&detector->mutex);
+            detector->hash_time += elapsed;
+            detector->hashes += hashed;
+            g_mutex_unlock(&detector->mutex);
+        }
+
+        g_atomic_int_add((gint*)&ctx->result->attempts_made, (gint)batch);
+        attempt += batch;
+    }
+}
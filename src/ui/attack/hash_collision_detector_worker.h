@@ -0,0 +1,22 @@
+/**
+ * \file            hash_collision_detector_worker.h
+ * \brief           Header file for hash_collision_detector_worker.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_COLLISION_DETECTOR_WORKER_H
+#define HASH_COLLISION_DETECTOR_WORKER_H
+
+#include "hash_collision_run.h"
+
+bool detector_lookup_batch(hash_collision_context_t* ctx, hash_detector_t* detector,
+                           unsigned int worker_id, guint32 first_index, uint8_t inputs[][32],
+                           const size_t* input_lens, char* const* hash_hexes, unsigned int count);
+void hash_collision_detector_worker(WorkerData* worker);
+
+#endif
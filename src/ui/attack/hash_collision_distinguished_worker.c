@@ -0,0 +1,179 @@
+/**
+ * \file            hash_collision_distinguished_worker.c
+ * \brief           The worker of the distinguished points strategy of the collision page, which
+ *                  walks trails of iterated hashes and stores only their distinguished ends
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_distinguished_worker.h"
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Pack the start and length of a distinguished point trail into the payload
+ *                 of its end in the compact table
+ *
+ * \param[in]      worker_id The worker that walked the trail, below 2^16
+ * \param[in]      trail The index of the trail among the trails of the worker, below 2^24
+ * \param[in]      length The number of hashes from the start to the end, below 2^24
+ * \return         The payload
+ */
+static inline uint64_t
+trail_payload(unsigned int worker_id, guint32 trail, guint32 length) {
+    return ((uint64_t)worker_id << 48) | ((uint64_t)(trail & 0xFFFFFF) << 24) | (length & 0xFFFFFF);
+}
+
+/**
+ * \brief          Walk two trails that end in the same distinguished point again to find
+ *                 where they merge. The longer trail is walked until both are as far from
+ *                 the end, then both are walked together until their next points are the
+ *                 same: the two current points are then different inputs with the same
+ *                 digest. A trail that starts on the other trail merges without a collision.
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      worker_id The id of the walking worker
+ * \param[in]      first The payload of the trail stored first
+ * \param[in]      second The payload of the trail that ended at the same point
+ * \param[out]     stats The statistics of the calling worker
+ * \return         WORKER_STEP_STOP when a collision was found or the hash failed, otherwise
+ *                 WORKER_STEP_CONTINUE
+ */
+static worker_step_t
+resolve_trail_merge(hash_collision_context_t* ctx, unsigned int worker_id, uint64_t first,
+                    uint64_t second, hash_collision_stats_t* stats) {
+    size_t point_length = walk_point_length(ctx->hash_id);
+    uint8_t point_a[BH_WALK_MAX_BYTES];
+    uint8_t point_b[BH_WALK_MAX_BYTES];
+    guint32 length_a = first & 0xFFFFFF;
+    guint32 length_b = second & 0xFFFFFF;
+    generate_indexed_input(ctx->run_seed, (unsigned int)(first >> 48), (first >> 24) & 0xFFFFFF,
+                           point_a, point_length, point_length);
+    generate_indexed_input(ctx->run_seed, (unsigned int)(second >> 48),
+                           (second >> 24) & 0xFFFFFF, point_b, point_length, point_length);
+
+    char hash_a[BH_HASH_MAX_HEX];
+    char hash_b[BH_HASH_MAX_HEX];
+    for (; length_a > length_b; length_a--) {
+        if (!walk_hash(ctx, worker_id, point_a, point_length, hash_a)) {
+            return WORKER_STEP_STOP;
+        }
+        stats->rewalk_hashes++;
+    }
+    for (; length_b > length_a; length_b--) {
+        if (!walk_hash(ctx, worker_id, point_b, point_length, hash_b)) {
+            return WORKER_STEP_STOP;
+        }
+        stats->rewalk_hashes++;
+    }
+
+    worker_step_t step = WORKER_STEP_CONTINUE;
+    uint8_t input_a[BH_WALK_MAX_BYTES];
+    uint8_t input_b[BH_WALK_MAX_BYTES];
+    for (; length_a > 0 && memcmp(point_a, point_b, point_length) != 0; length_a--) {
+        memcpy(input_a, point_a, point_length);
+        memcpy(input_b, point_b, point_length);
+        if (!walk_hash(ctx, worker_id, point_a, point_length, hash_a)
+            || !walk_hash(ctx, worker_id, point_b, point_length, hash_b)) {
+            return WORKER_STEP_STOP;
+        }
+        stats->rewalk_hashes += 2;
+
+        if (strcmp(hash_a, hash_b) == 0) {
+            char* input_a_hex = bytes_to_hex(input_a, point_length, true);
+            char* input_b_hex = bytes_to_hex(input_b, point_length, true);
+            if (input_a_hex && input_b_hex) {
+                record_collision(ctx, input_a_hex, input_b_hex, hash_a);
+            } else {
+                REGISTER_ERROR_FUNC(ctx, worker_id, ERROR_MEMORY_ALLOCATION,
+                                    "Input hex string allocation failed");
+            }
+            free(input_a_hex);
+            free(input_b_hex);
+            step = WORKER_STEP_STOP;
+            break;
+        }
+    }
+    return step;
+}
+
+/**************************************************************
+                      EXTERNAL FUNCTIONS
+**************************************************************/
+
+/**
+ * \brief          The worker of the distinguished points strategy. Every trail starts at a
+ *                 point generated from its index and iterates the hash until it reaches a
+ *                 distinguished point, a digest whose fingerprint has its low bits zero.
+ *                 Only the ends are stored, and two trails with the same end merged
+ *                 somewhere: they are walked again to find the two points of the merge.
+ *                 Trails longer than the limit of the plan are stuck in a cycle and dropped.
+ *
+ * \param[in]      worker The data of this worker
+ * \param[out]     stats The statistics of the worker
+ */
+void
+hash_collision_distinguished_worker(WorkerData* worker, hash_collision_stats_t* stats) {
+    hash_collision_context_t* ctx = worker->ctx;
+    hash_walker_t walker = {.ctx = ctx,
+                            .worker_id = worker->worker_id,
+                            .point_length = walk_point_length(ctx->hash_id),
+                            .max_attempts = worker->attempts_to_make};
+    uint64_t distinguished_mask = ((uint64_t)1 << ctx->plan.distinguished_bits) - 1;
+    uint8_t point[BH_WALK_MAX_BYTES];
+
+    worker_step_t step = WORKER_STEP_CONTINUE;
+    for (guint32 trail = 0; trail < BH_PLAN_MAX_TRAILS && step == WORKER_STEP_CONTINUE; trail++) {
+        generate_indexed_input(ctx->run_seed, worker->worker_id, trail, point,
+                               walker.point_length, walker.point_length);
+
+        char hash_hex[BH_HASH_MAX_HEX];
+        guint32 length = 0;
+        bool distinguished = false;
+        uint64_t fingerprint = 0;
+        while (!distinguished && length < ctx->plan.trail_limit) {
+            if (!walker_step(&walker, point, hash_hex)) {
+                step = WORKER_STEP_STOP;
+                break;
+            }
+            length++;
+            fingerprint = hash_filter_fingerprint(hash_hex);
+            distinguished = (fingerprint & distinguished_mask) == 0;
+        }
+
+        if (!distinguished) {
+            if (step == WORKER_STEP_CONTINUE) {
+                stats->abandoned_trails++;
+            }
+            continue;
+        }
+
+        stats->trails++;
+        uint64_t payload = trail_payload(worker->worker_id, trail, length);
+        uint64_t existing;
+        bool found;
+        g_mutex_lock(ctx->table_mutex);
+        bool inserted = hash_compact_table_find_or_insert(ctx->compact, fingerprint, payload,
+                                                          &existing, &found);
+        g_mutex_unlock(ctx->table_mutex);
+
+        if (!inserted) {
+            step = WORKER_STEP_INSERT_FAILED;
+        } else if (found) {
+            stats->trail_merges++;
+            step = resolve_trail_merge(ctx, worker->worker_id, existing, payload, stats);
+        }
+    }
+
+    g_atomic_int_add((gint*)&ctx->result->attempts_made, (gint)walker.pending);
+    if (step == WORKER_STEP_INSERT_FAILED) {
+        REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_HASH_TABLE_INSERT,
+                            "Trail end insert into compact table failed");
+    }
+}
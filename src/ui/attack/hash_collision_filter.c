@@ -0,0 +1,251 @@
+/**
+ * \file            hash_collision_filter.c
+ * \brief           A cache-resident blocked Bloom filter that sits in front of the
+ *                  hash collision table. Every block is one cache line, so a query
+ *                  costs at most one memory access, and a definite miss never has to
+ *                  walk a bucket chain of the main table.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_filter.h"
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Odd multipliers used to derive one bit position per block word from
+ *                 the lower half of the fingerprint (the split block Bloom filter salts)
+ */
+static const uint32_t s_filter_salts[BH_FILTER_BLOCK_WORDS] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U,
+};
+
+/**
+ * \brief          Get the block a fingerprint maps to. The upper 32 bits of the
+ *                 fingerprint are scaled to the block count with a multiply and shift,
+ *                 which avoids the cost of a modulo on every query.
+ *
+ * \param[in]      filter The filter to get the block from
+ * \param[in]      fingerprint The fingerprint of the digest
+ * \return         Pointer to the first word of the block
+ */
+static inline uint64_t*
+hash_filter_block(const hash_filter_t* filter, uint64_t fingerprint) {
+    uint64_t index = ((fingerprint >> 32) * (uint64_t)filter->block_count) >> 32;
+    return filter->blocks + (index * BH_FILTER_BLOCK_WORDS);
+}
+
+/**
+ * \brief          Get the bit to test or set in a given word of the block
+ *
+ * \param[in]      fingerprint The fingerprint of the digest
+ * \param[in]      word The index of the word in the block, 0 to BH_FILTER_BLOCK_WORDS - 1
+ * \return         A mask with exactly one bit set
+ */
+static inline uint64_t
+hash_filter_word_mask(uint64_t fingerprint, unsigned int word) {
+    uint32_t bit = ((uint32_t)fingerprint * s_filter_salts[word]) >> 26; // 0 - 63
+    return (uint64_t)1 << bit;
+}
+
+/****************************************************************
+                       EXTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Create a new blocked Bloom filter sized for the expected number of
+ *                 entries. You should free the returned filter using `hash_filter_destroy`
+ *                 when done.
+ *
+ * \param[in]      expected_entries The number of digests expected to be inserted
+ * \param[in]      bits_per_entry The number of filter bits to reserve per entry, 0 to use
+ *                 BH_FILTER_BITS_PER_ENTRY
+ * \return         A pointer to the newly created filter, or NULL on memory allocation
+ *                 failure
+ */
+hash_filter_t*
+hash_filter_create(size_t expected_entries, unsigned int bits_per_entry) {
+    if (bits_per_entry == 0) {
+        bits_per_entry = BH_FILTER_BITS_PER_ENTRY;
+    }
+
+    hash_filter_t* filter = malloc(sizeof(hash_filter_t));
+    if (!filter) {
+        return NULL;
+    }
+
+    // Round the total bits up to whole 512-bit blocks, with at least one block
+    const size_t block_bits = BH_FILTER_BLOCK_WORDS * 64;
+    size_t total_bits = expected_entries * bits_per_entry;
+    filter->block_count = (total_bits + block_bits - 1) / block_bits;
+    if (filter->block_count == 0) {
+        filter->block_count = 1;
+    }
+
+    // aligned_alloc is not available on every platform we build for (MinGW), so over
+    // allocate by one cache line and align the block pointer manually
+    size_t bytes = filter->block_count * BH_FILTER_BLOCK_WORDS * sizeof(uint64_t);
+    filter->allocation = calloc(1, bytes + 64);
+    if (!filter->allocation) {
+        free(filter);
+        return NULL;
+    }
+
+    uintptr_t aligned = ((uintptr_t)filter->allocation + 63) & ~(uintptr_t)63;
+    filter->blocks = (uint64_t*)aligned;
+
+    return filter;
+}
+
+/**
+ * \brief          Derive a 64-bit filter fingerprint from the hexadecimal digest. Up to
+ *                 the first 16 hex characters are parsed and then mixed, so that short
+ *                 digests like the ToyHash outputs still spread over every block.
+ *
+ * \param[in]      hash_hex The hexadecimal string representation of the digest
+ * \return         The 64-bit fingerprint of the digest
+ */
+uint64_t
+hash_filter_fingerprint(const char* hash_hex) {
+    uint64_t value = 0;
+    for (unsigned short i = 0; i < 16 && hash_hex[i] != '\0'; i++) {
+        char c = hash_hex[i];
+        uint64_t nibble = 0;
+        if (c >= '0' && c <= '9') {
+            nibble = c - '0';
+        } else if (c >= 'A' && c <= 'F') {
+            nibble = c - 'A' + 10;
+        } else if (c >= 'a' && c <= 'f') {
+            nibble = c - 'a' + 10;
+        }
+        value = (value << 4) | nibble;
+    }
+
+    // MurmurHash3 64-bit finalizer to spread every input bit over the fingerprint
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+/**
+ * \brief          Check whether a fingerprint may have been inserted into the filter.
+ *                 A false result is definite, a true result may be a false positive.
+ *
+ * \param[in]      filter The filter to query
+ * \param[in]      fingerprint The fingerprint from hash_filter_fingerprint
+ * \return         true if the fingerprint may be present, false if it is definitely absent
+ */
+bool
+hash_filter_contains(const hash_filter_t* filter, uint64_t fingerprint) {
+    const uint64_t* block = hash_filter_block(filter, fingerprint);
+
+    for (unsigned int word = 0; word < BH_FILTER_BLOCK_WORDS; word++) {
+        if ((block[word] & hash_filter_word_mask(fingerprint, word)) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * \brief          Insert a fingerprint into the filter
+ *
+ * \param[in]      filter The filter to insert into
+ * \param[in]      fingerprint The fingerprint from hash_filter_fingerprint
+ */
+void
+hash_filter_insert(hash_filter_t* filter, uint64_t fingerprint) {
+    uint64_t* block = hash_filter_block(filter, fingerprint);
+
+    for (unsigned int word = 0; word < BH_FILTER_BLOCK_WORDS; word++) {
+        block[word] |= hash_filter_word_mask(fingerprint, word);
+    }
+}
+
+/**
+ * \brief          Insert a fingerprint into the filter and report whether it may have
+ *                 been present before the insert. This touches the block only once, which
+ *                 is what the collision workers need for every generated digest.
+ *
+ * \param[in]      filter The filter to query and insert into
+ * \param[in]      fingerprint The fingerprint from hash_filter_fingerprint
+ * \return         true if the fingerprint may have been present, false if it was
+ *                 definitely absent
+ */
+bool
+hash_filter_test_and_insert(hash_filter_t* filter, uint64_t fingerprint) {
+    uint64_t* block = hash_filter_block(filter, fingerprint);
+    bool present = true;
+
+    for (unsigned int word = 0; word < BH_FILTER_BLOCK_WORDS; word++) {
+        uint64_t mask = hash_filter_word_mask(fingerprint, word);
+        if ((block[word] & mask) == 0) {
+            present = false;
+            block[word] |= mask;
+        }
+    }
+    return present;
+}
+
+/**
+ * \brief          Get the number of bytes used by the filter bits
+ *
+ * \param[in]      filter The filter to measure
+ * \return         The size of the filter bits in bytes, 0 if filter is NULL
+ */
+size_t
+hash_filter_memory_size(const hash_filter_t* filter) {
+    if (!filter) {
+        return 0;
+    }
+    return filter->block_count * BH_FILTER_BLOCK_WORDS * sizeof(uint64_t);
+}
+
+/**
+ * \brief          Get the number of bytes of filter bits hash_filter_create would allocate,
+ *                 without creating the filter
+ *
+ * \param[in]      expected_entries The number of digests expected to be inserted
+ * \param[in]      bits_per_entry The number of filter bits to reserve per entry, 0 to use
+ *                 BH_FILTER_BITS_PER_ENTRY
+ * \return         The size of the filter bits in bytes
+ */
+size_t
+hash_filter_estimate_bytes(size_t expected_entries, unsigned int bits_per_entry) {
+    if (bits_per_entry == 0) {
+        bits_per_entry = BH_FILTER_BITS_PER_ENTRY;
+    }
+
+    const size_t block_bits = BH_FILTER_BLOCK_WORDS * 64;
+    size_t block_count = (expected_entries * bits_per_entry + block_bits - 1) / block_bits;
+    if (block_count == 0) {
+        block_count = 1;
+    }
+    return block_count * BH_FILTER_BLOCK_WORDS * sizeof(uint64_t);
+}
+
+/**
+ * \brief          Destroys the filter and frees all its resources.
+ *
+ * \param[in]      filter The filter to destroy.
+ */
+void
+hash_filter_destroy(hash_filter_t* filter) {
+    // No filter to destroy, return early
+    if (!filter) {
+        return;
+    }
+
+    free(filter->allocation);
+    free(filter);
+}
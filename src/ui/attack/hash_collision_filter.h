@@ -0,0 +1,48 @@
+/**
+ * \file            hash_collision_filter.h
+ * \brief           Header file for hash_collision_filter.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_COLLISION_FILTER_H
+#define HASH_COLLISION_FILTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * \brief          The number of 64-bit words in one filter block. A block is exactly
+ *                 one 64-byte cache line, so every query touches a single line.
+ */
+#define BH_FILTER_BLOCK_WORDS     8
+
+/**
+ * \brief          The default number of filter bits reserved for every expected entry.
+ *                 At 12 bits per entry the split block filter stays below a 1% false
+ *                 positive rate.
+ */
+#define BH_FILTER_BITS_PER_ENTRY  12
+
+typedef struct {
+    uint64_t* blocks;      ///< The filter bits, BH_FILTER_BLOCK_WORDS words per block
+    size_t block_count;    ///< The number of 64-byte blocks in the filter
+    void* allocation;      ///< The unaligned allocation backing blocks, used to free it
+} hash_filter_t;
+
+hash_filter_t* hash_filter_create(size_t expected_entries, unsigned int bits_per_entry);
+uint64_t hash_filter_fingerprint(const char* hash_hex);
+bool hash_filter_contains(const hash_filter_t* filter, uint64_t fingerprint);
+void hash_filter_insert(hash_filter_t* filter, uint64_t fingerprint);
+bool hash_filter_test_and_insert(hash_filter_t* filter, uint64_t fingerprint);
+size_t hash_filter_memory_size(const hash_filter_t* filter);
+size_t hash_filter_estimate_bytes(size_t expected_entries, unsigned int bits_per_entry);
+void hash_filter_destroy(hash_filter_t* filter);
+
+#endif
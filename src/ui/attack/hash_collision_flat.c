@@ -0,0 +1,519 @@
+/**
+ * \file            hash_collision_flat.c
+ * \brief           A flat, open addressing digest table in the SwissTable style. Slots are
+ *                  grouped by 16, and every group has 16 control bytes holding a 7-bit tag
+ *                  of the digest in each slot. A probe compares the tag against the whole
+ *                  group with one SIMD compare, so a lookup of an absent digest usually
+ *                  reads a single cache line of control bytes. The digests and inputs live
+ *                  out of line in one arena, and a slot only stores a 32-bit arena offset.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_flat.h"
+
+#include "hash_collision_table.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define BH_FLAT_USE_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define BH_FLAT_USE_NEON
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Get the index of the lowest set bit
+ *
+ * \param[in]      mask A non-zero mask
+ * \return         The index of the lowest set bit
+ */
+static inline unsigned int
+hash_flat_lowest_bit(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned int)__builtin_ctz(mask);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned int)index;
+#else
+    unsigned int index = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+/**
+ * \brief          Compare every control byte of a group against a value
+ *
+ * \param[in]      group The BH_FLAT_GROUP_WIDTH control bytes of the group
+ * \param[in]      value The tag, or BH_FLAT_CTRL_EMPTY to find the empty slots
+ * \return         A mask with bit i set when control byte i equals value
+ */
+static inline uint32_t
+hash_flat_group_match(const uint8_t* group, uint8_t value) {
+#if defined(BH_FLAT_USE_SSE2)
+    __m128i ctrl = _mm_load_si128((const __m128i*)group);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)value)));
+#elif defined(BH_FLAT_USE_NEON)
+    // NEON has no movemask, so weight every matching lane by its bit and add up each half
+    static const uint8_t lane_bits[BH_FLAT_GROUP_WIDTH] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                                          1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t equal = vceqq_u8(vld1q_u8(group), vdupq_n_u8(value));
+    uint8x16_t weighted = vandq_u8(equal, vld1q_u8(lane_bits));
+    return (uint32_t)vaddv_u8(vget_low_u8(weighted))
+           | ((uint32_t)vaddv_u8(vget_high_u8(weighted)) << 8);
+#else
+    uint32_t mask = 0;
+    for (unsigned int i = 0; i < BH_FLAT_GROUP_WIDTH; i++) {
+        mask |= (uint32_t)(group[i] == value) << i;
+    }
+    return mask;
+#endif
+}
+
+/**
+ * \brief          Hash a digest for the table with the hasher of the table. The upper bits
+ *                 select the first group to probe and the lowest 7 bits are the tag stored
+ *                 in the control byte.
+ *
+ * \param[in]      table The table the digest is looked up in
+ * \param[in]      hash_hex The hexadecimal string representation of the digest
+ * \return         The 64-bit hash of the digest
+ */
+static inline uint64_t
+hash_flat_key_hash(const hash_flat_table_t* table, const char* hash_hex) {
+    return hash_bucket_hash(&table->hasher, hash_hex);
+}
+
+/**
+ * \brief          Get the stored digest of an occupied slot
+ *
+ * \param[in]      table The table the slot belongs to
+ * \param[in]      slot The index of the slot
+ * \return         The digest, followed in the arena by the input that generated it
+ */
+static inline const char*
+hash_flat_slot_key(const hash_flat_table_t* table, size_t slot) {
+    return table->arena + (size_t)table->slots[slot] * BH_FLAT_ARENA_ALIGN;
+}
+
+/**
+ * \brief          Allocate the control bytes and slots of a table for a number of groups.
+ *                 Every control byte starts empty.
+ *
+ * \param[in]      table The table to allocate, its previous arrays are not freed
+ * \param[in]      group_count The number of groups, must be a power of two
+ * \return         true on success, false on memory allocation failure
+ */
+static bool
+hash_flat_allocate_groups(hash_flat_table_t* table, size_t group_count) {
+    size_t slot_count = group_count * BH_FLAT_GROUP_WIDTH;
+
+    // The control bytes come first and are aligned for the SIMD loads, like the blocked
+    // Bloom filter the alignment is done by hand since aligned_alloc is missing on MinGW
+    void* allocation = malloc(slot_count + slot_count * sizeof(uint32_t) + 64);
+    if (!allocation) {
+        return false;
+    }
+
+    uintptr_t aligned = ((uintptr_t)allocation + 63) & ~(uintptr_t)63;
+    table->allocation = allocation;
+    table->ctrl = (uint8_t*)aligned;
+    table->slots = (uint32_t*)(table->ctrl + slot_count);
+    table->group_mask = group_count - 1;
+
+    // Keep the load at or below 7/8, a full group only costs one more probe
+    table->growth_left = slot_count - slot_count / 8 - table->entry_count;
+    memset(table->ctrl, BH_FLAT_CTRL_EMPTY, slot_count);
+    return true;
+}
+
+/**
+ * \brief          Find the first empty slot on the probe sequence of a hash. The table
+ *                 never deletes, so the first empty slot also ends every lookup of the
+ *                 hash, and the combined lookup and insert only probes once.
+ *
+ * \param[in]      table The table to probe
+ * \param[in]      hash The hash of the digest, from hash_flat_key_hash
+ * \param[in]      hash_hex The digest to look for, NULL to only find an empty slot
+ * \param[out]     found Receives the slot holding hash_hex when it is already stored
+ * \return         The first empty slot on the probe sequence, only valid when not found
+ */
+static size_t
+hash_flat_probe(const hash_flat_table_t* table, uint64_t hash, const char* hash_hex,
+                bool* found) {
+    uint8_t tag = (uint8_t)(hash & 0x7F);
+    size_t group = (size_t)(hash >> 7) & table->group_mask;
+    *found = false;
+
+    // Triangular probing visits every group once when the group count is a power of two
+    for (size_t step = 1;; step++) {
+        const uint8_t* ctrl = table->ctrl + group * BH_FLAT_GROUP_WIDTH;
+
+        if (hash_hex) {
+            uint32_t matches = hash_flat_group_match(ctrl, tag);
+            while (matches) {
+                size_t slot = group * BH_FLAT_GROUP_WIDTH + hash_flat_lowest_bit(matches);
+                if (strcmp(hash_flat_slot_key(table, slot), hash_hex) == 0) {
+                    *found = true;
+                    return slot;
+                }
+                matches &= matches - 1;
+            }
+        }
+
+        uint32_t empty = hash_flat_group_match(ctrl, BH_FLAT_CTRL_EMPTY);
+        if (empty) {
+            return group * BH_FLAT_GROUP_WIDTH + hash_flat_lowest_bit(empty);
+        }
+
+        group = (group + step) & table->group_mask;
+    }
+}
+
+/**
+ * \brief          Double the number of groups and move every entry to its new slot. The
+ *                 arena is left as is, only the control bytes and offsets are rebuilt.
+ *
+ * \param[in]      table The table to grow
+ * \return         true on success, false on memory allocation failure
+ */
+static bool
+hash_flat_grow(hash_flat_table_t* table) {
+    uint8_t* old_ctrl = table->ctrl;
+    uint32_t* old_slots = table->slots;
+    void* old_allocation = table->allocation;
+    size_t old_slot_count = (table->group_mask + 1) * BH_FLAT_GROUP_WIDTH;
+
+    if (!hash_flat_allocate_groups(table, (table->group_mask + 1) * 2)) {
+        return false;
+    }
+
+    for (size_t slot = 0; slot < old_slot_count; slot++) {
+        if (old_ctrl[slot] == BH_FLAT_CTRL_EMPTY) {
+            continue;
+        }
+
+        const char* key = table->arena + (size_t)old_slots[slot] * BH_FLAT_ARENA_ALIGN;
+        uint64_t hash = hash_flat_key_hash(table, key);
+
+        bool found;
+        size_t target = hash_flat_probe(table, hash, NULL, &found);
+        table->ctrl[target] = (uint8_t)(hash & 0x7F);
+        table->slots[target] = old_slots[slot];
+    }
+
+    free(old_allocation);
+    return true;
+}
+
+/**
+ * \brief          Store a digest that is known to be absent in a given empty slot
+ *
+ * \param[in]      table The table to insert into
+ * \param[in]      slot The empty slot, from hash_flat_probe
+ * \param[in]      hash The hash of the digest, from hash_flat_key_hash
+ * \param[in]      input The input string that generated the hash.
+ * \param[in]      hash_hex The hexadecimal string representation of the hash.
+ * \return         true on success, false on memory allocation failure
+ */
+static bool
+hash_flat_store(hash_flat_table_t* table, size_t slot, uint64_t hash, const char* input,
+                const char* hash_hex) {
+    size_t hash_len = strlen(hash_hex) + 1;
+    size_t input_len = strlen(input) + 1;
+    size_t entry_len = (hash_len + input_len + BH_FLAT_ARENA_ALIGN - 1)
+                       & ~(size_t)(BH_FLAT_ARENA_ALIGN - 1);
+
+    if (table->arena_used + entry_len > table->arena_capacity) {
+        size_t capacity = table->arena_capacity * 2;
+        while (table->arena_used + entry_len > capacity) {
+            capacity *= 2;
+        }
+        if (capacity / BH_FLAT_ARENA_ALIGN > UINT32_MAX) {
+            return false; // The offsets of the slots can not address more
+        }
+
+        char* arena = realloc(table->arena, capacity);
+        if (!arena) {
+            return false;
+        }
+        table->arena = arena;
+        table->arena_capacity = capacity;
+    }
+
+    char* entry = table->arena + table->arena_used;
+    memcpy(entry, hash_hex, hash_len);
+    memcpy(entry + hash_len, input, input_len);
+
+    table->ctrl[slot] = (uint8_t)(hash & 0x7F);
+    table->slots[slot] = (uint32_t)(table->arena_used / BH_FLAT_ARENA_ALIGN);
+    table->arena_used += entry_len;
+    table->entry_count++;
+    table->growth_left--;
+    return true;
+}
+
+/**
+ * \brief          Look up a digest and insert it when absent, with a single probe
+ *
+ * \param[in]      table The table to search in and insert into
+ * \param[in]      hash The hash of the digest, from hash_flat_key_hash
+ * \param[in]      input The input string that generated the hash.
+ * \param[in]      hash_hex The hexadecimal string representation of the hash.
+ * \param[in]      lookup false when the digest is known to be absent, which skips the tag
+ *                 compares
+ * \param[out]     existing_input Receives the stored input when the digest was found
+ * \return         true if the digest was found or inserted, false on memory allocation
+ *                 failure
+ */
+static bool
+hash_flat_lookup_insert(hash_flat_table_t* table, uint64_t hash, const char* input,
+                        const char* hash_hex, bool lookup, const char** existing_input) {
+    *existing_input = NULL;
+    if (table->growth_left == 0 && !hash_flat_grow(table)) {
+        return false;
+    }
+
+    bool found;
+    size_t slot = hash_flat_probe(table, hash, lookup ? hash_hex : NULL, &found);
+    if (found) {
+        const char* key = hash_flat_slot_key(table, slot);
+        *existing_input = key + strlen(key) + 1;
+        return true;
+    }
+    return hash_flat_store(table, slot, hash, input, hash_hex);
+}
+
+/****************************************************************
+                       EXTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Create a new flat table sized for the expected number of entries. The
+ *                 table grows when more are inserted. You should free the returned table
+ *                 using `hash_flat_table_destroy` when done.
+ *
+ * \param[in]      expected_entries The number of digests expected to be inserted
+ * \param[in]      hasher The hasher that places the digests, copied into the table
+ * \return         A pointer to the newly created table, or NULL on memory allocation
+ *                 failure
+ */
+hash_flat_table_t*
+hash_flat_table_create(size_t expected_entries, const hash_bucket_hasher_t* hasher) {
+    hash_flat_table_t* table = calloc(1, sizeof(hash_flat_table_t));
+    if (!table) {
+        return NULL;
+    }
+    table->hasher = *hasher;
+
+    // Enough groups to hold the expected entries under the 7/8 load limit
+    size_t group_count = 1;
+    while (group_count * BH_FLAT_GROUP_WIDTH * 7 / 8 < expected_entries) {
+        group_count *= 2;
+    }
+
+    // A SHA-512 digest with its input is about 200 bytes, start at 64 and grow on demand
+    table->arena_capacity = (expected_entries + 1) * 64;
+    table->arena = malloc(table->arena_capacity);
+    if (!table->arena || !hash_flat_allocate_groups(table, group_count)) {
+        free(table->arena);
+        free(table);
+        return NULL;
+    }
+
+    return table;
+}
+
+/**
+ * \brief          Finds the input stored for a digest
+ *
+ * \param[in]      table The table to search in.
+ * \param[in]      hash_hex The hexadecimal string representation of the hash to find.
+ * \return         The input stored with the digest, or NULL if not found. The pointer is
+ *                 only valid until the next insert.
+ */
+const char*
+hash_flat_table_find(const hash_flat_table_t* table, const char* hash_hex) {
+    bool found;
+    size_t slot = hash_flat_probe(table, hash_flat_key_hash(table, hash_hex), hash_hex, &found);
+    if (!found) {
+        return NULL;
+    }
+
+    const char* key = hash_flat_slot_key(table, slot);
+    return key + strlen(key) + 1;
+}
+
+/**
+ * \brief          Inserts a digest that is not in the table yet.
+ *
+ * \param[in]      table The table to insert into.
+ * \param[in]      input The input string that generated the hash.
+ * \param[in]      hash_hex The hexadecimal string representation of the hash.
+ * \return         true if the insertion was successful, false on memory allocation failure.
+ */
+bool
+hash_flat_table_insert(hash_flat_table_t* table, const char* input, const char* hash_hex) {
+    const char* existing_input;
+    return hash_flat_lookup_insert(table, hash_flat_key_hash(table, hash_hex), input, hash_hex,
+                                   false, &existing_input);
+}
+
+/**
+ * \brief          Look up a batch of digests and insert the ones not found, in order. The
+ *                 hashes of the batch are computed and their first groups prefetched before
+ *                 any digest is resolved, like hash_table_lookup_insert_batch, so the control
+ *                 byte misses of the batch overlap.
+ *
+ * \param[in]      table The table to search in and insert into.
+ * \param[in]      inputs The input strings that generated the hashes.
+ * \param[in]      hash_hexes The hexadecimal string representations of the hashes.
+ * \param[in]      count The number of digests in the batch.
+ * \param[in]      known_new Optional flags of the digests known to be absent, which are
+ *                 inserted without a lookup. NULL to look up all.
+ * \param[out]     existing_input Receives the stored input of the digest at the returned
+ *                 index when it was found, or NULL. Only valid until the next insert.
+ * \return         count if every digest was inserted. Otherwise the index of the first
+ *                 digest that was found (existing_input is set) or failed to insert
+ *                 (existing_input is NULL).
+ */
+size_t
+hash_flat_table_lookup_insert_batch(hash_flat_table_t* table, const char* const* inputs,
+                                    const char* const* hash_hexes, size_t count,
+                                    const bool* known_new, const char** existing_input) {
+    uint64_t hashes[BH_TABLE_BATCH_SIZE];
+    *existing_input = NULL;
+
+    for (size_t start = 0; start < count; start += BH_TABLE_BATCH_SIZE) {
+        size_t batch = count - start < BH_TABLE_BATCH_SIZE ? count - start : BH_TABLE_BATCH_SIZE;
+
+        // Stage 1: hash every digest and start loading the control bytes of its first group
+        for (size_t i = 0; i < batch; i++) {
+            hashes[i] = hash_flat_key_hash(table, hash_hexes[start + i]);
+            size_t group = (size_t)(hashes[i] >> 7) & table->group_mask;
+            BH_PREFETCH(table->ctrl + group * BH_FLAT_GROUP_WIDTH);
+        }
+
+        // Stage 2: resolve the batch in order, the table may grow in between so the
+        // groups are derived again from the hashes
+        for (size_t i = 0; i < batch; i++) {
+            bool lookup = !(known_new && known_new[start + i]);
+            if (!hash_flat_lookup_insert(table, hashes[i], inputs[start + i],
+                                         hash_hexes[start + i], lookup, existing_input)
+                || *existing_input) {
+                return start + i;
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * \brief          Get the number of bytes used by the table: control bytes, slots and the
+ *                 used part of the key arena
+ *
+ * \param[in]      table The table to measure
+ * \return         The size of the table in bytes, 0 if table is NULL
+ */
+size_t
+hash_flat_table_memory_size(const hash_flat_table_t* table) {
+    if (!table) {
+        return 0;
+    }
+
+    size_t slot_count = (table->group_mask + 1) * BH_FLAT_GROUP_WIDTH;
+    return slot_count * (1 + sizeof(uint32_t)) + table->arena_used;
+}
+
+/**
+ * \brief          Get the number of bytes a table would allocate once the expected number
+ *                 of entries are inserted, without creating it: the control bytes and slots
+ *                 sized as hash_flat_table_create sizes them, and the arena after it has
+ *                 doubled enough times to hold the entries
+ *
+ * \param[in]      expected_entries The number of entries
+ * \param[in]      entry_bytes The average bytes of the digest and input of an entry, with
+ *                 both null terminators
+ * \return         The size of the table in bytes
+ */
+size_t
+hash_flat_table_estimate_bytes(size_t expected_entries, size_t entry_bytes) {
+    size_t group_count = 1;
+    while (group_count * BH_FLAT_GROUP_WIDTH * 7 / 8 < expected_entries) {
+        group_count *= 2;
+    }
+    size_t slot_count = group_count * BH_FLAT_GROUP_WIDTH;
+
+    size_t entry_len = (entry_bytes + BH_FLAT_ARENA_ALIGN - 1) & ~(size_t)(BH_FLAT_ARENA_ALIGN - 1);
+    size_t arena_capacity = (expected_entries + 1) * 64;
+    while (arena_capacity < expected_entries * entry_len) {
+        arena_capacity *= 2;
+    }
+    return slot_count * (1 + sizeof(uint32_t)) + 64 + arena_capacity;
+}
+
+/**
+ * \brief          Add the probe lengths of the table to a chain length histogram. Every
+ *                 digest is hashed again and its probe sequence is followed to its group,
+ *                 so only call this once the run is over.
+ *
+ * \param[in]      table The table to measure, NULL adds nothing
+ * \param[in,out]  stats The histogram, bin i counts the digests found in the (i + 1)th
+ *                 group of their probe sequence
+ */
+void
+hash_flat_table_chain_stats(const hash_flat_table_t* table, hash_chain_stats_t* stats) {
+    if (!table) {
+        return;
+    }
+
+    size_t slot_count = (table->group_mask + 1) * BH_FLAT_GROUP_WIDTH;
+    for (size_t slot = 0; slot < slot_count; slot++) {
+        if (table->ctrl[slot] == BH_FLAT_CTRL_EMPTY) {
+            continue;
+        }
+
+        uint64_t hash = hash_flat_key_hash(table, hash_flat_slot_key(table, slot));
+        size_t group = (size_t)(hash >> 7) & table->group_mask;
+        size_t probes = 0;
+        for (size_t step = 1; group != slot / BH_FLAT_GROUP_WIDTH; step++) {
+            group = (group + step) & table->group_mask;
+            probes++;
+        }
+        hash_chain_stats_add(stats, probes, 1);
+    }
+}
+
+/**
+ * \brief          Destroys the table and frees all its resources.
+ *
+ * \param[in]      table The table to destroy.
+ */
+void
+hash_flat_table_destroy(hash_flat_table_t* table) {
+    // No table to destroy, return early
+    if (!table) {
+        return;
+    }
+
+    free(table->allocation);
+    free(table->arena);
+    free(table);
+}
@@ -0,0 +1,65 @@
+/**
+ * \file            hash_collision_flat.h
+ * \brief           Header file for hash_collision_flat.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_COLLISION_FLAT_H
+#define HASH_COLLISION_FLAT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_collision_bucket.h"
+
+/**
+ * \brief          The number of slots in one group. The control bytes of a group are
+ *                 matched with a single 16-byte SIMD compare.
+ */
+#define BH_FLAT_GROUP_WIDTH 16
+
+/**
+ * \brief          The control byte of an empty slot. Occupied slots hold a 7-bit tag,
+ *                 so the high bit alone tells empty and occupied apart.
+ */
+#define BH_FLAT_CTRL_EMPTY  0x80
+
+/**
+ * \brief          The alignment of the entries in the key arena. Slots store the arena
+ *                 offset in these units, so 32-bit slots address 32 GiB of keys.
+ */
+#define BH_FLAT_ARENA_ALIGN 8
+
+typedef struct {
+    uint8_t* ctrl;               ///< BH_FLAT_GROUP_WIDTH control bytes per group, empty or a tag
+    uint32_t* slots;             ///< The arena offset of the entry of every occupied slot
+    size_t group_mask;           ///< The number of groups minus one, a power of two minus one
+    size_t entry_count;          ///< The number of entries stored
+    size_t growth_left;          ///< The number of inserts left before the table has to grow
+    char* arena;                 ///< The entries, each one is "hash_hex\0input\0"
+    size_t arena_used;           ///< The number of arena bytes in use
+    size_t arena_capacity;       ///< The number of arena bytes allocated
+    void* allocation;            ///< The unaligned allocation backing ctrl and slots, to free it
+    hash_bucket_hasher_t hasher; ///< Hashes the digests to their first group and tag
+} hash_flat_table_t;
+
+hash_flat_table_t* hash_flat_table_create(size_t expected_entries,
+                                          const hash_bucket_hasher_t* hasher);
+const char* hash_flat_table_find(const hash_flat_table_t* table, const char* hash_hex);
+bool hash_flat_table_insert(hash_flat_table_t* table, const char* input, const char* hash_hex);
+size_t hash_flat_table_lookup_insert_batch(hash_flat_table_t* table, const char* const* inputs,
+                                           const char* const* hash_hexes, size_t count,
+                                           const bool* known_new, const char** existing_input);
+size_t hash_flat_table_memory_size(const hash_flat_table_t* table);
+size_t hash_flat_table_estimate_bytes(size_t expected_entries, size_t entry_bytes);
+void hash_flat_table_chain_stats(const hash_flat_table_t* table, hash_chain_stats_t* stats);
+void hash_flat_table_destroy(hash_flat_table_t* table);
+
+#endif
@@ -0,0 +1,175 @@
+/**
+ * \file            hash_collision_joux.c
+ * \brief           Joux multicollisions of the iterated toy hashes. The toy hashes process
+ *                  their input byte by byte from a small state and output the state, so a
+ *                  collision of two blocks from the same state stays a collision whatever
+ *                  follows. Chaining t of them gives 2^t messages with one digest for the
+ *                  price of t birthday searches.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_joux.h"
+
+/****************************************************************
+                       EXTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Check whether a hash function is an iterated toy hash a multicollision can
+ *                 be chained on
+ *
+ * \param[in]      hash_id The hash function
+ * \return         true for the toy hashes of the registry
+ */
+bool
+hash_joux_supports(enum hash_function_ids hash_id) {
+    return get_hash_config(hash_id)->toy_update != NULL;
+}
+
+/**
+ * \brief          Create a multicollision with a table of every state for the searches of
+ *                 its steps. You should free the returned multicollision using
+ *                 `hash_joux_destroy` when done.
+ *
+ * \param[in]      hash_id The toy hash function
+ * \param[in]      steps The single-block collisions to chain, 1 to BH_JOUX_MAX_STEPS
+ * \return         A pointer to the newly created multicollision, or NULL on memory allocation
+ *                 failure or invalid parameters
+ */
+hash_joux_t*
+hash_joux_create(enum hash_function_ids hash_id, unsigned int steps) {
+    if (!hash_joux_supports(hash_id) || steps == 0 || steps > BH_JOUX_MAX_STEPS) {
+        return NULL;
+    }
+
+    hash_joux_t* joux = calloc(1, sizeof(hash_joux_t));
+    if (!joux) {
+        return NULL;
+    }
+
+    const hash_config_t* hash = get_hash_config(hash_id);
+    joux->hash_id = hash_id;
+    joux->state_bits = hash->bits;
+    joux->steps = steps;
+    joux->slots = calloc((size_t)1 << joux->state_bits, sizeof(gint));
+    if (!joux->slots) {
+        free(joux);
+        return NULL;
+    }
+
+    joux->toy_update = hash->toy_update;
+    joux->states[0] = hash->toy_iv;
+    return joux;
+}
+
+/**
+ * \brief          Compress one block from a state, the toy hash continued on the block bytes
+ *
+ * \param[in]      joux The multicollision
+ * \param[in]      state The state before the block
+ * \param[in]      block The block
+ * \return         The state after the block
+ */
+uint32_t
+hash_joux_compress(const hash_joux_t* joux, uint32_t state, uint32_t block) {
+    uint8_t bytes[BH_JOUX_BLOCK_BYTES];
+    hash_joux_block_bytes(block, bytes);
+    return joux->toy_update(state, bytes, sizeof(bytes));
+}
+
+/**
+ * \brief          Get the candidate blocks a step searches at most. One more block than
+ *                 there are states always gives a collision.
+ *
+ * \param[in]      joux The multicollision
+ * \return         The number of candidates
+ */
+unsigned int
+hash_joux_candidates(const hash_joux_t* joux) {
+    return (1u << joux->state_bits) + 1;
+}
+
+/**
+ * \brief          Write a block as its bytes, little endian
+ *
+ * \param[in]      block The block
+ * \param[out]     bytes Receives BH_JOUX_BLOCK_BYTES bytes
+ */
+void
+hash_joux_block_bytes(uint32_t block, uint8_t* bytes) {
+    for (unsigned int i = 0; i < BH_JOUX_BLOCK_BYTES; i++) {
+        bytes[i] = (uint8_t)(block >> (8 * i));
+    }
+}
+
+/**
+ * \brief          Get the block of a candidate of a step. The candidate is multiplied by an
+ *                 odd constant, so the candidates of one step stay distinct but differ in all
+ *                 the bytes of the block: the CRC-like toy hash is linear in its last bytes
+ *                 and would map consecutive numbers to distinct states. The constant of the
+ *                 step makes every step try other blocks.
+ *
+ * \param[in]      step The step
+ * \param[in]      candidate The candidate number
+ * \return         The block
+ */
+uint32_t
+hash_joux_candidate_block(unsigned int step, uint32_t candidate) {
+    return (candidate * UINT32_C(0x9E3779B1)) ^ (uint32_t)((step + 1) * UINT32_C(0x7FEB352D));
+}
+
+/**
+ * \brief          Build one of the 2^steps messages: bit i of the choice picks the block of
+ *                 step i, the lowest bit the first block
+ *
+ * \param[in]      joux The finished multicollision
+ * \param[in]      choice The message number
+ * \param[out]     message Receives steps * BH_JOUX_BLOCK_BYTES bytes
+ * \return         The length of the message in bytes
+ */
+size_t
+hash_joux_message(const hash_joux_t* joux, uint64_t choice, uint8_t* message) {
+    for (unsigned int i = 0; i < joux->steps; i++) {
+        hash_joux_block_bytes(joux->blocks[i][(choice >> i) & 1],
+                              message + i * BH_JOUX_BLOCK_BYTES);
+    }
+    return (size_t)joux->steps * BH_JOUX_BLOCK_BYTES;
+}
+
+/**
+ * \brief          Move to the next step once the collision of the current one is found: the
+ *                 state after the colliding blocks starts the next step, and the table of
+ *                 states is emptied. Only call it once every worker of the step is done.
+ *
+ * \param[in]      joux The multicollision
+ */
+void
+hash_joux_next_step(hash_joux_t* joux) {
+    unsigned int step = (unsigned int)joux->step;
+    joux->states[step + 1] = hash_joux_compress(joux, joux->states[step], joux->blocks[step][0]);
+
+    memset(joux->slots, 0, ((size_t)1 << joux->state_bits) * sizeof(gint));
+    g_atomic_int_set(&joux->next_candidate, 0);
+    g_atomic_int_set(&joux->step_found, 0);
+    g_atomic_int_set(&joux->step, (gint)step + 1);
+}
+
+/**
+ * \brief          Destroy the multicollision with its table of states
+ *
+ * \param[in]      joux The multicollision to destroy, NULL is ignored
+ */
+void
+hash_joux_destroy(hash_joux_t* joux) {
+    if (!joux) {
+        return;
+    }
+
+    free(joux->slots);
+    free(joux);
+}
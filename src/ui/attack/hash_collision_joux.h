@@ -0,0 +1,75 @@
+/**
+ * \file            hash_collision_joux.h
+ * \brief           Header file for hash_collision_joux.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_COLLISION_JOUX_H
+#define HASH_COLLISION_JOUX_H
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_config.h"
+
+#include "../../utils/hash_function.h"
+
+/**
+ * \brief          The most single-block collisions a multicollision chains, 2^63 messages
+ */
+#define BH_JOUX_MAX_STEPS 63
+
+/**
+ * \brief          The bytes of one block, the candidates of a step are numbered and the
+ *                 number is the block
+ */
+#define BH_JOUX_BLOCK_BYTES 4
+
+/**
+ * \brief          The candidate blocks a worker takes at once from the counter of a step
+ */
+#define BH_JOUX_CHUNK_SIZE 256
+
+/**
+ * \brief          A Joux multicollision of an iterated toy hash: steps single-block
+ *                 collisions chained from the initial state. Any choice of one block of each
+ *                 pair gives the same final state, so 2^steps messages share one digest. Each
+ *                 step only compresses its candidate blocks from the state the previous step
+ *                 reached, no prefix is hashed again.
+ */
+typedef struct {
+    enum hash_function_ids hash_id; ///< The toy hash function, 8, 12 or 16 bits
+    unsigned int state_bits;        ///< The bits of the state, the digest is the state
+    hash_toy_update_fn toy_update;  ///< The update of the toy hash, from its registry entry
+    unsigned int steps;             ///< The single-block collisions to chain
+    int step;                       ///< The step being searched, steps once done, atomic
+    uint32_t states[BH_JOUX_MAX_STEPS + 1]; ///< The state before every step and the digest
+    uint32_t blocks[BH_JOUX_MAX_STEPS][2];  ///< The two colliding blocks of every step
+    int step_hashes[BH_JOUX_MAX_STEPS];     ///< The blocks compressed by every step, atomic
+    gint64 step_finished_at[BH_JOUX_MAX_STEPS]; ///< Monotonic time every step finished
+    gint* slots;                    ///< The candidate + 1 that reached every state, 0 for none
+    int next_candidate;             ///< The next candidate block of the step to take, atomic
+    int step_found;                 ///< Set once the step has its collision, atomic
+    unsigned int verified;          ///< The messages hashed again in full that gave the digest
+    unsigned int checked;           ///< The messages hashed again in full
+} hash_joux_t;
+
+bool hash_joux_supports(enum hash_function_ids hash_id);
+hash_joux_t* hash_joux_create(enum hash_function_ids hash_id, unsigned int steps);
+uint32_t hash_joux_compress(const hash_joux_t* joux, uint32_t state, uint32_t block);
+unsigned int hash_joux_candidates(const hash_joux_t* joux);
+void hash_joux_block_bytes(uint32_t block, uint8_t* bytes);
+uint32_t hash_joux_candidate_block(unsigned int step, uint32_t candidate);
+size_t hash_joux_message(const hash_joux_t* joux, uint64_t choice, uint8_t* message);
+void hash_joux_next_step(hash_joux_t* joux);
+void hash_joux_destroy(hash_joux_t* joux);
+
+#endif
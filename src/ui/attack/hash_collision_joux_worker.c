@@ -0,0 +1,146 @@
+/**
+ * \file            hash_collision_joux_worker.c
+ * \brief           The worker of the multicollision page, which searches the collision of one
+ *                  step of the chain
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_joux_worker.h"
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Hash again in full some of the 2^steps messages of a finished
+ *                 multicollision, the first, the last and a few picked from the run seed, and
+ *                 count those whose digest is the final state
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      worker_id The id of the worker that finished the last step
+ */
+static void
+joux_verify_messages(hash_collision_context_t* ctx, unsigned int worker_id) {
+    hash_joux_t* joux = ctx->joux;
+    uint8_t message[BH_JOUX_MAX_STEPS * BH_JOUX_BLOCK_BYTES];
+    uint64_t all = (UINT64_C(1) << joux->steps) - 1;
+    char* inputs[2] = {NULL, NULL};
+
+    for (unsigned int i = 0; i < 8; i++) {
+        uint64_t choice = i == 0   ? 0
+                          : i == 1 ? all
+                                   : ((i * UINT64_C(0x9E3779B97F4A7C15)) ^ ctx->run_seed) & all;
+        size_t len = hash_joux_message(joux, choice, message);
+
+        char hash_hex[BH_HASH_MAX_HEX];
+        if (!compute_hash(joux->hash_id, message, len, hash_hex)) {
+            free(inputs[0]);
+            free(inputs[1]);
+            REGISTER_ERROR_FUNC(ctx, worker_id, ERROR_HASH_COMPUTATION,
+                                "Hash function returned invalid result");
+            return;
+        }
+
+        joux->checked++;
+        if (strtoul(hash_hex, NULL, 16) == joux->states[joux->steps]) {
+            joux->verified++;
+        }
+
+        // The first and the last message are shown as the collision
+        if (i < 2) {
+            inputs[i] = bytes_to_hex(message, len, true);
+        }
+    }
+
+    g_mutex_lock(ctx->result_mutex);
+    hash_collision_simulation_result_t* result = ctx->result;
+    if (inputs[0] && inputs[1]) {
+        free(result->collision_input_1);
+        free(result->collision_input_2);
+        result->collision_input_1 = inputs[0];
+        result->collision_input_2 = inputs[1];
+        result->collision_found = joux->verified == joux->checked;
+    } else {
+        free(inputs[0]);
+        free(inputs[1]);
+        REGISTER_ERROR_FUNC(ctx, worker_id, ERROR_MEMORY_ALLOCATION,
+                            "Input hex string allocation failed");
+    }
+    g_mutex_unlock(ctx->result_mutex);
+}
+
+/**************************************************************
+                      EXTERNAL FUNCTIONS
+**************************************************************/
+
+/**
+ * \brief          Run a worker of a multicollision. Every step is one pass: the workers take
+ *                 chunks of candidate blocks, compress each from the state the previous step
+ *                 reached, and claim the state it reaches in the table of states. The first
+ *                 candidate that finds its state taken gives the collision of the step. The
+ *                 last worker of a step moves to the next one and submits its workers, which
+ *                 are counted in remaining_workers before it leaves.
+ *
+ * \param[in]      worker The data of this worker
+ */
+void
+hash_collision_joux_worker(WorkerData* worker) {
+    hash_collision_context_t* ctx = worker->ctx;
+    hash_joux_t* joux = ctx->joux;
+    unsigned int step = (unsigned int)g_atomic_int_get(&joux->step);
+    uint32_t state = joux->states[step];
+    unsigned int candidates = hash_joux_candidates(joux);
+
+    while (!g_atomic_int_get((gint*)&ctx->cancel) && !g_atomic_int_get(&joux->step_found)) {
+        unsigned int first =
+            (unsigned int)g_atomic_int_add(&joux->next_candidate, BH_JOUX_CHUNK_SIZE);
+        if (first >= candidates) {
+            break;
+        }
+
+        unsigned int last = first + BH_JOUX_CHUNK_SIZE < candidates ? first + BH_JOUX_CHUNK_SIZE
+                                                                    : candidates;
+        unsigned int candidate = first;
+        while (candidate < last) {
+            uint32_t block = hash_joux_candidate_block(step, candidate);
+            gint* slot = &joux->slots[hash_joux_compress(joux, state, block)];
+            candidate++;
+            if (g_atomic_int_compare_and_exchange(slot, 0, (gint)candidate)) {
+                continue;
+            }
+
+            // Another candidate reached the state first, only the first collision is kept
+            if (g_atomic_int_compare_and_exchange(&joux->step_found, 0, 1)) {
+                joux->blocks[step][0] =
+                    hash_joux_candidate_block(step, (uint32_t)g_atomic_int_get(slot) - 1);
+                joux->blocks[step][1] = block;
+            }
+            break;
+        }
+
+        g_atomic_int_add(&joux->step_hashes[step], (gint)(candidate - first));
+        g_atomic_int_add((gint*)&ctx->result->attempts_made, (gint)(candidate - first));
+    }
+
+    if (!g_atomic_int_dec_and_test((gint*)&ctx->pass_one_pending)) {
+        return;
+    }
+
+    joux->step_finished_at[step] = g_get_monotonic_time();
+    if (!g_atomic_int_get(&joux->step_found) || g_atomic_int_get((gint*)&ctx->cancel)
+        || ctx->error_info->has_error) {
+        return;
+    }
+
+    hash_joux_next_step(joux);
+    if (step + 1 < joux->steps) {
+        hash_collision_submit_workers(ctx, HASH_PASS_JOUX);
+    } else {
+        joux_verify_messages(ctx, worker->worker_id);
+    }
+}
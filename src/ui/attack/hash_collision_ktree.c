@@ -0,0 +1,372 @@
+/**
+ * \file            hash_collision_ktree.c
+ * \brief           The lists of Wagner's generalized birthday algorithm, the k-tree. Every
+ *                  join sorts its two lists on the bits it cancels with an LSD radix sort,
+ *                  then merges them and keeps the XOR of every pair that agrees on those bits.
+ *                  With k lists of 2^l entries, each join but the last cancels l bits and the
+ *                  last one cancels the 2l bits left, so k * 2^(n / (log2 k + 1)) digests give
+ *                  a solution for n bits, well below the 2^(n/2) of a birthday collision.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_ktree.h"
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Get the number of levels of joins of k lists
+ *
+ * \param[in]      k The number of lists
+ * \return         log2 of k
+ */
+static unsigned int
+hash_ktree_levels(unsigned int k) {
+    unsigned int levels = 0;
+    while ((1u << levels) < k) {
+        levels++;
+    }
+    return levels;
+}
+
+/**
+ * \brief          Get the bits every join but the last cancels: the digest bits divided over
+ *                 the levels, with the last join taking two shares
+ *
+ * \param[in]      k The number of lists
+ * \param[in]      bits The leading digest bits that must XOR to zero
+ * \return         The bits l
+ */
+static unsigned int
+hash_ktree_level_bits(unsigned int k, unsigned int bits) {
+    unsigned int shares = hash_ktree_levels(k) + 1;
+    return (bits + shares - 1) / shares;
+}
+
+/**
+ * \brief          Get the key an entry is sorted and merged on by a join
+ *
+ * \param[in]      entry The entry
+ * \param[in]      shift The bits already cancelled below the key
+ * \param[in]      key_mask The mask of the key bits
+ * \return         The key
+ */
+static inline uint64_t
+hash_ktree_key(const hash_ktree_entry_t* entry, unsigned int shift, uint64_t key_mask) {
+    return (entry->value >> shift) & key_mask;
+}
+
+/**
+ * \brief          Sort a list on its key with an LSD radix sort of 8 bits a pass. The order
+ *                 of entries with the same key is kept.
+ *
+ * \param[in]      list The list to sort
+ * \param[in]      shift The bits already cancelled below the key
+ * \param[in]      key_bits The bits of the key
+ * \param[in]      scratch Space for the entries of the list
+ */
+static void
+hash_ktree_sort(hash_ktree_list_t* list, unsigned int shift, unsigned int key_bits,
+                hash_ktree_entry_t* scratch) {
+    hash_ktree_entry_t* from = list->entries;
+    hash_ktree_entry_t* to = scratch;
+    uint64_t key_mask = key_bits >= 64 ? UINT64_MAX : (UINT64_C(1) << key_bits) - 1;
+
+    // The last digit is masked to the key, the bits above it would split the runs of a key
+    for (unsigned int digit = 0; digit < key_bits; digit += 8) {
+        size_t counts[257] = {0};
+        for (size_t i = 0; i < list->count; i++) {
+            counts[((hash_ktree_key(&from[i], shift, key_mask) >> digit) & 0xFF) + 1]++;
+        }
+        for (unsigned int d = 0; d < 256; d++) {
+            counts[d + 1] += counts[d];
+        }
+        for (size_t i = 0; i < list->count; i++) {
+            to[counts[(hash_ktree_key(&from[i], shift, key_mask) >> digit) & 0xFF]++] = from[i];
+        }
+
+        hash_ktree_entry_t* swap = from;
+        from = to;
+        to = swap;
+    }
+
+    if (from != list->entries) {
+        memcpy(list->entries, from, list->count * sizeof(hash_ktree_entry_t));
+    }
+}
+
+/**
+ * \brief          Collect the input index of every list below an entry
+ *
+ * \param[in]      tree The k-tree
+ * \param[in]      level The level of the entry
+ * \param[in]      list_index The list of the entry within its level
+ * \param[in]      position The position of the entry in its list
+ * \param[out]     leaves Receives the input index of every list
+ */
+static void
+hash_ktree_trace_entry(const hash_ktree_t* tree, unsigned int level, unsigned int list_index,
+                       uint32_t position, uint32_t* leaves) {
+    const hash_ktree_entry_t* entry = &tree->lists[level][list_index].entries[position];
+    if (level == 0) {
+        leaves[list_index] = entry->left;
+        return;
+    }
+
+    hash_ktree_trace_entry(tree, level - 1, 2 * list_index, entry->left, leaves);
+    hash_ktree_trace_entry(tree, level - 1, 2 * list_index + 1, entry->right, leaves);
+}
+
+/****************************************************************
+                       EXTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Get the entries of every list of a k-tree
+ *
+ * \param[in]      k The number of lists, 4, 8 or 16
+ * \param[in]      bits The leading digest bits that must XOR to zero
+ * \return         The entries, BH_KTREE_LIST_FACTOR * 2^l
+ */
+size_t
+hash_ktree_list_size(unsigned int k, unsigned int bits) {
+    return (size_t)BH_KTREE_LIST_FACTOR << hash_ktree_level_bits(k, bits);
+}
+
+/**
+ * \brief          Predict the memory of a k-tree: the lists of every level below the last
+ *                 join, and the sort scratch of the joins of the second level running at once
+ *
+ * \param[in]      k The number of lists, 4, 8 or 16
+ * \param[in]      bits The leading digest bits that must XOR to zero
+ * \return         The predicted bytes
+ */
+size_t
+hash_ktree_estimate_bytes(unsigned int k, unsigned int bits) {
+    size_t list_bytes = hash_ktree_list_size(k, bits) * sizeof(hash_ktree_entry_t);
+    size_t lists = 0;
+    for (unsigned int level = 0; level < hash_ktree_levels(k); level++) {
+        lists += k >> level;
+    }
+    return (lists + k / 2) * list_bytes;
+}
+
+/**
+ * \brief          Create a k-tree with every list of the levels below the last join
+ *                 allocated. You should free the returned tree using `hash_ktree_destroy`
+ *                 when done.
+ *
+ * \param[in]      hash_id The hash function of every list
+ * \param[in]      k The number of lists, 4, 8 or 16
+ * \param[in]      bits The leading digest bits that must XOR to zero, at least 2 * (log2 k + 1)
+ *                 so the last join has bits left, and at most BH_KTREE_MAX_BITS and the
+ *                 output bits of the hash function
+ * \return         A pointer to the newly created tree, or NULL on memory allocation failure
+ *                 or invalid parameters
+ */
+hash_ktree_t*
+hash_ktree_create(enum hash_function_ids hash_id, unsigned int k, unsigned int bits) {
+    unsigned int levels = hash_ktree_levels(k);
+    if ((k != 4 && k != 8 && k != 16) || bits < 2 * (levels + 1) || bits > BH_KTREE_MAX_BITS
+        || bits > get_hash_config_item(hash_id).bits) {
+        return NULL;
+    }
+
+    size_t list_size = hash_ktree_list_size(k, bits);
+    if (list_size > UINT32_MAX) {
+        return NULL;
+    }
+
+    hash_ktree_t* tree = calloc(1, sizeof(hash_ktree_t));
+    if (!tree) {
+        return NULL;
+    }
+
+    tree->hash_id = hash_id;
+    tree->k = k;
+    tree->levels = levels;
+    tree->bits = bits;
+    tree->level_bits = hash_ktree_level_bits(k, bits);
+    tree->list_size = list_size;
+
+    for (unsigned int level = 0; level < levels; level++) {
+        unsigned int count = k >> level;
+        tree->lists[level] = calloc(count, sizeof(hash_ktree_list_t));
+        if (!tree->lists[level]) {
+            hash_ktree_destroy(tree);
+            return NULL;
+        }
+
+        for (unsigned int i = 0; i < count; i++) {
+            hash_ktree_list_t* list = &tree->lists[level][i];
+            list->entries = malloc(list_size * sizeof(hash_ktree_entry_t));
+            if (!list->entries) {
+                hash_ktree_destroy(tree);
+                return NULL;
+            }
+            list->capacity = list_size;
+        }
+    }
+    return tree;
+}
+
+/**
+ * \brief          Get the number of jobs of a level, hashing chunks of a list on the first
+ *                 level and one join per list on the others
+ *
+ * \param[in]      tree The k-tree
+ * \param[in]      level The level, 0 to levels
+ * \return         The number of jobs
+ */
+unsigned int
+hash_ktree_level_jobs(const hash_ktree_t* tree, unsigned int level) {
+    if (level == 0) {
+        return tree->k * ((tree->list_size + BH_KTREE_CHUNK_SIZE - 1) / BH_KTREE_CHUNK_SIZE);
+    }
+    return tree->k >> level;
+}
+
+/**
+ * \brief          Get the bits cancelled below the key of a join
+ *
+ * \param[in]      tree The k-tree
+ * \param[in]      level The level the join builds, 1 to levels
+ * \return         The shift of the key
+ */
+unsigned int
+hash_ktree_join_shift(const hash_ktree_t* tree, unsigned int level) {
+    return (level - 1) * tree->level_bits;
+}
+
+/**
+ * \brief          Join two lists of the level below into one list of the given level. The
+ *                 two lists are sorted on the bits the join cancels, then merged, and every
+ *                 pair that agrees on those bits gives an entry until the list is full. The
+ *                 last join cancels every bit left and only counts its solutions.
+ *
+ * \param[in]      tree The k-tree
+ * \param[in]      level The level the join builds, 1 to levels
+ * \param[in]      index The list the join builds within its level
+ * \param[out]     root_left Last join only, receives the left position of the first solution
+ * \param[out]     root_right Last join only, receives the right position of the first
+ *                 solution
+ * \param[out]     solutions Last join only, receives the number of solutions
+ * \return         false on memory allocation failure, true otherwise
+ */
+bool
+hash_ktree_join(hash_ktree_t* tree, unsigned int level, unsigned int index,
+                uint32_t* root_left, uint32_t* root_right, guint64* solutions) {
+    hash_ktree_list_t* a = &tree->lists[level - 1][2 * index];
+    hash_ktree_list_t* b = &tree->lists[level - 1][2 * index + 1];
+    bool is_root = level == tree->levels;
+    hash_ktree_list_t* out = is_root ? NULL : &tree->lists[level][index];
+
+    unsigned int shift = hash_ktree_join_shift(tree, level);
+    unsigned int key_bits = is_root ? tree->bits - shift : tree->level_bits;
+    uint64_t key_mask = key_bits >= 64 ? UINT64_MAX : (UINT64_C(1) << key_bits) - 1;
+
+    hash_ktree_entry_t* scratch =
+        malloc(((a->count > b->count ? a->count : b->count) + 1) * sizeof(hash_ktree_entry_t));
+    if (!scratch) {
+        return false;
+    }
+    hash_ktree_sort(a, shift, key_bits, scratch);
+    hash_ktree_sort(b, shift, key_bits, scratch);
+    free(scratch);
+
+    if (out) {
+        out->count = 0;
+    }
+    guint64 found = 0;
+
+    size_t i = 0, j = 0;
+    while (i < a->count && j < b->count) {
+        uint64_t key_a = hash_ktree_key(&a->entries[i], shift, key_mask);
+        uint64_t key_b = hash_ktree_key(&b->entries[j], shift, key_mask);
+        if (key_a < key_b) {
+            i++;
+            continue;
+        }
+        if (key_b < key_a) {
+            j++;
+            continue;
+        }
+
+        // Every pair of the two runs with this key agrees on the cancelled bits
+        size_t a_end = i, b_end = j;
+        while (a_end < a->count && hash_ktree_key(&a->entries[a_end], shift, key_mask) == key_a) {
+            a_end++;
+        }
+        while (b_end < b->count && hash_ktree_key(&b->entries[b_end], shift, key_mask) == key_a) {
+            b_end++;
+        }
+
+        for (size_t x = i; x < a_end; x++) {
+            for (size_t y = j; y < b_end; y++) {
+                if (is_root) {
+                    if (found == 0) {
+                        *root_left = (uint32_t)x;
+                        *root_right = (uint32_t)y;
+                    }
+                    found++;
+                } else if (out->count < out->capacity) {
+                    hash_ktree_entry_t* entry = &out->entries[out->count++];
+                    entry->value = a->entries[x].value ^ b->entries[y].value;
+                    entry->left = (uint32_t)x;
+                    entry->right = (uint32_t)y;
+                }
+            }
+        }
+        i = a_end;
+        j = b_end;
+    }
+
+    if (is_root) {
+        *solutions = found;
+    }
+    return true;
+}
+
+/**
+ * \brief          Collect the input index of every list of a solution of the last join
+ *
+ * \param[in]      tree The k-tree
+ * \param[in]      root_left The left position of the solution
+ * \param[in]      root_right The right position of the solution
+ * \param[out]     leaves Receives the input index of every list, k of them
+ */
+void
+hash_ktree_trace(const hash_ktree_t* tree, uint32_t root_left, uint32_t root_right,
+                 uint32_t* leaves) {
+    hash_ktree_trace_entry(tree, tree->levels - 1, 0, root_left, leaves);
+    hash_ktree_trace_entry(tree, tree->levels - 1, 1, root_right, leaves);
+}
+
+/**
+ * \brief          Destroy the k-tree with its lists and the inputs of its solution
+ *
+ * \param[in]      tree The tree to destroy, NULL is ignored
+ */
+void
+hash_ktree_destroy(hash_ktree_t* tree) {
+    if (!tree) {
+        return;
+    }
+
+    for (unsigned int level = 0; level < tree->levels; level++) {
+        for (unsigned int i = 0; tree->lists[level] && i < (tree->k >> level); i++) {
+            free(tree->lists[level][i].entries);
+        }
+        free(tree->lists[level]);
+    }
+    for (unsigned int i = 0; i < BH_KTREE_MAX_K; i++) {
+        free(tree->input_hex[i]);
+    }
+    free(tree);
+}
@@ -0,0 +1,107 @@
+/**
+ * \file            hash_collision_ktree.h
+ * \brief           Header file for hash_collision_ktree.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_COLLISION_KTREE_H
+#define HASH_COLLISION_KTREE_H
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_config.h"
+
+/**
+ * \brief          The most lists of a k-tree, 16 lists take 4 levels of joins
+ */
+#define BH_KTREE_MAX_K      16
+
+/**
+ * \brief          The most levels of joins of a k-tree, log2 of BH_KTREE_MAX_K
+ */
+#define BH_KTREE_MAX_LEVELS 4
+
+/**
+ * \brief          The most digest bits a k-tree cancels, the digests are read into 64 bits
+ */
+#define BH_KTREE_MAX_BITS   64
+
+/**
+ * \brief          The inputs of a list a worker hashes as one job of the first level
+ */
+#define BH_KTREE_CHUNK_SIZE 4096
+
+/**
+ * \brief          Every list holds twice the 2^l entries the k-tree needs on average, so the
+ *                 last join expects 4 solutions instead of 1. The joins keep at most that many
+ *                 entries, so the lists keep their size at every level.
+ */
+#define BH_KTREE_LIST_FACTOR 2
+
+/**
+ * \brief          One entry of a list: the XOR of the truncated digests below it, with the
+ *                 position of its two children in the lists of the level below. An entry of
+ *                 the first level is one digest, left is the index of its input.
+ */
+typedef struct {
+    uint64_t value; ///< The XOR of the truncated digests, the bits already cancelled are zero
+    uint32_t left;  ///< The position of the left child, or the input index on the first level
+    uint32_t right; ///< The position of the right child, unused on the first level
+} hash_ktree_entry_t;
+
+/**
+ * \brief          A list of a level of the k-tree
+ */
+typedef struct {
+    hash_ktree_entry_t* entries; ///< The entries, capacity of them are allocated
+    size_t count;                ///< The entries in use
+    size_t capacity;             ///< The entries allocated
+} hash_ktree_list_t;
+
+/**
+ * \brief          A run of Wagner's k-tree algorithm: k lists of truncated digests, joined
+ *                 in pairs level by level on the next l bits until the last join matches
+ *                 every bit left, which gives k inputs whose truncated digests XOR to zero.
+ */
+typedef struct {
+    enum hash_function_ids hash_id;  ///< The hash function of every list
+    unsigned int k;                  ///< The number of lists, 4, 8 or 16
+    unsigned int levels;             ///< The levels of joins, log2 of k
+    unsigned int bits;               ///< The leading digest bits that must XOR to zero
+    unsigned int level_bits;         ///< The bits l every join but the last cancels
+    size_t list_size;                ///< The entries of every list
+    hash_ktree_list_t* lists[BH_KTREE_MAX_LEVELS]; ///< The lists of the levels below the last
+                                                   ///< join, k >> level of them
+    int level;                       ///< The level being built, 0 hashes the inputs
+    int next_job;                    ///< The next job of the level to take, atomic
+    guint64 solutions;               ///< The solutions of the last join
+    bool found;                      ///< Whether a solution was confirmed
+    uint32_t leaves[BH_KTREE_MAX_K]; ///< The input index of every list of the first solution
+    char* input_hex[BH_KTREE_MAX_K]; ///< The input of every list of the first solution in hex
+    char truncated[BH_KTREE_MAX_K][17]; ///< The compared bits of the digest of every input
+    gint64 level_finished_at[BH_KTREE_MAX_LEVELS + 1]; ///< Monotonic time each level finished
+    size_t level_entries[BH_KTREE_MAX_LEVELS + 1];     ///< The entries of each level
+} hash_ktree_t;
+
+size_t hash_ktree_list_size(unsigned int k, unsigned int bits);
+size_t hash_ktree_estimate_bytes(unsigned int k, unsigned int bits);
+hash_ktree_t* hash_ktree_create(enum hash_function_ids hash_id, unsigned int k,
+                                unsigned int bits);
+unsigned int hash_ktree_level_jobs(const hash_ktree_t* tree, unsigned int level);
+unsigned int hash_ktree_join_shift(const hash_ktree_t* tree, unsigned int level);
+bool hash_ktree_join(hash_ktree_t* tree, unsigned int level, unsigned int index,
+                     uint32_t* root_left, uint32_t* root_right, guint64* solutions);
+void hash_ktree_trace(const hash_ktree_t* tree, uint32_t root_left, uint32_t root_right,
+                      uint32_t* leaves);
+void hash_ktree_destroy(hash_ktree_t* tree);
+
+#endif
@@ -0,0 +1,191 @@
+/**
+ * \file            hash_collision_ktree_worker.c
+ * \brief           The worker of the k-tree page, which takes the jobs of the level being built
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_ktree_worker.h"
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Generate an input of a k-tree list from its index: the label of the list,
+ *                 'A' for the first, followed by the input generate_indexed_input makes for
+ *                 the index
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      list The list of the input
+ * \param[in]      index The index of the input within the list
+ * \param[out]     buffer Receives the input, at least 32 bytes
+ * \return         The length of the input in bytes
+ */
+static size_t
+ktree_generate_input(hash_collision_context_t* ctx, unsigned int list, guint32 index,
+                     uint8_t* buffer) {
+    buffer[0] = (uint8_t)('A' + list);
+    return 1 + generate_indexed_input(ctx->run_seed, list, index, buffer + 1, 4, 31);
+}
+
+/**
+ * \brief          Hash one chunk of a list of the first level into its entries, the compared
+ *                 digest bits as a number with the first digest bit highest
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      worker_id The id of the worker taking the job
+ * \param[in]      job The job of the first level, the chunks of the first list come first
+ * \return         false when a hash failed and the error is registered, true otherwise
+ */
+static bool
+ktree_hash_chunk(hash_collision_context_t* ctx, unsigned int worker_id, unsigned int job) {
+    hash_ktree_t* tree = ctx->ktree;
+    unsigned int chunks = hash_ktree_level_jobs(tree, 0) / tree->k;
+    unsigned int list = job / chunks;
+    size_t first = (size_t)(job % chunks) * BH_KTREE_CHUNK_SIZE;
+    size_t count = tree->list_size - first;
+    if (count > BH_KTREE_CHUNK_SIZE) {
+        count = BH_KTREE_CHUNK_SIZE;
+    }
+
+    hash_ktree_entry_t* entries = tree->lists[0][list].entries;
+    for (size_t i = first; i < first + count; i++) {
+        uint8_t input[32];
+        size_t input_len = ktree_generate_input(ctx, list, (guint32)i, input);
+        char hash_hex[BH_HASH_MAX_HEX];
+        if (!compute_hash(tree->hash_id, input, input_len, hash_hex)) {
+            REGISTER_ERROR_FUNC(ctx, worker_id, ERROR_HASH_COMPUTATION,
+                                "Hash function returned invalid result");
+            return false;
+        }
+
+        entries[i].value = hash_prefix_head(hash_hex) >> (BH_KTREE_MAX_BITS - tree->bits);
+        entries[i].left = (uint32_t)i;
+        entries[i].right = 0;
+    }
+
+    g_atomic_int_add((gint*)&ctx->result->attempts_made, (gint)count);
+    return true;
+}
+
+/**
+ * \brief          Confirm the first solution of the last join: trace the input of every list,
+ *                 then regenerate and hash every input and check that the compared bits of
+ *                 the digests XOR to zero
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      worker_id The id of the worker that made the last join
+ * \param[in]      root_left The left position of the solution
+ * \param[in]      root_right The right position of the solution
+ * \return         false when a hash or an allocation failed and the error is registered,
+ *                 true otherwise
+ */
+static bool
+ktree_confirm_solution(hash_collision_context_t* ctx, unsigned int worker_id,
+                       uint32_t root_left, uint32_t root_right) {
+    hash_ktree_t* tree = ctx->ktree;
+    hash_ktree_trace(tree, root_left, root_right, tree->leaves);
+
+    uint64_t sum = 0;
+    for (unsigned int list = 0; list < tree->k; list++) {
+        uint8_t input[32];
+        size_t input_len = ktree_generate_input(ctx, list, tree->leaves[list], input);
+        char hash_hex[BH_HASH_MAX_HEX];
+        if (!compute_hash(tree->hash_id, input, input_len, hash_hex)) {
+            REGISTER_ERROR_FUNC(ctx, worker_id, ERROR_HASH_COMPUTATION,
+                                "Hash function returned invalid result");
+            return false;
+        }
+
+        sum ^= hash_prefix_head(hash_hex) >> (BH_KTREE_MAX_BITS - tree->bits);
+        truncate_hex_digest(hash_hex, tree->bits, tree->truncated[list]);
+
+        tree->input_hex[list] = bytes_to_hex(input, input_len, true);
+        if (!tree->input_hex[list]) {
+            REGISTER_ERROR_FUNC(ctx, worker_id, ERROR_MEMORY_ALLOCATION,
+                                "Input hex string allocation failed");
+            return false;
+        }
+    }
+
+    tree->found = sum == 0;
+    g_mutex_lock(ctx->result_mutex);
+    ctx->result->collision_found = tree->found;
+    g_mutex_unlock(ctx->result_mutex);
+    return true;
+}
+
+/**************************************************************
+                      EXTERNAL FUNCTIONS
+**************************************************************/
+
+/**
+ * \brief          Run a worker of a k-tree. Every level is one pass: the workers take its
+ *                 jobs until none is left, hashing chunks of the lists on the first level and
+ *                 joining two lists on the others. The last worker of a level records when it
+ *                 finished and submits the workers of the next level, which are counted in
+ *                 remaining_workers before it leaves.
+ *
+ * \param[in]      worker The data of this worker
+ */
+void
+hash_collision_ktree_worker(WorkerData* worker) {
+    hash_collision_context_t* ctx = worker->ctx;
+    hash_ktree_t* tree = ctx->ktree;
+    unsigned int level = (unsigned int)g_atomic_int_get(&tree->level);
+    unsigned int jobs = hash_ktree_level_jobs(tree, level);
+
+    bool ok = true;
+    while (ok && !g_atomic_int_get((gint*)&ctx->cancel) && !ctx->error_info->has_error) {
+        unsigned int job = (unsigned int)g_atomic_int_add(&tree->next_job, 1);
+        if (job >= jobs) {
+            break;
+        }
+
+        if (level == 0) {
+            ok = ktree_hash_chunk(ctx, worker->worker_id, job);
+            continue;
+        }
+
+        // Only the last join fills these, it is the one job of its level
+        uint32_t root_left = 0, root_right = 0;
+        guint64 solutions = 0;
+        ok = hash_ktree_join(tree, level, job, &root_left, &root_right, &solutions);
+        if (!ok) {
+            REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_MEMORY_ALLOCATION,
+                                "K-tree sort scratch allocation failed");
+        } else if (level == tree->levels) {
+            tree->solutions = solutions;
+            if (solutions > 0) {
+                ok = ktree_confirm_solution(ctx, worker->worker_id, root_left, root_right);
+            }
+        }
+    }
+
+    if (!g_atomic_int_dec_and_test((gint*)&ctx->pass_one_pending)) {
+        return;
+    }
+
+    tree->level_finished_at[level] = g_get_monotonic_time();
+    if (level == tree->levels) {
+        tree->level_entries[level] = (size_t)tree->solutions;
+        return;
+    }
+
+    for (unsigned int i = 0; i < (tree->k >> level); i++) {
+        if (level == 0) {
+            tree->lists[0][i].count = tree->list_size;
+        }
+        tree->level_entries[level] += tree->lists[level][i].count;
+    }
+    if (!g_atomic_int_get((gint*)&ctx->cancel) && !ctx->error_info->has_error) {
+        g_atomic_int_set(&tree->next_job, 0);
+        g_atomic_int_set(&tree->level, (gint)level + 1);
+        hash_collision_submit_workers(ctx, HASH_PASS_KTREE);
+    }
+}
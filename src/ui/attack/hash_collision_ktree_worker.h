@@ -0,0 +1,19 @@
+/**
+ * \file            hash_collision_ktree_worker.h
+ * \brief           Header file for hash_collision_ktree_worker.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_COLLISION_KTREE_WORKER_H
+#define HASH_COLLISION_KTREE_WORKER_H
+
+#include "hash_collision_run.h"
+
+void hash_collision_ktree_worker(WorkerData* worker);
+
+#endif
@@ -0,0 +1,261 @@
+/**
+ * \file            hash_collision_near.c
+ * \brief           The digests of a near-collision search, with one chained index per
+ *                  substring. By the pigeonhole principle two digests that differ in at most d
+ *                  bits agree on at least one of d + 1 disjoint substrings, so looking a digest
+ *                  up in every substring index finds every digest within the distance without
+ *                  comparing all the pairs.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_near.h"
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Get the substring of a digest a substring index is keyed on
+ *
+ * \param[in]      search The near-collision search
+ * \param[in]      index The substring index
+ * \param[in]      value The compared bits of the digest
+ * \return         The substring
+ */
+static inline uint64_t
+hash_near_substring(const hash_near_search_t* search, unsigned int index, uint64_t value) {
+    unsigned int bits = search->index_bits[index];
+    uint64_t mask = bits >= 64 ? UINT64_MAX : (UINT64_C(1) << bits) - 1;
+    return (value >> search->index_shift[index]) & mask;
+}
+
+/**
+ * \brief          Get the bucket of a substring. The substring is mixed with a Fibonacci
+ *                 multiply, so a substring longer than the bucket bits spreads over them all.
+ *
+ * \param[in]      search The near-collision search
+ * \param[in]      substring The substring
+ * \return         The bucket
+ */
+static inline uint32_t
+hash_near_bucket(const hash_near_search_t* search, uint64_t substring) {
+    return (uint32_t)(((substring + 1) * UINT64_C(0x9E3779B97F4A7C15))
+                      >> (64 - search->bucket_bits));
+}
+
+/**
+ * \brief          Get the bucket bits of the substring indexes, one bucket per digest at
+ *                 most, so the chains stay short whenever the substrings allow it
+ *
+ * \param[in]      capacity The most digests to store
+ * \return         The bucket bits
+ */
+static unsigned int
+hash_near_bucket_bits(size_t capacity) {
+    unsigned int bucket_bits = 4;
+    while (bucket_bits < 31 && ((size_t)1 << bucket_bits) < capacity) {
+        bucket_bits++;
+    }
+    return bucket_bits;
+}
+
+/****************************************************************
+                       EXTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Create a near-collision search with its substring indexes. The compared bits
+ *                 are split into distance + 1 substrings as equal as they can be. You should
+ *                 free the returned search using `hash_near_search_destroy` when done.
+ *
+ * \param[in]      bits The leading digest bits compared, 1 to BH_NEAR_MAX_BITS
+ * \param[in]      distance The most bits two digests may differ in, below bits and at most
+ *                 BH_NEAR_MAX_DISTANCE
+ * \param[in]      capacity The most digests to store, at most BH_NEAR_NO_ENTRY
+ * \return         A pointer to the newly created search, or NULL on memory allocation failure
+ *                 or invalid parameters
+ */
+hash_near_search_t*
+hash_near_search_create(unsigned int bits, unsigned int distance, size_t capacity) {
+    if (bits == 0 || bits > BH_NEAR_MAX_BITS || distance >= bits
+        || distance > BH_NEAR_MAX_DISTANCE || capacity == 0 || capacity >= BH_NEAR_NO_ENTRY) {
+        return NULL;
+    }
+
+    hash_near_search_t* search = calloc(1, sizeof(hash_near_search_t));
+    if (!search) {
+        return NULL;
+    }
+
+    g_mutex_init(&search->mutex);
+    search->bits = bits;
+    search->distance = distance;
+    search->index_count = distance + 1;
+    search->capacity = capacity;
+
+    unsigned int shift = 0;
+    for (unsigned int i = 0; i < search->index_count; i++) {
+        search->index_shift[i] = shift;
+        search->index_bits[i] =
+            bits / search->index_count + (i < bits % search->index_count ? 1 : 0);
+        shift += search->index_bits[i];
+    }
+
+    search->bucket_bits = hash_near_bucket_bits(capacity);
+
+    search->values = malloc(capacity * sizeof(uint64_t));
+    search->payloads = malloc(capacity * sizeof(uint64_t));
+    if (!search->values || !search->payloads) {
+        hash_near_search_destroy(search);
+        return NULL;
+    }
+
+    size_t buckets = (size_t)1 << search->bucket_bits;
+    for (unsigned int i = 0; i < search->index_count; i++) {
+        search->heads[i] = malloc(buckets * sizeof(uint32_t));
+        search->next[i] = malloc(capacity * sizeof(uint32_t));
+        if (!search->heads[i] || !search->next[i]) {
+            hash_near_search_destroy(search);
+            return NULL;
+        }
+        memset(search->heads[i], 0xFF, buckets * sizeof(uint32_t));
+    }
+    return search;
+}
+
+/**
+ * \brief          Get the number of bits two compared digests differ in
+ *
+ * \param[in]      a The compared bits of the first digest
+ * \param[in]      b The compared bits of the second digest
+ * \return         The Hamming distance
+ */
+unsigned int
+hash_near_distance(uint64_t a, uint64_t b) {
+    return (unsigned int)__builtin_popcountll(a ^ b);
+}
+
+/**
+ * \brief          Look a digest up in every substring index, then store it. Only the digests
+ *                 of a bucket that share the substring are compared. Call it with the mutex
+ *                 of the search held.
+ *
+ * \param[in]      search The near-collision search
+ * \param[in]      value The compared bits of the digest
+ * \param[in]      payload The worker and index of the input of the digest
+ * \param[out]     match_value Receives the compared bits of the digest within the distance
+ * \param[out]     match_payload Receives the payload of the digest within the distance
+ * \return         true if a stored digest is within the distance, the digest is not stored
+ *                 then. false otherwise, the digest is stored unless the search is full.
+ */
+bool
+hash_near_search_add(hash_near_search_t* search, uint64_t value, uint64_t payload,
+                     uint64_t* match_value, uint64_t* match_payload) {
+    uint32_t buckets[BH_NEAR_MAX_INDEXES];
+    for (unsigned int i = 0; i < search->index_count; i++) {
+        uint64_t substring = hash_near_substring(search, i, value);
+        buckets[i] = hash_near_bucket(search, substring);
+
+        for (uint32_t entry = search->heads[i][buckets[i]]; entry != BH_NEAR_NO_ENTRY;
+             entry = search->next[i][entry]) {
+            uint64_t stored = search->values[entry];
+            if (hash_near_substring(search, i, stored) != substring) {
+                continue;
+            }
+
+            search->candidates++;
+            if (hash_near_distance(stored, value) <= search->distance) {
+                *match_value = stored;
+                *match_payload = search->payloads[entry];
+                return true;
+            }
+        }
+    }
+
+    if (search->count == search->capacity) {
+        return false;
+    }
+
+    uint32_t entry = (uint32_t)search->count++;
+    search->values[entry] = value;
+    search->payloads[entry] = payload;
+    for (unsigned int i = 0; i < search->index_count; i++) {
+        search->next[i][entry] = search->heads[i][buckets[i]];
+        search->heads[i][buckets[i]] = entry;
+    }
+    return false;
+}
+
+/**
+ * \brief          Get the number of digests expected before two of them are within the
+ *                 distance: a birthday bound over the chance p that a pair is, sqrt(pi / 2 / p)
+ *
+ * \param[in]      bits The leading digest bits compared
+ * \param[in]      distance The most bits two digests may differ in
+ * \return         The expected number of digests
+ */
+double
+hash_near_expected_inputs(unsigned int bits, unsigned int distance) {
+    double pairs_within = 0.0;
+    double choose = 1.0;
+    for (unsigned int i = 0; i <= distance && i <= bits; i++) {
+        pairs_within += choose;
+        choose = choose * (bits - i) / (i + 1);
+    }
+    return 1.2533141373155003 * sqrt(ldexp(1.0, (int)bits) / pairs_within);
+}
+
+/**
+ * \brief          Predict the memory of a near-collision search: the digests with their
+ *                 payloads, and the buckets and chains of every substring index
+ *
+ * \param[in]      distance The most bits two digests may differ in
+ * \param[in]      capacity The most digests to store
+ * \return         The predicted bytes
+ */
+size_t
+hash_near_estimate_bytes(unsigned int distance, size_t capacity) {
+    size_t buckets = (size_t)1 << hash_near_bucket_bits(capacity);
+    size_t per_index = buckets * sizeof(uint32_t) + capacity * sizeof(uint32_t);
+    return capacity * 2 * sizeof(uint64_t) + (distance + 1) * per_index;
+}
+
+/**
+ * \brief          Get the number of bytes used by the digests and the substring indexes
+ *
+ * \param[in]      search The search to measure
+ * \return         The size in bytes, 0 if search is NULL
+ */
+size_t
+hash_near_search_memory_size(const hash_near_search_t* search) {
+    if (!search) {
+        return 0;
+    }
+    return hash_near_estimate_bytes(search->distance, search->capacity);
+}
+
+/**
+ * \brief          Destroy the search with its digests and indexes
+ *
+ * \param[in]      search The search to destroy, NULL is ignored
+ */
+void
+hash_near_search_destroy(hash_near_search_t* search) {
+    if (!search) {
+        return;
+    }
+
+    for (unsigned int i = 0; i < search->index_count; i++) {
+        free(search->heads[i]);
+        free(search->next[i]);
+    }
+    free(search->values);
+    free(search->payloads);
+    g_mutex_clear(&search->mutex);
+    free(search);
+}
@@ -0,0 +1,82 @@
+/**
+ * \file            hash_collision_near.h
+ * \brief           Header file for hash_collision_near.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_COLLISION_NEAR_H
+#define HASH_COLLISION_NEAR_H
+
+#include <glib.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * \brief          The most leading digest bits a near-collision search compares, the digests
+ *                 are read into 64 bits
+ */
+#define BH_NEAR_MAX_BITS 64
+
+/**
+ * \brief          The most bits two digests of a near-collision may differ in
+ */
+#define BH_NEAR_MAX_DISTANCE 15
+
+/**
+ * \brief          The most substring indexes, one more than the distance: two digests that
+ *                 differ in at most d bits agree on at least one of d + 1 substrings
+ */
+#define BH_NEAR_MAX_INDEXES (BH_NEAR_MAX_DISTANCE + 1)
+
+/**
+ * \brief          Marks the end of a bucket chain of a substring index
+ */
+#define BH_NEAR_NO_ENTRY UINT32_MAX
+
+/**
+ * \brief          A near-collision search with multi-index hashing: two inputs whose digests
+ *                 differ in at most distance of their leading bits. The compared bits are
+ *                 split into distance + 1 substrings, each with its own chained index, so a
+ *                 digest is only compared with the digests that share a substring with it.
+ *                 The search is read and written under its mutex.
+ */
+typedef struct {
+    unsigned int bits;          ///< The leading digest bits compared
+    unsigned int distance;      ///< The most bits two digests may differ in
+    unsigned int index_count;   ///< The number of substrings, distance + 1
+    unsigned int index_shift[BH_NEAR_MAX_INDEXES]; ///< The lowest bit of every substring
+    unsigned int index_bits[BH_NEAR_MAX_INDEXES];  ///< The bits of every substring
+    unsigned int bucket_bits;   ///< Every index has 2^bucket_bits buckets
+    size_t capacity;            ///< The most digests stored
+    size_t count;               ///< The digests stored
+    uint64_t* values;           ///< The compared bits of every digest stored
+    uint64_t* payloads;         ///< The worker and index of the input of every digest stored
+    uint32_t* heads[BH_NEAR_MAX_INDEXES]; ///< The first digest of every bucket of every index
+    uint32_t* next[BH_NEAR_MAX_INDEXES];  ///< The next digest of the same bucket of every index
+    GMutex mutex;               ///< Guards the digests and the indexes
+    guint64 candidates;         ///< The digests that shared a substring and were compared
+    int found;                  ///< Set once a near-collision is found, read atomically
+    guint64 point;              ///< The digests looked up to and with the near-collision
+    uint64_t found_values[2];   ///< The compared bits of the two digests, the earlier first
+    unsigned int found_distance; ///< The bits the two digests differ in
+} hash_near_search_t;
+
+hash_near_search_t* hash_near_search_create(unsigned int bits, unsigned int distance,
+                                            size_t capacity);
+unsigned int hash_near_distance(uint64_t a, uint64_t b);
+bool hash_near_search_add(hash_near_search_t* search, uint64_t value, uint64_t payload,
+                          uint64_t* match_value, uint64_t* match_payload);
+double hash_near_expected_inputs(unsigned int bits, unsigned int distance);
+size_t hash_near_estimate_bytes(unsigned int distance, size_t capacity);
+size_t hash_near_search_memory_size(const hash_near_search_t* search);
+void hash_near_search_destroy(hash_near_search_t* search);
+
+#endif
@@ -0,0 +1,154 @@
+/**
+ * \file            hash_collision_near_worker.c
+ * \brief           The worker of the near-collision page, which looks the digests up in the
+ *                  substring indexes and adds them
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_near_worker.h"
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Record a near-collision, unless another worker already found one earlier
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      worker_id The id of the worker that found the near-collision
+ * \param[in]      point The digests looked up to and with the later input
+ * \param[in]      inputs The earlier and the later input
+ * \param[in]      input_lens The length of both inputs in bytes
+ * \param[in]      values The compared bits of the digests of both inputs
+ * \return         false when an allocation failed and the error is registered, true otherwise
+ */
+static bool
+record_near_collision(hash_collision_context_t* ctx, unsigned int worker_id, guint64 point,
+                      const uint8_t* inputs[2], const size_t input_lens[2],
+                      const uint64_t values[2]) {
+    hash_near_search_t* near = ctx->near;
+    bool ok = true;
+
+    g_mutex_lock(ctx->result_mutex);
+    if (!g_atomic_int_get(&near->found) || point < near->point) {
+        char* input_1 = bytes_to_hex(inputs[0], input_lens[0], true);
+        char* input_2 = bytes_to_hex(inputs[1], input_lens[1], true);
+        if (input_1 && input_2) {
+            hash_collision_simulation_result_t* result = ctx->result;
+            free(result->collision_input_1);
+            free(result->collision_input_2);
+            result->collision_input_1 = input_1;
+            result->collision_input_2 = input_2;
+            result->collision_found = true;
+            near->point = point;
+            near->found_values[0] = values[0];
+            near->found_values[1] = values[1];
+            near->found_distance = hash_near_distance(values[0], values[1]);
+            g_atomic_int_set(&near->found, 1);
+        } else {
+            free(input_1);
+            free(input_2);
+            REGISTER_ERROR_FUNC(ctx, worker_id, ERROR_MEMORY_ALLOCATION,
+                                "Input hex string allocation failed");
+            ok = false;
+        }
+    }
+    g_mutex_unlock(ctx->result_mutex);
+    return ok;
+}
+
+/**************************************************************
+                      EXTERNAL FUNCTIONS
+**************************************************************/
+
+/**
+ * \brief          The worker of a near-collision search. A batch of inputs is generated from
+ *                 their index and hashed first, then looked up and added in the substring
+ *                 indexes under one lock of the search. The earlier input of a match is
+ *                 regenerated from its payload to tell a repeated input from a near-collision.
+ *                 The worker stops once its attempts are made, or once a near-collision is
+ *                 found.
+ *
+ * \param[in]      worker The data of this worker
+ */
+void
+hash_collision_near_worker(WorkerData* worker) {
+    hash_collision_context_t* ctx = worker->ctx;
+    hash_near_search_t* near = ctx->near;
+    uint8_t inputs[BH_TABLE_BATCH_SIZE][32];
+    const uint8_t* input_ptrs[BH_TABLE_BATCH_SIZE];
+    size_t input_lens[BH_TABLE_BATCH_SIZE];
+    char hex_buffers[BH_TABLE_BATCH_SIZE][BH_HASH_MAX_HEX];
+    char* hash_hexes[BH_TABLE_BATCH_SIZE];
+    uint64_t values[BH_TABLE_BATCH_SIZE];
+    for (unsigned int i = 0; i < BH_TABLE_BATCH_SIZE; i++) {
+        input_ptrs[i] = inputs[i];
+        hash_hexes[i] = hex_buffers[i];
+    }
+
+    bool ok = true;
+    unsigned int attempt = 0;
+    while (ok && attempt < worker->attempts_to_make && !g_atomic_int_get((gint*)&ctx->cancel)
+           && !g_atomic_int_get(&near->found)) {
+        unsigned int batch = worker->attempts_to_make - attempt;
+        if (batch > BH_TABLE_BATCH_SIZE) {
+            batch = BH_TABLE_BATCH_SIZE;
+        }
+
+        for (unsigned int i = 0; i < batch; i++) {
+            input_lens[i] = generate_indexed_input(ctx->run_seed, worker->worker_id, attempt + i,
+                                                   inputs[i], 4, 31);
+        }
+
+        unsigned int hashed = batch;
+        if (!compute_hash_batch(ctx->hash_id, input_ptrs, input_lens, batch, hash_hexes)) {
+            REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_HASH_COMPUTATION,
+                                "Hash function returned invalid result");
+            hashed = 0;
+            ok = false;
+        }
+        for (unsigned int i = 0; i < hashed; i++) {
+            values[i] = hash_prefix_head(hash_hexes[i]) >> (BH_NEAR_MAX_BITS - near->bits);
+        }
+
+        // The digests before the batch, counted over every worker
+        guint64 checked = (guint)g_atomic_int_add((gint*)&ctx->result->attempts_made,
+                                                  (gint)hashed);
+
+        unsigned int match = hashed;
+        uint8_t earlier[32];
+        size_t earlier_len = 0;
+        uint64_t match_value = 0, match_payload = 0;
+        g_mutex_lock(&near->mutex);
+        for (unsigned int i = 0; i < hashed; i++) {
+            uint64_t payload = ((uint64_t)worker->worker_id << 32) | (attempt + i);
+            if (!hash_near_search_add(near, values[i], payload, &match_value, &match_payload)) {
+                continue;
+            }
+
+            // The random generator can produce the same input twice, which is not a collision
+            earlier_len =
+                generate_indexed_input(ctx->run_seed, (unsigned int)(match_payload >> 32),
+                                       (guint32)match_payload, earlier, 4, 31);
+            if (earlier_len != input_lens[i] || memcmp(earlier, inputs[i], earlier_len) != 0) {
+                match = i;
+                break;
+            }
+        }
+        g_mutex_unlock(&near->mutex);
+
+        if (ok && match < hashed) {
+            const uint8_t* pair[2] = {earlier, inputs[match]};
+            size_t pair_lens[2] = {earlier_len, input_lens[match]};
+            uint64_t pair_values[2] = {match_value, values[match]};
+            ok = record_near_collision(ctx, worker->worker_id, checked + match + 1, pair, pair_lens,
+                                       pair_values);
+        }
+        attempt += batch;
+    }
+}
@@ -0,0 +1,307 @@
+/**
+ * \file            hash_collision_plan.c
+ * \brief           Chooses how a hash collision run looks for a collision from the memory
+ *                  it may use. A full table is the fastest but stores every digest with its
+ *                  input, the compact table stores 16 bytes per digest and regenerates the
+ *                  inputs, distinguished points only store the ends of trails of iterated
+ *                  hashes, and the cycle search needs no table at all at about three times
+ *                  the hashes. The planner predicts the memory, the hashes and the time of
+ *                  each, and picks the fastest that fits.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_plan.h"
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Get the chance that a number of random digests holds a collision, by
+ *                 the birthday bound 1 - e^(-m^2 / 2N)
+ *
+ * \param[in]      attempts The number of random digests, m
+ * \param[in]      space The number of possible digests, N
+ * \return         The probability, 0 to 1
+ */
+static double
+hash_plan_birthday_probability(double attempts, double space) {
+    if (attempts <= 0) {
+        return 0.0;
+    }
+    return -expm1(-(attempts * attempts) / (2.0 * space));
+}
+
+/**
+ * \brief          Get the number of distinct digests a table can hold at most: every
+ *                 attempt, unless the hash has fewer possible digests than that
+ *
+ * \param[in]      request The run to plan
+ * \param[in]      space The number of possible digests
+ * \return         The number of digests to size the tables for
+ */
+static size_t
+hash_plan_table_entries(const hash_plan_request_t* request, double space) {
+    double entries = request->max_attempts;
+    if (space < entries) {
+        entries = space;
+    }
+    return (size_t)entries;
+}
+
+/**
+ * \brief          Predict the memory of a full table run, with the same sizing as the
+ *                 simulation uses for its stores, prefilters and shards
+ *
+ * \param[in]      request The run to plan
+ * \param[in]      entries The number of digests the tables hold, without the extra entries
+ * \return         The predicted size in bytes
+ */
+static size_t
+hash_plan_table_bytes(const hash_plan_request_t* request, size_t entries) {
+    size_t entry_bytes = request->hash_hex_length + BH_PLAN_INPUT_HEX_BYTES;
+    size_t stored = entries + request->extra_entries;
+
+    if (request->two_pass) {
+        // Only the filter hits are stored, once as a candidate digest and once with the
+        // input in the table, while the filter covers every attempt
+        size_t candidates = request->max_attempts / 32 + 1024 + request->extra_entries;
+        return hash_filter_estimate_bytes(request->max_attempts, 0)
+               + hash_digest_store_estimate_bytes(HASH_TABLE_CHAINED, candidates, false,
+                                                  request->hash_hex_length + 1)
+               + hash_digest_store_estimate_bytes(request->layout, candidates, false,
+                                                  entry_bytes);
+    }
+
+    if (request->sharded) {
+        return hash_shard_engine_estimate_bytes(request->worker_count, stored, request->layout,
+                                                request->bloom, entry_bytes,
+                                                request->digest_bytes);
+    }
+
+    size_t bytes = hash_digest_store_estimate_bytes(request->layout, stored, false, entry_bytes);
+    if (request->bloom) {
+        bytes += hash_filter_estimate_bytes(request->max_attempts, 0);
+    }
+    return bytes;
+}
+
+/**
+ * \brief          Choose the number of zero bits that make a point distinguished: the
+ *                 fewest that keep the trail ends within the budget and the trail indexes
+ *                 within 24 bits. Every extra bit halves
+ *                 the trails stored but doubles the hashes walked past the collision.
+ *
+ * \param[in]      request The run to plan
+ * \param[in]      expected The hashes expected before the first collision
+ * \param[in,out]  plan The plan to fill with the bits, the memory and the hashes
+ */
+static void
+hash_plan_distinguished_bits(const hash_plan_request_t* request, double expected,
+                             hash_attack_plan_t* plan) {
+    int workers = request->worker_count > 0 ? request->worker_count : 1;
+    unsigned int max_bits = request->bits / 2;
+    if (max_bits > BH_PLAN_MAX_DISTINGUISHED_BITS) {
+        max_bits = BH_PLAN_MAX_DISTINGUISHED_BITS;
+    }
+    for (unsigned int bits = 0; bits <= max_bits; bits++) {
+        double distance = ldexp(1.0, (int)bits);
+
+        // Every worker walks a trail past the collision to its end, and one more trail
+        // is needed for the second trail to meet the first
+        double hashes = expected + (workers + 1) * distance;
+        if (hashes > request->max_attempts) {
+            hashes = request->max_attempts;
+        }
+
+        // The trail ends store the trail index of a worker in 24 bits
+        size_t trails = (size_t)(hashes / distance) + workers;
+        if (trails / workers >= BH_PLAN_MAX_TRAILS && bits < max_bits) {
+            continue;
+        }
+        plan->distinguished_bits = bits;
+        plan->expected_hashes = hashes;
+        plan->predicted_bytes = hash_compact_table_estimate_bytes(trails);
+        if (plan->predicted_bytes <= request->budget_bytes) {
+            return;
+        }
+    }
+}
+
+/****************************************************************
+                       EXTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Get the memory budget offered by default: the memory the cgroup and the
+ *                 system report as available, in MiB and within the range of the form
+ *
+ * \return         The budget in MiB
+ */
+size_t
+hash_plan_default_budget_mib(void) {
+    size_t available = get_available_memory();
+    if (available == 0) {
+        return BH_PLAN_DEFAULT_BUDGET_MIB;
+    }
+
+    size_t mib = available / (1024 * 1024);
+    if (mib < 1) {
+        return 1;
+    }
+    return mib > BH_PLAN_MAX_BUDGET_MIB ? BH_PLAN_MAX_BUDGET_MIB : mib;
+}
+
+/**
+ * \brief          Predict the memory, the hashes, the time and the chance of success of a
+ *                 run with the given strategy
+ *
+ * \param[in]      request The run to plan
+ * \param[in]      strategy The strategy to predict, HASH_STRATEGY_AUTO is not accepted
+ * \param[out]     plan Receives the prediction, fits tells whether it is within the budget
+ */
+void
+hash_plan_for_strategy(const hash_plan_request_t* request, hash_strategy_t strategy,
+                       hash_attack_plan_t* plan) {
+    memset(plan, 0, sizeof(*plan));
+    plan->strategy = strategy;
+    plan->budget_bytes = request->budget_bytes;
+
+    int workers = request->worker_count > 0 ? request->worker_count : 1;
+    double space = ldexp(1.0, request->bits);
+    double attempts = request->max_attempts;
+    double expected = 1.2533141373155003 * sqrt(space); // sqrt(pi / 2 * N)
+    double hash_seconds = request->seconds_per_hash;
+
+    switch (strategy) {
+        case HASH_STRATEGY_COMPACT:
+            plan->predicted_bytes =
+                hash_compact_table_estimate_bytes(hash_plan_table_entries(request, space));
+            plan->expected_hashes = expected < attempts ? expected : attempts;
+            plan->predicted_seconds =
+                plan->expected_hashes * (hash_seconds / workers + BH_PLAN_COMPACT_NS * 1e-9);
+            plan->success_probability = hash_plan_birthday_probability(attempts, space);
+            break;
+
+        case HASH_STRATEGY_DISTINGUISHED: {
+            hash_plan_distinguished_bits(request, expected, plan);
+            double distance = ldexp(1.0, (int)plan->distinguished_bits);
+            plan->trail_limit = (unsigned int)(BH_PLAN_TRAIL_LIMIT_FACTOR * distance);
+
+            // The two merged trails are walked again by one worker to find the collision
+            plan->predicted_seconds =
+                (plan->expected_hashes / workers + 2.0 * distance) * hash_seconds;
+            plan->success_probability = hash_plan_birthday_probability(
+                attempts - (workers + 1) * distance, space);
+        } break;
+
+        case HASH_STRATEGY_CYCLE:
+            // A single walk from one start, the other workers are left idle
+            plan->predicted_bytes = 0;
+            plan->expected_hashes = BH_PLAN_CYCLE_FACTOR * expected;
+            if (plan->expected_hashes > attempts) {
+                plan->expected_hashes = attempts;
+            }
+            plan->predicted_seconds = plan->expected_hashes * hash_seconds;
+            plan->success_probability =
+                hash_plan_birthday_probability(attempts / BH_PLAN_CYCLE_FACTOR, space);
+            break;
+
+        default: {
+            plan->strategy = HASH_STRATEGY_TABLE;
+            plan->predicted_bytes =
+                hash_plan_table_bytes(request, hash_plan_table_entries(request, space));
+            plan->expected_hashes = expected < attempts ? expected : attempts;
+
+            // The shared table is locked for every lookup, the shards are not
+            double table_seconds = BH_PLAN_TABLE_NS * 1e-9;
+            double per_hash = request->sharded ? (hash_seconds + table_seconds) / workers
+                                               : hash_seconds / workers + table_seconds;
+            plan->predicted_seconds = plan->expected_hashes * per_hash;
+            if (request->two_pass) {
+                // The first pass makes every attempt before the replay looks for the collision
+                plan->expected_hashes += attempts;
+                plan->predicted_seconds += attempts * hash_seconds / workers;
+            }
+            plan->success_probability = hash_plan_birthday_probability(attempts, space);
+        } break;
+    }
+
+    plan->fits = plan->predicted_bytes <= request->budget_bytes;
+}
+
+/**
+ * \brief          Plan a run. A chosen strategy is predicted as it is, even when it does not
+ *                 fit the budget. HASH_STRATEGY_AUTO picks the full table or else the compact
+ *                 table when they fit, since nothing is faster, and otherwise the faster of
+ *                 distinguished points and the cycle search.
+ *
+ * \param[in]      request The run to plan
+ * \param[in]      strategy The strategy chosen on the form, or HASH_STRATEGY_AUTO
+ * \param[out]     plan Receives the plan
+ */
+void
+hash_plan_attack(const hash_plan_request_t* request, hash_strategy_t strategy,
+                 hash_attack_plan_t* plan) {
+    if (strategy > HASH_STRATEGY_AUTO && strategy <= HASH_STRATEGY_CYCLE) {
+        hash_plan_for_strategy(request, strategy, plan);
+        return;
+    }
+
+    hash_plan_for_strategy(request, HASH_STRATEGY_TABLE, plan);
+    if (plan->fits) {
+        return;
+    }
+    hash_plan_for_strategy(request, HASH_STRATEGY_COMPACT, plan);
+    if (plan->fits) {
+        return;
+    }
+
+    hash_attack_plan_t cycle;
+    hash_plan_for_strategy(request, HASH_STRATEGY_DISTINGUISHED, plan);
+    hash_plan_for_strategy(request, HASH_STRATEGY_CYCLE, &cycle);
+    if (!plan->fits || cycle.predicted_seconds < plan->predicted_seconds) {
+        *plan = cycle;
+    }
+}
+
+/**
+ * \brief          Replace a plan whose memory could not be allocated with the next strategy
+ *                 that needs less memory
+ *
+ * \param[in]      request The run the plan was made for
+ * \param[in,out]  plan The plan to replace, marked as a fallback
+ * \return         true if there is a strategy left, false if the plan already needs no table
+ */
+bool
+hash_plan_fall_back(const hash_plan_request_t* request, hash_attack_plan_t* plan) {
+    if (plan->strategy >= HASH_STRATEGY_CYCLE) {
+        return false;
+    }
+
+    hash_plan_for_strategy(request, plan->strategy + 1, plan);
+    plan->fallback = true;
+    return true;
+}
+
+/**
+ * \brief          Get the name of a strategy to show on the page
+ *
+ * \param[in]      strategy The strategy
+ * \return         The name
+ */
+const char*
+hash_plan_strategy_label(hash_strategy_t strategy) {
+    switch (strategy) {
+        case HASH_STRATEGY_TABLE: return "Full table";
+        case HASH_STRATEGY_COMPACT: return "Compact entries";
+        case HASH_STRATEGY_DISTINGUISHED: return "Distinguished points";
+        case HASH_STRATEGY_CYCLE: return "Cycle search";
+        default: return "Auto";
+    }
+}
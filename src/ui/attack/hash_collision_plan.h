@@ -0,0 +1,135 @@
+/**
+ * \file            hash_collision_plan.h
+ * \brief           Header file for hash_collision_plan.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_COLLISION_PLAN_H
+#define HASH_COLLISION_PLAN_H
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "hash_collision_compact.h"
+#include "hash_collision_filter.h"
+#include "hash_collision_shard.h"
+#include "hash_collision_table.h"
+
+#include "../../utils/memory.h"
+
+/**
+ * \brief          The memory budget in MiB offered when the available memory can not be
+ *                 detected
+ */
+#define BH_PLAN_DEFAULT_BUDGET_MIB     1024
+
+/**
+ * \brief          The largest memory budget in MiB the form accepts, 6 digits
+ */
+#define BH_PLAN_MAX_BUDGET_MIB         999999
+
+/**
+ * \brief          The average bytes of an input as stored by the full tables: the inputs
+ *                 are 4 to 31 random bytes, so 35 hex characters and a null terminator
+ */
+#define BH_PLAN_INPUT_HEX_BYTES        36
+
+/**
+ * \brief          The hashes a cycle search needs relative to a table. Brent's search
+ *                 takes about 1.98 sqrt(N) hashes to find the cycle and 1.88 sqrt(N) more
+ *                 to walk to its entry, against 1.25 sqrt(N) for a table.
+ */
+#define BH_PLAN_CYCLE_FACTOR           3.1
+
+/**
+ * \brief          A distinguished point trail is abandoned after this many times the
+ *                 expected distance between distinguished points, it is stuck in a cycle
+ */
+#define BH_PLAN_TRAIL_LIMIT_FACTOR     20
+
+/**
+ * \brief          The most zero bits a distinguished point may need, which keeps the trail
+ *                 lengths within the 24 bits the trail ends store them in
+ */
+#define BH_PLAN_MAX_DISTINGUISHED_BITS 16
+
+/**
+ * \brief          The most trails a worker may walk, the trail ends store their index in
+ *                 24 bits
+ */
+#define BH_PLAN_MAX_TRAILS             0x1000000
+
+/**
+ * \brief          The predicted nanoseconds of a lookup and insert in a full table, taken
+ *                 from the flat and chained benchmarks of a few million digests
+ */
+#define BH_PLAN_TABLE_NS               300
+
+/**
+ * \brief          The predicted nanoseconds of a lookup and insert in the compact table
+ */
+#define BH_PLAN_COMPACT_NS             60
+
+/**
+ * \brief          How a run looks for a collision. The values match the option numbers of
+ *                 the strategy field on the hash collision form, and the strategies after
+ *                 HASH_STRATEGY_AUTO are ordered from the most memory to the least.
+ */
+typedef enum {
+    HASH_STRATEGY_AUTO = 1,      ///< Let the planner choose from the memory budget
+    HASH_STRATEGY_TABLE,         ///< Store every digest with its input in a full table
+    HASH_STRATEGY_COMPACT,       ///< Store a 16-byte fingerprint and input index per digest
+    HASH_STRATEGY_DISTINGUISHED, ///< Walk trails of iterated hashes, store only their ends
+    HASH_STRATEGY_CYCLE          ///< Iterate the hash from one start and find the cycle
+} hash_strategy_t;
+
+/**
+ * \brief          Everything the planner needs to know about a run
+ */
+typedef struct {
+    unsigned int bits;            ///< The output bits of the hash function
+    size_t hash_hex_length;       ///< The length of a digest in hex, with the null terminator
+    size_t digest_bytes;          ///< The bytes of a binary digest of the hash function
+    unsigned int max_attempts;    ///< The total number of attempts requested for the run
+    unsigned int extra_entries;   ///< Digests stored besides the attempts, like flood keys
+    int worker_count;             ///< The number of workers of the run
+    size_t budget_bytes;          ///< The memory the run may use
+    bool sharded;                 ///< Full table only, whether the sharded engine is used
+    hash_table_layout_t layout;   ///< Full table only, the layout of the digest tables
+    bool bloom;                   ///< Full table only, whether a Bloom prefilter is used
+    bool two_pass;                ///< Full table only, whether the two-pass prefilter is used
+    double seconds_per_hash;      ///< The measured cost of generating and hashing one input
+} hash_plan_request_t;
+
+/**
+ * \brief          The strategy chosen for a run with its predicted cost
+ */
+typedef struct {
+    hash_strategy_t strategy;        ///< The strategy of the run, never HASH_STRATEGY_AUTO
+    bool fits;                       ///< Whether the predicted memory is within the budget
+    bool fallback;                   ///< Whether a strategy before this one failed to allocate
+    size_t budget_bytes;             ///< The memory the run may use
+    size_t predicted_bytes;          ///< The memory the strategy is predicted to use
+    double expected_hashes;          ///< The hashes expected before a collision or the cap
+    double predicted_seconds;        ///< The time those hashes are predicted to take
+    double success_probability;      ///< The chance to find a collision within the attempts
+    unsigned int distinguished_bits; ///< Distinguished points only, the zero bits of an end
+    unsigned int trail_limit;        ///< Distinguished points only, the longest trail walked
+} hash_attack_plan_t;
+
+size_t hash_plan_default_budget_mib(void);
+void hash_plan_for_strategy(const hash_plan_request_t* request, hash_strategy_t strategy,
+                            hash_attack_plan_t* plan);
+void hash_plan_attack(const hash_plan_request_t* request, hash_strategy_t strategy,
+                      hash_attack_plan_t* plan);
+bool hash_plan_fall_back(const hash_plan_request_t* request, hash_attack_plan_t* plan);
+const char* hash_plan_strategy_label(hash_strategy_t strategy);
+
+#endif
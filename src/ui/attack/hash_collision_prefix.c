@@ -0,0 +1,117 @@
+/**
+ * \file            hash_collision_prefix.c
+ * \brief           The target of a targeted prefix search, where the workers look for an
+ *                  input whose digest starts with a bit pattern. The leading 64 bits of every
+ *                  digest of a batch are read once, then the whole batch is compared against
+ *                  the pattern without a branch per digest.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_prefix.h"
+
+/****************************************************************
+                       EXTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Create the target of a prefix search. You should free the returned target
+ *                 using `hash_prefix_target_destroy` when done.
+ *
+ * \param[in]      bits The number of leading digest bits to fix, 1 to BH_PREFIX_MAX_BITS
+ * \param[in]      value The pattern as a number, its lowest bits bits are used
+ * \return         A pointer to the newly created target, or NULL on memory allocation failure
+ *                 or when bits is out of range
+ */
+hash_prefix_target_t*
+hash_prefix_target_create(unsigned int bits, uint64_t value) {
+    if (bits == 0 || bits > BH_PREFIX_MAX_BITS) {
+        return NULL;
+    }
+
+    hash_prefix_target_t* target = calloc(1, sizeof(hash_prefix_target_t));
+    if (!target) {
+        return NULL;
+    }
+
+    target->bits = bits;
+    target->mask = UINT64_MAX << (BH_PREFIX_MAX_BITS - bits);
+    target->pattern = (value << (BH_PREFIX_MAX_BITS - bits)) & target->mask;
+    return target;
+}
+
+/**
+ * \brief          Read the leading 64 bits of a hex digest. A digest shorter than 64 bits is
+ *                 padded with zero bits after its own.
+ *
+ * \param[in]      hash_hex The digest in hex
+ * \return         The leading bits, the first digest bit is the top bit
+ */
+uint64_t
+hash_prefix_head(const char* hash_hex) {
+    uint64_t value = 0;
+    unsigned short i = 0;
+    for (; i < 16 && hash_hex[i] != '\0'; i++) {
+        char c = hash_hex[i];
+        uint64_t nibble = 0;
+        if (c >= '0' && c <= '9') {
+            nibble = c - '0';
+        } else if (c >= 'A' && c <= 'F') {
+            nibble = c - 'A' + 10;
+        } else if (c >= 'a' && c <= 'f') {
+            nibble = c - 'a' + 10;
+        }
+        value = (value << 4) | nibble;
+    }
+    return i == 16 ? value : value << (4 * (16 - i));
+}
+
+/**
+ * \brief          Find the first digest of a batch that starts with the pattern. Every head is
+ *                 compared and the results are gathered into a mask, a loop without branches
+ *                 that the compiler turns into vector compares.
+ *
+ * \param[in]      target The target of the search
+ * \param[in]      heads The leading bits of the digests, from hash_prefix_head
+ * \param[in]      count The number of digests, at most BH_PREFIX_BATCH_MAX
+ * \return         The index of the first digest that matches, or count when none does
+ */
+unsigned int
+hash_prefix_match_batch(const hash_prefix_target_t* target, const uint64_t* heads,
+                        unsigned int count) {
+    uint64_t matches = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        matches |= (uint64_t)(((heads[i] ^ target->pattern) & target->mask) == 0) << i;
+    }
+
+    if (matches == 0) {
+        return count;
+    }
+
+    unsigned int first = 0;
+    while (!(matches & 1)) {
+        matches >>= 1;
+        first++;
+    }
+    return first;
+}
+
+/**
+ * \brief          Destroy the target with the input it found
+ *
+ * \param[in]      target The target to destroy, NULL is ignored
+ */
+void
+hash_prefix_target_destroy(hash_prefix_target_t* target) {
+    if (!target) {
+        return;
+    }
+
+    free(target->input_hex);
+    free(target->hash_hex);
+    free(target);
+}
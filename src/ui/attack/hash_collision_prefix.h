@@ -0,0 +1,52 @@
+/**
+ * \file            hash_collision_prefix.h
+ * \brief           Header file for hash_collision_prefix.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_COLLISION_PREFIX_H
+#define HASH_COLLISION_PREFIX_H
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * \brief          The most leading bits of a digest a prefix can fix, the head of a digest is
+ *                 read into 64 bits
+ */
+#define BH_PREFIX_MAX_BITS 64
+
+/**
+ * \brief          The most digests hash_prefix_match_batch checks at once, one bit of its
+ *                 match mask each
+ */
+#define BH_PREFIX_BATCH_MAX 64
+
+/**
+ * \brief          A targeted prefix search, the partial preimage of a bit pattern: an input
+ *                 whose digest starts with the given bits.
+ */
+typedef struct {
+    unsigned int bits;  ///< The number of leading digest bits fixed by the pattern
+    uint64_t pattern;   ///< The pattern, in the top bits
+    uint64_t mask;      ///< The top bits set for the pattern bits
+    int found;          ///< Set once an input matched, read atomically
+    guint64 point;      ///< The number of digests checked up to and with the match
+    char* input_hex;    ///< The input that matched
+    char* hash_hex;     ///< The digest of the input
+} hash_prefix_target_t;
+
+hash_prefix_target_t* hash_prefix_target_create(unsigned int bits, uint64_t value);
+uint64_t hash_prefix_head(const char* hash_hex);
+unsigned int hash_prefix_match_batch(const hash_prefix_target_t* target, const uint64_t* heads,
+                                     unsigned int count);
+void hash_prefix_target_destroy(hash_prefix_target_t* target);
+
+#endif
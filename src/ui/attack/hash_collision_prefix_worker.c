@@ -0,0 +1,139 @@
+/**
+ * \file            hash_collision_prefix_worker.c
+ * \brief           The worker of the prefix page, which matches every digest against the
+ *                  target prefix and feeds the detectors
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_prefix_worker.h"
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Record the input of a prefix search whose digest starts with the pattern,
+ *                 unless another worker already has.
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      worker_id The id of the worker that found the input
+ * \param[in]      point The number of digests checked up to and with the input
+ * \param[in]      input The input
+ * \param[in]      input_len The length of the input in bytes
+ * \param[in]      hash_hex The digest of the input
+ * \return         false when an allocation failed and the error is registered, true otherwise
+ */
+static bool
+record_prefix_match(hash_collision_context_t* ctx, unsigned int worker_id, guint64 point,
+                    const uint8_t* input, size_t input_len, const char* hash_hex) {
+    hash_prefix_target_t* target = ctx->prefix;
+    bool ok = true;
+
+    g_mutex_lock(ctx->result_mutex);
+    if (!g_atomic_int_get(&target->found) || point < target->point) {
+        char* input_hex = bytes_to_hex(input, input_len, true);
+        char* digest = g_strdup(hash_hex);
+        if (input_hex && digest) {
+            free(target->input_hex);
+            free(target->hash_hex);
+            target->input_hex = input_hex;
+            target->hash_hex = digest;
+            target->point = point;
+            g_atomic_int_set(&target->found, 1);
+        } else {
+            free(input_hex);
+            g_free(digest);
+            REGISTER_ERROR_FUNC(ctx, worker_id, ERROR_MEMORY_ALLOCATION,
+                                "Input hex string allocation failed");
+            ok = false;
+        }
+    }
+    g_mutex_unlock(ctx->result_mutex);
+    return ok;
+}
+
+/**************************************************************
+                      EXTERNAL FUNCTIONS
+**************************************************************/
+
+/**
+ * \brief          The worker of a prefix search. Every input is generated from its index and
+ *                 hashed once, the leading bits of the batch are matched against the pattern
+ *                 together, and the same digests feed the collision detectors of the run. So
+ *                 the prefix and the collision are measured on one stream of inputs and one
+ *                 budget. The worker stops once its attempts are made, or once the prefix is
+ *                 found and every detector has retired.
+ *
+ * \param[in]      worker The data of this worker
+ */
+void
+hash_collision_prefix_worker(WorkerData* worker) {
+    hash_collision_context_t* ctx = worker->ctx;
+    hash_prefix_target_t* target = ctx->prefix;
+    hash_detector_set_t* set = ctx->detectors;
+    uint8_t inputs[BH_TABLE_BATCH_SIZE][32];
+    const uint8_t* input_ptrs[BH_TABLE_BATCH_SIZE];
+    size_t input_lens[BH_TABLE_BATCH_SIZE];
+    char hex_buffers[BH_TABLE_BATCH_SIZE][BH_HASH_MAX_HEX];
+    char* hash_hexes[BH_TABLE_BATCH_SIZE];
+    uint64_t heads[BH_TABLE_BATCH_SIZE];
+    for (unsigned int i = 0; i < BH_TABLE_BATCH_SIZE; i++) {
+        input_ptrs[i] = inputs[i];
+        hash_hexes[i] = hex_buffers[i];
+    }
+
+    bool ok = true;
+    unsigned int attempt = 0;
+    while (ok && attempt < worker->attempts_to_make && !g_atomic_int_get((gint*)&ctx->cancel)) {
+        bool detecting = set && g_atomic_int_get(&set->active) > 0;
+        if (g_atomic_int_get(&target->found) && !detecting) {
+            break;
+        }
+
+        unsigned int batch = worker->attempts_to_make - attempt;
+        if (batch > BH_TABLE_BATCH_SIZE) {
+            batch = BH_TABLE_BATCH_SIZE;
+        }
+
+        for (unsigned int i = 0; i < batch; i++) {
+            input_lens[i] = generate_indexed_input(ctx->run_seed, worker->worker_id, attempt + i,
+                                                   inputs[i], 4, 31);
+        }
+
+        unsigned int hashed = batch;
+        if (!compute_hash_batch(ctx->hash_id, input_ptrs, input_lens, batch, hash_hexes)) {
+            REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_HASH_COMPUTATION,
+                                "Hash function returned invalid result");
+            hashed = 0;
+            ok = false;
+        }
+        for (unsigned int i = 0; i < hashed; i++) {
+            heads[i] = hash_prefix_head(hash_hexes[i]);
+        }
+
+        // The digests before the batch, counted over every worker
+        guint64 checked = (guint)g_atomic_int_add((gint*)&ctx->result->attempts_made,
+                                                  (gint)hashed);
+
+        unsigned int match = hash_prefix_match_batch(target, heads, hashed);
+        if (ok && match < hashed) {
+            ok = record_prefix_match(ctx, worker->worker_id, checked + match + 1, inputs[match],
+                                     input_lens[match], hash_hexes[match]);
+        }
+
+        for (unsigned int d = 0; ok && detecting && d < set->count; d++) {
+            hash_detector_t* detector = &set->detectors[d];
+            if (hash_detector_is_retired(detector)) {
+                continue;
+            }
+            ok = detector_lookup_batch(ctx, detector, worker->worker_id, attempt, inputs,
+                                       input_lens, hash_hexes, hashed);
+        }
+        attempt += batch;
+    }
+}
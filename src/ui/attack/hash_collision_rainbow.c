@@ -0,0 +1,300 @@
+/**
+ * \file            hash_collision_rainbow.c
+ * \brief           The rainbow tables of the time-memory tradeoff: chains of hashes and
+ *                  reductions over the points of a truncated digest, where only the two ends
+ *                  of every chain are stored. The chains are sorted by their end and written
+ *                  to a file, which later runs map instead of building the table again.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_rainbow.h"
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Get the mask of the points of a table
+ *
+ * \param[in]      rainbow The rainbow table
+ * \return         The mask of the low bits bits
+ */
+static inline uint64_t
+hash_rainbow_mask(const hash_rainbow_t* rainbow) {
+    return (UINT64_C(1) << rainbow->bits) - 1;
+}
+
+/**
+ * \brief          Compare two chains by their end, for qsort
+ *
+ * \param[in]      a The first chain
+ * \param[in]      b The second chain
+ * \return         Less than, equal to or greater than 0 as the end of a is below, equal to or
+ *                 above the end of b
+ */
+static int
+hash_rainbow_compare_ends(const void* a, const void* b) {
+    uint64_t end_a = ((const hash_rainbow_chain_t*)a)->end;
+    uint64_t end_b = ((const hash_rainbow_chain_t*)b)->end;
+    return (end_a > end_b) - (end_a < end_b);
+}
+
+/****************************************************************
+                       EXTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Create a rainbow table, with the file it is saved to named after its
+ *                 parameters. Nothing is built or mapped yet. You should free the returned
+ *                 table using `hash_rainbow_destroy` when done.
+ *
+ * \param[in]      hash_id The hash function of the chains
+ * \param[in]      bits The digest bits, BH_RAINBOW_MIN_BITS to BH_RAINBOW_MAX_BITS
+ * \param[in]      chain_length The hashes of every chain
+ * \param[in]      chain_count The chains of the table, at most 2^bits
+ * \param[in]      query_count The inversion queries to answer
+ * \return         A pointer to the newly created table, or NULL on memory allocation failure
+ *                 or invalid parameters
+ */
+hash_rainbow_t*
+hash_rainbow_create(enum hash_function_ids hash_id, unsigned int bits, unsigned int chain_length,
+                    size_t chain_count, unsigned int query_count) {
+    if (bits < BH_RAINBOW_MIN_BITS || bits > BH_RAINBOW_MAX_BITS || chain_length == 0
+        || chain_count == 0 || chain_count > (UINT64_C(1) << bits)) {
+        return NULL;
+    }
+
+    hash_rainbow_t* rainbow = calloc(1, sizeof(hash_rainbow_t));
+    if (!rainbow) {
+        return NULL;
+    }
+
+    rainbow->hash_id = hash_id;
+    rainbow->bits = bits;
+    rainbow->chain_length = chain_length;
+    rainbow->chain_count = chain_count;
+    rainbow->query_count = query_count;
+    snprintf(rainbow->path, sizeof(rainbow->path), "bh_rainbow_%d_%u_%u_%zu.tbl", (int)hash_id,
+             bits, chain_length, chain_count);
+    return rainbow;
+}
+
+/**
+ * \brief          Map the file of the table, if an earlier run saved it with the same
+ *                 parameters
+ *
+ * \param[in]      rainbow The rainbow table
+ * \return         true if the table is mapped, false if the file is missing, does not match
+ *                 the parameters or can not be mapped
+ */
+bool
+hash_rainbow_load(hash_rainbow_t* rainbow) {
+    mapped_file_t* map = mapped_file_open(rainbow->path);
+    if (!map) {
+        return false;
+    }
+
+    hash_rainbow_header_t header;
+    size_t expected = hash_rainbow_file_bytes(rainbow->chain_count);
+    if (map->size != expected) {
+        mapped_file_close(map);
+        return false;
+    }
+
+    memcpy(&header, map->data, sizeof(header));
+    if (memcmp(header.magic, BH_RAINBOW_MAGIC, sizeof(header.magic)) != 0
+        || header.hash_id != (uint32_t)rainbow->hash_id || header.bits != rainbow->bits
+        || header.chain_length != rainbow->chain_length
+        || header.chain_count != rainbow->chain_count) {
+        mapped_file_close(map);
+        return false;
+    }
+
+    rainbow->map = map;
+    rainbow->chains = (const hash_rainbow_chain_t*)(map->data + sizeof(header));
+    return true;
+}
+
+/**
+ * \brief          Allocate the chains before they are built
+ *
+ * \param[in]      rainbow The rainbow table
+ * \return         false on memory allocation failure, true otherwise
+ */
+bool
+hash_rainbow_begin_build(hash_rainbow_t* rainbow) {
+    rainbow->built = malloc(rainbow->chain_count * sizeof(hash_rainbow_chain_t));
+    return rainbow->built != NULL;
+}
+
+/**
+ * \brief          Sort the built chains by their end, save them to the file of the table and
+ *                 map it. The chains in memory are freed once they are saved. Only call it
+ *                 once every chain is built.
+ *
+ * \param[in]      rainbow The rainbow table
+ * \return         false when the file can not be written or mapped, true otherwise
+ */
+bool
+hash_rainbow_finish_build(hash_rainbow_t* rainbow) {
+    qsort(rainbow->built, rainbow->chain_count, sizeof(hash_rainbow_chain_t),
+          hash_rainbow_compare_ends);
+
+    hash_rainbow_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BH_RAINBOW_MAGIC, sizeof(header.magic));
+    header.hash_id = (uint32_t)rainbow->hash_id;
+    header.bits = rainbow->bits;
+    header.chain_length = rainbow->chain_length;
+    header.chain_count = rainbow->chain_count;
+
+    FILE* file = fopen(rainbow->path, "wb");
+    if (!file) {
+        return false;
+    }
+
+    bool written =
+        fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(rainbow->built, sizeof(hash_rainbow_chain_t), rainbow->chain_count, file)
+               == rainbow->chain_count;
+    written = fclose(file) == 0 && written;
+    if (!written) {
+        remove(rainbow->path);
+        return false;
+    }
+
+    free(rainbow->built);
+    rainbow->built = NULL;
+    return hash_rainbow_load(rainbow);
+}
+
+/**
+ * \brief          Get the first point of a chain. The index is multiplied by an odd
+ *                 constant, which is a bijection of the points, so the chains start apart.
+ *
+ * \param[in]      rainbow The rainbow table
+ * \param[in]      index The index of the chain
+ * \return         The first point
+ */
+uint64_t
+hash_rainbow_start_point(const hash_rainbow_t* rainbow, size_t index) {
+    return ((uint64_t)index * UINT64_C(0x9E3779B97F4A7C15)) & hash_rainbow_mask(rainbow);
+}
+
+/**
+ * \brief          Reduce a truncated digest to the point of the next column. Every column
+ *                 mixes its own constant in, so two chains that reach the same digest in
+ *                 different columns go on apart.
+ *
+ * \param[in]      rainbow The rainbow table
+ * \param[in]      column The column of the digest, 0 for the first hash of a chain
+ * \param[in]      value The truncated digest
+ * \return         The point of the next column
+ */
+uint64_t
+hash_rainbow_reduce(const hash_rainbow_t* rainbow, unsigned int column, uint64_t value) {
+    return (value ^ ((column + UINT64_C(1)) * UINT64_C(0xD6E8FEB86659FD93)))
+           & hash_rainbow_mask(rainbow);
+}
+
+/**
+ * \brief          Write the input of a point, its bytes little endian, as few as the bits
+ *                 need
+ *
+ * \param[in]      rainbow The rainbow table
+ * \param[in]      point The point
+ * \param[out]     input Receives at most BH_RAINBOW_MAX_INPUT_BYTES bytes
+ * \return         The length of the input in bytes
+ */
+size_t
+hash_rainbow_point_input(const hash_rainbow_t* rainbow, uint64_t point, uint8_t* input) {
+    size_t len = (rainbow->bits + 7) / 8;
+    for (size_t i = 0; i < len; i++) {
+        input[i] = (uint8_t)(point >> (8 * i));
+    }
+    return len;
+}
+
+/**
+ * \brief          Find the chains of the mapped table that end on a point
+ *
+ * \param[in]      rainbow The mapped rainbow table
+ * \param[in]      end The point the chains end on
+ * \param[out]     first Receives the position of the first chain ending on it
+ * \return         The number of chains ending on it, 0 for none
+ */
+size_t
+hash_rainbow_find(const hash_rainbow_t* rainbow, uint64_t end, size_t* first) {
+    size_t low = 0;
+    size_t high = rainbow->chain_count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (rainbow->chains[middle].end < end) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    size_t count = 0;
+    while (low + count < rainbow->chain_count && rainbow->chains[low + count].end == end) {
+        count++;
+    }
+    *first = low;
+    return count;
+}
+
+/**
+ * \brief          Get the chance that a rainbow table inverts a random point. The chains
+ *                 still apart in every column are counted as in Oechslin's analysis, the
+ *                 points a column covers are m_i, then m_(i+1) = N (1 - e^(-m_i / N)).
+ *
+ * \param[in]      bits The digest bits, N = 2^bits
+ * \param[in]      chain_length The hashes of every chain
+ * \param[in]      chain_count The chains of the table
+ * \return         The chance between 0 and 1
+ */
+double
+hash_rainbow_success_rate(unsigned int bits, unsigned int chain_length, size_t chain_count) {
+    double points = ldexp(1.0, (int)bits);
+    double covered = (double)chain_count;
+    double missed = 1.0;
+    for (unsigned int i = 0; i < chain_length; i++) {
+        missed *= 1.0 - covered / points;
+        covered = points * (1.0 - exp(-covered / points));
+    }
+    return 1.0 - missed;
+}
+
+/**
+ * \brief          Get the size of the file of a rainbow table
+ *
+ * \param[in]      chain_count The chains of the table
+ * \return         The size in bytes
+ */
+size_t
+hash_rainbow_file_bytes(size_t chain_count) {
+    return sizeof(hash_rainbow_header_t) + chain_count * sizeof(hash_rainbow_chain_t);
+}
+
+/**
+ * \brief          Destroy the rainbow table, unmapping its file. The file itself is kept
+ *                 for the next run.
+ *
+ * \param[in]      rainbow The table to destroy, NULL is ignored
+ */
+void
+hash_rainbow_destroy(hash_rainbow_t* rainbow) {
+    if (!rainbow) {
+        return;
+    }
+
+    mapped_file_close(rainbow->map);
+    free(rainbow->built);
+    free(rainbow);
+}
@@ -0,0 +1,120 @@
+/**
+ * \file            hash_collision_rainbow.h
+ * \brief           Header file for hash_collision_rainbow.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_COLLISION_RAINBOW_H
+#define HASH_COLLISION_RAINBOW_H
+
+#include <glib.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_config.h"
+
+#include "../../utils/mapped_file.h"
+
+/**
+ * \brief          The fewest digest bits a rainbow table inverts, smaller spaces are
+ *                 searched faster than the table is built
+ */
+#define BH_RAINBOW_MIN_BITS 16
+
+/**
+ * \brief          The most digest bits a rainbow table inverts, the points are read into
+ *                 64 bits and an input of 5 bytes covers them
+ */
+#define BH_RAINBOW_MAX_BITS 40
+
+/**
+ * \brief          The bytes of the input of the widest point
+ */
+#define BH_RAINBOW_MAX_INPUT_BYTES ((BH_RAINBOW_MAX_BITS + 7) / 8)
+
+/**
+ * \brief          The chains a worker builds as one job
+ */
+#define BH_RAINBOW_CHUNK_SIZE 16
+
+/**
+ * \brief          The first bytes of a rainbow table file
+ */
+#define BH_RAINBOW_MAGIC "BHRAINB1"
+
+/**
+ * \brief          The header of a rainbow table file, the chains sorted by their end follow
+ */
+typedef struct {
+    char magic[8];         ///< BH_RAINBOW_MAGIC, without its terminator
+    uint32_t hash_id;      ///< The hash function the chains were built with
+    uint32_t bits;         ///< The digest bits, the size of the point space
+    uint32_t chain_length; ///< The hashes of every chain
+    uint32_t reserved;     ///< Zero, keeps the chains aligned
+    uint64_t chain_count;  ///< The chains that follow
+} hash_rainbow_header_t;
+
+/**
+ * \brief          One chain of a rainbow table, only its two ends are kept
+ */
+typedef struct {
+    uint64_t start; ///< The first point of the chain
+    uint64_t end;   ///< The point after the last reduction
+} hash_rainbow_chain_t;
+
+/**
+ * \brief          A rainbow table over the points of a digest truncated to bits: every
+ *                 chain alternates the hash of a point with a reduction that depends on the
+ *                 column, so two chains only merge when they collide in the same column. The
+ *                 table is built once, saved to a file and memory-mapped by later runs, then
+ *                 answers inversion queries: a truncated digest back to a point hashing to it.
+ */
+typedef struct {
+    enum hash_function_ids hash_id; ///< The hash function of the chains
+    unsigned int bits;              ///< The digest bits, points are below 2^bits
+    unsigned int chain_length;      ///< The hashes of every chain
+    size_t chain_count;             ///< The chains of the table
+    char path[256];                 ///< The file the table is saved to and mapped from
+    hash_rainbow_chain_t* built;    ///< The chains while they are built, NULL once mapped
+    mapped_file_t* map;             ///< The mapped file, NULL until the table is loaded
+    const hash_rainbow_chain_t* chains; ///< The chains of the mapped file, sorted by end
+    bool loaded;                    ///< Whether the file existed and the build was skipped
+    int next_job;                   ///< The next build job or query to take, atomic
+    gint64 built_at;                ///< Monotonic time the build finished, 0 when loaded
+    gint64 lookups_started_at;      ///< Monotonic time the first query started
+    unsigned int query_count;       ///< The inversion queries to answer
+    int queries_done;               ///< The queries answered, atomic
+    int solved;                     ///< The queries inverted, atomic
+    int false_alarms;               ///< The matching ends whose chain did not hold the digest
+    guint64 lookup_hashes;          ///< The hashes of every query, under the result mutex
+    bool has_example;               ///< Whether an inverted query is kept as the example
+    uint64_t example_target;        ///< The truncated digest of the example
+    uint64_t example_preimage;      ///< The point found hashing to it
+} hash_rainbow_t;
+
+hash_rainbow_t* hash_rainbow_create(enum hash_function_ids hash_id, unsigned int bits,
+                                    unsigned int chain_length, size_t chain_count,
+                                    unsigned int query_count);
+bool hash_rainbow_load(hash_rainbow_t* rainbow);
+bool hash_rainbow_begin_build(hash_rainbow_t* rainbow);
+bool hash_rainbow_finish_build(hash_rainbow_t* rainbow);
+uint64_t hash_rainbow_start_point(const hash_rainbow_t* rainbow, size_t index);
+uint64_t hash_rainbow_reduce(const hash_rainbow_t* rainbow, unsigned int column,
+                             uint64_t value);
+size_t hash_rainbow_point_input(const hash_rainbow_t* rainbow, uint64_t point, uint8_t* input);
+size_t hash_rainbow_find(const hash_rainbow_t* rainbow, uint64_t end, size_t* first);
+double hash_rainbow_success_rate(unsigned int bits, unsigned int chain_length,
+                                 size_t chain_count);
+size_t hash_rainbow_file_bytes(size_t chain_count);
+void hash_rainbow_destroy(hash_rainbow_t* rainbow);
+
+#endif
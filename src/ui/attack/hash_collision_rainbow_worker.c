@@ -0,0 +1,232 @@
+/**
+ * \file            hash_collision_rainbow_worker.c
+ * \brief           The workers of the rainbow table page, which build the chains and answer the
+ *                  inversion queries
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_rainbow_worker.h"
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Hash a point of a rainbow table and truncate the digest to its bits
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      worker_id The id of the worker hashing the point
+ * \param[in]      point The point
+ * \param[out]     value Receives the truncated digest
+ * \return         false when the hash failed and the error is registered, true otherwise
+ */
+static bool
+rainbow_hash_point(hash_collision_context_t* ctx, unsigned int worker_id, uint64_t point,
+                   uint64_t* value) {
+    hash_rainbow_t* rainbow = ctx->rainbow;
+    uint8_t input[BH_RAINBOW_MAX_INPUT_BYTES];
+    size_t input_len = hash_rainbow_point_input(rainbow, point, input);
+
+    char hash_hex[BH_HASH_MAX_HEX];
+    if (!compute_hash(rainbow->hash_id, input, input_len, hash_hex)) {
+        REGISTER_ERROR_FUNC(ctx, worker_id, ERROR_HASH_COMPUTATION,
+                            "Hash function returned invalid result");
+        return false;
+    }
+
+    *value = hash_prefix_head(hash_hex) >> (64 - rainbow->bits);
+    return true;
+}
+
+/**
+ * \brief          Walk a rainbow chain over some of its columns, hashing the point and
+ *                 reducing the digest with the reduction of every column
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      worker_id The id of the worker walking the chain
+ * \param[in]      point The point before the first column of the walk
+ * \param[in]      first_column The first column to walk
+ * \param[in]      last_column The column the walk stops before
+ * \param[out]     end Receives the point after the last column walked
+ * \return         false when a hash failed and the error is registered, true otherwise
+ */
+static bool
+rainbow_walk(hash_collision_context_t* ctx, unsigned int worker_id, uint64_t point,
+             unsigned int first_column, unsigned int last_column, uint64_t* end) {
+    for (unsigned int column = first_column; column < last_column; column++) {
+        uint64_t value;
+        if (!rainbow_hash_point(ctx, worker_id, point, &value)) {
+            return false;
+        }
+        point = hash_rainbow_reduce(ctx->rainbow, column, value);
+    }
+
+    *end = point;
+    return true;
+}
+
+/**
+ * \brief          Invert one truncated digest with a mapped rainbow table. Every column is
+ *                 tried from the last, the cheapest, to the first: the digest is reduced as
+ *                 if it were in that column and walked to the end of the chain. Every chain
+ *                 ending there is walked again from its start to the column, and a point that
+ *                 hashes to the digest is a preimage. A chain that merely merged into the
+ *                 walk is a false alarm.
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      worker_id The id of the worker answering the query
+ * \param[in]      target The truncated digest to invert
+ * \param[out]     preimage Receives a point hashing to the digest
+ * \param[out]     hashes Receives the hashes of the query
+ * \param[out]     false_alarms Receives the false alarms of the query
+ * \return         1 if a preimage was found, 0 if not, -1 when a hash failed and the error is
+ *                 registered
+ */
+static int
+rainbow_invert(hash_collision_context_t* ctx, unsigned int worker_id, uint64_t target,
+               uint64_t* preimage, guint64* hashes, int* false_alarms) {
+    hash_rainbow_t* rainbow = ctx->rainbow;
+    unsigned int length = rainbow->chain_length;
+
+    for (unsigned int column = length; column-- > 0;) {
+        uint64_t end;
+        if (!rainbow_walk(ctx, worker_id, hash_rainbow_reduce(rainbow, column, target),
+                          column + 1, length, &end)) {
+            return -1;
+        }
+        *hashes += length - 1 - column;
+
+        size_t first;
+        size_t count = hash_rainbow_find(rainbow, end, &first);
+        for (size_t i = first; i < first + count; i++) {
+            uint64_t point;
+            uint64_t value;
+            if (!rainbow_walk(ctx, worker_id, rainbow->chains[i].start, 0, column, &point)
+                || !rainbow_hash_point(ctx, worker_id, point, &value)) {
+                return -1;
+            }
+            *hashes += column + 1;
+
+            if (value == target) {
+                *preimage = point;
+                return 1;
+            }
+            (*false_alarms)++;
+        }
+    }
+    return 0;
+}
+
+/**************************************************************
+                      EXTERNAL FUNCTIONS
+**************************************************************/
+
+/**
+ * \brief          Run a worker of the build of a rainbow table. The workers take jobs of
+ *                 chains and walk every chain from its start to its end. The last worker to
+ *                 leave sorts the chains, saves and maps the table, then submits the workers
+ *                 of the queries, which are counted in remaining_workers before it leaves.
+ *
+ * \param[in]      worker The data of this worker
+ */
+void
+hash_collision_rainbow_build_worker(WorkerData* worker) {
+    hash_collision_context_t* ctx = worker->ctx;
+    hash_rainbow_t* rainbow = ctx->rainbow;
+    bool ok = true;
+
+    while (ok && !g_atomic_int_get((gint*)&ctx->cancel) && !ctx->error_info->has_error) {
+        size_t first = (size_t)g_atomic_int_add(&rainbow->next_job, 1) * BH_RAINBOW_CHUNK_SIZE;
+        if (first >= rainbow->chain_count) {
+            break;
+        }
+
+        size_t last = first + BH_RAINBOW_CHUNK_SIZE < rainbow->chain_count
+                          ? first + BH_RAINBOW_CHUNK_SIZE
+                          : rainbow->chain_count;
+        for (size_t i = first; ok && i < last; i++) {
+            hash_rainbow_chain_t* chain = &rainbow->built[i];
+            chain->start = hash_rainbow_start_point(rainbow, i);
+            ok = rainbow_walk(ctx, worker->worker_id, chain->start, 0, rainbow->chain_length,
+                              &chain->end);
+        }
+        g_atomic_int_add((gint*)&ctx->result->attempts_made, (gint)(last - first));
+    }
+
+    if (!g_atomic_int_dec_and_test((gint*)&ctx->pass_one_pending)) {
+        return;
+    }
+
+    if (g_atomic_int_get((gint*)&ctx->cancel) || ctx->error_info->has_error) {
+        return;
+    }
+
+    if (!hash_rainbow_finish_build(rainbow)) {
+        REGISTER_ERROR_FUNC(ctx, worker->worker_id, ERROR_TABLE_FILE,
+                            "The rainbow table could not be saved and mapped");
+        return;
+    }
+
+    rainbow->built_at = g_get_monotonic_time();
+    rainbow->lookups_started_at = rainbow->built_at;
+    g_atomic_int_set(&rainbow->next_job, 0);
+    hash_collision_submit_workers(ctx, HASH_PASS_RAINBOW_LOOKUP);
+}
+
+/**
+ * \brief          Run a worker of the queries of a mapped rainbow table. The workers take
+ *                 the queries one at a time: the target of a query is the truncated digest of
+ *                 a point picked from the run seed, and the table is asked for any point that
+ *                 hashes to it.
+ *
+ * \param[in]      worker The data of this worker
+ */
+void
+hash_collision_rainbow_lookup_worker(WorkerData* worker) {
+    hash_collision_context_t* ctx = worker->ctx;
+    hash_rainbow_t* rainbow = ctx->rainbow;
+    uint64_t mask = (UINT64_C(1) << rainbow->bits) - 1;
+
+    while (!g_atomic_int_get((gint*)&ctx->cancel) && !ctx->error_info->has_error) {
+        unsigned int query = (unsigned int)g_atomic_int_add(&rainbow->next_job, 1);
+        if (query >= rainbow->query_count) {
+            break;
+        }
+
+        uint64_t secret = ((query + UINT64_C(1)) * UINT64_C(0x9E3779B97F4A7C15) ^ ctx->run_seed)
+                          & mask;
+        uint64_t target;
+        if (!rainbow_hash_point(ctx, worker->worker_id, secret, &target)) {
+            break;
+        }
+
+        uint64_t preimage = 0;
+        guint64 hashes = 1;
+        int false_alarms = 0;
+        int found =
+            rainbow_invert(ctx, worker->worker_id, target, &preimage, &hashes, &false_alarms);
+        if (found < 0) {
+            break;
+        }
+
+        g_mutex_lock(ctx->result_mutex);
+        rainbow->lookup_hashes += hashes;
+        rainbow->false_alarms += false_alarms;
+        if (found && !rainbow->has_example) {
+            rainbow->has_example = true;
+            rainbow->example_target = target;
+            rainbow->example_preimage = preimage;
+        }
+        g_mutex_unlock(ctx->result_mutex);
+
+        if (found) {
+            g_atomic_int_inc(&rainbow->solved);
+        }
+        g_atomic_int_inc(&rainbow->queries_done);
+    }
+}
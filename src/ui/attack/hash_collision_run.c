@@ -0,0 +1,292 @@
+/**
+ * \file            hash_collision_run.c
+ * \brief           The parts of a run the workers of every mode share: the inputs of a worker,
+ *                  the hashing of the inputs, the collisions found and the walks of iterated
+ *                  hashes
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_run.h"
+
+/**************************************************************
+                      EXTERNAL FUNCTIONS
+**************************************************************/
+
+/**
+ * \brief          Get the input of an attempt of a worker when the run does not draw random
+ *                 inputs: the line of the wordlist, read where it is mapped, or the counter
+ *                 input, zero-filled to the fixed length of the block inputs. The lines are
+ *                 numbered over the workers like their attempts.
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      worker_id The worker the input belongs to
+ * \param[in]      index The index of the input among the inputs of the worker
+ * \param[out]     buffer Receives the counter input, at least BH_INPUT_BUFFER_BYTES bytes
+ * \param[out]     len Receives the length of the input in bytes
+ * \return         The input, or NULL when the run draws random inputs
+ */
+const uint8_t*
+deterministic_input(const hash_collision_context_t* ctx, unsigned int worker_id, guint32 index,
+                    uint8_t* buffer, size_t* len) {
+    switch (ctx->input_mode) {
+        case HASH_INPUTS_WORDLIST:
+            return hash_wordlist_line(ctx->wordlist,
+                                      hash_collision_worker_first_attempt(ctx->max_attempts,
+                                                                          ctx->worker_count,
+                                                                          worker_id)
+                                          + (size_t)index,
+                                      len);
+        case HASH_INPUTS_COUNTER:
+            *len = generate_counter_input(ctx->run_seed, worker_id, index, buffer);
+            return buffer;
+        case HASH_INPUTS_BLOCK:
+            generate_counter_input(ctx->run_seed, worker_id, index, buffer);
+            memset(buffer + BH_COUNTER_INPUT_BYTES, 0,
+                   ctx->block_input_bytes - BH_COUNTER_INPUT_BYTES);
+            *len = ctx->block_input_bytes;
+            return buffer;
+        default: return NULL;
+    }
+}
+
+/**
+ * \brief          Get the input with a given index of a worker for the strategies that
+ *                 regenerate their inputs from the index alone
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      worker_id The worker the input belongs to
+ * \param[in]      index The index of the input among the inputs of the worker
+ * \param[out]     buffer Receives a generated input, at least BH_INPUT_BUFFER_BYTES bytes
+ * \param[out]     len Receives the length of the input in bytes
+ * \return         The input, in buffer or in the wordlist
+ */
+const uint8_t*
+generate_run_input(const hash_collision_context_t* ctx, unsigned int worker_id, guint32 index,
+                   uint8_t* buffer, size_t* len) {
+    const uint8_t* input = deterministic_input(ctx, worker_id, index, buffer, len);
+    if (!input) {
+        *len = generate_indexed_input(ctx->run_seed, worker_id, index, buffer, 4, 31);
+        input = buffer;
+    }
+    return input;
+}
+
+/**
+ * \brief          Hash an input of the table, compact and two-pass workers, through the
+ *                 single-block kernel when the run makes block inputs
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      input The input to hash
+ * \param[in]      input_len The length of the input in bytes
+ * \param[out]     hash_hex A buffer of BH_HASH_MAX_HEX bytes the hexadecimal digest is
+ *                 written to
+ * \return         true on success, false when the hash function failed
+ */
+bool
+hash_run_input(const hash_collision_context_t* ctx, const uint8_t* input, size_t input_len,
+               char* hash_hex) {
+    if (ctx->input_mode == HASH_INPUTS_BLOCK) {
+        return compute_block_hash(ctx->hash_id, &ctx->block_kernel, input, hash_hex);
+    }
+    return compute_hash(ctx->hash_id, input, input_len, hash_hex);
+}
+
+/**
+ * \brief          Hash an input of the sharded workers into its binary digest, through the
+ *                 single-block kernel when the run makes block inputs
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      input The input to hash
+ * \param[in]      input_len The length of the input in bytes
+ * \param[out]     digest A buffer of BH_HASH_MAX_DIGEST_BYTES bytes the digest is written to
+ * \return         true on success, false when the hash function failed
+ */
+bool
+hash_run_digest(const hash_collision_context_t* ctx, const uint8_t* input, size_t input_len,
+                uint8_t* digest) {
+    if (ctx->input_mode == HASH_INPUTS_BLOCK && ctx->block_kernel.block_bytes != 0) {
+        hash_block_kernel_hash(&ctx->block_kernel, input, digest);
+        return true;
+    }
+    return get_hash_config(ctx->hash_id)->digest(input, input_len, digest);
+}
+
+/**
+ * \brief          Hash a batch of inputs of the table and compact workers, through the batch
+ *                 of the single-block kernel when the run makes block inputs and through the
+ *                 batch function of the hash function otherwise
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      inputs The inputs to hash
+ * \param[in]      input_lens The length of every input in bytes
+ * \param[in]      count The number of inputs
+ * \param[out]     hash_hexes The buffers of BH_HASH_MAX_HEX bytes the hexadecimal digest of
+ *                 every input is written to
+ * \return         true on success, false when the hash function failed
+ */
+bool
+hash_run_batch(const hash_collision_context_t* ctx, const uint8_t* const* inputs,
+               const size_t* input_lens, unsigned int count, char* const* hash_hexes) {
+    // The block inputs of a hash without a kernel are the counter inputs, hashed as they are
+    if (ctx->input_mode != HASH_INPUTS_BLOCK || ctx->block_kernel.block_bytes == 0) {
+        return compute_hash_batch(ctx->hash_id, inputs, input_lens, count, hash_hexes);
+    }
+    return compute_block_hash_batch(ctx->hash_id, &ctx->block_kernel, inputs, count, hash_hexes);
+}
+
+/**
+ * \brief          Get the number of bytes of a point of a walk, the hex characters of a
+ *                 digest. The walks hash the hex digest rather than its bytes: the toy hashes
+ *                 are permutations of inputs as long as their digest, and a walk through a
+ *                 permutation only ever finds cycles without a collision.
+ *
+ * \param[in]      hash_id The hash function of the run
+ * \return         The number of bytes
+ */
+size_t
+walk_point_length(enum hash_function_ids hash_id) {
+    return get_hash_hex_length(hash_id) - 1; // Without the null terminator
+}
+
+/**
+ * \brief          Turn a digest into the next point of a walk
+ *
+ * \param[in]      hash_hex The hexadecimal string representation of the digest
+ * \param[out]     point Receives the hex characters, walk_point_length of them
+ */
+void
+walk_point_from_hex(const char* hash_hex, uint8_t* point) {
+    memcpy(point, hash_hex, strlen(hash_hex));
+}
+
+/**
+ * \brief          Store the collision in the result struct, unless another worker has
+ *                 already stored one.
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      first_input The input that was stored in the table first
+ * \param[in]      second_input The input of the current attempt
+ * \param[in]      hash_hex The digest shared by both inputs
+ */
+void
+record_collision(hash_collision_context_t* ctx, const char* first_input, const char* second_input,
+                 const char* hash_hex) {
+    g_mutex_lock(ctx->result_mutex);
+    if (!ctx->result->collision_found) { // First to find collision
+        ctx->result->collision_found = true;
+        ctx->result->collision_input_1 = strdup(first_input);
+        ctx->result->collision_input_2 = strdup(second_input);
+        ctx->result->collision_hash_hex = strdup(hash_hex);
+    }
+    g_mutex_unlock(ctx->result_mutex);
+}
+
+/**
+ * \brief          Check whether the workers should stop, because the run was cancelled or
+ *                 a collision was found. This takes the result mutex, so the sharded worker
+ *                 only calls it once per batch and while it waits.
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \return         true if the workers should stop, false otherwise
+ */
+bool
+hash_collision_run_stopping(hash_collision_context_t* ctx) {
+    if (g_atomic_int_get((gint*)&ctx->cancel)) {
+        return true;
+    }
+
+    g_mutex_lock(ctx->result_mutex);
+    bool found = ctx->result->collision_found;
+    g_mutex_unlock(ctx->result_mutex);
+    return found;
+}
+
+/**
+ * \brief          Hash a point and replace it with the next point of the walk. The hashes
+ *                 made here are not attempts, the distinguished points strategy uses it to
+ *                 walk merged trails again.
+ *
+ * \param[in]      ctx The shared context of the simulation
+ * \param[in]      worker_id The id of the walking worker, to report errors
+ * \param[in,out]  point The point to hash, replaced by the next point
+ * \param[in]      point_length The bytes of a point
+ * \param[out]     hash_hex A buffer of BH_HASH_MAX_HEX bytes the digest of the point is
+ *                 written to
+ * \return         true on success, false when the hash failed and the error is registered
+ */
+bool
+walk_hash(hash_collision_context_t* ctx, unsigned int worker_id, uint8_t* point,
+          size_t point_length, char* hash_hex) {
+    if (!compute_hash(ctx->hash_id, point, point_length, hash_hex)) {
+        REGISTER_ERROR_FUNC(ctx, worker_id, ERROR_HASH_COMPUTATION,
+                            "Hash function returned invalid result");
+        return false;
+    }
+
+    walk_point_from_hex(hash_hex, point);
+    return true;
+}
+
+/**
+ * \brief          Make one attempt of a walk: hash the point and replace it with the next.
+ *
+ * \param[in,out]  walker The walker making the attempt
+ * \param[in,out]  point The point to hash, replaced by the next point
+ * \param[out]     hash_hex A buffer of BH_HASH_MAX_HEX bytes the digest of the point is
+ *                 written to
+ * \return         true on success, false when the walker is out of attempts, the run is
+ *                 stopping or the hash failed
+ */
+bool
+walker_step(hash_walker_t* walker, uint8_t* point, char* hash_hex) {
+    if (walker->attempts >= walker->max_attempts) {
+        return false;
+    }
+
+    if (walker->pending == BH_WALK_SYNC_INTERVAL) {
+        g_atomic_int_add((gint*)&walker->ctx->result->attempts_made, (gint)walker->pending);
+        walker->pending = 0;
+        if (hash_collision_run_stopping(walker->ctx)) {
+            return false;
+        }
+    }
+
+    if (!walk_hash(walker->ctx, walker->worker_id, point, walker->point_length, hash_hex)) {
+        return false;
+    }
+    walker->attempts++;
+    walker->pending++;
+    return true;
+}
+
+/**
+ * \brief          Keep the leading bits of a hex digest: its leading hex characters, with the
+ *                 bits after the truncation cleared in the last one
+ *
+ * \param[in]      hash_hex The digest in hex, at least bits long
+ * \param[in]      bits The leading bits to keep, at most 64
+ * \param[out]     truncated A buffer of 17 characters the truncated digest is written to
+ * \return         truncated
+ */
+char*
+truncate_hex_digest(const char* hash_hex, unsigned int bits, char* truncated) {
+    unsigned int hex_length = (bits + 3) / 4;
+    memcpy(truncated, hash_hex, hex_length);
+    truncated[hex_length] = '\0';
+
+    unsigned int spare_bits = hex_length * 4 - bits;
+    if (spare_bits) {
+        static const char hex_digits[] = "0123456789ABCDEF";
+        char* last = &truncated[hex_length - 1];
+        unsigned int nibble = *last >= 'a' ? *last - 'a' + 10
+                              : *last >= 'A' ? *last - 'A' + 10
+                                             : *last - '0';
+        *last = hex_digits[nibble & (0xF << spare_bits) & 0xF];
+    }
+    return truncated;
+}
@@ -0,0 +1,65 @@
+/**
+ * \file            hash_collision_run.h
+ * \brief           Header file for hash_collision_run.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_COLLISION_RUN_H
+#define HASH_COLLISION_RUN_H
+
+#include "hash_collision_compute.h"
+
+/**
+ * \brief          The outcome of checking one digest against the shared tables
+ */
+typedef enum {
+    WORKER_STEP_CONTINUE = 0, ///< Nothing found, continue with the next attempt
+    WORKER_STEP_STOP,         ///< A collision is found (by this or another worker), stop
+    WORKER_STEP_INSERT_FAILED ///< The digest could not be stored, stop with an error
+} worker_step_t;
+
+/**
+ * \brief          The state of one worker walking iterated hashes, for the distinguished
+ *                 points and cycle strategies. Every hash of a walk is one attempt.
+ */
+typedef struct {
+    hash_collision_context_t* ctx; ///< The shared context of the simulation
+    unsigned int worker_id;        ///< The id of the walking worker
+    size_t point_length;           ///< The bytes of a point, from walk_point_length
+    unsigned int attempts;         ///< The hashes made so far
+    unsigned int max_attempts;     ///< The hashes the worker may make
+    unsigned int pending;          ///< The hashes not yet added to the shared attempt count
+} hash_walker_t;
+
+/**
+ * \brief          The number of hashes a walker makes between two updates of the shared
+ *                 attempt count, which is also when it checks whether the run is stopping
+ */
+#define BH_WALK_SYNC_INTERVAL 256
+
+const uint8_t* deterministic_input(const hash_collision_context_t* ctx, unsigned int worker_id,
+                                   guint32 index, uint8_t* buffer, size_t* len);
+const uint8_t* generate_run_input(const hash_collision_context_t* ctx, unsigned int worker_id,
+                                  guint32 index, uint8_t* buffer, size_t* len);
+bool hash_run_input(const hash_collision_context_t* ctx, const uint8_t* input, size_t input_len,
+                    char* hash_hex);
+bool hash_run_digest(const hash_collision_context_t* ctx, const uint8_t* input, size_t input_len,
+                     uint8_t* digest);
+bool hash_run_batch(const hash_collision_context_t* ctx, const uint8_t* const* inputs,
+                    const size_t* input_lens, unsigned int count, char* const* hash_hexes);
+size_t walk_point_length(enum hash_function_ids hash_id);
+void walk_point_from_hex(const char* hash_hex, uint8_t* point);
+void record_collision(hash_collision_context_t* ctx, const char* first_input,
+                      const char* second_input, const char* hash_hex);
+bool hash_collision_run_stopping(hash_collision_context_t* ctx);
+bool walk_hash(hash_collision_context_t* ctx, unsigned int worker_id, uint8_t* point,
+               size_t point_length, char* hash_hex);
+bool walker_step(hash_walker_t* walker, uint8_t* point, char* hash_hex);
+char* truncate_hex_digest(const char* hash_hex, unsigned int bits, char* truncated);
+
+#endif
@@ -0,0 +1,322 @@
+/**
+ * \file            hash_collision_shard.c
+ * \brief           Sharded digest ownership for the hash collision workers. Each worker
+ *                  owns the digests whose top bits select its shard, and every other
+ *                  worker routes those digests to it through a lock-free single producer,
+ *                  single consumer ring. A shard table has exactly one writer, so the
+ *                  probe path needs neither a mutex nor atomics.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_shard.h"
+
+/****************************************************************
+                       EXTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Create the shards and the rings between every pair of workers.
+ *                 You should free the returned engine using `hash_shard_engine_destroy`
+ *                 when done.
+ *
+ * \param[in]      shard_count The number of shards, one per worker
+ * \param[in]      expected_entries The number of digests expected over all shards
+ * \param[in]      layout The layout of the table of every shard
+ * \param[in]      with_filter Whether every shard gets a blocked Bloom prefilter
+ * \param[in]      hasher The hasher that places the digests in the table of every shard
+ * \param[in]      digest_bytes The bytes of a binary digest of the hash function, the part
+ *                 of a record the rings copy
+ * \return         A pointer to the newly created engine, or NULL on memory allocation
+ *                 failure
+ */
+hash_shard_engine_t*
+hash_shard_engine_create(int shard_count, size_t expected_entries, hash_table_layout_t layout,
+                         bool with_filter, const hash_bucket_hasher_t* hasher,
+                         size_t digest_bytes) {
+    if (shard_count < 1) {
+        shard_count = 1;
+    }
+
+    hash_shard_engine_t* engine = calloc(1, sizeof(hash_shard_engine_t));
+    if (!engine) {
+        return NULL;
+    }
+
+    engine->shard_count = shard_count;
+    engine->record_bytes = hash_shard_record_bytes(digest_bytes);
+    engine->shards = calloc(shard_count, sizeof(hash_digest_store_t));
+    engine->rings = calloc((size_t)shard_count * shard_count, sizeof(shard_ring_t));
+    if (!engine->shards || !engine->rings) {
+        hash_shard_engine_destroy(engine);
+        return NULL;
+    }
+
+    // Every shard sees about 1 / shard_count of the digests
+    size_t shard_entries = expected_entries / shard_count + 1;
+    for (int i = 0; i < shard_count; i++) {
+        if (!hash_digest_store_init(&engine->shards[i], layout, shard_entries, with_filter,
+                                    hasher)) {
+            hash_shard_engine_destroy(engine);
+            return NULL;
+        }
+    }
+
+    // A worker never routes a digest to its own shard, so the diagonal rings stay empty
+    for (int producer = 0; producer < shard_count; producer++) {
+        for (int consumer = 0; consumer < shard_count; consumer++) {
+            if (producer == consumer) {
+                continue;
+            }
+
+            shard_ring_t* ring = hash_shard_ring(engine, producer, consumer);
+            ring->record_bytes = engine->record_bytes;
+            ring->slots = malloc(BH_SHARD_RING_CAPACITY * ring->record_bytes);
+            if (!ring->slots) {
+                hash_shard_engine_destroy(engine);
+                return NULL;
+            }
+        }
+    }
+
+    return engine;
+}
+
+/**
+ * \brief          Get the shard that owns a digest. The top 32 bits of the digest are
+ *                 scaled to the shard count with a multiply and shift, and digests
+ *                 shorter than 32 bits (the ToyHash outputs) are left aligned first so
+ *                 their top bits still select the shard.
+ *
+ * \param[in]      engine The engine the shard belongs to
+ * \param[in]      hash_hex The hexadecimal string representation of the digest
+ * \return         The id of the owning shard, 0 to shard_count - 1
+ */
+unsigned int
+hash_shard_owner(const hash_shard_engine_t* engine, const char* hash_hex) {
+    uint32_t top = 0;
+    unsigned short nibbles = 0;
+    for (; nibbles < 8 && hash_hex[nibbles] != '\0'; nibbles++) {
+        char c = hash_hex[nibbles];
+        uint32_t nibble = 0;
+        if (c >= '0' && c <= '9') {
+            nibble = c - '0';
+        } else if (c >= 'A' && c <= 'F') {
+            nibble = c - 'A' + 10;
+        } else if (c >= 'a' && c <= 'f') {
+            nibble = c - 'a' + 10;
+        }
+        top = (top << 4) | nibble;
+    }
+
+    if (nibbles == 0) {
+        return 0;
+    }
+    if (nibbles < 8) {
+        top <<= 4 * (8 - nibbles);
+    }
+
+    return (unsigned int)(((uint64_t)top * (uint64_t)engine->shard_count) >> 32);
+}
+
+/**
+ * \brief          Get the ring a producer uses to route digests to a consumer shard
+ *
+ * \param[in]      engine The engine the ring belongs to
+ * \param[in]      producer The id of the worker that computed the digests
+ * \param[in]      consumer The id of the worker that owns the digests
+ * \return         Pointer to the ring
+ */
+shard_ring_t*
+hash_shard_ring(hash_shard_engine_t* engine, int producer, int consumer) {
+    return &engine->rings[(size_t)producer * engine->shard_count + consumer];
+}
+
+/**
+ * \brief          Get the bytes a record takes in a ring: its index and the digest bytes of
+ *                 the hash function, not the room shard_record_t keeps for the longest digest
+ *
+ * \param[in]      digest_bytes The bytes of a binary digest of the hash function
+ * \return         The bytes of a ring slot
+ */
+size_t
+hash_shard_record_bytes(size_t digest_bytes) {
+    return sizeof(guint32) + digest_bytes;
+}
+
+/**
+ * \brief          Publish a batch of records to a ring. The slots are written first and
+ *                 the tail is published once for the whole batch, so the consumer cache
+ *                 line is only invalidated once per batch. Must only be called by the
+ *                 producer of the ring.
+ *
+ * \param[in]      ring The ring to publish to
+ * \param[in]      records The records to publish, copied into the slots
+ * \param[in]      count The number of records to publish
+ * \return         The number of records published, less than count when the ring is full
+ */
+unsigned int
+shard_ring_push_batch(shard_ring_t* ring, const shard_record_t* records, unsigned int count) {
+    guint tail = (guint)ring->tail; // Only this producer writes tail
+    guint head = (guint)g_atomic_int_get(&ring->head);
+
+    guint free_slots = BH_SHARD_RING_CAPACITY - (tail - head);
+    if (count > free_slots) {
+        count = free_slots;
+    }
+
+    size_t digest_bytes = ring->record_bytes - sizeof(guint32);
+    for (unsigned int i = 0; i < count; i++) {
+        uint8_t* slot =
+            ring->slots + ((tail + i) & (BH_SHARD_RING_CAPACITY - 1)) * ring->record_bytes;
+        memcpy(slot, &records[i].index, sizeof(guint32));
+        memcpy(slot + sizeof(guint32), records[i].digest, digest_bytes);
+    }
+
+    if (count > 0) {
+        g_atomic_int_set(&ring->tail, (gint)(tail + count));
+    }
+    return count;
+}
+
+/**
+ * \brief          Take every published record from a ring, up to max_count. Must only
+ *                 be called by the consumer of the ring.
+ *
+ * \param[in]      ring The ring to consume from
+ * \param[out]     records Receives the records, copied out of the slots
+ * \param[in]      max_count The capacity of records
+ * \return         The number of records taken
+ */
+unsigned int
+shard_ring_pop_batch(shard_ring_t* ring, shard_record_t* records, unsigned int max_count) {
+    guint head = (guint)ring->head; // Only this consumer writes head
+    guint tail = (guint)g_atomic_int_get(&ring->tail);
+
+    guint count = tail - head;
+    if (count > max_count) {
+        count = max_count;
+    }
+
+    size_t digest_bytes = ring->record_bytes - sizeof(guint32);
+    for (guint i = 0; i < count; i++) {
+        const uint8_t* slot =
+            ring->slots + ((head + i) & (BH_SHARD_RING_CAPACITY - 1)) * ring->record_bytes;
+        memcpy(&records[i].index, slot, sizeof(guint32));
+        memcpy(records[i].digest, slot + sizeof(guint32), digest_bytes);
+    }
+
+    if (count > 0) {
+        g_atomic_int_set(&ring->head, (gint)(head + count));
+    }
+    return count;
+}
+
+/**
+ * \brief          Get the number of bytes used by the prefilter bits of every shard
+ *
+ * \param[in]      engine The engine to measure
+ * \return         The size of all shard filters in bytes
+ */
+size_t
+hash_shard_engine_filter_bytes(const hash_shard_engine_t* engine) {
+    size_t bytes = 0;
+    for (int i = 0; i < engine->shard_count; i++) {
+        bytes += hash_filter_memory_size(engine->shards[i].filter);
+    }
+    return bytes;
+}
+
+/**
+ * \brief          Get the number of bytes used by the tables of every shard. Only call
+ *                 this once the workers are done writing their shards.
+ *
+ * \param[in]      engine The engine to measure
+ * \return         The size of all shard tables in bytes
+ */
+size_t
+hash_shard_engine_table_bytes(const hash_shard_engine_t* engine) {
+    size_t bytes = 0;
+    for (int i = 0; i < engine->shard_count; i++) {
+        bytes += hash_digest_store_table_bytes(&engine->shards[i]);
+    }
+    return bytes;
+}
+
+/**
+ * \brief          Get the number of bytes an engine would allocate once the expected number
+ *                 of digests are inserted, without creating it: the store of every shard
+ *                 and the rings between every pair of workers
+ *
+ * \param[in]      shard_count The number of shards, one per worker
+ * \param[in]      expected_entries The number of digests of all shards together
+ * \param[in]      layout The layout of the table of every shard
+ * \param[in]      with_filter Whether every shard has a blocked Bloom prefilter
+ * \param[in]      entry_bytes The average bytes of the digest and input of an entry, with
+ *                 both null terminators
+ * \param[in]      digest_bytes The bytes of a binary digest of the hash function
+ * \return         The size of the engine in bytes
+ */
+size_t
+hash_shard_engine_estimate_bytes(int shard_count, size_t expected_entries,
+                                 hash_table_layout_t layout, bool with_filter,
+                                 size_t entry_bytes, size_t digest_bytes) {
+    if (shard_count < 1) {
+        shard_count = 1;
+    }
+
+    size_t shard_entries = expected_entries / shard_count + 1;
+    size_t rings = (size_t)shard_count * (shard_count - 1);
+    return shard_count
+               * hash_digest_store_estimate_bytes(layout, shard_entries, with_filter, entry_bytes)
+           + rings
+                 * (sizeof(shard_ring_t)
+                    + BH_SHARD_RING_CAPACITY * hash_shard_record_bytes(digest_bytes));
+}
+
+/**
+ * \brief          Add the chain lengths of the table of every shard to a histogram
+ *
+ * \param[in]      engine The engine to measure
+ * \param[in,out]  stats The histogram to add to
+ */
+void
+hash_shard_engine_chain_stats(const hash_shard_engine_t* engine, hash_chain_stats_t* stats) {
+    for (int i = 0; i < engine->shard_count; i++) {
+        hash_digest_store_chain_stats(&engine->shards[i], stats);
+    }
+}
+
+/**
+ * \brief          Destroys the engine, every shard and the rings. The records left in the
+ *                 rings when the run stopped early are dropped with the slots.
+ *
+ * \param[in]      engine The engine to destroy.
+ */
+void
+hash_shard_engine_destroy(hash_shard_engine_t* engine) {
+    // No engine to destroy, return early
+    if (!engine) {
+        return;
+    }
+
+    if (engine->rings) {
+        for (size_t i = 0; i < (size_t)engine->shard_count * engine->shard_count; i++) {
+            free(engine->rings[i].slots);
+        }
+        free(engine->rings);
+    }
+
+    if (engine->shards) {
+        for (int i = 0; i < engine->shard_count; i++) {
+            hash_digest_store_clear(&engine->shards[i]);
+        }
+        free(engine->shards);
+    }
+
+    free(engine);
+}
@@ -0,0 +1,89 @@
+/**
+ * \file            hash_collision_shard.h
+ * \brief           Header file for hash_collision_shard.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_COLLISION_SHARD_H
+#define HASH_COLLISION_SHARD_H
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "hash_collision_table.h"
+
+#include "../../utils/hash_function.h"
+
+/**
+ * \brief          The number of digests a worker collects for one shard before it
+ *                 publishes them to the ring of that shard in a single step
+ */
+#define BH_SHARD_BATCH_SIZE    32
+
+/**
+ * \brief          The number of record slots in every ring, must be a power of two
+ */
+#define BH_SHARD_RING_CAPACITY 1024
+
+/**
+ * \brief          A digest routed from the worker that computed it to the worker that
+ *                 owns its shard. The owner formats the digest and regenerates the input
+ *                 from its index, the producer of the ring being the worker the index
+ *                 belongs to. A ring slot only holds the index and the digest bytes of the
+ *                 hash function, see hash_shard_record_bytes.
+ */
+typedef struct {
+    uint8_t digest[BH_HASH_MAX_DIGEST_BYTES]; ///< The binary digest, as the hash function wrote it
+    guint32 index; ///< The index of the input among the inputs of its worker
+} shard_record_t;
+
+/**
+ * \brief          A lock-free single producer, single consumer ring. The producer only
+ *                 writes tail and the consumer only writes head, and each index sits on
+ *                 its own cache line so the two sides do not invalidate each other.
+ */
+typedef struct {
+    volatile gint tail;                   ///< The next slot the producer writes, only advances
+    char tail_padding[64 - sizeof(gint)]; ///< Keeps tail alone on its cache line
+    volatile gint head;                   ///< The next slot the consumer reads, only advances
+    char head_padding[64 - sizeof(gint)]; ///< Keeps head alone on its cache line
+    uint8_t* slots;                       ///< BH_SHARD_RING_CAPACITY slots of record_bytes
+    size_t record_bytes;                  ///< The bytes of a slot, the index then the digest
+} shard_ring_t;
+
+typedef struct {
+    int shard_count;              ///< The number of shards, one per worker
+    size_t record_bytes;          ///< The bytes a record takes in a ring
+    hash_digest_store_t* shards;  ///< The digests owned by every worker, only the owner writes
+                                  ///< its shard so no lock is needed
+    shard_ring_t* rings;          ///< shard_count * shard_count rings, producer major
+    volatile gint producers_done; ///< The number of workers that routed all their digests
+} hash_shard_engine_t;
+
+hash_shard_engine_t* hash_shard_engine_create(int shard_count, size_t expected_entries,
+                                              hash_table_layout_t layout, bool with_filter,
+                                              const hash_bucket_hasher_t* hasher,
+                                              size_t digest_bytes);
+size_t hash_shard_record_bytes(size_t digest_bytes);
+unsigned int hash_shard_owner(const hash_shard_engine_t* engine, const char* hash_hex);
+shard_ring_t* hash_shard_ring(hash_shard_engine_t* engine, int producer, int consumer);
+unsigned int shard_ring_push_batch(shard_ring_t* ring, const shard_record_t* records,
+                                   unsigned int count);
+unsigned int shard_ring_pop_batch(shard_ring_t* ring, shard_record_t* records,
+                                  unsigned int max_count);
+size_t hash_shard_engine_filter_bytes(const hash_shard_engine_t* engine);
+size_t hash_shard_engine_table_bytes(const hash_shard_engine_t* engine);
+size_t hash_shard_engine_estimate_bytes(int shard_count, size_t expected_entries,
+                                        hash_table_layout_t layout, bool with_filter,
+                                        size_t entry_bytes, size_t digest_bytes);
+void hash_shard_engine_chain_stats(const hash_shard_engine_t* engine, hash_chain_stats_t* stats);
+void hash_shard_engine_destroy(hash_shard_engine_t* engine);
+
+#endif
@@ -11,17 +11,20 @@
 
 #include "hash_collision_table.h"
 
+#include "../../utils/utils.h"
+
 /**
  * \brief          Create a new hash table with the specified number of buckets.
  *                 You should free the returned hash table using `hash_table_destroy`
  *                 when done.
  *
  * \param[in]      bucket_count The number of buckets in the hash table.
+ * \param[in]      hasher The hasher that places the digests, copied into the table
  * \return         A pointer to the newly created hash table, or NULL on memory
  *                 allocation failure
  */
 hash_table_t*
-hash_table_create(size_t bucket_count) {
+hash_table_create(size_t bucket_count, const hash_bucket_hasher_t* hasher) {
     // First, allocate memory for the hash table structure
     hash_table_t* table = malloc(sizeof(hash_table_t));
     if (!table) {
@@ -36,6 +39,9 @@ hash_table_create(size_t bucket_count) {
     }
 
     table->bucket_count = bucket_count;
+    table->entry_count = 0;
+    table->string_bytes = 0;
+    table->hasher = *hasher;
     return table;
 }
 
@@ -48,26 +54,35 @@ hash_table_create(size_t bucket_count) {
  */
 size_t
 simple_hash(const char* str, size_t bucket_count) {
-    size_t hash = 5381;
-    int c;
-    while ((c = *str++)) {               // Loops auto terminates at null character
-        hash = ((hash << 5) + hash) + c; // Multiply by 33 and add the current character
+    return hash_bucket_djb2(str) % bucket_count;
+}
+
+/**
+ * \brief          Get the bucket of a digest with the hasher of the table. djb2 keeps the
+ *                 placement of simple_hash, SipHash uses the key of the run.
+ *
+ * \param[in]      table The hash table the digest belongs to
+ * \param[in]      hash_hex The hexadecimal string representation of the digest
+ * \return         The bucket of the digest
+ */
+static inline size_t
+hash_table_bucket(const hash_table_t* table, const char* hash_hex) {
+    if (table->hasher.mode == HASH_BUCKET_DJB2) {
+        return simple_hash(hash_hex, table->bucket_count);
     }
-    return hash % bucket_count;
+    return hash_bucket_hash(&table->hasher, hash_hex) % table->bucket_count;
 }
 
 /**
- * \brief          Finds an entry in the hash table by its hash value.
- *                 This function searches for a hash value in the hash table and returns the corresponding
- *                 hash_node_t if found, or NULL if not found.
+ * \brief          Walk the chain of one bucket for a hash value
  *
  * \param[in]      table The hash table to search in.
+ * \param[in]      bucket The bucket of hash_hex, from hash_table_bucket
  * \param[in]      hash_hex The hexadecimal string representation of the hash to find.
  * \return         A pointer to the hash_node_t if found, or NULL if not found.
  */
-hash_node_t*
-hash_table_find(hash_table_t* table, const char* hash_hex) {
-    size_t bucket = simple_hash(hash_hex, table->bucket_count);
+static hash_node_t*
+hash_table_find_in_bucket(hash_table_t* table, size_t bucket, const char* hash_hex) {
     hash_node_t* entry = table->buckets[bucket];
 
     while (entry) {
@@ -80,19 +95,17 @@ hash_table_find(hash_table_t* table, const char* hash_hex) {
 }
 
 /**
- * \brief          Inserts a new entry into the hash table.
- *                 This function creates a new hash_node_t, initializes it with the input and hash_hex,
- *                 and inserts it into the appropriate bucket in the hash table.
+ * \brief          Insert a new entry at the head of the chain of one bucket
  *
  * \param[in]      table The hash table to insert into.
+ * \param[in]      bucket The bucket of hash_hex, from hash_table_bucket
  * \param[in]      input The input string that generated the hash.
  * \param[in]      hash_hex The hexadecimal string representation of the hash.
- * \return         true if the insertion was successful, false otherwise (e.g., memory allocation failure).
+ * \return         true if the insertion was successful, false on memory allocation failure.
  */
-bool
-hash_table_insert(hash_table_t* table, const char* input, const char* hash_hex) {
-    size_t bucket = simple_hash(hash_hex, table->bucket_count);
-
+static bool
+hash_table_insert_in_bucket(hash_table_t* table, size_t bucket, const char* input,
+                            const char* hash_hex) {
     hash_node_t* entry = malloc(sizeof(hash_node_t));
     if (!entry) {
         return false;
@@ -109,9 +122,150 @@ hash_table_insert(hash_table_t* table, const char* input, const char* hash_hex)
 
     entry->next = table->buckets[bucket];
     table->buckets[bucket] = entry;
+    table->entry_count++;
+    table->string_bytes += strlen(input) + strlen(hash_hex) + 2;
     return true;
 }
 
+/**
+ * \brief          Finds an entry in the hash table by its hash value.
+ *                 This function searches for a hash value in the hash table and returns the corresponding
+ *                 hash_node_t if found, or NULL if not found.
+ *
+ * \param[in]      table The hash table to search in.
+ * \param[in]      hash_hex The hexadecimal string representation of the hash to find.
+ * \return         A pointer to the hash_node_t if found, or NULL if not found.
+ */
+hash_node_t*
+hash_table_find(hash_table_t* table, const char* hash_hex) {
+    size_t bucket = hash_table_bucket(table, hash_hex);
+    return hash_table_find_in_bucket(table, bucket, hash_hex);
+}
+
+/**
+ * \brief          Inserts a new entry into the hash table.
+ *                 This function creates a new hash_node_t, initializes it with the input and hash_hex,
+ *                 and inserts it into the appropriate bucket in the hash table.
+ *
+ * \param[in]      table The hash table to insert into.
+ * \param[in]      input The input string that generated the hash.
+ * \param[in]      hash_hex The hexadecimal string representation of the hash.
+ * \return         true if the insertion was successful, false otherwise (e.g., memory allocation failure).
+ */
+bool
+hash_table_insert(hash_table_t* table, const char* input, const char* hash_hex) {
+    size_t bucket = hash_table_bucket(table, hash_hex);
+    return hash_table_insert_in_bucket(table, bucket, input, hash_hex);
+}
+
+/**
+ * \brief          Look up a batch of digests and insert the ones not found, in order.
+ *                 A single lookup is a chain of dependent cache misses: the bucket slot,
+ *                 then the node, then its key. The batch first computes every bucket and
+ *                 prefetches all slots, then all chain heads, then all head keys, so the
+ *                 misses of the whole batch overlap before any digest is resolved.
+ *                 Digests are resolved in order, so a digest repeated within the batch
+ *                 finds its earlier copy.
+ *
+ * \param[in]      table The hash table to search in and insert into.
+ * \param[in]      inputs The input strings that generated the hashes.
+ * \param[in]      hash_hexes The hexadecimal string representations of the hashes.
+ * \param[in]      count The number of digests in the batch.
+ * \param[in]      known_new Optional flags of the digests known to be absent (a definite
+ *                 prefilter miss), which are inserted without a lookup. NULL to look up all.
+ * \param[out]     existing Receives the entry found for the digest at the returned index,
+ *                 or NULL when the batch was inserted or an insert failed.
+ * \return         count if every digest was inserted. Otherwise the index of the first
+ *                 digest that was found (existing is set) or failed to insert (existing is
+ *                 NULL), the digests before it are inserted and the ones after it untouched.
+ */
+size_t
+hash_table_lookup_insert_batch(hash_table_t* table, const char* const* inputs,
+                               const char* const* hash_hexes, size_t count,
+                               const bool* known_new, hash_node_t** existing) {
+    size_t buckets[BH_TABLE_BATCH_SIZE];
+    *existing = NULL;
+
+    for (size_t start = 0; start < count; start += BH_TABLE_BATCH_SIZE) {
+        size_t batch = count - start < BH_TABLE_BATCH_SIZE ? count - start : BH_TABLE_BATCH_SIZE;
+
+        // Stage 1: compute every bucket and start loading its slot
+        for (size_t i = 0; i < batch; i++) {
+            buckets[i] = hash_table_bucket(table, hash_hexes[start + i]);
+            BH_PREFETCH(&table->buckets[buckets[i]]);
+        }
+
+        // Stage 2: the slots are arriving, start loading the chain heads they point to
+        for (size_t i = 0; i < batch; i++) {
+            hash_node_t* head = table->buckets[buckets[i]];
+            if (head && !(known_new && known_new[start + i])) {
+                BH_PREFETCH(head);
+            }
+        }
+
+        // Stage 3: start loading the key of every chain head
+        for (size_t i = 0; i < batch; i++) {
+            hash_node_t* head = table->buckets[buckets[i]];
+            if (head && !(known_new && known_new[start + i])) {
+                BH_PREFETCH(head->hash_hex);
+            }
+        }
+
+        // Stage 4: resolve the batch in order
+        for (size_t i = 0; i < batch; i++) {
+            const char* hash_hex = hash_hexes[start + i];
+            if (!(known_new && known_new[start + i])) {
+                *existing = hash_table_find_in_bucket(table, buckets[i], hash_hex);
+                if (*existing) {
+                    return start + i;
+                }
+            }
+
+            if (!hash_table_insert_in_bucket(table, buckets[i], inputs[start + i], hash_hex)) {
+                return start + i;
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * \brief          Get the number of bytes used by the table: the buckets, the nodes and
+ *                 their strings, without the overhead of the allocator
+ *
+ * \param[in]      table The table to measure
+ * \return         The size of the table in bytes, 0 if table is NULL
+ */
+size_t
+hash_table_memory_size(const hash_table_t* table) {
+    if (!table) {
+        return 0;
+    }
+    return (size_t)table->bucket_count * sizeof(hash_node_t*)
+           + table->entry_count * sizeof(hash_node_t) + table->string_bytes;
+}
+
+/**
+ * \brief          Add the chain lengths of the table to a chain length histogram
+ *
+ * \param[in]      table The table to measure, NULL adds nothing
+ * \param[in,out]  stats The histogram, bin i counts the buckets holding i entries
+ */
+void
+hash_table_chain_stats(const hash_table_t* table, hash_chain_stats_t* stats) {
+    if (!table) {
+        return;
+    }
+
+    for (size_t i = 0; i < table->bucket_count; i++) {
+        size_t length = 0;
+        for (const hash_node_t* entry = table->buckets[i]; entry; entry = entry->next) {
+            length++;
+        }
+        hash_chain_stats_add(stats, length, 1);
+    }
+}
+
 /**
  * \brief          Destroys the hash table and frees all its resources.
  *                 This function iterates through each bucket in the hash table, freeing
@@ -151,4 +305,192 @@ hash_table_destroy(hash_table_t* table) {
     // Finally, free the hash table's buckets array and the table itself
     free(table->buckets);
     free(table);
-}
\ No newline at end of file
+}
+
+/**
+ * \brief          Allocate the table of a digest store in the given layout, and its
+ *                 prefilter. Free it using `hash_digest_store_clear` when done.
+ *
+ * \param[out]     store The store to initialise
+ * \param[in]      layout The layout of the table
+ * \param[in]      expected_entries The number of digests expected to be inserted
+ * \param[in]      with_filter Whether a blocked Bloom prefilter is placed in front of the table
+ * \param[in]      hasher The hasher that places the digests in the table
+ * \return         true on success, false on memory allocation failure, in which case
+ *                 nothing is left allocated
+ */
+bool
+hash_digest_store_init(hash_digest_store_t* store, hash_table_layout_t layout,
+                       size_t expected_entries, bool with_filter,
+                       const hash_bucket_hasher_t* hasher) {
+    memset(store, 0, sizeof(*store));
+    store->layout = layout;
+
+    if (layout == HASH_TABLE_CHAINED) {
+        // The load factor (n / table_size) should ideally stay under 0.75
+        store->chained =
+            hash_table_create(next_prime((unsigned int)(expected_entries * 1.3)), hasher);
+    } else {
+        store->flat = hash_flat_table_create(expected_entries, hasher);
+    }
+
+    if (with_filter) {
+        store->filter = hash_filter_create(expected_entries, BH_FILTER_BITS_PER_ENTRY);
+    }
+
+    if ((!store->chained && !store->flat) || (with_filter && !store->filter)) {
+        hash_digest_store_clear(store);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * \brief          Finds the input stored for a digest
+ *
+ * \param[in]      store The store to search in
+ * \param[in]      hash_hex The hexadecimal string representation of the hash to find.
+ * \return         The input stored with the digest, or NULL if not found. The pointer is
+ *                 only valid until the next insert.
+ */
+const char*
+hash_digest_store_find(hash_digest_store_t* store, const char* hash_hex) {
+    if (store->layout == HASH_TABLE_CHAINED) {
+        hash_node_t* entry = hash_table_find(store->chained, hash_hex);
+        return entry ? entry->input : NULL;
+    }
+    return hash_flat_table_find(store->flat, hash_hex);
+}
+
+/**
+ * \brief          Inserts a digest that is not in the store yet. The prefilter is not
+ *                 touched, the callers query it themselves to count its hits.
+ *
+ * \param[in]      store The store to insert into
+ * \param[in]      input The input string that generated the hash.
+ * \param[in]      hash_hex The hexadecimal string representation of the hash.
+ * \return         true if the insertion was successful, false on memory allocation failure.
+ */
+bool
+hash_digest_store_insert(hash_digest_store_t* store, const char* input, const char* hash_hex) {
+    if (store->layout == HASH_TABLE_CHAINED) {
+        return hash_table_insert(store->chained, input, hash_hex);
+    }
+    return hash_flat_table_insert(store->flat, input, hash_hex);
+}
+
+/**
+ * \brief          Look up a batch of digests and insert the ones not found, in order,
+ *                 with the prefetching batch lookup of the layout of the store
+ *
+ * \param[in]      store The store to search in and insert into
+ * \param[in]      inputs The input strings that generated the hashes.
+ * \param[in]      hash_hexes The hexadecimal string representations of the hashes.
+ * \param[in]      count The number of digests in the batch.
+ * \param[in]      known_new Optional flags of the digests known to be absent, which are
+ *                 inserted without a lookup. NULL to look up all.
+ * \param[out]     existing_input Receives the stored input of the digest at the returned
+ *                 index when it was found, or NULL. Only valid until the next insert.
+ * \return         count if every digest was inserted. Otherwise the index of the first
+ *                 digest that was found (existing_input is set) or failed to insert
+ *                 (existing_input is NULL).
+ */
+size_t
+hash_digest_store_lookup_insert_batch(hash_digest_store_t* store, const char* const* inputs,
+                                      const char* const* hash_hexes, size_t count,
+                                      const bool* known_new, const char** existing_input) {
+    if (store->layout == HASH_TABLE_CHAINED) {
+        hash_node_t* entry = NULL;
+        size_t stop = hash_table_lookup_insert_batch(store->chained, inputs, hash_hexes, count,
+                                                     known_new, &entry);
+        *existing_input = entry ? entry->input : NULL;
+        return stop;
+    }
+    return hash_flat_table_lookup_insert_batch(store->flat, inputs, hash_hexes, count,
+                                               known_new, existing_input);
+}
+
+/**
+ * \brief          Get the number of bytes used by the table of the store, without its
+ *                 prefilter
+ *
+ * \param[in]      store The store to measure
+ * \return         The size of the table in bytes
+ */
+size_t
+hash_digest_store_table_bytes(const hash_digest_store_t* store) {
+    return hash_table_memory_size(store->chained) + hash_flat_table_memory_size(store->flat);
+}
+
+/**
+ * \brief          Get the number of bytes a store would allocate once the expected number
+ *                 of digests are inserted, without creating it. Unlike the measured sizes,
+ *                 the chained layout counts the allocator header of its three allocations
+ *                 per entry, since that is memory the run needs as well.
+ *
+ * \param[in]      layout The layout of the table
+ * \param[in]      expected_entries The number of digests
+ * \param[in]      with_filter Whether a blocked Bloom prefilter is placed in front of the table
+ * \param[in]      entry_bytes The average bytes of the digest and input of an entry, with
+ *                 both null terminators
+ * \return         The size of the store in bytes
+ */
+size_t
+hash_digest_store_estimate_bytes(hash_table_layout_t layout, size_t expected_entries,
+                                 bool with_filter, size_t entry_bytes) {
+    size_t bytes = with_filter ? hash_filter_estimate_bytes(expected_entries, 0) : 0;
+    if (layout != HASH_TABLE_CHAINED) {
+        return bytes + hash_flat_table_estimate_bytes(expected_entries, entry_bytes);
+    }
+
+    size_t bucket_count = (size_t)(expected_entries * 1.3) + 1;
+    bytes += bucket_count * sizeof(hash_node_t*);
+    return bytes + expected_entries * (sizeof(hash_node_t) + entry_bytes + 3 * 16);
+}
+
+/**
+ * \brief          Get the number of places the djb2 hash of a digest is reduced to: the
+ *                 bucket count of a chained table, or for a flat table the group count
+ *                 times 128, since the 7 low bits are the tag and the next bits the group.
+ *                 Keys with the same djb2 hash modulo this value share a chain.
+ *
+ * \param[in]      store The store to get the modulus of
+ * \return         The modulus
+ */
+uint64_t
+hash_digest_store_bucket_modulus(const hash_digest_store_t* store) {
+    if (store->layout == HASH_TABLE_CHAINED) {
+        return store->chained->bucket_count;
+    }
+    return (uint64_t)(store->flat->group_mask + 1) << 7;
+}
+
+/**
+ * \brief          Add the chain lengths of the table of the store to a histogram, see
+ *                 hash_table_chain_stats and hash_flat_table_chain_stats for the meaning of
+ *                 the bins of each layout
+ *
+ * \param[in]      store The store to measure
+ * \param[in,out]  stats The histogram to add to
+ */
+void
+hash_digest_store_chain_stats(const hash_digest_store_t* store, hash_chain_stats_t* stats) {
+    hash_table_chain_stats(store->chained, stats);
+    hash_flat_table_chain_stats(store->flat, stats);
+}
+
+/**
+ * \brief          Free the table and the prefilter of a store, and reset it to empty
+ *
+ * \param[in]      store The store to clear
+ */
+void
+hash_digest_store_clear(hash_digest_store_t* store) {
+    hash_table_destroy(store->chained);
+    hash_flat_table_destroy(store->flat);
+    hash_filter_destroy(store->filter);
+
+    store->chained = NULL;
+    store->flat = NULL;
+    store->filter = NULL;
+}
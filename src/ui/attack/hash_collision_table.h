@@ -18,6 +18,26 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "hash_collision_bucket.h"
+#include "hash_collision_filter.h"
+#include "hash_collision_flat.h"
+
+/**
+ * \brief          The number of digests resolved together by hash_table_lookup_insert_batch.
+ *                 Larger batches are split into runs of this size.
+ */
+#define BH_TABLE_BATCH_SIZE 32
+
+/**
+ * \brief          Hint the CPU to start loading the cache line at address. Compiles to
+ *                 nothing where the compiler has no prefetch builtin.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define BH_PREFETCH(address) __builtin_prefetch((address), 0, 3)
+#else
+#define BH_PREFETCH(address) ((void)(address))
+#endif
+
 typedef struct HashNode {
     struct HashNode* next; ///< Pointer to the next node in the linked list
     char* hash_hex;        ///< The hash value of the input
@@ -26,13 +46,58 @@ typedef struct HashNode {
 
 typedef struct {
     hash_node_t** buckets; ///< Pointers to the head of linked lists of the start of the hash table
-    unsigned int bucket_count; ///< The number of nodes in the linked list
+    unsigned int bucket_count;   ///< The number of nodes in the linked list
+    size_t entry_count;          ///< The number of entries stored
+    size_t string_bytes;         ///< The bytes of the digest and input strings of every entry
+    hash_bucket_hasher_t hasher; ///< Hashes the digests to their bucket
 } hash_table_t;
 
-hash_table_t* hash_table_create(size_t bucket_count);
+/**
+ * \brief          The memory layout of a digest table. The values match the option numbers
+ *                 of the table field on the hash collision form.
+ */
+typedef enum {
+    HASH_TABLE_FLAT = 1, ///< Open addressing with 16-slot groups of SIMD matched tags
+    HASH_TABLE_CHAINED   ///< A linked list of hash_node_t per bucket
+} hash_table_layout_t;
+
+/**
+ * \brief          A table of digests in either layout, with its optional prefilter. Only
+ *                 the table of the chosen layout is allocated, the other one stays NULL.
+ */
+typedef struct {
+    hash_table_layout_t layout; ///< The layout of the table
+    hash_table_t* chained;      ///< The table when layout is HASH_TABLE_CHAINED
+    hash_flat_table_t* flat;    ///< The table when layout is HASH_TABLE_FLAT
+    hash_filter_t* filter;      ///< The prefilter in front of the table, NULL when it is off
+} hash_digest_store_t;
+
+hash_table_t* hash_table_create(size_t bucket_count, const hash_bucket_hasher_t* hasher);
 size_t simple_hash(const char* str, size_t bucket_count);
 hash_node_t* hash_table_find(hash_table_t* table, const char* hash_hex);
 bool hash_table_insert(hash_table_t* table, const char* input, const char* hash_hex);
+size_t hash_table_lookup_insert_batch(hash_table_t* table, const char* const* inputs,
+                                      const char* const* hash_hexes, size_t count,
+                                      const bool* known_new, hash_node_t** existing);
+size_t hash_table_memory_size(const hash_table_t* table);
+void hash_table_chain_stats(const hash_table_t* table, hash_chain_stats_t* stats);
 void hash_table_destroy(hash_table_t* table);
 
+bool hash_digest_store_init(hash_digest_store_t* store, hash_table_layout_t layout,
+                            size_t expected_entries, bool with_filter,
+                            const hash_bucket_hasher_t* hasher);
+const char* hash_digest_store_find(hash_digest_store_t* store, const char* hash_hex);
+bool hash_digest_store_insert(hash_digest_store_t* store, const char* input,
+                              const char* hash_hex);
+size_t hash_digest_store_lookup_insert_batch(hash_digest_store_t* store,
+                                             const char* const* inputs,
+                                             const char* const* hash_hexes, size_t count,
+                                             const bool* known_new, const char** existing_input);
+size_t hash_digest_store_table_bytes(const hash_digest_store_t* store);
+size_t hash_digest_store_estimate_bytes(hash_table_layout_t layout, size_t expected_entries,
+                                        bool with_filter, size_t entry_bytes);
+uint64_t hash_digest_store_bucket_modulus(const hash_digest_store_t* store);
+void hash_digest_store_chain_stats(const hash_digest_store_t* store, hash_chain_stats_t* stats);
+void hash_digest_store_clear(hash_digest_store_t* store);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,251 @@
+/**
+ * \file            hash_collision_wordlist.c
+ * \brief           The wordlist inputs of the hash collision page: a corpus with one input per
+ *                  line, mapped into memory and indexed once by several threads. Every thread
+ *                  counts the lines starting in its slice of the corpus, then records the
+ *                  offsets of the indexed lines of its slice from the line number the slices
+ *                  before it end on. Empty lines are not inputs and are skipped.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_wordlist.h"
+
+/**
+ * \brief          The slice of the corpus one indexing thread reads
+ */
+typedef struct {
+    const uint8_t* data; ///< The corpus
+    size_t size;         ///< The bytes of the corpus
+    size_t begin;        ///< The first byte of the slice
+    size_t end;          ///< The byte after the slice
+    size_t line_count;   ///< The lines starting in the slice, set by the first pass
+    size_t first_line;   ///< The number of the first line starting in the slice
+    size_t* starts;      ///< The index the second pass writes the offsets into
+} wordlist_slice_t;
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Check whether the line starting at an offset is empty, a newline or a
+ *                 carriage return and a newline, or the end of the corpus
+ *
+ * \param[in]      data The corpus
+ * \param[in]      size The bytes of the corpus
+ * \param[in]      start The offset of the line
+ * \return         true if the line is empty, false otherwise
+ */
+static inline bool
+wordlist_line_empty(const uint8_t* data, size_t size, size_t start) {
+    if (start >= size || data[start] == '\n') {
+        return true;
+    }
+    return data[start] == '\r' && (start + 1 == size || data[start + 1] == '\n');
+}
+
+/**
+ * \brief          Count the lines starting in a slice that are not empty: the first line of
+ *                 the corpus, and the line after every newline
+ *
+ * \param[in,out]  data The slice, receives line_count
+ * \return         NULL
+ */
+static gpointer
+wordlist_count_lines(gpointer data) {
+    wordlist_slice_t* slice = data;
+    size_t count = 0;
+    if (slice->begin == 0 && !wordlist_line_empty(slice->data, slice->size, 0)) {
+        count++;
+    }
+
+    size_t at = slice->begin;
+    while (at < slice->end) {
+        const uint8_t* newline = memchr(slice->data + at, '\n', slice->end - at);
+        if (!newline) {
+            break;
+        }
+        at = (size_t)(newline + 1 - slice->data);
+        if (!wordlist_line_empty(slice->data, slice->size, at)) {
+            count++;
+        }
+    }
+    slice->line_count = count;
+    return NULL;
+}
+
+/**
+ * \brief          Record the offset of every indexed line starting in a slice, numbering the
+ *                 lines from first_line
+ *
+ * \param[in]      data The slice, with first_line set
+ * \return         NULL
+ */
+static gpointer
+wordlist_record_starts(gpointer data) {
+    wordlist_slice_t* slice = data;
+    size_t line = slice->first_line;
+    if (slice->begin == 0 && !wordlist_line_empty(slice->data, slice->size, 0)) {
+        slice->starts[0] = 0;
+        line++;
+    }
+
+    size_t at = slice->begin;
+    while (at < slice->end) {
+        const uint8_t* newline = memchr(slice->data + at, '\n', slice->end - at);
+        if (!newline) {
+            break;
+        }
+        at = (size_t)(newline + 1 - slice->data);
+        if (wordlist_line_empty(slice->data, slice->size, at)) {
+            continue;
+        }
+        if (line % BH_WORDLIST_INDEX_STRIDE == 0) {
+            slice->starts[line / BH_WORDLIST_INDEX_STRIDE] = at;
+        }
+        line++;
+    }
+    return NULL;
+}
+
+/**
+ * \brief          Run a pass of the index on every slice, one thread per slice
+ *
+ * \param[in]      pass The pass to run
+ * \param[in,out]  slices The slices
+ * \param[in]      count The number of slices
+ */
+static void
+wordlist_run_pass(GThreadFunc pass, wordlist_slice_t* slices, unsigned int count) {
+    GThread* threads[BH_WORDLIST_MAX_THREADS];
+    for (unsigned int i = 1; i < count; i++) {
+        threads[i] = g_thread_new("wordlist-index", pass, &slices[i]);
+    }
+    pass(&slices[0]);
+    for (unsigned int i = 1; i < count; i++) {
+        g_thread_join(threads[i]);
+    }
+}
+
+/****************************************************************
+                       EXTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Map a corpus and index its lines. You should free the returned wordlist
+ *                 using `hash_wordlist_destroy` when done.
+ *
+ * \param[in]      path The path of the corpus
+ * \param[in]      threads The threads that index the corpus, 1 to BH_WORDLIST_MAX_THREADS
+ * \return         A pointer to the wordlist, or NULL if the corpus is missing or has no line
+ *                 or on memory allocation failure
+ */
+hash_wordlist_t*
+hash_wordlist_open(const char* path, unsigned int threads) {
+    hash_wordlist_t* wordlist = calloc(1, sizeof(hash_wordlist_t));
+    if (!wordlist) {
+        return NULL;
+    }
+
+    gint64 started_at = g_get_monotonic_time();
+    wordlist->map = mapped_file_open(path);
+    if (!wordlist->map) {
+        free(wordlist);
+        return NULL;
+    }
+
+    // Small corpora are not worth a thread per slice
+    const uint8_t* data = wordlist->map->data;
+    size_t size = wordlist->map->size;
+    if (threads < 1) {
+        threads = 1;
+    }
+    if (threads > BH_WORDLIST_MAX_THREADS) {
+        threads = BH_WORDLIST_MAX_THREADS;
+    }
+    if (size / threads < 64 * 1024) {
+        threads = (unsigned int)(size / (64 * 1024)) + 1;
+    }
+
+    wordlist_slice_t slices[BH_WORDLIST_MAX_THREADS];
+    for (unsigned int i = 0; i < threads; i++) {
+        slices[i] = (wordlist_slice_t){.data = data,
+                                       .size = size,
+                                       .begin = size / threads * i,
+                                       .end = i + 1 == threads ? size : size / threads * (i + 1)};
+    }
+    wordlist_run_pass(wordlist_count_lines, slices, threads);
+
+    for (unsigned int i = 0; i < threads; i++) {
+        slices[i].first_line = wordlist->lines;
+        wordlist->lines += slices[i].line_count;
+    }
+
+    wordlist->starts =
+        malloc(((wordlist->lines + BH_WORDLIST_INDEX_STRIDE - 1) / BH_WORDLIST_INDEX_STRIDE)
+               * sizeof(size_t));
+    if (wordlist->lines == 0 || !wordlist->starts) {
+        hash_wordlist_destroy(wordlist);
+        return NULL;
+    }
+    for (unsigned int i = 0; i < threads; i++) {
+        slices[i].starts = wordlist->starts;
+    }
+    wordlist_run_pass(wordlist_record_starts, slices, threads);
+
+    wordlist->threads = threads;
+    wordlist->index_time = g_get_monotonic_time() - started_at;
+    return wordlist;
+}
+
+/**
+ * \brief          Get a line of the wordlist where it is in the mapping, without its newline
+ *                 or a carriage return before it. The empty lines are not counted.
+ *
+ * \param[in]      wordlist The wordlist
+ * \param[in]      line The line, below lines
+ * \param[out]     len Receives the length of the line in bytes
+ * \return         The first byte of the line
+ */
+const uint8_t*
+hash_wordlist_line(const hash_wordlist_t* wordlist, size_t line, size_t* len) {
+    const uint8_t* data = wordlist->map->data;
+    size_t size = wordlist->map->size;
+    size_t start = wordlist->starts[line / BH_WORDLIST_INDEX_STRIDE];
+    for (size_t skip = line % BH_WORDLIST_INDEX_STRIDE; skip > 0;) {
+        const uint8_t* newline = memchr(data + start, '\n', size - start);
+        start = (size_t)(newline + 1 - data);
+        if (!wordlist_line_empty(data, size, start)) {
+            skip--;
+        }
+    }
+
+    const uint8_t* newline = memchr(data + start, '\n', size - start);
+    size_t end = newline ? (size_t)(newline - data) : size;
+    if (end > start && data[end - 1] == '\r') {
+        end--;
+    }
+    *len = end - start;
+    return data + start;
+}
+
+/**
+ * \brief          Destroy the wordlist, unmapping the corpus
+ *
+ * \param[in]      wordlist The wordlist to destroy, NULL is ignored
+ */
+void
+hash_wordlist_destroy(hash_wordlist_t* wordlist) {
+    if (!wordlist) {
+        return;
+    }
+
+    mapped_file_close(wordlist->map);
+    free(wordlist->starts);
+    free(wordlist);
+}
@@ -0,0 +1,59 @@
+/**
+ * \file            hash_collision_wordlist.h
+ * \brief           Header file for hash_collision_wordlist.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_COLLISION_WORDLIST_H
+#define HASH_COLLISION_WORDLIST_H
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../utils/mapped_file.h"
+
+/**
+ * \brief          The corpus the wordlist inputs are read from, one input per line, in the
+ *                 working directory
+ */
+#define BH_WORDLIST_PATH "bh_wordlist.txt"
+
+/**
+ * \brief          The lines from one indexed line start to the next. A line is found from the
+ *                 start before it with at most BH_WORDLIST_INDEX_STRIDE - 1 memchr calls, and
+ *                 the index takes one offset per BH_WORDLIST_INDEX_STRIDE lines.
+ */
+#define BH_WORDLIST_INDEX_STRIDE 8
+
+/**
+ * \brief          The most threads that index a wordlist
+ */
+#define BH_WORDLIST_MAX_THREADS 64
+
+/**
+ * \brief          A corpus mapped read-only into memory, with the offset of every
+ *                 BH_WORDLIST_INDEX_STRIDE-th line. The lines are hashed where they are in the
+ *                 mapping, so only the pages being read are in memory, and the corpus can be
+ *                 larger than the memory.
+ */
+typedef struct {
+    mapped_file_t* map;   ///< The mapped corpus
+    size_t lines;         ///< The lines of the corpus, the last one may lack its newline
+    size_t* starts;       ///< The offset of the lines 0, BH_WORDLIST_INDEX_STRIDE, ...
+    unsigned int threads; ///< The threads the index was built with
+    gint64 index_time;    ///< The microseconds the index took to build
+} hash_wordlist_t;
+
+hash_wordlist_t* hash_wordlist_open(const char* path, unsigned int threads);
+const uint8_t* hash_wordlist_line(const hash_wordlist_t* wordlist, size_t line, size_t* len);
+void hash_wordlist_destroy(hash_wordlist_t* wordlist);
+
+#endif
@@ -0,0 +1,353 @@
+/**
+ * \file            hash_collision_yuval.c
+ * \brief           The meaningful messages of Yuval's birthday attack: two messages written
+ *                  with choice points, a synonym or a whitespace each, so every message has
+ *                  2^choices variants that all read the same. A collision between a variant of
+ *                  the honest message and a variant of the fraudulent one is as good as any.
+ *                  The variants are hashed from the cached state at their first choice that
+ *                  differs from the variant before, so only the suffix is hashed again.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_collision_yuval.h"
+
+/**
+ * \brief          A pair of messages: the honest one the victim signs, and the fraudulent
+ *                 one the signature is moved to
+ */
+typedef struct {
+    const char* name;     ///< The name of the pair
+    const char* texts[2]; ///< The honest and the fraudulent message, with their choice points
+} hash_yuval_pair_t;
+
+static const hash_yuval_pair_t s_yuval_pairs[] = {
+    {"Car sale letter",
+     {"{Dear|Hello} {Alice|Ms. Smith},{\n|\n\n}{I am|I'm} {writing|getting in touch} "
+      "{to confirm|to let you know} {that |}{Bob|Mr. Jones} {will|is going to} "
+      "{be paid|receive} {$1,000|one thousand dollars} {for|in return for} {the|his} "
+      "{old|used} {car|vehicle}{.| .}{ |  }{The|This} {payment|transfer} {will be made|is due} "
+      "{on|by} {Friday|the end of the week}{.| .}{ |  }{Kind regards|Best wishes},{\n|\n\n}"
+      "{Carol|C.}",
+      "{Dear|Hello} {Alice|Ms. Smith},{\n|\n\n}{I am|I'm} {writing|getting in touch} "
+      "{to confirm|to let you know} {that |}{Bob|Mr. Jones} {will|is going to} "
+      "{be paid|receive} {$100,000|one hundred thousand dollars} {for|in return for} "
+      "{the|his} {old|family} {house|home}{.| .}{ |  }{The|This} {payment|transfer} "
+      "{will be made|is due} {on|by} {Friday|the end of the week}{.| .}{ |  }"
+      "{Kind regards|Best wishes},{\n|\n\n}{Carol|C.}"}},
+    {"Contract clause",
+     {"{The|This} {Supplier|Vendor} {shall|will} {deliver|ship} {100|one hundred} "
+      "{units|items} {to|for} {the|its} {Customer|Client} {within|in no more than} "
+      "{30|thirty} {days|calendar days} {of|after} {the|each} {order|purchase order}"
+      "{.| .}{ |  }{Late|Delayed} {deliveries|shipments} {are|will be} {refunded|credited} "
+      "{in full|entirely}{.| .}{ |  }{Signed|Agreed},{ |  }{the|both} {parties|signatories}"
+      "{.| .}",
+      "{The|This} {Supplier|Vendor} {shall|will} {deliver|ship} {100|one hundred} "
+      "{units|items} {to|for} {the|its} {Customer|Client} {within|in no more than} "
+      "{300|three hundred} {days|calendar days} {of|after} {the|each} {order|purchase order}"
+      "{.| .}{ |  }{Late|Delayed} {deliveries|shipments} "
+      "{are never|will not be} {refunded|credited} {at all|in any case}{.| .}{ |  }"
+      "{Signed|Agreed},{ |  }{the|both} {parties|signatories}{.| .}"}},
+};
+static const unsigned int s_yuval_pairs_len = ARRAY_SIZE(s_yuval_pairs);
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Hash the option a variant picks at a choice point and the fixed text after
+ *                 it, from the state at the choice point into the state at the next one
+ *
+ * \param[in]      hasher The hasher
+ * \param[in]      choice The choice point
+ * \param[in]      option The option picked, 0 or 1
+ * \return         false when OpenSSL failed, true otherwise
+ */
+static bool
+hash_yuval_hasher_step(hash_yuval_hasher_t* hasher, unsigned int choice, unsigned int option) {
+    const hash_yuval_template_t* message = hasher->message;
+    const char* text = message->options[choice][option];
+    size_t text_len = message->option_lens[choice][option];
+    const char* fixed = message->fixed[choice + 1];
+    size_t fixed_len = message->fixed_lens[choice + 1];
+    hasher->bytes_hashed += text_len + fixed_len;
+    hasher->lengths[choice + 1] = hasher->lengths[choice] + text_len + fixed_len;
+
+    if (!hasher->md) {
+        uint32_t state = hasher->toy_update(hasher->toy_states[choice], text, text_len);
+        hasher->toy_states[choice + 1] = hasher->toy_update(state, fixed, fixed_len);
+        return true;
+    }
+
+    EVP_MD_CTX* next = hasher->states[choice + 1];
+    return EVP_MD_CTX_copy_ex(next, hasher->states[choice]) == 1
+           && EVP_DigestUpdate(next, text, text_len) == 1
+           && EVP_DigestUpdate(next, fixed, fixed_len) == 1;
+}
+
+/****************************************************************
+                       EXTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Get the number of built-in pairs of messages
+ *
+ * \return         The number of pairs
+ */
+unsigned int
+hash_yuval_pair_count(void) {
+    return s_yuval_pairs_len;
+}
+
+/**
+ * \brief          Get the name of a built-in pair of messages
+ *
+ * \param[in]      pair The pair, 0 to hash_yuval_pair_count() - 1
+ * \return         The name, or NULL for an unknown pair
+ */
+const char*
+hash_yuval_pair_name(unsigned int pair) {
+    return pair < s_yuval_pairs_len ? s_yuval_pairs[pair].name : NULL;
+}
+
+/**
+ * \brief          Parse a message of a built-in pair into its fixed texts and the options of
+ *                 its choice points. The parsed message points into the built-in text.
+ *
+ * \param[in]      pair The pair, 0 to hash_yuval_pair_count() - 1
+ * \param[in]      side 0 for the honest message, 1 for the fraudulent one
+ * \param[out]     message Receives the parsed message
+ * \return         false for an unknown pair or a malformed text, true otherwise
+ */
+bool
+hash_yuval_template_parse(unsigned int pair, unsigned int side, hash_yuval_template_t* message) {
+    if (pair >= s_yuval_pairs_len || side > 1) {
+        return false;
+    }
+
+    memset(message, 0, sizeof(*message));
+    message->name = s_yuval_pairs[pair].name;
+
+    const char* text = s_yuval_pairs[pair].texts[side];
+    const char* fixed = text;
+    unsigned int count = 0;
+    for (const char* c = text; *c != '\0'; c++) {
+        if (*c != '{') {
+            continue;
+        }
+
+        const char* bar = strchr(c, '|');
+        const char* close = bar ? strchr(bar, '}') : NULL;
+        if (!close || count == BH_YUVAL_MAX_CHOICES) {
+            return false;
+        }
+
+        message->fixed[count] = fixed;
+        message->fixed_lens[count] = (size_t)(c - fixed);
+        message->options[count][0] = c + 1;
+        message->option_lens[count][0] = (size_t)(bar - c - 1);
+        message->options[count][1] = bar + 1;
+        message->option_lens[count][1] = (size_t)(close - bar - 1);
+        count++;
+        fixed = close + 1;
+        c = close;
+    }
+    message->fixed[count] = fixed;
+    message->fixed_lens[count] = strlen(fixed);
+    message->choice_count = count;
+
+    size_t max_len = 0;
+    for (unsigned int i = 0; i <= count; i++) {
+        max_len += message->fixed_lens[i];
+        if (i < count) {
+            size_t a = message->option_lens[i][0];
+            size_t b = message->option_lens[i][1];
+            max_len += a > b ? a : b;
+        }
+    }
+    message->max_len = max_len;
+    return count > 0 && max_len <= BH_YUVAL_MAX_MESSAGE;
+}
+
+/**
+ * \brief          Get the number of variants of a message
+ *
+ * \param[in]      message The parsed message
+ * \return         2^choices
+ */
+uint64_t
+hash_yuval_variant_count(const hash_yuval_template_t* message) {
+    return UINT64_C(1) << message->choice_count;
+}
+
+/**
+ * \brief          Write a variant of a message in full
+ *
+ * \param[in]      message The parsed message
+ * \param[in]      variant The variant, below hash_yuval_variant_count
+ * \param[out]     buffer Receives the variant, at least max_len bytes, not terminated
+ * \return         The length of the variant in bytes
+ */
+size_t
+hash_yuval_variant(const hash_yuval_template_t* message, uint64_t variant, uint8_t* buffer) {
+    unsigned int count = message->choice_count;
+    size_t len = 0;
+    for (unsigned int i = 0; i <= count; i++) {
+        memcpy(buffer + len, message->fixed[i], message->fixed_lens[i]);
+        len += message->fixed_lens[i];
+        if (i < count) {
+            unsigned int option = (variant >> (count - 1 - i)) & 1;
+            memcpy(buffer + len, message->options[i][option], message->option_lens[i][option]);
+            len += message->option_lens[i][option];
+        }
+    }
+    return len;
+}
+
+/**
+ * \brief          Create a hasher of the variants of a message. You should free the returned
+ *                 hasher using `hash_yuval_hasher_destroy` when done.
+ *
+ * \param[in]      hash_id The hash function
+ * \param[in]      message The parsed message, kept by the hasher
+ * \return         A pointer to the newly created hasher, or NULL on memory allocation failure
+ */
+hash_yuval_hasher_t*
+hash_yuval_hasher_create(enum hash_function_ids hash_id, const hash_yuval_template_t* message) {
+    hash_yuval_hasher_t* hasher = calloc(1, sizeof(hash_yuval_hasher_t));
+    if (!hasher) {
+        return NULL;
+    }
+
+    hasher->hash_id = hash_id;
+    hasher->message = message;
+    const hash_config_t* hash = get_hash_config(hash_id);
+    hasher->md = hash->md ? hash->md() : NULL;
+    if (!hasher->md) {
+        hasher->toy_update = hash->toy_update;
+        hasher->whole = !hash->toy_update;
+        return hasher;
+    }
+
+    hasher->final = EVP_MD_CTX_new();
+    bool ok = hasher->final != NULL;
+    for (unsigned int i = 0; ok && i <= message->choice_count; i++) {
+        hasher->states[i] = EVP_MD_CTX_new();
+        ok = hasher->states[i] != NULL;
+    }
+
+    if (!ok) {
+        hash_yuval_hasher_destroy(hasher);
+        return NULL;
+    }
+    return hasher;
+}
+
+/**
+ * \brief          Hash a variant of the message of the hasher. The states of the choice
+ *                 points before the first choice where it differs from the previous variant
+ *                 are reused, the later ones are rebuilt.
+ *
+ * \param[in]      hasher The hasher
+ * \param[in]      variant The variant, below hash_yuval_variant_count
+ * \param[out]     hash_hex Receives the digest in uppercase hex like compute_hash writes it,
+ *                 at least BH_YUVAL_MAX_HEX bytes
+ * \return         false when OpenSSL failed, true otherwise
+ */
+bool
+hash_yuval_hasher_digest(hash_yuval_hasher_t* hasher, uint64_t variant, char* hash_hex) {
+    const hash_yuval_template_t* message = hasher->message;
+    unsigned int count = message->choice_count;
+
+    if (hasher->whole) {
+        const hash_config_t* hash = get_hash_config(hasher->hash_id);
+        uint8_t buffer[BH_YUVAL_MAX_MESSAGE];
+        uint8_t digest[BH_HASH_MAX_DIGEST_BYTES];
+        size_t len = hash_yuval_variant(message, variant, buffer);
+        if (!hash->digest(buffer, len, digest)) {
+            return false;
+        }
+        hash_config_digest_hex(hash, digest, hash_hex);
+        hasher->bytes_hashed += len;
+        hasher->message_bytes += len;
+        hasher->variants++;
+        return true;
+    }
+
+    // The first choice point is the highest bit, so the highest bit that changed is the
+    // first choice whose state has to be rebuilt
+    unsigned int first = 0;
+    if (hasher->primed) {
+        uint64_t changed = variant ^ hasher->current;
+        first = changed ? count - 1 - (63 - __builtin_clzll(changed)) : count;
+    } else if (hasher->md) {
+        if (EVP_DigestInit_ex(hasher->states[0], hasher->md, NULL) != 1
+            || EVP_DigestUpdate(hasher->states[0], message->fixed[0], message->fixed_lens[0])
+                   != 1) {
+            return false;
+        }
+    } else {
+        hasher->toy_states[0] = hasher->toy_update(get_hash_config(hasher->hash_id)->toy_iv,
+                                                   message->fixed[0], message->fixed_lens[0]);
+    }
+    if (!hasher->primed) {
+        hasher->lengths[0] = message->fixed_lens[0];
+        hasher->bytes_hashed += message->fixed_lens[0];
+    }
+
+    hasher->primed = false;
+    for (unsigned int i = first; i < count; i++) {
+        if (!hash_yuval_hasher_step(hasher, i, (variant >> (count - 1 - i)) & 1)) {
+            return false;
+        }
+    }
+    hasher->primed = true;
+    hasher->current = variant;
+    hasher->variants++;
+    hasher->message_bytes += hasher->lengths[count];
+
+    if (!hasher->md) {
+        sprintf(hash_hex, "%0*X", get_hash_config(hasher->hash_id)->bits / 4,
+                hasher->toy_states[count]);
+        return true;
+    }
+
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_len = 0;
+    if (EVP_MD_CTX_copy_ex(hasher->final, hasher->states[count]) != 1
+        || EVP_DigestFinal_ex(hasher->final, digest, &digest_len) != 1) {
+        hasher->primed = false;
+        return false;
+    }
+
+    static const char digits[] = "0123456789ABCDEF";
+    for (unsigned int i = 0; i < digest_len; i++) {
+        hash_hex[2 * i] = digits[digest[i] >> 4];
+        hash_hex[2 * i + 1] = digits[digest[i] & 0x0F];
+    }
+    hash_hex[2 * digest_len] = '\0';
+    return true;
+}
+
+/**
+ * \brief          Destroy the hasher with its states
+ *
+ * \param[in]      hasher The hasher to destroy, NULL is ignored
+ */
+void
+hash_yuval_hasher_destroy(hash_yuval_hasher_t* hasher) {
+    if (!hasher) {
+        return;
+    }
+
+    for (unsigned int i = 0; i <= BH_YUVAL_MAX_CHOICES; i++) {
+        EVP_MD_CTX_free(hasher->states[i]);
+    }
+    EVP_MD_CTX_free(hasher->final);
+    free(hasher);
+}
@@ -0,0 +1,95 @@
+/**
+ * \file            hash_collision_yuval.h
+ * \brief           Header file for hash_collision_yuval.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_COLLISION_YUVAL_H
+#define HASH_COLLISION_YUVAL_H
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_config.h"
+
+#include "../../utils/hash_function.h"
+#include "../../utils/utils.h"
+
+/**
+ * \brief          The most choice points of a template, the variants are numbered in 64 bits
+ */
+#define BH_YUVAL_MAX_CHOICES 48
+
+/**
+ * \brief          The most bytes of a variant of a template
+ */
+#define BH_YUVAL_MAX_MESSAGE 1024
+
+/**
+ * \brief          The bytes of the hex digest of the longest digest and its terminator
+ */
+#define BH_YUVAL_MAX_HEX (EVP_MAX_MD_SIZE * 2 + 1)
+
+/**
+ * \brief          A message with choice points, written "{first|second}" in its text. Every
+ *                 variant picks one option of every choice point, the first choice point from
+ *                 the highest bit of the variant number, so consecutive variants only differ
+ *                 in their last choices and share the longest prefix.
+ */
+typedef struct {
+    const char* name;                                 ///< The name of the message
+    unsigned int choice_count;                        ///< The choice points
+    const char* fixed[BH_YUVAL_MAX_CHOICES + 1];      ///< The text before every choice point
+    size_t fixed_lens[BH_YUVAL_MAX_CHOICES + 1];      ///< The length of every fixed text
+    const char* options[BH_YUVAL_MAX_CHOICES][2];     ///< The two options of every choice point
+    size_t option_lens[BH_YUVAL_MAX_CHOICES][2];      ///< The length of every option
+    size_t max_len;                                   ///< The length of the longest variant
+} hash_yuval_template_t;
+
+/**
+ * \brief          Hashes the variants of one template and keeps the state of the hash at
+ *                 every choice point of the last variant. The next variant restarts from the
+ *                 state at its first choice that differs, so only the suffix is hashed again.
+ *                 The OpenSSL states are copied with EVP_MD_CTX_copy_ex, the toy hashes keep
+ *                 their native state. The hashes implemented natively have no state to copy
+ *                 and hash every variant in full.
+ */
+typedef struct {
+    enum hash_function_ids hash_id;         ///< The hash function
+    const hash_yuval_template_t* message;   ///< The template of the variants
+    const EVP_MD* md;                       ///< The OpenSSL digest, NULL for the other hashes
+    bool whole;                             ///< Whether every variant is hashed in full
+    hash_toy_update_fn toy_update;          ///< The update of a toy hash, NULL for the others
+    EVP_MD_CTX* states[BH_YUVAL_MAX_CHOICES + 1]; ///< The OpenSSL state at every choice point
+    EVP_MD_CTX* final;                      ///< The state the digest is finalized from
+    uint32_t toy_states[BH_YUVAL_MAX_CHOICES + 1]; ///< The toy state at every choice point
+    size_t lengths[BH_YUVAL_MAX_CHOICES + 1]; ///< The bytes of the variant up to every choice
+    bool primed;                            ///< Whether the states hold a variant
+    uint64_t current;                       ///< The variant the states were made for
+    guint64 bytes_hashed;                   ///< The bytes hashed over every variant
+    guint64 message_bytes;                  ///< The bytes of every variant hashed in full
+    guint64 variants;                       ///< The variants hashed
+} hash_yuval_hasher_t;
+
+unsigned int hash_yuval_pair_count(void);
+const char* hash_yuval_pair_name(unsigned int pair);
+bool hash_yuval_template_parse(unsigned int pair, unsigned int side,
+                               hash_yuval_template_t* message);
+uint64_t hash_yuval_variant_count(const hash_yuval_template_t* message);
+size_t hash_yuval_variant(const hash_yuval_template_t* message, uint64_t variant,
+                          uint8_t* buffer);
+hash_yuval_hasher_t* hash_yuval_hasher_create(enum hash_function_ids hash_id,
+                                              const hash_yuval_template_t* message);
+bool hash_yuval_hasher_digest(hash_yuval_hasher_t* hasher, uint64_t variant, char* hash_hex);
+void hash_yuval_hasher_destroy(hash_yuval_hasher_t* hasher);
+
+#endif
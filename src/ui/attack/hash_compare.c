@@ -0,0 +1,286 @@
+/**
+ * \file            hash_compare.c
+ * \brief           The page that compares several hash functions in one run. Every random
+ *                  input is generated once and hashed by each selected hash function, with
+ *                  one collision detector per function, and the page shows the collision
+ *                  point and the throughput of every function side by side. With the
+ *                  truncations on, the same digests also feed a detector for each of their
+ *                  16 to 48-bit prefixes.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_compare.h"
+
+#define ACTION_SUBMIT 1
+
+static const struct FormButton s_compare_form_button = {"[ Run Comparison ]", "[ Running... ]",
+                                                         ACTION_SUBMIT};
+
+// The compared hash functions are a range of the hash menu, which lists hash_config[]
+static const struct FormInputField s_compare_form_field_metadata[] = {
+    {"Max Attempts", 10000, 8, 0},
+    {"Truncations (1 Off, 2 On)", 1, 1, 2},
+    {"First hash (menu number)", 2, 2, 0},
+    {"Last hash (menu number)", 7, 2, 0}};
+
+// The prefix widths watched for every selected hash function with more output bits
+static const unsigned int s_compare_truncation_bits[] = {16, 24, 32, 40, 48};
+static const unsigned short s_compare_truncation_bits_len = ARRAY_SIZE(s_compare_truncation_bits);
+
+/**
+ * \brief          The index of the input fields in s_compare_form_field_metadata
+ */
+enum hash_compare_field_index {
+    HASH_COMPARE_FIELD_MAX_ATTEMPTS = 0,
+    HASH_COMPARE_FIELD_TRUNCATIONS,
+    HASH_COMPARE_FIELD_FIRST_HASH,
+    HASH_COMPARE_FIELD_LAST_HASH
+};
+
+/**
+ * \brief          One row of the comparison table, kept to render it again after a resize
+ */
+typedef struct {
+    char label[24];           ///< The label of the hash function, with the compared bits
+    bool collision_found;     ///< Whether the detector found a collision
+    guint64 collision_point;  ///< The number of digests up to and with the collision
+    double hashes_per_second; ///< The hashing throughput of the function alone
+    double table_mib;         ///< The size of the detector table
+    char digest[17];          ///< The start of the collision digest
+} hash_compare_row_t;
+
+// The rows of the last comparison, rendered again when the page is restored
+static hash_compare_row_t s_compare_rows[BH_DETECTOR_MAX];
+static unsigned int s_compare_row_count = 0;
+static int s_compare_attempts = 0;
+static double s_compare_seconds = 0.0;
+
+/****************************************************************
+ INTERNAL FUNCTION
+ ****************************************************************/
+
+/**
+ * \brief          Count the detectors a comparison run needs
+ *
+ * \param[in]      selected Whether every entry of hash_config[] is selected
+ * \param[in]      truncations Whether the prefixes of the digests are watched too
+ * \return         The number of detectors
+ */
+static unsigned int
+hash_compare_detector_count(const bool* selected, bool truncations) {
+    unsigned int count = 0;
+    for (unsigned short i = 0; i < hash_config_len; i++) {
+        if (!selected[i]) {
+            continue;
+        }
+        count++;
+        for (unsigned short t = 0; truncations && t < s_compare_truncation_bits_len; t++) {
+            count += s_compare_truncation_bits[t] < hash_config[i].bits;
+        }
+    }
+    return count;
+}
+
+/**
+ * \brief          Start a comparison run: add a detector for every selected hash function,
+ *                 after the detectors of its prefixes when the truncations are on, then submit
+ *                 the workers that hash the shared inputs. The detectors of one function are
+ *                 added next to each other so the workers hash every input once for them.
+ *
+ * \param[in]      max_attempts The number of inputs to generate
+ * \param[in]      selected Whether every entry of hash_config[] is selected
+ * \param[in]      truncations Whether the prefixes of the digests are watched too
+ * \param[in]      thread_pool The thread pool to run the workers on
+ * \param[out]     ctx The context of the run shared between all worker threads
+ * \return         true if the run started, false if no hash function is selected
+ */
+static bool
+hash_compare_run(unsigned int max_attempts, const bool* selected, bool truncations,
+                 GThreadPool* thread_pool, hash_collision_context_t* ctx) {
+    if (max_attempts == 0) {
+        max_attempts = 10000; // Default to 10,000 attempts for zero attempts
+    }
+
+    ctx->detectors = hash_detector_set_create();
+    if (!ctx->detectors) {
+        render_full_page_error_exit(stdscr, 0, 0, "Memory allocation failed for detectors.");
+    }
+    for (unsigned short i = 0; i < hash_config_len; i++) {
+        if (!selected[i]) {
+            continue;
+        }
+        for (unsigned short t = 0; truncations && t < s_compare_truncation_bits_len; t++) {
+            if (s_compare_truncation_bits[t] < hash_config[i].bits
+                && !hash_detector_set_add(ctx->detectors, hash_config[i].id,
+                                          s_compare_truncation_bits[t], max_attempts)) {
+                render_full_page_error_exit(stdscr, 0, 0,
+                                            "Memory allocation failed for detector table.");
+            }
+        }
+        if (!hash_detector_set_add(ctx->detectors, hash_config[i].id, 0, max_attempts)) {
+            render_full_page_error_exit(stdscr, 0, 0,
+                                        "Memory allocation failed for detector table.");
+        }
+    }
+    if (ctx->detectors->count == 0) {
+        hash_detector_set_destroy(ctx->detectors);
+        ctx->detectors = NULL;
+        return false;
+    }
+
+    // The inputs are regenerated from their index to confirm a collision
+    attack_page_prepare_run(ctx, thread_pool, max_attempts);
+    hash_collision_submit_workers(ctx, HASH_PASS_DETECTORS);
+    return true;
+}
+
+/**
+ * \brief          Take the value from the form fields and start a comparison run
+ *
+ * \param[in]      page The comparison page
+ * \param[in]      thread_pool The thread pool to use for running the comparison
+ * \param[out]     ctx The context of the run shared between all worker threads
+ */
+static void
+hash_compare_start(attack_page_t* page, GThreadPool* thread_pool, hash_collision_context_t* ctx) {
+    unsigned int attempts = atoi(attack_page_field_buffer(page, HASH_COMPARE_FIELD_MAX_ATTEMPTS));
+    int first = atoi(attack_page_field_buffer(page, HASH_COMPARE_FIELD_FIRST_HASH));
+    int last = atoi(attack_page_field_buffer(page, HASH_COMPARE_FIELD_LAST_HASH));
+    bool truncations = atoi(attack_page_field_buffer(page, HASH_COMPARE_FIELD_TRUNCATIONS)) == 2;
+
+    if (first < 1 || first > last || last > hash_config_len) {
+        attack_page_message(page, "The hashes are the menu numbers of the first and the last "
+                                  "hash function to compare.");
+        return;
+    }
+
+    // The hash functions of the range the installed OpenSSL lacks are left out
+    bool* selected = g_new0(bool, hash_config_len);
+    for (int i = first - 1; i < last; i++) {
+        selected[i] = hash_config_init(&hash_config[i]);
+    }
+
+    if (hash_compare_detector_count(selected, truncations) > BH_DETECTOR_MAX) {
+        attack_page_message(page,
+                            "Too many detectors, compare fewer hash functions or turn off the "
+                            "truncations.");
+    } else if (!hash_compare_run(attempts, selected, truncations, thread_pool, ctx)) {
+        attack_page_message(page, BH_HASH_UNAVAILABLE_MESSAGE);
+    }
+    g_free(selected);
+}
+
+/**
+ * \brief          Keep the results of every detector of a finished run as table rows
+ *
+ * \param[in]      ctx The context of the finished run
+ */
+static void
+hash_compare_collect_rows(hash_collision_context_t* ctx) {
+    hash_collision_stats_t* stats = &ctx->result->stats;
+    s_compare_attempts = ctx->result->attempts_made;
+    s_compare_seconds = stats->finished_at > stats->started_at
+                            ? (double)(stats->finished_at - stats->started_at) / G_USEC_PER_SEC
+                            : 0.0;
+
+    s_compare_row_count = ctx->detectors ? ctx->detectors->count : 0;
+    for (unsigned int i = 0; i < s_compare_row_count; i++) {
+        hash_detector_t* detector = &ctx->detectors->detectors[i];
+        hash_compare_row_t* row = &s_compare_rows[i];
+        double hash_seconds = (double)detector->hash_time / G_USEC_PER_SEC;
+
+        const char* label = get_hash_config_item(detector->hash_id).label;
+        if (detector->hex_length) {
+            snprintf(row->label, sizeof(row->label), "%s/%u", label, detector->bits);
+        } else {
+            snprintf(row->label, sizeof(row->label), "%s", label);
+        }
+        row->collision_found = detector->collision_found;
+        row->collision_point = detector->digests;
+        row->hashes_per_second = hash_seconds > 0 ? detector->hashes / hash_seconds : 0.0;
+        row->table_mib = (double)(detector->table ? hash_compact_table_memory_size(detector->table)
+                                                  : detector->table_bytes)
+                         / (1024.0 * 1024.0);
+        snprintf(row->digest, sizeof(row->digest), "%s",
+                 detector->collision_hash_hex ? detector->collision_hash_hex : "-");
+    }
+}
+
+/**
+ * \brief          Render the comparison table of the last run: the collision point, the
+ *                 hashing throughput and the table size of every selected hash function
+ *
+ * \param[in]      win The sub window of the form
+ * \param[in]      starting_y The row of the table header
+ */
+static void
+render_compare_result(WINDOW* win, int starting_y) {
+    wattron(win, A_BOLD);
+    mvwprintw(win, starting_y, BH_FORM_X_PADDING, "%-14s %-14s %14s %10s  %s", "Hash",
+              "Collision at", "Hashes/s", "Table MiB", "Digest");
+    wattroff(win, A_BOLD);
+
+    for (unsigned int i = 0; i < s_compare_row_count; i++) {
+        const hash_compare_row_t* row = &s_compare_rows[i];
+        char point[24];
+        if (row->collision_found) {
+            snprintf(point, sizeof(point), "%llu", (unsigned long long)row->collision_point);
+        } else {
+            snprintf(point, sizeof(point), "none");
+        }
+
+        int color = row->collision_found ? BH_SUCCESS_COLOR_PAIR : BH_ERROR_COLOR_PAIR;
+        wattron(win, COLOR_PAIR(color));
+        mvwprintw(win, starting_y + 1 + i, BH_FORM_X_PADDING, "%-14s %-14s %14.0f %10.2f  %s",
+                  row->label, point, row->hashes_per_second, row->table_mib, row->digest);
+        wattroff(win, COLOR_PAIR(color));
+    }
+
+    mvwprintw(win, starting_y + 1 + s_compare_row_count, BH_FORM_X_PADDING,
+              "Inputs   : %d generated once for %u detectors in %.3f s", s_compare_attempts,
+              s_compare_row_count, s_compare_seconds);
+}
+
+static const attack_page_config_t s_compare_page = {
+    .title = "[ Hash Function Comparison ]",
+    .name = "comparison",
+    .description = "Every input is hashed by each selected function, one detector per width",
+    .fields = s_compare_form_field_metadata,
+    .field_count = ARRAY_SIZE(s_compare_form_field_metadata),
+    .button = &s_compare_form_button,
+    .result_rows = BH_DETECTOR_MAX + 2,
+    .start = hash_compare_start,
+    .collect = hash_compare_collect_rows,
+    .render_result = render_compare_result,
+};
+
+/**************************************************************
+                      EXTERNAL FUNCTIONS
+**************************************************************/
+
+/**
+ * \brief          Render the page that compares several hash functions on one stream of
+ *                 random inputs.
+ *
+ * \param[in]      content_win The window to render the comparison page on
+ * \param[in]      header_win The window to render the header content, normally for
+ *                 the args of header_render
+ * \param[in]      footer_win The window to render the footer content, normally for
+ *                 the args of footer_render
+ * \param[out]     max_y The maximum height of the screen space that can be rendered. The
+ *                 value will be updated when a resize happens
+ * \param[out]     max_x The maximum width of the screen space that can be rendered. The
+ *                 value will be updated when a resize happens
+ * \param[in]      thread_pool The thread pool to use for running the comparison.
+ */
+void
+render_hash_compare_page(WINDOW* content_win, WINDOW* header_win, WINDOW* footer_win, int* max_y,
+                         int* max_x, GThreadPool* thread_pool) {
+    attack_page_render(&s_compare_page, content_win, header_win, footer_win, max_y, max_x,
+                       thread_pool);
+}
@@ -15,17 +15,130 @@
 
 #include "hash_config.h"
 
+#include "../../utils/hash_block.h"
+
+/**
+ * \brief          Write the last hex digits of a binary digest: the toy digests are padded to
+ *                 whole bytes, and only their last bits / 4 digits are kept
+ *
+ * \param[in]      digest The binary digest
+ * \param[in]      digest_bytes The bytes of the digest
+ * \param[in]      hex_length The number of digits to write
+ * \param[out]     hex Receives the digits in uppercase and the null terminator
+ * \return         hex
+ */
+static inline char*
+digest_hex_tail(const uint8_t* digest, size_t digest_bytes, size_t hex_length, char* hex) {
+    static const char hex_digits[] = "0123456789ABCDEF";
+    size_t skipped = digest_bytes * 2 - hex_length;
+    for (size_t i = 0; i < hex_length; i++) {
+        size_t nibble = skipped + i;
+        uint8_t byte = digest[nibble / 2];
+        hex[i] = hex_digits[nibble % 2 ? byte & 0xF : byte >> 4];
+    }
+    hex[hex_length] = '\0';
+    return hex;
+}
+
+/**
+ * \brief          Define the truncate function of a hash function from its digest bytes and
+ *                 bits, so the loop of every function runs a known number of digits
+ */
+#define BH_DEFINE_TRUNCATE(name, bytes, bits)                                                      \
+    static char* name##_truncate(const uint8_t* digest, char* hex) {                               \
+        return digest_hex_tail(digest, (bytes), (bits) / 4, hex);                                  \
+    }
+
+BH_DEFINE_TRUNCATE(hash_8bit, 1, 8)
+BH_DEFINE_TRUNCATE(hash_12bit, 2, 12)
+BH_DEFINE_TRUNCATE(hash_16bit, 2, 16)
+BH_DEFINE_TRUNCATE(hash_ripemd160, 20, 160)
+BH_DEFINE_TRUNCATE(hash_sha1, 20, 160)
+BH_DEFINE_TRUNCATE(hash_sha3_256, 32, 256)
+BH_DEFINE_TRUNCATE(hash_sha256, 32, 256)
+BH_DEFINE_TRUNCATE(hash_sha512, 64, 512)
+BH_DEFINE_TRUNCATE(hash_sha384, 48, 384)
+BH_DEFINE_TRUNCATE(hash_keccak_256, 32, 256)
+BH_DEFINE_TRUNCATE(hash_blake2b512, 64, 512)
+BH_DEFINE_TRUNCATE(hash_blake2s256, 32, 256)
+BH_DEFINE_TRUNCATE(hash_blake3, 32, 256)
+BH_DEFINE_TRUNCATE(hash_xxh3_64, 8, 64)
+BH_DEFINE_TRUNCATE(hash_xxh3_128, 16, 128)
+BH_DEFINE_TRUNCATE(hash_siphash24, 8, 64)
+
+/**
+ * \brief          Define the block init function of a hash function from its OpenSSL ID, the
+ *                 ID the single-block kernels share with the OpenSSL wrappers
+ */
+#define BH_DEFINE_BLOCK_INIT(name, openssl_id)                                                     \
+    static bool name##_block_init(hash_block_kernel_t* kernel) {                                   \
+        return hash_block_kernel_init(kernel, (openssl_id));                                       \
+    }
+
+BH_DEFINE_BLOCK_INIT(hash_ripemd160, BH_OPENSSL_HASH_RIPEMD160)
+BH_DEFINE_BLOCK_INIT(hash_sha1, BH_OPENSSL_HASH_SHA1)
+BH_DEFINE_BLOCK_INIT(hash_sha3_256, BH_OPENSSL_HASH_SHA3_256)
+BH_DEFINE_BLOCK_INIT(hash_sha256, BH_OPENSSL_HASH_SHA256)
+BH_DEFINE_BLOCK_INIT(hash_sha512, BH_OPENSSL_HASH_SHA512)
+BH_DEFINE_BLOCK_INIT(hash_sha384, BH_OPENSSL_HASH_SHA384)
+
+/**
+ * \brief          Define the toy update function of a toy hash over its update on the state
+ *                 type of its bits
+ */
+#define BH_DEFINE_TOY_UPDATE(name, state_type)                                                     \
+    static uint32_t name##_toy_update(uint32_t state, const void* data, size_t len) {              \
+        return name##_update((state_type)state, data, len);                                        \
+    }
+
+BH_DEFINE_TOY_UPDATE(hash_8bit, uint8_t)
+BH_DEFINE_TOY_UPDATE(hash_12bit, uint16_t)
+BH_DEFINE_TOY_UPDATE(hash_16bit, uint16_t)
+
 const hash_config_t hash_config[] = {
-    {HASH_CONFIG_8BIT, "ToyHash8", (unsigned short)8, "~2^4 = 16", "2^8 = 256"},
-    {HASH_CONFIG_12BIT, "ToyHash12", (unsigned short)12, "~2^6 = 64", "2^12 = 4096"},
-    {HASH_CONFIG_16BIT, "ToyHash16", (unsigned short)16, "~2^8 = 256", "2^16 = 65536"},
-    {HASH_CONFIG_RIPEMD160, "RIPEMD-160", (unsigned short)160, "~2^80", "2^160"},
-    {HASH_CONFIG_SHA1, "SHA-1", (unsigned short)160, "~2^80", "2^160"},
-    {HASH_CONFIG_SHA3_256, "SHA3-256", (unsigned short)256, "~2^128", "2^256"},
-    {HASH_CONFIG_SHA256, "SHA-256", (unsigned short)256, "~2^128", "2^256"},
-    {HASH_CONFIG_SHA512, "SHA-512", (unsigned short)512, "~2^256", "2^512"},
-    {HASH_CONFIG_SHA384, "SHA-384", (unsigned short)384, "~2^192", "2^384"},
-    // {HASH_CONFIG_KECCAK256, "Keccak-256", (unsigned short)256, "~2^128", "2^256"},
+    {HASH_CONFIG_8BIT, "ToyHash8", (unsigned short)8, "~2^4 = 16", "2^8 = 256", 1, hash_8bit_digest,
+     hash_8bit_batch, NULL, hash_8bit_truncate, NULL, NULL, hash_8bit_toy_update, BH_HASH_8BIT_IV},
+    {HASH_CONFIG_12BIT, "ToyHash12", (unsigned short)12, "~2^6 = 64", "2^12 = 4096", 2,
+     hash_12bit_digest, hash_12bit_batch, NULL, hash_12bit_truncate, NULL, NULL,
+     hash_12bit_toy_update, BH_HASH_12BIT_IV},
+    {HASH_CONFIG_16BIT, "ToyHash16", (unsigned short)16, "~2^8 = 256", "2^16 = 65536", 2,
+     hash_16bit_digest, hash_16bit_batch, NULL, hash_16bit_truncate, NULL, NULL,
+     hash_16bit_toy_update, BH_HASH_16BIT_IV},
+    {HASH_CONFIG_RIPEMD160, "RIPEMD-160", (unsigned short)160, "~2^80", "2^160", 20,
+     hash_ripemd160_digest, hash_ripemd160_batch, hash_ripemd160_init, hash_ripemd160_truncate,
+     EVP_ripemd160, hash_ripemd160_block_init, NULL, 0},
+    {HASH_CONFIG_SHA1, "SHA-1", (unsigned short)160, "~2^80", "2^160", 20, hash_sha1_digest,
+     hash_sha1_batch, hash_sha1_init, hash_sha1_truncate, EVP_sha1, hash_sha1_block_init, NULL, 0},
+    {HASH_CONFIG_SHA3_256, "SHA3-256", (unsigned short)256, "~2^128", "2^256", 32,
+     hash_sha3_256_digest, hash_sha3_256_batch, NULL, hash_sha3_256_truncate, EVP_sha3_256,
+     hash_sha3_256_block_init, NULL, 0},
+    {HASH_CONFIG_SHA256, "SHA-256", (unsigned short)256, "~2^128", "2^256", 32, hash_sha256_digest,
+     hash_sha256_batch, hash_sha256_init, hash_sha256_truncate, EVP_sha256, hash_sha256_block_init,
+     NULL, 0},
+    {HASH_CONFIG_SHA512, "SHA-512", (unsigned short)512, "~2^256", "2^512", 64, hash_sha512_digest,
+     hash_sha512_batch, hash_sha512_init, hash_sha512_truncate, EVP_sha512, hash_sha512_block_init,
+     NULL, 0},
+    {HASH_CONFIG_SHA384, "SHA-384", (unsigned short)384, "~2^192", "2^384", 48, hash_sha384_digest,
+     hash_sha384_batch, hash_sha384_init, hash_sha384_truncate, EVP_sha384, hash_sha384_block_init,
+     NULL, 0},
+    {HASH_CONFIG_KECCAK256, "Keccak-256", (unsigned short)256, "~2^128", "2^256", 32,
+     hash_keccak_256_digest, hash_keccak_256_batch, NULL, hash_keccak_256_truncate, NULL, NULL,
+     NULL, 0},
+    {HASH_CONFIG_BLAKE2B512, "BLAKE2b-512", (unsigned short)512, "~2^256", "2^512", 64,
+     hash_blake2b512_digest, hash_blake2b512_batch, hash_blake2b512_init, hash_blake2b512_truncate,
+     EVP_blake2b512, NULL, NULL, 0},
+    {HASH_CONFIG_BLAKE2S256, "BLAKE2s-256", (unsigned short)256, "~2^128", "2^256", 32,
+     hash_blake2s256_digest, hash_blake2s256_batch, hash_blake2s256_init, hash_blake2s256_truncate,
+     EVP_blake2s256, NULL, NULL, 0},
+    {HASH_CONFIG_BLAKE3, "BLAKE3", (unsigned short)256, "~2^128", "2^256", 32, hash_blake3_digest,
+     hash_blake3_batch, NULL, hash_blake3_truncate, NULL, NULL, NULL, 0},
+    {HASH_CONFIG_XXH3_64, "xxHash3-64", (unsigned short)64, "~2^32", "2^64", 8, hash_xxh3_64_digest,
+     hash_xxh3_64_batch, NULL, hash_xxh3_64_truncate, NULL, NULL, NULL, 0},
+    {HASH_CONFIG_XXH3_128, "xxHash3-128", (unsigned short)128, "~2^64", "2^128", 16,
+     hash_xxh3_128_digest, hash_xxh3_128_batch, NULL, hash_xxh3_128_truncate, NULL, NULL, NULL, 0},
+    {HASH_CONFIG_SIPHASH24, "SipHash-2-4", (unsigned short)64, "~2^32", "2^64", 8,
+     hash_siphash24_digest, hash_siphash24_batch, NULL, hash_siphash24_truncate, NULL, NULL, NULL,
+     0},
 };
 
 const unsigned short hash_config_len = ARRAY_SIZE(hash_config);
@@ -70,12 +183,57 @@ get_hash_config_menu() {
  */
 hash_config_t
 get_hash_config_item(enum hash_function_ids id) {
+    return *get_hash_config(id);
+}
+
+/**
+ * \brief          Get the registry entry of a hash function without copying it, for the
+ *                 workers that hash through its functions
+ *
+ * \param[in]      id The ID of the hash function
+ * \return         The registry entry of the hash function
+ */
+const hash_config_t*
+get_hash_config(enum hash_function_ids id) {
     if (id < 0 || id >= hash_config_len) {
         fprintf(stderr, "Invalid hash function ID: %d\n", id);
         exit(EXIT_FAILURE);
     }
 
-    return hash_config[id];
+    return &hash_config[id];
+}
+
+/**
+ * \brief          Check a hash function can hash before the workers of a run use it, through
+ *                 the init function of its registry entry
+ *
+ * \param[in]      hash The registry entry of the hash function
+ * \return         true when it can, false when its implementation is not available
+ */
+bool
+hash_config_init(const hash_config_t* hash) {
+    return hash->init == NULL || hash->init();
+}
+
+/**
+ * \brief          Write the hex of a binary digest, truncated to the bits of the hash function
+ *                 by the truncate function of its registry entry
+ *
+ * \param[in]      hash The registry entry of the hash function
+ * \param[in]      digest The binary digest, hash->digest_bytes long
+ * \param[out]     hex A buffer of get_hash_hex_length characters, or NULL to allocate one the
+ *                 caller frees
+ * \return         The hex in uppercase, or NULL on memory allocation failure
+ */
+char*
+hash_config_digest_hex(const hash_config_t* hash, const uint8_t* digest, char* hex) {
+    if (!hex) {
+        hex = malloc(hash->bits / 4 + 1);
+        if (!hex) {
+            return NULL;
+        }
+    }
+    return hash->truncate(digest, hex);
 }
 
 /**
@@ -91,4 +249,38 @@ uint16_t
 get_hash_hex_length(enum hash_function_ids hash_id) {
     hash_config_t hash_config_item = get_hash_config_item(hash_id);
     return hash_config_item.bits / 4 + 1; // +1 for null terminator
-}
\ No newline at end of file
+}
+
+/**
+ * \brief          Write the kernel a hash function runs on this processor: the Keccak kernel
+ *                 of the SHA-3 family, the lanes of BLAKE3, the compression of the block inputs
+ *                 next to OpenSSL for the other inputs of the Merkle-Damgard hashes, and the
+ *                 portable code of the hashes implemented here
+ *
+ * \param[in]      hash_id The ID of the hash function
+ * \param[out]     buffer Receives the name of the kernel
+ * \param[in]      size The size of the buffer in bytes
+ * \return         The buffer
+ */
+char*
+hash_config_kernel_name(enum hash_function_ids hash_id, char* buffer, size_t size) {
+    switch (hash_id) {
+        case HASH_CONFIG_SHA3_256:
+        case HASH_CONFIG_KECCAK256:
+            snprintf(buffer, size, "%s", hash_keccak_kernel_name(hash_keccak_kernel()));
+            return buffer;
+        case HASH_CONFIG_BLAKE3:
+            snprintf(buffer, size, "%s", hash_blake3_kernel_name(hash_blake3_kernel()));
+            return buffer;
+        default: break;
+    }
+
+    const hash_config_t* hash = get_hash_config(hash_id);
+    hash_block_kernel_t kernel;
+    if (hash->block_init && hash->block_init(&kernel)) {
+        snprintf(buffer, size, "OpenSSL; %s blocks", hash_block_impl_name(kernel.impl));
+    } else {
+        snprintf(buffer, size, "%s", hash->md ? "OpenSSL" : "scalar");
+    }
+    return buffer;
+}
@@ -15,6 +15,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "../../utils/hash_block.h"
+#include "../../utils/hash_function.h"
 #include "../../utils/utils.h"
 #include "../menu.h"
 
@@ -28,15 +30,73 @@ enum hash_function_ids {
     HASH_CONFIG_SHA256,
     HASH_CONFIG_SHA512,
     HASH_CONFIG_SHA384,
-    HASH_CONFIG_KECCAK256
+    HASH_CONFIG_KECCAK256,
+    HASH_CONFIG_BLAKE2B512,
+    HASH_CONFIG_BLAKE2S256,
+    HASH_CONFIG_BLAKE3,
+    HASH_CONFIG_XXH3_64,
+    HASH_CONFIG_XXH3_128,
+    HASH_CONFIG_SIPHASH24
 };
 
+/**
+ * \brief          The bytes of the longest hex digest with its null terminator, the size of the
+ *                 buffers the truncate functions write into
+ */
+#define BH_HASH_MAX_HEX (BH_HASH_MAX_DIGEST_BYTES * 2 + 1)
+
+/**
+ * \brief          Why a run can not start when hash_config_init fails for its hash function
+ */
+#define BH_HASH_UNAVAILABLE_MESSAGE "This hash function is not available in the installed OpenSSL."
+
+/**
+ * \brief          Write the hex of a binary digest truncated to the bits of its hash function
+ *
+ * \param[in]      digest The binary digest
+ * \param[out]     hex Receives the hex in uppercase, at most BH_HASH_MAX_HEX bytes
+ * \return         hex
+ */
+typedef char* (*hash_truncate_fn)(const uint8_t* digest, char* hex);
+
+/**
+ * \brief          Set up the single-block kernel of a hash function for the block inputs
+ *
+ * \param[out]     kernel The kernel to set up
+ * \return         true if the processor and the kernel support the hash function
+ */
+typedef bool (*hash_block_init_fn)(hash_block_kernel_t* kernel);
+
+/**
+ * \brief          Continue the one integer state of a toy hash on some bytes
+ *
+ * \param[in]      state The state before the bytes
+ * \param[in]      data The bytes
+ * \param[in]      len The number of bytes
+ * \return         The state after the bytes
+ */
+typedef uint32_t (*hash_toy_update_fn)(uint32_t state, const void* data, size_t len);
+
+/**
+ * \brief          The registry entry of a hash function. The workers look the entry up once
+ *                 and hash through its functions, so adding a hash function is adding its
+ *                 functions and its entry.
+ */
 typedef struct {
     enum hash_function_ids id;        ///< The ID of the hash function
     const char* label;                ///< The label for the hash function
     const unsigned short bits;        ///< The bit size of the hash function
     const char* estimated_collisions; ///< Estimated collisions for the hash function
     const char* space_size;           ///< Space size of the hash function
+    size_t digest_bytes; ///< The bytes of the binary digest, the hex is its last bits / 4 digits
+    hash_digest_fn digest; ///< Hashes one input into its binary digest
+    hash_batch_fn batch;   ///< Hashes a batch of inputs, in a loop specialized for the function
+    hash_init_fn init;     ///< Checks the function can hash before a run, NULL when it always can
+    hash_truncate_fn truncate; ///< Writes the hex of a digest into a buffer of the caller
+    const EVP_MD* (*md)(void); ///< Gets its OpenSSL digest, NULL when OpenSSL has none
+    hash_block_init_fn block_init; ///< Sets up its single-block kernel, NULL when it has none
+    hash_toy_update_fn toy_update; ///< Continues its state, NULL unless it is a toy hash
+    uint32_t toy_iv; ///< The initial state of a toy hash, iterated byte by byte without padding
 } hash_config_t;
 
 extern const hash_config_t hash_config[];    ///< Array of hash configurations
@@ -45,7 +105,11 @@ extern const unsigned short hash_config_len; ///< The number of hash configurati
 struct ListMenuItem* get_hash_config_menu();
 
 hash_config_t get_hash_config_item(enum hash_function_ids id);
+const hash_config_t* get_hash_config(enum hash_function_ids id);
+bool hash_config_init(const hash_config_t* hash);
+char* hash_config_digest_hex(const hash_config_t* hash, const uint8_t* digest, char* hex);
 
 uint16_t get_hash_hex_length(enum hash_function_ids hash_id);
+char* hash_config_kernel_name(enum hash_function_ids hash_id, char* buffer, size_t size);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,271 @@
+/**
+ * \file            hash_joux.c
+ * \brief           The page of the Joux multicollision: t single-block collisions of an
+ *                  iterated toy hash chained from its initial state. Any choice of one block
+ *                  of each pair is one of 2^t messages with the same digest, for t birthday
+ *                  searches instead of the work a random function needs. Some of the
+ *                  messages are hashed again in full to check them.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_joux.h"
+
+#define ACTION_SUBMIT 1
+
+/**
+ * \brief          The rows of the sub window below the button for the results of a run
+ */
+#define BH_JOUX_RESULT_ROWS 14
+
+/**
+ * \brief          The steps listed in the results, the rest are summed up in one row
+ */
+#define BH_JOUX_LISTED_STEPS 7
+
+static const struct FormButton s_joux_form_button = {"[ Build Multicollision ]", "[ Running... ]",
+                                                     ACTION_SUBMIT};
+
+static const struct FormInputField s_joux_form_field_metadata[] = {
+    {"Hash (menu number)", 1, 2, 0},
+    {"Collisions t", 20, 2, BH_JOUX_MAX_STEPS}};
+
+/**
+ * \brief          The index of the input fields in s_joux_form_field_metadata
+ */
+enum hash_joux_field_index { HASH_JOUX_FIELD_HASH = 0, HASH_JOUX_FIELD_STEPS };
+
+/**
+ * \brief          The results of the last run, kept to render them again after a resize
+ */
+typedef struct {
+    int attempts;             ///< The blocks compressed
+    double seconds;           ///< The duration of the run
+    const char* label;        ///< The label of the hash function
+    unsigned int state_bits;  ///< The bits of the state and the digest
+    unsigned int steps;       ///< The collisions asked for
+    unsigned int done;        ///< The collisions chained
+    unsigned int verified;    ///< The messages hashed again in full that gave the digest
+    unsigned int checked;     ///< The messages hashed again in full
+    int step_hashes[BH_JOUX_MAX_STEPS];     ///< The blocks compressed by every step
+    double step_ms[BH_JOUX_MAX_STEPS];      ///< The duration of every step
+    uint32_t states[BH_JOUX_MAX_STEPS + 1]; ///< The state before every step and the digest
+    uint32_t blocks[BH_JOUX_MAX_STEPS][2];  ///< The two colliding blocks of every step
+} hash_joux_result_t;
+
+// The results of the last search, rendered again when the page is restored
+static hash_joux_result_t s_joux_result;
+
+/****************************************************************
+ INTERNAL FUNCTION
+ ****************************************************************/
+
+/**
+ * \brief          Start a multicollision: create the table of states, then submit the
+ *                 workers of the first step.
+ *
+ * \param[in]      hash_id The toy hash function to chain the collisions on
+ * \param[in]      steps The single-block collisions to chain
+ * \param[in]      thread_pool The thread pool to run the workers on
+ * \param[out]     ctx The context of the run shared between all worker threads
+ */
+static void
+hash_joux_run(enum hash_function_ids hash_id, unsigned int steps, GThreadPool* thread_pool,
+              hash_collision_context_t* ctx) {
+    ctx->hash_id = hash_id;
+    ctx->joux = hash_joux_create(hash_id, steps);
+    if (!ctx->joux) {
+        render_full_page_error_exit(stdscr, 0, 0,
+                                    "Memory allocation failed for the table of states.");
+    }
+
+    // The messages hashed again in full at the end are picked from the run seed
+    attack_page_prepare_run(ctx, thread_pool, steps * hash_joux_candidates(ctx->joux));
+    hash_collision_submit_workers(ctx, HASH_PASS_JOUX);
+}
+
+/**
+ * \brief          Update the progress bar in the multicollision form sub window with the
+ *                 collisions chained so far.
+ *
+ * \param[in]      page The multicollision page
+ * \param[in]      ctx The context of the run
+ */
+static void
+hash_joux_progress_update(attack_page_t* page, hash_collision_context_t* ctx) {
+    if (!ctx->joux) {
+        return;
+    }
+
+    int step = g_atomic_int_get(&ctx->joux->step);
+    int total = (int)ctx->joux->steps;
+    attack_page_status(page, "Progress: %d%% (%d/%d collisions, %d blocks)", step * 100 / total,
+                       step, total, g_atomic_int_get(&ctx->result->attempts_made));
+}
+
+/**
+ * \brief          Keep the results of a finished run, with the blocks and the duration of
+ *                 every step
+ *
+ * \param[in]      ctx The context of the finished run
+ */
+static void
+hash_joux_collect_result(hash_collision_context_t* ctx) {
+    hash_collision_stats_t* stats = &ctx->result->stats;
+    hash_joux_result_t* result = &s_joux_result;
+    memset(result, 0, sizeof(*result));
+
+    result->attempts = ctx->result->attempts_made;
+    result->seconds = stats->finished_at > stats->started_at
+                          ? (double)(stats->finished_at - stats->started_at) / G_USEC_PER_SEC
+                          : 0.0;
+    result->label = get_hash_config_item(ctx->hash_id).label;
+    if (!ctx->joux) {
+        return;
+    }
+
+    hash_joux_t* joux = ctx->joux;
+    result->state_bits = joux->state_bits;
+    result->steps = joux->steps;
+    result->done = (unsigned int)joux->step;
+    result->verified = joux->verified;
+    result->checked = joux->checked;
+    result->states[0] = joux->states[0];
+
+    gint64 step_started_at = stats->started_at;
+    for (unsigned int i = 0; i < result->done; i++) {
+        result->step_hashes[i] = joux->step_hashes[i];
+        result->step_ms[i] = (double)(joux->step_finished_at[i] - step_started_at) / 1000.0;
+        result->states[i + 1] = joux->states[i + 1];
+        result->blocks[i][0] = joux->blocks[i][0];
+        result->blocks[i][1] = joux->blocks[i][1];
+        step_started_at = joux->step_finished_at[i];
+    }
+}
+
+/**
+ * \brief          Render the results of the last run: the blocks compressed against t
+ *                 birthday searches and against a random function, the digest every message
+ *                 shares, and the colliding blocks of the first steps
+ *
+ * \param[in]      win The sub window of the form
+ * \param[in]      starting_y The row of the first line of the results
+ */
+static void
+render_joux_result(WINDOW* win, int starting_y) {
+    const hash_joux_result_t* result = &s_joux_result;
+
+    int digits = (int)(result->state_bits + 3) / 4;
+    double expected = result->steps * 1.2533141373155003 * sqrt(ldexp(1.0, result->state_bits));
+
+    wattron(win, A_BOLD);
+    mvwprintw(win, starting_y, BH_FORM_X_PADDING, "%s, %u chained collisions for 2^%u messages",
+              result->label, result->steps, result->steps);
+    wattroff(win, A_BOLD);
+
+    mvwprintw(win, starting_y + 1, BH_FORM_X_PADDING,
+              "Cost      : %d blocks, %.0f expected for %u birthday searches of 2^%u states",
+              result->attempts, expected, result->steps, result->state_bits);
+    mvwprintw(win, starting_y + 2, BH_FORM_X_PADDING,
+              "Generic   : about 2^%u hashes for as many messages of a random function",
+              result->steps + result->state_bits);
+
+    bool complete = result->done == result->steps;
+    bool verified = complete && result->checked > 0 && result->verified == result->checked;
+    int color = verified ? BH_SUCCESS_COLOR_PAIR : BH_ERROR_COLOR_PAIR;
+    wattron(win, COLOR_PAIR(color));
+    if (complete) {
+        mvwprintw(win, starting_y + 4, BH_FORM_X_PADDING,
+                  "Messages  : 2^%u share the digest %0*x, %u of %u hashed again match",
+                  result->steps, digits, result->states[result->steps], result->verified,
+                  result->checked);
+    } else {
+        mvwprintw(win, starting_y + 4, BH_FORM_X_PADDING,
+                  "Messages  : stopped after %u of %u collisions", result->done, result->steps);
+    }
+    wattroff(win, COLOR_PAIR(color));
+
+    unsigned int listed = result->done < BH_JOUX_LISTED_STEPS ? result->done : BH_JOUX_LISTED_STEPS;
+    for (unsigned int i = 0; i < listed; i++) {
+        mvwprintw(win, starting_y + 5 + i, BH_FORM_X_PADDING,
+                  "  Step %-3u: %08x | %08x from %0*x, %d blocks, %.2f ms", i + 1,
+                  result->blocks[i][0], result->blocks[i][1], digits, result->states[i],
+                  result->step_hashes[i], result->step_ms[i]);
+    }
+    if (result->done > listed) {
+        mvwprintw(win, starting_y + 5 + listed, BH_FORM_X_PADDING, "  ...       %u more steps",
+                  result->done - listed);
+    }
+
+    mvwprintw(win, starting_y + 13, BH_FORM_X_PADDING, "Run       : %d blocks in %.3f s",
+              result->attempts, result->seconds);
+}
+
+/**
+ * \brief          Take the value from the form fields and start a multicollision
+ *
+ * \param[in]      page The multicollision page
+ * \param[in]      thread_pool The thread pool to use for running the workers
+ * \param[out]     ctx The context of the run shared between all worker threads
+ */
+static void
+hash_joux_start(attack_page_t* page, GThreadPool* thread_pool, hash_collision_context_t* ctx) {
+    int hash_number = atoi(attack_page_field_buffer(page, HASH_JOUX_FIELD_HASH));
+    unsigned int steps = atoi(attack_page_field_buffer(page, HASH_JOUX_FIELD_STEPS));
+
+    const char* message = NULL;
+    if (hash_number < 1 || hash_number > hash_config_len) {
+        message = "The hash is the number of a hash function in the menu.";
+    } else if (!hash_joux_supports(hash_config[hash_number - 1].id)) {
+        message = "Multicollisions are chained on the iterated toy hashes only.";
+    } else {
+        hash_joux_run(hash_config[hash_number - 1].id, steps, thread_pool, ctx);
+    }
+
+    if (message) {
+        attack_page_message(page, message);
+    }
+}
+
+static const attack_page_config_t s_joux_page = {
+    .title = "[ Joux Multicollision ]",
+    .name = "multicollision",
+    .description = "Chains t single-block collisions, so 2^t messages share one digest",
+    .fields = s_joux_form_field_metadata,
+    .field_count = ARRAY_SIZE(s_joux_form_field_metadata),
+    .button = &s_joux_form_button,
+    .result_rows = BH_JOUX_RESULT_ROWS,
+    .start = hash_joux_start,
+    .progress = hash_joux_progress_update,
+    .collect = hash_joux_collect_result,
+    .render_result = render_joux_result,
+};
+
+/**************************************************************
+                      EXTERNAL FUNCTIONS
+**************************************************************/
+
+/**
+ * \brief          Render the page that chains single-block collisions into a multicollision.
+ *
+ * \param[in]      content_win The window to render the multicollision page on
+ * \param[in]      header_win The window to render the header content, normally for
+ *                 the args of header_render
+ * \param[in]      footer_win The window to render the footer content, normally for
+ *                 the args of footer_render
+ * \param[out]     max_y The maximum height of the screen space that can be rendered. The
+ *                 value will be updated when a resize happens
+ * \param[out]     max_x The maximum width of the screen space that can be rendered. The
+ *                 value will be updated when a resize happens
+ * \param[in]      thread_pool The thread pool to use for running the search.
+ */
+void
+render_hash_joux_page(WINDOW* content_win, WINDOW* header_win, WINDOW* footer_win, int* max_y,
+                      int* max_x, GThreadPool* thread_pool) {
+    attack_page_render(&s_joux_page, content_win, header_win, footer_win, max_y, max_x,
+                       thread_pool);
+}
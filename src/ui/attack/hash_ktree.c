@@ -0,0 +1,303 @@
+/**
+ * \file            hash_ktree.c
+ * \brief           The page of the k-tree XOR solver, Wagner's generalized birthday
+ *                  algorithm: one input from each of k lists whose digests XOR to zero on
+ *                  their leading bits. The lists are hashed, then joined in pairs level by
+ *                  level, and the page shows how many entries each level kept and how the
+ *                  k * 2^(n / (log2 k + 1)) hashes compare with a birthday collision.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_ktree.h"
+
+#define ACTION_SUBMIT 1
+
+/**
+ * \brief          The rows of the sub window below the button for the results of a run
+ */
+#define BH_KTREE_RESULT_ROWS 18
+
+static const struct FormButton s_ktree_form_button = {"[ Run Solver ]", "[ Running... ]",
+                                                      ACTION_SUBMIT};
+
+static const struct FormInputField s_ktree_form_field_metadata[] = {
+    {"Hash (menu number)", 7, 2, 0},
+    {"Lists K (4, 8 or 16)", 4, 2, BH_KTREE_MAX_K},
+    {"Bit Width", 40, 2, BH_KTREE_MAX_BITS}};
+
+/**
+ * \brief          The index of the input fields in s_ktree_form_field_metadata
+ */
+enum hash_ktree_field_index {
+    HASH_KTREE_FIELD_HASH = 0,
+    HASH_KTREE_FIELD_K,
+    HASH_KTREE_FIELD_BITS
+};
+
+/**
+ * \brief          The results of the last run, kept to render them again after a resize
+ */
+typedef struct {
+    int hashes;                           ///< The inputs hashed
+    const char* label;                    ///< The label of the hash function
+    unsigned int k;                       ///< The number of lists
+    unsigned int levels;                  ///< The levels of joins
+    unsigned int bits;                    ///< The leading digest bits that XOR to zero
+    unsigned int level_bits;              ///< The bits every join but the last cancels
+    size_t list_size;                     ///< The entries of every list
+    double list_mib;                      ///< The memory of the lists
+    size_t level_entries[BH_KTREE_MAX_LEVELS + 1]; ///< The entries each level kept
+    double level_seconds[BH_KTREE_MAX_LEVELS + 1]; ///< The duration of each level
+    unsigned int levels_done;             ///< The levels that finished
+    guint64 solutions;                    ///< The solutions of the last join
+    bool found;                           ///< Whether the first solution was confirmed
+    char inputs[BH_KTREE_MAX_K][67];      ///< The input of every list of the solution
+    char digests[BH_KTREE_MAX_K][17];     ///< The compared bits of the digest of every input
+} hash_ktree_result_t;
+
+// The results of the last run, rendered again when the page is restored
+static hash_ktree_result_t s_ktree_result;
+
+/****************************************************************
+ INTERNAL FUNCTION
+ ****************************************************************/
+
+/**
+ * \brief          Start a k-tree run: create the lists of every level, then submit the
+ *                 workers that hash the first one. The last worker of a level submits the
+ *                 workers of the next.
+ *
+ * \param[in]      hash_id The hash function of every list
+ * \param[in]      k The number of lists
+ * \param[in]      bits The leading digest bits that must XOR to zero
+ * \param[in]      thread_pool The thread pool to run the workers on
+ * \param[out]     ctx The context of the run shared between all worker threads
+ */
+static void
+hash_ktree_run(enum hash_function_ids hash_id, unsigned int k, unsigned int bits,
+               GThreadPool* thread_pool, hash_collision_context_t* ctx) {
+    ctx->hash_id = hash_id;
+    ctx->ktree = hash_ktree_create(hash_id, k, bits);
+    if (!ctx->ktree) {
+        render_full_page_error_exit(stdscr, 0, 0, "Memory allocation failed for k-tree lists.");
+    }
+
+    // The inputs of the solution are regenerated from their index to confirm it
+    attack_page_prepare_run(ctx, thread_pool, (unsigned int)(k * ctx->ktree->list_size));
+    hash_collision_submit_workers(ctx, HASH_PASS_KTREE);
+}
+
+/**
+ * \brief          Update the progress bar while a k-tree runs, with the hashing of the lists
+ *                 first and the joins of every level after it
+ *
+ * \param[in]      page The k-tree page
+ * \param[in]      ctx The context of the running solver
+ */
+static void
+hash_ktree_run_progress_update(attack_page_t* page, hash_collision_context_t* ctx) {
+    hash_ktree_t* tree = ctx->ktree;
+    unsigned int level = (unsigned int)g_atomic_int_get(&tree->level);
+
+    // A finished run shows the inputs it hashed
+    if (level == 0 || g_atomic_int_get((gint*)&ctx->remaining_workers) == 0) {
+        attack_page_progress(page, g_atomic_int_get(&ctx->result->attempts_made),
+                             (int)ctx->max_attempts);
+        return;
+    }
+
+    unsigned int jobs = hash_ktree_level_jobs(tree, level);
+    unsigned int taken = (unsigned int)g_atomic_int_get(&tree->next_job);
+    attack_page_status(page, "Joining: level %u of %u, %u/%u joins started", level, tree->levels,
+                       taken < jobs ? taken : jobs, jobs);
+}
+
+/**
+ * \brief          Keep the results of a finished run
+ *
+ * \param[in]      ctx The context of the finished run
+ */
+static void
+hash_ktree_collect_result(hash_collision_context_t* ctx) {
+    hash_collision_stats_t* stats = &ctx->result->stats;
+    hash_ktree_result_t* result = &s_ktree_result;
+    memset(result, 0, sizeof(*result));
+
+    result->hashes = ctx->result->attempts_made;
+    if (!ctx->ktree) {
+        return;
+    }
+
+    hash_ktree_t* tree = ctx->ktree;
+    result->label = get_hash_config_item(tree->hash_id).label;
+    result->k = tree->k;
+    result->levels = tree->levels;
+    result->bits = tree->bits;
+    result->level_bits = tree->level_bits;
+    result->list_size = tree->list_size;
+    result->list_mib = (double)hash_ktree_estimate_bytes(tree->k, tree->bits) / (1024.0 * 1024.0);
+
+    gint64 level_start = stats->started_at;
+    for (unsigned int level = 0; level <= tree->levels && tree->level_finished_at[level]; level++) {
+        result->level_entries[level] = tree->level_entries[level];
+        result->level_seconds[level] =
+            (double)(tree->level_finished_at[level] - level_start) / G_USEC_PER_SEC;
+        level_start = tree->level_finished_at[level];
+        result->levels_done = level + 1;
+    }
+
+    result->solutions = tree->solutions;
+    result->found = tree->found;
+    for (unsigned int i = 0; i < tree->k; i++) {
+        snprintf(result->inputs[i], sizeof(result->inputs[i]), "%s",
+                 tree->input_hex[i] ? tree->input_hex[i] : "-");
+        snprintf(result->digests[i], sizeof(result->digests[i]), "%s",
+                 tree->found ? tree->truncated[i] : "-");
+    }
+}
+
+/**
+ * \brief          Render the results of the last run: the entries every level kept, the
+ *                 solutions of the last join, the hashes made against the 1.25 * 2^(n/2) of a
+ *                 birthday collision, and the input of every list with its digest
+ *
+ * \param[in]      win The sub window of the form
+ * \param[in]      starting_y The row of the first line of the results
+ */
+static void
+render_ktree_result(WINDOW* win, int starting_y) {
+    const hash_ktree_result_t* result = &s_ktree_result;
+
+    double birthday = 1.2533141373155003 * ldexp(1.0, (int)result->bits / 2)
+                      * (result->bits % 2 ? 1.4142135623730951 : 1.0);
+
+    wattron(win, A_BOLD);
+    mvwprintw(win, starting_y, BH_FORM_X_PADDING,
+              "XOR of %u lists on the first %u bits of %s, %u bits per join, %.2f MiB", result->k,
+              result->bits, result->label, result->level_bits, result->list_mib);
+    wattroff(win, A_BOLD);
+
+    int row = starting_y + 2;
+    for (unsigned int level = 0; level < result->levels_done; level++, row++) {
+        if (level == 0) {
+            mvwprintw(win, row, BH_FORM_X_PADDING,
+                      "Level 0   : %u lists of %zu digests hashed in %.3f s", result->k,
+                      result->list_size, result->level_seconds[level]);
+        } else if (level < result->levels) {
+            mvwprintw(win, row, BH_FORM_X_PADDING,
+                      "Level %u   : %u lists, %zu entries kept of %zu, %.3f s", level,
+                      result->k >> level, result->level_entries[level],
+                      (size_t)(result->k >> level) * result->list_size,
+                      result->level_seconds[level]);
+        } else {
+            mvwprintw(win, row, BH_FORM_X_PADDING, "Level %u   : last join, %llu solutions, %.3f s",
+                      level, (unsigned long long)result->solutions, result->level_seconds[level]);
+        }
+    }
+
+    row++;
+    int color = result->found ? BH_SUCCESS_COLOR_PAIR : BH_ERROR_COLOR_PAIR;
+    wattron(win, COLOR_PAIR(color));
+    mvwprintw(win, row++, BH_FORM_X_PADDING,
+              "Solution  : %s with %d hashes, a collision takes about %.0f",
+              result->found ? "found" : "not found", result->hashes, birthday);
+    wattroff(win, COLOR_PAIR(color));
+
+    if (!result->found) {
+        return;
+    }
+
+    // Two inputs a line, an input is cut to its first 24 hex characters
+    for (unsigned int i = 0; i < result->k; i += 2, row++) {
+        wmove(win, row, BH_FORM_X_PADDING);
+        for (unsigned int j = i; j < i + 2 && j < result->k; j++) {
+            wprintw(win, "%c: %-24.24s %-16s   ", 'A' + j, result->inputs[j], result->digests[j]);
+        }
+    }
+}
+
+/**
+ * \brief          Take the value from the form fields and start a k-tree run when its lists
+ *                 fit the memory budget
+ *
+ * \param[in]      page The k-tree page
+ * \param[in]      thread_pool The thread pool to use for running the solver
+ * \param[out]     ctx The context of the run shared between all worker threads
+ */
+static void
+hash_ktree_start(attack_page_t* page, GThreadPool* thread_pool, hash_collision_context_t* ctx) {
+    int hash = atoi(attack_page_field_buffer(page, HASH_KTREE_FIELD_HASH));
+    unsigned int k = atoi(attack_page_field_buffer(page, HASH_KTREE_FIELD_K));
+    unsigned int bits = atoi(attack_page_field_buffer(page, HASH_KTREE_FIELD_BITS));
+
+    char message[128] = {0};
+    unsigned int levels = k == 16 ? 4 : k == 8 ? 3 : 2;
+    if (hash < 1 || hash > hash_config_len) {
+        snprintf(message, sizeof(message), "The hash is the number of a hash function in a menu.");
+    } else if (!hash_config_init(&hash_config[hash - 1])) {
+        snprintf(message, sizeof(message), BH_HASH_UNAVAILABLE_MESSAGE);
+    } else if (k != 4 && k != 8 && k != 16) {
+        snprintf(message, sizeof(message), "The number of lists must be 4, 8 or 16.");
+    } else if (bits < 2 * (levels + 1) || bits > hash_config[hash - 1].bits) {
+        snprintf(message, sizeof(message),
+                 "The bit width must be from %u to the %u bits of the digest.", 2 * (levels + 1),
+                 hash_config[hash - 1].bits < BH_KTREE_MAX_BITS ? hash_config[hash - 1].bits
+                                                                 : BH_KTREE_MAX_BITS);
+    } else if (hash_ktree_estimate_bytes(k, bits) / (1024 * 1024)
+               > hash_plan_default_budget_mib()) {
+        snprintf(message, sizeof(message), "The lists need %zu MiB, over the %zu MiB budget.",
+                 hash_ktree_estimate_bytes(k, bits) / (1024 * 1024),
+                 hash_plan_default_budget_mib());
+    } else {
+        hash_ktree_run(hash_config[hash - 1].id, k, bits, thread_pool, ctx);
+    }
+
+    if (message[0]) {
+        attack_page_message(page, message);
+    }
+}
+
+static const attack_page_config_t s_ktree_page = {
+    .title = "[ K-tree XOR Solver ]",
+    .name = "k-tree",
+    .description =
+        "Finds one input of each of k lists whose digests XOR to zero on their first bits",
+    .fields = s_ktree_form_field_metadata,
+    .field_count = ARRAY_SIZE(s_ktree_form_field_metadata),
+    .button = &s_ktree_form_button,
+    .result_rows = BH_KTREE_RESULT_ROWS,
+    .start = hash_ktree_start,
+    .progress = hash_ktree_run_progress_update,
+    .collect = hash_ktree_collect_result,
+    .render_result = render_ktree_result,
+};
+
+/**************************************************************
+                      EXTERNAL FUNCTIONS
+**************************************************************/
+
+/**
+ * \brief          Render the page that solves the XOR of k lists with a k-tree.
+ *
+ * \param[in]      content_win The window to render the k-tree page on
+ * \param[in]      header_win The window to render the header content, normally for
+ *                 the args of header_render
+ * \param[in]      footer_win The window to render the footer content, normally for
+ *                 the args of footer_render
+ * \param[out]     max_y The maximum height of the screen space that can be rendered. The
+ *                 value will be updated when a resize happens
+ * \param[out]     max_x The maximum width of the screen space that can be rendered. The
+ *                 value will be updated when a resize happens
+ * \param[in]      thread_pool The thread pool to use for running the solver.
+ */
+void
+render_hash_ktree_page(WINDOW* content_win, WINDOW* header_win, WINDOW* footer_win, int* max_y,
+                       int* max_x, GThreadPool* thread_pool) {
+    attack_page_render(&s_ktree_page, content_win, header_win, footer_win, max_y, max_x,
+                       thread_pool);
+}
@@ -16,7 +16,20 @@ static ITEM** s_hash_menu_choices_items = NULL;
 static MENU* s_hash_menu = NULL;
 static WINDOW* s_hash_menu_sub_win = NULL;
 
-static const int hash_menu_window_rows = 40; ///< The number of rows for the hash menu window
+static int s_hash_menu_sub_win_cols = 0; ///< The columns the items need, set by hash_menu_init
+
+// The items after the hash functions: the comparison of several of them and the searches
+static const hash_menu_tool_t s_hash_menu_tools[] = {
+    {"Compare", "(all hashes)", render_hash_compare_page},
+    {"Prefix search", "(preimage)", render_hash_prefix_page},
+    {"Claw search", "(two families)", render_hash_claw_page},
+    {"K-tree XOR", "(k lists)", render_hash_ktree_page},
+    {"Near collision", "(Hamming)", render_hash_near_page},
+    {"Joux multicollision", "(toy hashes)", render_hash_joux_page},
+    {"Rainbow table", "(TMTO)", render_hash_rainbow_page},
+    {"Output analysis", "(toy hashes)", render_hash_analysis_page},
+};
+static const unsigned short s_hash_menu_tools_len = ARRAY_SIZE(s_hash_menu_tools);
 
 MENU*
 hash_menu_get() {
@@ -29,9 +42,47 @@ hash_menu_get() {
     return s_hash_menu; // Return the current hash menu
 }
 
+/**
+ * \brief          Get the number of items of the menu, one per hash function and the tool
+ *                 items after them
+ *
+ * \return         The number of items
+ */
+unsigned short
+hash_menu_item_count() {
+    return hash_config_len + s_hash_menu_tools_len;
+}
+
+/**
+ * \brief          Get the tool a menu item opens
+ *
+ * \param[in]      index The index of the item
+ * \return         The tool, or NULL for the items of the hash functions
+ */
+const hash_menu_tool_t*
+hash_menu_tool(int index) {
+    if (index < hash_config_len || index >= hash_menu_item_count()) {
+        return NULL;
+    }
+    return &s_hash_menu_tools[index - hash_config_len];
+}
+
 static int
 hash_menu_window_cols() {
-    return MENU_PADDING_Y + hash_config_len + MENU_PADDING_Y;
+    return MENU_PADDING_Y + hash_menu_item_count() + MENU_PADDING_Y;
+}
+
+/**
+ * \brief          Get the width of the hash menu window: 40 columns, or more when the
+ *                 longest item and the borders do not fit in them
+ *
+ * \return         The number of columns for the hash menu window
+ */
+static int
+hash_menu_window_rows() {
+    // The sub-window starts right of the left border
+    int cols = 1 + s_hash_menu_sub_win_cols + 1;
+    return cols > 40 ? cols : 40;
 }
 
 /**
@@ -52,14 +103,26 @@ hash_menu_init(WINDOW* win) {
                                     "Memory allocation fails for get_hash_config_menu");
     }
 
+    struct ListMenuItem* choices =
+        realloc(hash_menu_choices, hash_menu_item_count() * sizeof(struct ListMenuItem));
+    if (choices == NULL) {
+        render_full_page_error_exit(stdscr, 0, 0, "Memory allocation fails for hash menu choices");
+    }
+    hash_menu_choices = choices;
+    for (unsigned short i = 0; i < s_hash_menu_tools_len; i++) {
+        hash_menu_choices[hash_config_len + i] = (struct ListMenuItem){
+            s_hash_menu_tools[i].label, s_hash_menu_tools[i].description};
+    }
+
     // Resize the window for the menu BEFORE creating the sub-window
     // as the size of the sub-window depends on the main window size
-    wresize(win, hash_menu_window_cols(), hash_menu_window_rows);
+    s_hash_menu_sub_win_cols = list_menu_width(hash_menu_choices, hash_menu_item_count());
+    wresize(win, hash_menu_window_cols(), hash_menu_window_rows());
 
-    s_hash_menu_sub_win =
-        derwin(win, hash_config_len, 32, 2, 1); // Create a sub-window for the menu
+    // Create a sub-window for the menu
+    s_hash_menu_sub_win = derwin(win, hash_menu_item_count(), s_hash_menu_sub_win_cols, 2, 1);
 
-    list_menu_init(win, hash_menu_choices, hash_config_len, &s_hash_menu_choices_items,
+    list_menu_init(win, hash_menu_choices, hash_menu_item_count(), &s_hash_menu_choices_items,
                    &s_hash_menu, &s_hash_menu_sub_win);
     return true;
 }
@@ -83,12 +146,12 @@ hash_menu_render(WINDOW* win, int max_y, int max_x) {
     }
 
     // Center the menu window
-    int y = (max_y - 20) / 2;
-    int x = (max_x - hash_menu_window_rows) / 2;
+    int y = (max_y - hash_menu_window_cols()) / 2;
+    int x = (max_x - hash_menu_window_rows()) / 2;
     mvwin(win, y, x);
 
     box(win, 0, 0);
-    print_in_middle(win, 0, 0, hash_menu_window_rows, " Select hash function ",
+    print_in_middle(win, 0, 0, hash_menu_window_rows(), " Select hash function ",
                     COLOR_PAIR(BH_MAIN_COLOR_PAIR));
 
     // Render the menu navigation text
@@ -134,14 +197,14 @@ hash_menu_restore(WINDOW* win, int max_y, int max_x) {
     }
 
     // Check if the window size is equal to hash_menu_window_cols(), resize it if not
-    if (getmaxy(win) != hash_menu_window_cols() || getmaxx(win) != hash_menu_window_rows) {
-        wresize(win, hash_menu_window_cols(), hash_menu_window_rows);
+    if (getmaxy(win) != hash_menu_window_cols() || getmaxx(win) != hash_menu_window_rows()) {
+        wresize(win, hash_menu_window_cols(), hash_menu_window_rows());
 
         // Resize the sub-window to match the new window size
-        wresize(s_hash_menu_sub_win, hash_config_len, 32);
+        wresize(s_hash_menu_sub_win, hash_menu_item_count(), s_hash_menu_sub_win_cols);
         mvwin(s_hash_menu_sub_win, 2, 1); // Move the sub-window to the correct position
 
-        mvwin(win, (max_y - hash_menu_window_cols()) / 2, (max_x - hash_menu_window_rows) / 2);
+        mvwin(win, (max_y - hash_menu_window_cols()) / 2, (max_x - hash_menu_window_rows()) / 2);
     }
 
     post_menu(s_hash_menu);              // Post the menu to the window
@@ -19,9 +19,35 @@
 
 #include "../../utils/utils.h"
 #include "../menu.h"
+#include "hash_analysis.h"
+#include "hash_claw.h"
+#include "hash_compare.h"
 #include "hash_config.h"
+#include "hash_joux.h"
+#include "hash_ktree.h"
+#include "hash_near.h"
+#include "hash_prefix.h"
+#include "hash_rainbow.h"
+
+/**
+ * \brief          Render the page a tool item of the hash menu opens, until the user leaves it
+ */
+typedef void (*hash_menu_tool_render_fn)(WINDOW* content_win, WINDOW* header_win,
+                                         WINDOW* footer_win, int* max_y, int* max_x,
+                                         GThreadPool* thread_pool);
+
+/**
+ * \brief          A tool item of the hash menu, listed after the hash functions
+ */
+typedef struct {
+    const char* label;               ///< The menu label at the left
+    const char* description;         ///< The longer description at the right
+    hash_menu_tool_render_fn render; ///< Renders the page of the tool
+} hash_menu_tool_t;
 
 MENU* hash_menu_get();
+unsigned short hash_menu_item_count();
+const hash_menu_tool_t* hash_menu_tool(int index);
 bool hash_menu_init(WINDOW* win);
 MENU* hash_menu_render(WINDOW* win, int max_y, int max_x);
 void hash_menu_erase();
@@ -0,0 +1,281 @@
+/**
+ * \file            hash_near.c
+ * \brief           The page of the near-collision search: two inputs whose digests differ in
+ *                  at most d of their leading bits, the pairs the avalanche of a hash function
+ *                  makes as rare as a random function would. The digests are indexed on d + 1
+ *                  substrings, so a candidate pair always shares one, and the page shows the
+ *                  bit positions where the two digests differ.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_near.h"
+
+#define ACTION_SUBMIT 1
+
+/**
+ * \brief          The rows of the sub window below the button for the results of a search
+ */
+#define BH_NEAR_RESULT_ROWS 12
+
+static const struct FormButton s_near_form_button = {"[ Run Search ]", "[ Running... ]",
+                                                     ACTION_SUBMIT};
+
+static const struct FormInputField s_near_form_field_metadata[] = {
+    {"Hash (menu number)", 7, 2, 0},
+    {"Compared Bits", 48, 2, BH_NEAR_MAX_BITS},
+    {"Max Distance", 4, 2, BH_NEAR_MAX_DISTANCE},
+    {"Max Attempts", 60000, 8, 0}};
+
+/**
+ * \brief          The index of the input fields in s_near_form_field_metadata
+ */
+enum hash_near_field_index {
+    HASH_NEAR_FIELD_HASH = 0,
+    HASH_NEAR_FIELD_BITS,
+    HASH_NEAR_FIELD_DISTANCE,
+    HASH_NEAR_FIELD_MAX_ATTEMPTS
+};
+
+/**
+ * \brief          The results of the last search, kept to render them again after a resize
+ */
+typedef struct {
+    int attempts;               ///< The digests looked up
+    double seconds;             ///< The duration of the run
+    const char* label;          ///< The label of the hash function
+    unsigned int bits;          ///< The leading digest bits compared
+    unsigned int distance;      ///< The most bits the digests may differ in
+    unsigned int index_count;   ///< The number of substring indexes
+    unsigned int index_bits[2]; ///< The bits of the shortest and the longest substring
+    double index_mib;           ///< The size of the digests and the indexes
+    guint64 candidates;         ///< The digests that shared a substring and were compared
+    bool found;                 ///< Whether a near-collision was found
+    guint64 point;              ///< The digests looked up to and with the near-collision
+    unsigned int found_distance; ///< The bits the two digests differ in
+    char inputs[2][67];         ///< The two inputs, the earlier first
+    char digests[2][BH_NEAR_MAX_BITS + 1]; ///< The compared bits of both digests in binary
+    char marks[BH_NEAR_MAX_BITS + 1]; ///< A '^' under every bit where the digests differ
+    char positions[BH_NEAR_MAX_DISTANCE * 4 + 1]; ///< The differing bit positions, first is 0
+} hash_near_result_t;
+
+// The results of the last search, rendered again when the page is restored
+static hash_near_result_t s_near_result;
+
+/****************************************************************
+ INTERNAL FUNCTION
+ ****************************************************************/
+
+/**
+ * \brief          Start a near-collision search: create the digests and their substring
+ *                 indexes, then submit the workers.
+ *
+ * \param[in]      hash_id The hash function to search with
+ * \param[in]      bits The leading digest bits compared
+ * \param[in]      distance The most bits the digests may differ in
+ * \param[in]      max_attempts The number of inputs to hash
+ * \param[in]      thread_pool The thread pool to run the workers on
+ * \param[out]     ctx The context of the run shared between all worker threads
+ */
+static void
+hash_near_run(enum hash_function_ids hash_id, unsigned int bits, unsigned int distance,
+              unsigned int max_attempts, GThreadPool* thread_pool, hash_collision_context_t* ctx) {
+    if (max_attempts == 0) {
+        max_attempts = 10000; // Default to 10,000 attempts for zero attempts
+    }
+
+    ctx->hash_id = hash_id;
+    ctx->near = hash_near_search_create(bits, distance, max_attempts);
+    if (!ctx->near) {
+        render_full_page_error_exit(stdscr, 0, 0,
+                                    "Memory allocation failed for near-collision indexes.");
+    }
+
+    // The earlier input of a near-collision is regenerated from its index
+    attack_page_prepare_run(ctx, thread_pool, max_attempts);
+    hash_collision_submit_workers(ctx, HASH_PASS_NEAR);
+}
+
+/**
+ * \brief          Keep the results of a finished search, with both digests in binary and the
+ *                 positions they differ at
+ *
+ * \param[in]      ctx The context of the finished run
+ */
+static void
+hash_near_collect_result(hash_collision_context_t* ctx) {
+    hash_collision_stats_t* stats = &ctx->result->stats;
+    hash_near_result_t* result = &s_near_result;
+    memset(result, 0, sizeof(*result));
+
+    result->attempts = ctx->result->attempts_made;
+    result->seconds = stats->finished_at > stats->started_at
+                          ? (double)(stats->finished_at - stats->started_at) / G_USEC_PER_SEC
+                          : 0.0;
+    result->label = get_hash_config_item(ctx->hash_id).label;
+    if (!ctx->near) {
+        return;
+    }
+
+    hash_near_search_t* near = ctx->near;
+    result->bits = near->bits;
+    result->distance = near->distance;
+    result->index_count = near->index_count;
+    result->index_bits[0] = near->index_bits[near->index_count - 1];
+    result->index_bits[1] = near->index_bits[0];
+    result->index_mib = (double)hash_near_search_memory_size(near) / (1024.0 * 1024.0);
+    result->candidates = near->candidates;
+    result->found = near->found;
+    result->point = near->point;
+    result->found_distance = near->found_distance;
+    snprintf(result->inputs[0], sizeof(result->inputs[0]), "%s",
+             ctx->result->collision_input_1 ? ctx->result->collision_input_1 : "-");
+    snprintf(result->inputs[1], sizeof(result->inputs[1]), "%s",
+             ctx->result->collision_input_2 ? ctx->result->collision_input_2 : "-");
+    if (!near->found) {
+        return;
+    }
+
+    // The first digest bit is the top one of the compared bits
+    size_t used = 0;
+    for (unsigned int i = 0; i < near->bits; i++) {
+        unsigned int shift = near->bits - 1 - i;
+        unsigned int a = (near->found_values[0] >> shift) & 1;
+        unsigned int b = (near->found_values[1] >> shift) & 1;
+        result->digests[0][i] = a ? '1' : '0';
+        result->digests[1][i] = b ? '1' : '0';
+        result->marks[i] = a != b ? '^' : ' ';
+        if (a != b && used < sizeof(result->positions)) {
+            used += snprintf(result->positions + used, sizeof(result->positions) - used, "%s%u",
+                             used ? ", " : "", i);
+        }
+    }
+}
+
+/**
+ * \brief          Render the results of the last search: where the near-collision was found
+ *                 against the digests a random function needs, the two digests with the bits
+ *                 they differ in marked, and the two inputs
+ *
+ * \param[in]      win The sub window of the form
+ * \param[in]      starting_y The row of the first line of the results
+ */
+static void
+render_near_result(WINDOW* win, int starting_y) {
+    const hash_near_result_t* result = &s_near_result;
+
+    double expected = hash_near_expected_inputs(result->bits, result->distance);
+
+    wattron(win, A_BOLD);
+    mvwprintw(win, starting_y, BH_FORM_X_PADDING, "%s, at most %u of the first %u bits apart",
+              result->label, result->distance, result->bits);
+    wattroff(win, A_BOLD);
+
+    mvwprintw(win, starting_y + 1, BH_FORM_X_PADDING,
+              "Indexes   : %u substrings of %u to %u bits, %.2f MiB, %llu candidates compared",
+              result->index_count, result->index_bits[0], result->index_bits[1], result->index_mib,
+              (unsigned long long)result->candidates);
+
+    int color = result->found ? BH_SUCCESS_COLOR_PAIR : BH_ERROR_COLOR_PAIR;
+    wattron(win, COLOR_PAIR(color));
+    if (result->found) {
+        mvwprintw(win, starting_y + 3, BH_FORM_X_PADDING,
+                  "Near      : %u bits apart after %llu digests, %.0f expected",
+                  result->found_distance, (unsigned long long)result->point, expected);
+    } else {
+        mvwprintw(win, starting_y + 3, BH_FORM_X_PADDING,
+                  "Near      : not found in %d digests, %.0f expected", result->attempts, expected);
+    }
+    wattroff(win, COLOR_PAIR(color));
+
+    mvwprintw(win, starting_y + 4, BH_FORM_X_PADDING, "  Input 1 : %s", result->inputs[0]);
+    mvwprintw(win, starting_y + 5, BH_FORM_X_PADDING, "  Input 2 : %s", result->inputs[1]);
+    if (result->found) {
+        mvwprintw(win, starting_y + 6, BH_FORM_X_PADDING, "  Digest 1: %s", result->digests[0]);
+        mvwprintw(win, starting_y + 7, BH_FORM_X_PADDING, "  Digest 2: %s", result->digests[1]);
+        wattron(win, COLOR_PAIR(BH_ERROR_COLOR_PAIR));
+        mvwprintw(win, starting_y + 8, BH_FORM_X_PADDING, "            %s", result->marks);
+        wattroff(win, COLOR_PAIR(BH_ERROR_COLOR_PAIR));
+        mvwprintw(win, starting_y + 9, BH_FORM_X_PADDING, "  Bits    : %s", result->positions);
+    }
+    mvwprintw(win, starting_y + 11, BH_FORM_X_PADDING, "Run       : %d digests in %.3f s",
+              result->attempts, result->seconds);
+}
+
+/**
+ * \brief          Take the value from the form fields and start a near-collision search
+ *
+ * \param[in]      page The near-collision page
+ * \param[in]      thread_pool The thread pool to use for running the search
+ * \param[out]     ctx The context of the run shared between all worker threads
+ */
+static void
+hash_near_start(attack_page_t* page, GThreadPool* thread_pool, hash_collision_context_t* ctx) {
+    int hash_number = atoi(attack_page_field_buffer(page, HASH_NEAR_FIELD_HASH));
+    unsigned int bits = atoi(attack_page_field_buffer(page, HASH_NEAR_FIELD_BITS));
+    unsigned int distance = atoi(attack_page_field_buffer(page, HASH_NEAR_FIELD_DISTANCE));
+    unsigned int attempts = atoi(attack_page_field_buffer(page, HASH_NEAR_FIELD_MAX_ATTEMPTS));
+
+    const char* message = NULL;
+    if (hash_number < 1 || hash_number > hash_config_len) {
+        message = "The hash is the number of a hash function in the menu.";
+    } else if (!hash_config_init(&hash_config[hash_number - 1])) {
+        message = BH_HASH_UNAVAILABLE_MESSAGE;
+    } else if (bits > hash_config[hash_number - 1].bits) {
+        message = "The compared bits can not be longer than the digest.";
+    } else if (distance >= bits) {
+        message = "The distance must be below the compared bits.";
+    } else if (hash_near_estimate_bytes(distance, attempts) / (1024 * 1024)
+               > hash_plan_default_budget_mib()) {
+        message = "The indexes of that many digests do not fit the memory budget.";
+    } else {
+        hash_near_run(hash_config[hash_number - 1].id, bits, distance, attempts, thread_pool,
+                      ctx);
+    }
+
+    if (message) {
+        attack_page_message(page, message);
+    }
+}
+
+static const attack_page_config_t s_near_page = {
+    .title = "[ Near-Collision Search ]",
+    .name = "near-collision search",
+    .description = "Finds two inputs whose digests differ in at most d of their first bits",
+    .fields = s_near_form_field_metadata,
+    .field_count = ARRAY_SIZE(s_near_form_field_metadata),
+    .button = &s_near_form_button,
+    .result_rows = BH_NEAR_RESULT_ROWS,
+    .start = hash_near_start,
+    .collect = hash_near_collect_result,
+    .render_result = render_near_result,
+};
+
+/**************************************************************
+                      EXTERNAL FUNCTIONS
+**************************************************************/
+
+/**
+ * \brief          Render the page that searches for two digests within a Hamming distance.
+ *
+ * \param[in]      content_win The window to render the near-collision search page on
+ * \param[in]      header_win The window to render the header content, normally for
+ *                 the args of header_render
+ * \param[in]      footer_win The window to render the footer content, normally for
+ *                 the args of footer_render
+ * \param[out]     max_y The maximum height of the screen space that can be rendered. The
+ *                 value will be updated when a resize happens
+ * \param[out]     max_x The maximum width of the screen space that can be rendered. The
+ *                 value will be updated when a resize happens
+ * \param[in]      thread_pool The thread pool to use for running the search.
+ */
+void
+render_hash_near_page(WINDOW* content_win, WINDOW* header_win, WINDOW* footer_win, int* max_y,
+                      int* max_x, GThreadPool* thread_pool) {
+    attack_page_render(&s_near_page, content_win, header_win, footer_win, max_y, max_x,
+                       thread_pool);
+}
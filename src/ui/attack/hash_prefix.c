@@ -0,0 +1,275 @@
+/**
+ * \file            hash_prefix.c
+ * \brief           The page of the targeted prefix search, the partial preimage of a bit
+ *                  pattern: every worker hashes its own stream of random inputs and checks
+ *                  whether a digest starts with the pattern. The same digests feed a collision
+ *                  detector on the same leading bits, so the 2^n cost of the prefix and the
+ *                  2^(n/2) cost of the collision are measured on one budget.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_prefix.h"
+
+#define ACTION_SUBMIT 1
+
+/**
+ * \brief          The rows of the sub window below the button for the results of a search
+ */
+#define BH_PREFIX_RESULT_ROWS 12
+
+static const struct FormButton s_prefix_form_button = {"[ Run Search ]", "[ Running... ]",
+                                                        ACTION_SUBMIT};
+
+static const struct FormInputField s_prefix_form_field_metadata[] = {
+    {"Hash (menu number)", 7, 2, 0},
+    {"Prefix Bits", 12, 2, BH_PREFIX_MAX_BITS},
+    {"Target Pattern", 2989, 8, 0},
+    {"Max Attempts", 60000, 8, 0}};
+
+/**
+ * \brief          The index of the input fields in s_prefix_form_field_metadata
+ */
+enum hash_prefix_field_index {
+    HASH_PREFIX_FIELD_HASH = 0,
+    HASH_PREFIX_FIELD_BITS,
+    HASH_PREFIX_FIELD_PATTERN,
+    HASH_PREFIX_FIELD_MAX_ATTEMPTS
+};
+
+/**
+ * \brief          The results of the last search, kept to render them again after a resize
+ */
+typedef struct {
+    int attempts;                ///< The digests checked by the run
+    double seconds;              ///< The duration of the run
+    const char* label;           ///< The label of the hash function
+    unsigned int bits;           ///< The leading bits fixed by the pattern
+    char pattern[BH_PREFIX_MAX_BITS + 1]; ///< The pattern in binary
+    bool prefix_found;           ///< Whether a digest started with the pattern
+    guint64 prefix_point;        ///< The digests checked up to and with the match
+    char prefix_input[65];       ///< The input that matched
+    char prefix_digest[33];      ///< The start of its digest
+    bool collision_found;        ///< Whether two digests shared the leading bits
+    guint64 collision_point;     ///< The digests looked up to and with the collision
+    char collision_inputs[2][65]; ///< The two inputs that collided
+} hash_prefix_result_t;
+
+// The results of the last search, rendered again when the page is restored
+static hash_prefix_result_t s_prefix_result;
+
+/****************************************************************
+ INTERNAL FUNCTION
+ ****************************************************************/
+
+/**
+ * \brief          Start a prefix search: create the target of the pattern and a detector for
+ *                 the collision on the same leading bits, then submit the workers.
+ *
+ * \param[in]      hash_id The hash function to search with
+ * \param[in]      bits The leading digest bits fixed by the pattern
+ * \param[in]      pattern The pattern as a number, its lowest bits bits are used
+ * \param[in]      max_attempts The number of inputs to hash
+ * \param[in]      thread_pool The thread pool to run the workers on
+ * \param[out]     ctx The context of the run shared between all worker threads
+ */
+static void
+hash_prefix_run(enum hash_function_ids hash_id, unsigned int bits, uint64_t pattern,
+                unsigned int max_attempts, GThreadPool* thread_pool,
+                hash_collision_context_t* ctx) {
+    if (max_attempts == 0) {
+        max_attempts = 10000; // Default to 10,000 attempts for zero attempts
+    }
+
+    ctx->hash_id = hash_id;
+    ctx->prefix = hash_prefix_target_create(bits, pattern);
+    ctx->detectors = hash_detector_set_create();
+    if (!ctx->prefix || !ctx->detectors) {
+        render_full_page_error_exit(stdscr, 0, 0, "Memory allocation failed for prefix target.");
+    }
+
+    // A pattern as long as the digest makes the collision one of the whole digest
+    unsigned int truncation = bits < get_hash_config_item(hash_id).bits ? bits : 0;
+    if (!hash_detector_set_add(ctx->detectors, hash_id, truncation, max_attempts)) {
+        render_full_page_error_exit(stdscr, 0, 0, "Memory allocation failed for detector table.");
+    }
+
+    // The inputs are regenerated from their index to confirm a collision
+    attack_page_prepare_run(ctx, thread_pool, max_attempts);
+    hash_collision_submit_workers(ctx, HASH_PASS_PREFIX);
+}
+
+/**
+ * \brief          Keep the results of a finished search
+ *
+ * \param[in]      ctx The context of the finished run
+ */
+static void
+hash_prefix_collect_result(hash_collision_context_t* ctx) {
+    hash_collision_stats_t* stats = &ctx->result->stats;
+    hash_prefix_result_t* result = &s_prefix_result;
+    memset(result, 0, sizeof(*result));
+
+    result->attempts = ctx->result->attempts_made;
+    result->seconds = stats->finished_at > stats->started_at
+                          ? (double)(stats->finished_at - stats->started_at) / G_USEC_PER_SEC
+                          : 0.0;
+    result->label = get_hash_config_item(ctx->hash_id).label;
+    if (!ctx->prefix) {
+        return;
+    }
+
+    hash_prefix_target_t* target = ctx->prefix;
+    result->bits = target->bits;
+    for (unsigned int i = 0; i < target->bits; i++) {
+        result->pattern[i] = (target->pattern >> (BH_PREFIX_MAX_BITS - 1 - i)) & 1 ? '1' : '0';
+    }
+
+    result->prefix_found = target->found;
+    result->prefix_point = target->point;
+    snprintf(result->prefix_input, sizeof(result->prefix_input), "%s",
+             target->input_hex ? target->input_hex : "-");
+    snprintf(result->prefix_digest, sizeof(result->prefix_digest), "%s",
+             target->hash_hex ? target->hash_hex : "-");
+
+    if (ctx->detectors && ctx->detectors->count > 0) {
+        hash_detector_t* detector = &ctx->detectors->detectors[0];
+        result->collision_found = detector->collision_found;
+        result->collision_point = detector->digests;
+        snprintf(result->collision_inputs[0], sizeof(result->collision_inputs[0]), "%s",
+                 detector->collision_input_1 ? detector->collision_input_1 : "-");
+        snprintf(result->collision_inputs[1], sizeof(result->collision_inputs[1]), "%s",
+                 detector->collision_input_2 ? detector->collision_input_2 : "-");
+    }
+}
+
+/**
+ * \brief          Render the results of the last search: where the prefix and the collision
+ *                 on the same bits were found, against the 2^n and 1.25 * 2^(n/2) digests
+ *                 expected for them
+ *
+ * \param[in]      win The sub window of the form
+ * \param[in]      starting_y The row of the first line of the results
+ */
+static void
+render_prefix_result(WINDOW* win, int starting_y) {
+    const hash_prefix_result_t* result = &s_prefix_result;
+
+    double expected_prefix = ldexp(1.0, result->bits);
+    double expected_collision = 1.2533141373155003 * sqrt(expected_prefix); // sqrt(pi / 2 * N)
+
+    wattron(win, A_BOLD);
+    mvwprintw(win, starting_y, BH_FORM_X_PADDING, "%s, digest starting with %s", result->label,
+              result->pattern);
+    wattroff(win, A_BOLD);
+
+    int color = result->prefix_found ? BH_SUCCESS_COLOR_PAIR : BH_ERROR_COLOR_PAIR;
+    wattron(win, COLOR_PAIR(color));
+    if (result->prefix_found) {
+        mvwprintw(win, starting_y + 2, BH_FORM_X_PADDING,
+                  "Prefix    : found after %llu digests, 2^%u = %.0f expected",
+                  (unsigned long long)result->prefix_point, result->bits, expected_prefix);
+    } else {
+        mvwprintw(win, starting_y + 2, BH_FORM_X_PADDING,
+                  "Prefix    : not found in %d digests, 2^%u = %.0f expected", result->attempts,
+                  result->bits, expected_prefix);
+    }
+    wattroff(win, COLOR_PAIR(color));
+    mvwprintw(win, starting_y + 3, BH_FORM_X_PADDING, "  Input   : %s", result->prefix_input);
+    mvwprintw(win, starting_y + 4, BH_FORM_X_PADDING, "  Digest  : %s...", result->prefix_digest);
+
+    color = result->collision_found ? BH_SUCCESS_COLOR_PAIR : BH_ERROR_COLOR_PAIR;
+    wattron(win, COLOR_PAIR(color));
+    if (result->collision_found) {
+        mvwprintw(win, starting_y + 6, BH_FORM_X_PADDING,
+                  "Collision : found after %llu digests, 1.25 * 2^(%u/2) = %.0f expected",
+                  (unsigned long long)result->collision_point, result->bits, expected_collision);
+    } else {
+        mvwprintw(win, starting_y + 6, BH_FORM_X_PADDING,
+                  "Collision : not found in %d digests, 1.25 * 2^(%u/2) = %.0f expected",
+                  result->attempts, result->bits, expected_collision);
+    }
+    wattroff(win, COLOR_PAIR(color));
+    mvwprintw(win, starting_y + 7, BH_FORM_X_PADDING, "  Inputs  : %s, %s",
+              result->collision_inputs[0], result->collision_inputs[1]);
+
+    if (result->prefix_found && result->collision_found) {
+        mvwprintw(win, starting_y + 9, BH_FORM_X_PADDING,
+                  "Gap       : the prefix took %.1f times the digests of the collision, "
+                  "%.1f expected",
+                  (double)result->prefix_point / result->collision_point,
+                  expected_prefix / expected_collision);
+    }
+    mvwprintw(win, starting_y + 10, BH_FORM_X_PADDING, "Run       : %d digests in %.3f s",
+              result->attempts, result->seconds);
+}
+
+/**
+ * \brief          Take the value from the form fields and start a prefix search
+ *
+ * \param[in]      page The prefix search page
+ * \param[in]      thread_pool The thread pool to use for running the search
+ * \param[out]     ctx The context of the run shared between all worker threads
+ */
+static void
+hash_prefix_start(attack_page_t* page, GThreadPool* thread_pool, hash_collision_context_t* ctx) {
+    int hash_number = atoi(attack_page_field_buffer(page, HASH_PREFIX_FIELD_HASH));
+    unsigned int bits = atoi(attack_page_field_buffer(page, HASH_PREFIX_FIELD_BITS));
+    uint64_t pattern =
+        strtoull(attack_page_field_buffer(page, HASH_PREFIX_FIELD_PATTERN), NULL, 10);
+    unsigned int attempts = atoi(attack_page_field_buffer(page, HASH_PREFIX_FIELD_MAX_ATTEMPTS));
+
+    if (hash_number < 1 || hash_number > hash_config_len) {
+        attack_page_message(page, "The hash is the number of a hash function in the menu.");
+    } else if (!hash_config_init(&hash_config[hash_number - 1])) {
+        attack_page_message(page, BH_HASH_UNAVAILABLE_MESSAGE);
+    } else if (bits > hash_config[hash_number - 1].bits) {
+        attack_page_message(page, "The prefix can not be longer than the digest.");
+    } else {
+        hash_prefix_run(hash_config[hash_number - 1].id, bits, pattern, attempts, thread_pool,
+                        ctx);
+    }
+}
+
+static const attack_page_config_t s_prefix_page = {
+    .title = "[ Targeted Prefix Search ]",
+    .name = "prefix search",
+    .description = "Finds a digest starting with the lowest Prefix Bits bits of the pattern",
+    .fields = s_prefix_form_field_metadata,
+    .field_count = ARRAY_SIZE(s_prefix_form_field_metadata),
+    .button = &s_prefix_form_button,
+    .result_rows = BH_PREFIX_RESULT_ROWS,
+    .start = hash_prefix_start,
+    .collect = hash_prefix_collect_result,
+    .render_result = render_prefix_result,
+};
+
+/**************************************************************
+                      EXTERNAL FUNCTIONS
+**************************************************************/
+
+/**
+ * \brief          Render the page that searches for an input whose digest starts with a bit
+ *                 pattern, next to a collision search on the same bits.
+ *
+ * \param[in]      content_win The window to render the prefix search page on
+ * \param[in]      header_win The window to render the header content, normally for
+ *                 the args of header_render
+ * \param[in]      footer_win The window to render the footer content, normally for
+ *                 the args of footer_render
+ * \param[out]     max_y The maximum height of the screen space that can be rendered. The
+ *                 value will be updated when a resize happens
+ * \param[out]     max_x The maximum width of the screen space that can be rendered. The
+ *                 value will be updated when a resize happens
+ * \param[in]      thread_pool The thread pool to use for running the search.
+ */
+void
+render_hash_prefix_page(WINDOW* content_win, WINDOW* header_win, WINDOW* footer_win, int* max_y,
+                        int* max_x, GThreadPool* thread_pool) {
+    attack_page_render(&s_prefix_page, content_win, header_win, footer_win, max_y, max_x,
+                       thread_pool);
+}
@@ -0,0 +1,30 @@
+/**
+ * \file            hash_prefix.h
+ * \brief           Header file for hash_prefix.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_PREFIX_H
+#define HASH_PREFIX_H
+
+#include <glib.h>
+#include <math.h>
+#include <ncurses.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "attack_page.h"
+#include "hash_config.h"
+
+#include "../../utils/hash_function.h"
+
+void render_hash_prefix_page(WINDOW* content_win, WINDOW* header_win, WINDOW* footer_win,
+                             int* max_y, int* max_x, GThreadPool* thread_pool);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,329 @@
+/**
+ * \file            hash_rainbow.c
+ * \brief           The page of the rainbow tables: the time-memory tradeoff beside the
+ *                  birthday attack. A table of chains over a digest truncated to a few dozen
+ *                  bits is built once on the worker pool and saved to a file in the working
+ *                  directory, later runs with the same parameters map the file instead. The
+ *                  table then answers inversion queries, a truncated digest back to an input
+ *                  that hashes to it.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_rainbow.h"
+
+#define ACTION_SUBMIT 1
+
+/**
+ * \brief          The rows of the sub window below the button for the results of a run
+ */
+#define BH_RAINBOW_RESULT_ROWS 11
+
+static const struct FormButton s_rainbow_form_button = {"[ Build and Query ]", "[ Running... ]",
+                                                        ACTION_SUBMIT};
+
+static const struct FormInputField s_rainbow_form_field_metadata[] = {
+    {"Hash (menu number)", 7, 2, 0},
+    {"Digest Bits", 24, 2, BH_RAINBOW_MAX_BITS},
+    {"Chain Length", 512, 5, 0},
+    {"Chains", 32768, 8, 0},
+    {"Queries", 100, 4, 0}};
+
+/**
+ * \brief          The index of the input fields in s_rainbow_form_field_metadata
+ */
+enum hash_rainbow_field_index {
+    HASH_RAINBOW_FIELD_HASH = 0,
+    HASH_RAINBOW_FIELD_BITS,
+    HASH_RAINBOW_FIELD_CHAIN_LENGTH,
+    HASH_RAINBOW_FIELD_CHAINS,
+    HASH_RAINBOW_FIELD_QUERIES
+};
+
+/**
+ * \brief          The results of the last run, kept to render them again after a resize
+ */
+typedef struct {
+    int queries;               ///< The queries answered
+    double seconds;            ///< The duration of the run
+    const char* label;         ///< The label of the hash function
+    unsigned int bits;         ///< The digest bits
+    unsigned int chain_length; ///< The hashes of every chain
+    size_t chain_count;        ///< The chains of the table
+    char path[256];            ///< The file of the table
+    double file_mib;           ///< The size of the file
+    bool ready;                ///< Whether the table was built or loaded
+    bool loaded;               ///< Whether the table was mapped from an earlier run
+    double build_seconds;      ///< The duration of the build, 0 when loaded
+    double lookup_seconds;     ///< The duration of the queries
+    int solved;                ///< The queries inverted
+    int false_alarms;          ///< The matching ends whose chain did not hold the digest
+    guint64 lookup_hashes;     ///< The hashes of every query
+    bool has_example;          ///< Whether an inverted query is shown
+    uint64_t example_target;   ///< The truncated digest of the example
+    char example_input[BH_RAINBOW_MAX_INPUT_BYTES * 2 + 1]; ///< The input found, in hex
+} hash_rainbow_result_t;
+
+// The results of the last search, rendered again when the page is restored
+static hash_rainbow_result_t s_rainbow_result;
+
+/****************************************************************
+ INTERNAL FUNCTION
+ ****************************************************************/
+
+/**
+ * \brief          Start a run of a rainbow table: map the table if an earlier run saved it
+ *                 with the same parameters and submit the workers of the queries, or submit
+ *                 the workers of the build, which go on with the queries.
+ *
+ * \param[in]      hash_id The hash function of the chains
+ * \param[in]      bits The digest bits
+ * \param[in]      chain_length The hashes of every chain
+ * \param[in]      chain_count The chains of the table
+ * \param[in]      query_count The inversion queries to answer
+ * \param[in]      thread_pool The thread pool to run the workers on
+ * \param[out]     ctx The context of the run shared between all worker threads
+ */
+static void
+hash_rainbow_run(enum hash_function_ids hash_id, unsigned int bits, unsigned int chain_length,
+                 size_t chain_count, unsigned int query_count, GThreadPool* thread_pool,
+                 hash_collision_context_t* ctx) {
+    ctx->hash_id = hash_id;
+    ctx->rainbow = hash_rainbow_create(hash_id, bits, chain_length, chain_count, query_count);
+    if (!ctx->rainbow) {
+        render_full_page_error_exit(stdscr, 0, 0, "Memory allocation failed for rainbow table.");
+    }
+
+    // The points of the queries are picked from the run seed
+    attack_page_prepare_run(ctx, thread_pool, chain_count);
+
+    if (hash_rainbow_load(ctx->rainbow)) {
+        ctx->rainbow->loaded = true;
+        ctx->rainbow->lookups_started_at = ctx->result->stats.started_at;
+        hash_collision_submit_workers(ctx, HASH_PASS_RAINBOW_LOOKUP);
+        return;
+    }
+
+    if (!hash_rainbow_begin_build(ctx->rainbow)) {
+        render_full_page_error_exit(stdscr, 0, 0, "Memory allocation failed for rainbow chains.");
+    }
+    hash_collision_submit_workers(ctx, HASH_PASS_RAINBOW_BUILD);
+}
+
+/**
+ * \brief          Update the progress bar in the rainbow table form sub window with the
+ *                 chains built, then the queries answered.
+ *
+ * \param[in]      page The rainbow table page
+ * \param[in]      ctx The context of the run
+ */
+static void
+hash_rainbow_progress_update(attack_page_t* page, hash_collision_context_t* ctx) {
+    hash_rainbow_t* rainbow = ctx->rainbow;
+    if (!rainbow) {
+        return;
+    }
+
+    if (rainbow->loaded || rainbow->built_at != 0) {
+        int done = g_atomic_int_get(&rainbow->queries_done);
+        attack_page_status(page, "Queries : %d%% (%d/%u queries)",
+                           (int)((gint64)done * 100 / rainbow->query_count), done,
+                           rainbow->query_count);
+    } else {
+        int built = g_atomic_int_get(&ctx->result->attempts_made);
+        attack_page_status(page, "Building: %d%% (%d/%zu chains)",
+                           (int)((gint64)built * 100 / (gint64)rainbow->chain_count), built,
+                           rainbow->chain_count);
+    }
+}
+
+/**
+ * \brief          Keep the results of a finished run
+ *
+ * \param[in]      ctx The context of the finished run
+ */
+static void
+hash_rainbow_collect_result(hash_collision_context_t* ctx) {
+    hash_collision_stats_t* stats = &ctx->result->stats;
+    hash_rainbow_result_t* result = &s_rainbow_result;
+    memset(result, 0, sizeof(*result));
+
+    result->seconds = stats->finished_at > stats->started_at
+                          ? (double)(stats->finished_at - stats->started_at) / G_USEC_PER_SEC
+                          : 0.0;
+    result->label = get_hash_config_item(ctx->hash_id).label;
+    if (!ctx->rainbow) {
+        return;
+    }
+
+    hash_rainbow_t* rainbow = ctx->rainbow;
+    result->queries = rainbow->queries_done;
+    result->bits = rainbow->bits;
+    result->chain_length = rainbow->chain_length;
+    result->chain_count = rainbow->chain_count;
+    snprintf(result->path, sizeof(result->path), "%s", rainbow->path);
+    result->file_mib =
+        (double)hash_rainbow_file_bytes(rainbow->chain_count) / (1024.0 * 1024.0);
+    result->ready = rainbow->chains != NULL;
+    result->loaded = rainbow->loaded;
+    if (rainbow->built_at != 0) {
+        result->build_seconds = (double)(rainbow->built_at - stats->started_at) / G_USEC_PER_SEC;
+    }
+    if (result->ready && stats->finished_at > rainbow->lookups_started_at) {
+        result->lookup_seconds =
+            (double)(stats->finished_at - rainbow->lookups_started_at) / G_USEC_PER_SEC;
+    }
+    result->solved = rainbow->solved;
+    result->false_alarms = rainbow->false_alarms;
+    result->lookup_hashes = rainbow->lookup_hashes;
+    result->has_example = rainbow->has_example;
+    if (rainbow->has_example) {
+        uint8_t input[BH_RAINBOW_MAX_INPUT_BYTES];
+        size_t input_len = hash_rainbow_point_input(rainbow, rainbow->example_preimage, input);
+        for (size_t i = 0; i < input_len; i++) {
+            snprintf(result->example_input + 2 * i, 3, "%02X", input[i]);
+        }
+        result->example_target = rainbow->example_target;
+    }
+}
+
+/**
+ * \brief          Render the results of the last run: the table and how it was obtained,
+ *                 the queries inverted against the coverage expected, and the cost of a
+ *                 query against a search without the table
+ *
+ * \param[in]      win The sub window of the form
+ * \param[in]      starting_y The row of the first line of the results
+ */
+static void
+render_rainbow_result(WINDOW* win, int starting_y) {
+    const hash_rainbow_result_t* result = &s_rainbow_result;
+
+    double expected = hash_rainbow_success_rate(result->bits, result->chain_length,
+                                                result->chain_count);
+
+    wattron(win, A_BOLD);
+    mvwprintw(win, starting_y, BH_FORM_X_PADDING, "%s cut to %u bits, %zu chains of %u hashes",
+              result->label, result->bits, result->chain_count, result->chain_length);
+    wattroff(win, A_BOLD);
+
+    if (!result->ready) {
+        mvwprintw(win, starting_y + 1, BH_FORM_X_PADDING, "Table     : not built, %s",
+                  result->path);
+    } else if (result->loaded) {
+        mvwprintw(win, starting_y + 1, BH_FORM_X_PADDING, "Table     : mapped from %s, %.2f MiB",
+                  result->path, result->file_mib);
+    } else {
+        mvwprintw(win, starting_y + 1, BH_FORM_X_PADDING,
+                  "Table     : built in %.3f s and saved to %s, %.2f MiB", result->build_seconds,
+                  result->path, result->file_mib);
+    }
+    mvwprintw(win, starting_y + 2, BH_FORM_X_PADDING,
+              "Coverage  : %.1f%% of the 2^%u points expected", expected * 100.0, result->bits);
+
+    int color = result->solved > 0 ? BH_SUCCESS_COLOR_PAIR : BH_ERROR_COLOR_PAIR;
+    wattron(win, COLOR_PAIR(color));
+    mvwprintw(win, starting_y + 4, BH_FORM_X_PADDING, "Inverted  : %d of %d queries (%.1f%%)",
+              result->solved, result->queries,
+              result->queries > 0 ? result->solved * 100.0 / result->queries : 0.0);
+    wattroff(win, COLOR_PAIR(color));
+
+    if (result->queries > 0) {
+        mvwprintw(win, starting_y + 5, BH_FORM_X_PADDING,
+                  "Lookups   : %.2f ms and %.0f hashes per query, %d false alarms",
+                  result->lookup_seconds * 1000.0 / result->queries,
+                  (double)result->lookup_hashes / result->queries, result->false_alarms);
+    }
+    if (result->has_example) {
+        mvwprintw(win, starting_y + 6, BH_FORM_X_PADDING, "  Example : digest %0*llx from input %s",
+                  (int)(result->bits + 3) / 4, (unsigned long long)result->example_target,
+                  result->example_input);
+    }
+    mvwprintw(win, starting_y + 8, BH_FORM_X_PADDING,
+              "Brute     : %.0f hashes per query expected without the table",
+              ldexp(1.0, (int)result->bits));
+
+    mvwprintw(win, starting_y + 10, BH_FORM_X_PADDING, "Run       : %.3f s", result->seconds);
+}
+
+/**
+ * \brief          Take the value from the form fields and start a run of a rainbow table
+ *
+ * \param[in]      page The rainbow table page
+ * \param[in]      thread_pool The thread pool to use for running the workers
+ * \param[out]     ctx The context of the run shared between all worker threads
+ */
+static void
+hash_rainbow_start(attack_page_t* page, GThreadPool* thread_pool, hash_collision_context_t* ctx) {
+    int hash_number = atoi(attack_page_field_buffer(page, HASH_RAINBOW_FIELD_HASH));
+    unsigned int bits = atoi(attack_page_field_buffer(page, HASH_RAINBOW_FIELD_BITS));
+    unsigned int chain_length =
+        atoi(attack_page_field_buffer(page, HASH_RAINBOW_FIELD_CHAIN_LENGTH));
+    size_t chain_count = atoi(attack_page_field_buffer(page, HASH_RAINBOW_FIELD_CHAINS));
+    unsigned int query_count = atoi(attack_page_field_buffer(page, HASH_RAINBOW_FIELD_QUERIES));
+
+    const char* message = NULL;
+    if (hash_number < 1 || hash_number > hash_config_len) {
+        message = "The hash is the number of a hash function in the menu.";
+    } else if (!hash_config_init(&hash_config[hash_number - 1])) {
+        message = BH_HASH_UNAVAILABLE_MESSAGE;
+    } else if (bits < BH_RAINBOW_MIN_BITS || bits > hash_config[hash_number - 1].bits) {
+        message = "The digest bits must be at least 16 and fit the digest.";
+    } else if (chain_count > (UINT64_C(1) << bits)) {
+        message = "There can not be more chains than points.";
+    } else if (hash_rainbow_file_bytes(chain_count) / (1024 * 1024)
+               > hash_plan_default_budget_mib()) {
+        message = "That many chains do not fit the memory budget.";
+    } else {
+        hash_rainbow_run(hash_config[hash_number - 1].id, bits, chain_length, chain_count,
+                         query_count, thread_pool, ctx);
+    }
+
+    if (message) {
+        attack_page_message(page, message);
+    }
+}
+
+static const attack_page_config_t s_rainbow_page = {
+    .title = "[ Rainbow Table ]",
+    .name = "rainbow table",
+    .description = "Builds or maps a rainbow table, then inverts truncated digests with it",
+    .fields = s_rainbow_form_field_metadata,
+    .field_count = ARRAY_SIZE(s_rainbow_form_field_metadata),
+    .button = &s_rainbow_form_button,
+    .result_rows = BH_RAINBOW_RESULT_ROWS,
+    .start = hash_rainbow_start,
+    .progress = hash_rainbow_progress_update,
+    .collect = hash_rainbow_collect_result,
+    .render_result = render_rainbow_result,
+};
+
+/**************************************************************
+                      EXTERNAL FUNCTIONS
+**************************************************************/
+
+/**
+ * \brief          Render the page that builds rainbow tables and inverts truncated digests
+ *                 with them.
+ *
+ * \param[in]      content_win The window to render the rainbow table page on
+ * \param[in]      header_win The window to render the header content, normally for
+ *                 the args of header_render
+ * \param[in]      footer_win The window to render the footer content, normally for
+ *                 the args of footer_render
+ * \param[out]     max_y The maximum height of the screen space that can be rendered. The
+ *                 value will be updated when a resize happens
+ * \param[out]     max_x The maximum width of the screen space that can be rendered. The
+ *                 value will be updated when a resize happens
+ * \param[in]      thread_pool The thread pool to use for running the search.
+ */
+void
+render_hash_rainbow_page(WINDOW* content_win, WINDOW* header_win, WINDOW* footer_win,
+                         int* max_y, int* max_x, GThreadPool* thread_pool) {
+    attack_page_render(&s_rainbow_page, content_win, header_win, footer_win, max_y, max_x,
+                       thread_pool);
+}
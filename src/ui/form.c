@@ -25,7 +25,7 @@
  * \return         The longest max_length value.
  */
 unsigned short
-calculate_longest_max_length(const struct FormInputField const form_fields[],
+calculate_longest_max_length(const struct FormInputField form_fields[],
                              uint8_t form_fields_len, bool padding) {
     unsigned short longest = 0;
 
@@ -311,10 +311,16 @@ display_field_error(form_manager_t* manager, FIELD* field, unsigned int max_leng
         return false;
     }
 
-    // Get the maximum allowed value based on the field's max length
+    // Get the maximum allowed value based on the field's max length, unless the field
+    // defines a smaller maximum value of its own
     int min = 1;
     int max = calculate_form_max_value(max_length);
 
+    field_tracker_t* tracker = find_field_tracker(manager, field);
+    if (tracker && tracker->max_value > 0 && (int)tracker->max_value < max) {
+        max = tracker->max_value;
+    }
+
     if (value < min || value > max) {
         wattron(manager->sub_win, COLOR_PAIR(BH_ERROR_COLOR_PAIR));
         mvwprintw(manager->sub_win, y_pos, x_pos, "Range: %d-%d", min, max);
@@ -361,9 +367,9 @@ clear_field_error(form_manager_t* manager, FIELD* field) {
  * \return         Pointer to newly created form manager on success, NULL on failure
  */
 form_manager_t*
-create_form_manager(const struct FormInputField const input_metadata[],
+create_form_manager(const struct FormInputField input_metadata[],
                     unsigned short input_metadata_len,
-                    const struct FormButton const button_metadata[],
+                    const struct FormButton button_metadata[],
                     unsigned short button_metadata_len) {
     form_manager_t* manager = malloc(sizeof(form_manager_t));
     if (!manager) {
@@ -374,7 +380,7 @@ create_form_manager(const struct FormInputField const input_metadata[],
 
     // Allocate arrays
     manager->fields = calloc((total_field_count + 2), sizeof(FIELD*)); // +1 for NULL terminator
-    manager->trackers = malloc(sizeof(field_tracker_t) * input_metadata_len);
+    manager->trackers = calloc(input_metadata_len, sizeof(field_tracker_t));
 
     manager->input_count = input_metadata_len;
     manager->button_count = button_metadata_len;
@@ -408,6 +414,74 @@ create_form_manager(const struct FormInputField const input_metadata[],
     return manager;
 }
 
+/**
+ * \brief          Create the writable input fields of a form manager, one per row from the top
+ *                 of its sub window, each with its default value, its numeric range and its
+ *                 tracker
+ *
+ * \param[in]      manager The form manager created from the same metadata
+ * \param[in]      input_metadata Array of input field metadata structures
+ *
+ * \return         true once every field is created, false on memory allocation failure
+ */
+bool
+create_form_input_fields(form_manager_t* manager,
+                         const struct FormInputField input_metadata[]) {
+    if (!manager) {
+        return false;
+    }
+
+    for (unsigned short i = 0; i < manager->input_count; ++i) {
+        const struct FormInputField* metadata = &input_metadata[i];
+
+        manager->fields[i] =
+            new_field(1,                             // Field height
+                      manager->max_field_length + 1, // Field width
+                      i,                             // Field y-position
+                      BH_FORM_X_PADDING + BH_FORM_FIELD_BRACKET_PADDING + manager->max_label_length
+                          + BH_FORM_FIELD_BRACKET_PADDING, // Field x-position
+                      0,                                   // number of offscreen rows
+                      0                                    // number of additional working buffers
+            );
+        if (!manager->fields[i]) {
+            return false;
+        }
+
+        // Convert the default value to string, an unsigned short is 5 digits at most
+        char string_buffer[8];
+        unsigned int buffer_size =
+            metadata->max_length + 1 < sizeof(string_buffer) ? metadata->max_length + 1
+                                                             : sizeof(string_buffer);
+        snprintf(string_buffer, buffer_size, "%hu", metadata->default_value);
+
+        // Make the field visible and editable
+        field_opts_on(manager->fields[i], O_STATIC);    // Keep field static size
+        field_opts_off(manager->fields[i], O_AUTOSKIP); // Don't auto skip to next field
+        set_field_back(manager->fields[i], A_NORMAL);   // Set normal background initially
+        set_field_buffer(manager->fields[i], 0, string_buffer); // Set the default value
+        set_field_just(manager->fields[i], JUSTIFY_LEFT);       // Left justify the content
+
+        // Set maximum field length
+        set_max_field(manager->fields[i], manager->max_field_length);
+
+        // Set the field type to numeric
+        int max_value = calculate_form_max_value(metadata->max_length);
+        if (metadata->max_value > 0 && (int)metadata->max_value < max_value) {
+            max_value = metadata->max_value;
+        }
+        set_field_type(manager->fields[i], TYPE_INTEGER, 0, (long)1, (long)max_value);
+
+        // Initialize tracker
+        manager->trackers[i].field = manager->fields[i];
+        manager->trackers[i].current_length = strlen(string_buffer);
+        manager->trackers[i].max_length = metadata->max_length;
+        manager->trackers[i].max_value = metadata->max_value;
+        manager->trackers[i].field_index = i;
+        manager->trackers[i].cursor_position = manager->trackers[i].current_length;
+    }
+    return true;
+}
+
 /**
  * \brief          Find tracker for a given field
  *
@@ -747,4 +821,128 @@ free_form_manager(form_manager_t* manager) {
     }
 
     free(manager);
-}
\ No newline at end of file
+}
+/****************************************************************
+                    FORM RENDERING AND INPUT
+****************************************************************/
+
+/**
+ * \brief          Render the label and the brackets of every input field of the form
+ *
+ * \param[in]      manager The form manager instance
+ * \param[in]      input_metadata Array of input field metadata structures
+ */
+void
+render_form_field_labels(form_manager_t* manager,
+                         const struct FormInputField input_metadata[]) {
+    for (unsigned short i = 0; i < manager->input_count; ++i) {
+        mvwprintw(manager->sub_win, i, BH_FORM_X_PADDING, "%s", input_metadata[i].label);
+        mvwprintw(manager->sub_win, i, BH_FORM_X_PADDING + manager->max_label_length, ": [");
+        mvwprintw(manager->sub_win, i,
+                  BH_FORM_X_PADDING + manager->max_label_length + BH_FORM_FIELD_BRACKET_PADDING + 1
+                      + (manager->max_field_length + 1) + BH_FORM_FIELD_BRACKET_PADDING,
+                  "]");
+    }
+}
+
+/**
+ * \brief          Handle a key pressed on a form of numeric fields followed by a button: move
+ *                 between the fields, move the cursor, and edit the digits of the active field
+ *
+ * \param[in]      manager The form manager instance
+ * \param[in]      ch The current int character input from the key pressed
+ * \param[in]      button_label The label of the button, set again when it is highlighted
+ * \param[out]     is_btn_highlighted Tracks whether the button is highlighted, before it is set
+ *                 to its running state
+ *
+ * \return         true when enter is pressed on the button and the form is valid
+ */
+bool
+handle_form_input_key(form_manager_t* manager, int ch, const char* button_label,
+                      bool* is_btn_highlighted) {
+    FIELD* active_field = current_field(manager->form);
+    int current_index = field_index(active_field);
+    bool is_button = is_field_button(manager, current_index);
+
+    switch (ch) {
+        case KEY_UP:
+        case KEY_DOWN: {
+            if (!validate_field_and_display(manager)) {
+                break;
+            }
+
+            FIELD* old_field = active_field;
+            form_driver(manager->form, ch == KEY_DOWN ? REQ_NEXT_FIELD : REQ_PREV_FIELD);
+            form_driver(manager->form, REQ_END_LINE);
+            active_field = current_field(manager->form);
+
+            update_field_highlighting(manager);
+
+            if (!is_button) {
+                on_field_change(manager, old_field, active_field);
+                *is_btn_highlighted = false;
+            } else {
+                *is_btn_highlighted = true;
+                set_field_buffer(manager->fields[manager->input_count], 0, button_label);
+            }
+            pos_form_cursor(manager->form);
+        } break;
+
+        case KEY_LEFT:
+            if (!is_button && cursor_can_move_left(manager, active_field)
+                && form_driver(manager->form, REQ_PREV_CHAR) == E_OK
+                && get_cursor_position(manager, active_field) > 0) {
+                decrement_cursor_position(manager, active_field);
+            }
+            break;
+        case KEY_RIGHT:
+            if (!is_button && cursor_can_move_right(manager, active_field)
+                && form_driver(manager->form, REQ_NEXT_CHAR) == E_OK
+                && (int)get_cursor_position(manager, active_field)
+                       < get_field_current_length(manager, active_field)) {
+                increment_cursor_position(manager, active_field);
+            }
+            break;
+
+        case KEY_BACKSPACE:
+        case '\b':
+        case 127:
+            if (!is_button && get_field_current_length(manager, active_field) > 0) {
+                unsigned short prev_length = get_field_length_on_screen(manager, active_field);
+                if (form_driver(manager->form, REQ_DEL_PREV) == E_OK
+                    && get_field_length_on_screen(manager, active_field) != prev_length) {
+                    decrement_field_length(manager, active_field);
+                    // Whenever a character is deleted, the cursor position is automatically
+                    // move to the left by ncurses, so we need to update our tracker as well
+                    decrement_cursor_position(manager, active_field);
+                }
+            }
+            break;
+        case KEY_DC:
+            if (!is_button && get_field_current_length(manager, active_field) > 0) {
+                unsigned short prev_length = get_field_length_on_screen(manager, active_field);
+                if (form_driver(manager->form, REQ_DEL_CHAR) == E_OK
+                    && get_field_length_on_screen(manager, active_field) != prev_length) {
+                    decrement_field_length(manager, active_field);
+                }
+            }
+            break;
+
+        case '\n':
+            return validate_field_and_display(manager) && is_button;
+
+        default:
+            if (!is_button && isdigit(ch) && field_has_space_for_char(manager, active_field)) {
+                unsigned short prev_length = get_field_length_on_screen(manager, active_field);
+                if (form_driver(manager->form, ch) == E_OK
+                    && get_field_length_on_screen(manager, active_field) != prev_length) {
+                    increment_field_length(manager, active_field);
+                    // Whenever a character is added, the cursor position is automatically
+                    // move to the right by ncurses, so we need to update our tracker as well
+                    increment_cursor_position(manager, active_field);
+                }
+            }
+            break;
+    }
+    return false;
+}
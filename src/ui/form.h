@@ -29,6 +29,8 @@ struct FormInputField {
     unsigned short default_value; ///< Default value to set in the buffer on form init
     unsigned int
         max_length; ///< The maximum length the of character of the input field. The actual length of the input field would be N+1 to accomodate the text cursor
+    unsigned int
+        max_value; ///< The maximum value accepted by the field, 0 to accept any value that fits in max_length digits. Used by fields that select one of a few options
 };
 
 /**
@@ -54,6 +56,8 @@ typedef struct FieldTracker {
     unsigned int cursor_position; ///< The actual position of the text cursor the user sees
     unsigned int
         max_length; ///< The max length of character this input field can accept. This should be one character smaller than the input form field X length
+    unsigned int
+        max_value; ///< The maximum value this input field accepts, 0 to derive it from max_length
     unsigned int field_index; // Index in the metadata array
 } field_tracker_t;
 
@@ -95,7 +99,7 @@ typedef struct FormManager {
 
 /********************** UTILITY FUNCTIONS **********************/
 
-unsigned short calculate_longest_max_length(const struct FormInputField const form_fields[],
+unsigned short calculate_longest_max_length(const struct FormInputField form_fields[],
                                             uint8_t form_fields_len, bool padding);
 int calculate_form_max_value(int length);
 
@@ -117,10 +121,12 @@ void clear_field_error(form_manager_t* manager, FIELD* field);
 
 /************************ FORM MANAGERS ************************/
 
-form_manager_t* create_form_manager(const struct FormInputField const input_metadata[],
+form_manager_t* create_form_manager(const struct FormInputField input_metadata[],
                                     unsigned short input_metadata_len,
-                                    const struct FormButton const button_metadata[],
+                                    const struct FormButton button_metadata[],
                                     unsigned short button_metadata_len);
+bool create_form_input_fields(form_manager_t* manager,
+                              const struct FormInputField input_metadata[]);
 field_tracker_t* find_field_tracker(form_manager_t* manager, FIELD* field);
 bool field_has_space_for_char(form_manager_t* manager, FIELD* field);
 void increment_field_length(form_manager_t* manager, FIELD* field);
@@ -136,4 +142,11 @@ unsigned short get_field_length_on_screen(form_manager_t* manager, FIELD* field)
 int get_field_current_length(form_manager_t* manager, FIELD* field);
 void on_field_change(form_manager_t* manager, FIELD* old_field, FIELD* new_field);
 void free_form_manager(form_manager_t* manager);
+
+/****************** FORM RENDERING AND INPUT *******************/
+
+void render_form_field_labels(form_manager_t* manager,
+                              const struct FormInputField input_metadata[]);
+bool handle_form_input_key(form_manager_t* manager, int ch, const char* button_label,
+                           bool* is_btn_highlighted);
 #endif
\ No newline at end of file
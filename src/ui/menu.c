@@ -44,11 +44,35 @@ list_menu_init(WINDOW* win, const struct ListMenuItem choices[], unsigned short
         *sub_win = derwin(win, 6, 38, 2, 1);
     }
 
-    *menu = new_menu(*choices_items); // Create the menu
-    set_menu_win(*menu, win);         // Set the window for the menu
-    set_menu_sub(*menu, *sub_win);    // Create a sub-window for the menu
-    set_menu_mark(*menu, "> ");       // Set the mark for selected items
-    post_menu(*menu);                 // Post the menu to the window
+    *menu = new_menu(*choices_items);            // Create the menu
+    set_menu_win(*menu, win);                    // Set the window for the menu
+    set_menu_sub(*menu, *sub_win);               // Create a sub-window for the menu
+    set_menu_mark(*menu, "> ");                  // Set the mark for selected items
+    set_menu_format(*menu, (int)choices_len, 1); // One row per item instead of at most 16
+    post_menu(*menu);                            // Post the menu to the window
+}
+
+/**
+ * \brief          Get the columns a list menu needs to show its items in full: the mark, the
+ *                 longest label, one space and the longest description.
+ *
+ * \param[in]      choices The choices for the menu.
+ * \param[in]      choices_len The number of choices in the menu.
+ * 
+eturn         The number of columns for the sub-window of the menu.
+ */
+int
+list_menu_width(const struct ListMenuItem choices[], unsigned short choices_len) {
+    size_t label_len = 0;
+    size_t description_len = 0;
+    for (unsigned short i = 0; i < choices_len; ++i) {
+        size_t len = strlen(choices[i].label);
+        label_len = len > label_len ? len : label_len;
+        len = strlen(choices[i].description);
+        description_len = len > description_len ? len : description_len;
+    }
+
+    return (int)(strlen("> ") + label_len + 1 + description_len);
 }
 
 /**
@@ -34,6 +34,7 @@ struct ListMenuItem {
 
 void list_menu_init(WINDOW* win, const struct ListMenuItem choices[], unsigned short choices_len,
                     ITEM*** choices_items, MENU** menu, WINDOW** sub_win);
+int list_menu_width(const struct ListMenuItem choices[], unsigned short choices_len);
 
 void list_menu_navigation_render(WINDOW* win, int y, int x, bool hide_exit_text);
 
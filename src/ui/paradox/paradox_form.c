@@ -21,10 +21,42 @@ static const unsigned short paradox_form_buttons_metadata_len =
     ARRAY_SIZE(paradox_form_buttons_metadata);
 
 static const struct FormInputField const paradox_form_fields_metadata[] = {
-    {"Domain Size (days)", 365, 5}, {"Sample Count (people)", 23, 9}, {"Simulation Runs", 1000, 5}};
+    {"Domain Size (days)", 365, 5, 0},
+    {"Sample Count (people)", 23, 9, 0},
+    {"Simulation Runs", 1000, 5, 0},
+    {"Source (1 rand, 2 hash)", 1, 1, 2},
+    {"Hash (menu number)", 7, 2, 0}};
 static const unsigned short paradox_form_fields_metadata_len =
     ARRAY_SIZE(paradox_form_fields_metadata);
 
+/**
+ * \brief          The index of the input fields in paradox_form_fields_metadata
+ */
+enum paradox_form_field_index {
+    PARADOX_FIELD_DOMAIN = 0,
+    PARADOX_FIELD_SAMPLES,
+    PARADOX_FIELD_RUNS,
+    PARADOX_FIELD_SOURCE,
+    PARADOX_FIELD_HASH
+};
+
+/**
+ * \brief          Where the simulation draws its samples. The values match the option numbers
+ *                 of the source field.
+ */
+enum paradox_sample_source { PARADOX_SOURCE_RAND = 1, PARADOX_SOURCE_HASH };
+
+// The source of the samples of the last simulation, rendered with its results
+static const char* s_paradox_sample_label = "rand()";
+
+// The simulation run a step at a time by paradox_form_update, NULL when none is running
+static paradox_simulation_t* s_paradox_simulation = NULL;
+static int s_paradox_runs_done = 0; ///< The trials the running simulation has run so far
+static int s_paradox_runs = 0;      ///< The trials of the running simulation
+
+// Why the last simulation did not run to its end, rendered instead of its result, or NULL
+static const char* s_paradox_error = NULL;
+
 static form_manager_t* manager = NULL;
 
 /****************************************************************
@@ -73,30 +105,96 @@ paradox_form_create_sub_win(WINDOW* win, int max_y, int max_x) {
     post_form(manager->form);
 }
 
+/**
+ * \brief          Get the column right of the closing bracket of a field, where the form
+ *                 shows the error of the field
+ *
+ * \return         The column in the sub window
+ */
+static int
+paradox_form_field_note_x(void) {
+    return BH_FORM_X_PADDING + manager->max_label_length + BH_FORM_FIELD_BRACKET_PADDING + 1 + 1
+           + manager->max_field_length + BH_FORM_FIELD_BRACKET_PADDING + 2;
+}
+
+/**
+ * \brief          Render the label of the selected hash function right of the hash field.
+ *                 Only call it once the field is validated, so its buffer is up to date.
+ */
+static void
+render_hash_label(void) {
+    FIELD* field = paradox_form_field_get(PARADOX_FIELD_HASH);
+    clear_field_error(manager, field);
+
+    int hash_number = atoi(field_buffer(field, 0));
+    if (hash_number >= 1 && hash_number <= hash_config_len) {
+        mvwprintw(manager->sub_win, PARADOX_FIELD_HASH + BH_FORM_Y_PADDING,
+                  paradox_form_field_note_x(), "%s", hash_config[hash_number - 1].label);
+    }
+}
+
 /**
  * \brief          Take the value from the form field as arguments for calculating the
- *                 collision and simulation. The result will be stored back to the arguments
- *                 provided to the function.
+ *                 collision and start the simulation, which paradox_form_update runs a step
+ *                 at a time. The probability is stored back to the argument provided to the
+ *                 function, the simulated result once the simulation is done.
  *
  * \param[in]      collision_probability A reference of the value of the probability of
  *                 hash collision of this result
  * \param[in]      simulated_runs_results A reference of the value of the actual collision
- *                 occur in simulations
+ *                 occur in simulations, -1 until the simulation is done
  */
 static void
 run_simulation_from_input(double* collision_probability, double* simulated_runs_results) {
-    int domain_size = atoi(field_buffer(paradox_form_field_get(0), 0));
-    int sample_count = atoi(field_buffer(paradox_form_field_get(1), 0));
-    int simulation_runs = atoi(field_buffer(paradox_form_field_get(2), 0));
+    int domain_size = atoi(field_buffer(paradox_form_field_get(PARADOX_FIELD_DOMAIN), 0));
+    int sample_count = atoi(field_buffer(paradox_form_field_get(PARADOX_FIELD_SAMPLES), 0));
+    int simulation_runs = atoi(field_buffer(paradox_form_field_get(PARADOX_FIELD_RUNS), 0));
+    int source = atoi(field_buffer(paradox_form_field_get(PARADOX_FIELD_SOURCE), 0));
+    int hash_number = atoi(field_buffer(paradox_form_field_get(PARADOX_FIELD_HASH), 0));
 
     *collision_probability = calculate_birthday_collision_probability(domain_size, sample_count);
-    *simulated_runs_results =
-        simulate_birthday_collision(domain_size, sample_count, simulation_runs);
+    *simulated_runs_results = -1;
+    s_paradox_error = NULL;
+    if (source == PARADOX_SOURCE_HASH) {
+        // The samples are the digests of the hash, through the batch loop of its registry entry
+        const hash_config_t* hash = &hash_config[hash_number - 1];
+        s_paradox_sample_label = hash->label;
+        if (!hash_config_init(hash)) {
+            s_paradox_error = BH_HASH_UNAVAILABLE_MESSAGE;
+            return;
+        }
+        s_paradox_simulation = paradox_simulation_create(domain_size, sample_count,
+                                                         simulation_runs, hash->batch,
+                                                         hash->digest_bytes);
+    } else {
+        s_paradox_sample_label = "rand()";
+        s_paradox_simulation =
+            paradox_simulation_create(domain_size, sample_count, simulation_runs, NULL, 0);
+    }
 
-    if (*simulated_runs_results == -1.0) {
-        render_full_page_error_exit(
-            stdscr, 0, 0,
-            "Memory allocation for simulate_birthday_collision fails at run_simulation_from_input");
+    if (!s_paradox_simulation) {
+        render_full_page_error_exit(stdscr, 0, 0,
+                                    "Memory allocation for the simulation fails at "
+                                    "run_simulation_from_input");
+    }
+    s_paradox_runs_done = 0;
+    s_paradox_runs = simulation_runs;
+    update_button_field_is_running(paradox_form_field_get(manager->input_count),
+                                   paradox_form_buttons_metadata[0].label,
+                                   paradox_form_buttons_metadata[0].loading_label, true);
+}
+
+/**
+ * \brief          Clear a row of the results below the form, up to the border of the window
+ *
+ * \param[in]      win The window the results are rendered on
+ * \param[in]      row The row to clear
+ * \param[in]      starting_cols The column the results start at
+ */
+static void
+clear_result_row(WINDOW* win, int row, int starting_cols) {
+    for (int col = starting_cols; col < getmaxx(win) - 1; col++) {
+        mvwaddch(win, row, col, ' ');
     }
 }
 
@@ -107,7 +205,8 @@ run_simulation_from_input(double* collision_probability, double* simulated_runs_
  *                 the sub win that holds the form. It will assume that the subwin is at the top
  *                 of the window and will render the content {BH_FORM_Y_PADDING} under it
  * \param[in]      collision_probability The result of the collision probability to render
- * \param[in]      simulated_runs_results The result of the simulations to render
+ * \param[in]      simulated_runs_results The result of the simulations to render, unused
+ *                 while a simulation is running
  */
 static void
 render_simulation_result(WINDOW* win, double collision_probability, double simulated_runs_results) {
@@ -122,13 +221,28 @@ render_simulation_result(WINDOW* win, double collision_probability, double simul
     uint8_t starting_rows = form_win_y + BH_FORM_Y_PADDING;
     uint8_t starting_cols = BH_FORM_X_PADDING + 1;
 
-    mvwprintw(win, starting_rows, starting_cols, "Estimated chance of a collision:         ");
-    mvwprintw(win, starting_rows, starting_cols, "Estimated chance of a collision: %.2f%%  ",
+    clear_result_row(win, starting_rows, starting_cols);
+    mvwprintw(win, starting_rows, starting_cols, "Estimated chance of a collision: %.2f%%",
               collision_probability * 100);
 
-    mvwprintw(win, starting_rows + 1, starting_cols, "Simulated runs results:         ");
-    mvwprintw(win, starting_rows + 1, starting_cols, "Simulated runs results: %.2f%%  ",
-              simulated_runs_results);
+    // A running simulation shows how far it got instead of its result
+    clear_result_row(win, starting_rows + 1, starting_cols);
+    if (s_paradox_error) {
+        wattron(win, A_BOLD | COLOR_PAIR(BH_ERROR_COLOR_PAIR));
+        mvwprintw(win, starting_rows + 1, starting_cols, "%s", s_paradox_error);
+        wattroff(win, A_BOLD | COLOR_PAIR(BH_ERROR_COLOR_PAIR));
+    } else if (s_paradox_simulation) {
+        mvwprintw(win, starting_rows + 1, starting_cols, "Simulation progress: %d%% (%d/%d runs)",
+                  (int)((int64_t)s_paradox_runs_done * 100 / s_paradox_runs),
+                  s_paradox_runs_done, s_paradox_runs);
+    } else {
+        mvwprintw(win, starting_rows + 1, starting_cols, "Simulated runs results: %.2f%%",
+                  simulated_runs_results);
+    }
+
+    clear_result_row(win, starting_rows + 2, starting_cols);
+    mvwprintw(win, starting_rows + 2, starting_cols, "Samples drawn from: %s",
+              s_paradox_sample_label);
 
     wrefresh(win);
 }
@@ -214,14 +328,20 @@ paradox_form_init(WINDOW* win, int max_y, int max_x) {
         // Set maximum field length
         set_max_field(manager->fields[i], manager->max_field_length);
 
-        // Set the field type to numeric
+        // Set the field type to numeric, the hash field takes the number of a hash function
         int max_value = calculate_form_max_value(metadata->max_length);
+        unsigned int field_max_value =
+            i == PARADOX_FIELD_HASH ? hash_config_len : metadata->max_value;
+        if (field_max_value > 0 && (int)field_max_value < max_value) {
+            max_value = field_max_value;
+        }
         set_field_type(manager->fields[i], TYPE_INTEGER, 0, (long)1, (long)max_value);
 
         // Initialize tracker
         manager->trackers[i].field = manager->fields[i];
         manager->trackers[i].current_length = strlen(string_buffer);
         manager->trackers[i].max_length = metadata->max_length;
+        manager->trackers[i].max_value = field_max_value;
         manager->trackers[i].field_index = i;
         manager->trackers[i].cursor_position = manager->trackers[i].current_length;
 
@@ -269,6 +389,8 @@ paradox_form_render(WINDOW* win, int max_y, int max_x) {
                   "]");
     }
 
+    render_hash_label();
+
     set_current_field(manager->form, manager->fields[0]);
     update_field_highlighting(manager);
     form_driver(manager->form, REQ_END_LINE);
@@ -316,7 +438,7 @@ paradox_form_restore(WINDOW* win, int max_y, int max_x, double collision_probabi
     set_current_field(manager->form, manager->fields[0]);
     form_driver(manager->form, REQ_FIRST_FIELD);
 
-    if (collision_probability != -1 && simulated_runs_results != -1) {
+    if (collision_probability != -1 && (simulated_runs_results != -1 || s_paradox_simulation)) {
         render_simulation_result(win, collision_probability, simulated_runs_results);
     }
 
@@ -329,10 +451,50 @@ paradox_form_restore(WINDOW* win, int max_y, int max_x, double collision_probabi
  */
 void
 paradox_form_destroy() {
+    // Leaving the page stops the running simulation
+    paradox_simulation_destroy(s_paradox_simulation);
+    s_paradox_simulation = NULL;
+    s_paradox_error = NULL;
+
     free_form_manager(manager);
     manager = NULL;
 }
 
+/**
+ * \brief          Run the next step of the running simulation and render its progress, or
+ *                 its result once it is done. Call it on every pass of the input loop, it
+ *                 returns right away when no simulation is running.
+ *
+ * \param[in]      win The window that the form previously initialize and render in.
+ * \param[in]      collision_probability The probability of the running simulation
+ * \param[out]     simulated_runs_results The variable reference to store the results of
+ *                 simulations once the simulation is done
+ */
+void
+paradox_form_update(WINDOW* win, double collision_probability, double* simulated_runs_results) {
+    if (!s_paradox_simulation) {
+        return;
+    }
+
+    s_paradox_runs_done = paradox_simulation_step(s_paradox_simulation, BH_PARADOX_STEP_SAMPLES);
+    if (s_paradox_runs_done < 0) {
+        s_paradox_error = "The simulation stopped, its hash function or memory allocation failed.";
+    }
+
+    if (s_paradox_runs_done < 0 || s_paradox_runs_done == s_paradox_runs) {
+        *simulated_runs_results =
+            s_paradox_error ? -1 : paradox_simulation_result(s_paradox_simulation);
+        paradox_simulation_destroy(s_paradox_simulation);
+        s_paradox_simulation = NULL;
+        update_button_field_is_running(paradox_form_field_get(manager->input_count),
+                                       paradox_form_buttons_metadata[0].label,
+                                       paradox_form_buttons_metadata[0].loading_label, false);
+    }
+
+    render_simulation_result(win, collision_probability, *simulated_runs_results);
+    pos_form_cursor(manager->form);
+}
+
 /**
  * \brief          Handles input for the paradox form.
  *
@@ -376,13 +538,16 @@ paradox_form_handle_input(WINDOW* win, int ch, double* collision_probability,
                 current_index = field_index(active_field);
 
                 update_field_highlighting(manager);
+                render_hash_label();
 
                 if (!is_button) {
                     on_field_change(manager, old_field, active_field);
                     pos_form_cursor(manager->form);
                 } else {
-                    set_field_buffer(paradox_form_field_get(manager->input_count), 0,
-                                     paradox_form_buttons_metadata[0].label);
+                    update_button_field_is_running(paradox_form_field_get(manager->input_count),
+                                                   paradox_form_buttons_metadata[0].label,
+                                                   paradox_form_buttons_metadata[0].loading_label,
+                                                   s_paradox_simulation != NULL);
                     pos_form_cursor(manager->form);
                 }
             }
@@ -447,7 +612,8 @@ paradox_form_handle_input(WINDOW* win, int ch, double* collision_probability,
 
         case '\n': {
             bool valid = validate_field_and_display(manager);
-            if (valid && is_button) {
+            // The button does nothing until the running simulation is done
+            if (valid && is_button && !s_paradox_simulation) {
                 run_simulation_from_input(collision_probability, simulated_runs_results);
                 render_simulation_result(win, *collision_probability, *simulated_runs_results);
             }
@@ -21,6 +21,7 @@
 
 #include "../../ui/error.h"
 #include "../../utils/paradox_math.h"
+#include "../attack/hash_config.h"
 #include "../../utils/utils.h"
 #include "../form.h"
 
@@ -33,6 +34,9 @@ void paradox_form_destroy();
 void paradox_form_handle_input(WINDOW* win, int ch, double* collision_probability,
                                double* simulated_runs_results);
 
+void paradox_form_update(WINDOW* win, double collision_probability,
+                         double* simulated_runs_results);
+
 void paradox_form_restore(WINDOW* win, int max_y, int max_x, double collision_probability,
                           double simulated_runs_results);
 
@@ -0,0 +1,223 @@
+/**
+ * \file            cpu_features.c
+ * \brief           The processor features the hash kernels are selected for, read once at
+ *                  startup: CPUID on x86, the hardware capabilities of the kernel on ARMv8.
+ *                  The BH_CPU_FEATURES environment variable narrows them down, so the kernel
+ *                  of every narrower feature set can be run and compared on one machine.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "cpu_features.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#define BH_CPU_X86
+#elif defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#define BH_CPU_ARM_LINUX
+#elif defined(__aarch64__) && defined(__APPLE__)
+#define BH_CPU_ARM_APPLE
+#endif
+
+/**
+ * \brief          The names of the features in the order of their bits, the names the
+ *                 environment variable lists
+ */
+static const char* const s_cpu_feature_names[BH_CPU_FEATURE_COUNT] = {
+    "sha-ni",
+    "avx2",
+    "avx512f",
+    "armv8-sha",
+    "sse4.1",
+};
+
+static bool s_cpu_initialized = false;
+static unsigned int s_cpu_detected = 0;
+static unsigned int s_cpu_features = 0;
+static const char* s_cpu_override = NULL;
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Read the features of the processor the program runs on
+ *
+ * \return         The detected features, a mask of cpu_feature_t
+ */
+static unsigned int
+detect_features(void) {
+    unsigned int features = 0;
+#if defined(BH_CPU_X86)
+    __builtin_cpu_init();
+    unsigned int eax, ebx, ecx, edx;
+    // The SHA rounds take their message words shuffled with SSSE3 and blended with SSE4.1
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_SHA)
+        && __builtin_cpu_supports("sse4.1")) {
+        features |= CPU_FEATURE_SHA_NI;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        features |= CPU_FEATURE_SSE41;
+    }
+    // The compiler also checks the operating system saves the wide registers
+    if (__builtin_cpu_supports("avx2")) {
+        features |= CPU_FEATURE_AVX2;
+    }
+    if (__builtin_cpu_supports("avx512f")) {
+        features |= CPU_FEATURE_AVX512F;
+    }
+#elif defined(BH_CPU_ARM_LINUX)
+    unsigned long hwcap = getauxval(AT_HWCAP);
+    if ((hwcap & HWCAP_SHA1) && (hwcap & HWCAP_SHA2)) {
+        features |= CPU_FEATURE_ARMV8_SHA;
+    }
+#elif defined(BH_CPU_ARM_APPLE)
+    // Every Apple processor of the architecture has the Crypto Extensions
+    features |= CPU_FEATURE_ARMV8_SHA;
+#endif
+    return features;
+}
+
+/**
+ * \brief          Read the features an override allows: the names separated by commas or
+ *                 spaces, "none" and the unknown names allow nothing
+ *
+ * \param[in]      value The value of the environment variable
+ * \return         The allowed features, a mask of cpu_feature_t
+ */
+static unsigned int
+parse_override(const char* value) {
+    unsigned int allowed = 0;
+    while (*value != '\0') {
+        size_t len = strcspn(value, ", ");
+        for (unsigned int i = 0; i < BH_CPU_FEATURE_COUNT; i++) {
+            if (strlen(s_cpu_feature_names[i]) == len
+                && strncmp(value, s_cpu_feature_names[i], len) == 0) {
+                allowed |= 1U << i;
+            }
+        }
+        value += len;
+        value += strspn(value, ", ");
+    }
+    return allowed;
+}
+
+/****************************************************************
+                       EXTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Detect the features of the processor and apply the override of the
+ *                 environment. It is called once at startup, before any worker runs.
+ */
+void
+cpu_features_init(void) {
+    s_cpu_detected = detect_features();
+    s_cpu_override = getenv(BH_CPU_FEATURES_ENV);
+    if (s_cpu_override != NULL && *s_cpu_override == '\0') {
+        s_cpu_override = NULL;
+    }
+
+    // An override only narrows the features down, a missing instruction cannot be forced
+    s_cpu_features = s_cpu_detected;
+    if (s_cpu_override != NULL) {
+        s_cpu_features &= parse_override(s_cpu_override);
+    }
+    s_cpu_initialized = true;
+}
+
+/**
+ * \brief          Get the features the processor has, before the override
+ *
+ * \return         A mask of cpu_feature_t
+ */
+unsigned int
+cpu_features_detected(void) {
+    if (!s_cpu_initialized) {
+        cpu_features_init();
+    }
+    return s_cpu_detected;
+}
+
+/**
+ * \brief          Get the features the kernels may use, the detected ones the override allows
+ *
+ * \return         A mask of cpu_feature_t
+ */
+unsigned int
+cpu_features(void) {
+    if (!s_cpu_initialized) {
+        cpu_features_init();
+    }
+    return s_cpu_features;
+}
+
+/**
+ * \brief          Check whether the kernels may use a feature
+ *
+ * \param[in]      feature The feature
+ * \return         true when the processor has it and the override allows it
+ */
+bool
+cpu_has(cpu_feature_t feature) {
+    return (cpu_features() & feature) != 0;
+}
+
+/**
+ * \brief          Get the value of the override
+ *
+ * \return         The value of BH_CPU_FEATURES, or NULL when it is not set
+ */
+const char*
+cpu_features_override(void) {
+    if (!s_cpu_initialized) {
+        cpu_features_init();
+    }
+    return s_cpu_override;
+}
+
+/**
+ * \brief          Get the name of a feature, the one the environment variable lists
+ *
+ * \param[in]      feature The feature
+ * \return         A static string
+ */
+const char*
+cpu_feature_name(cpu_feature_t feature) {
+    for (unsigned int i = 0; i < BH_CPU_FEATURE_COUNT; i++) {
+        if (feature == 1U << i) {
+            return s_cpu_feature_names[i];
+        }
+    }
+    return "unknown";
+}
+
+/**
+ * \brief          Write the names of a set of features separated by spaces
+ *
+ * \param[in]      features A mask of cpu_feature_t
+ * \param[out]     buffer Receives the names, "none" for an empty set
+ * \param[in]      size The size of the buffer in bytes
+ * \return         The buffer
+ */
+char*
+cpu_features_describe(unsigned int features, char* buffer, size_t size) {
+    size_t used = 0;
+    buffer[0] = '\0';
+    for (unsigned int i = 0; i < BH_CPU_FEATURE_COUNT && used < size; i++) {
+        if (features & (1U << i)) {
+            int written = snprintf(buffer + used, size - used, "%s%s", used > 0 ? " " : "",
+                                   s_cpu_feature_names[i]);
+            used += written > 0 ? (size_t)written : 0;
+        }
+    }
+    if (used == 0) {
+        snprintf(buffer, size, "none");
+    }
+    return buffer;
+}
@@ -0,0 +1,51 @@
+/**
+ * \file            cpu_features.h
+ * \brief           Header file for cpu_features.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * \brief          The environment variable that limits the features the kernels may use, a
+ *                 comma separated list of feature names, or "none" for the portable kernels
+ */
+#define BH_CPU_FEATURES_ENV "BH_CPU_FEATURES"
+
+/**
+ * \brief          The processor features a hash kernel may be selected for, one bit each
+ */
+typedef enum {
+    CPU_FEATURE_SHA_NI = 1 << 0,    ///< x86 SHA extensions, the SHA-1 and SHA-256 rounds
+    CPU_FEATURE_AVX2 = 1 << 1,      ///< x86 256-bit integer vectors
+    CPU_FEATURE_AVX512F = 1 << 2,   ///< x86 512-bit vectors
+    CPU_FEATURE_ARMV8_SHA = 1 << 3, ///< ARMv8 Crypto Extensions, the SHA-1 and SHA-256 rounds
+    CPU_FEATURE_SSE41 = 1 << 4,     ///< x86 SSE4.1, the 128-bit integer vectors with blends
+} cpu_feature_t;
+
+/**
+ * \brief          The number of features in cpu_feature_t
+ */
+#define BH_CPU_FEATURE_COUNT 5
+
+void cpu_features_init(void);
+unsigned int cpu_features_detected(void);
+unsigned int cpu_features(void);
+bool cpu_has(cpu_feature_t feature);
+const char* cpu_features_override(void);
+const char* cpu_feature_name(cpu_feature_t feature);
+char* cpu_features_describe(unsigned int features, char* buffer, size_t size);
+
+#endif
@@ -0,0 +1,456 @@
+/**
+ * \file            hash_blake3.c
+ * \brief           BLAKE3 with its default 32-byte output. The input is split into chunks
+ *                  of 1024 bytes, every chunk is compressed block by block into a chaining
+ *                  value and the chaining values are merged pairwise up a binary tree. The
+ *                  inputs of the attacks fit one chunk, which is the root of the tree then,
+ *                  and the batches compress those chunks several at a time, one input per
+ *                  lane of a vector register, on the processors with SSE4.1, AVX2 or AVX-512.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_blake3.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define BH_BLAKE3_USE_X86
+#endif
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+#define BLAKE3_BLOCK_BYTES 64
+#define BLAKE3_CHUNK_BYTES 1024
+
+/**
+ * \brief          The most chaining values waiting on the stack, one per level of the tree
+ */
+#define BLAKE3_MAX_DEPTH 54
+
+enum {
+    BLAKE3_CHUNK_START = 1 << 0,
+    BLAKE3_CHUNK_END = 1 << 1,
+    BLAKE3_PARENT = 1 << 2,
+    BLAKE3_ROOT = 1 << 3,
+};
+
+static const uint32_t s_blake3_iv[8] = {0x6A09E667U, 0xBB67AE85U, 0x3C6EF372U, 0xA54FF53AU,
+                                        0x510E527FU, 0x9B05688CU, 0x1F83D9ABU, 0x5BE0CD19U};
+
+/**
+ * \brief          The message word every round reads at every position, the message
+ *                 permutation applied round after round
+ */
+static const uint8_t s_blake3_schedule[7][16] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    {2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8},
+    {3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1},
+    {10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6},
+    {12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4},
+    {9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7},
+    {11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13},
+};
+
+static inline uint32_t
+load_le32(const uint8_t* bytes) {
+    return ((uint32_t)bytes[3] << 24) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[1] << 8)
+           | bytes[0];
+}
+
+/**
+ * \brief          Rotate a word right, a 32-bit word or a vector of them alike
+ */
+#define BLAKE3_ROTR(word, bits) (((word) >> (bits)) | ((word) << (32 - (bits))))
+
+/**
+ * \brief          The BLAKE3 quarter round on four state words and two message words
+ */
+#define BLAKE3_G(a, b, c, d, x, y)                                                                 \
+    do {                                                                                           \
+        a = a + b + (x);                                                                           \
+        d = BLAKE3_ROTR(d ^ a, 16);                                                                \
+        c = c + d;                                                                                 \
+        b = BLAKE3_ROTR(b ^ c, 12);                                                                \
+        a = a + b + (y);                                                                           \
+        d = BLAKE3_ROTR(d ^ a, 8);                                                                 \
+        c = c + d;                                                                                 \
+        b = BLAKE3_ROTR(b ^ c, 7);                                                                 \
+    } while (0)
+
+/**
+ * \brief          The seven rounds of the compression on the 16 state words v and the 16
+ *                 message words m, of type uint32_t for one block or vectors of them with one
+ *                 block per element: the rounds are made of additions, XOR and rotations,
+ *                 which apply to every element of a vector alike.
+ */
+#define BLAKE3_ROUNDS(v, m)                                                                        \
+    do {                                                                                           \
+        for (int round = 0; round < 7; round++) {                                                  \
+            const uint8_t* s = s_blake3_schedule[round];                                           \
+            BLAKE3_G(v[0], v[4], v[8], v[12], m[s[0]], m[s[1]]);                                   \
+            BLAKE3_G(v[1], v[5], v[9], v[13], m[s[2]], m[s[3]]);                                   \
+            BLAKE3_G(v[2], v[6], v[10], v[14], m[s[4]], m[s[5]]);                                  \
+            BLAKE3_G(v[3], v[7], v[11], v[15], m[s[6]], m[s[7]]);                                  \
+            BLAKE3_G(v[0], v[5], v[10], v[15], m[s[8]], m[s[9]]);                                  \
+            BLAKE3_G(v[1], v[6], v[11], v[12], m[s[10]], m[s[11]]);                                \
+            BLAKE3_G(v[2], v[7], v[8], v[13], m[s[12]], m[s[13]]);                                 \
+            BLAKE3_G(v[3], v[4], v[9], v[14], m[s[14]], m[s[15]]);                                 \
+        }                                                                                          \
+    } while (0)
+
+/**
+ * \brief          Compress one block into the next chaining value: seven rounds of the
+ *                 columns, then the diagonals, of the 16 state words
+ *
+ * \param[in]      cv The chaining value before the block
+ * \param[in]      block The 64 bytes of the block, zero padded
+ * \param[in]      counter The chunk counter, 0 for a parent
+ * \param[in]      block_len The bytes of the block before the padding
+ * \param[in]      flags The domain flags of the block
+ * \param[out]     out Receives the chaining value after the block, it may be cv
+ */
+static void
+blake3_compress(const uint32_t* cv, const uint8_t* block, uint64_t counter, uint32_t block_len,
+                uint32_t flags, uint32_t* out) {
+    uint32_t m[16];
+    for (int i = 0; i < 16; i++) {
+        m[i] = load_le32(block + 4 * i);
+    }
+
+    uint32_t v[16] = {cv[0], cv[1], cv[2], cv[3], cv[4], cv[5], cv[6], cv[7],
+                      s_blake3_iv[0], s_blake3_iv[1], s_blake3_iv[2], s_blake3_iv[3],
+                      (uint32_t)counter, (uint32_t)(counter >> 32), block_len, flags};
+    BLAKE3_ROUNDS(v, m);
+
+    for (int i = 0; i < 8; i++) {
+        out[i] = v[i] ^ v[i + 8];
+    }
+}
+
+/**
+ * \brief          Compress every block of a chunk but the last one, then keep the last one
+ *                 for the caller to compress as a chunk or as the root
+ *
+ * \param[in]      chunk The bytes of the chunk
+ * \param[in]      len The bytes of the chunk, at most 1024
+ * \param[in]      counter The index of the chunk in the input
+ * \param[out]     cv Receives the chaining value before the last block
+ * \param[out]     last Receives the last block, zero padded
+ * \param[out]     last_len Receives the bytes of the last block before the padding
+ * \return         The flags of the last block, without ROOT
+ */
+static uint32_t
+blake3_chunk_start(const uint8_t* chunk, size_t len, uint64_t counter, uint32_t* cv,
+                   uint8_t* last, uint32_t* last_len) {
+    memcpy(cv, s_blake3_iv, sizeof(s_blake3_iv));
+    uint32_t flags = BLAKE3_CHUNK_START;
+    while (len > BLAKE3_BLOCK_BYTES) {
+        blake3_compress(cv, chunk, counter, BLAKE3_BLOCK_BYTES, flags, cv);
+        chunk += BLAKE3_BLOCK_BYTES;
+        len -= BLAKE3_BLOCK_BYTES;
+        flags = 0;
+    }
+
+    memset(last, 0, BLAKE3_BLOCK_BYTES);
+    memcpy(last, chunk, len);
+    *last_len = (uint32_t)len;
+    return flags | BLAKE3_CHUNK_END;
+}
+
+/**
+ * \brief          Write the left and the right chaining values as the block of a parent
+ *
+ * \param[in]      left The left chaining value
+ * \param[in]      right The right chaining value
+ * \param[out]     block Receives the 64 bytes of the block
+ */
+static void
+blake3_parent_block(const uint32_t* left, const uint32_t* right, uint8_t* block) {
+    for (int i = 0; i < 8; i++) {
+        for (int b = 0; b < 4; b++) {
+            block[4 * i + b] = (uint8_t)(left[i] >> (8 * b));
+            block[32 + 4 * i + b] = (uint8_t)(right[i] >> (8 * b));
+        }
+    }
+}
+
+#if defined(BH_BLAKE3_USE_X86)
+
+/**
+ * \brief          The words of 4, 8 and 16 blocks, one block per element. The GCC vector
+ *                 extensions compile the operators on them to the instructions of the target
+ *                 of the function that uses them, so there is one kernel per target below.
+ */
+typedef uint32_t blake3_x4_t __attribute__((vector_size(16)));
+typedef uint32_t blake3_x8_t __attribute__((vector_size(32)));
+typedef uint32_t blake3_x16_t __attribute__((vector_size(64)));
+
+/**
+ * \brief          Define the kernel that hashes up to `lanes` single-chunk inputs at once, one
+ *                 input per element of word_t. The inputs are compressed block by block side
+ *                 by side; an input with fewer blocks keeps its chaining value once its root
+ *                 block is compressed, and the unused elements are never stored.
+ */
+#define BLAKE3_DEFINE_LANES_KERNEL(name, isa, word_t, lanes)                                       \
+    __attribute__((target(isa))) static void name(const uint8_t* const* inputs,                    \
+                                                  const size_t* input_lens, size_t count,          \
+                                                  uint8_t* digests) {                              \
+        size_t blocks[lanes] = {0}, max_blocks = 0;                                                \
+        for (size_t m = 0; m < count; m++) {                                                       \
+            blocks[m] = (input_lens[m] + BLAKE3_BLOCK_BYTES - 1) / BLAKE3_BLOCK_BYTES;             \
+            blocks[m] = blocks[m] > 0 ? blocks[m] : 1;                                             \
+            max_blocks = blocks[m] > max_blocks ? blocks[m] : max_blocks;                          \
+        }                                                                                          \
+                                                                                                   \
+        const word_t zero = {0};                                                                   \
+        word_t cv[8];                                                                              \
+        for (int i = 0; i < 8; i++) {                                                              \
+            cv[i] = zero + s_blake3_iv[i];                                                         \
+        }                                                                                          \
+                                                                                                   \
+        for (size_t b = 0; b < max_blocks; b++) {                                                  \
+            word_t w[16] = {0}, block_len = zero, flags = zero, active = zero;                     \
+            for (size_t m = 0; m < count; m++) {                                                   \
+                if (b >= blocks[m]) {                                                              \
+                    continue;                                                                      \
+                }                                                                                  \
+                size_t offset = b * BLAKE3_BLOCK_BYTES;                                            \
+                size_t len = input_lens[m] - offset;                                               \
+                len = len < BLAKE3_BLOCK_BYTES ? len : BLAKE3_BLOCK_BYTES;                         \
+                uint8_t block[BLAKE3_BLOCK_BYTES] = {0};                                           \
+                memcpy(block, inputs[m] + offset, len);                                            \
+                for (int i = 0; i < 16; i++) {                                                     \
+                    w[i][m] = load_le32(block + 4 * i);                                            \
+                }                                                                                  \
+                block_len[m] = (uint32_t)len;                                                      \
+                flags[m] = (b == 0 ? BLAKE3_CHUNK_START : 0)                                       \
+                           | (b + 1 == blocks[m] ? BLAKE3_CHUNK_END | BLAKE3_ROOT : 0);            \
+                active[m] = UINT32_MAX;                                                            \
+            }                                                                                      \
+                                                                                                   \
+            /* The chunk counter is 0, the inputs are the first and only chunk */                  \
+            word_t v[16] = {cv[0], cv[1], cv[2], cv[3], cv[4], cv[5], cv[6], cv[7],                \
+                            zero + s_blake3_iv[0], zero + s_blake3_iv[1], zero + s_blake3_iv[2],   \
+                            zero + s_blake3_iv[3], zero, zero, block_len, flags};                  \
+            BLAKE3_ROUNDS(v, w);                                                                   \
+            for (int i = 0; i < 8; i++) {                                                          \
+                cv[i] = ((v[i] ^ v[i + 8]) & active) | (cv[i] & ~active);                          \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        for (size_t m = 0; m < count; m++) {                                                       \
+            for (int i = 0; i < 8; i++) {                                                          \
+                uint8_t* word = digests + m * BH_BLAKE3_DIGEST_BYTES + 4 * i;                      \
+                for (int b = 0; b < 4; b++) {                                                      \
+                    word[b] = (uint8_t)(cv[i][m] >> (8 * b));                                      \
+                }                                                                                  \
+            }                                                                                      \
+        }                                                                                          \
+    }
+
+BLAKE3_DEFINE_LANES_KERNEL(blake3_chunks_sse41, "sse4.1", blake3_x4_t, 4)
+BLAKE3_DEFINE_LANES_KERNEL(blake3_chunks_avx2, "avx2", blake3_x8_t, 8)
+BLAKE3_DEFINE_LANES_KERNEL(blake3_chunks_avx512, "avx512f", blake3_x16_t, 16)
+
+#endif
+
+/**
+ * \brief          Hash single-chunk inputs, as many at once as the kernel has lanes. The
+ *                 inputs left over from the widest kernel go through the narrower ones.
+ *
+ * \param[in]      inputs The inputs, at most BLAKE3_CHUNK_BYTES each
+ * \param[in]      input_lens The length of every input in bytes
+ * \param[in]      count The number of inputs
+ * \param[out]     digests Receives the BH_BLAKE3_DIGEST_BYTES of every digest in a row
+ */
+static void
+blake3_chunks(const uint8_t* const* inputs, const size_t* input_lens, size_t count,
+              uint8_t* digests) {
+    size_t done = 0;
+#if defined(BH_BLAKE3_USE_X86)
+    if (cpu_has(CPU_FEATURE_AVX512F)) {
+        for (; count - done >= 16; done += 16) {
+            blake3_chunks_avx512(inputs + done, input_lens + done, 16,
+                                 digests + done * BH_BLAKE3_DIGEST_BYTES);
+        }
+    }
+    if (cpu_has(CPU_FEATURE_AVX2)) {
+        for (; count - done >= 8; done += 8) {
+            blake3_chunks_avx2(inputs + done, input_lens + done, 8,
+                               digests + done * BH_BLAKE3_DIGEST_BYTES);
+        }
+    }
+    if (cpu_has(CPU_FEATURE_SSE41)) {
+        // A partly filled vector still beats compressing two inputs one after the other
+        while (count - done >= 2) {
+            size_t lanes = count - done < 4 ? count - done : 4;
+            blake3_chunks_sse41(inputs + done, input_lens + done, lanes,
+                                digests + done * BH_BLAKE3_DIGEST_BYTES);
+            done += lanes;
+        }
+    }
+#endif
+    for (; done < count; done++) {
+        hash_blake3(inputs[done], input_lens[done], digests + done * BH_BLAKE3_DIGEST_BYTES);
+    }
+}
+
+/**
+ * \brief          Hash the gathered inputs of a batch and write every digest at the index of
+ *                 its input
+ *
+ * \param[in]      inputs The gathered inputs
+ * \param[in]      input_lens The length of every gathered input in bytes
+ * \param[in]      owners The index of the input in the batch of every gathered input
+ * \param[in]      count The number of gathered inputs, at most BH_BLAKE3_MAX_LANES
+ * \param[out]     digests The digests of the batch, in the order of its inputs
+ */
+static void
+blake3_gathered_chunks(const uint8_t* const* inputs, const size_t* input_lens,
+                       const size_t* owners, size_t count, uint8_t* digests) {
+    uint8_t chunk_digests[BH_BLAKE3_MAX_LANES * BH_BLAKE3_DIGEST_BYTES];
+    blake3_chunks(inputs, input_lens, count, chunk_digests);
+    for (size_t m = 0; m < count; m++) {
+        memcpy(digests + owners[m] * BH_BLAKE3_DIGEST_BYTES,
+               chunk_digests + m * BH_BLAKE3_DIGEST_BYTES, BH_BLAKE3_DIGEST_BYTES);
+    }
+}
+
+/****************************************************************
+                       EXTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Get the widest BLAKE3 kernel the processor runs, from the features detected
+ *                 at startup
+ *
+ * \return         The kernel hash_blake3_many hashes most inputs of a batch with
+ */
+hash_blake3_kernel_t
+hash_blake3_kernel(void) {
+#if defined(BH_BLAKE3_USE_X86)
+    if (cpu_has(CPU_FEATURE_AVX512F)) {
+        return HASH_BLAKE3_AVX512;
+    }
+    if (cpu_has(CPU_FEATURE_AVX2)) {
+        return HASH_BLAKE3_AVX2;
+    }
+    if (cpu_has(CPU_FEATURE_SSE41)) {
+        return HASH_BLAKE3_SSE41;
+    }
+#endif
+    return HASH_BLAKE3_SCALAR;
+}
+
+/**
+ * \brief          Get the name of a BLAKE3 kernel for display
+ *
+ * \param[in]      kernel The kernel
+ * \return         A static string
+ */
+const char*
+hash_blake3_kernel_name(hash_blake3_kernel_t kernel) {
+    switch (kernel) {
+        case HASH_BLAKE3_AVX512: return "AVX-512, 16 lanes";
+        case HASH_BLAKE3_AVX2: return "AVX2, 8 lanes";
+        case HASH_BLAKE3_SSE41: return "SSE4.1, 4 lanes";
+        default: return "scalar";
+    }
+}
+
+/**
+ * \brief          Compute the BLAKE3 digest of an input. The chaining values of the complete
+ *                 subtrees wait on a stack, a new one is merged with the ones below it as
+ *                 long as the chunk count has trailing zeros. The last chunk is merged with
+ *                 the whole stack, and whichever node is left is compressed as the root.
+ *
+ * \param[in]      data Pointer to input data buffer
+ * \param[in]      len Length of input data in bytes
+ * \param[out]     digest Receives the BH_BLAKE3_DIGEST_BYTES of the digest
+ */
+void
+hash_blake3(const void* data, size_t len, uint8_t* digest) {
+    const uint8_t* input = data;
+    uint32_t stack[BLAKE3_MAX_DEPTH][8];
+    unsigned int depth = 0;
+    uint64_t counter = 0;
+
+    for (; len > BLAKE3_CHUNK_BYTES; input += BLAKE3_CHUNK_BYTES, len -= BLAKE3_CHUNK_BYTES) {
+        uint32_t cv[8], last_len;
+        uint8_t last[BLAKE3_BLOCK_BYTES];
+        uint32_t flags =
+            blake3_chunk_start(input, BLAKE3_CHUNK_BYTES, counter, cv, last, &last_len);
+        blake3_compress(cv, last, counter, last_len, flags, cv);
+
+        counter++;
+        for (uint64_t chunks = counter; (chunks & 1) == 0; chunks >>= 1) {
+            uint8_t block[BLAKE3_BLOCK_BYTES];
+            blake3_parent_block(stack[--depth], cv, block);
+            blake3_compress(s_blake3_iv, block, 0, BLAKE3_BLOCK_BYTES, BLAKE3_PARENT, cv);
+        }
+        memcpy(stack[depth++], cv, sizeof(cv));
+    }
+
+    // The node still open: the last chunk, then every parent up the stack
+    uint32_t cv[8], block_len;
+    uint8_t block[BLAKE3_BLOCK_BYTES];
+    uint32_t flags = blake3_chunk_start(input, len, counter, cv, block, &block_len);
+    uint64_t block_counter = counter;
+    while (depth > 0) {
+        uint32_t right[8];
+        blake3_compress(cv, block, block_counter, block_len, flags, right);
+        blake3_parent_block(stack[--depth], right, block);
+        memcpy(cv, s_blake3_iv, sizeof(s_blake3_iv));
+        block_counter = 0;
+        block_len = BLAKE3_BLOCK_BYTES;
+        flags = BLAKE3_PARENT;
+    }
+
+    uint32_t root[8];
+    blake3_compress(cv, block, block_counter, block_len, flags | BLAKE3_ROOT, root);
+    for (int i = 0; i < 8; i++) {
+        for (int b = 0; b < 4; b++) {
+            digest[4 * i + b] = (uint8_t)(root[i] >> (8 * b));
+        }
+    }
+}
+
+/**
+ * \brief          Compute the BLAKE3 digests of a batch of inputs. The inputs that fit one
+ *                 chunk are gathered and hashed several at a time, the longer ones go through
+ *                 the tree of hash_blake3.
+ *
+ * \param[in]      inputs The inputs to hash
+ * \param[in]      input_lens The length of every input in bytes
+ * \param[in]      count The number of inputs
+ * \param[out]     digests Receives the BH_BLAKE3_DIGEST_BYTES of every digest in a row
+ */
+void
+hash_blake3_many(const uint8_t* const* inputs, const size_t* input_lens, size_t count,
+                 uint8_t* digests) {
+    const uint8_t* gathered[BH_BLAKE3_MAX_LANES];
+    size_t gathered_lens[BH_BLAKE3_MAX_LANES];
+    size_t owners[BH_BLAKE3_MAX_LANES];
+    size_t gathered_count = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (input_lens[i] > BLAKE3_CHUNK_BYTES) {
+            hash_blake3(inputs[i], input_lens[i], digests + i * BH_BLAKE3_DIGEST_BYTES);
+            continue;
+        }
+
+        gathered[gathered_count] = inputs[i];
+        gathered_lens[gathered_count] = input_lens[i];
+        owners[gathered_count++] = i;
+        if (gathered_count == BH_BLAKE3_MAX_LANES) {
+            blake3_gathered_chunks(gathered, gathered_lens, owners, gathered_count, digests);
+            gathered_count = 0;
+        }
+    }
+    blake3_gathered_chunks(gathered, gathered_lens, owners, gathered_count, digests);
+}
@@ -0,0 +1,44 @@
+/**
+ * \file            hash_blake3.h
+ * \brief           Header file for hash_blake3.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_BLAKE3_H
+#define HASH_BLAKE3_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cpu_features.h"
+
+/**
+ * \brief          The bytes of a BLAKE3 digest, the default output length
+ */
+#define BH_BLAKE3_DIGEST_BYTES 32
+
+/**
+ * \brief          The most inputs a BLAKE3 kernel hashes at once, the 16 lanes of AVX-512
+ */
+#define BH_BLAKE3_MAX_LANES 16
+
+typedef enum {
+    HASH_BLAKE3_SCALAR = 0, ///< One input per compression, on any processor
+    HASH_BLAKE3_SSE41,      ///< Four inputs per compression in the 128-bit registers
+    HASH_BLAKE3_AVX2,       ///< Eight inputs per compression in the 256-bit registers
+    HASH_BLAKE3_AVX512      ///< Sixteen inputs per compression in the 512-bit registers
+} hash_blake3_kernel_t;
+
+hash_blake3_kernel_t hash_blake3_kernel(void);
+const char* hash_blake3_kernel_name(hash_blake3_kernel_t kernel);
+void hash_blake3(const void* data, size_t len, uint8_t* digest);
+void hash_blake3_many(const uint8_t* const* inputs, const size_t* input_lens, size_t count,
+                      uint8_t* digests);
+
+#endif
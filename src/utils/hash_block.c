@@ -0,0 +1,796 @@
+/**
+ * \file            hash_block.c
+ * \brief           Single-block kernels of the hash functions that OpenSSL computes for the
+ *                  other inputs. A message that fits one block with its padding is hashed by
+ *                  one compression from the initial state, so each kernel is the compression
+ *                  function alone with the padding written once for every message.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_block.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define BH_BLOCK_USE_SHA_NI
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+#include <arm_neon.h>
+#define BH_BLOCK_USE_ARMV8_SHA
+#if defined(__clang__)
+#define BH_BLOCK_ARMV8_TARGET "crypto"
+#else
+#define BH_BLOCK_ARMV8_TARGET "+crypto"
+#endif
+#endif
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+static const uint32_t s_sha256_k[64] = {
+    0x428A2F98U, 0x71374491U, 0xB5C0FBCFU, 0xE9B5DBA5U, 0x3956C25BU, 0x59F111F1U,
+    0x923F82A4U, 0xAB1C5ED5U, 0xD807AA98U, 0x12835B01U, 0x243185BEU, 0x550C7DC3U,
+    0x72BE5D74U, 0x80DEB1FEU, 0x9BDC06A7U, 0xC19BF174U, 0xE49B69C1U, 0xEFBE4786U,
+    0x0FC19DC6U, 0x240CA1CCU, 0x2DE92C6FU, 0x4A7484AAU, 0x5CB0A9DCU, 0x76F988DAU,
+    0x983E5152U, 0xA831C66DU, 0xB00327C8U, 0xBF597FC7U, 0xC6E00BF3U, 0xD5A79147U,
+    0x06CA6351U, 0x14292967U, 0x27B70A85U, 0x2E1B2138U, 0x4D2C6DFCU, 0x53380D13U,
+    0x650A7354U, 0x766A0ABBU, 0x81C2C92EU, 0x92722C85U, 0xA2BFE8A1U, 0xA81A664BU,
+    0xC24B8B70U, 0xC76C51A3U, 0xD192E819U, 0xD6990624U, 0xF40E3585U, 0x106AA070U,
+    0x19A4C116U, 0x1E376C08U, 0x2748774CU, 0x34B0BCB5U, 0x391C0CB3U, 0x4ED8AA4AU,
+    0x5B9CCA4FU, 0x682E6FF3U, 0x748F82EEU, 0x78A5636FU, 0x84C87814U, 0x8CC70208U,
+    0x90BEFFFAU, 0xA4506CEBU, 0xBEF9A3F7U, 0xC67178F2U,
+};
+
+static const uint32_t s_sha256_iv[8] = {
+    0x6A09E667U, 0xBB67AE85U, 0x3C6EF372U, 0xA54FF53AU,
+    0x510E527FU, 0x9B05688CU, 0x1F83D9ABU, 0x5BE0CD19U,
+};
+
+static const uint32_t s_sha1_iv[5] = {
+    0x67452301U, 0xEFCDAB89U, 0x98BADCFEU, 0x10325476U, 0xC3D2E1F0U,
+};
+
+static const uint32_t s_sha1_k[4] = {0x5A827999U, 0x6ED9EBA1U, 0x8F1BBCDCU, 0xCA62C1D6U};
+
+static const uint64_t s_sha512_k[80] = {
+    0x428A2F98D728AE22ULL, 0x7137449123EF65CDULL, 0xB5C0FBCFEC4D3B2FULL,
+    0xE9B5DBA58189DBBCULL, 0x3956C25BF348B538ULL, 0x59F111F1B605D019ULL,
+    0x923F82A4AF194F9BULL, 0xAB1C5ED5DA6D8118ULL, 0xD807AA98A3030242ULL,
+    0x12835B0145706FBEULL, 0x243185BE4EE4B28CULL, 0x550C7DC3D5FFB4E2ULL,
+    0x72BE5D74F27B896FULL, 0x80DEB1FE3B1696B1ULL, 0x9BDC06A725C71235ULL,
+    0xC19BF174CF692694ULL, 0xE49B69C19EF14AD2ULL, 0xEFBE4786384F25E3ULL,
+    0x0FC19DC68B8CD5B5ULL, 0x240CA1CC77AC9C65ULL, 0x2DE92C6F592B0275ULL,
+    0x4A7484AA6EA6E483ULL, 0x5CB0A9DCBD41FBD4ULL, 0x76F988DA831153B5ULL,
+    0x983E5152EE66DFABULL, 0xA831C66D2DB43210ULL, 0xB00327C898FB213FULL,
+    0xBF597FC7BEEF0EE4ULL, 0xC6E00BF33DA88FC2ULL, 0xD5A79147930AA725ULL,
+    0x06CA6351E003826FULL, 0x142929670A0E6E70ULL, 0x27B70A8546D22FFCULL,
+    0x2E1B21385C26C926ULL, 0x4D2C6DFC5AC42AEDULL, 0x53380D139D95B3DFULL,
+    0x650A73548BAF63DEULL, 0x766A0ABB3C77B2A8ULL, 0x81C2C92E47EDAEE6ULL,
+    0x92722C851482353BULL, 0xA2BFE8A14CF10364ULL, 0xA81A664BBC423001ULL,
+    0xC24B8B70D0F89791ULL, 0xC76C51A30654BE30ULL, 0xD192E819D6EF5218ULL,
+    0xD69906245565A910ULL, 0xF40E35855771202AULL, 0x106AA07032BBD1B8ULL,
+    0x19A4C116B8D2D0C8ULL, 0x1E376C085141AB53ULL, 0x2748774CDF8EEB99ULL,
+    0x34B0BCB5E19B48A8ULL, 0x391C0CB3C5C95A63ULL, 0x4ED8AA4AE3418ACBULL,
+    0x5B9CCA4F7763E373ULL, 0x682E6FF3D6B2B8A3ULL, 0x748F82EE5DEFB2FCULL,
+    0x78A5636F43172F60ULL, 0x84C87814A1F0AB72ULL, 0x8CC702081A6439ECULL,
+    0x90BEFFFA23631E28ULL, 0xA4506CEBDE82BDE9ULL, 0xBEF9A3F7B2C67915ULL,
+    0xC67178F2E372532BULL, 0xCA273ECEEA26619CULL, 0xD186B8C721C0C207ULL,
+    0xEADA7DD6CDE0EB1EULL, 0xF57D4F7FEE6ED178ULL, 0x06F067AA72176FBAULL,
+    0x0A637DC5A2C898A6ULL, 0x113F9804BEF90DAEULL, 0x1B710B35131C471BULL,
+    0x28DB77F523047D84ULL, 0x32CAAB7B40C72493ULL, 0x3C9EBE0A15C9BEBCULL,
+    0x431D67C49C100D4CULL, 0x4CC5D4BECB3E42B6ULL, 0x597F299CFC657E2AULL,
+    0x5FCB6FAB3AD6FAECULL, 0x6C44198C4A475817ULL,
+};
+
+static const uint64_t s_sha512_iv[8] = {
+    0x6A09E667F3BCC908ULL, 0xBB67AE8584CAA73BULL, 0x3C6EF372FE94F82BULL,
+    0xA54FF53A5F1D36F1ULL, 0x510E527FADE682D1ULL, 0x9B05688C2B3E6C1FULL,
+    0x1F83D9ABFB41BD6BULL, 0x5BE0CD19137E2179ULL,
+};
+
+static const uint64_t s_sha384_iv[8] = {
+    0xCBBB9D5DC1059ED8ULL, 0x629A292A367CD507ULL, 0x9159015A3070DD17ULL,
+    0x152FECD8F70E5939ULL, 0x67332667FFC00B31ULL, 0x8EB44A8768581511ULL,
+    0xDB0C2E0D64F98FA7ULL, 0x47B5481DBEFA4FA4ULL,
+};
+
+/**
+ * \brief          The message word of every step of the left and the right line of RIPEMD-160
+ */
+static const uint8_t s_ripemd_r[2][80] = {
+    {0, 1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15, 7,  4,  13, 1,
+     10, 6, 15, 3,  12, 0,  9,  5,  2,  14, 11, 8,  3,  10, 14, 4,  9,  15, 8,  1,
+     2,  7, 0,  6,  13, 11, 5,  12, 1,  9,  11, 10, 0,  8,  12, 4,  13, 3,  7,  15,
+     14, 5, 6,  2,  4,  0,  5,  9,  7,  12, 2,  10, 14, 1,  3,  8,  11, 6,  15, 13},
+    {5,  14, 7,  0,  9, 2,  11, 4,  13, 6,  15, 8,  1,  10, 3,  12, 6,  11, 3,  7,
+     0,  13, 5,  10, 14, 15, 8, 12, 4,  9,  1,  2,  15, 5,  1,  3,  7,  14, 6,  9,
+     11, 8,  12, 2,  10, 0,  4,  13, 8,  6,  4,  1,  3,  11, 15, 0,  5,  12, 2,  13,
+     9,  7,  10, 14, 12, 15, 10, 4,  1,  5,  8,  7,  6,  2,  13, 14, 0,  3,  9,  11},
+};
+
+/**
+ * \brief          The rotation of every step of the left and the right line of RIPEMD-160
+ */
+static const uint8_t s_ripemd_s[2][80] = {
+    {11, 14, 15, 12, 5,  8,  7,  9,  11, 13, 14, 15, 6,  7,  9,  8,  7,  6,  8,  13,
+     11, 9,  7,  15, 7,  12, 15, 9,  11, 7,  13, 12, 11, 13, 6,  7,  14, 9,  13, 15,
+     14, 8,  13, 6,  5,  12, 7,  5,  11, 12, 14, 15, 14, 15, 9,  8,  9,  14, 5,  6,
+     8,  6,  5,  12, 9,  15, 5,  11, 6,  8,  13, 12, 5,  12, 13, 14, 11, 8,  5,  6},
+    {8,  9,  9,  11, 13, 15, 15, 5,  7,  7,  8,  11, 14, 14, 12, 6,  9,  13, 15, 7,
+     12, 8,  9,  11, 7,  7,  12, 7,  6,  15, 13, 11, 9,  7,  15, 11, 8,  6,  6,  14,
+     12, 13, 5,  14, 13, 13, 7,  5,  15, 5,  8,  11, 14, 14, 6,  14, 6,  9,  12, 9,
+     12, 5,  15, 8,  8,  5,  12, 9,  12, 5,  14, 6,  8,  13, 6,  5,  15, 13, 11, 11},
+};
+
+/**
+ * \brief          The constant of every round of the left and the right line of RIPEMD-160
+ */
+static const uint32_t s_ripemd_k[2][5] = {
+    {0x00000000U, 0x5A827999U, 0x6ED9EBA1U, 0x8F1BBCDCU, 0xA953FD4EU},
+    {0x50A28BE6U, 0x5C4DD124U, 0x6D703EF3U, 0x7A6D76E9U, 0x00000000U},
+};
+
+static inline uint32_t
+rotl32(uint32_t value, unsigned int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+static inline uint32_t
+rotr32(uint32_t value, unsigned int bits) {
+    return (value >> bits) | (value << (32 - bits));
+}
+
+static inline uint64_t
+rotr64(uint64_t value, unsigned int bits) {
+    return (value >> bits) | (value << (64 - bits));
+}
+
+static inline uint32_t
+load_be32(const uint8_t* bytes) {
+    return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8)
+           | bytes[3];
+}
+
+static inline uint64_t
+load_be64(const uint8_t* bytes) {
+    return ((uint64_t)load_be32(bytes) << 32) | load_be32(bytes + 4);
+}
+
+static inline uint32_t
+load_le32(const uint8_t* bytes) {
+    return ((uint32_t)bytes[3] << 24) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[1] << 8)
+           | bytes[0];
+}
+
+static inline uint64_t
+load_le64(const uint8_t* bytes) {
+    return ((uint64_t)load_le32(bytes + 4) << 32) | load_le32(bytes);
+}
+
+static inline void
+store_be32(uint8_t* bytes, uint32_t value) {
+    for (int i = 3; i >= 0; i--, value >>= 8) {
+        bytes[i] = (uint8_t)value;
+    }
+}
+
+static inline void
+store_be64(uint8_t* bytes, uint64_t value) {
+    for (int i = 7; i >= 0; i--, value >>= 8) {
+        bytes[i] = (uint8_t)value;
+    }
+}
+
+static inline void
+store_le32(uint8_t* bytes, uint32_t value) {
+    for (int i = 0; i < 4; i++, value >>= 8) {
+        bytes[i] = (uint8_t)value;
+    }
+}
+
+static inline void
+store_le64(uint8_t* bytes, uint64_t value) {
+    for (int i = 0; i < 8; i++, value >>= 8) {
+        bytes[i] = (uint8_t)value;
+    }
+}
+
+/**
+ * \brief          Compress one SHA-1 block from the initial state
+ *
+ * \param[in]      block The padded block, 64 bytes
+ * \param[out]     digest Receives the 20 bytes of the digest
+ */
+static void
+sha1_block(const uint8_t* block, uint8_t* digest) {
+    const uint32_t* iv = s_sha1_iv;
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++) {
+        w[i] = load_be32(block + 4 * i);
+    }
+    for (int i = 16; i < 80; i++) {
+        w[i] = rotl32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+
+    uint32_t a = iv[0], b = iv[1], c = iv[2], d = iv[3], e = iv[4];
+    for (int i = 0; i < 80; i++) {
+        uint32_t f;
+        if (i < 20) {
+            f = (b & c) | (~b & d);
+        } else if (i < 40) {
+            f = b ^ c ^ d;
+        } else if (i < 60) {
+            f = (b & c) | (b & d) | (c & d);
+        } else {
+            f = b ^ c ^ d;
+        }
+        uint32_t t = rotl32(a, 5) + f + e + s_sha1_k[i / 20] + w[i];
+        e = d;
+        d = c;
+        c = rotl32(b, 30);
+        b = a;
+        a = t;
+    }
+
+    store_be32(digest, iv[0] + a);
+    store_be32(digest + 4, iv[1] + b);
+    store_be32(digest + 8, iv[2] + c);
+    store_be32(digest + 12, iv[3] + d);
+    store_be32(digest + 16, iv[4] + e);
+}
+
+/**
+ * \brief          Compress one SHA-256 block from the initial state
+ *
+ * \param[in]      block The padded block, 64 bytes
+ * \param[out]     digest Receives the 32 bytes of the digest
+ */
+static void
+sha256_block(const uint8_t* block, uint8_t* digest) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = load_be32(block + 4 * i);
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = rotr32(w[i - 15], 7) ^ rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr32(w[i - 2], 17) ^ rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = s_sha256_iv[0], b = s_sha256_iv[1], c = s_sha256_iv[2], d = s_sha256_iv[3];
+    uint32_t e = s_sha256_iv[4], f = s_sha256_iv[5], g = s_sha256_iv[6], h = s_sha256_iv[7];
+
+    // Eight rounds at a time rename the state instead of moving it
+#define SHA256_ROUND(a, b, c, d, e, f, g, h, i)                                                    \
+    do {                                                                                           \
+        uint32_t t1 = h + (rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25)) + ((e & f) ^ (~e & g))    \
+                      + s_sha256_k[i] + w[i];                                                      \
+        uint32_t t2 = (rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22))                               \
+                      + ((a & b) ^ (a & c) ^ (b & c));                                             \
+        d += t1;                                                                                   \
+        h = t1 + t2;                                                                               \
+    } while (0)
+
+    for (int i = 0; i < 64; i += 8) {
+        SHA256_ROUND(a, b, c, d, e, f, g, h, i);
+        SHA256_ROUND(h, a, b, c, d, e, f, g, i + 1);
+        SHA256_ROUND(g, h, a, b, c, d, e, f, i + 2);
+        SHA256_ROUND(f, g, h, a, b, c, d, e, i + 3);
+        SHA256_ROUND(e, f, g, h, a, b, c, d, i + 4);
+        SHA256_ROUND(d, e, f, g, h, a, b, c, i + 5);
+        SHA256_ROUND(c, d, e, f, g, h, a, b, i + 6);
+        SHA256_ROUND(b, c, d, e, f, g, h, a, i + 7);
+    }
+#undef SHA256_ROUND
+
+    uint32_t state[8] = {a, b, c, d, e, f, g, h};
+    for (int i = 0; i < 8; i++) {
+        store_be32(digest + 4 * i, s_sha256_iv[i] + state[i]);
+    }
+}
+
+#if defined(BH_BLOCK_USE_SHA_NI)
+
+/**
+ * \brief          Compress one SHA-1 block from the initial state with the SHA extensions.
+ *                 Every instruction makes four rounds, with A in the high lane of the state
+ *                 and E in the high lane of its own register, and the next four message
+ *                 words are scheduled from the four groups before them.
+ *
+ * \param[in]      block The padded block, 64 bytes
+ * \param[out]     digest Receives the 20 bytes of the digest
+ */
+__attribute__((target("sha,sse4.1"))) static void
+sha1_block_sha_ni(const uint8_t* block, uint8_t* digest) {
+    const __m128i reverse = _mm_set_epi64x(0x0001020304050607LL, 0x08090A0B0C0D0E0FLL);
+    __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)s_sha1_iv), 0x1B);
+    __m128i e = _mm_set_epi32((int)s_sha1_iv[4], 0, 0, 0);
+    __m128i abcd_start = abcd, e_start = e;
+
+    __m128i msg[4];
+    for (int i = 0; i < 4; i++) {
+        msg[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(block + 16 * i)), reverse);
+    }
+
+    for (int i = 0; i < 20; i++) {
+        // E of the next four rounds is the rotated A of the last four, plus the words
+        e = i == 0 ? _mm_add_epi32(e, msg[0]) : _mm_sha1nexte_epu32(e, msg[i & 3]);
+        __m128i before = abcd;
+        switch (i / 5) {
+            case 0: abcd = _mm_sha1rnds4_epu32(abcd, e, 0); break;
+            case 1: abcd = _mm_sha1rnds4_epu32(abcd, e, 1); break;
+            case 2: abcd = _mm_sha1rnds4_epu32(abcd, e, 2); break;
+            default: abcd = _mm_sha1rnds4_epu32(abcd, e, 3); break;
+        }
+        e = before;
+
+        if (i < 16) {
+            __m128i next = _mm_sha1msg1_epu32(msg[i & 3], msg[(i + 1) & 3]);
+            next = _mm_xor_si128(next, msg[(i + 2) & 3]);
+            msg[i & 3] = _mm_sha1msg2_epu32(next, msg[(i + 3) & 3]);
+        }
+    }
+
+    e = _mm_sha1nexte_epu32(e, e_start);
+    abcd = _mm_add_epi32(abcd, abcd_start);
+    _mm_storeu_si128((__m128i*)digest, _mm_shuffle_epi8(abcd, reverse));
+    store_be32(digest + 16, (uint32_t)_mm_extract_epi32(e, 3));
+}
+
+/**
+ * \brief          Compress one SHA-256 block from the initial state with the SHA extensions.
+ *                 The instructions keep the state as ABEF and CDGH, every one makes two
+ *                 rounds, and the next four message words are scheduled from the four groups
+ *                 before them.
+ *
+ * \param[in]      block The padded block, 64 bytes
+ * \param[out]     digest Receives the 32 bytes of the digest
+ */
+__attribute__((target("sha,sse4.1"))) static void
+sha256_block_sha_ni(const uint8_t* block, uint8_t* digest) {
+    const __m128i byte_swap = _mm_set_epi64x(0x0C0D0E0F08090A0BLL, 0x0405060700010203LL);
+    __m128i cdab = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)s_sha256_iv), 0xB1);
+    __m128i efgh = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(s_sha256_iv + 4)), 0x1B);
+    __m128i abef = _mm_alignr_epi8(cdab, efgh, 8);
+    __m128i cdgh = _mm_blend_epi16(efgh, cdab, 0xF0);
+    __m128i abef_start = abef, cdgh_start = cdgh;
+
+    __m128i msg[4];
+    for (int i = 0; i < 4; i++) {
+        msg[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(block + 16 * i)), byte_swap);
+    }
+
+    for (int i = 0; i < 16; i++) {
+        __m128i k = _mm_loadu_si128((const __m128i*)(s_sha256_k + 4 * i));
+        __m128i wk = _mm_add_epi32(msg[i & 3], k);
+        cdgh = _mm_sha256rnds2_epu32(cdgh, abef, wk);
+        if (i < 12) {
+            __m128i next = _mm_sha256msg1_epu32(msg[i & 3], msg[(i + 1) & 3]);
+            next = _mm_add_epi32(next, _mm_alignr_epi8(msg[(i + 3) & 3], msg[(i + 2) & 3], 4));
+            msg[i & 3] = _mm_sha256msg2_epu32(next, msg[(i + 3) & 3]);
+        }
+        abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(wk, 0x0E));
+    }
+
+    // Back from ABEF and CDGH to ABCD and EFGH, then to big-endian words
+    abef = _mm_add_epi32(abef, abef_start);
+    cdgh = _mm_add_epi32(cdgh, cdgh_start);
+    __m128i feba = _mm_shuffle_epi32(abef, 0x1B);
+    __m128i dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+    __m128i abcd = _mm_blend_epi16(feba, dchg, 0xF0);
+    efgh = _mm_alignr_epi8(dchg, feba, 8);
+    _mm_storeu_si128((__m128i*)digest, _mm_shuffle_epi8(abcd, byte_swap));
+    _mm_storeu_si128((__m128i*)(digest + 16), _mm_shuffle_epi8(efgh, byte_swap));
+}
+
+#endif
+
+#if defined(BH_BLOCK_USE_ARMV8_SHA)
+
+/**
+ * \brief          Compress one SHA-1 block from the initial state with the ARMv8 Crypto
+ *                 Extensions. Every instruction makes four rounds with the choose, parity or
+ *                 majority function of their part, and the next four message words are
+ *                 scheduled from the four groups before them.
+ *
+ * \param[in]      block The padded block, 64 bytes
+ * \param[out]     digest Receives the 20 bytes of the digest
+ */
+__attribute__((target(BH_BLOCK_ARMV8_TARGET))) static void
+sha1_block_armv8(const uint8_t* block, uint8_t* digest) {
+    uint32x4_t abcd = vld1q_u32(s_sha1_iv);
+    uint32_t e = s_sha1_iv[4];
+
+    uint32x4_t msg[4];
+    for (int i = 0; i < 4; i++) {
+        msg[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(block + 16 * i)));
+    }
+
+    for (int i = 0; i < 20; i++) {
+        uint32x4_t wk = vaddq_u32(msg[i & 3], vdupq_n_u32(s_sha1_k[i / 5]));
+        uint32_t next_e = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+        if (i < 5) {
+            abcd = vsha1cq_u32(abcd, e, wk);
+        } else if (i < 10 || i >= 15) {
+            abcd = vsha1pq_u32(abcd, e, wk);
+        } else {
+            abcd = vsha1mq_u32(abcd, e, wk);
+        }
+        e = next_e;
+
+        if (i < 16) {
+            uint32x4_t next = vsha1su0q_u32(msg[i & 3], msg[(i + 1) & 3], msg[(i + 2) & 3]);
+            msg[i & 3] = vsha1su1q_u32(next, msg[(i + 3) & 3]);
+        }
+    }
+
+    abcd = vaddq_u32(abcd, vld1q_u32(s_sha1_iv));
+    vst1q_u8(digest, vrev32q_u8(vreinterpretq_u8_u32(abcd)));
+    store_be32(digest + 16, e + s_sha1_iv[4]);
+}
+
+/**
+ * \brief          Compress one SHA-256 block from the initial state with the ARMv8 Crypto
+ *                 Extensions. Every pair of instructions makes four rounds on ABCD and EFGH,
+ *                 and the next four message words are scheduled from the four groups before
+ *                 them.
+ *
+ * \param[in]      block The padded block, 64 bytes
+ * \param[out]     digest Receives the 32 bytes of the digest
+ */
+__attribute__((target(BH_BLOCK_ARMV8_TARGET))) static void
+sha256_block_armv8(const uint8_t* block, uint8_t* digest) {
+    uint32x4_t abcd = vld1q_u32(s_sha256_iv);
+    uint32x4_t efgh = vld1q_u32(s_sha256_iv + 4);
+
+    uint32x4_t msg[4];
+    for (int i = 0; i < 4; i++) {
+        msg[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(block + 16 * i)));
+    }
+
+    for (int i = 0; i < 16; i++) {
+        uint32x4_t wk = vaddq_u32(msg[i & 3], vld1q_u32(s_sha256_k + 4 * i));
+        if (i < 12) {
+            uint32x4_t next = vsha256su0q_u32(msg[i & 3], msg[(i + 1) & 3]);
+            msg[i & 3] = vsha256su1q_u32(next, msg[(i + 2) & 3], msg[(i + 3) & 3]);
+        }
+        uint32x4_t before = abcd;
+        abcd = vsha256hq_u32(abcd, efgh, wk);
+        efgh = vsha256h2q_u32(efgh, before, wk);
+    }
+
+    abcd = vaddq_u32(abcd, vld1q_u32(s_sha256_iv));
+    efgh = vaddq_u32(efgh, vld1q_u32(s_sha256_iv + 4));
+    vst1q_u8(digest, vrev32q_u8(vreinterpretq_u8_u32(abcd)));
+    vst1q_u8(digest + 16, vrev32q_u8(vreinterpretq_u8_u32(efgh)));
+}
+
+#endif
+
+/**
+ * \brief          Compress one SHA-512 block from an initial state, which is all SHA-384
+ *                 changes besides its shorter digest
+ *
+ * \param[in]      iv The initial state
+ * \param[in]      block The padded block, 128 bytes
+ * \param[out]     digest Receives the digest
+ * \param[in]      digest_bytes The bytes of the digest, 64 or 48
+ */
+static void
+sha512_block(const uint64_t* iv, const uint8_t* block, uint8_t* digest, size_t digest_bytes) {
+    uint64_t w[80];
+    for (int i = 0; i < 16; i++) {
+        w[i] = load_be64(block + 8 * i);
+    }
+    for (int i = 16; i < 80; i++) {
+        uint64_t s0 = rotr64(w[i - 15], 1) ^ rotr64(w[i - 15], 8) ^ (w[i - 15] >> 7);
+        uint64_t s1 = rotr64(w[i - 2], 19) ^ rotr64(w[i - 2], 61) ^ (w[i - 2] >> 6);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint64_t a = iv[0], b = iv[1], c = iv[2], d = iv[3], e = iv[4], f = iv[5], g = iv[6], h = iv[7];
+
+#define SHA512_ROUND(a, b, c, d, e, f, g, h, i)                                                    \
+    do {                                                                                           \
+        uint64_t t1 = h + (rotr64(e, 14) ^ rotr64(e, 18) ^ rotr64(e, 41)) + ((e & f) ^ (~e & g))   \
+                      + s_sha512_k[i] + w[i];                                                      \
+        uint64_t t2 = (rotr64(a, 28) ^ rotr64(a, 34) ^ rotr64(a, 39))                              \
+                      + ((a & b) ^ (a & c) ^ (b & c));                                             \
+        d += t1;                                                                                   \
+        h = t1 + t2;                                                                               \
+    } while (0)
+
+    for (int i = 0; i < 80; i += 8) {
+        SHA512_ROUND(a, b, c, d, e, f, g, h, i);
+        SHA512_ROUND(h, a, b, c, d, e, f, g, i + 1);
+        SHA512_ROUND(g, h, a, b, c, d, e, f, i + 2);
+        SHA512_ROUND(f, g, h, a, b, c, d, e, i + 3);
+        SHA512_ROUND(e, f, g, h, a, b, c, d, i + 4);
+        SHA512_ROUND(d, e, f, g, h, a, b, c, i + 5);
+        SHA512_ROUND(c, d, e, f, g, h, a, b, i + 6);
+        SHA512_ROUND(b, c, d, e, f, g, h, a, i + 7);
+    }
+#undef SHA512_ROUND
+
+    uint64_t state[8] = {a, b, c, d, e, f, g, h};
+    for (size_t i = 0; i < digest_bytes / 8; i++) {
+        store_be64(digest + 8 * i, iv[i] + state[i]);
+    }
+}
+
+/**
+ * \brief          Get the boolean function of a step of a RIPEMD-160 line
+ *
+ * \param[in]      round The round of the step, 0 to 4
+ * \param[in]      x The first word
+ * \param[in]      y The second word
+ * \param[in]      z The third word
+ * \return         The value of the function
+ */
+static inline uint32_t
+ripemd_f(unsigned int round, uint32_t x, uint32_t y, uint32_t z) {
+    switch (round) {
+        case 0: return x ^ y ^ z;
+        case 1: return (x & y) | (~x & z);
+        case 2: return (x | ~y) ^ z;
+        case 3: return (x & z) | (y & ~z);
+        default: return x ^ (y | ~z);
+    }
+}
+
+/**
+ * \brief          Compress one RIPEMD-160 block from the initial state, the two lines run
+ *                 side by side and are merged into the state at the end
+ *
+ * \param[in]      block The padded block, 64 bytes
+ * \param[out]     digest Receives the 20 bytes of the digest
+ */
+static void
+ripemd160_block(const uint8_t* block, uint8_t* digest) {
+    static const uint32_t iv[5] = {0x67452301U, 0xEFCDAB89U, 0x98BADCFEU, 0x10325476U,
+                                   0xC3D2E1F0U};
+    uint32_t x[16];
+    for (int i = 0; i < 16; i++) {
+        x[i] = load_le32(block + 4 * i);
+    }
+
+    uint32_t line[2][5];
+    memcpy(line[0], iv, sizeof(iv));
+    memcpy(line[1], iv, sizeof(iv));
+    for (unsigned int j = 0; j < 80; j++) {
+        for (unsigned int l = 0; l < 2; l++) {
+            uint32_t* v = line[l];
+            unsigned int round = l == 0 ? j / 16 : 4 - j / 16;
+            uint32_t t = rotl32(v[0] + ripemd_f(round, v[1], v[2], v[3]) + x[s_ripemd_r[l][j]]
+                                    + s_ripemd_k[l][j / 16],
+                                s_ripemd_s[l][j])
+                         + v[4];
+            v[0] = v[4];
+            v[4] = v[3];
+            v[3] = rotl32(v[2], 10);
+            v[2] = v[1];
+            v[1] = t;
+        }
+    }
+
+    store_le32(digest, iv[1] + line[0][2] + line[1][3]);
+    store_le32(digest + 4, iv[2] + line[0][3] + line[1][4]);
+    store_le32(digest + 8, iv[3] + line[0][4] + line[1][0]);
+    store_le32(digest + 12, iv[4] + line[0][0] + line[1][1]);
+    store_le32(digest + 16, iv[0] + line[0][1] + line[1][2]);
+}
+
+/**
+ * \brief          Absorb one SHA3-256 block into the zero state and squeeze the digest, with
+ *                 the Keccak kernel that permutes the blocks one at a time
+ *
+ * \param[in]      block The padded block, 136 bytes
+ * \param[out]     digest Receives the 32 bytes of the digest
+ */
+static void
+sha3_256_block(const uint8_t* block, uint8_t* digest) {
+    hash_keccak_256_blocks(&block, 1, digest);
+}
+
+static void
+sha512_block_512(const uint8_t* block, uint8_t* digest) {
+    sha512_block(s_sha512_iv, block, digest, 64);
+}
+
+static void
+sha512_block_384(const uint8_t* block, uint8_t* digest) {
+    sha512_block(s_sha384_iv, block, digest, 48);
+}
+
+/**
+ * \brief          Get the compression function of a hash function in an implementation
+ *
+ * \param[in]      hash_id The hash function
+ * \param[in]      impl The implementation from hash_block_impl_for
+ * \return         The compression function, NULL for an unsupported hash function
+ */
+static hash_block_compress_fn
+block_compress(enum openssl_hash_function_ids hash_id, hash_block_impl_t impl) {
+    switch (hash_id) {
+        case BH_OPENSSL_HASH_RIPEMD160: return ripemd160_block;
+        case BH_OPENSSL_HASH_SHA1:
+#if defined(BH_BLOCK_USE_SHA_NI)
+            return impl == HASH_BLOCK_IMPL_SHA_NI ? sha1_block_sha_ni : sha1_block;
+#elif defined(BH_BLOCK_USE_ARMV8_SHA)
+            return impl == HASH_BLOCK_IMPL_ARMV8 ? sha1_block_armv8 : sha1_block;
+#else
+            return sha1_block;
+#endif
+        case BH_OPENSSL_HASH_SHA256:
+#if defined(BH_BLOCK_USE_SHA_NI)
+            return impl == HASH_BLOCK_IMPL_SHA_NI ? sha256_block_sha_ni : sha256_block;
+#elif defined(BH_BLOCK_USE_ARMV8_SHA)
+            return impl == HASH_BLOCK_IMPL_ARMV8 ? sha256_block_armv8 : sha256_block;
+#else
+            return sha256_block;
+#endif
+        case BH_OPENSSL_HASH_SHA512: return sha512_block_512;
+        case BH_OPENSSL_HASH_SHA384: return sha512_block_384;
+        case BH_OPENSSL_HASH_SHA3_256: return sha3_256_block;
+        default: return NULL;
+    }
+}
+
+/****************************************************************
+                       EXTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Pick the implementation of the compression of a hash function for the
+ *                 processor, from the features detected at startup. Only SHA-1 and SHA-256
+ *                 have instructions of their own, the SHA3-256 blocks go through the Keccak
+ *                 kernels of hash_keccak_kernel.
+ *
+ * \param[in]      hash_id The hash function
+ * \return         The implementation hash_block_kernel_init selects
+ */
+hash_block_impl_t
+hash_block_impl_for(enum openssl_hash_function_ids hash_id) {
+    if (hash_id != BH_OPENSSL_HASH_SHA1 && hash_id != BH_OPENSSL_HASH_SHA256) {
+        return HASH_BLOCK_IMPL_SCALAR;
+    }
+#if defined(BH_BLOCK_USE_SHA_NI)
+    if (cpu_has(CPU_FEATURE_SHA_NI)) {
+        return HASH_BLOCK_IMPL_SHA_NI;
+    }
+#elif defined(BH_BLOCK_USE_ARMV8_SHA)
+    if (cpu_has(CPU_FEATURE_ARMV8_SHA)) {
+        return HASH_BLOCK_IMPL_ARMV8;
+    }
+#endif
+    return HASH_BLOCK_IMPL_SCALAR;
+}
+
+/**
+ * \brief          Get the name of an implementation of the compression for display
+ *
+ * \param[in]      impl The implementation
+ * \return         A static string
+ */
+const char*
+hash_block_impl_name(hash_block_impl_t impl) {
+    switch (impl) {
+        case HASH_BLOCK_IMPL_SHA_NI: return "SHA-NI";
+        case HASH_BLOCK_IMPL_ARMV8: return "ARMv8";
+        default: return "scalar";
+    }
+}
+
+
+/**
+ * \brief          Set up the single-block kernel of a hash function: the message length is
+ *                 the most one block holds with its padding, and the padding with the length
+ *                 encoding is written after it once
+ *
+ * \param[out]     kernel The kernel to set up
+ * \param[in]      hash_id The hash function
+ * \return         true on success, false for an unsupported hash function
+ */
+bool
+hash_block_kernel_init(hash_block_kernel_t* kernel, enum openssl_hash_function_ids hash_id) {
+    memset(kernel, 0, sizeof(*kernel));
+    kernel->hash_id = hash_id;
+
+    switch (hash_id) {
+        case BH_OPENSSL_HASH_RIPEMD160:
+        case BH_OPENSSL_HASH_SHA1:
+        case BH_OPENSSL_HASH_SHA256: {
+            // A 0x80 byte, then the bit length in 8 bytes, little-endian for RIPEMD-160
+            kernel->block_bytes = 64;
+            kernel->message_bytes = 55;
+            kernel->digest_bytes = hash_id == BH_OPENSSL_HASH_SHA256 ? 32 : 20;
+            kernel->block[55] = 0x80;
+            uint64_t bits = 55 * 8;
+            if (hash_id == BH_OPENSSL_HASH_RIPEMD160) {
+                store_le64(kernel->block + 56, bits);
+            } else {
+                store_be64(kernel->block + 56, bits);
+            }
+        } break;
+        case BH_OPENSSL_HASH_SHA512:
+        case BH_OPENSSL_HASH_SHA384:
+            // A 0x80 byte, then the bit length in 16 bytes
+            kernel->block_bytes = 128;
+            kernel->message_bytes = 111;
+            kernel->digest_bytes = hash_id == BH_OPENSSL_HASH_SHA512 ? 64 : 48;
+            kernel->block[111] = 0x80;
+            store_be64(kernel->block + 120, 111 * 8);
+            break;
+        case BH_OPENSSL_HASH_SHA3_256:
+            // The domain bits and the first padding bit share the last byte with the final bit
+            kernel->block_bytes = 136;
+            kernel->message_bytes = 135;
+            kernel->digest_bytes = 32;
+            kernel->block[135] = 0x06 | 0x80;
+            break;
+        default: return false;
+    }
+
+    kernel->impl = hash_block_impl_for(hash_id);
+    kernel->compress = block_compress(hash_id, kernel->impl);
+    return true;
+}
+
+/**
+ * \brief          Hash one message with a single-block kernel. Only the message is written
+ *                 into a copy of the padded block, then the block is compressed once by the
+ *                 implementation selected at init.
+ *
+ * \param[in]      kernel The kernel of the hash function
+ * \param[in]      message The message, kernel->message_bytes long
+ * \param[out]     digest Receives the digest, kernel->digest_bytes long
+ */
+void
+hash_block_kernel_hash(const hash_block_kernel_t* kernel, const uint8_t* message,
+                       uint8_t* digest) {
+    uint8_t block[BH_HASH_BLOCK_MAX_BYTES];
+    memcpy(block, message, kernel->message_bytes);
+    memcpy(block + kernel->message_bytes, kernel->block + kernel->message_bytes,
+           kernel->block_bytes - kernel->message_bytes);
+
+    kernel->compress(block, digest);
+}
+
+/**
+ * \brief          Hash a batch of messages with a single-block kernel. The SHA3-256 blocks are
+ *                 permuted several at a time by the Keccak kernel of the processor, the other
+ *                 hash functions compress one block after the other.
+ *
+ * \param[in]      kernel The kernel of the hash function
+ * \param[in]      messages The messages, kernel->message_bytes long each
+ * \param[in]      count The number of messages
+ * \param[out]     digests Receives the digest of every message in a row, kernel->digest_bytes
+ *                 each
+ */
+void
+hash_block_kernel_hash_batch(const hash_block_kernel_t* kernel, const uint8_t* const* messages,
+                             size_t count, uint8_t* digests) {
+    if (kernel->hash_id != BH_OPENSSL_HASH_SHA3_256) {
+        for (size_t i = 0; i < count; i++) {
+            hash_block_kernel_hash(kernel, messages[i], digests + i * kernel->digest_bytes);
+        }
+        return;
+    }
+
+    uint8_t blocks[BH_KECCAK_MAX_LANES][BH_HASH_BLOCK_MAX_BYTES];
+    const uint8_t* block_ptrs[BH_KECCAK_MAX_LANES];
+    for (size_t done = 0; done < count; done += BH_KECCAK_MAX_LANES) {
+        size_t lanes = count - done < BH_KECCAK_MAX_LANES ? count - done : BH_KECCAK_MAX_LANES;
+        for (size_t m = 0; m < lanes; m++) {
+            memcpy(blocks[m], messages[done + m], kernel->message_bytes);
+            memcpy(blocks[m] + kernel->message_bytes, kernel->block + kernel->message_bytes,
+                   kernel->block_bytes - kernel->message_bytes);
+            block_ptrs[m] = blocks[m];
+        }
+        hash_keccak_256_blocks(block_ptrs, lanes, digests + done * kernel->digest_bytes);
+    }
+}
@@ -0,0 +1,73 @@
+/**
+ * \file            hash_block.h
+ * \brief           Header file for hash_block.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_BLOCK_H
+#define HASH_BLOCK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cpu_features.h"
+#include "hash_function.h"
+#include "hash_keccak.h"
+
+/**
+ * \brief          The bytes of the largest block, the 136 bytes SHA3-256 absorbs at once
+ */
+#define BH_HASH_BLOCK_MAX_BYTES 136
+
+/**
+ * \brief          The bytes of the largest digest of a single-block kernel, SHA-512
+ */
+#define BH_HASH_BLOCK_MAX_DIGEST 64
+
+/**
+ * \brief          The implementations of the compression of a single-block kernel
+ */
+typedef enum {
+    HASH_BLOCK_IMPL_SCALAR = 0, ///< The portable compression, on any processor
+    HASH_BLOCK_IMPL_SHA_NI,     ///< The x86 SHA extensions, for SHA-1 and SHA-256
+    HASH_BLOCK_IMPL_ARMV8       ///< The ARMv8 Crypto Extensions, for SHA-1 and SHA-256
+} hash_block_impl_t;
+
+/**
+ * \brief          Compress one padded block from the initial state into the digest
+ */
+typedef void (*hash_block_compress_fn)(const uint8_t* block, uint8_t* digest);
+
+/**
+ * \brief          A single-block kernel of a hash function. Every message has the same
+ *                 length, the most one block holds with its padding, so the padding and the
+ *                 length encoding are the same for every message and are written once. A
+ *                 digest is one compression of the block from the initial state, without the
+ *                 buffering and the length counting of the streaming interface.
+ */
+typedef struct {
+    enum openssl_hash_function_ids hash_id; ///< The hash function
+    size_t block_bytes;                     ///< The bytes of one block
+    size_t message_bytes;                   ///< The fixed length of every message
+    size_t digest_bytes;                    ///< The bytes of the digest
+    uint8_t block[BH_HASH_BLOCK_MAX_BYTES]; ///< Room for the message, then its padding
+    hash_block_impl_t impl;                 ///< The implementation picked for the processor
+    hash_block_compress_fn compress;        ///< The compression of that implementation
+} hash_block_kernel_t;
+
+hash_block_impl_t hash_block_impl_for(enum openssl_hash_function_ids hash_id);
+const char* hash_block_impl_name(hash_block_impl_t impl);
+bool hash_block_kernel_init(hash_block_kernel_t* kernel, enum openssl_hash_function_ids hash_id);
+void hash_block_kernel_hash(const hash_block_kernel_t* kernel, const uint8_t* message,
+                            uint8_t* digest);
+void hash_block_kernel_hash_batch(const hash_block_kernel_t* kernel, const uint8_t* const* messages,
+                                  size_t count, uint8_t* digests);
+
+#endif
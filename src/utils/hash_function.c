@@ -25,8 +25,23 @@
  */
 uint8_t
 hash_8bit(const void* data, size_t len) {
+    return hash_8bit_update(BH_HASH_8BIT_IV, data, len);
+}
+
+/**
+ * \brief          Continue the 8-bit hash from the state it reached on the bytes before.
+ *                 The hash is iterated byte by byte without any finalization, so the state
+ *                 after a prefix is the digest of that prefix.
+ *
+ * \param[in]      state The state after the previous bytes, BH_HASH_8BIT_IV for none
+ * \param[in]      data Pointer to the next bytes
+ * \param[in]      len Length of the next bytes
+ * \return         The state after the bytes
+ */
+uint8_t
+hash_8bit_update(uint8_t state, const void* data, size_t len) {
     const uint8_t* bytes = (const uint8_t*)data;
-    uint8_t hash = 0x5A;           // Initial seed value
+    uint8_t hash = state;
     const uint8_t multiplier = 31; // Small prime multiplier
 
     for (size_t i = 0; i < len; i++) {
@@ -50,8 +65,21 @@ hash_8bit(const void* data, size_t len) {
  */
 uint16_t
 hash_12bit(const void* data, size_t len) {
+    return hash_12bit_update(BH_HASH_12BIT_IV, data, len);
+}
+
+/**
+ * \brief          Continue the 12-bit hash from the state it reached on the bytes before
+ *
+ * \param[in]      state The state after the previous bytes, BH_HASH_12BIT_IV for none
+ * \param[in]      data Pointer to the next bytes
+ * \param[in]      len Length of the next bytes
+ * \return         The state after the bytes, in the lower 12 bits
+ */
+uint16_t
+hash_12bit_update(uint16_t state, const void* data, size_t len) {
     const uint8_t* bytes = (const uint8_t*)data;
-    uint16_t hash = 0x9C4;       // 12-bit FNV offset basis approximation
+    uint16_t hash = state;
     const uint16_t prime = 0x93; // Small prime for 12-bit space
 
     for (size_t i = 0; i < len; i++) {
@@ -76,8 +104,21 @@ hash_12bit(const void* data, size_t len) {
  */
 uint16_t
 hash_16bit(const void* data, size_t len) {
+    return hash_16bit_update(BH_HASH_16BIT_IV, data, len);
+}
+
+/**
+ * \brief          Continue the 16-bit hash from the state it reached on the bytes before
+ *
+ * \param[in]      state The state after the previous bytes, BH_HASH_16BIT_IV for none
+ * \param[in]      data Pointer to the next bytes
+ * \param[in]      len Length of the next bytes
+ * \return         The state after the bytes
+ */
+uint16_t
+hash_16bit_update(uint16_t state, const void* data, size_t len) {
     const uint8_t* bytes = (const uint8_t*)data;
-    uint16_t hash = 0xFFFF;             // Initialize with all bits set
+    uint16_t hash = state;
     const uint16_t polynomial = 0x8408; // Reversed CRC-16 polynomial
 
     for (size_t i = 0; i < len; i++) {
@@ -95,6 +136,43 @@ hash_16bit(const void* data, size_t len) {
     return hash;
 }
 
+/**
+ * \brief          SipHash-2-4 with the fixed key BH_SIPHASH_KEY_0 and BH_SIPHASH_KEY_1: two
+ *                 compression rounds per 8-byte word and four finalization rounds. It is
+ *                 the keyed hash of many hash tables, here under a public key so its
+ *                 collisions can be searched like those of any unkeyed hash.
+ *
+ * \param[in]      data Pointer to input data buffer
+ * \param[in]      len Length of input data in bytes
+ * \return         The 64-bit hash
+ */
+uint64_t
+hash_siphash24(const void* data, size_t len) {
+    static const uint64_t key[2] = {BH_SIPHASH_KEY_0, BH_SIPHASH_KEY_1};
+    return hash_siphash(key, 2, 4, data, len);
+}
+
+/**
+ * \brief          Get the OpenSSL digest of a hash function ID
+ *
+ * \param[in]      hash_id The ID of the hash function
+ * \return         The digest, or NULL for an unsupported ID
+ */
+const EVP_MD*
+openssl_hash_md(enum openssl_hash_function_ids hash_id) {
+    switch (hash_id) {
+        case BH_OPENSSL_HASH_RIPEMD160: return EVP_ripemd160();
+        case BH_OPENSSL_HASH_SHA1: return EVP_sha1();
+        case BH_OPENSSL_HASH_SHA3_256: return EVP_sha3_256();
+        case BH_OPENSSL_HASH_SHA256: return EVP_sha256();
+        case BH_OPENSSL_HASH_SHA512: return EVP_sha512();
+        case BH_OPENSSL_HASH_SHA384: return EVP_sha384();
+        case BH_OPENSSL_HASH_BLAKE2B512: return EVP_blake2b512();
+        case BH_OPENSSL_HASH_BLAKE2S256: return EVP_blake2s256();
+        default: return NULL; // Unsupported hash function ID
+    }
+}
+
 /**
  * \brief          Generic wrapper for OpenSSL hash functions
  *                 REMEMBER TO `free()` the returned pointer after use.
@@ -108,20 +186,9 @@ hash_16bit(const void* data, size_t len) {
 unsigned char*
 openssl_hash(const void* data, size_t len, enum openssl_hash_function_ids hash_id) {
     // 0. Set the correct hash function based on the ID
-    const EVP_MD* (*hash_fn)(void) = NULL;
-
-    switch (hash_id) {
-        case BH_OPENSSL_HASH_RIPEMD160: hash_fn = EVP_ripemd160; break;
-        case BH_OPENSSL_HASH_SHA1: hash_fn = EVP_sha1; break;
-        case BH_OPENSSL_HASH_SHA3_256: hash_fn = EVP_sha3_256; break;
-        case BH_OPENSSL_HASH_SHA256: hash_fn = EVP_sha256; break;
-        case BH_OPENSSL_HASH_SHA512: hash_fn = EVP_sha512; break;
-        case BH_OPENSSL_HASH_SHA384: hash_fn = EVP_sha384; break;
-        default: return NULL; // Unsupported hash function ID
-    }
+    const EVP_MD* md = openssl_hash_md(hash_id);
 
     // 1. Buffer to store the hash
-    const EVP_MD* md = hash_fn();
     if (!md) {
         return NULL;
     }
@@ -161,4 +228,198 @@ openssl_hash(const void* data, size_t len, enum openssl_hash_function_ids hash_i
     EVP_MD_CTX_free(ctx);
 
     return hash;
-}
\ No newline at end of file
+}
+/**
+ * \brief          Hash one input with an OpenSSL digest, in one call without a context to
+ *                 allocate
+ *
+ * \param[in]      md The digest
+ * \param[in]      data Pointer to input data buffer
+ * \param[in]      len Length of input data in bytes
+ * \param[out]     digest Receives the digest
+ * \return         true on success, false when OpenSSL failed
+ */
+static bool
+openssl_hash_into(const EVP_MD* md, const void* data, size_t len, uint8_t* digest) {
+    return EVP_Digest(data, len, digest, NULL, md, NULL) == 1;
+}
+
+/**
+ * \brief          Check an OpenSSL digest hashes, by hashing no bytes with it. The digests of
+ *                 the legacy provider, RIPEMD-160 on some OpenSSL 3 builds, fail here.
+ *
+ * \param[in]      md The digest, NULL when OpenSSL was built without it
+ * \return         true when the digest hashes, false otherwise
+ */
+static bool
+openssl_hash_available(const EVP_MD* md) {
+    uint8_t digest[EVP_MAX_MD_SIZE];
+    return md != NULL && openssl_hash_into(md, "", 0, digest);
+}
+
+/**
+ * \brief          Hash a batch of inputs with an OpenSSL digest. The context is allocated
+ *                 once for the batch and only initialized again for every input.
+ *
+ * \param[in]      md The digest
+ * \param[in]      inputs The inputs
+ * \param[in]      input_lens The length of every input in bytes
+ * \param[in]      count The number of inputs
+ * \param[out]     digests Receives count digests, one after the other
+ * \return         true on success, false when OpenSSL failed
+ */
+static bool
+openssl_hash_batch(const EVP_MD* md, const uint8_t* const* inputs, const size_t* input_lens,
+                   size_t count, uint8_t* digests) {
+    EVP_MD_CTX* ctx = EVP_MD_CTX_new();
+    if (!ctx) {
+        return false;
+    }
+
+    size_t digest_bytes = (size_t)EVP_MD_size(md);
+    bool ok = true;
+    for (size_t i = 0; i < count && ok; i++) {
+        ok = EVP_DigestInit_ex(ctx, md, NULL) == 1
+             && EVP_DigestUpdate(ctx, inputs[i], input_lens[i]) == 1
+             && EVP_DigestFinal_ex(ctx, digests + i * digest_bytes, NULL) == 1;
+    }
+    EVP_MD_CTX_free(ctx);
+    return ok;
+}
+
+/**
+ * \brief          Define the digest and the batch functions of a toy hash. The batch loop
+ *                 calls the digest function directly, so it is inlined into the loop.
+ */
+#define BH_DEFINE_TOY_HASH(name, bytes)                                                            \
+    bool name##_digest(const void* data, size_t len, uint8_t* digest) {                            \
+        uint16_t value = name(data, len);                                                          \
+        if ((bytes) == 2) {                                                                        \
+            *digest++ = (uint8_t)(value >> 8);                                                     \
+        }                                                                                          \
+        *digest = (uint8_t)value;                                                                  \
+        return true;                                                                               \
+    }                                                                                              \
+    bool name##_batch(const uint8_t* const* inputs, const size_t* input_lens, size_t count,        \
+                      uint8_t* digests) {                                                          \
+        for (size_t i = 0; i < count; i++) {                                                       \
+            name##_digest(inputs[i], input_lens[i], digests + i * (bytes));                        \
+        }                                                                                          \
+        return true;                                                                               \
+    }
+
+/**
+ * \brief          Define the digest, the batch and the init functions of an OpenSSL hash,
+ *                 with its digest fixed in all of them
+ */
+#define BH_DEFINE_OPENSSL_HASH(name, md)                                                           \
+    bool name##_digest(const void* data, size_t len, uint8_t* digest) {                            \
+        return openssl_hash_into(md(), data, len, digest);                                         \
+    }                                                                                              \
+    bool name##_batch(const uint8_t* const* inputs, const size_t* input_lens, size_t count,        \
+                      uint8_t* digests) {                                                          \
+        return openssl_hash_batch(md(), inputs, input_lens, count, digests);                       \
+    }                                                                                              \
+    bool name##_init(void) {                                                                       \
+        return openssl_hash_available(md());                                                       \
+    }
+
+/**
+ * \brief          Define the digest and the batch functions of a hash implemented here, from
+ *                 the function that writes its digest. The batch loop calls it directly, so
+ *                 it is inlined into the loop.
+ */
+#define BH_DEFINE_NATIVE_HASH(name, bytes, write)                                                  \
+    bool name##_digest(const void* data, size_t len, uint8_t* digest) {                            \
+        write(data, len, digest);                                                                  \
+        return true;                                                                               \
+    }                                                                                              \
+    bool name##_batch(const uint8_t* const* inputs, const size_t* input_lens, size_t count,        \
+                      uint8_t* digests) {                                                          \
+        for (size_t i = 0; i < count; i++) {                                                       \
+            write(inputs[i], input_lens[i], digests + i * (bytes));                                \
+        }                                                                                          \
+        return true;                                                                               \
+    }
+
+/**
+ * \brief          Define the digest and the batch functions of a 256-bit Keccak sponge by its
+ *                 domain byte. The batch hands the whole batch to the sponge, which permutes
+ *                 the single-block inputs several at a time.
+ */
+#define BH_DEFINE_KECCAK_HASH(name, domain)                                                        \
+    bool name##_digest(const void* data, size_t len, uint8_t* digest) {                            \
+        hash_keccak_256_sponge(data, len, (domain), digest);                                       \
+        return true;                                                                               \
+    }                                                                                              \
+    bool name##_batch(const uint8_t* const* inputs, const size_t* input_lens, size_t count,        \
+                      uint8_t* digests) {                                                          \
+        hash_keccak_256_sponge_batch(inputs, input_lens, count, (domain), digests);                \
+        return true;                                                                               \
+    }
+
+/**
+ * \brief          Define the digest and the batch functions of BLAKE3. The batch hands the
+ *                 whole batch to hash_blake3_many, which hashes the single-chunk inputs several
+ *                 at a time.
+ */
+#define BH_DEFINE_BLAKE3_HASH(name)                                                                \
+    bool name##_digest(const void* data, size_t len, uint8_t* digest) {                            \
+        hash_blake3(data, len, digest);                                                            \
+        return true;                                                                               \
+    }                                                                                              \
+    bool name##_batch(const uint8_t* const* inputs, const size_t* input_lens, size_t count,        \
+                      uint8_t* digests) {                                                          \
+        hash_blake3_many(inputs, input_lens, count, digests);                                      \
+        return true;                                                                               \
+    }
+
+static inline void
+store_be64(uint8_t* bytes, uint64_t value) {
+    for (int i = 7; i >= 0; i--, value >>= 8) {
+        bytes[i] = (uint8_t)value;
+    }
+}
+
+/**
+ * \brief          Write the 64-bit xxHash3 of an input in its canonical big-endian form
+ */
+static inline void
+xxh3_64_write(const void* data, size_t len, uint8_t* digest) {
+    store_be64(digest, hash_xxh3_64(data, len));
+}
+
+/**
+ * \brief          Write the 128-bit xxHash3 of an input in its canonical form, high64 first
+ */
+static inline void
+xxh3_128_write(const void* data, size_t len, uint8_t* digest) {
+    hash_xxh3_128_t hash = hash_xxh3_128(data, len);
+    store_be64(digest, hash.high64);
+    store_be64(digest + 8, hash.low64);
+}
+
+/**
+ * \brief          Write the SipHash-2-4 of an input big-endian, as the 64-bit value reads
+ */
+static inline void
+siphash24_write(const void* data, size_t len, uint8_t* digest) {
+    store_be64(digest, hash_siphash24(data, len));
+}
+
+BH_DEFINE_TOY_HASH(hash_8bit, 1)
+BH_DEFINE_TOY_HASH(hash_12bit, 2)
+BH_DEFINE_TOY_HASH(hash_16bit, 2)
+BH_DEFINE_OPENSSL_HASH(hash_ripemd160, EVP_ripemd160)
+BH_DEFINE_OPENSSL_HASH(hash_sha1, EVP_sha1)
+BH_DEFINE_KECCAK_HASH(hash_sha3_256, BH_KECCAK_DOMAIN_SHA3)
+BH_DEFINE_OPENSSL_HASH(hash_sha256, EVP_sha256)
+BH_DEFINE_OPENSSL_HASH(hash_sha512, EVP_sha512)
+BH_DEFINE_OPENSSL_HASH(hash_sha384, EVP_sha384)
+BH_DEFINE_KECCAK_HASH(hash_keccak_256, BH_KECCAK_DOMAIN_KECCAK)
+BH_DEFINE_OPENSSL_HASH(hash_blake2b512, EVP_blake2b512)
+BH_DEFINE_OPENSSL_HASH(hash_blake2s256, EVP_blake2s256)
+BH_DEFINE_BLAKE3_HASH(hash_blake3)
+BH_DEFINE_NATIVE_HASH(hash_xxh3_64, 8, xxh3_64_write)
+BH_DEFINE_NATIVE_HASH(hash_xxh3_128, 16, xxh3_128_write)
+BH_DEFINE_NATIVE_HASH(hash_siphash24, 8, siphash24_write)
@@ -13,8 +13,15 @@
 #define HASH_FUNCTION_H
 
 #include <openssl/evp.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
+#include "hash_blake3.h"
+#include "hash_keccak.h"
+#include "hash_siphash.h"
+#include "hash_xxh3.h"
+
 enum openssl_hash_function_ids {
     BH_OPENSSL_HASH_RIPEMD160,
     BH_OPENSSL_HASH_SHA1,
@@ -22,14 +29,103 @@ enum openssl_hash_function_ids {
     BH_OPENSSL_HASH_SHA256,
     BH_OPENSSL_HASH_SHA512,
     BH_OPENSSL_HASH_SHA384,
+    BH_OPENSSL_HASH_BLAKE2B512,
+    BH_OPENSSL_HASH_BLAKE2S256,
 };
 
+/**
+ * \brief          The initial states of the toy hash functions, the digest of no bytes
+ */
+#define BH_HASH_8BIT_IV  0x5A   ///< Initial seed value
+#define BH_HASH_12BIT_IV 0x9C4  ///< 12-bit FNV offset basis approximation
+#define BH_HASH_16BIT_IV 0xFFFF ///< Initialize with all bits set
+
+/**
+ * \brief          The key of the SipHash-2-4 of the menu, the key of the reference test
+ *                 vectors, 00 01 .. 0F. An attack needs every run to hash alike, so the key
+ *                 is fixed and public.
+ */
+#define BH_SIPHASH_KEY_0 0x0706050403020100ULL
+#define BH_SIPHASH_KEY_1 0x0F0E0D0C0B0A0908ULL
+
+/**
+ * \brief          The bytes of the longest binary digest, SHA-512
+ */
+#define BH_HASH_MAX_DIGEST_BYTES 64
+
+/**
+ * \brief          Hash one input into its binary digest
+ *
+ * \param[in]      data Pointer to input data buffer
+ * \param[in]      len Length of input data in bytes
+ * \param[out]     digest Receives the digest, big-endian for the toy hashes
+ * \return         true on success, false when the hash failed
+ */
+typedef bool (*hash_digest_fn)(const void* data, size_t len, uint8_t* digest);
+
+/**
+ * \brief          Hash a batch of inputs into their binary digests, one after the other
+ *
+ * \param[in]      inputs The inputs
+ * \param[in]      input_lens The length of every input in bytes
+ * \param[in]      count The number of inputs
+ * \param[out]     digests Receives count digests
+ * \return         true on success, false when the hash failed
+ */
+typedef bool (*hash_batch_fn)(const uint8_t* const* inputs, const size_t* input_lens, size_t count,
+                              uint8_t* digests);
+
+/**
+ * \brief          Check a hash function can hash before the workers of a run start with it
+ *
+ * \return         true when it can, false when its implementation is not available
+ */
+typedef bool (*hash_init_fn)(void);
+
+/**
+ * \brief          Declare the digest and the batch functions of a hash function
+ */
+#define BH_DECLARE_HASH_FUNCTIONS(name)                                                            \
+    bool name##_digest(const void* data, size_t len, uint8_t* digest);                             \
+    bool name##_batch(const uint8_t* const* inputs, const size_t* input_lens, size_t count,        \
+                      uint8_t* digests)
+
+/**
+ * \brief          Declare the digest, the batch and the init functions of an OpenSSL hash
+ */
+#define BH_DECLARE_OPENSSL_HASH_FUNCTIONS(name)                                                    \
+    BH_DECLARE_HASH_FUNCTIONS(name);                                                               \
+    bool name##_init(void)
+
 uint8_t hash_8bit(const void* data, size_t len);
+uint8_t hash_8bit_update(uint8_t state, const void* data, size_t len);
 
 uint16_t hash_12bit(const void* data, size_t len);
+uint16_t hash_12bit_update(uint16_t state, const void* data, size_t len);
 
 uint16_t hash_16bit(const void* data, size_t len);
+uint16_t hash_16bit_update(uint16_t state, const void* data, size_t len);
+
+uint64_t hash_siphash24(const void* data, size_t len);
 
+const EVP_MD* openssl_hash_md(enum openssl_hash_function_ids hash_id);
 unsigned char* openssl_hash(const void* data, size_t len, enum openssl_hash_function_ids hash_id);
 
+BH_DECLARE_HASH_FUNCTIONS(hash_8bit);
+BH_DECLARE_HASH_FUNCTIONS(hash_12bit);
+BH_DECLARE_HASH_FUNCTIONS(hash_16bit);
+BH_DECLARE_OPENSSL_HASH_FUNCTIONS(hash_ripemd160);
+BH_DECLARE_OPENSSL_HASH_FUNCTIONS(hash_sha1);
+BH_DECLARE_HASH_FUNCTIONS(hash_sha3_256);
+BH_DECLARE_OPENSSL_HASH_FUNCTIONS(hash_sha256);
+BH_DECLARE_OPENSSL_HASH_FUNCTIONS(hash_sha512);
+BH_DECLARE_OPENSSL_HASH_FUNCTIONS(hash_sha384);
+BH_DECLARE_HASH_FUNCTIONS(hash_keccak_256);
+BH_DECLARE_OPENSSL_HASH_FUNCTIONS(hash_blake2b512);
+BH_DECLARE_OPENSSL_HASH_FUNCTIONS(hash_blake2s256);
+BH_DECLARE_HASH_FUNCTIONS(hash_blake3);
+BH_DECLARE_HASH_FUNCTIONS(hash_xxh3_64);
+BH_DECLARE_HASH_FUNCTIONS(hash_xxh3_128);
+BH_DECLARE_HASH_FUNCTIONS(hash_siphash24);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,390 @@
+/**
+ * \file            hash_keccak.c
+ * \brief           The Keccak-f[1600] permutation that SHA3-256 and Keccak-256 share, and
+ *                  the sponge around it. Keccak-256 is the hash of the Keccak submission
+ *                  before it became SHA-3, it only differs in the padding: its first padding
+ *                  bit comes without the two SHA-3 domain bits. The messages that fit one
+ *                  block are permuted several at a time, one message per lane of a vector
+ *                  register, on the processors with AVX2 or AVX-512.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_keccak.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define BH_KECCAK_USE_X86
+#endif
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+static const uint64_t s_keccak_rc[24] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808AULL,
+    0x8000000080008000ULL, 0x000000000000808BULL, 0x0000000080000001ULL,
+    0x8000000080008081ULL, 0x8000000000008009ULL, 0x000000000000008AULL,
+    0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000AULL,
+    0x000000008000808BULL, 0x800000000000008BULL, 0x8000000000008089ULL,
+    0x8000000000008003ULL, 0x8000000000008002ULL, 0x8000000000000080ULL,
+    0x000000000000800AULL, 0x800000008000000AULL, 0x8000000080008081ULL,
+    0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL,
+};
+
+static inline uint64_t
+load_le64(const uint8_t* bytes) {
+    uint64_t word = 0;
+    for (int i = 7; i >= 0; i--) {
+        word = (word << 8) | bytes[i];
+    }
+    return word;
+}
+
+static inline void
+store_le64(uint8_t* bytes, uint64_t value) {
+    for (int i = 0; i < 8; i++, value >>= 8) {
+        bytes[i] = (uint8_t)value;
+    }
+}
+
+/**
+ * \brief          Rotate a lane left, a 64-bit word or a vector of them alike
+ */
+#define KECCAK_ROTL(lane, bits) (((lane) << (bits)) | ((lane) >> (64 - (bits))))
+
+/**
+ * \brief          The 24 rounds of Keccak-f[1600] on 25 lanes of type lane_t. The lanes are
+ *                 64-bit words for one state, or vectors of them with one state per element:
+ *                 every step is made of XOR, AND, NOT and rotations, which apply to every
+ *                 element of a vector alike, so the same rounds permute several states.
+ */
+#define KECCAK_F1600_ROUNDS(lane_t, a)                                                             \
+    do {                                                                                           \
+        for (int round = 0; round < 24; round++) {                                                 \
+            /* Theta, the columns are written out so no index is computed modulo 5 */              \
+            lane_t c0 = a[0] ^ a[5] ^ a[10] ^ a[15] ^ a[20];                                       \
+            lane_t c1 = a[1] ^ a[6] ^ a[11] ^ a[16] ^ a[21];                                       \
+            lane_t c2 = a[2] ^ a[7] ^ a[12] ^ a[17] ^ a[22];                                       \
+            lane_t c3 = a[3] ^ a[8] ^ a[13] ^ a[18] ^ a[23];                                       \
+            lane_t c4 = a[4] ^ a[9] ^ a[14] ^ a[19] ^ a[24];                                       \
+            lane_t d0 = c4 ^ KECCAK_ROTL(c1, 1), d1 = c0 ^ KECCAK_ROTL(c2, 1);                     \
+            lane_t d2 = c1 ^ KECCAK_ROTL(c3, 1), d3 = c2 ^ KECCAK_ROTL(c4, 1);                     \
+            lane_t d4 = c3 ^ KECCAK_ROTL(c0, 1);                                                   \
+            for (int y = 0; y < 25; y += 5) {                                                      \
+                a[y] ^= d0;                                                                        \
+                a[y + 1] ^= d1;                                                                    \
+                a[y + 2] ^= d2;                                                                    \
+                a[y + 3] ^= d3;                                                                    \
+                a[y + 4] ^= d4;                                                                    \
+            }                                                                                      \
+                                                                                                   \
+            /* Rho and pi: every lane is rotated into its place in b */                            \
+            lane_t b[25];                                                                          \
+            b[0] = a[0];                                                                           \
+            b[1] = KECCAK_ROTL(a[6], 44);                                                          \
+            b[2] = KECCAK_ROTL(a[12], 43);                                                         \
+            b[3] = KECCAK_ROTL(a[18], 21);                                                         \
+            b[4] = KECCAK_ROTL(a[24], 14);                                                         \
+            b[5] = KECCAK_ROTL(a[3], 28);                                                          \
+            b[6] = KECCAK_ROTL(a[9], 20);                                                          \
+            b[7] = KECCAK_ROTL(a[10], 3);                                                          \
+            b[8] = KECCAK_ROTL(a[16], 45);                                                         \
+            b[9] = KECCAK_ROTL(a[22], 61);                                                         \
+            b[10] = KECCAK_ROTL(a[1], 1);                                                          \
+            b[11] = KECCAK_ROTL(a[7], 6);                                                          \
+            b[12] = KECCAK_ROTL(a[13], 25);                                                        \
+            b[13] = KECCAK_ROTL(a[19], 8);                                                         \
+            b[14] = KECCAK_ROTL(a[20], 18);                                                        \
+            b[15] = KECCAK_ROTL(a[4], 27);                                                         \
+            b[16] = KECCAK_ROTL(a[5], 36);                                                         \
+            b[17] = KECCAK_ROTL(a[11], 10);                                                        \
+            b[18] = KECCAK_ROTL(a[17], 15);                                                        \
+            b[19] = KECCAK_ROTL(a[23], 56);                                                        \
+            b[20] = KECCAK_ROTL(a[2], 62);                                                         \
+            b[21] = KECCAK_ROTL(a[8], 55);                                                         \
+            b[22] = KECCAK_ROTL(a[14], 39);                                                        \
+            b[23] = KECCAK_ROTL(a[15], 41);                                                        \
+            b[24] = KECCAK_ROTL(a[21], 2);                                                         \
+                                                                                                   \
+            /* Chi, row by row */                                                                  \
+            for (int y = 0; y < 25; y += 5) {                                                      \
+                a[y] = b[y] ^ (~b[y + 1] & b[y + 2]);                                              \
+                a[y + 1] = b[y + 1] ^ (~b[y + 2] & b[y + 3]);                                      \
+                a[y + 2] = b[y + 2] ^ (~b[y + 3] & b[y + 4]);                                      \
+                a[y + 3] = b[y + 3] ^ (~b[y + 4] & b[y]);                                          \
+                a[y + 4] = b[y + 4] ^ (~b[y] & b[y + 1]);                                          \
+            }                                                                                      \
+                                                                                                   \
+            a[0] ^= s_keccak_rc[round];                                                            \
+        }                                                                                          \
+    } while (0)
+
+/**
+ * \brief          Absorb one block of the rate into the state
+ *
+ * \param[in,out]  state The 25 lanes of the state
+ * \param[in]      block The BH_KECCAK_256_RATE bytes of the block
+ */
+static void
+keccak_absorb(uint64_t* state, const uint8_t* block) {
+    for (int i = 0; i < BH_KECCAK_256_RATE / 8; i++) {
+        state[i] ^= load_le64(block + 8 * i);
+    }
+    hash_keccak_f1600(state);
+}
+
+/**
+ * \brief          Permute padded blocks one at a time, the kernel of the processors without
+ *                 the vector extensions and of the messages left over from the lanes
+ *
+ * \param[in]      blocks The padded blocks
+ * \param[in]      count The number of blocks
+ * \param[out]     digests Receives the BH_KECCAK_256_DIGEST_BYTES of every digest in a row
+ */
+static void
+keccak_256_blocks_scalar(const uint8_t* const* blocks, size_t count, uint8_t* digests) {
+    for (size_t m = 0; m < count; m++) {
+        uint64_t a[25] = {0};
+        for (int i = 0; i < BH_KECCAK_256_RATE / 8; i++) {
+            a[i] = load_le64(blocks[m] + 8 * i);
+        }
+        hash_keccak_f1600(a);
+        for (int i = 0; i < BH_KECCAK_256_DIGEST_BYTES / 8; i++) {
+            store_le64(digests + m * BH_KECCAK_256_DIGEST_BYTES + 8 * i, a[i]);
+        }
+    }
+}
+
+#if defined(BH_KECCAK_USE_X86)
+
+/**
+ * \brief          The lanes of 4 and of 8 states, one state per element. The GCC vector
+ *                 extensions compile the operators on them to the instructions of the target
+ *                 of the function that uses them, so there is one kernel per target below.
+ */
+typedef uint64_t keccak_x4_t __attribute__((vector_size(32)));
+typedef uint64_t keccak_x8_t __attribute__((vector_size(64)));
+
+/**
+ * \brief          Define the kernel that permutes up to one padded block per element of lane_t
+ *                 at once: every block is loaded into its element of the lanes, the unused
+ *                 elements stay zero, and only the digests of the blocks given are stored.
+ */
+#define KECCAK_DEFINE_LANES_KERNEL(name, isa, lane_t)                                              \
+    __attribute__((target(isa))) static void name(const uint8_t* const* blocks, size_t count,      \
+                                                  uint8_t* digests) {                              \
+        lane_t a[25] = {0};                                                                        \
+        for (size_t m = 0; m < count; m++) {                                                       \
+            for (int i = 0; i < BH_KECCAK_256_RATE / 8; i++) {                                     \
+                a[i][m] = load_le64(blocks[m] + 8 * i);                                            \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        KECCAK_F1600_ROUNDS(lane_t, a);                                                            \
+                                                                                                   \
+        for (size_t m = 0; m < count; m++) {                                                       \
+            for (int i = 0; i < BH_KECCAK_256_DIGEST_BYTES / 8; i++) {                             \
+                store_le64(digests + m * BH_KECCAK_256_DIGEST_BYTES + 8 * i, a[i][m]);             \
+            }                                                                                      \
+        }                                                                                          \
+    }
+
+KECCAK_DEFINE_LANES_KERNEL(keccak_256_blocks_avx2, "avx2", keccak_x4_t)
+KECCAK_DEFINE_LANES_KERNEL(keccak_256_blocks_avx512, "avx512f", keccak_x8_t)
+
+#endif
+
+/**
+ * \brief          Permute the gathered blocks of a batch and write every digest at the index
+ *                 of the input its block was padded from
+ *
+ * \param[in]      blocks The gathered blocks
+ * \param[in]      owners The index of the input of every block
+ * \param[in]      count The number of blocks, at most BH_KECCAK_MAX_LANES
+ * \param[out]     digests The digests of the batch, in the order of its inputs
+ */
+static void
+keccak_256_gathered_blocks(const uint8_t* const* blocks, const size_t* owners, size_t count,
+                           uint8_t* digests) {
+    uint8_t block_digests[BH_KECCAK_MAX_LANES * BH_KECCAK_256_DIGEST_BYTES];
+    hash_keccak_256_blocks(blocks, count, block_digests);
+    for (size_t m = 0; m < count; m++) {
+        memcpy(digests + owners[m] * BH_KECCAK_256_DIGEST_BYTES,
+               block_digests + m * BH_KECCAK_256_DIGEST_BYTES, BH_KECCAK_256_DIGEST_BYTES);
+    }
+}
+
+/****************************************************************
+                       EXTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Get the widest Keccak kernel the processor runs, from the features detected
+ *                 at startup, so one build uses the vector registers where they exist and runs
+ *                 everywhere else
+ *
+ * \return         The kernel hash_keccak_256_blocks uses
+ */
+hash_keccak_kernel_t
+hash_keccak_kernel(void) {
+#if defined(BH_KECCAK_USE_X86)
+    if (cpu_has(CPU_FEATURE_AVX512F)) {
+        return HASH_KECCAK_AVX512;
+    }
+    if (cpu_has(CPU_FEATURE_AVX2)) {
+        return HASH_KECCAK_AVX2;
+    }
+#endif
+    return HASH_KECCAK_SCALAR;
+}
+
+/**
+ * \brief          Get the number of messages a Keccak kernel permutes at once
+ *
+ * \param[in]      kernel The kernel
+ * \return         1, 4 or 8
+ */
+unsigned int
+hash_keccak_kernel_lanes(hash_keccak_kernel_t kernel) {
+    switch (kernel) {
+        case HASH_KECCAK_AVX512: return 8;
+        case HASH_KECCAK_AVX2: return 4;
+        default: return 1;
+    }
+}
+
+/**
+ * \brief          Get the name of a Keccak kernel for display
+ *
+ * \param[in]      kernel The kernel
+ * \return         A static string
+ */
+const char*
+hash_keccak_kernel_name(hash_keccak_kernel_t kernel) {
+    switch (kernel) {
+        case HASH_KECCAK_AVX512: return "AVX-512, 8 lanes";
+        case HASH_KECCAK_AVX2: return "AVX2, 4 lanes";
+        default: return "scalar";
+    }
+}
+
+/**
+ * \brief          Apply the 24 rounds of Keccak-f[1600] to a state
+ *
+ * \param[in,out]  state The 25 lanes of the state, lane x + 5 * y at index x + 5 * y
+ */
+void
+hash_keccak_f1600(uint64_t* state) {
+    KECCAK_F1600_ROUNDS(uint64_t, state);
+}
+
+/**
+ * \brief          Absorb padded single blocks into the zero state and squeeze a 256-bit
+ *                 digest from each, as many blocks per permutation as the kernel has lanes.
+ *                 The blocks left over from the widest kernel go through the narrower ones.
+ *
+ * \param[in]      blocks The blocks, BH_KECCAK_256_RATE bytes each with their padding
+ * \param[in]      count The number of blocks
+ * \param[out]     digests Receives the BH_KECCAK_256_DIGEST_BYTES of every digest in a row
+ */
+void
+hash_keccak_256_blocks(const uint8_t* const* blocks, size_t count, uint8_t* digests) {
+    size_t done = 0;
+#if defined(BH_KECCAK_USE_X86)
+    hash_keccak_kernel_t kernel = hash_keccak_kernel();
+    if (kernel == HASH_KECCAK_AVX512) {
+        for (; count - done >= 8; done += 8) {
+            keccak_256_blocks_avx512(blocks + done, 8, digests + done * BH_KECCAK_256_DIGEST_BYTES);
+        }
+    }
+    if (kernel != HASH_KECCAK_SCALAR && cpu_has(CPU_FEATURE_AVX2)) {
+        // A partly filled vector still beats permuting two messages one after the other
+        while (count - done >= 2) {
+            size_t lanes = count - done < 4 ? count - done : 4;
+            keccak_256_blocks_avx2(blocks + done, lanes,
+                                   digests + done * BH_KECCAK_256_DIGEST_BYTES);
+            done += lanes;
+        }
+    }
+#endif
+    keccak_256_blocks_scalar(blocks + done, count - done,
+                             digests + done * BH_KECCAK_256_DIGEST_BYTES);
+}
+
+/**
+ * \brief          Compute the 256-bit Keccak sponge of an input, Keccak-256 or SHA3-256 by
+ *                 the domain byte. The last block carries the domain byte and the final 0x80
+ *                 bit.
+ *
+ * \param[in]      data Pointer to input data buffer
+ * \param[in]      len Length of input data in bytes
+ * \param[in]      domain BH_KECCAK_DOMAIN_KECCAK or BH_KECCAK_DOMAIN_SHA3
+ * \param[out]     digest Receives the BH_KECCAK_256_DIGEST_BYTES of the digest
+ */
+void
+hash_keccak_256_sponge(const void* data, size_t len, uint8_t domain, uint8_t* digest) {
+    const uint8_t* input = data;
+    uint64_t state[25] = {0};
+    for (; len >= BH_KECCAK_256_RATE; input += BH_KECCAK_256_RATE, len -= BH_KECCAK_256_RATE) {
+        keccak_absorb(state, input);
+    }
+
+    uint8_t last[BH_KECCAK_256_RATE] = {0};
+    memcpy(last, input, len);
+    last[len] = domain;
+    last[BH_KECCAK_256_RATE - 1] |= 0x80;
+    keccak_absorb(state, last);
+
+    for (int i = 0; i < BH_KECCAK_256_DIGEST_BYTES / 8; i++) {
+        store_le64(digest + 8 * i, state[i]);
+    }
+}
+
+/**
+ * \brief          Compute the 256-bit Keccak sponges of a batch of inputs. The inputs that fit
+ *                 one block with their padding are padded and gathered, then permuted several
+ *                 at a time by hash_keccak_256_blocks, the longer ones go through the sponge.
+ *
+ * \param[in]      inputs The inputs to hash
+ * \param[in]      input_lens The length of every input in bytes
+ * \param[in]      count The number of inputs
+ * \param[in]      domain BH_KECCAK_DOMAIN_KECCAK or BH_KECCAK_DOMAIN_SHA3
+ * \param[out]     digests Receives the BH_KECCAK_256_DIGEST_BYTES of every digest in a row
+ */
+void
+hash_keccak_256_sponge_batch(const uint8_t* const* inputs, const size_t* input_lens, size_t count,
+                             uint8_t domain, uint8_t* digests) {
+    uint8_t blocks[BH_KECCAK_MAX_LANES][BH_KECCAK_256_RATE];
+    const uint8_t* block_ptrs[BH_KECCAK_MAX_LANES];
+    size_t owners[BH_KECCAK_MAX_LANES];
+    size_t gathered = 0;
+    for (size_t m = 0; m < BH_KECCAK_MAX_LANES; m++) {
+        block_ptrs[m] = blocks[m];
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        size_t len = input_lens[i];
+        if (len >= BH_KECCAK_256_RATE) {
+            hash_keccak_256_sponge(inputs[i], len, domain,
+                                   digests + i * BH_KECCAK_256_DIGEST_BYTES);
+            continue;
+        }
+
+        uint8_t* block = blocks[gathered];
+        memcpy(block, inputs[i], len);
+        memset(block + len, 0, BH_KECCAK_256_RATE - len);
+        block[len] = domain;
+        block[BH_KECCAK_256_RATE - 1] |= 0x80;
+        owners[gathered++] = i;
+
+        if (gathered == BH_KECCAK_MAX_LANES) {
+            keccak_256_gathered_blocks(block_ptrs, owners, gathered, digests);
+            gathered = 0;
+        }
+    }
+    keccak_256_gathered_blocks(block_ptrs, owners, gathered, digests);
+}
@@ -0,0 +1,62 @@
+/**
+ * \file            hash_keccak.h
+ * \brief           Header file for hash_keccak.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_KECCAK_H
+#define HASH_KECCAK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cpu_features.h"
+
+/**
+ * \brief          The bytes Keccak-256 and SHA3-256 absorb per permutation, the rate
+ */
+#define BH_KECCAK_256_RATE 136
+
+/**
+ * \brief          The bytes of a Keccak-256 digest
+ */
+#define BH_KECCAK_256_DIGEST_BYTES 32
+
+/**
+ * \brief          The most messages a Keccak kernel permutes at once, the 8 lanes of AVX-512
+ */
+#define BH_KECCAK_MAX_LANES 8
+
+/**
+ * \brief          The domain byte that starts the padding of Keccak-256, the first padding bit
+ */
+#define BH_KECCAK_DOMAIN_KECCAK 0x01
+
+/**
+ * \brief          The domain byte that starts the padding of SHA3-256, the two SHA-3 domain
+ *                 bits followed by the first padding bit
+ */
+#define BH_KECCAK_DOMAIN_SHA3 0x06
+
+typedef enum {
+    HASH_KECCAK_SCALAR = 0, ///< One message per permutation, on any processor
+    HASH_KECCAK_AVX2,       ///< Four messages per permutation in the 256-bit registers
+    HASH_KECCAK_AVX512      ///< Eight messages per permutation in the 512-bit registers
+} hash_keccak_kernel_t;
+
+hash_keccak_kernel_t hash_keccak_kernel(void);
+unsigned int hash_keccak_kernel_lanes(hash_keccak_kernel_t kernel);
+const char* hash_keccak_kernel_name(hash_keccak_kernel_t kernel);
+void hash_keccak_f1600(uint64_t* state);
+void hash_keccak_256_blocks(const uint8_t* const* blocks, size_t count, uint8_t* digests);
+void hash_keccak_256_sponge(const void* data, size_t len, uint8_t domain, uint8_t* digest);
+void hash_keccak_256_sponge_batch(const uint8_t* const* inputs, const size_t* input_lens,
+                                  size_t count, uint8_t domain, uint8_t* digests);
+
+#endif
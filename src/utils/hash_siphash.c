@@ -0,0 +1,116 @@
+/**
+ * \file            hash_siphash.c
+ * \brief           SipHash with a chosen number of compression and finalization rounds.
+ *                  The registry hashes with SipHash-2-4, the digest tables place their
+ *                  digests with the cheaper SipHash-1-3.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_siphash.h"
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Rotate a 64-bit value left
+ *
+ * \param[in]      value The value to rotate
+ * \param[in]      bits The number of bits to rotate by, 1 to 63
+ * \return         The rotated value
+ */
+static inline uint64_t
+rotl64(uint64_t value, unsigned int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+/**
+ * \brief          Load 8 bytes as a little endian 64-bit word, as SipHash reads its input
+ *
+ * \param[in]      bytes The bytes to load
+ * \return         The word
+ */
+static inline uint64_t
+load_le64(const uint8_t* bytes) {
+    uint64_t word;
+    memcpy(&word, bytes, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+/**
+ * \brief          Apply the SipHash round function to the four state words, a number of
+ *                 times
+ */
+#define BH_SIPROUNDS(v0, v1, v2, v3, rounds)                                                       \
+    do {                                                                                           \
+        for (unsigned int r = 0; r < (rounds); r++) {                                              \
+            v0 += v1;                                                                              \
+            v1 = rotl64(v1, 13);                                                                   \
+            v1 ^= v0;                                                                              \
+            v0 = rotl64(v0, 32);                                                                   \
+            v2 += v3;                                                                              \
+            v3 = rotl64(v3, 16);                                                                   \
+            v3 ^= v2;                                                                              \
+            v0 += v3;                                                                              \
+            v3 = rotl64(v3, 21);                                                                   \
+            v3 ^= v0;                                                                              \
+            v2 += v1;                                                                              \
+            v1 = rotl64(v1, 17);                                                                   \
+            v1 ^= v2;                                                                              \
+            v2 = rotl64(v2, 32);                                                                   \
+        }                                                                                          \
+    } while (0)
+
+/****************************************************************
+                       EXTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          SipHash-c-d: c compression rounds per 8-byte word and d finalization
+ *                 rounds under a 128-bit key
+ *
+ * \param[in]      key The 128-bit key
+ * \param[in]      c_rounds The compression rounds, 2 for SipHash-2-4, 1 for SipHash-1-3
+ * \param[in]      d_rounds The finalization rounds, 4 for SipHash-2-4, 3 for SipHash-1-3
+ * \param[in]      data The bytes to hash
+ * \param[in]      len The number of bytes
+ * \return         The 64-bit hash
+ */
+uint64_t
+hash_siphash(const uint64_t key[2], unsigned int c_rounds, unsigned int d_rounds,
+             const void* data, size_t len) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint64_t v0 = key[0] ^ 0x736f6d6570736575ULL;
+    uint64_t v1 = key[1] ^ 0x646f72616e646f6dULL;
+    uint64_t v2 = key[0] ^ 0x6c7967656e657261ULL;
+    uint64_t v3 = key[1] ^ 0x7465646279746573ULL;
+
+    const uint8_t* end = bytes + (len & ~(size_t)7);
+    for (; bytes != end; bytes += 8) {
+        uint64_t word = load_le64(bytes);
+        v3 ^= word;
+        BH_SIPROUNDS(v0, v1, v2, v3, c_rounds);
+        v0 ^= word;
+    }
+
+    // The last word holds the remaining bytes and the length in its top byte
+    uint64_t last = (uint64_t)len << 56;
+    for (size_t i = 0; i < (len & 7); i++) {
+        last |= (uint64_t)bytes[i] << (8 * i);
+    }
+    v3 ^= last;
+    BH_SIPROUNDS(v0, v1, v2, v3, c_rounds);
+    v0 ^= last;
+
+    v2 ^= 0xff;
+    BH_SIPROUNDS(v0, v1, v2, v3, d_rounds);
+    return v0 ^ v1 ^ v2 ^ v3;
+}
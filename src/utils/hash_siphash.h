@@ -0,0 +1,22 @@
+/**
+ * \file            hash_siphash.h
+ * \brief           Header file for hash_siphash.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_SIPHASH_H
+#define HASH_SIPHASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+uint64_t hash_siphash(const uint64_t key[2], unsigned int c_rounds, unsigned int d_rounds,
+                      const void* data, size_t len);
+
+#endif
@@ -0,0 +1,459 @@
+/**
+ * \file            hash_xxh3.c
+ * \brief           xxHash3, the non-cryptographic hash of the xxHash family, in its 64-bit
+ *                  and 128-bit variants with the default secret and seed 0. Short inputs are
+ *                  mixed by a few multiplications of their first and last words, inputs over
+ *                  240 bytes by the striped accumulators of the long loop.
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_xxh3.h"
+
+/****************************************************************
+                       INTERNAL FUNCTION
+****************************************************************/
+
+#define XXH_PRIME32_1 0x9E3779B1U
+#define XXH_PRIME32_2 0x85EBCA77U
+#define XXH_PRIME32_3 0xC2B2AE3DU
+#define XXH_PRIME64_1 0x9E3779B185EBCA87ULL
+#define XXH_PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define XXH_PRIME64_3 0x165667B19E3779F9ULL
+#define XXH_PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define XXH_PRIME64_5 0x27D4EB2F165667C5ULL
+#define XXH_PRIME_MX1 0x165667919E3779F9ULL
+#define XXH_PRIME_MX2 0x9FB21C651E98DF25ULL
+
+/**
+ * \brief          The bytes of the default secret
+ */
+#define XXH_SECRET_BYTES 192
+
+/**
+ * \brief          The bytes of the smallest secret, the mid-size inputs read the secret
+ *                 up to it
+ */
+#define XXH_SECRET_MIN_BYTES 136
+
+/**
+ * \brief          The bytes of one stripe of the long loop, one per accumulator word
+ */
+#define XXH_STRIPE_BYTES 64
+
+/**
+ * \brief          The stripes of one block of the long loop, the secret advances 8 bytes
+ *                 per stripe until its last stripe
+ */
+#define XXH_STRIPES_PER_BLOCK ((XXH_SECRET_BYTES - XXH_STRIPE_BYTES) / 8)
+
+/**
+ * \brief          The longest input of the mid-size mixing, longer ones take the long loop
+ */
+#define XXH_MIDSIZE_MAX 240
+
+static const uint8_t s_xxh3_secret[XXH_SECRET_BYTES] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+static inline uint32_t
+read_le32(const uint8_t* bytes) {
+    uint32_t word;
+    memcpy(&word, bytes, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap32(word);
+#endif
+    return word;
+}
+
+static inline uint64_t
+read_le64(const uint8_t* bytes) {
+    uint64_t word;
+    memcpy(&word, bytes, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+static inline uint64_t
+rotl64(uint64_t value, unsigned int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static inline uint64_t
+xorshift64(uint64_t value, unsigned int shift) {
+    return value ^ (value >> shift);
+}
+
+static inline hash_xxh3_128_t
+mul64to128(uint64_t lhs, uint64_t rhs) {
+    unsigned __int128 product = (unsigned __int128)lhs * rhs;
+    return (hash_xxh3_128_t){(uint64_t)product, (uint64_t)(product >> 64)};
+}
+
+static inline uint64_t
+mul128_fold64(uint64_t lhs, uint64_t rhs) {
+    hash_xxh3_128_t product = mul64to128(lhs, rhs);
+    return product.low64 ^ product.high64;
+}
+
+static inline uint64_t
+xxh64_avalanche(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= XXH_PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= XXH_PRIME64_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+static inline uint64_t
+xxh3_avalanche(uint64_t hash) {
+    hash = xorshift64(hash, 37);
+    hash *= XXH_PRIME_MX1;
+    return xorshift64(hash, 32);
+}
+
+static inline uint64_t
+xxh3_rrmxmx(uint64_t hash, uint64_t len) {
+    hash ^= rotl64(hash, 49) ^ rotl64(hash, 24);
+    hash *= XXH_PRIME_MX2;
+    hash ^= (hash >> 35) + len;
+    hash *= XXH_PRIME_MX2;
+    return xorshift64(hash, 28);
+}
+
+/**
+ * \brief          Mix 16 input bytes with 16 secret bytes into one word
+ *
+ * \param[in]      input The input bytes
+ * \param[in]      secret The secret bytes
+ * \return         The folded product of the two keyed words
+ */
+static inline uint64_t
+xxh3_mix16(const uint8_t* input, const uint8_t* secret) {
+    return mul128_fold64(read_le64(input) ^ read_le64(secret),
+                         read_le64(input + 8) ^ read_le64(secret + 8));
+}
+
+/**
+ * \brief          Mix 32 input bytes into both halves of a 128-bit accumulator, each half
+ *                 takes one 16-byte run keyed and the other one plain
+ *
+ * \param[in]      acc The accumulator
+ * \param[in]      first The first 16 input bytes
+ * \param[in]      second The second 16 input bytes
+ * \param[in]      secret The 32 secret bytes
+ * \return         The accumulator after the bytes
+ */
+static inline hash_xxh3_128_t
+xxh3_mix32(hash_xxh3_128_t acc, const uint8_t* first, const uint8_t* second,
+           const uint8_t* secret) {
+    acc.low64 += xxh3_mix16(first, secret);
+    acc.low64 ^= read_le64(second) + read_le64(second + 8);
+    acc.high64 += xxh3_mix16(second, secret + 16);
+    acc.high64 ^= read_le64(first) + read_le64(first + 8);
+    return acc;
+}
+
+/**
+ * \brief          Accumulate one stripe: every word is added to its neighbour and
+ *                 multiplied keyed into its own accumulator
+ *
+ * \param[in,out]  acc The 8 accumulator words
+ * \param[in]      input The 64 bytes of the stripe
+ * \param[in]      secret The secret bytes of the stripe
+ */
+static inline void
+xxh3_accumulate_stripe(uint64_t* acc, const uint8_t* input, const uint8_t* secret) {
+    for (int lane = 0; lane < 8; lane++) {
+        uint64_t value = read_le64(input + 8 * lane);
+        uint64_t keyed = value ^ read_le64(secret + 8 * lane);
+        acc[lane ^ 1] += value;
+        acc[lane] += (keyed & 0xFFFFFFFFU) * (keyed >> 32);
+    }
+}
+
+/**
+ * \brief          Scramble the accumulators at the end of every block of the long loop
+ *
+ * \param[in,out]  acc The 8 accumulator words
+ * \param[in]      secret The last 64 bytes of the secret
+ */
+static inline void
+xxh3_scramble(uint64_t* acc, const uint8_t* secret) {
+    for (int lane = 0; lane < 8; lane++) {
+        acc[lane] = (xorshift64(acc[lane], 47) ^ read_le64(secret + 8 * lane)) * XXH_PRIME32_1;
+    }
+}
+
+/**
+ * \brief          Run the long loop of an input over 240 bytes: blocks of 16 stripes with a
+ *                 scramble after each, then the stripes left and the last 64 bytes
+ *
+ * \param[out]     acc Receives the 8 accumulator words
+ * \param[in]      input The input
+ * \param[in]      len The length of the input, over 240 bytes
+ */
+static void
+xxh3_long_loop(uint64_t* acc, const uint8_t* input, size_t len) {
+    static const uint64_t initial[8] = {XXH_PRIME32_3, XXH_PRIME64_1, XXH_PRIME64_2,
+                                        XXH_PRIME64_3, XXH_PRIME64_4, XXH_PRIME32_2,
+                                        XXH_PRIME64_5, XXH_PRIME32_1};
+    memcpy(acc, initial, sizeof(initial));
+
+    const size_t block_bytes = XXH_STRIPE_BYTES * XXH_STRIPES_PER_BLOCK;
+    size_t blocks = (len - 1) / block_bytes;
+    for (size_t n = 0; n < blocks; n++) {
+        for (size_t s = 0; s < XXH_STRIPES_PER_BLOCK; s++) {
+            xxh3_accumulate_stripe(acc, input + n * block_bytes + s * XXH_STRIPE_BYTES,
+                                   s_xxh3_secret + 8 * s);
+        }
+        xxh3_scramble(acc, s_xxh3_secret + XXH_SECRET_BYTES - XXH_STRIPE_BYTES);
+    }
+
+    size_t stripes = ((len - 1) - block_bytes * blocks) / XXH_STRIPE_BYTES;
+    for (size_t s = 0; s < stripes; s++) {
+        xxh3_accumulate_stripe(acc, input + blocks * block_bytes + s * XXH_STRIPE_BYTES,
+                               s_xxh3_secret + 8 * s);
+    }
+    xxh3_accumulate_stripe(acc, input + len - XXH_STRIPE_BYTES,
+                           s_xxh3_secret + XXH_SECRET_BYTES - XXH_STRIPE_BYTES - 7);
+}
+
+/**
+ * \brief          Merge the 8 accumulators of the long loop into one word
+ *
+ * \param[in]      acc The 8 accumulator words
+ * \param[in]      secret The 64 secret bytes to key them with
+ * \param[in]      start The starting value, derived from the length
+ * \return         The merged word
+ */
+static uint64_t
+xxh3_merge(const uint64_t* acc, const uint8_t* secret, uint64_t start) {
+    uint64_t result = start;
+    for (int i = 0; i < 4; i++) {
+        result += mul128_fold64(acc[2 * i] ^ read_le64(secret + 16 * i),
+                                acc[2 * i + 1] ^ read_le64(secret + 16 * i + 8));
+    }
+    return xxh3_avalanche(result);
+}
+
+/**
+ * \brief          The 64-bit xxHash3 of an input of at most 16 bytes
+ *
+ * \param[in]      input The input
+ * \param[in]      len The length of the input
+ * \return         The digest
+ */
+static uint64_t
+xxh3_64_short(const uint8_t* input, size_t len) {
+    const uint8_t* secret = s_xxh3_secret;
+    if (len > 8) {
+        uint64_t low = read_le64(input) ^ (read_le64(secret + 24) ^ read_le64(secret + 32));
+        uint64_t high =
+            read_le64(input + len - 8) ^ (read_le64(secret + 40) ^ read_le64(secret + 48));
+        uint64_t acc = len + __builtin_bswap64(low) + high + mul128_fold64(low, high);
+        return xxh3_avalanche(acc);
+    }
+    if (len >= 4) {
+        uint64_t value = read_le32(input + len - 4) + ((uint64_t)read_le32(input) << 32);
+        return xxh3_rrmxmx(value ^ (read_le64(secret + 8) ^ read_le64(secret + 16)), len);
+    }
+    if (len > 0) {
+        uint32_t combined = ((uint32_t)input[0] << 16) | ((uint32_t)input[len >> 1] << 24)
+                            | input[len - 1] | ((uint32_t)len << 8);
+        return xxh64_avalanche(combined ^ (uint64_t)(read_le32(secret) ^ read_le32(secret + 4)));
+    }
+    return xxh64_avalanche(read_le64(secret + 56) ^ read_le64(secret + 64));
+}
+
+/**
+ * \brief          The 128-bit xxHash3 of an input of at most 16 bytes
+ *
+ * \param[in]      input The input
+ * \param[in]      len The length of the input
+ * \return         The digest
+ */
+static hash_xxh3_128_t
+xxh3_128_short(const uint8_t* input, size_t len) {
+    const uint8_t* secret = s_xxh3_secret;
+    if (len > 8) {
+        uint64_t low = read_le64(input);
+        uint64_t high = read_le64(input + len - 8);
+        hash_xxh3_128_t m = mul64to128(
+            low ^ high ^ (read_le64(secret + 32) ^ read_le64(secret + 40)), XXH_PRIME64_1);
+        m.low64 += (uint64_t)(len - 1) << 54;
+        high ^= read_le64(secret + 48) ^ read_le64(secret + 56);
+        m.high64 += high + (uint64_t)(uint32_t)high * (XXH_PRIME32_2 - 1);
+        m.low64 ^= __builtin_bswap64(m.high64);
+
+        hash_xxh3_128_t h = mul64to128(m.low64, XXH_PRIME64_2);
+        h.high64 += m.high64 * XXH_PRIME64_2;
+        h.low64 = xxh3_avalanche(h.low64);
+        h.high64 = xxh3_avalanche(h.high64);
+        return h;
+    }
+    if (len >= 4) {
+        uint64_t value = read_le32(input) + ((uint64_t)read_le32(input + len - 4) << 32);
+        uint64_t keyed = value ^ (read_le64(secret + 16) ^ read_le64(secret + 24));
+        hash_xxh3_128_t m = mul64to128(keyed, XXH_PRIME64_1 + (len << 2));
+        m.high64 += m.low64 << 1;
+        m.low64 ^= m.high64 >> 3;
+        m.low64 = xorshift64(m.low64, 35);
+        m.low64 *= XXH_PRIME_MX2;
+        m.low64 = xorshift64(m.low64, 28);
+        m.high64 = xxh3_avalanche(m.high64);
+        return m;
+    }
+    if (len > 0) {
+        uint32_t low = ((uint32_t)input[0] << 16) | ((uint32_t)input[len >> 1] << 24)
+                       | input[len - 1] | ((uint32_t)len << 8);
+        uint32_t swapped = __builtin_bswap32(low);
+        uint32_t high = (swapped << 13) | (swapped >> 19);
+        return (hash_xxh3_128_t){
+            xxh64_avalanche(low ^ (uint64_t)(read_le32(secret) ^ read_le32(secret + 4))),
+            xxh64_avalanche(high ^ (uint64_t)(read_le32(secret + 8) ^ read_le32(secret + 12)))};
+    }
+    return (hash_xxh3_128_t){xxh64_avalanche(read_le64(secret + 64) ^ read_le64(secret + 72)),
+                             xxh64_avalanche(read_le64(secret + 80) ^ read_le64(secret + 88))};
+}
+
+/**
+ * \brief          Finish a 128-bit accumulator of the 17 to 240 byte inputs
+ *
+ * \param[in]      acc The accumulator
+ * \param[in]      len The length of the input
+ * \return         The digest
+ */
+static hash_xxh3_128_t
+xxh3_128_finish(hash_xxh3_128_t acc, size_t len) {
+    hash_xxh3_128_t h;
+    h.low64 = xxh3_avalanche(acc.low64 + acc.high64);
+    h.high64 = 0
+               - xxh3_avalanche(acc.low64 * XXH_PRIME64_1 + acc.high64 * XXH_PRIME64_4
+                                + (uint64_t)len * XXH_PRIME64_2);
+    return h;
+}
+
+/****************************************************************
+                       EXTERNAL FUNCTION
+****************************************************************/
+
+/**
+ * \brief          Compute the 64-bit xxHash3 of an input, with the default secret and seed 0
+ *
+ * \param[in]      data Pointer to input data buffer
+ * \param[in]      len Length of input data in bytes
+ * \return         The digest
+ */
+uint64_t
+hash_xxh3_64(const void* data, size_t len) {
+    const uint8_t* input = data;
+    const uint8_t* secret = s_xxh3_secret;
+    if (len <= 16) {
+        return xxh3_64_short(input, len);
+    }
+
+    uint64_t acc = len * XXH_PRIME64_1;
+    if (len <= 128) {
+        if (len > 32) {
+            if (len > 64) {
+                if (len > 96) {
+                    acc += xxh3_mix16(input + 48, secret + 96);
+                    acc += xxh3_mix16(input + len - 64, secret + 112);
+                }
+                acc += xxh3_mix16(input + 32, secret + 64);
+                acc += xxh3_mix16(input + len - 48, secret + 80);
+            }
+            acc += xxh3_mix16(input + 16, secret + 32);
+            acc += xxh3_mix16(input + len - 32, secret + 48);
+        }
+        acc += xxh3_mix16(input, secret);
+        acc += xxh3_mix16(input + len - 16, secret + 16);
+        return xxh3_avalanche(acc);
+    }
+
+    if (len <= XXH_MIDSIZE_MAX) {
+        for (unsigned int i = 0; i < 8; i++) {
+            acc += xxh3_mix16(input + 16 * i, secret + 16 * i);
+        }
+        acc = xxh3_avalanche(acc);
+        uint64_t acc_end = xxh3_mix16(input + len - 16, secret + XXH_SECRET_MIN_BYTES - 17);
+        for (unsigned int i = 8; i < len / 16; i++) {
+            acc_end += xxh3_mix16(input + 16 * i, secret + 16 * (i - 8) + 3);
+        }
+        return xxh3_avalanche(acc + acc_end);
+    }
+
+    uint64_t accs[8];
+    xxh3_long_loop(accs, input, len);
+    return xxh3_merge(accs, secret + 11, len * XXH_PRIME64_1);
+}
+
+/**
+ * \brief          Compute the 128-bit xxHash3 of an input, with the default secret and seed 0
+ *
+ * \param[in]      data Pointer to input data buffer
+ * \param[in]      len Length of input data in bytes
+ * \return         The digest
+ */
+hash_xxh3_128_t
+hash_xxh3_128(const void* data, size_t len) {
+    const uint8_t* input = data;
+    const uint8_t* secret = s_xxh3_secret;
+    if (len <= 16) {
+        return xxh3_128_short(input, len);
+    }
+
+    hash_xxh3_128_t acc = {len * XXH_PRIME64_1, 0};
+    if (len <= 128) {
+        if (len > 32) {
+            if (len > 64) {
+                if (len > 96) {
+                    acc = xxh3_mix32(acc, input + 48, input + len - 64, secret + 96);
+                }
+                acc = xxh3_mix32(acc, input + 32, input + len - 48, secret + 64);
+            }
+            acc = xxh3_mix32(acc, input + 16, input + len - 32, secret + 32);
+        }
+        acc = xxh3_mix32(acc, input, input + len - 16, secret);
+        return xxh3_128_finish(acc, len);
+    }
+
+    if (len <= XXH_MIDSIZE_MAX) {
+        for (size_t i = 32; i < 160; i += 32) {
+            acc = xxh3_mix32(acc, input + i - 32, input + i - 16, secret + i - 32);
+        }
+        acc.low64 = xxh3_avalanche(acc.low64);
+        acc.high64 = xxh3_avalanche(acc.high64);
+        for (size_t i = 160; i <= len; i += 32) {
+            acc = xxh3_mix32(acc, input + i - 32, input + i - 16, secret + 3 + i - 160);
+        }
+        acc = xxh3_mix32(acc, input + len - 16, input + len - 32,
+                         secret + XXH_SECRET_MIN_BYTES - 17 - 16);
+        return xxh3_128_finish(acc, len);
+    }
+
+    uint64_t accs[8];
+    xxh3_long_loop(accs, input, len);
+    return (hash_xxh3_128_t){
+        xxh3_merge(accs, secret + 11, len * XXH_PRIME64_1),
+        xxh3_merge(accs, secret + XXH_SECRET_BYTES - 64 - 11, ~(len * XXH_PRIME64_2))};
+}
@@ -0,0 +1,30 @@
+/**
+ * \file            hash_xxh3.h
+ * \brief           Header file for hash_xxh3.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASH_XXH3_H
+#define HASH_XXH3_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * \brief          A 128-bit xxHash3 digest, the canonical form writes high64 first
+ */
+typedef struct {
+    uint64_t low64;  ///< The low 64 bits
+    uint64_t high64; ///< The high 64 bits
+} hash_xxh3_128_t;
+
+uint64_t hash_xxh3_64(const void* data, size_t len);
+hash_xxh3_128_t hash_xxh3_128(const void* data, size_t len);
+
+#endif
@@ -0,0 +1,143 @@
+/**
+ * \file            mapped_file.c
+ * \brief           Cross-platform read-only memory mapping of a file, for the tables that
+ *                  are precomputed once and looked up by later runs without reading them
+ *                  whole.
+ *
+ *                  On Windows: Uses CreateFileMapping and MapViewOfFile
+ *                  On Linux: Uses mmap of the file descriptor
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "mapped_file.h"
+
+#ifdef _WIN32
+/****************************************************************
+                       WINDOWS IMPLEMENTATION
+****************************************************************/
+
+/**
+ * \brief          Map a file read-only into memory. You should close the returned map using
+ *                 `mapped_file_close` when done.
+ *
+ * \param[in]      path The path of the file to map
+ * \return         The map of the file, or NULL if the file is missing, empty or can not be
+ *                 mapped
+ */
+mapped_file_t*
+mapped_file_open(const char* path) {
+    mapped_file_t* map = calloc(1, sizeof(mapped_file_t));
+    if (!map) {
+        return NULL;
+    }
+
+    map->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER size;
+    if (map->file == INVALID_HANDLE_VALUE || !GetFileSizeEx(map->file, &size)
+        || size.QuadPart == 0 || (unsigned long long)size.QuadPart > SIZE_MAX) {
+        if (map->file != INVALID_HANDLE_VALUE) {
+            CloseHandle(map->file);
+        }
+        free(map);
+        return NULL;
+    }
+
+    map->size = (size_t)size.QuadPart;
+    map->mapping = CreateFileMappingA(map->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (map->mapping) {
+        map->data = MapViewOfFile(map->mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+
+    if (!map->data) {
+        if (map->mapping) {
+            CloseHandle(map->mapping);
+        }
+        CloseHandle(map->file);
+        free(map);
+        return NULL;
+    }
+    return map;
+}
+
+/**
+ * \brief          Unmap a file and close it
+ *
+ * \param[in]      map The map to close, NULL is ignored
+ */
+void
+mapped_file_close(mapped_file_t* map) {
+    if (!map) {
+        return;
+    }
+
+    UnmapViewOfFile(map->data);
+    CloseHandle(map->mapping);
+    CloseHandle(map->file);
+    free(map);
+}
+
+#else
+/****************************************************************
+                        POSIX IMPLEMENTATION
+****************************************************************/
+
+/**
+ * \brief          Map a file read-only into memory. You should close the returned map using
+ *                 `mapped_file_close` when done.
+ *
+ * \param[in]      path The path of the file to map
+ * \return         The map of the file, or NULL if the file is missing, empty or can not be
+ *                 mapped
+ */
+mapped_file_t*
+mapped_file_open(const char* path) {
+    mapped_file_t* map = calloc(1, sizeof(mapped_file_t));
+    if (!map) {
+        return NULL;
+    }
+
+    map->fd = open(path, O_RDONLY);
+    struct stat status;
+    if (map->fd < 0 || fstat(map->fd, &status) != 0 || status.st_size <= 0) {
+        if (map->fd >= 0) {
+            close(map->fd);
+        }
+        free(map);
+        return NULL;
+    }
+
+    map->size = (size_t)status.st_size;
+    void* data = mmap(NULL, map->size, PROT_READ, MAP_SHARED, map->fd, 0);
+    if (data == MAP_FAILED) {
+        close(map->fd);
+        free(map);
+        return NULL;
+    }
+
+    map->data = data;
+    return map;
+}
+
+/**
+ * \brief          Unmap a file and close it
+ *
+ * \param[in]      map The map to close, NULL is ignored
+ */
+void
+mapped_file_close(mapped_file_t* map) {
+    if (!map) {
+        return;
+    }
+
+    munmap((void*)map->data, map->size);
+    close(map->fd);
+    free(map);
+}
+
+#endif
@@ -0,0 +1,49 @@
+/**
+ * \file            mapped_file.h
+ * \brief           Header file for mapped_file.c
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * \brief          A file mapped read-only into memory. The pages are read from the file
+ *                 the first time they are touched, so a large file costs no memory until it
+ *                 is used.
+ */
+typedef struct {
+    const uint8_t* data; ///< The content of the file
+    size_t size;         ///< The size of the file in bytes
+#ifdef _WIN32
+    HANDLE file;    ///< The handle of the file
+    HANDLE mapping; ///< The handle of the mapping of the file
+#else
+    int fd; ///< The descriptor of the file
+#endif
+} mapped_file_t;
+
+mapped_file_t* mapped_file_open(const char* path);
+void mapped_file_close(mapped_file_t* map);
+
+#endif
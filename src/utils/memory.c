@@ -0,0 +1,211 @@
+/**
+ * \file            memory.c
+ * \brief           Cross-platform detection of the memory the application can still use,
+ *                  so the attacks can plan their tables around it instead of failing on
+ *                  the first allocation that does not fit.
+ *
+ *                  On Windows: Uses GlobalMemoryStatusEx for the available physical memory
+ *                  On Linux: Uses MemAvailable of /proc/meminfo, lowered to what is left of
+ *                  the memory limit of the cgroup (v2 or v1) the process runs in
+ */
+
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "memory.h"
+
+#ifdef _WIN32
+/****************************************************************
+                       WINDOWS IMPLEMENTATION
+****************************************************************/
+
+/**
+ * \brief          Get the number of bytes of memory the application can still allocate
+ *                 without paging, which on Windows is the available physical memory.
+ *
+ * \return         The available memory in bytes, 0 if it could not be determined
+ */
+size_t
+get_available_memory(void) {
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof(status);
+    if (!GlobalMemoryStatusEx(&status)) {
+        return 0;
+    }
+
+    if (status.ullAvailPhys > SIZE_MAX) {
+        return SIZE_MAX;
+    }
+    return (size_t)status.ullAvailPhys;
+}
+
+#else
+/****************************************************************
+                        POSIX IMPLEMENTATION
+****************************************************************/
+
+/**
+ * \brief          Read the first number of a file, like the single value of a cgroup
+ *                 control file
+ *
+ * \param[in]      path The path of the file to read
+ * \param[out]     value Receives the number
+ * \return         true if the file starts with a number, false if it is missing or holds
+ *                 something else, like the "max" of an unlimited cgroup v2
+ */
+static bool
+read_number_file(const char* path, uint64_t* value) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+
+    unsigned long long number;
+    bool has_number = fscanf(file, "%llu", &number) == 1;
+    fclose(file);
+
+    if (has_number) {
+        *value = (uint64_t)number;
+    }
+    return has_number;
+}
+
+/**
+ * \brief          Get the memory left below a cgroup limit, given the file holding the
+ *                 limit and the file holding the current usage
+ *
+ * \param[in]      limit_path The control file of the limit in bytes
+ * \param[in]      usage_path The control file of the usage in bytes
+ * \param[out]     available Receives the bytes left, 0 when the usage is over the limit
+ * \return         true if the cgroup has a limit, false if it is unlimited or unreadable
+ */
+static bool
+cgroup_memory_left(const char* limit_path, const char* usage_path, uint64_t* available) {
+    uint64_t limit;
+    uint64_t usage = 0;
+    if (!read_number_file(limit_path, &limit)) {
+        return false;
+    }
+
+    // An unlimited cgroup v1 reports a limit near the largest page aligned 64-bit value
+    if (limit >= ((uint64_t)1 << 60)) {
+        return false;
+    }
+
+    read_number_file(usage_path, &usage);
+    *available = usage < limit ? limit - usage : 0;
+    return true;
+}
+
+/**
+ * \brief          Get the memory left in the cgroup of the process. The cgroup v2 path of
+ *                 the process is read from /proc/self/cgroup, and the root of the hierarchy
+ *                 is tried next since that is where containers usually see their own group.
+ *                 The cgroup v1 memory controller is only tried at its usual mount point.
+ *
+ * \param[out]     available Receives the bytes left below the limit
+ * \return         true if a limited cgroup was found, false otherwise
+ */
+static bool
+cgroup_available_memory(uint64_t* available) {
+    char limit_path[512];
+    char usage_path[512];
+
+    FILE* file = fopen("/proc/self/cgroup", "r");
+    if (file) {
+        char line[384];
+        while (fgets(line, sizeof(line), file)) {
+            // The unified hierarchy is the line with hierarchy id 0 and no controllers
+            if (strncmp(line, "0::", 3) != 0) {
+                continue;
+            }
+
+            line[strcspn(line, "\n")] = '\0';
+            snprintf(limit_path, sizeof(limit_path), "/sys/fs/cgroup%s/memory.max", line + 3);
+            snprintf(usage_path, sizeof(usage_path), "/sys/fs/cgroup%s/memory.current",
+                     line + 3);
+            if (cgroup_memory_left(limit_path, usage_path, available)) {
+                fclose(file);
+                return true;
+            }
+            break;
+        }
+        fclose(file);
+    }
+
+    if (cgroup_memory_left("/sys/fs/cgroup/memory.max", "/sys/fs/cgroup/memory.current",
+                           available)) {
+        return true;
+    }
+    return cgroup_memory_left("/sys/fs/cgroup/memory/memory.limit_in_bytes",
+                              "/sys/fs/cgroup/memory/memory.usage_in_bytes", available);
+}
+
+/**
+ * \brief          Get the memory the kernel estimates can be allocated without swapping,
+ *                 the MemAvailable line of /proc/meminfo
+ *
+ * \param[out]     available Receives the available memory in bytes
+ * \return         true if /proc/meminfo has the line, false otherwise
+ */
+static bool
+meminfo_available_memory(uint64_t* available) {
+    FILE* file = fopen("/proc/meminfo", "r");
+    if (!file) {
+        return false;
+    }
+
+    char line[128];
+    bool found = false;
+    while (!found && fgets(line, sizeof(line), file)) {
+        unsigned long long kibibytes;
+        if (sscanf(line, "MemAvailable: %llu kB", &kibibytes) == 1) {
+            *available = (uint64_t)kibibytes * 1024;
+            found = true;
+        }
+    }
+
+    fclose(file);
+    return found;
+}
+
+/**
+ * \brief          Get the number of bytes of memory the application can still allocate
+ *                 without swapping: the lower of the MemAvailable of /proc/meminfo and what
+ *                 is left below the cgroup limit. Systems without /proc fall back to the
+ *                 free physical pages reported by sysconf where it has them.
+ *
+ * \return         The available memory in bytes, 0 if it could not be determined
+ */
+size_t
+get_available_memory(void) {
+    uint64_t available = 0;
+    bool known = meminfo_available_memory(&available);
+
+#if defined(_SC_AVPHYS_PAGES) && defined(_SC_PAGESIZE)
+    if (!known) {
+        long pages = sysconf(_SC_AVPHYS_PAGES);
+        long page_size = sysconf(_SC_PAGESIZE);
+        if (pages > 0 && page_size > 0) {
+            available = (uint64_t)pages * (uint64_t)page_size;
+            known = true;
+        }
+    }
+#endif
+
+    uint64_t cgroup_left;
+    if (cgroup_available_memory(&cgroup_left) && (!known || cgroup_left < available)) {
+        available = cgroup_left;
+        known = true;
+    }
+
+    if (!known) {
+        return 0;
+    }
+    return available > SIZE_MAX ? SIZE_MAX : (size_t)available;
+}
+
+#endif
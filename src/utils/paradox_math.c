@@ -1,7 +1,9 @@
 /**
  * \file            paradox_math.c
  * \brief           The logic and math behind the birthday paradox simulation
- *                  that calculate the probability for the birthday paradox
+ *                  that calculate the probability for the birthday paradox. The
+ *                  simulation draws its samples from rand(), the ideal source, or
+ *                  from the digests of a hash function over counter inputs.
  */
 
 /*
@@ -12,32 +14,253 @@
 
 #include "paradox_math.h"
 
+/**
+ * \brief          The samples of a hashed simulation: counter inputs hashed a batch at a
+ *                 time, every digest reduced to a birthday
+ */
+typedef struct {
+    hash_batch_fn batch; ///< The batch function of the hash
+    size_t digest_bytes; ///< The bytes of a digest of the hash
+    int domain_size;     ///< The birthdays the digests are reduced to
+    uint64_t key;        ///< Drawn once per simulation, the first half of every input
+    uint64_t counter;    ///< The counter of the next input to hash
+    int next;            ///< The next sample of the batch to hand out
+    int samples[BH_PARADOX_HASH_BATCH]; ///< The birthdays of the last batch
+    uint8_t inputs[BH_PARADOX_HASH_BATCH][BH_PARADOX_INPUT_BYTES]; ///< The inputs of a batch
+    uint8_t digests[BH_PARADOX_HASH_BATCH * BH_HASH_MAX_DIGEST_BYTES]; ///< Their digests
+} hashed_samples_t;
+
+/**
+ * \brief          Finds the first repeated birthday of a trial in O(1) per sample. The stamps
+ *                 are stamped with the generation of the trial that last saw them, and a new
+ *                 trial only bumps the generation, so the memory is reused without clearing.
+ *                 Domains up to BH_PARADOX_STAMP_MAX_DOMAIN get a stamp per birthday, larger
+ *                 ones an open-addressing set of the birthdays of the trial, which grows with it.
+ */
+typedef struct {
+    uint32_t* stamps;    ///< The generation of every birthday, or of every slot of the set
+    int* keys;           ///< The birthday of every slot, NULL without a set
+    size_t mask;         ///< The slots of the set minus one, a power of two minus one
+    size_t count;        ///< The birthdays in the set this trial
+    uint32_t generation; ///< The generation of the current trial, never 0
+    int domain_size;     ///< The range of possible values
+} collision_detector_t;
+
+/**
+ * \brief          A simulation run a step at a time, drawing its samples from rand() or from
+ *                 the digests of a hash function
+ */
+struct paradox_simulation {
+    collision_detector_t detector; ///< Finds the first repeated birthday of a trial
+    hashed_samples_t* samples;     ///< The samples of the hash, NULL to draw from rand()
+    int sample_size;               ///< The number of values to take per trial
+    int num_runs;                  ///< The number of trials to run
+    int runs_done;                 ///< The trials run so far
+    int collisions_found;          ///< The trials that found a collision so far
+};
+
 /****************************************************************
                        INTERNAL FUNCTION
 ****************************************************************/
 
 /**
- * \brief          Helper function to check if there's a collision in 
- *                 an array of numbers
+ * \brief          Seed the random number generator once
+ */
+static void
+seed_random(void) {
+    static bool seeded = false;
+    if (!seeded) {
+        srand((unsigned int)time(NULL));
+        seeded = true;
+    }
+}
+
+/**
+ * \brief          Start a collision detector for the trials of a simulation. You should free
+ *                 it using `detector_free` when done.
  *
- * \param[in]      numbers An array of numbers that will be checked if
- *                 any of the two number is the same
- * \param[in]      size The size of the array to be checked
- * \return         True if a collision is found, and false if no collisions
- *                 occurred
- * 
+ * \param[out]     detector The detector to start
+ * \param[in]      domain_size The range of possible values
+ * \return         true once started, false on memory allocation failure
  */
 static bool
-has_collision(const int* numbers, int size) {
-    // Check each pair of numbers for a match
-    for (int i = 0; i < size - 1; i++) {
-        for (int j = i + 1; j < size; j++) {
-            if (numbers[i] == numbers[j]) {
-                return true;
-            }
+detector_init(collision_detector_t* detector, int domain_size) {
+    memset(detector, 0, sizeof(*detector));
+    detector->domain_size = domain_size;
+    if (domain_size <= BH_PARADOX_STAMP_MAX_DOMAIN) {
+        // One stamp per birthday, indexed by the birthday itself (1 to domain_size)
+        detector->stamps = calloc((size_t)domain_size + 1, sizeof(uint32_t));
+        return detector->stamps != NULL;
+    }
+
+    detector->mask = BH_PARADOX_SET_MIN_SLOTS - 1;
+    detector->stamps = calloc(BH_PARADOX_SET_MIN_SLOTS, sizeof(uint32_t));
+    detector->keys = malloc(BH_PARADOX_SET_MIN_SLOTS * sizeof(int));
+    if (!detector->stamps || !detector->keys) {
+        free(detector->stamps);
+        free(detector->keys);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * \brief          Start the next trial. Only the stamps of the current generation count, so
+ *                 the birthdays of the trials before are forgotten without clearing anything;
+ *                 the stamps are only cleared once every 2^32 trials when the generation wraps.
+ *
+ * \param[in]      detector The detector
+ */
+static void
+detector_next_trial(collision_detector_t* detector) {
+    detector->count = 0;
+    if (++detector->generation == 0) {
+        size_t stamps = detector->keys ? detector->mask + 1 : (size_t)detector->domain_size + 1;
+        memset(detector->stamps, 0, stamps * sizeof(uint32_t));
+        detector->generation = 1;
+    }
+}
+
+/**
+ * \brief          Double the slots of the set, moving over the birthdays of the current trial
+ *
+ * \param[in]      detector The detector, with a set
+ * \return         true once grown, false on memory allocation failure
+ */
+static bool
+detector_grow(collision_detector_t* detector) {
+    size_t slots = 2 * (detector->mask + 1);
+    uint32_t* stamps = calloc(slots, sizeof(uint32_t));
+    int* keys = malloc(slots * sizeof(int));
+    if (!stamps || !keys) {
+        free(stamps);
+        free(keys);
+        return false;
+    }
+
+    for (size_t i = 0; i <= detector->mask; i++) {
+        if (detector->stamps[i] != detector->generation) {
+            continue;
+        }
+        size_t slot = ((uint32_t)detector->keys[i] * 2654435769u) & (slots - 1);
+        while (stamps[slot] == detector->generation) {
+            slot = (slot + 1) & (slots - 1);
         }
+        stamps[slot] = detector->generation;
+        keys[slot] = detector->keys[i];
     }
-    return false;
+
+    free(detector->stamps);
+    free(detector->keys);
+    detector->stamps = stamps;
+    detector->keys = keys;
+    detector->mask = slots - 1;
+    return true;
+}
+
+/**
+ * \brief          Add a birthday to the current trial
+ *
+ * \param[in]      detector The detector
+ * \param[in]      value The birthday, 1 to the domain size
+ * \return         1 when the trial already had the birthday, a collision, 0 when it is new,
+ *                 and -1 when the set could not grow
+ */
+static int
+detector_add(collision_detector_t* detector, int value) {
+    if (!detector->keys) {
+        if (detector->stamps[value] == detector->generation) {
+            return 1;
+        }
+        detector->stamps[value] = detector->generation;
+        return 0;
+    }
+
+    // Linear probing at a load of at most 1/2, the Fibonacci hash spreads consecutive values
+    size_t slot = ((uint32_t)value * 2654435769u) & detector->mask;
+    while (detector->stamps[slot] == detector->generation) {
+        if (detector->keys[slot] == value) {
+            return 1;
+        }
+        slot = (slot + 1) & detector->mask;
+    }
+    detector->stamps[slot] = detector->generation;
+    detector->keys[slot] = value;
+
+    if (++detector->count > (detector->mask + 1) / 2 && !detector_grow(detector)) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * \brief          Free the memory of a detector
+ *
+ * \param[in]      detector The detector
+ */
+static void
+detector_free(collision_detector_t* detector) {
+    free(detector->stamps);
+    free(detector->keys);
+}
+
+/**
+ * \brief          Hash the next batch of counter inputs and reduce every digest to a
+ *                 birthday: its first 8 bytes, big endian, modulo the domain. A digest of
+ *                 fewer bits than the domain only reaches some of the birthdays, as the hash
+ *                 would.
+ *
+ * \param[in]      samples The samples of the simulation
+ * \return         true once the batch is hashed, false when the hash failed
+ */
+static bool
+hashed_samples_refill(hashed_samples_t* samples) {
+    const uint8_t* inputs[BH_PARADOX_HASH_BATCH];
+    size_t input_lens[BH_PARADOX_HASH_BATCH];
+    for (int i = 0; i < BH_PARADOX_HASH_BATCH; i++, samples->counter++) {
+        for (int byte = 0; byte < 8; byte++) {
+            samples->inputs[i][byte] = (uint8_t)(samples->key >> (8 * byte));
+            samples->inputs[i][8 + byte] = (uint8_t)(samples->counter >> (8 * byte));
+        }
+        inputs[i] = samples->inputs[i];
+        input_lens[i] = BH_PARADOX_INPUT_BYTES;
+    }
+
+    if (!samples->batch(inputs, input_lens, BH_PARADOX_HASH_BATCH, samples->digests)) {
+        return false;
+    }
+
+    size_t value_bytes = samples->digest_bytes < 8 ? samples->digest_bytes : 8;
+    for (int i = 0; i < BH_PARADOX_HASH_BATCH; i++) {
+        const uint8_t* digest = samples->digests + i * samples->digest_bytes;
+        uint64_t value = 0;
+        for (size_t byte = 0; byte < value_bytes; byte++) {
+            value = (value << 8) | digest[byte];
+        }
+        samples->samples[i] = (int)(value % (uint64_t)samples->domain_size) + 1;
+    }
+    samples->next = 0;
+    return true;
+}
+
+/**
+ * \brief          Draw the next sample of a simulation
+ *
+ * \param[in]      simulation The simulation
+ * \return         The birthday, 1 to the domain size, or 0 when the hash failed
+ */
+static int
+simulation_next_sample(paradox_simulation_t* simulation) {
+    hashed_samples_t* samples = simulation->samples;
+    if (!samples) {
+        // Generate number in range [1, domain_size]
+        return (rand() % simulation->detector.domain_size) + 1;
+    }
+
+    if (samples->next == BH_PARADOX_HASH_BATCH && !hashed_samples_refill(samples)) {
+        return 0;
+    }
+    return samples->samples[samples->next++];
 }
 
 /****************************************************************
@@ -93,6 +316,155 @@ calculate_birthday_collision_probability(int domain_size, int sample_size) {
     return 1.0 - no_collision_prob;
 }
 
+/**
+ * \brief          Start a simulation that is run a step at a time with
+ *                 `paradox_simulation_step`. With a hash, the samples are the digests of
+ *                 counter inputs reduced to the domain. The inputs are hashed a batch at a
+ *                 time and the samples of a trial follow the ones of the trial before, so no
+ *                 input is hashed twice. You should free the returned simulation using
+ *                 `paradox_simulation_destroy` when done.
+ *
+ * \param[in]      domain_size The range of possible values (e.g., 365
+ *                 for days in a year)
+ * \param[in]      sample_size The number of values to take per trial
+ * \param[in]      num_runs The number of simulation trials to run
+ * \param[in]      batch The batch function of the hash from its registry entry, or NULL to
+ *                 draw the samples from rand()
+ * \param[in]      digest_bytes The bytes of a digest of the hash, unused without one
+ * \return         The simulation, or NULL on memory allocation failure
+ */
+paradox_simulation_t*
+paradox_simulation_create(int domain_size, int sample_size, int num_runs, hash_batch_fn batch,
+                          size_t digest_bytes) {
+    // Seed the random number generator if it hasn't been seeded
+    seed_random();
+
+    paradox_simulation_t* simulation = calloc(1, sizeof(paradox_simulation_t));
+    if (!simulation) {
+        return NULL;
+    }
+
+    // The detector remembers the birthdays of a trial, reused across trials without clearing
+    if (!detector_init(&simulation->detector, domain_size)) {
+        free(simulation);
+        return NULL;
+    }
+    simulation->sample_size = sample_size;
+    simulation->num_runs = num_runs;
+
+    if (batch) {
+        hashed_samples_t* samples = (hashed_samples_t*)malloc(sizeof(hashed_samples_t));
+        if (!samples) {
+            paradox_simulation_destroy(simulation);
+            return NULL;
+        }
+
+        // Every simulation hashes other inputs, so running it again gives another estimate
+        samples->batch = batch;
+        samples->digest_bytes = digest_bytes;
+        samples->domain_size = domain_size;
+        samples->key = ((uint64_t)rand() << 32) ^ (uint64_t)rand() ^ (uint64_t)time(NULL);
+        samples->counter = 0;
+        samples->next = BH_PARADOX_HASH_BATCH;
+        simulation->samples = samples;
+    }
+    return simulation;
+}
+
+/**
+ * \brief          Run the next trials of a simulation, until it drew max_samples samples or
+ *                 ran all of its trials. A trial started in the step is always finished.
+ *
+ * \param[in]      simulation The simulation
+ * \param[in]      max_samples The samples the step draws before it stops after its trial
+ * \return         The trials run so far, num_runs once the simulation is done, or -1 when
+ *                 memory allocation or the hash failed
+ *
+ * \note           A trial stops at its first repeated value, so it takes at most
+ *                 domain_size + 1 samples whatever the sample size.
+ */
+int
+paradox_simulation_step(paradox_simulation_t* simulation, int max_samples) {
+    int drawn = 0;
+    while (simulation->runs_done < simulation->num_runs && drawn < max_samples) {
+        detector_next_trial(&simulation->detector);
+
+        // Draw the samples of this trial until the first repeat, the samples of a hash
+        // after it are left to the next trial
+        for (int i = 0; i < simulation->sample_size; i++) {
+            int value = simulation_next_sample(simulation);
+            if (value == 0) {
+                return -1;
+            }
+            drawn++;
+
+            int found = detector_add(&simulation->detector, value);
+            if (found < 0) {
+                return -1;
+            }
+            if (found > 0) {
+                simulation->collisions_found++;
+                break;
+            }
+        }
+        simulation->runs_done++;
+    }
+    return simulation->runs_done;
+}
+
+/**
+ * \brief          Get the result of the trials of a simulation run so far
+ *
+ * \param[in]      simulation The simulation
+ * \return         The percentage of trials where a collision was found (0.0 to 100.0)
+ */
+double
+paradox_simulation_result(const paradox_simulation_t* simulation) {
+    if (simulation->runs_done == 0) {
+        return 0.0;
+    }
+    return (100.0 * simulation->collisions_found) / simulation->runs_done;
+}
+
+/**
+ * \brief          Free the memory of a simulation
+ *
+ * \param[in]      simulation The simulation, may be NULL
+ */
+void
+paradox_simulation_destroy(paradox_simulation_t* simulation) {
+    if (!simulation) {
+        return;
+    }
+
+    detector_free(&simulation->detector);
+    free(simulation->samples);
+    free(simulation);
+}
+
+/**
+ * \brief          Run a simulation to its end
+ *
+ * \param[in]      simulation The simulation, may be NULL after a failed create
+ * \return         The percentage of trials where a collision was found (0.0 to 100.0), or
+ *                 -1.0 when the simulation could not be created or failed
+ */
+static double
+paradox_simulation_run(paradox_simulation_t* simulation) {
+    if (!simulation) {
+        return -1.0; // Memory allocation failed
+    }
+
+    int runs_done;
+    do {
+        runs_done = paradox_simulation_step(simulation, BH_PARADOX_STEP_SAMPLES);
+    } while (runs_done >= 0 && runs_done < simulation->num_runs);
+
+    double result = runs_done < 0 ? -1.0 : paradox_simulation_result(simulation);
+    paradox_simulation_destroy(simulation);
+    return result;
+}
+
 /**
  * \brief          Simulates the birthday paradox by running multiple
  *                 random trials.
@@ -107,42 +479,35 @@ calculate_birthday_collision_probability(int domain_size, int sample_size) {
  *                 will be returned
  *
  * \note           This function uses actual random sampling to empirically test
- *                 the birthday paradox probability through simulation
+ *                 the birthday paradox probability through simulation. A trial
+ *                 stops at its first repeated value, so it takes at most
+ *                 domain_size + 1 samples whatever the sample size.
  */
 double
 simulate_birthday_collision(int domain_size, int sample_size, int num_runs) {
-    // Seed the random number generator if it hasn't been seeded
-    static bool seeded = false;
-    if (!seeded) {
-        srand((unsigned int)time(NULL));
-        seeded = true;
-    }
-
-    // Allocate array for storing random numbers in each trial
-    int* numbers = (int*)malloc(sample_size * sizeof(int));
-    if (!numbers) {
-        return -1.0; // Memory allocation failed
-    }
-
-    int collisions_found = 0;
-
-    // Run the simulation num_runs times
-    for (int run = 0; run < num_runs; run++) {
-        // Generate random numbers for this trial
-        for (int i = 0; i < sample_size; i++) {
-            // Generate number in range [1, domain_size]
-            numbers[i] = (rand() % domain_size) + 1;
-        }
-
-        // Check if this trial had a collision
-        if (has_collision(numbers, sample_size)) {
-            collisions_found++;
-        }
-    }
-
-    // Free the allocated memory
-    free(numbers);
+    return paradox_simulation_run(
+        paradox_simulation_create(domain_size, sample_size, num_runs, NULL, 0));
+}
 
-    // Calculate and return the percentage
-    return (100.0 * collisions_found) / num_runs;
+/**
+ * \brief          Simulates the birthday paradox with the samples of a hash function
+ *                 instead of rand(): the digests of counter inputs, reduced to the domain.
+ *                 The inputs are hashed a batch at a time and the samples of a trial follow
+ *                 the ones of the trial before, so no input is hashed twice.
+ *
+ * \param[in]      domain_size The range of possible values (e.g., 365
+ *                 for days in a year)
+ * \param[in]      sample_size The number of values to take per trial
+ * \param[in]      num_runs The number of simulation trials to run
+ * \param[in]      batch The batch function of the hash, from its registry entry
+ * \param[in]      digest_bytes The bytes of a digest of the hash
+ * \return         The percentage of trials where a collision was
+ *                 found (0.0 to 100.0). If memory allocation or the hash fails, -1.0
+ *                 will be returned
+ */
+double
+simulate_birthday_collision_hashed(int domain_size, int sample_size, int num_runs,
+                                   hash_batch_fn batch, size_t digest_bytes) {
+    return paradox_simulation_run(
+        paradox_simulation_create(domain_size, sample_size, num_runs, batch, digest_bytes));
 }
@@ -13,11 +13,54 @@
 #define PARADOX_MATH_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
+#include "hash_function.h"
+
+/**
+ * \brief          The counter inputs hashed at once by a hashed simulation
+ */
+#define BH_PARADOX_HASH_BATCH 256
+
+/**
+ * \brief          The bytes of a counter input of a hashed simulation, a key drawn for the
+ *                 simulation followed by the counter, both little endian
+ */
+#define BH_PARADOX_INPUT_BYTES 16
+
+/**
+ * \brief          The largest domain whose birthdays get a stamp each; larger domains keep the
+ *                 birthdays of a trial in an open-addressing set instead
+ */
+#define BH_PARADOX_STAMP_MAX_DOMAIN (1 << 22)
+
+/**
+ * \brief          The slots of the set of a large domain before it first grows
+ */
+#define BH_PARADOX_SET_MIN_SLOTS 1024
+
+/**
+ * \brief          The samples a step of a simulation draws before it returns, so the page
+ *                 running it can draw its progress and read keys between the steps
+ */
+#define BH_PARADOX_STEP_SAMPLES (1 << 16)
+
+typedef struct paradox_simulation paradox_simulation_t;
+
 double calculate_birthday_collision_probability(int domain_size, int sample_size);
 
 double simulate_birthday_collision(int domain_size, int sample_size, int num_runs);
 
+double simulate_birthday_collision_hashed(int domain_size, int sample_size, int num_runs,
+                                          hash_batch_fn batch, size_t digest_bytes);
+
+paradox_simulation_t* paradox_simulation_create(int domain_size, int sample_size, int num_runs,
+                                                hash_batch_fn batch, size_t digest_bytes);
+int paradox_simulation_step(paradox_simulation_t* simulation, int max_samples);
+double paradox_simulation_result(const paradox_simulation_t* simulation);
+void paradox_simulation_destroy(paradox_simulation_t* simulation);
+
 #endif